@@ -0,0 +1,227 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     ChannelChurnBench.cpp
+ * @brief    连接对象频繁创建销毁：回收池分配与堆分配对比
+ * @author   Bwar
+ * @date:    2026年10月18日
+ * @note     模拟短连接场景下Dispatcher::CreateSocketChannel()和DiscardSocketChannel()
+ * 的连接对象创建、Init()、关闭和析构，保持一定数量的存活连接，每轮以新连接替换最早
+ * 的连接（存活连接的分配与释放交错，不是同一内存块的反复分配）。统计：
+ * 1. 连接实现：SocketChannelImpl以allocate_shared与PoolAllocator（与SocketChannel构造
+ *    时相同）对比make_shared，两者都执行Init()并取得ev_io、ev_timer（与加入IO事件和
+ *    超时相同），后者只有对象与控制块走堆分配，编解码器、收发队列和watcher仍由回收池分配；
+ * 2. 一个连接的全部内存分配：连接、实现、编解码器、ev_io、ev_timer各一块及收发缓冲，
+ *    MemoryPool与SendQueue回收池对比malloc和new/delete。
+ * 连接fd为-1，两种方式的关闭都只多一次失败的close()系统调用。
+ * 用法：ChannelChurnBench [每种方式的轮数] [存活连接数]
+ * Modify history:
+ ******************************************************************************/
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "ev.h"
+#include "labor/Labor.hpp"
+#include "labor/NodeInfo.hpp"
+#include "util/json/CJsonObject.hpp"
+#include "util/MemoryPool.hpp"
+#include "channel/SocketChannel.hpp"
+#include "channel/SocketChannelImpl.hpp"
+#include "channel/SendQueue.hpp"
+#include "codec/CodecHttp.hpp"
+#include "logger/NetLogger.hpp"
+
+using namespace neb;
+
+typedef std::chrono::steady_clock clock_type;
+
+static double Ms(clock_type::time_point oBegin, clock_type::time_point oEnd)
+{
+    return(std::chrono::duration<double, std::milli>(oEnd - oBegin).count());
+}
+
+/**
+ * @brief SocketChannelImpl::Init()只需要Labor提供当前时间
+ */
+class BenchLabor: public Labor
+{
+public:
+    BenchLabor() : Labor(LABOR_WORKER), m_uiSequence(0)
+    {
+    }
+    virtual ~BenchLabor()
+    {
+    }
+
+    virtual Dispatcher* GetDispatcher() override { return(nullptr); }
+    virtual ActorBuilder* GetActorBuilder() override { return(nullptr); }
+    virtual uint32 GetSequence() const override { return(++m_uiSequence); }
+    virtual time_t GetNowTime() const override { return(time(NULL)); }
+    virtual long GetNowTimeMs() const override { return(0); }
+    virtual int64 GetMonotonicTimeMs() const override { return(0); }
+    virtual int64 GetMonotonicTimeUs() const override { return(0); }
+    virtual const CJsonObject& GetNodeConf() const override { return(m_oConf); }
+    virtual void SetNodeConf(const CJsonObject& oNodeConf) override {}
+    virtual const NodeInfo& GetNodeInfo() const override { return(m_stNodeInfo); }
+    virtual void SetNodeId(uint32 uiNodeId) override {}
+    virtual bool AddNetLogMsg(const MsgBody& oMsgBody) override { return(false); }
+    virtual void OnTerminated(struct ev_signal* watcher) override {}
+    virtual const CJsonObject& GetCustomConf() const override { return(m_oConf); }
+
+private:
+    mutable uint32 m_uiSequence;
+    CJsonObject m_oConf;
+    NodeInfo m_stNodeInfo;
+};
+
+static void InitChannel(std::shared_ptr<SocketChannelImpl>& pChannel, BenchLabor& oLabor)
+{
+    pChannel->SetLabor(&oLabor);
+    pChannel->Init(CODEC_HTTP, false);
+    pChannel->MutableIoWatcher();
+    pChannel->MutableTimerWatcher();
+}
+
+template <typename MAKE>
+static double ChurnChannel(int iRounds, int iLive, BenchLabor& oLabor, MAKE&& fnMake)
+{
+    std::vector<std::shared_ptr<SocketChannelImpl>> vecLive(iLive);
+    for (int i = 0; i < iLive; ++i)
+    {
+        vecLive[i] = fnMake();
+        InitChannel(vecLive[i], oLabor);
+    }
+    clock_type::time_point oBegin = clock_type::now();
+    for (int i = 0; i < iRounds; ++i)
+    {
+        std::shared_ptr<SocketChannelImpl>& pChannel = vecLive[i % iLive];
+        pChannel = fnMake();        // 原连接在此析构（关闭、释放收发队列、编解码器和watcher）
+        InitChannel(pChannel, oLabor);
+    }
+    double dElapsed = Ms(oBegin, clock_type::now());
+    vecLive.clear();
+    return(dElapsed);
+}
+
+/**
+ * @brief 一个连接的各内存块
+ */
+struct tagConnBlocks
+{
+    void* apBlock[5] = {nullptr, nullptr, nullptr, nullptr, nullptr};
+    SendQueue* pSendBuff = nullptr;
+    SendQueue* pWaitForSendBuff = nullptr;
+    CBuffer* pRecvBuff = nullptr;
+};
+
+template <typename ALLOC, typename FREE>
+static double ChurnBlocks(int iRounds, int iLive, ALLOC&& fnAlloc, FREE&& fnFree)
+{
+    std::vector<tagConnBlocks> vecLive(iLive);
+    for (auto& stBlocks : vecLive)
+    {
+        fnAlloc(stBlocks);
+    }
+    clock_type::time_point oBegin = clock_type::now();
+    for (int i = 0; i < iRounds; ++i)
+    {
+        tagConnBlocks& stBlocks = vecLive[i % iLive];
+        fnFree(stBlocks);
+        fnAlloc(stBlocks);
+    }
+    double dElapsed = Ms(oBegin, clock_type::now());
+    for (auto& stBlocks : vecLive)
+    {
+        fnFree(stBlocks);
+    }
+    return(dElapsed);
+}
+
+int main(int argc, char* argv[])
+{
+    int iRounds = (argc > 1) ? atoi(argv[1]) : 200000;
+    int iLive = (argc > 2) ? atoi(argv[2]) : 1000;
+    if (iRounds <= 0 || iLive <= 0)
+    {
+        fprintf(stderr, "usage: %s [rounds] [live_channels]\n", argv[0]);
+        return(1);
+    }
+    char szDir[] = "/tmp/neb_churn_bench_XXXXXX";
+    if (NULL == mkdtemp(szDir))
+    {
+        perror("mkdtemp");
+        return(1);
+    }
+    std::string strLogFile = std::string(szDir) + "/bench.log";
+    {
+        std::shared_ptr<NetLogger> pLogger = std::make_shared<NetLogger>(strLogFile, Logger::FATAL);
+        BenchLabor oLabor;
+        printf("ChannelChurn: %d rounds, %d live channels\n", iRounds, iLive);
+
+        double dPooled = ChurnChannel(iRounds, iLive, oLabor, [&]()
+                {
+                    return(std::allocate_shared<SocketChannelImpl>(PoolAllocator<SocketChannelImpl>(),
+                            nullptr, pLogger, -1, oLabor.GetSequence()));
+                });
+        double dHeap = ChurnChannel(iRounds, iLive, oLabor, [&]()
+                {
+                    return(std::make_shared<SocketChannelImpl>(nullptr, pLogger, -1, oLabor.GetSequence()));
+                });
+        printf("%-30s %8.1f ns/channel\n", "impl allocate_shared(pool)", dPooled * 1000000.0 / iRounds);
+        printf("%-30s %8.1f ns/channel\n", "impl make_shared(heap)", dHeap * 1000000.0 / iRounds);
+
+        // 与连接实际分配的内存块大小一致（控制块按对象加32字节估计）
+        const size_t auiSize[5] = {sizeof(SocketChannel) + 32, sizeof(SocketChannelImpl) + 32,
+                sizeof(CodecHttp), sizeof(ev_io), sizeof(ev_timer)};
+        double dPoolBlocks = ChurnBlocks(iRounds, iLive,
+                [&](tagConnBlocks& stBlocks)
+                {
+                    for (int i = 0; i < 5; ++i)
+                    {
+                        stBlocks.apBlock[i] = MemoryPool::Allocate(auiSize[i]);
+                    }
+                    stBlocks.pSendBuff = SendQueue::Acquire();
+                    stBlocks.pWaitForSendBuff = SendQueue::Acquire();
+                    stBlocks.pRecvBuff = SendQueue::AcquireBuffer();
+                },
+                [&](tagConnBlocks& stBlocks)
+                {
+                    for (int i = 0; i < 5; ++i)
+                    {
+                        MemoryPool::Deallocate(stBlocks.apBlock[i], auiSize[i]);
+                    }
+                    SendQueue::Release(stBlocks.pSendBuff);
+                    SendQueue::Release(stBlocks.pWaitForSendBuff);
+                    SendQueue::ReleaseBuffer(stBlocks.pRecvBuff);
+                });
+        double dHeapBlocks = ChurnBlocks(iRounds, iLive,
+                [&](tagConnBlocks& stBlocks)
+                {
+                    for (int i = 0; i < 5; ++i)
+                    {
+                        stBlocks.apBlock[i] = malloc(auiSize[i]);
+                    }
+                    stBlocks.pSendBuff = new SendQueue();
+                    stBlocks.pWaitForSendBuff = new SendQueue();
+                    stBlocks.pRecvBuff = new CBuffer(CBuffer::BUFFER_MAX_READ);
+                },
+                [&](tagConnBlocks& stBlocks)
+                {
+                    for (int i = 0; i < 5; ++i)
+                    {
+                        free(stBlocks.apBlock[i]);
+                    }
+                    delete stBlocks.pSendBuff;
+                    delete stBlocks.pWaitForSendBuff;
+                    delete stBlocks.pRecvBuff;
+                });
+        printf("%-30s %8.1f ns/connection\n", "blocks MemoryPool+SendQueue", dPoolBlocks * 1000000.0 / iRounds);
+        printf("%-30s %8.1f ns/connection\n", "blocks malloc+new", dHeapBlocks * 1000000.0 / iRounds);
+    }
+    unlink(strLogFile.c_str());
+    rmdir(szDir);
+    return(0);
+}
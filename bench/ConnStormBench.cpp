@@ -0,0 +1,334 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     ConnStormBench.cpp
+ * @brief    新建连接风暴：SO_REUSEPORT各Worker自行accept与Manager accept后传递fd对比
+ * @author   Bwar
+ * @date:    2026年10月18日
+ * @note     在回环地址上以真实的线程模式Worker（与Manager::CreateWorkerThread()相同的方式
+ * 创建和运行）处理新建连接，统计每秒可建立并得到响应的新连接数：
+ * 1. fd passing：Worker不监听，一个Manager线程accept后按轮询以SocketChannel::SendChannelFd()
+ *    把fd传给各Worker（与Dispatcher::AcceptFdAndTransfer()相同，只是不做IP连接频率检查），
+ *    Worker经Dispatcher::FdTransfer()、CreateAcceptedChannel()接入；
+ * 2. SO_REUSEPORT：配置reuse_port，各Worker在StartService()中各自监听同一端口，由内核分发
+ *    新连接，经Dispatcher::AcceptClientConn()、CreateAcceptedChannel()接入。
+ * Worker以http编解码接入，未加载任何模块，对每个请求响应404。服务端在fork出的子进程中运行，
+ * 客户端线程循环connect、发送一个http请求、读到响应后关闭，统计从connect到收到响应的
+ * 平均和最大耗时。
+ * 用法：ConnStormBench [Worker数] [连接总数] [客户端线程数]
+ * Modify history:
+ ******************************************************************************/
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <string>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "labor/Worker.hpp"
+#include "channel/SocketChannel.hpp"
+#include "logger/NetLogger.hpp"
+#include "util/json/CJsonObject.hpp"
+
+using namespace neb;
+
+typedef std::chrono::steady_clock clock_type;
+
+static const char* s_szRequest = "GET /conn_storm HTTP/1.1\r\nHost: 127.0.0.1\r\nContent-Length: 0\r\n\r\n";
+
+static double Ms(clock_type::time_point oBegin, clock_type::time_point oEnd)
+{
+    return(std::chrono::duration<double, std::milli>(oEnd - oBegin).count());
+}
+
+/**
+ * @brief 找一个空闲端口（绑定后立即关闭）
+ */
+static uint16 FreePort()
+{
+    int iFd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in stAddr;
+    memset(&stAddr, 0, sizeof(stAddr));
+    stAddr.sin_family = AF_INET;
+    stAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t uiAddrLen = sizeof(stAddr);
+    uint16 unPort = 0;
+    if (bind(iFd, (struct sockaddr*)&stAddr, sizeof(stAddr)) == 0
+            && getsockname(iFd, (struct sockaddr*)&stAddr, &uiAddrLen) == 0)
+    {
+        unPort = ntohs(stAddr.sin_port);
+    }
+    close(iFd);
+    return(unPort);
+}
+
+/**
+ * @brief fd passing模式下Manager的监听fd
+ */
+static int Listen(uint16 unPort)
+{
+    int iFd = socket(AF_INET, SOCK_STREAM, 0);
+    int iReuse = 1;
+    setsockopt(iFd, SOL_SOCKET, SO_REUSEADDR, &iReuse, sizeof(iReuse));
+    struct sockaddr_in stAddr;
+    memset(&stAddr, 0, sizeof(stAddr));
+    stAddr.sin_family = AF_INET;
+    stAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    stAddr.sin_port = htons(unPort);
+    if (bind(iFd, (struct sockaddr*)&stAddr, sizeof(stAddr)) < 0 || listen(iFd, 1024) < 0)
+    {
+        fprintf(stderr, "listen error %d: %s\n", errno, strerror(errno));
+        close(iFd);
+        return(-1);
+    }
+    fcntl(iFd, F_SETFL, fcntl(iFd, F_GETFL) | O_NONBLOCK);
+    return(iFd);
+}
+
+/**
+ * @brief 服务端子进程：创建线程模式Worker，fd passing模式下本线程充当Manager accept并传递fd，
+ * 同时读走Worker发给Manager的启动和负载消息。由父进程kill结束。
+ */
+static void Serve(const std::string& strWorkPath, bool bReusePort, int iWorkerNum, uint16 unPort)
+{
+    signal(SIGPIPE, SIG_IGN);
+    CJsonObject oConf;
+    oConf.Parse("{\"server_name\":\"conn_storm\",\"thread_mode\":true,\"node_type\":\"BENCH\","
+            "\"host\":\"127.0.0.1\",\"port\":0,\"access_host\":\"127.0.0.1\",\"access_codec\":3,"
+            "\"log_path\":\".\",\"log_level\":0,\"net_log_level\":0,\"io_timeout\":10.0,"
+            "\"permission\":{\"addr_permit\":{\"stat_interval\":60.0,\"permit_num\":1000000000}},"
+            "\"load_config\":{\"worker\":{\"boot_load\":{},\"dynamic_loading\":[]}}}");
+    oConf.Add("worker_num", iWorkerNum);
+    oConf.Add("access_port", (int)unPort);
+    oConf.Add("reuse_port", bReusePort, bReusePort);
+
+    std::vector<int> vecControlFd;
+    std::vector<int> vecDataFd;
+    for (int i = 0; i < iWorkerNum; ++i)
+    {
+        int aiControlFd[2];
+        int aiDataFd[2];
+        if (socketpair(PF_UNIX, SOCK_STREAM, 0, aiControlFd) < 0 || socketpair(PF_UNIX, SOCK_STREAM, 0, aiDataFd) < 0)
+        {
+            fprintf(stderr, "socketpair error %d: %s\n", errno, strerror(errno));
+            _exit(1);
+        }
+        for (int iFd : {aiControlFd[0], aiControlFd[1], aiDataFd[0], aiDataFd[1]})
+        {
+            fcntl(iFd, F_SETFL, fcntl(iFd, F_GETFL) | O_NONBLOCK);
+        }
+        Worker* pWorker = new Worker(strWorkPath, aiControlFd[1], aiDataFd[1], i, Labor::LABOR_WORKER);
+        if (!pWorker->Init(oConf))
+        {
+            fprintf(stderr, "worker %d init failed\n", i);
+            _exit(1);
+        }
+        std::thread t(&Worker::Run, pWorker);
+        t.detach();
+        vecControlFd.push_back(aiControlFd[0]);
+        vecDataFd.push_back(aiDataFd[0]);
+    }
+
+    int iListenFd = bReusePort ? -1 : Listen(unPort);
+    std::shared_ptr<NetLogger> pLogger = std::make_shared<NetLogger>(strWorkPath + "/manager.log", Logger::FATAL);
+    int iEpollFd = epoll_create1(0);
+    struct epoll_event stEvent;
+    stEvent.events = EPOLLIN;
+    for (auto iFd : vecControlFd)
+    {
+        stEvent.data.fd = iFd;
+        epoll_ctl(iEpollFd, EPOLL_CTL_ADD, iFd, &stEvent);
+    }
+    if (iListenFd >= 0)
+    {
+        stEvent.data.fd = iListenFd;
+        epoll_ctl(iEpollFd, EPOLL_CTL_ADD, iListenFd, &stEvent);
+    }
+    struct epoll_event astEvent[64];
+    char szDiscard[4096];
+    size_t uiNext = 0;
+    while (true)
+    {
+        int iNum = epoll_wait(iEpollFd, astEvent, 64, -1);
+        for (int i = 0; i < iNum; ++i)
+        {
+            if (astEvent[i].data.fd != iListenFd)
+            {
+                while (read(astEvent[i].data.fd, szDiscard, sizeof(szDiscard)) > 0);
+                continue;
+            }
+            for (int j = 0; j < gc_iMaxAcceptPerEvent; ++j)
+            {
+                int iFd = accept(iListenFd, NULL, NULL);
+                if (iFd < 0)
+                {
+                    break;
+                }
+                SocketChannel::SendChannelFd(vecDataFd[uiNext], iFd, AF_INET, CODEC_HTTP, pLogger);
+                uiNext = (uiNext + 1) % vecDataFd.size();
+                close(iFd);     // 已传给Worker，Manager不再持有
+            }
+        }
+    }
+}
+
+/**
+ * @brief 建立一个连接，发送请求并读到响应
+ */
+static bool Request(const struct sockaddr_in& stAddr)
+{
+    int iFd = socket(AF_INET, SOCK_STREAM, 0);
+    struct linger stLinger = {1, 0};     // 客户端不留TIME_WAIT，避免耗尽本地端口
+    setsockopt(iFd, SOL_SOCKET, SO_LINGER, &stLinger, sizeof(stLinger));
+    char szResponse[256];
+    bool bResult = (connect(iFd, (struct sockaddr*)&stAddr, sizeof(stAddr)) == 0
+            && write(iFd, s_szRequest, strlen(s_szRequest)) == (ssize_t)strlen(s_szRequest)
+            && read(iFd, szResponse, sizeof(szResponse)) >= 12
+            && 0 == strncmp(szResponse, "HTTP/1.1 404", 12));
+    close(iFd);
+    return(bResult);
+}
+
+struct tagClientStat
+{
+    long lConnected = 0;
+    long lFailed = 0;
+    double dTotalMs = 0.0;
+    double dMaxMs = 0.0;
+};
+
+static void ClientLoop(const struct sockaddr_in& stAddr, int iConnNum, tagClientStat& stStat)
+{
+    for (int i = 0; i < iConnNum; ++i)
+    {
+        clock_type::time_point oBegin = clock_type::now();
+        if (Request(stAddr))
+        {
+            double dMs = Ms(oBegin, clock_type::now());
+            ++stStat.lConnected;
+            stStat.dTotalMs += dMs;
+            stStat.dMaxMs = (dMs > stStat.dMaxMs) ? dMs : stStat.dMaxMs;
+        }
+        else
+        {
+            ++stStat.lFailed;
+        }
+    }
+}
+
+static bool Run(const std::string& strWorkPath, const char* szMode, bool bReusePort,
+        int iWorkerNum, int iConnNum, int iClientNum)
+{
+    uint16 unPort = FreePort();
+    pid_t iServerPid = fork();
+    if (iServerPid < 0)
+    {
+        perror("fork");
+        return(false);
+    }
+    if (0 == iServerPid)
+    {
+        Serve(strWorkPath, bReusePort, iWorkerNum, unPort);
+        _exit(0);
+    }
+
+    struct sockaddr_in stAddr;
+    memset(&stAddr, 0, sizeof(stAddr));
+    stAddr.sin_family = AF_INET;
+    stAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    stAddr.sin_port = htons(unPort);
+    bool bReady = false;
+    for (int i = 0; i < 500 && !bReady; ++i)    // 等待Worker（或Manager线程）开始监听
+    {
+        bReady = Request(stAddr);
+        if (!bReady)
+        {
+            usleep(10000);
+        }
+    }
+    usleep(100000);     // SO_REUSEPORT模式下等其余Worker也开始监听
+    bool bResult = false;
+    if (bReady)
+    {
+        std::vector<tagClientStat> vecStat(iClientNum);
+        std::vector<std::thread> vecClient;
+        clock_type::time_point oStart = clock_type::now();
+        for (int i = 0; i < iClientNum; ++i)
+        {
+            int iNum = iConnNum / iClientNum + ((i < iConnNum % iClientNum) ? 1 : 0);
+            vecClient.emplace_back(ClientLoop, std::cref(stAddr), iNum, std::ref(vecStat[i]));
+        }
+        for (auto& oThread : vecClient)
+        {
+            oThread.join();
+        }
+        double dElapsed = Ms(oStart, clock_type::now());
+
+        tagClientStat stTotal;
+        for (auto& stStat : vecStat)
+        {
+            stTotal.lConnected += stStat.lConnected;
+            stTotal.lFailed += stStat.lFailed;
+            stTotal.dTotalMs += stStat.dTotalMs;
+            stTotal.dMaxMs = (stStat.dMaxMs > stTotal.dMaxMs) ? stStat.dMaxMs : stTotal.dMaxMs;
+        }
+        printf("%-14s %10.0f conn/s  avg %7.3f ms  max %8.3f ms  (%ld failed)\n",
+                szMode, stTotal.lConnected * 1000.0 / dElapsed,
+                (stTotal.lConnected > 0) ? stTotal.dTotalMs / stTotal.lConnected : 0.0,
+                stTotal.dMaxMs, stTotal.lFailed);
+        bResult = (stTotal.lFailed == 0 && stTotal.lConnected == iConnNum);
+    }
+    else
+    {
+        fprintf(stderr, "%s: server on port %u not ready\n", szMode, unPort);
+    }
+    kill(iServerPid, SIGKILL);
+    waitpid(iServerPid, NULL, 0);
+    return(bResult);
+}
+
+int main(int argc, char* argv[])
+{
+    int iWorkerNum = (argc > 1) ? atoi(argv[1]) : 4;
+    int iConnNum = (argc > 2) ? atoi(argv[2]) : 20000;
+    int iClientNum = (argc > 3) ? atoi(argv[3]) : 8;
+    if (iWorkerNum <= 0 || iConnNum <= 0 || iClientNum <= 0)
+    {
+        fprintf(stderr, "usage: %s [worker_num] [connections] [client_threads]\n", argv[0]);
+        return(1);
+    }
+    char szDir[] = "/tmp/neb_conn_storm_XXXXXX";
+    if (NULL == mkdtemp(szDir))
+    {
+        perror("mkdtemp");
+        return(1);
+    }
+    printf("ConnStorm: %d workers, %d connections from %d client threads, %u cpus\n",
+            iWorkerNum, iConnNum, iClientNum, std::thread::hardware_concurrency());
+    bool bOk = Run(szDir, "fd passing", false, iWorkerNum, iConnNum, iClientNum);
+    bOk = Run(szDir, "SO_REUSEPORT", true, iWorkerNum, iConnNum, iClientNum) && bOk;
+    DIR* pDir = opendir(szDir);     // Worker和Manager线程的日志文件
+    if (NULL != pDir)
+    {
+        struct dirent* pEntry = NULL;
+        while ((pEntry = readdir(pDir)) != NULL)
+        {
+            if (pEntry->d_name[0] != '.')
+            {
+                unlink((std::string(szDir) + "/" + pEntry->d_name).c_str());
+            }
+        }
+        closedir(pDir);
+    }
+    rmdir(szDir);
+    return(bOk ? 0 : 1);
+}
@@ -0,0 +1,110 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     FileLoggerBench.cpp
+ * @brief    FileLogger同步与异步模式的写日志速度
+ * @author   Bwar
+ * @date:    2026年10月18日
+ * @note     日志级别从FATAL到TRACE各跑一轮，每轮调用WriteLog()的级别在FATAL到TRACE
+ * 之间循环，级别越高实际写入的比例越大。同步模式的耗时即调用耗时；异步模式分别给出
+ * 调用耗时（事件循环线程看到的开销）和包括后台线程写完全部日志的总耗时。
+ * 用法：FileLoggerBench [每轮调用次数]
+ * Modify history:
+ ******************************************************************************/
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <unistd.h>
+#include "logger/FileLogger.hpp"
+
+using namespace neb;
+
+struct tagResult
+{
+    double dCallRate = 0.0;         ///< 调用速度（次/秒）
+    double dTotalRate = 0.0;        ///< 含后台线程写完的速度（次/秒）
+    unsigned long long ullDropped = 0;
+};
+
+enum E_MODE
+{
+    MODE_SYNC_FLUSH     = 0,        ///< 同步，每条fflush（always_flush_log: true）
+    MODE_SYNC           = 1,        ///< 同步，不逐条fflush
+    MODE_ASYNC_DROP     = 2,        ///< 异步，缓冲区满时丢弃
+    MODE_ASYNC_BLOCK    = 3,        ///< 异步，缓冲区满时等待
+    MODE_NUM
+};
+
+static const char* s_szMode[MODE_NUM] = {"sync+flush", "sync", "async(drop)", "async(block)"};
+
+tagResult Run(const std::string& strDir, E_MODE eMode, int iLogLevel, unsigned int uiCallNum)
+{
+    typedef std::chrono::steady_clock clock;
+    std::string strLogFile = strDir + "/bench_" + std::to_string(eMode) + "_" + std::to_string(iLogLevel) + ".log";
+    tagResult stResult;
+    clock::time_point oBegin = clock::now();
+    clock::time_point oCalled;
+    {
+        FileLogger oLogger(strLogFile, iLogLevel, 1024 * 1024 * 1024, 1, (MODE_SYNC_FLUSH == eMode));
+        if (MODE_ASYNC_DROP == eMode || MODE_ASYNC_BLOCK == eMode)
+        {
+            oLogger.EnableAsync(4 * 1024 * 1024,
+                    (MODE_ASYNC_DROP == eMode) ? FileLogger::OVERFLOW_DROP : FileLogger::OVERFLOW_BLOCK);
+        }
+        oBegin = clock::now();
+        for (unsigned int i = 0; i < uiCallNum; ++i)
+        {
+            oLogger.WriteLog(i % Logger::LEV_MAX, __FILE__, __LINE__, __FUNCTION__,
+                    "cmd %u, seq %u, fd %d, channel %s, recv %u bytes", 1001u, i, 12, "10.0.0.1:16001", 187u);
+        }
+        oCalled = clock::now();
+        stResult.ullDropped = oLogger.GetDroppedLogNum();
+    }   // 析构时等待后台线程写完
+    clock::time_point oEnd = clock::now();
+    double dCall = std::chrono::duration<double>(oCalled - oBegin).count();
+    double dTotal = std::chrono::duration<double>(oEnd - oBegin).count();
+    stResult.dCallRate = uiCallNum / dCall;
+    stResult.dTotalRate = uiCallNum / dTotal;
+    unlink(strLogFile.c_str());
+    return(stResult);
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned int uiCallNum = (argc > 1) ? (unsigned int)atoi(argv[1]) : 200000;
+    char szDir[] = "/tmp/neb_logger_bench_XXXXXX";
+    if (NULL == mkdtemp(szDir))
+    {
+        perror("mkdtemp");
+        return(1);
+    }
+
+    printf("FileLogger: %u WriteLog() calls per run, call levels cycle FATAL..TRACE\n", uiCallNum);
+    printf("call rate in msgs/s (async: total rate including background flush, dropped lines)\n");
+    printf("%-10s", "log_level");
+    for (int m = 0; m < MODE_NUM; ++m)
+    {
+        printf(" %16s", s_szMode[m]);
+    }
+    printf("\n");
+    for (int iLevel = Logger::FATAL; iLevel < Logger::LEV_MAX; ++iLevel)
+    {
+        printf("%-10s", LogLevMsg[iLevel].c_str());
+        std::string strAsync;
+        for (int m = 0; m < MODE_NUM; ++m)
+        {
+            tagResult stResult = Run(szDir, (E_MODE)m, iLevel, uiCallNum);
+            printf(" %16.0f", stResult.dCallRate);
+            if (MODE_ASYNC_DROP == m || MODE_ASYNC_BLOCK == m)
+            {
+                char szAsync[64];
+                snprintf(szAsync, sizeof(szAsync), "  [%s total %.0f, dropped %llu]",
+                        s_szMode[m], stResult.dTotalRate, stResult.ullDropped);
+                strAsync += szAsync;
+            }
+        }
+        printf("%s\n", strAsync.c_str());
+    }
+    rmdir(szDir);
+    return(0);
+}
@@ -0,0 +1,151 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     HpackBench.cpp
+ * @brief    HPACK头块编码和解码的耗时
+ * @author   Bwar
+ * @date:    2026年10月18日
+ * @note     以一组典型的浏览器请求头（13个头字段）测量三种情形：
+ * cold   每个头块使用新的编解码器（计时含创建编解码器），全部为字面量并插入动态表；
+ * repeat 同一连接上重复相同的请求，头字段全部命中动态表编码为索引；
+ * churn  同一连接上每个请求的:path和cookie都不同，动态表持续插入和淘汰。
+ * 每种情形分别测量不用和使用哈夫曼编码，编码和解码分开计时，并核对解码结果。
+ * 用法：HpackBench [头块数]
+ * Modify history:
+ ******************************************************************************/
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "codec/http2/CodecHttp2.hpp"
+#include "codec/http2/Http2Frame.hpp"
+#include "logger/NetLogger.hpp"
+#include "util/CBuffer.hpp"
+
+using namespace neb;
+
+enum E_SCENE
+{
+    SCENE_COLD      = 0,
+    SCENE_REPEAT    = 1,
+    SCENE_CHURN     = 2,
+};
+
+static void MakeRequest(E_SCENE eScene, int iSeq, bool bWithHuffman, HttpMsg& oHttpMsg)
+{
+    oHttpMsg.set_with_huffman(bWithHuffman);
+    auto& mapHeader = *oHttpMsg.mutable_headers();
+    mapHeader[":method"] = "GET";
+    mapHeader[":scheme"] = "https";
+    mapHeader[":authority"] = "www.example.com";
+    mapHeader[":path"] = "/api/v1/items?page=1";
+    mapHeader["user-agent"] = "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0 Safari/537.36";
+    mapHeader["accept"] = "text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8";
+    mapHeader["accept-encoding"] = "gzip, deflate, br";
+    mapHeader["accept-language"] = "zh-CN,zh;q=0.9,en;q=0.8";
+    mapHeader["cache-control"] = "no-cache";
+    mapHeader["referer"] = "https://www.example.com/index.html";
+    mapHeader["cookie"] = "session=8f3a9c2e71d04b6a; theme=dark";
+    mapHeader["x-request-id"] = "3e5b7c9d-1f2a-4b6c-8d0e-2f4a6b8c0d1e";
+    mapHeader["custom-key"] = "custom-value";
+    if (SCENE_CHURN == eScene)
+    {
+        mapHeader[":path"] = "/api/v1/items?page=" + std::to_string(iSeq);
+        mapHeader["cookie"] = "session=" + std::to_string(1000000007LL * iSeq) + "; theme=dark";
+        mapHeader["x-request-id"] = std::to_string(iSeq) + "-1f2a-4b6c-8d0e-2f4a6b8c0d1e";
+    }
+}
+
+static bool Run(const char* szName, E_SCENE eScene, bool bWithHuffman, int iBlockNum,
+        std::shared_ptr<NetLogger> pLogger)
+{
+    typedef std::chrono::steady_clock clock;
+    std::vector<HttpMsg> vecRequest(iBlockNum);
+    for (int i = 0; i < iBlockNum; ++i)
+    {
+        MakeRequest(eScene, i, bWithHuffman, vecRequest[i]);
+    }
+
+    std::vector<CBuffer> vecBlock(iBlockNum);
+    std::unique_ptr<CodecHttp2> pEncoder(new CodecHttp2(pLogger, CODEC_HTTP));
+    clock::time_point oBegin = clock::now();
+    for (int i = 0; i < iBlockNum; ++i)
+    {
+        if (SCENE_COLD == eScene)
+        {
+            pEncoder.reset(new CodecHttp2(pLogger, CODEC_HTTP));
+        }
+        pEncoder->PackHeader(vecRequest[i], &vecBlock[i]);
+    }
+    double dEncodeNs = std::chrono::duration<double, std::nano>(clock::now() - oBegin).count() / iBlockNum;
+
+    size_t uiBytes = 0;
+    for (auto& oBlock : vecBlock)
+    {
+        uiBytes += oBlock.ReadableBytes();
+    }
+
+    std::vector<HttpMsg> vecDecoded(iBlockNum);
+    std::unique_ptr<CodecHttp2> pDecoder(new CodecHttp2(pLogger, CODEC_HTTP));
+    bool bOk = true;
+    oBegin = clock::now();
+    for (int i = 0; i < iBlockNum; ++i)
+    {
+        if (SCENE_COLD == eScene)
+        {
+            pDecoder.reset(new CodecHttp2(pLogger, CODEC_HTTP));
+        }
+        if (CODEC_STATUS_PART_OK != pDecoder->UnpackHeader(vecBlock[i].GetWriteIndex(), &vecBlock[i], vecDecoded[i]))
+        {
+            bOk = false;
+            break;
+        }
+    }
+    double dDecodeNs = std::chrono::duration<double, std::nano>(clock::now() - oBegin).count() / iBlockNum;
+
+    for (int i = 0; bOk && i < iBlockNum; ++i)
+    {
+        for (auto& oHeader : vecRequest[i].headers())
+        {
+            auto iter = vecDecoded[i].headers().find(oHeader.first);
+            if (iter == vecDecoded[i].headers().end() || iter->second != oHeader.second)
+            {
+                bOk = false;
+                break;
+            }
+        }
+    }
+
+    printf("%-8s %-8s %7.1f bytes/block  encode %8.1f ns  decode %8.1f ns  %s\n",
+            szName, bWithHuffman ? "huffman" : "raw", (double)uiBytes / iBlockNum,
+            dEncodeNs, dDecodeNs, bOk ? "results match" : "RESULTS DIFFER");
+    return(bOk);
+}
+
+int main(int argc, char* argv[])
+{
+    int iBlockNum = (argc > 1) ? atoi(argv[1]) : 100000;
+    char szDir[] = "/tmp/neb_hpack_bench_XXXXXX";
+    if (NULL == mkdtemp(szDir))
+    {
+        perror("mkdtemp");
+        return(1);
+    }
+    std::string strLogFile = std::string(szDir) + "/bench.log";
+    bool bOk = true;
+    {
+        std::shared_ptr<NetLogger> pLogger = std::make_shared<NetLogger>(strLogFile, Logger::FATAL);
+        printf("HPACK: %d header blocks of 13 request headers, time per block\n", iBlockNum);
+        for (int i = 0; i < 2; ++i)
+        {
+            bOk = Run("cold", SCENE_COLD, (i == 1), iBlockNum, pLogger) && bOk;
+            bOk = Run("repeat", SCENE_REPEAT, (i == 1), iBlockNum, pLogger) && bOk;
+            bOk = Run("churn", SCENE_CHURN, (i == 1), iBlockNum, pLogger) && bOk;
+        }
+    }
+    unlink(strLogFile.c_str());
+    rmdir(szDir);
+    return(bOk ? 0 : 1);
+}
@@ -0,0 +1,118 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     HttpEncodeBench.cpp
+ * @brief    小包体http响应的编码耗时：逐个添加的头与预先序列化的头（HttpMsg.header_block）对比
+ * @author   Bwar
+ * @date:    2026年10月18日
+ * @note     模拟Module对每个请求返回一个小包体（"hello world"）的响应，每个响应带5个固定的
+ * 头（Content-Type、Cache-Control、X-Frame-Options、X-Content-Type-Options、Vary，
+ * 不含编码器自动添加的Connection、Server、Allow）：
+ * 1. headers：每个响应重新填充headers字段，编码时逐个写入；
+ * 2. header_block：固定的头预先序列化一次，每个响应只设置header_block。
+ * 两者都包括构造响应消息和CodecHttp::Encode()，编码结果写入同一个CBuffer后丢弃，
+ * 编码结果除头的顺序外相同。
+ * 用法：HttpEncodeBench [响应数]
+ * Modify history:
+ ******************************************************************************/
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <unistd.h>
+#include "codec/CodecHttp.hpp"
+#include "logger/NetLogger.hpp"
+#include "util/CBuffer.hpp"
+
+using namespace neb;
+
+typedef std::chrono::steady_clock clock_type;
+
+static double Ms(clock_type::time_point oBegin, clock_type::time_point oEnd)
+{
+    return(std::chrono::duration<double, std::milli>(oEnd - oBegin).count());
+}
+
+static const char* s_aszHeader[][2] = {
+    {"Content-Type", "text/plain; charset=utf-8"},
+    {"Cache-Control", "no-cache"},
+    {"X-Frame-Options", "DENY"},
+    {"X-Content-Type-Options", "nosniff"},
+    {"Vary", "Accept-Encoding"},
+};
+
+template <typename FILL>
+static double EncodeLoop(CodecHttp& oCodec, int iNum, size_t& uiBytes, FILL&& fnFill)
+{
+    HttpMsg oHttpMsg;
+    CBuffer oBuff;
+    uiBytes = 0;
+    clock_type::time_point oBegin = clock_type::now();
+    for (int i = 0; i < iNum; ++i)
+    {
+        oHttpMsg.Clear();
+        oHttpMsg.set_type(HTTP_RESPONSE);
+        oHttpMsg.set_http_major(1);
+        oHttpMsg.set_http_minor(1);
+        oHttpMsg.set_status_code(200);
+        fnFill(oHttpMsg);
+        oHttpMsg.set_body("hello world");
+        if (CODEC_STATUS_OK != oCodec.Encode(oHttpMsg, &oBuff))
+        {
+            return(-1.0);
+        }
+        uiBytes += oBuff.ReadableBytes();
+        oBuff.Clear();
+    }
+    return(Ms(oBegin, clock_type::now()));
+}
+
+int main(int argc, char* argv[])
+{
+    int iNum = (argc > 1) ? atoi(argv[1]) : 1000000;
+    if (iNum <= 0)
+    {
+        fprintf(stderr, "usage: %s [responses]\n", argv[0]);
+        return(1);
+    }
+    char szDir[] = "/tmp/neb_http_encode_bench_XXXXXX";
+    if (NULL == mkdtemp(szDir))
+    {
+        perror("mkdtemp");
+        return(1);
+    }
+    std::string strLogFile = std::string(szDir) + "/bench.log";
+    bool bOk = true;
+    {
+        std::shared_ptr<NetLogger> pLogger = std::make_shared<NetLogger>(strLogFile, Logger::FATAL);
+        CodecHttp oCodec(pLogger, CODEC_HTTP);
+        std::string strHeaderBlock;
+        for (auto& aszHeader : s_aszHeader)
+        {
+            strHeaderBlock += std::string(aszHeader[0]) + ": " + aszHeader[1] + "\r\n";
+        }
+        printf("HttpEncode: %d responses with a %zu byte body\n", iNum, sizeof("hello world") - 1);
+
+        size_t uiHeadersBytes = 0;
+        double dHeaders = EncodeLoop(oCodec, iNum, uiHeadersBytes, [](HttpMsg& oHttpMsg)
+                {
+                    auto& mapHeader = *oHttpMsg.mutable_headers();
+                    for (auto& aszHeader : s_aszHeader)
+                    {
+                        mapHeader[aszHeader[0]] = aszHeader[1];
+                    }
+                });
+        size_t uiBlockBytes = 0;
+        double dBlock = EncodeLoop(oCodec, iNum, uiBlockBytes, [&strHeaderBlock](HttpMsg& oHttpMsg)
+                {
+                    oHttpMsg.set_header_block(strHeaderBlock);
+                });
+        bOk = (dHeaders >= 0.0 && dBlock >= 0.0 && uiHeadersBytes == uiBlockBytes);
+        printf("%-14s %8.1f ns/response  %zu bytes/response\n", "headers",
+                dHeaders * 1000000.0 / iNum, uiHeadersBytes / iNum);
+        printf("%-14s %8.1f ns/response  %zu bytes/response\n", "header_block",
+                dBlock * 1000000.0 / iNum, uiBlockBytes / iNum);
+    }
+    unlink(strLogFile.c_str());
+    rmdir(szDir);
+    return(bOk ? 0 : 1);
+}
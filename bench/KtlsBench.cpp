@@ -0,0 +1,240 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     KtlsBench.cpp
+ * @brief    TLS发送吞吐量：kTLS与SSL_write()用户态加密对比
+ * @author   Bwar
+ * @date:    2026年10月18日
+ * @note     在回环地址上建立TLS 1.3（TLS_AES_128_GCM_SHA256）连接，客户端线程以固定块大小
+ * 调用SSL_write()发送，服务端SSL_read()接收并丢弃，统计吞吐量和进程CPU时间：
+ * 1. SSL_write：不开启kTLS，记录在OpenSSL中加密后write()；
+ * 2. kTLS：两端开启SSL_OP_ENABLE_KTLS（与SocketChannelSslImpl::SslEnableKtls()相同），
+ *    握手后SSL_write()直接交给内核加密。
+ * SocketChannelSslImpl::KtlsProbe()探测内核不支持kTLS（没有tls模块）时跳过全部测试；
+ * 握手后发送方向未能开启kTLS（内核不支持协商到的加密套件）时跳过kTLS一项。
+ * 需以WITH_OPENSSL编译（make with_openssl=y bench），否则直接跳过。
+ * 用法：KtlsBench [发送MB数] [每次写入字节数]
+ * Modify history:
+ ******************************************************************************/
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#ifdef WITH_OPENSSL
+#include "channel/SocketChannelSslImpl.hpp"
+#endif
+
+#if defined(WITH_OPENSSL) && defined(SSL_OP_ENABLE_KTLS)
+
+using namespace neb;
+
+typedef std::chrono::steady_clock clock_type;
+
+static double Ms(clock_type::time_point oBegin, clock_type::time_point oEnd)
+{
+    return(std::chrono::duration<double, std::milli>(oEnd - oBegin).count());
+}
+
+static double CpuMs()
+{
+    struct timespec stTime;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &stTime);
+    return(stTime.tv_sec * 1000.0 + stTime.tv_nsec / 1000000.0);
+}
+
+/**
+ * @brief 生成自签名证书（P-256），只用于本测试
+ */
+static bool MakeCert(EVP_PKEY*& pKey, X509*& pCert)
+{
+    pKey = EVP_EC_gen("P-256");
+    pCert = X509_new();
+    if (NULL == pKey || NULL == pCert)
+    {
+        return(false);
+    }
+    ASN1_INTEGER_set(X509_get_serialNumber(pCert), 1);
+    X509_gmtime_adj(X509_getm_notBefore(pCert), 0);
+    X509_gmtime_adj(X509_getm_notAfter(pCert), 3600);
+    X509_set_pubkey(pCert, pKey);
+    X509_NAME* pName = X509_get_subject_name(pCert);
+    X509_NAME_add_entry_by_txt(pName, "CN", MBSTRING_ASC, (const unsigned char*)"localhost", -1, -1, 0);
+    X509_set_issuer_name(pCert, pName);
+    return(X509_sign(pCert, pKey, EVP_sha256()) > 0);
+}
+
+static SSL_CTX* MakeCtx(bool bServer, bool bKtls, EVP_PKEY* pKey, X509* pCert)
+{
+    SSL_CTX* pCtx = SSL_CTX_new(bServer ? TLS_server_method() : TLS_client_method());
+    SSL_CTX_set_min_proto_version(pCtx, TLS1_3_VERSION);
+    SSL_CTX_set_ciphersuites(pCtx, "TLS_AES_128_GCM_SHA256");
+    if (bServer)
+    {
+        SSL_CTX_use_certificate(pCtx, pCert);
+        SSL_CTX_use_PrivateKey(pCtx, pKey);
+        SSL_CTX_set_num_tickets(pCtx, 0);   // 握手后不再有ticket记录，接收方向也可开启kTLS
+    }
+    if (bKtls)
+    {
+        SSL_CTX_set_options(pCtx, SSL_OP_ENABLE_KTLS);
+    }
+    return(pCtx);
+}
+
+static bool TcpPair(int& iServerFd, int& iClientFd)
+{
+    int iListenFd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in stAddr;
+    memset(&stAddr, 0, sizeof(stAddr));
+    stAddr.sin_family = AF_INET;
+    stAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t uiAddrLen = sizeof(stAddr);
+    if (bind(iListenFd, (struct sockaddr*)&stAddr, sizeof(stAddr)) < 0 || listen(iListenFd, 1) < 0
+            || getsockname(iListenFd, (struct sockaddr*)&stAddr, &uiAddrLen) < 0)
+    {
+        close(iListenFd);
+        return(false);
+    }
+    iClientFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (connect(iClientFd, (struct sockaddr*)&stAddr, sizeof(stAddr)) < 0)
+    {
+        close(iListenFd);
+        close(iClientFd);
+        return(false);
+    }
+    iServerFd = accept(iListenFd, NULL, NULL);
+    close(iListenFd);
+    return(iServerFd >= 0);
+}
+
+/**
+ * @return 0成功，1失败，-1未能开启kTLS（跳过）
+ */
+static int Run(const char* szMode, bool bKtls, EVP_PKEY* pKey, X509* pCert, size_t uiTotal, size_t uiChunk)
+{
+    int iServerFd = -1;
+    int iClientFd = -1;
+    if (!TcpPair(iServerFd, iClientFd))
+    {
+        fprintf(stderr, "loopback connect error %d: %s\n", errno, strerror(errno));
+        return(1);
+    }
+    SSL_CTX* pServerCtx = MakeCtx(true, bKtls, pKey, pCert);
+    SSL_CTX* pClientCtx = MakeCtx(false, bKtls, pKey, pCert);
+    SSL* pServer = SSL_new(pServerCtx);
+    SSL* pClient = SSL_new(pClientCtx);
+    SSL_set_fd(pServer, iServerFd);
+    SSL_set_fd(pClient, iClientFd);
+
+    int iConnect = 0;
+    std::thread oHandshake([&]{ iConnect = SSL_connect(pClient); });
+    int iAccept = SSL_accept(pServer);
+    oHandshake.join();
+    int iResult = 0;
+    if (iAccept != 1 || iConnect != 1)
+    {
+        fprintf(stderr, "%s: handshake failed\n", szMode);
+        ERR_print_errors_fp(stderr);
+        iResult = 1;
+    }
+    else if (bKtls && BIO_get_ktls_send(SSL_get_wbio(pClient)) <= 0)
+    {
+        printf("%-10s skipped: kernel did not accept the negotiated cipher for ktls\n", szMode);
+        iResult = -1;
+    }
+    else
+    {
+        bool bKtlsRecv = (BIO_get_ktls_recv(SSL_get_rbio(pServer)) > 0);
+        size_t uiSent = 0;
+        size_t uiRecv = 0;
+        std::vector<char> vecSend(uiChunk, 'x');
+        std::vector<char> vecRecv(64 * 1024);
+        double dCpuBegin = CpuMs();
+        clock_type::time_point oBegin = clock_type::now();
+        std::thread oSender([&]
+                {
+                    while (uiSent < uiTotal)
+                    {
+                        int iWrite = SSL_write(pClient, vecSend.data(), (int)vecSend.size());
+                        if (iWrite <= 0)
+                        {
+                            break;
+                        }
+                        uiSent += iWrite;
+                    }
+                });
+        while (uiRecv < uiTotal)
+        {
+            int iRead = SSL_read(pServer, vecRecv.data(), (int)vecRecv.size());
+            if (iRead <= 0)
+            {
+                break;
+            }
+            uiRecv += iRead;
+        }
+        oSender.join();
+        double dElapsed = Ms(oBegin, clock_type::now());
+        double dCpu = CpuMs() - dCpuBegin;
+        printf("%-10s %9.1f MB/s  cpu %8.1f ms for %zu MB  (recv %s)\n", szMode,
+                uiRecv / 1048576.0 * 1000.0 / dElapsed, dCpu, uiTotal >> 20,
+                bKtlsRecv ? "ktls" : "SSL_read");
+        iResult = (uiRecv >= uiTotal) ? 0 : 1;
+    }
+    SSL_free(pServer);
+    SSL_free(pClient);
+    SSL_CTX_free(pServerCtx);
+    SSL_CTX_free(pClientCtx);
+    close(iServerFd);
+    close(iClientFd);
+    return(iResult);
+}
+
+int main(int argc, char* argv[])
+{
+    size_t uiTotalMb = (argc > 1) ? atoi(argv[1]) : 512;
+    size_t uiChunk = (argc > 2) ? atoi(argv[2]) : 16384;
+    if (0 == uiTotalMb || 0 == uiChunk)
+    {
+        fprintf(stderr, "usage: %s [megabytes] [write_size]\n", argv[0]);
+        return(1);
+    }
+    int iErrno = 0;
+    if (!SocketChannelSslImpl::KtlsProbe(iErrno))
+    {
+        printf("KtlsBench: skipped, ktls is not supported by the kernel (setsockopt TCP_ULP \"tls\": %s)\n",
+                strerror(iErrno));
+        return(0);
+    }
+    EVP_PKEY* pKey = NULL;
+    X509* pCert = NULL;
+    if (!MakeCert(pKey, pCert))
+    {
+        fprintf(stderr, "failed to create certificate\n");
+        ERR_print_errors_fp(stderr);
+        return(1);
+    }
+    printf("KtlsBench: %zu MB in %zu byte writes, TLS 1.3 AES-128-GCM over loopback\n", uiTotalMb, uiChunk);
+    int iResult = Run("SSL_write", false, pKey, pCert, uiTotalMb << 20, uiChunk);
+    int iKtlsResult = Run("ktls", true, pKey, pCert, uiTotalMb << 20, uiChunk);
+    X509_free(pCert);
+    EVP_PKEY_free(pKey);
+    return((iResult > 0 || iKtlsResult > 0) ? 1 : 0);
+}
+
+#else
+
+int main()
+{
+    printf("KtlsBench: skipped, built without WITH_OPENSSL or with an OpenSSL version lacking ktls\n");
+    return(0);
+}
+
+#endif
@@ -0,0 +1,141 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     LogLevelBench.cpp
+ * @brief    LOG4_*宏在日志级别关闭时的调用开销
+ * @author   Bwar
+ * @date:    2026年10月18日
+ * @note     日志参数取一个需要计算的值（消息体数据的十六进制串），对比：
+ * 1. 直接调用WriteLog()（宏改造前的路径：先求值参数，再在WriteLog()内判断级别）；
+ * 2. LOG4_TRACE()运行时级别关闭（先判断IsLogLevelEnabled()，不求值参数）；
+ * 3. LOG4_TRACE()编译期消除（NEB_MIN_LOG_LEVEL为5）；
+ * 4. LOG4_INFO()级别开启时实际写日志文件。
+ * 同时统计参数被求值的次数，以确认关闭的日志不求值参数。
+ * 用法：LogLevelBench [每项调用次数]
+ * Modify history:
+ ******************************************************************************/
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <unistd.h>
+#include "Definition.hpp"
+#include "logger/NetLogger.hpp"
+
+using namespace neb;
+
+static unsigned long long s_ullArgEvalNum = 0;
+
+__attribute__((noinline)) std::string HexDump(const std::string& strData)
+{
+    static const char sc_szHex[] = "0123456789abcdef";
+    ++s_ullArgEvalNum;
+    std::string strHex;
+    strHex.reserve(strData.size() * 2);
+    for (size_t i = 0; i < strData.size(); ++i)
+    {
+        strHex.push_back(sc_szHex[((unsigned char)strData[i]) >> 4]);
+        strHex.push_back(sc_szHex[((unsigned char)strData[i]) & 0x0F]);
+    }
+    return(strHex);
+}
+
+/**
+ * @brief 与Actor、Codec等相同，提供LOG4_*宏所需的Logger()和IsLogLevelEnabled()
+ */
+class LogCaller
+{
+public:
+    LogCaller(NetLogger* pLogger, const std::string& strData)
+        : m_pLogger(pLogger), m_strData(strData)
+    {
+    }
+
+    template <typename ...Targs>
+    void Logger(int iLogLevel, const char* szFileName, unsigned int uiFileLine, const char* szFunction, Targs&&... args)
+    {
+        m_pLogger->WriteLog(iLogLevel, szFileName, uiFileLine, szFunction, std::forward<Targs>(args)...);
+    }
+
+    bool IsLogLevelEnabled(int iLogLevel) const
+    {
+        return(m_pLogger->IsLevelEnabled(iLogLevel));
+    }
+
+    __attribute__((noinline)) void DirectWriteLog(unsigned int uiSeq)
+    {
+        m_pLogger->WriteLog(neb::Logger::TRACE, __FILE__, __LINE__, __FUNCTION__,
+                "seq %u, data %s", uiSeq, HexDump(m_strData).c_str());
+    }
+
+    __attribute__((noinline)) void RuntimeDisabled(unsigned int uiSeq)
+    {
+        LOG4_TRACE("seq %u, data %s", uiSeq, HexDump(m_strData).c_str());
+    }
+
+    __attribute__((noinline)) void Enabled(unsigned int uiSeq)
+    {
+        LOG4_INFO("seq %u, data %s", uiSeq, HexDump(m_strData).c_str());
+    }
+
+    void CompiledOut(unsigned int uiSeq);
+
+private:
+    NetLogger* m_pLogger;
+    std::string m_strData;
+};
+
+// 以下代码等同于 make min_log_level=5 编译
+#undef NEB_MIN_LOG_LEVEL
+#define NEB_MIN_LOG_LEVEL 5
+
+__attribute__((noinline)) void LogCaller::CompiledOut(unsigned int uiSeq)
+{
+    LOG4_TRACE("seq %u, data %s", uiSeq, HexDump(m_strData).c_str());
+}
+
+template <typename F>
+void Measure(const char* szName, unsigned int uiCallNum, F fCall)
+{
+    typedef std::chrono::steady_clock clock;
+    s_ullArgEvalNum = 0;
+    clock::time_point oBegin = clock::now();
+    for (unsigned int i = 0; i < uiCallNum; ++i)
+    {
+        fCall(i);
+    }
+    double dNs = std::chrono::duration<double, std::nano>(clock::now() - oBegin).count();
+    printf("%-36s %10.1f ns/call   args evaluated %llu times\n", szName, dNs / uiCallNum, s_ullArgEvalNum);
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned int uiCallNum = (argc > 1) ? (unsigned int)atoi(argv[1]) : 1000000;
+    char szDir[] = "/tmp/neb_loglevel_bench_XXXXXX";
+    if (NULL == mkdtemp(szDir))
+    {
+        perror("mkdtemp");
+        return(1);
+    }
+    std::string strLogFile = std::string(szDir) + "/bench.log";
+    int iRet = 0;
+    {
+        NetLogger oLogger(strLogFile, neb::Logger::INFO, 1024 * 1024 * 1024, 1, gc_uiMaxLogLineLen, false);
+        LogCaller oCaller(&oLogger, std::string(256, 'n'));
+        printf("LOG4_* cost, log level INFO, 256 bytes of data hex-dumped as the argument, %u calls each\n", uiCallNum);
+        Measure("WriteLog(TRACE) direct, disabled", uiCallNum, [&oCaller](unsigned int i){ oCaller.DirectWriteLog(i); });
+        unsigned long long ullDirectEval = s_ullArgEvalNum;
+        Measure("LOG4_TRACE runtime disabled", uiCallNum, [&oCaller](unsigned int i){ oCaller.RuntimeDisabled(i); });
+        unsigned long long ullRuntimeEval = s_ullArgEvalNum;
+        Measure("LOG4_TRACE NEB_MIN_LOG_LEVEL=5", uiCallNum, [&oCaller](unsigned int i){ oCaller.CompiledOut(i); });
+        unsigned long long ullCompiledEval = s_ullArgEvalNum;
+        Measure("LOG4_INFO enabled, written", uiCallNum / 10, [&oCaller](unsigned int i){ oCaller.Enabled(i); });
+        if (ullDirectEval != uiCallNum || ullRuntimeEval != 0 || ullCompiledEval != 0)
+        {
+            fprintf(stderr, "unexpected argument evaluation count\n");
+            iRet = 1;
+        }
+    }
+    unlink(strLogFile.c_str());
+    rmdir(szDir);
+    return(iRet);
+}
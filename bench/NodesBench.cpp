@@ -0,0 +1,155 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     NodesBench.cpp
+ * @brief    Nodes三种分布方式的查找耗时、负载均衡和增删节点的迁移比例
+ * @author   Bwar
+ * @date:    2026年10月18日
+ * @note     对hash环（200虚拟节点）、Maglev和jump consistent hash分别统计：
+ * 1. 按字符串hash key查找和按uint32 hash值查找的耗时；
+ * 2. 各节点分得key数的最大值与平均值之比；
+ * 3. 增加一个节点、删除字典序末尾节点和删除中间节点时改变归属的key比例，
+ *    理想值为1/(N+1)和1/N。
+ * 用法：NodesBench [节点数] [key数]
+ * Modify history:
+ ******************************************************************************/
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "ios/Nodes.hpp"
+
+using namespace neb;
+
+static const char* s_szNodeType = "LOGIC";
+static const char* s_szDistribution[] = {"hash_ring", "maglev", "jump"};
+
+static std::string NodeIdentify(int i)
+{
+    char szIdentify[32];
+    snprintf(szIdentify, sizeof(szIdentify), "192.168.1.%d:16001.%d", 10 + i, i % 4);
+    return(szIdentify);
+}
+
+static void Assign(Nodes& oNodes, const std::vector<std::string>& vecKey, std::vector<const std::string*>& vecOwner)
+{
+    vecOwner.resize(vecKey.size());
+    for (size_t i = 0; i < vecKey.size(); ++i)
+    {
+        const std::string* pNode = nullptr;
+        oNodes.GetNode(s_szNodeType, vecKey[i], pNode);
+        vecOwner[i] = pNode;
+    }
+}
+
+/**
+ * @brief 两次分配中归属不同的key比例（比较节点标识而非指针，节点增删后指针可能变化）
+ */
+static double Moved(const std::vector<std::string>& vecBefore, const std::vector<const std::string*>& vecAfter)
+{
+    size_t uiMoved = 0;
+    for (size_t i = 0; i < vecBefore.size(); ++i)
+    {
+        if (nullptr == vecAfter[i] || vecBefore[i] != *vecAfter[i])
+        {
+            ++uiMoved;
+        }
+    }
+    return((double)uiMoved / vecBefore.size());
+}
+
+static std::vector<std::string> Snapshot(const std::vector<const std::string*>& vecOwner)
+{
+    std::vector<std::string> vecSnapshot;
+    vecSnapshot.reserve(vecOwner.size());
+    for (auto p : vecOwner)
+    {
+        vecSnapshot.push_back((nullptr == p) ? std::string() : *p);
+    }
+    return(vecSnapshot);
+}
+
+int main(int argc, char* argv[])
+{
+    typedef std::chrono::steady_clock clock;
+    int iNodeNum = (argc > 1) ? atoi(argv[1]) : 16;
+    int iKeyNum = (argc > 2) ? atoi(argv[2]) : 200000;
+    std::vector<std::string> vecKey;
+    vecKey.reserve(iKeyNum);
+    for (int i = 0; i < iKeyNum; ++i)
+    {
+        vecKey.push_back("user:" + std::to_string(i * 7919 + 13));
+    }
+
+    printf("Nodes: %d nodes, %d keys; ideal churn add %.4f, remove %.4f\n",
+            iNodeNum, iKeyNum, 1.0 / (iNodeNum + 1), 1.0 / iNodeNum);
+    printf("%-10s %12s %12s %9s %10s %12s %12s\n",
+            "dist", "key ns/op", "hash ns/op", "max/avg", "add", "del(last)", "del(middle)");
+    for (int iDistribution = DISTRIBUTION_HASH_RING; iDistribution <= DISTRIBUTION_JUMP; ++iDistribution)
+    {
+        Nodes oNodes(HASH_murmur3_32, 200, iDistribution);
+        for (int i = 0; i < iNodeNum; ++i)
+        {
+            oNodes.AddNode(s_szNodeType, NodeIdentify(i));
+        }
+
+        std::vector<const std::string*> vecOwner;
+        Assign(oNodes, vecKey, vecOwner);     // 预热（Maglev表等在首次查找时构建）
+        clock::time_point oBegin = clock::now();
+        Assign(oNodes, vecKey, vecOwner);
+        double dKeyNs = std::chrono::duration<double, std::nano>(clock::now() - oBegin).count() / iKeyNum;
+
+        uint32 uiChecksum = 0;
+        oBegin = clock::now();
+        for (int i = 0; i < iKeyNum; ++i)
+        {
+            const std::string* pNode = nullptr;
+            oNodes.GetNode(s_szNodeType, (uint32)(i * 2654435761u), pNode);
+            uiChecksum += (nullptr == pNode) ? 0 : pNode->size();
+        }
+        double dHashNs = std::chrono::duration<double, std::nano>(clock::now() - oBegin).count() / iKeyNum;
+
+        std::unordered_map<std::string, int> mapLoad;
+        for (auto p : vecOwner)
+        {
+            ++mapLoad[(nullptr == p) ? std::string() : *p];
+        }
+        int iMaxLoad = 0;
+        for (auto& load : mapLoad)
+        {
+            iMaxLoad = (load.second > iMaxLoad) ? load.second : iMaxLoad;
+        }
+        double dImbalance = (double)iMaxLoad / ((double)iKeyNum / iNodeNum);
+
+        std::vector<std::string> vecBase = Snapshot(vecOwner);
+        oNodes.AddNode(s_szNodeType, NodeIdentify(iNodeNum));
+        Assign(oNodes, vecKey, vecOwner);
+        double dAdd = Moved(vecBase, vecOwner);
+        oNodes.DelNode(s_szNodeType, NodeIdentify(iNodeNum));
+
+        // NodeIdentify()按编号递增，字典序末尾节点取编号最大的一个
+        std::string strLast = NodeIdentify(iNodeNum - 1);
+        for (int i = 0; i < iNodeNum; ++i)
+        {
+            strLast = (NodeIdentify(i) > strLast) ? NodeIdentify(i) : strLast;
+        }
+        Assign(oNodes, vecKey, vecOwner);
+        vecBase = Snapshot(vecOwner);
+        oNodes.DelNode(s_szNodeType, strLast);
+        Assign(oNodes, vecKey, vecOwner);
+        double dDelLast = Moved(vecBase, vecOwner);
+        oNodes.AddNode(s_szNodeType, strLast);
+
+        Assign(oNodes, vecKey, vecOwner);
+        vecBase = Snapshot(vecOwner);
+        oNodes.DelNode(s_szNodeType, NodeIdentify(iNodeNum / 2));
+        Assign(oNodes, vecKey, vecOwner);
+        double dDelMiddle = Moved(vecBase, vecOwner);
+
+        printf("%-10s %12.1f %12.1f %9.3f %10.4f %12.4f %12.4f%s\n",
+                s_szDistribution[iDistribution], dKeyNs, dHashNs, dImbalance, dAdd, dDelLast, dDelMiddle,
+                (0 == uiChecksum) ? "  (no node found)" : "");
+    }
+    return(0);
+}
@@ -0,0 +1,127 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     ResolverBench.cpp
+ * @brief    域名解析对事件循环的阻塞：同步getaddrinfo()与Resolver后台解析对比
+ * @author   Bwar
+ * @date:    2026年10月18日
+ * @note     以固定延时的桩解析函数模拟慢DNS，模拟事件循环逐个处理需连接域名的请求：
+ * 同步方式在循环中直接解析；Resolver方式查缓存、未命中时提交后台解析，并在后续循环
+ * 中取回结果。统计单次循环的最大耗时（事件循环被阻塞的最长时间）和全部解析完成的
+ * 耗时，以及缓存命中时Lookup()的耗时。
+ * 用法：ResolverBench [域名数] [单次解析延时毫秒]
+ * Modify history:
+ ******************************************************************************/
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <netinet/in.h>
+#include "ios/Resolver.hpp"
+
+using namespace neb;
+
+typedef std::chrono::steady_clock clock_type;
+
+static double Ms(clock_type::time_point oBegin, clock_type::time_point oEnd)
+{
+    return(std::chrono::duration<double, std::milli>(oEnd - oBegin).count());
+}
+
+int main(int argc, char* argv[])
+{
+    int iHostNum = (argc > 1) ? atoi(argv[1]) : 50;
+    int iDelayMs = (argc > 2) ? atoi(argv[2]) : 20;
+    std::vector<std::string> vecHost;
+    for (int i = 0; i < iHostNum; ++i)
+    {
+        vecHost.push_back("node" + std::to_string(i) + ".svc.test");
+    }
+    Resolver::resolve_function fnSlowDns = [iDelayMs](const std::string& strHost, std::vector<Resolver::tagAddress>& vecAddress)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(iDelayMs));
+        Resolver::tagAddress stAddress;
+        memset(&stAddress.stAddr, 0, sizeof(stAddress.stAddr));
+        ((struct sockaddr_in*)&stAddress.stAddr)->sin_family = AF_INET;
+        stAddress.uiAddrLen = sizeof(struct sockaddr_in);
+        vecAddress.push_back(stAddress);
+        return(0);
+    };
+    printf("Resolver: %d hosts, %d ms per resolution\n", iHostNum, iDelayMs);
+
+    // 同步解析：每次循环阻塞一次完整解析
+    double dMaxIteration = 0.0;
+    clock_type::time_point oStart = clock_type::now();
+    for (int i = 0; i < iHostNum; ++i)
+    {
+        clock_type::time_point oBegin = clock_type::now();
+        std::vector<Resolver::tagAddress> vecAddress;
+        fnSlowDns(vecHost[i], vecAddress);
+        double dIteration = Ms(oBegin, clock_type::now());
+        dMaxIteration = (dIteration > dMaxIteration) ? dIteration : dMaxIteration;
+    }
+    printf("%-22s max loop stall %9.3f ms, all resolved in %8.1f ms\n",
+            "sync getaddrinfo", dMaxIteration, Ms(oStart, clock_type::now()));
+
+    // 后台解析：循环中只查缓存和提交，完成通知后取回结果
+    Resolver oResolver;
+    std::atomic<int> iNotified(0);
+    oResolver.SetResolveFunction(fnSlowDns);
+    oResolver.SetNotifyFunction([&iNotified]{ ++iNotified; });
+    dMaxIteration = 0.0;
+    int iResolved = 0;
+    int iNext = 0;
+    unsigned long long ullIteration = 0;
+    oStart = clock_type::now();
+    while (iResolved < iHostNum)
+    {
+        clock_type::time_point oBegin = clock_type::now();
+        if (iNext < iHostNum)
+        {
+            Resolver::tagAddress stAddress;
+            int iErrCode = 0;
+            if (Resolver::RESOLVE_MISS == oResolver.Lookup(vecHost[iNext], 80, stAddress, iErrCode, 0.0))
+            {
+                oResolver.Resolve(vecHost[iNext]);
+            }
+            ++iNext;
+        }
+        if (iNotified.load() > 0)
+        {
+            std::vector<Resolver::tagResult> vecResult;
+            oResolver.FetchResult(vecResult);
+            for (auto& stResult : vecResult)
+            {
+                oResolver.Update(stResult, 0.0, 60.0);
+            }
+            iResolved += vecResult.size();
+        }
+        double dIteration = Ms(oBegin, clock_type::now());
+        dMaxIteration = (dIteration > dMaxIteration) ? dIteration : dMaxIteration;
+        ++ullIteration;
+        if (iNext >= iHostNum)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));   // 模拟处理其他事件
+        }
+    }
+    printf("%-22s max loop stall %9.3f ms, all resolved in %8.1f ms (%llu loop iterations)\n",
+            "Resolver (background)", dMaxIteration, Ms(oStart, clock_type::now()), ullIteration);
+
+    // 缓存命中
+    const int iLookupNum = 1000000;
+    int iHit = 0;
+    clock_type::time_point oBegin = clock_type::now();
+    for (int i = 0; i < iLookupNum; ++i)
+    {
+        Resolver::tagAddress stAddress;
+        int iErrCode = 0;
+        iHit += (Resolver::RESOLVE_HIT == oResolver.Lookup(vecHost[i % iHostNum], 80, stAddress, iErrCode, 1.0));
+    }
+    printf("%-22s %.1f ns/op, %d of %d hit\n", "cached Lookup()",
+            Ms(oBegin, clock_type::now()) * 1000000.0 / iLookupNum, iHit, iLookupNum);
+    oResolver.Stop();
+    return((iHit == iLookupNum) ? 0 : 1);
+}
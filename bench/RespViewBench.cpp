@@ -0,0 +1,157 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     RespViewBench.cpp
+ * @brief    RespView直接遍历与转换为RedisReply后遍历的耗时对比
+ * @author   Bwar
+ * @date:    2026年10月18日
+ * @note     对10000个元素的数组回复（bulk string数组如LRANGE、integer数组、
+ * SCAN形式的嵌套数组）分别以RespView::Iterator遍历和ToRedisReply()后遍历，
+ * 统计每次回复的耗时和吞吐，并核对两种方式得到的结果一致。
+ * 用法：RespViewBench [元素数] [重复次数]
+ * Modify history:
+ ******************************************************************************/
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include "codec/RespView.hpp"
+#include "pb/redis.pb.h"
+
+using namespace neb;
+
+struct tagDigest
+{
+    uint64 ullElementNum = 0;
+    uint64 ullBytes = 0;
+    int64 llSum = 0;
+
+    bool operator==(const tagDigest& stOther) const
+    {
+        return(ullElementNum == stOther.ullElementNum && ullBytes == stOther.ullBytes && llSum == stOther.llSum);
+    }
+};
+
+static void DigestView(const RespView& oView, tagDigest& stDigest)
+{
+    if (oView.IsAggregate())
+    {
+        RespView::Iterator oIter = oView.Begin();
+        RespView oElement;
+        while (oIter.Next(oElement))
+        {
+            DigestView(oElement, stDigest);
+        }
+        return;
+    }
+    ++stDigest.ullElementNum;
+    if (RespView::RESP_TYPE_INTEGER == oView.Type())
+    {
+        stDigest.llSum += oView.Integer();
+    }
+    else
+    {
+        stDigest.ullBytes += oView.Size();
+    }
+}
+
+static void DigestReply(const RedisReply& oReply, tagDigest& stDigest)
+{
+    if (oReply.element_size() > 0)
+    {
+        for (int i = 0; i < oReply.element_size(); ++i)
+        {
+            DigestReply(oReply.element(i), stDigest);
+        }
+        return;
+    }
+    ++stDigest.ullElementNum;
+    if (oReply.str().empty())
+    {
+        stDigest.llSum += oReply.integer();
+    }
+    else
+    {
+        stDigest.ullBytes += oReply.str().size();
+    }
+}
+
+static std::string BulkArray(int iNum)
+{
+    std::string strFrame = "*" + std::to_string(iNum) + "\r\n";
+    for (int i = 0; i < iNum; ++i)
+    {
+        std::string strValue = "item:" + std::to_string(i) + ":" + std::string(16 + i % 48, 'v');
+        strFrame += "$" + std::to_string(strValue.size()) + "\r\n" + strValue + "\r\n";
+    }
+    return(strFrame);
+}
+
+static std::string IntegerArray(int iNum)
+{
+    std::string strFrame = "*" + std::to_string(iNum) + "\r\n";
+    for (int i = 0; i < iNum; ++i)
+    {
+        strFrame += ":" + std::to_string((int64)i * 7919 + 1) + "\r\n";
+    }
+    return(strFrame);
+}
+
+static std::string ScanReply(int iNum)
+{
+    std::string strFrame = "*2\r\n$4\r\n4096\r\n*" + std::to_string(iNum) + "\r\n";
+    for (int i = 0; i < iNum; ++i)
+    {
+        std::string strKey = "session:" + std::to_string(i * 31 + 7);
+        strFrame += "$" + std::to_string(strKey.size()) + "\r\n" + strKey + "\r\n";
+    }
+    return(strFrame);
+}
+
+static bool Run(const char* szName, const std::string& strFrame, int iRepeat)
+{
+    typedef std::chrono::steady_clock clock;
+    tagDigest stViewDigest;
+    clock::time_point oBegin = clock::now();
+    for (int i = 0; i < iRepeat; ++i)
+    {
+        RespView oView;
+        if (CODEC_STATUS_OK != RespView::Parse(strFrame.data(), strFrame.size(), oView))
+        {
+            fprintf(stderr, "%s: parse failed\n", szName);
+            return(false);
+        }
+        stViewDigest = tagDigest();
+        DigestView(oView, stViewDigest);
+    }
+    double dViewUs = std::chrono::duration<double, std::micro>(clock::now() - oBegin).count() / iRepeat;
+
+    tagDigest stReplyDigest;
+    oBegin = clock::now();
+    for (int i = 0; i < iRepeat; ++i)
+    {
+        RespView oView;
+        RespView::Parse(strFrame.data(), strFrame.size(), oView);
+        RedisReply oReply;
+        oView.ToRedisReply(oReply);
+        stReplyDigest = tagDigest();
+        DigestReply(oReply, stReplyDigest);
+    }
+    double dReplyUs = std::chrono::duration<double, std::micro>(clock::now() - oBegin).count() / iRepeat;
+
+    bool bSame = (stViewDigest == stReplyDigest);
+    printf("%-16s %8zu bytes  view %9.1f us (%7.1f MB/s)  RedisReply %9.1f us (%7.1f MB/s)  x%.1f  %s\n",
+            szName, strFrame.size(), dViewUs, strFrame.size() / dViewUs, dReplyUs, strFrame.size() / dReplyUs,
+            dReplyUs / dViewUs, bSame ? "results match" : "RESULTS DIFFER");
+    return(bSame);
+}
+
+int main(int argc, char* argv[])
+{
+    int iNum = (argc > 1) ? atoi(argv[1]) : 10000;
+    int iRepeat = (argc > 2) ? atoi(argv[2]) : 200;
+    printf("RespView: %d-element replies, %d runs each, parse + walk every element\n", iNum, iRepeat);
+    bool bOk = Run("bulk array", BulkArray(iNum), iRepeat);
+    bOk = Run("integer array", IntegerArray(iNum), iRepeat) && bOk;
+    bOk = Run("scan reply", ScanReply(iNum), iRepeat) && bOk;
+    return(bOk ? 0 : 1);
+}
@@ -95,14 +95,37 @@
         }               \
     } while(0)
 
-#define LOG4_FATAL(args...) Logger(neb::Logger::FATAL, __FILE__, __LINE__, __FUNCTION__, ##args)
-#define LOG4_ERROR(args...) Logger(neb::Logger::ERROR, __FILE__, __LINE__, __FUNCTION__, ##args)
-#define LOG4_WARNING(args...) Logger(neb::Logger::WARNING, __FILE__, __LINE__, __FUNCTION__, ##args)
-#define LOG4_NOTICE(args...) Logger(neb::Logger::NOTICE, __FILE__, __LINE__, __FUNCTION__, ##args)
-#define LOG4_INFO(args...) Logger(neb::Logger::INFO, __FILE__, __LINE__, __FUNCTION__, ##args)
-#define LOG4_CRITICAL(args...) Logger(neb::Logger::CRITICAL, __FILE__, __LINE__, __FUNCTION__, ##args)
-#define LOG4_DEBUG(args...) Logger(neb::Logger::DEBUG, __FILE__, __LINE__, __FUNCTION__, ##args)
-#define LOG4_TRACE(args...) Logger(neb::Logger::TRACE, __FILE__, __LINE__, __FUNCTION__, ##args)
+/**
+ * @brief 编译期最低日志级别
+ * @note 取值同neb::Logger::LogLev（0 FATAL ~ 7 TRACE），级别数值大于此值的LOG4_*调用连同参数
+ * 求值在编译期消除（如 make min_log_level=5 时不编译DEBUG和TRACE日志）。
+ */
+#ifndef NEB_MIN_LOG_LEVEL
+#define NEB_MIN_LOG_LEVEL 7
+#endif
+
+/**
+ * @brief 日志宏
+ * @note 先判断编译期级别和运行时级别（IsLogLevelEnabled()），不输出的日志不求值参数。
+ * 调用处须有Logger()和IsLogLevelEnabled()成员（Actor、Dispatcher、Codec等）。
+ */
+#define NEB_LOG(iLev, args...) \
+    do \
+    { \
+        if ((iLev) <= NEB_MIN_LOG_LEVEL && IsLogLevelEnabled(iLev)) \
+        { \
+            Logger(iLev, __FILE__, __LINE__, __FUNCTION__, ##args); \
+        } \
+    } while(0)
+
+#define LOG4_FATAL(args...) NEB_LOG(neb::Logger::FATAL, ##args)
+#define LOG4_ERROR(args...) NEB_LOG(neb::Logger::ERROR, ##args)
+#define LOG4_WARNING(args...) NEB_LOG(neb::Logger::WARNING, ##args)
+#define LOG4_NOTICE(args...) NEB_LOG(neb::Logger::NOTICE, ##args)
+#define LOG4_INFO(args...) NEB_LOG(neb::Logger::INFO, ##args)
+#define LOG4_CRITICAL(args...) NEB_LOG(neb::Logger::CRITICAL, ##args)
+#define LOG4_DEBUG(args...) NEB_LOG(neb::Logger::DEBUG, ##args)
+#define LOG4_TRACE(args...) NEB_LOG(neb::Logger::TRACE, ##args)
 //#define LOG4_TRACE(...) Logger(neb::Logger::TRACE, __FILE__, __LINE__, __FUNCTION__, __VA_ARGS__)
 
 typedef int8_t int8;
@@ -162,6 +185,9 @@ const int gc_iErrBuffLen = 256;
 /** @brief IP地址长度 */
 const int gc_iAddrLen = 64;
 
+/** @brief 每次监听fd可读事件最多accept的连接数（SO_REUSEPORT模式下Worker自行accept） */
+const int gc_iMaxAcceptPerEvent = 64;
+
 const uint32 gc_uiMsgHeadSize = 15;
 const uint32 gc_uiClientMsgHeadSize = 14;
 
@@ -11,6 +11,7 @@
 #include "actor/Actor.hpp"
 #include <algorithm>
 #include "ios/Dispatcher.hpp"
+#include "codec/RespCmd.hpp"
 #include "actor/session/Session.hpp"
 #include "actor/step/Step.hpp"
 #include "labor/Worker.hpp"
@@ -20,14 +21,14 @@ namespace neb
 
 Actor::Actor(ACTOR_TYPE eActorType, ev_tstamp dTimeout)
     : m_eActorType(eActorType),
-      m_uiSequence(0), m_dActiveTime(0.0), m_dTimeout(dTimeout),
-      m_pLabor(nullptr), m_pTimerWatcher(NULL), m_pContext(nullptr)
+      m_uiSequence(0), m_dActiveTime(0.0), m_dMonotonicActiveTime(0.0), m_dTimeout(dTimeout),
+      m_pLabor(nullptr), m_pContext(nullptr)
 {
+    m_stTimer.data = this;    // (void*)(Actor*)
 }
 
 Actor::~Actor()
 {
-    FREE(m_pTimerWatcher);
     LOG4_TRACE("eActorType %d, seq %u, actor name \"%s\"",
             m_eActorType, GetSequence(), m_strActorName.c_str());
 }
@@ -90,6 +91,16 @@ long Actor::GetNowTimeMs() const
     return(m_pLabor->GetNowTimeMs());
 }
 
+int64 Actor::GetMonotonicTimeMs() const
+{
+    return(m_pLabor->GetMonotonicTimeMs());
+}
+
+int64 Actor::GetMonotonicTimeUs() const
+{
+    return(m_pLabor->GetMonotonicTimeUs());
+}
+
 const CJsonObject& Actor::GetCustomConf() const
 {
     return(m_pLabor->GetCustomConf());
@@ -181,6 +192,17 @@ bool Actor::SendTo(const std::string& strIdentify, int32 iCmd, uint32 uiSeq, con
     return(m_pLabor->GetDispatcher()->SendTo(strIdentify, eCodecType, false, true, iCmd, uiSeq, oMsgBody)); 
 }
 
+uint32 Actor::GetEndpoint(const std::string& strIdentify)
+{
+    return(m_pLabor->GetDispatcher()->GetEndpoint(strIdentify));
+}
+
+bool Actor::SendTo(uint32 uiEndpoint, int32 iCmd, uint32 uiSeq, const MsgBody& oMsgBody, E_CODEC_TYPE eCodecType)
+{
+    (const_cast<MsgBody&>(oMsgBody)).set_trace_id(GetTraceId());
+    return(m_pLabor->GetDispatcher()->SendTo(uiEndpoint, eCodecType, false, true, iCmd, uiSeq, oMsgBody));
+}
+
 bool Actor::SendTo(const std::string& strHost, int iPort, const HttpMsg& oHttpMsg, uint32 uiStepSeq)
 {
     bool bWithSsl = false;
@@ -207,11 +229,61 @@ bool Actor::SendTo(const std::string& strIdentify, const RedisMsg& oRedisMsg, bo
     return(m_pLabor->GetDispatcher()->SendTo(strIdentify, CODEC_RESP, bWithSsl, bPipeline, oRedisMsg, GetSequence()));
 }
 
+bool Actor::SendTo(const std::string& strIdentify, const RespCmd& oRespCmd, bool bWithSsl, bool bPipeline, uint32 uiStepSeq)
+{
+    return(m_pLabor->GetDispatcher()->SendTo(strIdentify, CODEC_RESP, bWithSsl, bPipeline, oRespCmd, GetSequence()));
+}
+
+bool Actor::SendTo(const std::string& strIdentify, const std::vector<RespCmd>& vecRespCmd, bool bWithSsl, bool bPipeline)
+{
+    return(m_pLabor->GetDispatcher()->SendTo(strIdentify, CODEC_RESP, bWithSsl, bPipeline, vecRespCmd, GetSequence()));
+}
+
 bool Actor::SendToCluster(const std::string& strIdentify, const RedisMsg& oRedisMsg, bool bWithSsl, bool bPipeline, bool bEnableReadOnly)
 {
     return(m_pLabor->GetActorBuilder()->SendToCluster(strIdentify, bWithSsl, bPipeline, oRedisMsg, GetSequence(), bEnableReadOnly));
 }
 
+bool Actor::SendToCluster(const std::string& strIdentify, const RespCmd& oRespCmd, bool bWithSsl, bool bPipeline, bool bEnableReadOnly)
+{
+    return(m_pLabor->GetActorBuilder()->SendToCluster(strIdentify, bWithSsl, bPipeline, oRespCmd, GetSequence(), bEnableReadOnly));
+}
+
+bool Actor::SendWithNearCache(const std::string& strIdentify, const RespCmd& oRespCmd, const RedisReply*& pCachedReply,
+        bool bCluster, bool bWithSsl, bool bPipeline)
+{
+    pCachedReply = nullptr;
+    RedisNearCache& oNearCache = m_pLabor->GetDispatcher()->GetRedisNearCache();
+    if (!oNearCache.IsEnabled() || !oNearCache.IsCacheable(oRespCmd)
+            || !m_pLabor->GetDispatcher()->TrackRedis(strIdentify, bCluster, bWithSsl))
+    {
+        return(bCluster ? SendToCluster(strIdentify, oRespCmd, bWithSsl, bPipeline)
+                : SendTo(strIdentify, oRespCmd, bWithSsl, bPipeline));
+    }
+    uint32 uiFillId = 0;
+    pCachedReply = oNearCache.Lookup(strIdentify, oRespCmd, uiFillId);
+    if (nullptr != pCachedReply)
+    {
+        return(true);
+    }
+    std::shared_ptr<Step> pStepFill = MakeSharedStep("neb::StepRedisNearCacheFill", GetSequence(), uiFillId, GetTimeout());
+    if (nullptr == pStepFill)
+    {
+        LOG4_ERROR("failed to new StepRedisNearCacheFill");
+        oNearCache.Cancel(uiFillId);
+        return(false);
+    }
+    pStepFill->Emit();
+    bool bResult = bCluster ? pStepFill->SendToCluster(strIdentify, oRespCmd, bWithSsl, bPipeline)
+            : pStepFill->SendTo(strIdentify, oRespCmd, bWithSsl, bPipeline);
+    if (!bResult)
+    {
+        oNearCache.Cancel(uiFillId);
+        m_pLabor->GetActorBuilder()->RemoveStep(pStepFill);
+    }
+    return(bResult);
+}
+
 bool Actor::SendRoundRobin(const std::string& strIdentify, const RedisMsg& oRedisMsg, bool bWithSsl, bool bPipeline)
 {
     return(m_pLabor->GetDispatcher()->SendRoundRobin(strIdentify, CODEC_RESP, bWithSsl, bPipeline, oRedisMsg, GetSequence()));
@@ -265,6 +337,18 @@ bool Actor::SendOriented(const std::string& strNodeType, int32 iCmd, uint32 uiSe
     }
 }
 
+bool Actor::Broadcast(const std::string& strNodeType, int32 iCmd, uint32 uiSeq, const MsgBody& oMsgBody, E_CODEC_TYPE eCodecType)
+{
+    (const_cast<MsgBody&>(oMsgBody)).set_trace_id(GetTraceId());
+    return(m_pLabor->GetDispatcher()->Broadcast(strNodeType, eCodecType, false, true, iCmd, uiSeq, oMsgBody));
+}
+
+bool Actor::Multicast(const std::vector<std::shared_ptr<SocketChannel>>& vecChannel, int32 iCmd, uint32 uiSeq, const MsgBody& oMsgBody)
+{
+    (const_cast<MsgBody&>(oMsgBody)).set_trace_id(GetTraceId());
+    return(m_pLabor->GetDispatcher()->Multicast(vecChannel, iCmd, uiSeq, oMsgBody));
+}
+
 bool Actor::SendDataReport(int32 iCmd, uint32 uiSeq, const MsgBody& oMsgBody)
 {
     (const_cast<MsgBody&>(oMsgBody)).set_trace_id(GetTraceId());
@@ -285,6 +369,31 @@ int32 Actor::GetStepNum() const
     return(m_pLabor->GetActorBuilder()->GetStepNum());
 }
 
+std::shared_ptr<MsgHead> Actor::RetainMessage(const MsgHead& oMsgHead)
+{
+    return(m_pLabor->GetDispatcher()->RetainMessage(oMsgHead));
+}
+
+std::shared_ptr<MsgBody> Actor::RetainMessage(const MsgBody& oMsgBody)
+{
+    return(m_pLabor->GetDispatcher()->RetainMessage(oMsgBody));
+}
+
+std::shared_ptr<HttpMsg> Actor::RetainMessage(const HttpMsg& oHttpMsg)
+{
+    return(m_pLabor->GetDispatcher()->RetainMessage(oHttpMsg));
+}
+
+std::shared_ptr<RedisReply> Actor::RetainMessage(const RedisReply& oRedisReply)
+{
+    return(m_pLabor->GetDispatcher()->RetainMessage(oRedisReply));
+}
+
+MessagePool<RedisReply>& Actor::GetRedisMsgPool()
+{
+    return(m_pLabor->GetDispatcher()->GetRedisMsgPool());
+}
+
 void Actor::SetLabor(Labor* pLabor)
 {
     m_pLabor = pLabor;
@@ -299,18 +408,9 @@ uint32 Actor::ForceNewSequence()
     return(m_uiSequence);
 }
 
-ev_timer* Actor::MutableTimerWatcher()
+TimingWheel::tagTimer* Actor::MutableTimer()
 {
-    if (NULL == m_pTimerWatcher)
-    {
-        m_pTimerWatcher = (ev_timer*)malloc(sizeof(ev_timer));
-        if (NULL != m_pTimerWatcher)
-        {
-            memset(m_pTimerWatcher, 0, sizeof(ev_timer));
-            m_pTimerWatcher->data = this;    // (void*)(Actor*)
-        }
-    }
-    return(m_pTimerWatcher);
+    return(&m_stTimer);
 }
 
 void Actor::SetActorName(const std::string& strActorName)
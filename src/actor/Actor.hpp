@@ -12,6 +12,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #ifdef __GNUC__
 #pragma GCC diagnostic push
@@ -31,6 +32,7 @@
 #include "channel/Channel.hpp"
 #include "labor/Labor.hpp"
 #include "codec/Codec.hpp"
+#include "ios/TimingWheel.hpp"
 #include "ActorBuilder.hpp"
 
 namespace neb
@@ -53,6 +55,8 @@ class Context;
 class Step;
 class Model;
 class Chain;
+class RespCmd;
+template<typename T> class MessagePool;
 
 class Actor: public std::enable_shared_from_this<Actor>
 {
@@ -80,6 +84,7 @@ public:
     virtual ~Actor();
 
     template <typename ...Targs> void Logger(int iLogLevel, const char* szFileName, unsigned int uiFileLine, const char* szFunction, Targs&&... args) const;
+    bool IsLogLevelEnabled(int iLogLevel) const;
     template <typename ...Targs> std::shared_ptr<Step> MakeSharedStep(const std::string& strStepName, Targs&&... args);
     template <typename ...Targs> std::shared_ptr<Session> MakeSharedSession(const std::string& strSessionName, Targs&&... args);
     template <typename ...Targs> std::shared_ptr<Context> MakeSharedContext(const std::string& strContextName, Targs&&... args);
@@ -112,6 +117,8 @@ protected:
     const NodeInfo& GetNodeInfo() const;
     time_t GetNowTime() const;
     long GetNowTimeMs() const;
+    int64 GetMonotonicTimeMs() const;
+    int64 GetMonotonicTimeUs() const;
     ev_tstamp GetDataReportInterval() const;
 
     /**
@@ -191,6 +198,22 @@ protected:
      */
     virtual bool SendTo(const std::string& strIdentify, int32 iCmd, uint32 uiSeq, const MsgBody& oMsgBody, E_CODEC_TYPE eCodecType = CODEC_NEBULA);
 
+    /**
+     * @brief 获取节点句柄
+     * @note 节点标识首次出现时登记，之后总是返回同一句柄。频繁发往同一节点时可保存句柄，
+     * 以SendTo(uint32 uiEndpoint, ...)发送，省去每次发送对节点标识的查找和解析。
+     * @param strIdentify 连接标识符(IP:port.worker_index, e.g 192.168.11.12:3001.1)
+     * @return 节点句柄
+     */
+    uint32 GetEndpoint(const std::string& strIdentify);
+
+    /**
+     * @brief 按节点句柄发送请求
+     * @param uiEndpoint 节点句柄（由GetEndpoint()获取）
+     * @see SendTo(const std::string& strIdentify, int32 iCmd, uint32 uiSeq, const MsgBody& oMsgBody, E_CODEC_TYPE eCodecType)
+     */
+    virtual bool SendTo(uint32 uiEndpoint, int32 iCmd, uint32 uiSeq, const MsgBody& oMsgBody, E_CODEC_TYPE eCodecType = CODEC_NEBULA);
+
     /**
      * @brief 发送http请求
      * @param strHost IP地址
@@ -213,6 +236,24 @@ protected:
      */
     virtual bool SendTo(const std::string& strIdentify, const RedisMsg& oRedisMsg, bool bWithSsl = false, bool bPipeline = true, uint32 uiStepSeq = 0);
 
+    /**
+     * @brief 发送redis请求（直接编码，不构造RedisMsg）
+     * @note 只有RedisStep及其派生类才能调用此方法
+     * @param strIdentify RedisChannel通道标识，格式如： 192.168.125.53:6379
+     * @param oRespCmd redis命令，如RespCmd("HSET", strKey, strField, strValue)
+     * @param bWithSsl 是否需要SSL
+     * @param bPipeline 是否支持pipeline
+     * @param uiStepSeq 应用层无用参数，框架层的系统Actor会用到
+     * @return 是否发送成功
+     */
+    virtual bool SendTo(const std::string& strIdentify, const RespCmd& oRespCmd, bool bWithSsl = false, bool bPipeline = true, uint32 uiStepSeq = 0);
+
+    /**
+     * @brief 以pipeline批量发送redis请求，每条命令各回调一次
+     * @note 只有RedisStep及其派生类才能调用此方法
+     */
+    virtual bool SendTo(const std::string& strIdentify, const std::vector<RespCmd>& vecRespCmd, bool bWithSsl = false, bool bPipeline = true);
+
     /**
      * @brief 发送redis请求
      * @note 只有RedisStep及其派生类才能调用此方法
@@ -226,6 +267,25 @@ protected:
      * @return 是否发送成功
      */
     virtual bool SendToCluster(const std::string& strIdentify, const RedisMsg& oRedisMsg, bool bWithSsl = false, bool bPipeline = true, bool bEnableReadOnly = false);
+    /**
+     * @brief 发送redis请求到redis cluster
+     * @note 集群需保存请求以便MOVED、ASK重定向时重发，命令在集群步骤中转换为RedisMsg保存。
+     */
+    virtual bool SendToCluster(const std::string& strIdentify, const RespCmd& oRespCmd, bool bWithSsl = false, bool bPipeline = true, bool bEnableReadOnly = false);
+    /**
+     * @brief 经近端缓存发送redis读请求
+     * @note 只有RedisStep及其派生类才能调用此方法。命中时不发送请求也不会回调，响应
+     * 由pCachedReply直接返回（在当前回调返回前有效）；未命中时发出请求，响应到达后
+     * 回填缓存并与SendTo()一样回调Callback()。近端缓存未开启、命令不可缓存或跟踪
+     * 尚未建立时等同于SendTo()（或SendToCluster()）。
+     * @param strIdentify redis节点标识（如192.168.125.53:6379）或redis cluster标识
+     * @param oRespCmd redis读命令，如RespCmd("HGET", strKey, strField)
+     * @param[out] pCachedReply 命中时为缓存的响应，否则为nullptr
+     * @param bCluster strIdentify是否为redis cluster
+     * @return 是否命中或发送成功
+     */
+    bool SendWithNearCache(const std::string& strIdentify, const RespCmd& oRespCmd, const RedisReply*& pCachedReply,
+            bool bCluster = false, bool bWithSsl = false, bool bPipeline = true);
     /**
      * @brief 发送redis请求到类似于codis proxy的服务
      */
@@ -279,6 +339,29 @@ protected:
 
     virtual bool SendOriented(const std::string& strNodeType, int32 iCmd, uint32 uiSeq, const MsgBody& oMsgBody, E_CODEC_TYPE eCodecType = CODEC_NEBULA);
 
+    /**
+     * @brief 发送到同一类型的所有节点
+     * @note 消息只编码一次，编码结果由各节点连接共享。
+     * @param strNodeType 节点类型
+     * @param iCmd 发送的命令字
+     * @param uiSeq 发送的数据包seq
+     * @param oMsgBody 数据包体
+     * @param oCodecType 编解码方式
+     * @return 是否至少发送到一个节点
+     */
+    virtual bool Broadcast(const std::string& strNodeType, int32 iCmd, uint32 uiSeq, const MsgBody& oMsgBody, E_CODEC_TYPE eCodecType = CODEC_NEBULA);
+
+    /**
+     * @brief 同一消息发送到一组连接（如群聊推送）
+     * @note 每种编解码方式只编码一次，编码结果由各连接的发送队列共享，无须在业务代码中逐个连接SendTo()。
+     * @param vecChannel 消息通道
+     * @param iCmd 发送的命令字
+     * @param uiSeq 发送的数据包seq
+     * @param oMsgBody 数据包体
+     * @return 是否至少有一个连接发送成功
+     */
+    virtual bool Multicast(const std::vector<std::shared_ptr<SocketChannel>>& vecChannel, int32 iCmd, uint32 uiSeq, const MsgBody& oMsgBody);
+
     virtual bool SendDataReport(int32 iCmd, uint32 uiSeq, const MsgBody& oMsgBody);
 
     /**
@@ -290,10 +373,37 @@ protected:
 
     int32 GetStepNum() const;
 
+    /**
+     * @brief 接管收到的消息
+     * @note 框架解码所用的消息对象取自Worker的回收池，AnyMessage()、Callback()等回调返回后
+     * 即被清空复用，需要在回调之外继续使用消息时须在回调中调用此函数。接管的是消息对象本身
+     * （无拷贝），回调中原引用仍然有效；传入的不是框架正在处理的消息时则复制一份。
+     * @param oMsg 回调中收到的消息
+     * @return 调用方持有的消息
+     */
+    std::shared_ptr<MsgHead> RetainMessage(const MsgHead& oMsgHead);
+    std::shared_ptr<MsgBody> RetainMessage(const MsgBody& oMsgBody);
+    std::shared_ptr<HttpMsg> RetainMessage(const HttpMsg& oHttpMsg);
+    std::shared_ptr<RedisReply> RetainMessage(const RedisReply& oRedisReply);
+
 protected:
+    /**
+     * @brief 框架解码redis消息所用的回收池
+     * @note RespView转换为RedisReply时从这里取消息，转换出的消息与框架直接解码的一样
+     * 可在回调中RetainMessage()接管。
+     */
+    MessagePool<RedisReply>& GetRedisMsgPool();
+
+    /**
+     * @brief 刷新活跃时间
+     * @param dActiveTime 活跃时间（系统时间，单位：秒）
+     * @note 超时判断不使用这个时间，而是同时记下的单调时钟时间，派生类覆盖本函数
+     * 且不调用基类实现时（如Timer），超时时间不会被刷新。
+     */
     virtual void SetActiveTime(ev_tstamp dActiveTime)
     {
         m_dActiveTime = dActiveTime;
+        m_dMonotonicActiveTime = (ev_tstamp)GetMonotonicTimeUs() / 1000000.0;
     }
 
     ev_tstamp GetActiveTime() const
@@ -309,17 +419,18 @@ protected:
 private:
     void SetLabor(Labor* pLabor);
     uint32 ForceNewSequence();
-    ev_timer* MutableTimerWatcher();
+    TimingWheel::tagTimer* MutableTimer();
     void SetActorName(const std::string& strActorName);
     void SetTraceId(const std::string& strTraceId);
 
 private:
     ACTOR_TYPE m_eActorType;
     uint32 m_uiSequence;
-    ev_tstamp m_dActiveTime;
+    ev_tstamp m_dActiveTime;            ///< 活跃时间（系统时间，单位：秒）
+    ev_tstamp m_dMonotonicActiveTime;   ///< 活跃时间（单调时钟，单位：秒），用于超时判断
     ev_tstamp m_dTimeout;
     Labor* m_pLabor;
-    ev_timer* m_pTimerWatcher;
+    TimingWheel::tagTimer m_stTimer;
     std::string m_strActorName;
     std::string m_strTraceId;       // for log trace
     std::shared_ptr<Context> m_pContext;
@@ -336,6 +447,11 @@ void Actor::Logger(int iLogLevel, const char* szFileName, unsigned int uiFileLin
     m_pLabor->GetActorBuilder()->Logger(m_strTraceId, iLogLevel, szFileName, uiFileLine, szFunction, std::forward<Targs>(args)...);
 }
 
+inline bool Actor::IsLogLevelEnabled(int iLogLevel) const
+{
+    return(m_pLabor->GetActorBuilder()->IsLogLevelEnabled(iLogLevel, true));
+}
+
 template <typename ...Targs>
 std::shared_ptr<Step> Actor::MakeSharedStep(const std::string& strStepName, Targs&&... args)
 {
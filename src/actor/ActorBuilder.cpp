@@ -27,6 +27,7 @@
 #include "actor/session/sys_session/SessionLogger.hpp"
 #include "ios/Dispatcher.hpp"
 #include "channel/SocketChannel.hpp"
+#include "codec/RespView.hpp"
 
 namespace neb
 {
@@ -70,51 +71,52 @@ bool ActorBuilder::Init(CJsonObject& oDynamicLoadConf)
     return(true);
 }
 
-void ActorBuilder::StepTimeoutCallback(struct ev_loop* loop, ev_timer* watcher, int revents)
+void ActorBuilder::StepTimeoutCallback(TimingWheel::tagTimer* pTimer)
 {
-    if (watcher->data != NULL)
+    if (pTimer->data != NULL)
     {
-        Step* pStep = (Step*)watcher->data;
+        Actor* pStep = (Actor*)pTimer->data;
         pStep->m_pLabor->GetActorBuilder()->OnStepTimeout(std::dynamic_pointer_cast<Step>(pStep->shared_from_this()));
     }
 }
 
-void ActorBuilder::SessionTimeoutCallback(struct ev_loop* loop, ev_timer* watcher, int revents)
+void ActorBuilder::SessionTimeoutCallback(TimingWheel::tagTimer* pTimer)
 {
-    if (watcher->data != NULL)
+    if (pTimer->data != NULL)
     {
-        Session* pSession = (Session*)watcher->data;
+        Actor* pSession = (Actor*)pTimer->data;
         pSession->m_pLabor->GetActorBuilder()->OnSessionTimeout(std::dynamic_pointer_cast<Session>(pSession->shared_from_this()));
     }
 }
 
-void ActorBuilder::ChainTimeoutCallback(struct ev_loop* loop, ev_timer* watcher, int revents)
+void ActorBuilder::ChainTimeoutCallback(TimingWheel::tagTimer* pTimer)
 {
-    if (watcher->data != NULL)
+    if (pTimer->data != NULL)
     {
-        Chain* pChain = (Chain*)watcher->data;
+        Actor* pChain = (Actor*)pTimer->data;
         pChain->m_pLabor->GetActorBuilder()->OnChainTimeout(std::dynamic_pointer_cast<Chain>(pChain->shared_from_this()));
     }
 }
 
 bool ActorBuilder::OnStepTimeout(std::shared_ptr<Step> pStep)
 {
-    ev_timer* watcher = pStep->MutableTimerWatcher();
-    ev_tstamp after = pStep->GetActiveTime() - m_pLabor->GetNowTime() + pStep->GetTimeout();
+    TimingWheel::tagTimer* pTimer = pStep->MutableTimer();
+    ev_tstamp dNowTime = m_pLabor->GetDispatcher()->GetMonotonicTime();
+    ev_tstamp after = pStep->m_dMonotonicActiveTime - dNowTime + pStep->GetTimeout();
     if (after > 0)    // 在定时时间内被重新刷新过，重新设置定时器
     {
-        m_pLabor->GetDispatcher()->RefreshEvent(watcher, after);
+        m_pLabor->GetDispatcher()->RefreshEvent(pTimer, after);
         return(true);
     }
     else    // 步骤已超时
     {
         LOG4_TRACE("seq %lu: active_time %lf, now_time %lf, lifetime %lf",
-                        pStep->GetSequence(), pStep->GetActiveTime(), m_pLabor->GetNowTime(), pStep->GetTimeout());
+                        pStep->GetSequence(), pStep->m_dMonotonicActiveTime, dNowTime, pStep->GetTimeout());
         E_CMD_STATUS eResult = pStep->Timeout();
         if (CMD_STATUS_RUNNING == eResult)
         {
             ev_tstamp after = pStep->GetTimeout();
-            m_pLabor->GetDispatcher()->RefreshEvent(watcher, after);
+            m_pLabor->GetDispatcher()->RefreshEvent(pTimer, after);
             return(true);
         }
         else
@@ -128,12 +130,11 @@ bool ActorBuilder::OnStepTimeout(std::shared_ptr<Step> pStep)
 
 bool ActorBuilder::OnSessionTimeout(std::shared_ptr<Session> pSession)
 {
-    ev_timer* watcher = pSession->MutableTimerWatcher();
-    //LOG4_TRACE("CHECK watchar = 0x%x", watcher);
-    ev_tstamp after = pSession->GetActiveTime() - m_pLabor->GetNowTime() + pSession->GetTimeout();
+    TimingWheel::tagTimer* pTimer = pSession->MutableTimer();
+    ev_tstamp after = pSession->m_dMonotonicActiveTime - m_pLabor->GetDispatcher()->GetMonotonicTime() + pSession->GetTimeout();
     if (after > 0)    // 定时时间内被重新刷新过，重新设置定时器
     {
-        m_pLabor->GetDispatcher()->RefreshEvent(watcher, after);
+        m_pLabor->GetDispatcher()->RefreshEvent(pTimer, after);
         return(true);
     }
     else    // 会话已超时
@@ -141,7 +142,7 @@ bool ActorBuilder::OnSessionTimeout(std::shared_ptr<Session> pSession)
         //LOG4_TRACE("session_id: %s", pSession->GetSessionId().c_str());
         if (CMD_STATUS_RUNNING == pSession->Timeout())
         {
-            m_pLabor->GetDispatcher()->RefreshEvent(watcher, pSession->GetTimeout());
+            m_pLabor->GetDispatcher()->RefreshEvent(pTimer, pSession->GetTimeout());
             return(true);
         }
         else
@@ -154,19 +155,18 @@ bool ActorBuilder::OnSessionTimeout(std::shared_ptr<Session> pSession)
 
 bool ActorBuilder::OnChainTimeout(std::shared_ptr<Chain> pChain)
 {
-    ev_timer* watcher = pChain->MutableTimerWatcher();
-    LOG4_TRACE("CHECK watchar = 0x%x", watcher);
-    ev_tstamp after = pChain->GetActiveTime() - m_pLabor->GetNowTime() + pChain->GetTimeout();
+    TimingWheel::tagTimer* pTimer = pChain->MutableTimer();
+    ev_tstamp after = pChain->m_dMonotonicActiveTime - m_pLabor->GetDispatcher()->GetMonotonicTime() + pChain->GetTimeout();
     if (after > 0)    // 定时时间内被重新刷新过，重新设置定时器
     {
-        m_pLabor->GetDispatcher()->RefreshEvent(watcher, after);
+        m_pLabor->GetDispatcher()->RefreshEvent(pTimer, after);
         return(true);
     }
     else    // 会话已超时
     {
         if (CMD_STATUS_RUNNING == pChain->Timeout())
         {
-            m_pLabor->GetDispatcher()->RefreshEvent(watcher, pChain->GetTimeout());
+            m_pLabor->GetDispatcher()->RefreshEvent(pTimer, pChain->GetTimeout());
             return(true);
         }
         else
@@ -193,9 +193,7 @@ bool ActorBuilder::OnMessage(std::shared_ptr<SocketChannel> pChannel, const MsgH
             }
             else
             {
-                std::ostringstream oss;
-                oss << m_pLabor->GetNodeInfo().uiNodeId << "." << m_pLabor->GetNowTime() << "." << m_pLabor->GetSequence();
-                cmd_iter->second->SetTraceId(oss.str());
+                cmd_iter->second->SetTraceId(MakeTraceId(m_pLabor->GetSequence()));
             }
             cmd_iter->second->AnyMessage(pChannel, oMsgHead, oMsgBody);
         }
@@ -222,6 +220,15 @@ bool ActorBuilder::OnMessage(std::shared_ptr<SocketChannel> pChannel, const MsgH
                     LOG4_ERROR("json parse string error: \"%s\"");
                 }
             }
+            else if (CMD_REQ_SET_SSL_TICKET_KEY == oMsgHead.cmd())
+            {
+#ifdef WITH_OPENSSL
+                if (!SslResumption::SetTicketKeys(oMsgBody.data()))
+                {
+                    LOG4_ERROR("invalid ssl ticket key length %u", (uint32)oMsgBody.data().size());
+                }
+#endif
+            }
             else
             {
                 if (CODEC_NEBULA == pChannel->GetCodecType())   // 内部服务往客户端发送  if (std::string("0.0.0.0") == strFromIp)
@@ -235,9 +242,7 @@ bool ActorBuilder::OnMessage(std::shared_ptr<SocketChannel> pChannel, const MsgH
                         }
                         else
                         {
-                            std::ostringstream oss;
-                            oss << m_pLabor->GetNodeInfo().uiNodeId << "." << m_pLabor->GetNowTime() << "." << m_pLabor->GetSequence();
-                            cmd_iter->second->SetTraceId(oss.str());
+                            cmd_iter->second->SetTraceId(MakeTraceId(m_pLabor->GetSequence()));
                         }
                         cmd_iter->second->AnyMessage(pChannel, oMsgHead, oMsgBody);
                     }
@@ -263,9 +268,7 @@ bool ActorBuilder::OnMessage(std::shared_ptr<SocketChannel> pChannel, const MsgH
                         }
                         else
                         {
-                            std::ostringstream oss;
-                            oss << m_pLabor->GetNodeInfo().uiNodeId << "." << m_pLabor->GetNowTime() << "." << m_pLabor->GetSequence();
-                            cmd_iter->second->SetTraceId(oss.str());
+                            cmd_iter->second->SetTraceId(MakeTraceId(m_pLabor->GetSequence()));
                         }
                         cmd_iter->second->AnyMessage(pChannel, oMsgHead, oMsgBody);
                     }
@@ -359,9 +362,7 @@ bool ActorBuilder::OnMessage(std::shared_ptr<SocketChannel> pChannel, const Http
                 module_iter = m_mapModule.find("http_upgrade");
                 if (module_iter != m_mapModule.end())
                 {
-                    std::ostringstream oss;
-                    oss << m_pLabor->GetNodeInfo().uiNodeId << "." << m_pLabor->GetNowTime() << "." << m_pLabor->GetSequence();
-                    module_iter->second->SetTraceId(oss.str());
+                    module_iter->second->SetTraceId(MakeTraceId(m_pLabor->GetSequence()));
                     module_iter->second->AnyMessage(pChannel, oHttpMsg);
                     return(true);
                 }
@@ -383,25 +384,19 @@ bool ActorBuilder::OnMessage(std::shared_ptr<SocketChannel> pChannel, const Http
                 }
                 else
                 {
-                    std::ostringstream oss;
-                    oss << m_pLabor->GetNodeInfo().uiNodeId << "." << m_pLabor->GetNowTime() << "." << m_pLabor->GetSequence();
-                    module_iter->second->SetTraceId(oss.str());
+                    module_iter->second->SetTraceId(MakeTraceId(m_pLabor->GetSequence()));
                     module_iter->second->AnyMessage(pChannel, oHttpMsg);
                 }
             }
             else
             {
-                std::ostringstream oss;
-                oss << m_pLabor->GetNodeInfo().uiNodeId << "." << m_pLabor->GetNowTime() << "." << m_pLabor->GetSequence();
-                module_iter->second->SetTraceId(oss.str());
+                module_iter->second->SetTraceId(MakeTraceId(m_pLabor->GetSequence()));
                 module_iter->second->AnyMessage(pChannel, oHttpMsg);
             }
         }
         else
         {
-            std::ostringstream oss;
-            oss << m_pLabor->GetNodeInfo().uiNodeId << "." << m_pLabor->GetNowTime() << "." << m_pLabor->GetSequence();
-            module_iter->second->SetTraceId(oss.str());
+            module_iter->second->SetTraceId(MakeTraceId(m_pLabor->GetSequence()));
             module_iter->second->AnyMessage(pChannel, oHttpMsg);
         }
     }
@@ -445,6 +440,36 @@ bool ActorBuilder::OnMessage(std::shared_ptr<SocketChannel> pChannel, const Http
 }
 
 bool ActorBuilder::OnMessage(std::shared_ptr<SocketChannel> pChannel, const RedisMsg& oRedisMsg, uint32 uiFinalStepSeq)
+{
+    return(OnRedisMessage(pChannel, oRedisMsg, uiFinalStepSeq));
+}
+
+bool ActorBuilder::OnMessage(std::shared_ptr<SocketChannel> pChannel, const RespView& oRespView)
+{
+    return(OnRedisMessage(pChannel, oRespView, 0));
+}
+
+bool ActorBuilder::OnRedisCmdMessage(std::shared_ptr<RedisCmd> pRedisCmd,
+        std::shared_ptr<SocketChannel> pChannel, const RedisMsg& oRedisMsg)
+{
+    return(pRedisCmd->AnyMessage(pChannel, oRedisMsg));
+}
+
+bool ActorBuilder::OnRedisCmdMessage(std::shared_ptr<RedisCmd> pRedisCmd,
+        std::shared_ptr<SocketChannel> pChannel, const RespView& oRespView)
+{
+    MessagePool<RedisMsg>::Holder oRedisMsgHolder(m_pLabor->GetDispatcher()->GetRedisMsgPool());
+    RedisMsg& oRedisMsg = *oRedisMsgHolder;
+    if (!oRespView.ToRedisReply(oRedisMsg))
+    {
+        LOG4_ERROR("failed to convert resp type %d to RedisReply", oRespView.Type());
+        return(false);
+    }
+    return(pRedisCmd->AnyMessage(pChannel, oRedisMsg));
+}
+
+template <typename T>
+bool ActorBuilder::OnRedisMessage(std::shared_ptr<SocketChannel> pChannel, const T& oRedisMsg, uint32 uiFinalStepSeq)
 {
     if (pChannel->IsClient())
     {
@@ -503,7 +528,7 @@ bool ActorBuilder::OnMessage(std::shared_ptr<SocketChannel> pChannel, const Redi
                 LOG4_ERROR("cmd %d is not a RedisCmd instance!", CMD_REQ_REDIS_PROXY);
                 return(false);
             }
-            return(pRedisCmd->AnyMessage(pChannel, oRedisMsg));
+            return(OnRedisCmdMessage(pRedisCmd, pChannel, oRedisMsg));
         }
         LOG4_ERROR("no instance of RedisCmd or derived class of RedisCmd found for cmd %d", CMD_REQ_REDIS_PROXY);
         return(false);
@@ -644,7 +669,7 @@ void ActorBuilder::RemoveStep(std::shared_ptr<Step> pStep)
             class_iter->second.erase(id_iter);
         }
     }
-    m_pLabor->GetDispatcher()->DelEvent(pStep->MutableTimerWatcher());
+    m_pLabor->GetDispatcher()->DelEvent(pStep->MutableTimer());
     callback_iter = m_mapCallbackStep.find(pStep->GetSequence());
     if (callback_iter != m_mapCallbackStep.end())
     {
@@ -668,7 +693,7 @@ void ActorBuilder::RemoveSession(std::shared_ptr<Session> pSession)
             class_iter->second.erase(id_iter);
         }
     }
-    m_pLabor->GetDispatcher()->DelEvent(pSession->MutableTimerWatcher());
+    m_pLabor->GetDispatcher()->DelEvent(pSession->MutableTimer());
     auto iter = m_mapCallbackSession.find(pSession->GetSessionId());
     if (iter != m_mapCallbackSession.end())
     {
@@ -683,7 +708,7 @@ void ActorBuilder::RemoveChain(uint32 uiChainId)
     if (chain_iter != m_mapChain.end())
     {
         std::shared_ptr<Chain> pChain = chain_iter->second;
-        m_pLabor->GetDispatcher()->DelEvent(pChain->MutableTimerWatcher());
+        m_pLabor->GetDispatcher()->DelEvent(pChain->MutableTimer());
         m_mapChain.erase(chain_iter);
     }
 }
@@ -702,9 +727,7 @@ void ActorBuilder::ChannelNotice(std::shared_ptr<SocketChannel> pChannel, const
         oMsgHead.set_cmd(CMD_REQ_DISCONNECT);
         oMsgHead.set_seq(m_pLabor->GetSequence());
         oMsgHead.set_len(oMsgBody.ByteSize());
-        std::ostringstream oss;
-        oss << m_pLabor->GetNodeInfo().uiNodeId << "." << m_pLabor->GetNowTime() << "." << m_pLabor->GetSequence();
-        cmd_iter->second->SetTraceId(oss.str());
+        cmd_iter->second->SetTraceId(MakeTraceId(m_pLabor->GetSequence()));
         cmd_iter->second->AnyMessage(pChannel, oMsgHead, oMsgBody);
     }
 }
@@ -829,11 +852,21 @@ void ActorBuilder::LoadSysCmd()
         MakeSharedModule(nullptr, "neb::ModuleHttpUpgrade", strModulePath);
     }
     m_pSessionLogger = std::dynamic_pointer_cast<SessionLogger>(MakeSharedSession(nullptr, "neb::SessionLogger"));
+    if (nullptr != m_pSessionLogger)
+    {
+        uint32 uiNetLogBatchSize = 0;       // 未配置时逐条发送，兼容不支持批量日志的LOGGER
+        bool bNetLogCompress = false;
+        m_pLabor->GetNodeConf().Get("net_log_batch_size", uiNetLogBatchSize);
+        m_pLabor->GetNodeConf().Get("net_log_compress", bNetLogCompress);
+        m_pSessionLogger->SetBatchOption(uiNetLogBatchSize, bNetLogCompress);
+    }
 }
 
 std::shared_ptr<Actor> ActorBuilder::InitializeSharedActor(Actor* pCreator, std::shared_ptr<Actor> pSharedActor, const std::string& strActorName)
 {
     pSharedActor->SetLabor(m_pLabor);
+    // 派生类的SetActiveTime()可能不刷新单调时钟时间（如Timer），超时从创建时刻起算
+    pSharedActor->m_dMonotonicActiveTime = m_pLabor->GetDispatcher()->GetMonotonicTime();
     pSharedActor->SetActiveTime(m_pLabor->GetNowTime());
     pSharedActor->SetActorName(strActorName);
     if (nullptr != pCreator && pSharedActor->GetActorType() != Actor::ACT_CONTEXT)
@@ -897,11 +930,7 @@ bool ActorBuilder::TransformToSharedStep(Actor* pCreator, std::shared_ptr<Actor>
 {
     pSharedActor->m_dTimeout = (gc_dDefaultTimeout == pSharedActor->m_dTimeout)
             ? m_pLabor->GetNodeInfo().dStepTimeout : pSharedActor->m_dTimeout;
-    ev_timer* timer_watcher = pSharedActor->MutableTimerWatcher();
-    if (NULL == timer_watcher)
-    {
-        return(false);
-    }
+    TimingWheel::tagTimer* pTimer = pSharedActor->MutableTimer();
 
     if (nullptr != pCreator)
     {
@@ -927,7 +956,7 @@ bool ActorBuilder::TransformToSharedStep(Actor* pCreator, std::shared_ptr<Actor>
     {
         if (gc_dNoTimeout != pSharedStep->m_dTimeout)
         {
-            m_pLabor->GetDispatcher()->AddEvent(timer_watcher, StepTimeoutCallback, pSharedStep->m_dTimeout);
+            m_pLabor->GetDispatcher()->AddEvent(pTimer, StepTimeoutCallback, pSharedStep->m_dTimeout);
         }
         LOG4_TRACE("Step(seq %u, active_time %lf, lifetime %lf) register successful.",
                         pSharedStep->GetSequence(), pSharedStep->GetActiveTime(), pSharedStep->GetTimeout());
@@ -947,17 +976,11 @@ bool ActorBuilder::TransformToSharedStep(Actor* pCreator, std::shared_ptr<Actor>
 
 bool ActorBuilder::TransformToSharedSession(Actor* pCreator, std::shared_ptr<Actor> pSharedActor)
 {
-    ev_timer* timer_watcher = pSharedActor->MutableTimerWatcher();
-    if (NULL == timer_watcher)
-    {
-        return(false);
-    }
+    TimingWheel::tagTimer* pTimer = pSharedActor->MutableTimer();
 
     if (nullptr != pCreator)
     {
-        std::ostringstream oss;
-        oss << m_pLabor->GetNodeInfo().uiNodeId << "." << m_pLabor->GetNowTime() << "." << pSharedActor->GetSequence();
-        pSharedActor->SetTraceId(oss.str());
+        pSharedActor->SetTraceId(MakeTraceId(pSharedActor->GetSequence()));
     }
     std::shared_ptr<Session> pSharedSession = std::dynamic_pointer_cast<Session>(pSharedActor);
     auto ret = m_mapCallbackSession.insert(std::make_pair(pSharedSession->GetSessionId(), pSharedSession));
@@ -965,7 +988,7 @@ bool ActorBuilder::TransformToSharedSession(Actor* pCreator, std::shared_ptr<Act
     {
         if (pSharedSession->m_dTimeout > 0)
         {
-            m_pLabor->GetDispatcher()->AddEvent(timer_watcher, SessionTimeoutCallback, pSharedSession->m_dTimeout);
+            m_pLabor->GetDispatcher()->AddEvent(pTimer, SessionTimeoutCallback, pSharedSession->m_dTimeout);
         }
         auto session_class_iter = m_mapLoadedSession.find(pSharedSession->GetActorName());
         if (session_class_iter != m_mapLoadedSession.end())
@@ -1056,11 +1079,7 @@ bool ActorBuilder::TransformToSharedModel(Actor* pCreator, std::shared_ptr<Actor
 
 bool ActorBuilder::TransformToSharedChain(Actor* pCreator, std::shared_ptr<Actor> pSharedActor)
 {
-    ev_timer* timer_watcher = pSharedActor->MutableTimerWatcher();
-    if (NULL == timer_watcher)
-    {
-        return(false);
-    }
+    TimingWheel::tagTimer* pTimer = pSharedActor->MutableTimer();
 
     if (nullptr != pCreator)
     {
@@ -1099,7 +1118,7 @@ bool ActorBuilder::TransformToSharedChain(Actor* pCreator, std::shared_ptr<Actor
     {
         if (gc_dNoTimeout != pSharedChain->m_dTimeout)
         {
-            m_pLabor->GetDispatcher()->AddEvent(timer_watcher, ChainTimeoutCallback, pSharedChain->m_dTimeout);
+            m_pLabor->GetDispatcher()->AddEvent(pTimer, ChainTimeoutCallback, pSharedChain->m_dTimeout);
         }
         return(true);
     }
@@ -1112,22 +1131,37 @@ bool ActorBuilder::TransformToSharedChain(Actor* pCreator, std::shared_ptr<Actor
 
 bool ActorBuilder::SendToCluster(const std::string& strIdentify, bool bWithSsl, bool bPipeline, const RedisMsg& oRedisMsg, uint32 uiStepSeq, bool bEnableReadOnly)
 {
-    bool bSendResult = false;
+    auto pClusterStep = GetClusterStep(strIdentify, bWithSsl, bPipeline, bEnableReadOnly);
+    if (pClusterStep == nullptr)
+    {
+        return(false);
+    }
+    return(pClusterStep->SendTo(strIdentify, oRedisMsg, bWithSsl, bPipeline, uiStepSeq));
+}
+
+bool ActorBuilder::SendToCluster(const std::string& strIdentify, bool bWithSsl, bool bPipeline, const RespCmd& oRespCmd, uint32 uiStepSeq, bool bEnableReadOnly)
+{
+    auto pClusterStep = GetClusterStep(strIdentify, bWithSsl, bPipeline, bEnableReadOnly);
+    if (pClusterStep == nullptr)
+    {
+        return(false);
+    }
+    return(pClusterStep->SendTo(strIdentify, oRespCmd, bWithSsl, bPipeline, uiStepSeq));
+}
+
+std::shared_ptr<Step> ActorBuilder::GetClusterStep(const std::string& strIdentify, bool bWithSsl, bool bPipeline, bool bEnableReadOnly)
+{
     auto iter = m_mapClusterChannelStep.find(strIdentify);
-    if (iter == m_mapClusterChannelStep.end())
+    if (iter != m_mapClusterChannelStep.end())
     {
-        auto pSharedStep = MakeSharedStep(nullptr, "neb::StepRedisCluster", strIdentify, (bool)bWithSsl, (bool)bPipeline, (bool)bEnableReadOnly);
-        if (pSharedStep != nullptr)
-        {
-            m_mapClusterChannelStep.insert(std::make_pair(strIdentify, pSharedStep));
-            bSendResult = pSharedStep->SendTo(strIdentify, oRedisMsg, bWithSsl, bPipeline, uiStepSeq);
-        }
+        return(iter->second);
     }
-    else
+    auto pSharedStep = MakeSharedStep(nullptr, "neb::StepRedisCluster", strIdentify, (bool)bWithSsl, (bool)bPipeline, (bool)bEnableReadOnly);
+    if (pSharedStep != nullptr)
     {
-        bSendResult = iter->second->SendTo(strIdentify, oRedisMsg, bWithSsl, bPipeline, uiStepSeq);
+        m_mapClusterChannelStep.insert(std::make_pair(strIdentify, pSharedStep));
     }
-    return(bSendResult);
+    return(pSharedStep);
 }
 
 std::shared_ptr<Session> ActorBuilder::GetSession(uint32 uiSessionId)
@@ -1189,9 +1223,7 @@ std::shared_ptr<Model> ActorBuilder::GetModel(const std::string& strModelName)
 
 bool ActorBuilder::ResetTimeout(std::shared_ptr<Actor> pSharedActor)
 {
-    ev_timer* watcher = pSharedActor->MutableTimerWatcher();
-    ev_tstamp after = m_pLabor->GetNowTime() + pSharedActor->GetTimeout();
-    m_pLabor->GetDispatcher()->RefreshEvent(watcher, after);
+    m_pLabor->GetDispatcher()->RefreshEvent(pSharedActor->MutableTimer(), pSharedActor->GetTimeout());
     return(true);
 }
 
@@ -1220,6 +1252,38 @@ bool ActorBuilder::AddNetLogMsg(const MsgBody& oMsgBody)
     return(true);
 }
 
+bool ActorBuilder::AddNetLog(const std::string& strTraceId, int iLogLevel, const char* szFileName,
+        unsigned int uiFileLine, const char* szFunction, const char* szLogContent)
+{
+    // 此函数不能写日志，不然可能会导致写日志函数与此函数无限递归
+    if (nullptr == m_pSessionLogger || !m_pSessionLogger->IsBatchEnabled())
+    {
+        return(false);
+    }
+    // 与逐条发送时SendOriented()的路由一致：有trace id的按trace id，否则按本节点标识选择LOGGER节点
+    std::string strLoggerIdentify;
+    if (!m_pLabor->GetDispatcher()->GetOrientedNode("LOGGER",
+            strTraceId.empty() ? m_pLabor->GetNodeInfo().strNodeIdentify : strTraceId, strLoggerIdentify))
+    {
+        return(false);
+    }
+    if (m_pSessionLogger->AddLog(strLoggerIdentify, strTraceId, iLogLevel, szFileName, uiFileLine, szFunction, szLogContent))
+    {
+        // 批量已满，下一个定时轮刻度即发送，不在写日志的调用栈中发送
+        m_pLabor->GetDispatcher()->RefreshEvent(m_pSessionLogger->MutableTimer(), 0);
+    }
+    return(true);
+}
+
+std::string ActorBuilder::MakeTraceId(uint32 uiSequence) const
+{
+    // 每个请求都生成trace id，用snprintf代替ostringstream
+    char szTraceId[64];
+    int iLen = snprintf(szTraceId, sizeof(szTraceId), "%u.%ld.%u",
+            m_pLabor->GetNodeInfo().uiNodeId, (long)m_pLabor->GetNowTime(), uiSequence);
+    return(std::string(szTraceId, (iLen > 0) ? iLen : 0));
+}
+
 void ActorBuilder::BootLoadCmd(CJsonObject& oCmdConf)
 {
     LOG4_TRACE(" ");
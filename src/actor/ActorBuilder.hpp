@@ -38,6 +38,7 @@
 #include "Definition.hpp"
 #include "Error.hpp"
 #include "util/CBuffer.hpp"
+#include "ios/TimingWheel.hpp"
 #include "ActorFactory.hpp"
 #include "logger/NetLogger.hpp"
 
@@ -57,6 +58,9 @@ class Timer;
 class Context;
 class Step;
 class RedisStep;
+class RespCmd;
+class RedisCmd;
+class RespView;
 class HttpStep;
 class Model;
 class Chain;
@@ -87,15 +91,16 @@ public:
     bool Init(CJsonObject& oBootLoadConf, CJsonObject& oDynamicLoadConf);
     bool Init(CJsonObject& oDynamicLoadConf);
 
-    static void StepTimeoutCallback(struct ev_loop* loop, ev_timer* watcher, int revents);
-    static void SessionTimeoutCallback(struct ev_loop* loop, ev_timer* watcher, int revents);
-    static void ChainTimeoutCallback(struct ev_loop* loop, ev_timer* watcher, int revents);
+    static void StepTimeoutCallback(TimingWheel::tagTimer* pTimer);
+    static void SessionTimeoutCallback(TimingWheel::tagTimer* pTimer);
+    static void ChainTimeoutCallback(TimingWheel::tagTimer* pTimer);
     bool OnStepTimeout(std::shared_ptr<Step> pStep);
     bool OnSessionTimeout(std::shared_ptr<Session> pSession);
     bool OnChainTimeout(std::shared_ptr<Chain> pChain);
     bool OnMessage(std::shared_ptr<SocketChannel> pChannel, const MsgHead& oMsgHead, const MsgBody& oMsgBody);
     bool OnMessage(std::shared_ptr<SocketChannel> pChannel, const HttpMsg& oHttpMsg);
     bool OnMessage(std::shared_ptr<SocketChannel> pChannel, const RedisMsg& oRedisMsg, uint32 uiFinalStepSeq = 0);
+    bool OnMessage(std::shared_ptr<SocketChannel> pChannel, const RespView& oRespView);
     bool OnMessage(std::shared_ptr<SocketChannel> pChannel, const CBuffer& oBuffer);
     bool OnError(std::shared_ptr<SocketChannel> pChannel, uint32 uiStepSeq, int iErrno, const std::string& strErrMsg);
 
@@ -104,6 +109,11 @@ public:
         void Logger(int iLogLevel, const char* szFileName, unsigned int uiFileLine, const char* szFunction, Targs&&... args);
     template <typename ...Targs>
         void Logger(const std::string& strTraceId, int iLogLevel, const char* szFileName, unsigned int uiFileLine, const char* szFunction, Targs&&... args);
+    /**
+     * @brief 日志级别是否需要输出（LOG4_*宏在格式化参数之前调用）
+     * @param bWithTraceId 是否为带trace id的Actor日志
+     */
+    bool IsLogLevelEnabled(int iLogLevel, bool bWithTraceId = false) const;
 
     template <typename ...Targs>
     std::shared_ptr<Actor> MakeSharedActor(Actor* pCreator, const std::string& strActorName, Targs&&... args);
@@ -140,6 +150,7 @@ public:
 
 public:
     bool SendToCluster(const std::string& strIdentify, bool bWithSsl, bool bPipeline, const RedisMsg& oRedisMsg, uint32 uiStepSeq, bool bEnableReadOnly);
+    bool SendToCluster(const std::string& strIdentify, bool bWithSsl, bool bPipeline, const RespCmd& oRespCmd, uint32 uiStepSeq, bool bEnableReadOnly);
     virtual std::shared_ptr<Session> GetSession(uint32 uiSessionId);
     virtual std::shared_ptr<Session> GetSession(const std::string& strSessionId);
     virtual bool ExecStep(uint32 uiStepSeq, int iErrno = ERR_OK, const std::string& strErrMsg = "", void* data = NULL);
@@ -148,6 +159,8 @@ public:
     int32 GetStepNum();
     bool ReloadCmdConf();
     bool AddNetLogMsg(const MsgBody& oMsgBody);
+    bool AddNetLog(const std::string& strTraceId, int iLogLevel, const char* szFileName,
+            unsigned int uiFileLine, const char* szFunction, const char* szLogContent);
 
 protected:
     void AddAssemblyLine(std::shared_ptr<Session> pSession);
@@ -165,6 +178,18 @@ protected:
     tagSo* LoadSo(const std::string& strSoPath, const std::string& strVersion);
     void LoadDynamicSymbol(CJsonObject& oOneSoConf);
     void UnloadDynamicSymbol(CJsonObject& oOneSoConf);
+    std::string MakeTraceId(uint32 uiSequence) const;
+    /**
+     * @brief 取strIdentify集群的ClusterChannelStep，不存在则创建
+     */
+    std::shared_ptr<Step> GetClusterStep(const std::string& strIdentify, bool bWithSsl, bool bPipeline, bool bEnableReadOnly);
+    /**
+     * @brief redis响应（RedisMsg或RespView）交给等待的步骤，redis请求交给RedisCmd
+     */
+    template <typename T>
+    bool OnRedisMessage(std::shared_ptr<SocketChannel> pChannel, const T& oRedisMsg, uint32 uiFinalStepSeq);
+    bool OnRedisCmdMessage(std::shared_ptr<RedisCmd> pRedisCmd, std::shared_ptr<SocketChannel> pChannel, const RedisMsg& oRedisMsg);
+    bool OnRedisCmdMessage(std::shared_ptr<RedisCmd> pRedisCmd, std::shared_ptr<SocketChannel> pChannel, const RespView& oRespView);
 
 private:
     char* m_pErrBuff;
@@ -212,6 +237,11 @@ void ActorBuilder::Logger(const std::string& strTraceId, int iLogLevel, const ch
     m_pLogger->WriteLog(strTraceId, iLogLevel, szFileName, uiFileLine, szFunction, std::forward<Targs>(args)...);
 }
 
+inline bool ActorBuilder::IsLogLevelEnabled(int iLogLevel, bool bWithTraceId) const
+{
+    return(m_pLogger->IsLevelEnabled(iLogLevel, bWithTraceId));
+}
+
 template <typename ...Targs>
 std::shared_ptr<Actor> ActorBuilder::MakeSharedActor(Actor* pCreator, const std::string& strActorName, Targs&&... args)
 {
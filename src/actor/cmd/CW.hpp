@@ -40,6 +40,8 @@ enum E_CMD
     CMD_RSP_UPDATE_WORKER_LOAD          = 14,   ///< 更新Worker进程负载信息应答（一般无须应答）
     CMD_REQ_START_SERVICE               = 15,   ///< 服务就绪请求
     CMD_RSP_START_SERVICE               = 16,   ///< 服务就绪响应（无须响应）
+    CMD_REQ_SET_SSL_TICKET_KEY          = 17,   ///< 设置TLS session ticket密钥请求（manager to worker）
+    CMD_RSP_SET_SSL_TICKET_KEY          = 18,   ///< 设置TLS session ticket密钥响应（无须响应）
 
     CMD_REQ_NODE_STATUS_REPORT          = 101,  ///< 节点Server状态上报请求（各节点向控制中心上报自身状态信息）
     CMD_RSP_NODE_STATUS_REPORT          = 102,  ///< 节点Server状态上报应答
@@ -77,6 +79,8 @@ enum E_CMD
     CMD_RSP_REDIS_PROXY                 = 404,  ///< 不使用
     CMD_REQ_RAW_DATA                    = 405,  ///< 裸数据传输固定虚Cmd，不会在网络中传输，处理raw数据的插件加载时必须配置成CMD_REQ_RAW_DATA
     CMD_RSP_RAW_DATA                    = 406,  ///< 不使用
+    CMD_REQ_LOG4_TRACE_BATCH            = 407,  ///< 批量分布式网络日志请求（TraceLogBatch）
+    CMD_RSP_LOG4_TRACE_BATCH            = 408,  ///< 批量分布式网络日志响应（无须响应）
 
     // 接入层转发命令字，如客户端数据转发给Logic，Logic数据转发给客户端等
     CMD_REQ_FROM_CLIENT                 = 501,  ///< 客户端发送过来需由接入层转发的数据，传输的MsgHead里的Cmd不会被改变（无业务逻辑直接转发的场景，如登录等接入层有业务逻辑的场景不适用）
@@ -15,13 +15,15 @@ namespace neb
 {
 
 SessionLogger::SessionLogger()
-    : Timer("neb::SessionLogger", 1.0)
+    : Timer("neb::SessionLogger", 1.0),
+      m_uiBatchSize(0), m_bCompress(false), m_bFlushPending(false)
 {
 }
 
 SessionLogger::~SessionLogger()
 {
    m_listLogMsgBody.clear();
+   m_mapLogBatch.clear();
 }
 
 E_CMD_STATUS SessionLogger::Timeout()
@@ -32,6 +34,23 @@ E_CMD_STATUS SessionLogger::Timeout()
         SendOriented("LOGGER", CMD_REQ_LOG4_TRACE, GetSequence(), m_listLogMsgBody.front());
         m_listLogMsgBody.pop_front();
     }
+
+    // 发送过程中产生的日志进入新的批量，下一周期发送
+    m_bFlushPending = false;
+    for (auto iter = m_mapLogBatch.begin(); iter != m_mapLogBatch.end(); )
+    {
+        if (iter->second->Empty())  // 一个周期内无日志（LOGGER节点可能已下线），释放批量
+        {
+            iter = m_mapLogBatch.erase(iter);
+            continue;
+        }
+        MsgBody oMsgBody;
+        iter->second->Serialize(m_strBatchData, m_bCompress);
+        iter->second->Clear();
+        oMsgBody.set_data(m_strBatchData);
+        SendTo(iter->first, CMD_REQ_LOG4_TRACE_BATCH, GetSequence(), oMsgBody);
+        ++iter;
+    }
     return(CMD_STATUS_RUNNING);
 }
 
@@ -41,5 +60,23 @@ void SessionLogger::AddMsg(const MsgBody& oMsgBody)
     m_listLogMsgBody.push_back(oMsgBody);
 }
 
+bool SessionLogger::AddLog(const std::string& strLoggerIdentify, const std::string& strTraceId, int iLogLevel,
+        const char* szFileName, unsigned int uiFileLine, const char* szFunction, const char* szLogContent)
+{
+    // 此函数不能写日志，不然可能会导致写日志函数与此函数无限递归
+    auto iter = m_mapLogBatch.find(strLoggerIdentify);
+    if (iter == m_mapLogBatch.end())
+    {
+        std::unique_ptr<NetLogBatch> pBatch(new NetLogBatch(GetNodeType(), GetNodeIdentify()));
+        iter = m_mapLogBatch.insert(std::make_pair(strLoggerIdentify, std::move(pBatch))).first;
+    }
+    iter->second->Add(GetNowTimeMs(), iLogLevel, szFileName, uiFileLine, szFunction, strTraceId, szLogContent);
+    if (!m_bFlushPending && iter->second->GetByteSize() >= m_uiBatchSize)
+    {
+        m_bFlushPending = true;
+        return(true);
+    }
+    return(false);
 }
 
+}
@@ -11,7 +11,10 @@
 #define SESSIONLOGGER_HPP_
 
 #include <list>
+#include <memory>
+#include <unordered_map>
 #include "pb/msg.pb.h"
+#include "logger/NetLogBatch.hpp"
 #include <actor/session/Timer.hpp>
 
 namespace neb
@@ -26,9 +29,37 @@ public:
     virtual E_CMD_STATUS Timeout();
 
     void AddMsg(const MsgBody& oMsgBody);
-                    
+
+    /**
+     * @brief 设置批量发送参数
+     * @param uiBatchSize 发往同一LOGGER节点的日志累计达到此字节数即尽快发送，0表示不批量发送
+     * @param bCompress 是否压缩
+     */
+    void SetBatchOption(uint32 uiBatchSize, bool bCompress)
+    {
+        m_uiBatchSize = uiBatchSize;
+        m_bCompress = bCompress;
+    }
+
+    bool IsBatchEnabled() const
+    {
+        return(m_uiBatchSize > 0);
+    }
+
+    /**
+     * @brief 添加一条日志到发往strLoggerIdentify的批量中
+     * @return 是否需要尽快发送（批量已满，且尚未请求过提前发送）
+     */
+    bool AddLog(const std::string& strLoggerIdentify, const std::string& strTraceId, int iLogLevel,
+            const char* szFileName, unsigned int uiFileLine, const char* szFunction, const char* szLogContent);
+
 private:
     std::list<MsgBody> m_listLogMsgBody;
+    std::unordered_map<std::string, std::unique_ptr<NetLogBatch>> m_mapLogBatch;    ///< 按LOGGER节点分批
+    uint32 m_uiBatchSize;
+    bool m_bCompress;
+    bool m_bFlushPending;           ///< 已请求提前发送
+    std::string m_strBatchData;
 };
 
 }
@@ -73,6 +73,17 @@ const RedisRequest& RedisStep::GenrateRedisRequest()
     return(m_oRedisRequest);
 }
 
+RespCmd RedisStep::GenerateRespCmd() const
+{
+    RespCmd oRespCmd;
+    oRespCmd.Append(m_strCmd);
+    for (size_t i = 0; i < m_vecCmdArguments.size(); ++i)
+    {
+        oRespCmd.Append(m_vecCmdArguments[i].first);
+    }
+    return(oRespCmd);
+}
+
 std::shared_ptr<RedisRequest>  RedisStep::MutableRedisRequest()
 {
     auto pRequest = std::make_shared<RedisRequest>();
@@ -14,6 +14,7 @@
 #include <list>
 #include "actor/step/Step.hpp"
 #include "pb/redis.pb.h"
+#include "codec/RespCmd.hpp"
 
 namespace neb
 {
@@ -82,6 +83,13 @@ public:
 
     const RedisRequest& GenrateRedisRequest();
 
+    /**
+     * @brief 以SetCmd()和Append()设置的命令生成RespCmd
+     * @note RespCmd引用本步骤保存的命令和参数，SetCmd()、Append()之前有效。
+     * SendTo(strIdentify, GenerateRespCmd())不再构造RedisRequest。
+     */
+    RespCmd GenerateRespCmd() const;
+
 protected:
     std::shared_ptr<RedisRequest> MutableRedisRequest();
 
@@ -8,6 +8,8 @@
  * Modify history:
  ******************************************************************************/
 #include "Step.hpp"
+#include "codec/RespView.hpp"
+#include "ios/MessagePool.hpp"
 
 namespace neb
 {
@@ -61,6 +63,19 @@ E_CMD_STATUS Step::Callback(std::shared_ptr<SocketChannel> pChannel,
     return(CMD_STATUS_FAULT);
 }
 
+E_CMD_STATUS Step::Callback(std::shared_ptr<SocketChannel> pChannel,
+            const RespView& oRespView)
+{
+    MessagePool<RedisReply>::Holder oRedisMsgHolder(GetRedisMsgPool());
+    RedisReply& oRedisReply = *oRedisMsgHolder;
+    if (!oRespView.ToRedisReply(oRedisReply))
+    {
+        LOG4_ERROR("failed to convert resp type %d to RedisReply", oRespView.Type());
+        return(CMD_STATUS_FAULT);
+    }
+    return(Callback(pChannel, oRedisReply));
+}
+
 E_CMD_STATUS Step::Callback(std::shared_ptr<SocketChannel> pChannel,
             const char* pRawData, uint32 uiRawDataSize)
 {
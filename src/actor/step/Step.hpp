@@ -18,6 +18,7 @@ namespace neb
 
 class ActorBuilder;
 class Chain;
+class RespView;
 
 class Step: public Actor
 {
@@ -57,6 +58,15 @@ public:
             const HttpMsg& oHttpMsg, void* data = NULL);
     virtual E_CMD_STATUS Callback(std::shared_ptr<SocketChannel> pChannel,
             const RedisReply& oRedisReply);
+    /**
+     * @brief redis响应的零拷贝回调
+     * @note oRespView引用连接的接收缓冲区，只在回调期间有效。默认实现把oRespView转换为
+     * RedisReply后调用Callback(pChannel, oRedisReply)，大数组响应等需要避免逐元素
+     * 构造RedisReply的步骤可覆盖此方法直接遍历oRespView。经StepRedisCluster转发的
+     * 响应（含跨槽位合并的结果）仍以RedisReply回调。
+     */
+    virtual E_CMD_STATUS Callback(std::shared_ptr<SocketChannel> pChannel,
+            const RespView& oRespView);
     virtual E_CMD_STATUS Callback(std::shared_ptr<SocketChannel> pChannel,
             const char* pRawData, uint32 uiRawDataSize);
 
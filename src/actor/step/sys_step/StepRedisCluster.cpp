@@ -18,91 +18,161 @@
 namespace neb
 {
 
-const uint16 StepRedisCluster::sc_unClusterSlots = 16384;
+const uint16 StepRedisCluster::sc_unClusterSlots;
+const uint16 StepRedisCluster::sc_unInvalidNode;
+const int32 StepRedisCluster::sc_iMaxRedirect;
+const int32 StepRedisCluster::sc_iExpiredSubRequest;
 
-const std::unordered_set<std::string> StepRedisCluster::s_setSupportExtractCmd =
+#define REDIS_CMD_R     (REDIS_CMD_FLAG_SUPPORTED)
+#define REDIS_CMD_W     (REDIS_CMD_FLAG_SUPPORTED | REDIS_CMD_FLAG_WRITE)
+
+struct tagRedisCmdDef
 {
-    // strings
-    "APPEND","BITCOUNT","BITFIELD","BITPOS","DECR","DECRBY","GET",
-    "GETBIT","GETRANGE","GETSET","INCR","INCRBY","INCRBYFLOAT","MGET",
-    "MSET","MSETNX","PSETEX","SET","SETBIT","SETEX","SETNX","SETRANGE",
-    "STRLEN",
-    // hashes
-    "HDEL","HEXISTS","HGET","HGETALL","HINCRBY","HINCRBYFLOAT","HKEYS",
-    "HLEN","HMGET","HMSET","HSET","HSETNX","HSTRLEN","HVALS","HSCAN",
-    // lists
-    "LINDEX","LINSERT","LLEN","LPOP","LPOS","LPUSH","LPUSHX","LRANGE",
-    "LREM","LSET","LTRIM","RPOP","PROPLPUSH","RPUSH","RPUSHX",
-    // sets
-    "SADD","SCARD","SISMEMBER","SMISMEMBER","SMEMBERS","SPOP",
-    "SRANDMEMBER","SREM","SSCAN",
-    // sorted sets
-    "ZADD","ZCARD","ZCOUNT","ZINCRBY","ZLEXCOUNT","ZPOPMAX","ZPOPMIN",
-    "ZRANGE","ZRANGEBYLEX","ZREVRANGEBYLEX","ZRANGEBYSCORE","ZRANK",
-    "ZREM","ZREMRANGEBYLEX","ZREMRANGEBYRANK","ZREMRANGEBYSCORE",
-    "ZREVRANGE","ZREVRANGEBYSCORE","ZREVRANK","ZSCORE","ZMSCORE","ZSCAN",
-    // keys
-    "DEL","DUMP","EXISTS","EXPIRE","EXPIREAT","MOVE","PERSIST","PEXPIRE",
-    "PEXPIREAT","PTTL","RANDOMKEY","RESTORE","SORT","TOUCH","TTL","TYPE",
-    "UNLINK"
+    const char* szCmd;
+    uint32 uiFlag;
 };
 
-const std::unordered_set<std::string> StepRedisCluster::s_setReadCmd =
+static const tagRedisCmdDef s_aRedisCmdDef[] =
 {
     // strings
-    "BITCOUNT","BITPOS","GET","GETBIT","GETRANGE","MGET","STRLEN",
+    {"APPEND", REDIS_CMD_W}, {"BITCOUNT", REDIS_CMD_R}, {"BITFIELD", REDIS_CMD_W}, {"BITPOS", REDIS_CMD_R},
+    {"DECR", REDIS_CMD_W}, {"DECRBY", REDIS_CMD_W}, {"GET", REDIS_CMD_R}, {"GETBIT", REDIS_CMD_R},
+    {"GETRANGE", REDIS_CMD_R}, {"GETSET", REDIS_CMD_W}, {"INCR", REDIS_CMD_W}, {"INCRBY", REDIS_CMD_W},
+    {"INCRBYFLOAT", REDIS_CMD_W}, {"MGET", REDIS_CMD_R | REDIS_CMD_FLAG_MULTI_KEY | REDIS_CMD_FLAG_MERGE_ARRAY},
+    {"MSET", REDIS_CMD_W | REDIS_CMD_FLAG_MULTI_KEY_VALUE | REDIS_CMD_FLAG_MERGE_STATUS}, {"MSETNX", REDIS_CMD_W | REDIS_CMD_FLAG_MULTI_KEY_VALUE},
+    {"PSETEX", REDIS_CMD_W}, {"SET", REDIS_CMD_W}, {"SETBIT", REDIS_CMD_W}, {"SETEX", REDIS_CMD_W},
+    {"SETNX", REDIS_CMD_W}, {"SETRANGE", REDIS_CMD_W}, {"STRLEN", REDIS_CMD_R},
     // hashes
-    "HEXISTS","HGET","HGETALL","HKEYS","HLEN","HMGET","HSTRLEN","HVALS","HSCAN",
+    {"HDEL", REDIS_CMD_W}, {"HEXISTS", REDIS_CMD_R}, {"HGET", REDIS_CMD_R}, {"HGETALL", REDIS_CMD_R},
+    {"HINCRBY", REDIS_CMD_W}, {"HINCRBYFLOAT", REDIS_CMD_W}, {"HKEYS", REDIS_CMD_R}, {"HLEN", REDIS_CMD_R},
+    {"HMGET", REDIS_CMD_R}, {"HMSET", REDIS_CMD_W}, {"HSET", REDIS_CMD_W}, {"HSETNX", REDIS_CMD_W},
+    {"HSTRLEN", REDIS_CMD_R}, {"HVALS", REDIS_CMD_R}, {"HSCAN", REDIS_CMD_R},
     // lists
-    "LINDEX","LLEN","LRANGE",
+    {"LINDEX", REDIS_CMD_R}, {"LINSERT", REDIS_CMD_W}, {"LLEN", REDIS_CMD_R}, {"LPOP", REDIS_CMD_W},
+    {"LPOS", REDIS_CMD_R}, {"LPUSH", REDIS_CMD_W}, {"LPUSHX", REDIS_CMD_W}, {"LRANGE", REDIS_CMD_R},
+    {"LREM", REDIS_CMD_W}, {"LSET", REDIS_CMD_W}, {"LTRIM", REDIS_CMD_W}, {"RPOP", REDIS_CMD_W},
+    {"RPOPLPUSH", REDIS_CMD_W}, {"RPUSH", REDIS_CMD_W}, {"RPUSHX", REDIS_CMD_W},
     // sets
-    "SCARD","SISMEMBER","SMISMEMBER","SMEMBERS","SRANDMEMBER","SSCAN",
+    {"SADD", REDIS_CMD_W}, {"SCARD", REDIS_CMD_R}, {"SISMEMBER", REDIS_CMD_R}, {"SMISMEMBER", REDIS_CMD_R},
+    {"SMEMBERS", REDIS_CMD_R}, {"SPOP", REDIS_CMD_W}, {"SRANDMEMBER", REDIS_CMD_R}, {"SREM", REDIS_CMD_W},
+    {"SSCAN", REDIS_CMD_R},
     // sorted sets
-    "ZCARD","ZCOUNT","ZLEXCOUNT","ZRANGE","ZRANGEBYLEX","ZRANGEBYSCORE","ZRANK",
-    "ZREVRANGE","ZREVRANGEBYLEX","ZREVRANGEBYSCORE","ZREVRANK",
-    "ZSCORE","ZMSCORE","ZSCAN",
+    {"ZADD", REDIS_CMD_W}, {"ZCARD", REDIS_CMD_R}, {"ZCOUNT", REDIS_CMD_R}, {"ZINCRBY", REDIS_CMD_W},
+    {"ZLEXCOUNT", REDIS_CMD_R}, {"ZPOPMAX", REDIS_CMD_W}, {"ZPOPMIN", REDIS_CMD_W}, {"ZRANGE", REDIS_CMD_R},
+    {"ZRANGEBYLEX", REDIS_CMD_R}, {"ZREVRANGEBYLEX", REDIS_CMD_R}, {"ZRANGEBYSCORE", REDIS_CMD_R},
+    {"ZRANK", REDIS_CMD_R}, {"ZREM", REDIS_CMD_W}, {"ZREMRANGEBYLEX", REDIS_CMD_W},
+    {"ZREMRANGEBYRANK", REDIS_CMD_W}, {"ZREMRANGEBYSCORE", REDIS_CMD_W}, {"ZREVRANGE", REDIS_CMD_R},
+    {"ZREVRANGEBYSCORE", REDIS_CMD_R}, {"ZREVRANK", REDIS_CMD_R}, {"ZSCORE", REDIS_CMD_R},
+    {"ZMSCORE", REDIS_CMD_R}, {"ZSCAN", REDIS_CMD_R},
     // keys
-    "DUMP","EXISTS","PTTL","RANDOMKEY","TTL","TYPE"
+    {"DEL", REDIS_CMD_W | REDIS_CMD_FLAG_MULTI_KEY | REDIS_CMD_FLAG_MERGE_SUM}, {"DUMP", REDIS_CMD_R},
+    {"EXISTS", REDIS_CMD_R | REDIS_CMD_FLAG_MULTI_KEY | REDIS_CMD_FLAG_MERGE_SUM}, {"EXPIRE", REDIS_CMD_W}, {"EXPIREAT", REDIS_CMD_W},
+    {"MOVE", REDIS_CMD_W}, {"PERSIST", REDIS_CMD_W}, {"PEXPIRE", REDIS_CMD_W}, {"PEXPIREAT", REDIS_CMD_W},
+    {"PTTL", REDIS_CMD_R}, {"RANDOMKEY", REDIS_CMD_R}, {"RESTORE", REDIS_CMD_W}, {"SORT", REDIS_CMD_W},
+    {"TOUCH", REDIS_CMD_W | REDIS_CMD_FLAG_MULTI_KEY | REDIS_CMD_FLAG_MERGE_SUM}, {"TTL", REDIS_CMD_R}, {"TYPE", REDIS_CMD_R},
+    {"UNLINK", REDIS_CMD_W | REDIS_CMD_FLAG_MULTI_KEY | REDIS_CMD_FLAG_MERGE_SUM}
 };
 
-const std::unordered_set<std::string> StepRedisCluster::s_setWriteCmd =
+#undef REDIS_CMD_R
+#undef REDIS_CMD_W
+
+static const uint32 s_uiRedisCmdTableSize = 512;       ///< 开放寻址表大小（2的幂，不小于命令数的4倍）
+static const uint32 s_uiRedisCmdMaxLen = 24;
+
+/**
+ * @brief 命令名hash（FNV-1a），同时把命令名转为大写写入szUpper
+ * @return 命令名过长时返回false
+ */
+static inline bool HashRedisCmd(const char* szCmd, size_t uiLength, char* szUpper, uint32& uiHash)
 {
-    // strings
-    "APPEND","BITFIELD","DECR","DECRBY","GETSET","INCR","INCRBY","INCRBYFLOAT",
-    "MSET","MSETNX","PSETEX","SET","SETBIT","SETEX","SETNX","SETRANGE",
-    // hashes
-    "HDEL","HINCRBY","HINCRBYFLOAT","HMSET","HSET","HSETNX",
-    // lists
-    "LINSERT","LPOS","LPUSH","LPUSHX","LREM","LSET","LTRIM","RPOP",
-    "PROPLPUSH","RPUSH","RPUSHX",
-    // sets
-    "SADD","SPOP","SREM",
-    // sorted sets
-    "ZADD","ZINCRBY","ZPOPMAX","ZPOPMIN",
-    "ZREM","ZREMRANGEBYLEX","ZREMRANGEBYRANK","ZREMRANGEBYSCORE",
-    // keys
-    "DEL","EXPIREAT","MOVE","PERSIST","PEXPIRE","PEXPIREAT",
-    "RESTORE","SORT","TOUCH","UNLINK"
-};
+    if (uiLength == 0 || uiLength > s_uiRedisCmdMaxLen)
+    {
+        return(false);
+    }
+    uiHash = 2166136261u;
+    for (size_t i = 0; i < uiLength; ++i)
+    {
+        char c = szCmd[i];
+        if (c >= 'a' && c <= 'z')
+        {
+            c -= ('a' - 'A');
+        }
+        szUpper[i] = c;
+        uiHash = (uiHash ^ (uint8)c) * 16777619u;
+    }
+    return(true);
+}
 
-const std::unordered_set<std::string> StepRedisCluster::s_setMultipleKeyCmd =
+/**
+ * @brief 由s_aRedisCmdDef构建的开放寻址表（线性探测），首次使用时构建
+ */
+static const tagRedisCmdDef* const* GetRedisCmdTable()
 {
-    "MGET","DEL","EXISTS","TOUCH","UNLINK"
-};
+    static const tagRedisCmdDef* s_aTable[s_uiRedisCmdTableSize] = {nullptr};
+    static bool s_bBuilt = []()->bool
+    {
+        char szUpper[s_uiRedisCmdMaxLen];
+        uint32 uiHash = 0;
+        for (size_t i = 0; i < sizeof(s_aRedisCmdDef) / sizeof(tagRedisCmdDef); ++i)
+        {
+            HashRedisCmd(s_aRedisCmdDef[i].szCmd, strlen(s_aRedisCmdDef[i].szCmd), szUpper, uiHash);
+            uint32 uiPos = uiHash & (s_uiRedisCmdTableSize - 1);
+            while (nullptr != s_aTable[uiPos])
+            {
+                uiPos = (uiPos + 1) & (s_uiRedisCmdTableSize - 1);
+            }
+            s_aTable[uiPos] = &s_aRedisCmdDef[i];
+        }
+        return(true);
+    }();
+    (void)s_bBuilt;
+    return(s_aTable);
+}
 
-const std::unordered_set<std::string> StepRedisCluster::s_setMultipleKeyValueCmd =
+uint32 StepRedisCluster::ClassifyCmd(const std::string& strCmd)
 {
-    "MSET","MSETNX"
-};
+    char szUpper[s_uiRedisCmdMaxLen];
+    uint32 uiHash = 0;
+    if (!HashRedisCmd(strCmd.data(), strCmd.size(), szUpper, uiHash))
+    {
+        return(0);
+    }
+    const tagRedisCmdDef* const* pTable = GetRedisCmdTable();
+    for (uint32 uiPos = uiHash & (s_uiRedisCmdTableSize - 1);
+            nullptr != pTable[uiPos]; uiPos = (uiPos + 1) & (s_uiRedisCmdTableSize - 1))
+    {
+        if (0 == strncmp(pTable[uiPos]->szCmd, szUpper, strCmd.size())
+                && '\0' == pTable[uiPos]->szCmd[strCmd.size()])
+        {
+            return(pTable[uiPos]->uiFlag);
+        }
+    }
+    return(0);
+}
+
+uint16 StepRedisCluster::GetSlot(const std::string& strKey)
+{
+    size_t uiTagBegin = strKey.find('{');
+    if (std::string::npos != uiTagBegin)
+    {
+        size_t uiTagEnd = strKey.find('}', uiTagBegin + 1);
+        if (std::string::npos != uiTagEnd && uiTagEnd > uiTagBegin + 1)
+        {
+            return(crc16(strKey.data() + uiTagBegin + 1, uiTagEnd - uiTagBegin - 1) & (sc_unClusterSlots - 1));
+        }
+    }
+    return(crc16(strKey.data(), strKey.size()) & (sc_unClusterSlots - 1));
+}
 
 StepRedisCluster::StepRedisCluster(
         const std::string& strIdentify,  bool bWithSsl, bool bPipeline, bool bEnableReadOnly)
     : RedisStep(nullptr, 10.0),
       m_bWithSsl(bWithSsl), m_bPipeline(bPipeline), m_bEnableReadOnly(bEnableReadOnly),
-      m_uiAddressIndex(0),
+      m_uiAddressIndex(0), m_bSlotsRefreshing(false), m_lSlotsRefreshTime(0),
       m_strIdentify(strIdentify)
 {
     Split(strIdentify, ",", m_vecAddress);
+    m_aSlot2Node.fill(sc_unInvalidNode);
 }
 
 StepRedisCluster::~StepRedisCluster()
@@ -123,13 +193,14 @@ E_CMD_STATUS StepRedisCluster::Callback(
     if (step_iter == m_mapPipelineRequest.end() || step_iter->second.size() == 0)
     {
         LOG4_ERROR("no \"%s\" found in m_mapPipelineStep", pChannel->GetIdentify().c_str());
+        return(CMD_STATUS_RUNNING);
     }
     auto pRedisRequest = step_iter->second.front();
     uint32 uiRealStepSeq = (uint32)pRedisRequest->integer();
     step_iter->second.pop();
     if (uiRealStepSeq == GetSequence())
     {
-        if (pRedisRequest->element(0).str() == "ASK")
+        if (pRedisRequest->element(0).str() == REDIS_COMMAND_ASKING)
         {
             CmdAskingCallback(pChannel, pChannel->GetIdentify(), oRedisReply);
         }
@@ -145,154 +216,22 @@ E_CMD_STATUS StepRedisCluster::Callback(
     }
     else
     {
-        auto num_iter = m_mapStepEmitNum.find(uiRealStepSeq);
-        if (num_iter == m_mapStepEmitNum.end()) // 单key请求的响应
+        if (IsExpiredSubRequest(*pRedisRequest))
+        {
+            LOG4_DEBUG("drop the late reply of a timed out cross slot request of step %u", uiRealStepSeq);
+            return(CMD_STATUS_RUNNING);
+        }
+        if (REDIS_REPLY_ERROR == oRedisReply.type() && Redirect(oRedisReply, pRedisRequest))
+        {
+            return(CMD_STATUS_RUNNING);
+        }
+        if (m_mapGatherRequest.find(uiRealStepSeq) == m_mapGatherRequest.end()) // 未拆分请求的响应
         {
-            if (REDIS_REPLY_ERROR == oRedisReply.type())
-            {
-                std::vector<std::string> vecMsg;
-                Split(oRedisReply.str(), " ", vecMsg);
-                if (vecMsg.size() >= 3)
-                {
-                    if (vecMsg[0] == "MOVED")
-                    {
-                        SendTo(vecMsg[2], pRedisRequest);
-                        SendCmdClusterSlots();
-                        return(CMD_STATUS_RUNNING);
-                    }
-                    if (vecMsg[0] == "ASK")
-                    {
-                        AddToAskingQueue(vecMsg[2], pRedisRequest);
-                        SendCmdAsking(vecMsg[2]);
-                        return(CMD_STATUS_RUNNING);
-                    }
-                }
-            }
             GetLabor(this)->GetActorBuilder()->OnMessage(pChannel, oRedisReply, uiRealStepSeq);
         }
-        else    // 多key请求的响应
+        else    // 跨槽位拆分的子命令的响应
         {
-            if (REDIS_REPLY_ARRAY == oRedisReply.type())
-            {
-                auto reply_iter = m_mapReply.find(uiRealStepSeq);
-                if (reply_iter == m_mapReply.end())
-                {
-                    LOG4_ERROR("no m_mapReply found for step %u", uiRealStepSeq);
-                    return(CMD_STATUS_RUNNING);
-                }
-                std::vector<uint32> vecElementIndex;
-                for (int i = 1; i < pRedisRequest->element_size(); ++i)  // element(0).str() is cmd
-                {
-                    if (pRedisRequest->element(i).integer() > 0 || i == 1)
-                    {
-                        vecElementIndex.push_back((uint32)pRedisRequest->element(i).integer());
-                    }
-                }
-                for (uint32 j = 0; j < vecElementIndex.size(); ++j)
-                {
-                    if (vecElementIndex[j] < reply_iter->second.size())
-                    {
-                        if (reply_iter->second[vecElementIndex[j]] == nullptr)
-                        {
-                            reply_iter->second[vecElementIndex[j]] = new RedisReply();
-                        }
-                        reply_iter->second[vecElementIndex[j]]->CopyFrom(oRedisReply.element(j));
-                    }
-                    else
-                    {
-                        LOG4_ERROR("element index %u larger than reply size %u", vecElementIndex[j], reply_iter->second.size());
-                    }
-                }
-                uint32 uiReqReplyOdd = (pRedisRequest->element_size() - 1) % oRedisReply.element_size();
-                if (uiReqReplyOdd != 0)
-                {
-                    LOG4_ERROR("request and reply not match for %s", pRedisRequest->element(0).str().c_str());
-                }
-                num_iter->second--;
-                if (num_iter->second == 0)
-                {
-                    RedisReply oFinalReply;
-                    oFinalReply.set_type(oRedisReply.type());
-                    for (size_t k = 0; k < reply_iter->second.size(); ++k)
-                    {
-                        oFinalReply.mutable_element()->AddAllocated(reply_iter->second[k]);
-                        reply_iter->second[k] = nullptr;
-                    }
-                    GetLabor(this)->GetActorBuilder()->OnMessage(pChannel, oFinalReply, uiRealStepSeq);
-                    m_mapStepEmitNum.erase(num_iter);
-                    m_mapReply.erase(reply_iter);
-                }
-            }
-            else
-            {
-                if (REDIS_REPLY_ERROR == oRedisReply.type())
-                {
-                    std::vector<std::string> vecMsg;
-                    Split(oRedisReply.str(), " ", vecMsg);
-                    if (vecMsg.size() >= 3)
-                    {
-                        if (vecMsg[0] == "MOVED")
-                        {
-                            SendTo(vecMsg[2], pRedisRequest);
-                            SendCmdClusterSlots();
-                            return(CMD_STATUS_RUNNING);
-                        }
-                        if (vecMsg[0] == "ASK")
-                        {
-                            AddToAskingQueue(vecMsg[2], pRedisRequest);
-                            SendCmdAsking(vecMsg[2]);
-                            return(CMD_STATUS_RUNNING);
-                        }
-                        if (vecMsg[0] == "CROSSSLOT")
-                        {
-                            SendCmdClusterSlots();
-                        }
-                    }
-                }
-                auto reply_iter = m_mapReply.find(uiRealStepSeq);
-                if (reply_iter == m_mapReply.end())
-                {
-                    LOG4_ERROR("no m_mapReply found for step %u", uiRealStepSeq);
-                    return(CMD_STATUS_RUNNING);
-                }
-                std::vector<uint32> vecElementIndex;
-                for (int i = 1; i < pRedisRequest->element_size(); ++i)  // element(0).str() is cmd
-                {
-                    if (pRedisRequest->element(i).integer() > 0 || i == 1)
-                    {
-                        vecElementIndex.push_back((uint32)pRedisRequest->element(i).integer());
-                    }
-                }
-                for (uint32 j = 0; j < vecElementIndex.size(); ++j)
-                {
-                    if (vecElementIndex[j] < reply_iter->second.size())
-                    {
-                        if (reply_iter->second[vecElementIndex[j]] == nullptr)
-                        {
-                            reply_iter->second[vecElementIndex[j]] = new RedisReply();
-                        }
-                        reply_iter->second[vecElementIndex[j]]->CopyFrom(oRedisReply);
-                    }
-                    else
-                    {
-                        LOG4_ERROR("element index %u larger than reply size %u", vecElementIndex[j], reply_iter->second.size());
-                    }
-                }
-                num_iter->second--;
-                if (num_iter->second == 0)
-                {
-                    RedisReply oFinalReply;
-                    oFinalReply.set_type(oRedisReply.type());
-                    for (size_t k = 0; k < reply_iter->second.size(); ++k)
-                    {
-                        oFinalReply.mutable_element()->AddAllocated(reply_iter->second[k]);
-                        reply_iter->second[k] = nullptr;
-                    }
-                    GetLabor(this)->GetActorBuilder()->OnMessage(pChannel, oFinalReply, uiRealStepSeq);
-                    m_mapStepEmitNum.erase(num_iter);
-                    m_mapReply.erase(reply_iter);
-                }
-            }
+            Gather(pChannel, uiRealStepSeq, *pRedisRequest, oRedisReply);
         }
     }
     return(CMD_STATUS_RUNNING);
@@ -300,33 +239,36 @@ E_CMD_STATUS StepRedisCluster::Callback(
 
 E_CMD_STATUS StepRedisCluster::Timeout()
 {
-    for (auto timeout_iter = m_mapTimeoutStep.begin(); timeout_iter != m_mapTimeoutStep.end(); )
+    CheckGatherTimeout();
+    return(CMD_STATUS_RUNNING);
+}
+
+void StepRedisCluster::CheckGatherTimeout()
+{
+    time_t lNowTime = GetNowTime();
+    while (!m_mapTimeoutStep.empty() && lNowTime - m_mapTimeoutStep.begin()->first >= GetTimeout())
     {
-        if (GetNowTime() - timeout_iter->first >= GetTimeout())
+        auto timeout_iter = m_mapTimeoutStep.begin();
+        for (uint32 i = 0; i < timeout_iter->second.size(); ++i)
         {
-            for (uint32 i = 0; i < timeout_iter->second.size(); ++i)
+            uint32 uiStepSeq = timeout_iter->second[i];
+            auto gather_iter = m_mapGatherRequest.find(uiStepSeq);
+            // 同一seq的命令完成后可能又发起了新的跨槽位命令，只处理本次登记的那一个
+            if (gather_iter == m_mapGatherRequest.end() || gather_iter->second.lRegisterTime != timeout_iter->first)
             {
-                auto reply_iter = m_mapReply.find(timeout_iter->second[i]);
-                if (reply_iter != m_mapReply.end())
-                {
-                    m_mapReply.erase(reply_iter);
-                }
-                auto num_iter = m_mapStepEmitNum.find(timeout_iter->second[i]);
-                if (num_iter != m_mapStepEmitNum.end())
-                {
-                    m_mapStepEmitNum.erase(num_iter);
-                }
+                continue;
             }
-            timeout_iter->second.clear();
-            m_mapTimeoutStep.erase(timeout_iter);
-            timeout_iter = m_mapTimeoutStep.begin();
-        }
-        else
-        {
-            break;
+            for (auto& pSubRequest : gather_iter->second.vecSubRequest)
+            {
+                pSubRequest->mutable_element(0)->set_integer(sc_iExpiredSubRequest);
+            }
+            LOG4_WARNING("cross slot request of step %u timeout, %u sub requests not replied.",
+                    uiStepSeq, gather_iter->second.uiWaitingNum);
+            m_mapGatherRequest.erase(gather_iter);
+            GetLabor(this)->GetActorBuilder()->OnError(nullptr, uiStepSeq, ERR_TIMEOUT, "cross slot request timeout");
         }
+        m_mapTimeoutStep.erase(timeout_iter);
     }
-    return(CMD_STATUS_RUNNING);
 }
 
 E_CMD_STATUS StepRedisCluster::ErrBack(
@@ -337,6 +279,8 @@ E_CMD_STATUS StepRedisCluster::ErrBack(
     if (step_iter == m_mapPipelineRequest.end() || step_iter->second.size() == 0)
     {
         LOG4_INFO("no \"%s\" found in m_mapPipelineStep", pChannel->GetIdentify().c_str());
+        AskingQueueErrBack(pChannel, iErrno, strErrMsg);
+        return(CMD_STATUS_RUNNING);
     }
     while (step_iter->second.size() > 0)
     {
@@ -347,61 +291,15 @@ E_CMD_STATUS StepRedisCluster::ErrBack(
         {
             SendCmdClusterSlots();
         }
-        else
+        else if (!IsExpiredSubRequest(*pRedisRequest))     // 已超时的子命令已回调过调用方
         {
-            auto num_iter = m_mapStepEmitNum.find(uiRealStepSeq);
-            if (num_iter == m_mapStepEmitNum.end()) // 单key请求的响应
+            if (m_mapGatherRequest.find(uiRealStepSeq) == m_mapGatherRequest.end()) // 未拆分的请求
             {
                 GetLabor(this)->GetActorBuilder()->OnError(pChannel, uiRealStepSeq, iErrno, strErrMsg);
             }
             else
             {
-                auto reply_iter = m_mapReply.find(uiRealStepSeq);
-                if (reply_iter == m_mapReply.end())
-                {
-                    LOG4_ERROR("no m_mapReply found for step %u", uiRealStepSeq);
-                    continue;
-                }
-                std::vector<uint32> vecElementIndex;
-                for (int i = 1; i < pRedisRequest->element_size(); ++i)  // element(0).str() is cmd
-                {
-                    if (pRedisRequest->element(i).integer() > 0 || i == 1)
-                    {
-                        vecElementIndex.push_back((uint32)pRedisRequest->element(i).integer());
-                    }
-                }
-                RedisReply oRedisReply;
-                oRedisReply.set_type(REDIS_REPLY_ERROR);
-                oRedisReply.set_str(strErrMsg);
-                for (uint32 j = 0; j < vecElementIndex.size(); ++j)
-                {
-                    if (vecElementIndex[j] < reply_iter->second.size())
-                    {
-                        if (reply_iter->second[vecElementIndex[j]] == nullptr)
-                        {
-                            reply_iter->second[vecElementIndex[j]] = new RedisReply();
-                        }
-                        reply_iter->second[vecElementIndex[j]]->CopyFrom(oRedisReply);
-                    }
-                    else
-                    {
-                        LOG4_ERROR("element index %u larger than reply size %u", vecElementIndex[j], reply_iter->second.size());
-                    }
-                }
-                num_iter->second--;
-                if (num_iter->second == 0)
-                {
-                    RedisReply oFinalReply;
-                    oFinalReply.set_type(REDIS_REPLY_ARRAY);
-                    for (size_t k = 0; k < reply_iter->second.size(); ++k)
-                    {
-                        oFinalReply.mutable_element()->AddAllocated(reply_iter->second[k]);
-                        reply_iter->second[k] = nullptr;
-                    }
-                    GetLabor(this)->GetActorBuilder()->OnMessage(pChannel, oFinalReply, uiRealStepSeq);
-                    m_mapStepEmitNum.erase(num_iter);
-                    m_mapReply.erase(reply_iter);
-                }
+                GatherError(pChannel, uiRealStepSeq, *pRedisRequest, strErrMsg);
             }
         }
     }
@@ -412,29 +310,48 @@ E_CMD_STATUS StepRedisCluster::ErrBack(
 bool StepRedisCluster::SendTo(const std::string& strIdentify, const RedisMsg& oRedisMsg,
             bool bWithSsl, bool bPipeline, uint32 uiStepSeq)
 {
-    if (m_mapSlot2Node.size() > 0)
+    if (m_vecRedisNode.size() > 0)
     {
         return(Dispatch(oRedisMsg, uiStepSeq));
     }
     else
     {
         m_vecWaittingRequest.push_back(std::make_pair(uiStepSeq, oRedisMsg));
-        return(SendCmdClusterSlots());
+        return(RefreshClusterSlots());
     }
 }
 
+bool StepRedisCluster::SendTo(const std::string& strIdentify, const RespCmd& oRespCmd,
+            bool bWithSsl, bool bPipeline, uint32 uiStepSeq)
+{
+    m_oRespCmdRequest.Clear();
+    oRespCmd.ToRedisMsg(m_oRespCmdRequest);
+    return(SendTo(strIdentify, m_oRespCmdRequest, bWithSsl, bPipeline, uiStepSeq));
+}
+
 bool StepRedisCluster::SendTo(const std::string& strIdentify, std::shared_ptr<RedisMsg> pRedisMsg)
+{
+    return(SendTo(InternServer(strIdentify), pRedisMsg));
+}
+
+bool StepRedisCluster::SendTo(uint16 unServer, std::shared_ptr<RedisMsg> pRedisMsg)
 {
     LOG4_TRACE("%s", pRedisMsg->DebugString().c_str());
-    bool bResult = GetLabor(this)->GetDispatcher()->SendTo(strIdentify, CODEC_RESP, m_bWithSsl, m_bPipeline, (*pRedisMsg.get()), GetSequence());
+    if (unServer >= m_vecRedisServer.size())
+    {
+        LOG4_ERROR("invalid redis server %u", unServer);
+        return(false);
+    }
+    const RedisServer& stServer = m_vecRedisServer[unServer];
+    bool bResult = GetLabor(this)->GetDispatcher()->SendTo(stServer.uiEndpoint, CODEC_RESP, m_bWithSsl, m_bPipeline, (*pRedisMsg.get()), GetSequence());
     if (bResult)
     {
-        auto iter = m_mapPipelineRequest.find(strIdentify);
+        auto iter = m_mapPipelineRequest.find(stServer.strIdentify);
         if (iter == m_mapPipelineRequest.end())
         {
             std::queue<std::shared_ptr<RedisMsg>> queStep;
             queStep.push(pRedisMsg);
-            m_mapPipelineRequest.insert(std::make_pair(strIdentify, std::move(queStep)));
+            m_mapPipelineRequest.insert(std::make_pair(stServer.strIdentify, std::move(queStep)));
         }
         else
         {
@@ -444,40 +361,194 @@ bool StepRedisCluster::SendTo(const std::string& strIdentify, std::shared_ptr<Re
     return(bResult);
 }
 
-bool StepRedisCluster::ExtractCmd(const RedisMsg& oRedisMsg,
-        std::string& strCmd, std::vector<std::string>& vecHashKeys,
-        int& iReadOrWrite, int& iKeyInterval)
+bool StepRedisCluster::SendTo(uint16 unServer, const std::vector<std::shared_ptr<RedisMsg>>& vecRedisMsg,
+        std::vector<std::shared_ptr<RedisMsg>>& vecFailedMsg)
 {
-    auto GetTag = [](const std::string& strKey, std::string& strTag)->void
+    if (unServer >= m_vecRedisServer.size())
+    {
+        LOG4_ERROR("invalid redis server %u", unServer);
+        vecFailedMsg.insert(vecFailedMsg.end(), vecRedisMsg.begin(), vecRedisMsg.end());
+        return(false);
+    }
+    if (!m_bPipeline)
     {
-        size_t uiTagBegin = strKey.find_first_of("{");
-        if (std::string::npos == uiTagBegin)
+        // 非pipeline连接一次只能有一个待响应请求，逐条发送；已发出的子命令照常等待响应
+        bool bResult = true;
+        for (auto it = vecRedisMsg.begin(); it != vecRedisMsg.end(); ++it)
         {
-            strTag = strKey;
+            if (!SendTo(unServer, *it))
+            {
+                vecFailedMsg.push_back(*it);
+                bResult = false;
+            }
         }
-        else
+        return(bResult);
+    }
+    const RedisServer& stServer = m_vecRedisServer[unServer];
+    LOG4_TRACE("send %u cmds to %s", (uint32)vecRedisMsg.size(), stServer.strIdentify.c_str());
+    bool bResult = GetLabor(this)->GetDispatcher()->SendTo(stServer.uiEndpoint, CODEC_RESP, m_bWithSsl, m_bPipeline, vecRedisMsg, GetSequence());
+    if (!bResult)
+    {
+        vecFailedMsg.insert(vecFailedMsg.end(), vecRedisMsg.begin(), vecRedisMsg.end());    // 整批编码失败时已回滚
+    }
+    else
+    {
+        auto iter = m_mapPipelineRequest.find(stServer.strIdentify);
+        if (iter == m_mapPipelineRequest.end())
+        {
+            std::queue<std::shared_ptr<RedisMsg>> queStep;
+            iter = m_mapPipelineRequest.insert(std::make_pair(stServer.strIdentify, std::move(queStep))).first;
+        }
+        for (auto it = vecRedisMsg.begin(); it != vecRedisMsg.end(); ++it)
         {
-            size_t uiTagEnd = strKey.find_last_of("}");
-            if (std::string::npos == uiTagEnd || uiTagEnd <= uiTagBegin + 1)
+            iter->second.push(*it);
+        }
+    }
+    return(bResult);
+}
+
+bool StepRedisCluster::Redirect(const RedisReply& oRedisReply, std::shared_ptr<RedisMsg> pRedisRequest)
+{
+    std::vector<std::string> vecMsg;
+    Split(oRedisReply.str(), " ", vecMsg);
+    if (vecMsg.size() > 0 && vecMsg[0] == "CROSSSLOT")
+    {
+        RefreshClusterSlots();
+        return(false);
+    }
+    if (vecMsg.size() < 3 || (vecMsg[0] != "MOVED" && vecMsg[0] != "ASK"))
+    {
+        return(false);
+    }
+    // 借用命令名元素的integer记录重定向次数，防止槽位迁移异常时无限重定向
+    auto pCmd = pRedisRequest->mutable_element(0);
+    if (pCmd->integer() >= sc_iMaxRedirect)
+    {
+        LOG4_ERROR("%s redirected more than %d times, last: %s",
+                pCmd->str().c_str(), sc_iMaxRedirect, oRedisReply.str().c_str());
+        return(false);
+    }
+    pCmd->set_integer(pCmd->integer() + 1);
+    if (vecMsg[0] == "MOVED")
+    {
+        OnMoved((uint16)atoi(vecMsg[1].c_str()), vecMsg[2]);
+        return(SendTo(vecMsg[2], pRedisRequest));
+    }
+    AddToAskingQueue(vecMsg[2], pRedisRequest);
+    SendCmdAsking(vecMsg[2]);
+    return(true);
+}
+
+bool StepRedisCluster::Gather(std::shared_ptr<SocketChannel> pChannel, uint32 uiStepSeq,
+        const RedisMsg& oSubRequest, const RedisReply& oSubReply)
+{
+    auto gather_iter = m_mapGatherRequest.find(uiStepSeq);
+    if (gather_iter == m_mapGatherRequest.end())
+    {
+        LOG4_ERROR("no gather request found for step %u", uiStepSeq);
+        return(false);
+    }
+    RedisGather& stGather = gather_iter->second;
+    if (REDIS_REPLY_ERROR == oSubReply.type() && stGather.strErrMsg.empty())
+    {
+        stGather.strErrMsg = oSubReply.str();
+    }
+    if (stGather.uiCmdFlag & REDIS_CMD_FLAG_MERGE_ARRAY)
+    {
+        // 子命令中key元素的integer为该key在原命令中的序号，子命令结果依次写回原序号位置
+        int iKeyInterval = (stGather.uiCmdFlag & REDIS_CMD_FLAG_MULTI_KEY_VALUE) ? 2 : 1;
+        int iReplyIndex = 0;
+        for (int i = 1; i < oSubRequest.element_size(); i += iKeyInterval, ++iReplyIndex)
+        {
+            int iKeyIndex = (int)oSubRequest.element(i).integer();
+            if (iKeyIndex >= stGather.oReply.element_size())
+            {
+                LOG4_ERROR("key index %d larger than reply size %d", iKeyIndex, stGather.oReply.element_size());
+                continue;
+            }
+            if (REDIS_REPLY_ARRAY != oSubReply.type())
+            {
+                stGather.oReply.mutable_element(iKeyIndex)->CopyFrom(oSubReply);
+            }
+            else if (iReplyIndex < oSubReply.element_size())
             {
-                strTag = strKey;
+                stGather.oReply.mutable_element(iKeyIndex)->CopyFrom(oSubReply.element(iReplyIndex));
             }
             else
             {
-                ++uiTagBegin;
-                size_t uiTagLen = uiTagEnd - uiTagBegin;
-                if (uiTagLen > 0)
-                {
-                    strTag = strKey.substr(uiTagBegin, uiTagLen);
-                }
-                else
-                {
-                    strTag = strKey;
-                }
+                LOG4_ERROR("request and reply not match for %s", oSubRequest.element(0).str().c_str());
             }
         }
-    };
+    }
+    else if (stGather.uiCmdFlag & REDIS_CMD_FLAG_MERGE_SUM)
+    {
+        if (REDIS_REPLY_INTEGER == oSubReply.type())
+        {
+            stGather.llSum += oSubReply.integer();
+        }
+        else if (stGather.strErrMsg.empty())
+        {
+            stGather.strErrMsg = "unexpected reply type " + std::to_string(oSubReply.type());
+        }
+    }
+    else
+    {
+        if (REDIS_REPLY_STATUS != oSubReply.type() && stGather.strErrMsg.empty())
+        {
+            stGather.strErrMsg = "unexpected reply type " + std::to_string(oSubReply.type());
+        }
+    }
+    if (stGather.uiWaitingNum > 0)
+    {
+        --stGather.uiWaitingNum;
+    }
+    if (stGather.uiWaitingNum > 0 || nullptr == pChannel)
+    {
+        return(stGather.uiWaitingNum == 0);
+    }
+
+    if (stGather.uiCmdFlag & REDIS_CMD_FLAG_MERGE_ARRAY)
+    {
+        // 部分子命令失败时，失败key对应的元素为错误，其余key的结果照常返回
+        GetLabor(this)->GetActorBuilder()->OnMessage(pChannel, stGather.oReply, uiStepSeq);
+    }
+    else
+    {
+        // DEL、MSET等部分子命令失败时，成功的子命令已生效，整体结果以首个错误返回
+        RedisReply oFinalReply;
+        if (!stGather.strErrMsg.empty())
+        {
+            oFinalReply.set_type(REDIS_REPLY_ERROR);
+            oFinalReply.set_str(stGather.strErrMsg);
+        }
+        else if (stGather.uiCmdFlag & REDIS_CMD_FLAG_MERGE_SUM)
+        {
+            oFinalReply.set_type(REDIS_REPLY_INTEGER);
+            oFinalReply.set_integer(stGather.llSum);
+        }
+        else
+        {
+            oFinalReply.set_type(REDIS_REPLY_STATUS);
+            oFinalReply.set_str("OK");
+        }
+        GetLabor(this)->GetActorBuilder()->OnMessage(pChannel, oFinalReply, uiStepSeq);
+    }
+    m_mapGatherRequest.erase(gather_iter);
+    return(true);
+}
+
+bool StepRedisCluster::GatherError(std::shared_ptr<SocketChannel> pChannel, uint32 uiStepSeq,
+        const RedisMsg& oSubRequest, const std::string& strErrMsg)
+{
+    RedisReply oRedisReply;
+    oRedisReply.set_type(REDIS_REPLY_ERROR);
+    oRedisReply.set_str(strErrMsg);
+    return(Gather(pChannel, uiStepSeq, oSubRequest, oRedisReply));
+}
 
+bool StepRedisCluster::ExtractCmd(const RedisMsg& oRedisMsg,
+        std::vector<uint16>& vecSlot, uint32& uiCmdFlag)
+{
     if (REDIS_REPLY_ARRAY == oRedisMsg.type())
     {
         if (oRedisMsg.element_size() == 0)
@@ -491,14 +562,14 @@ bool StepRedisCluster::ExtractCmd(const RedisMsg& oRedisMsg,
                     "invalid redis cmd: %s", oRedisMsg.DebugString().c_str());
             return(false);
         }
-        strCmd = oRedisMsg.element(0).str();
-        if (s_setSupportExtractCmd.find(strCmd) == s_setSupportExtractCmd.end())
+        const std::string& strCmd = oRedisMsg.element(0).str();
+        uiCmdFlag = ClassifyCmd(strCmd);
+        if (!(uiCmdFlag & REDIS_CMD_FLAG_SUPPORTED))
         {
             LOG4_ERROR("cmd %s not supported by StepRedisCluster", strCmd.c_str());
             return(false);
         }
-        std::string strTag;
-        if (s_setMultipleKeyCmd.find(strCmd) != s_setMultipleKeyCmd.end())
+        if (uiCmdFlag & REDIS_CMD_FLAG_MULTI_KEY)
         {
             if (oRedisMsg.element_size() < 2)
             {
@@ -514,21 +585,11 @@ bool StepRedisCluster::ExtractCmd(const RedisMsg& oRedisMsg,
                             "invalid redis cmd: %s", oRedisMsg.DebugString().c_str());
                     return(false);
                 }
-                GetTag(oRedisMsg.element(i).str(), strTag);
-                vecHashKeys.push_back(strTag);
-            }
-            iKeyInterval = 1;
-            if (s_setWriteCmd.find(strCmd) == s_setWriteCmd.end())
-            {
-                iReadOrWrite = REDIS_CMD_READ;
-            }
-            else
-            {
-                iReadOrWrite = REDIS_CMD_WRITE;
+                vecSlot.push_back(GetSlot(oRedisMsg.element(i).str()));
             }
             return(true);
         }
-        else if (s_setMultipleKeyValueCmd.find(strCmd) != s_setMultipleKeyValueCmd.end())
+        else if (uiCmdFlag & REDIS_CMD_FLAG_MULTI_KEY_VALUE)
         {
             if (!(oRedisMsg.element_size() & 0x0001)) // (oRedisMsg.element_size() % 2 == 0)
             {
@@ -536,28 +597,15 @@ bool StepRedisCluster::ExtractCmd(const RedisMsg& oRedisMsg,
                         strCmd.c_str(), oRedisMsg.DebugString().c_str());
                 return(false);
             }
-            for (int i = 1; i < oRedisMsg.element_size(); ++i)
+            for (int i = 1; i < oRedisMsg.element_size(); i += 2)
             {
-                if (i & 0x0001) // (i % 2 == 1)
+                if (REDIS_REPLY_STRING != oRedisMsg.element(i).type() || oRedisMsg.element(i).str().size() == 0)
                 {
-                    if (REDIS_REPLY_STRING != oRedisMsg.element(i).type() || oRedisMsg.element(i).str().size() == 0)
-                    {
-                        LOG4_ERROR("cmd element be a REDIS_REPLY_STRING and key length can not be 0, "
-                                "invalid redis cmd: %s", oRedisMsg.DebugString().c_str());
-                        return(false);
-                    }
-                    GetTag(oRedisMsg.element(i).str(), strTag);
-                    vecHashKeys.push_back(strTag);
+                    LOG4_ERROR("cmd element be a REDIS_REPLY_STRING and key length can not be 0, "
+                            "invalid redis cmd: %s", oRedisMsg.DebugString().c_str());
+                    return(false);
                 }
-            }
-            iKeyInterval = 2;
-            if (s_setWriteCmd.find(strCmd) == s_setWriteCmd.end())
-            {
-                iReadOrWrite = REDIS_CMD_READ;
-            }
-            else
-            {
-                iReadOrWrite = REDIS_CMD_WRITE;
+                vecSlot.push_back(GetSlot(oRedisMsg.element(i).str()));
             }
             LOG4_TRACE("oRedisMsg.element_size() = %d", oRedisMsg.element_size());
             return(true);
@@ -575,16 +623,7 @@ bool StepRedisCluster::ExtractCmd(const RedisMsg& oRedisMsg,
                 LOG4_ERROR("cmd element be a REDIS_REPLY_STRING, invalid redis cmd: %s", oRedisMsg.DebugString().c_str());
                 return(false);
             }
-            GetTag(oRedisMsg.element(1).str(), strTag);
-            vecHashKeys.emplace_back(std::move(strTag));
-            if (s_setWriteCmd.find(strCmd) == s_setWriteCmd.end())
-            {
-                iReadOrWrite = REDIS_CMD_WRITE;
-            }
-            else
-            {
-                iReadOrWrite = REDIS_CMD_READ;
-            }
+            vecSlot.push_back(GetSlot(oRedisMsg.element(1).str()));
             return(true);
         }
     }
@@ -595,29 +634,29 @@ bool StepRedisCluster::ExtractCmd(const RedisMsg& oRedisMsg,
     }
 }
 
-bool StepRedisCluster::GetRedisNode(int iSlotId, int iReadOrWrite, std::string& strNodeIdentify, bool& bIsMaster) const
+bool StepRedisCluster::GetRedisNode(uint16 unSlot, int iReadOrWrite, uint16& unServer, bool& bIsMaster)
 {
-    auto slot_iter = m_mapSlot2Node.find(iSlotId);
-    if (slot_iter == m_mapSlot2Node.end())
+    uint16 unNode = m_aSlot2Node[unSlot & (sc_unClusterSlots - 1)];
+    if (sc_unInvalidNode == unNode)
     {
-        LOG4_ERROR("no redis node found for slot %d", iSlotId);
+        LOG4_ERROR("no redis node found for slot %u", unSlot);
         return(false);
     }
+    RedisNode& stNode = m_vecRedisNode[unNode];
     if ((REDIS_CMD_WRITE == iReadOrWrite)
-            || (slot_iter->second->setFllower.size() == 0)
+            || (stNode.vecFollower.size() == 0)
             || (!m_bEnableReadOnly))
     {
-        strNodeIdentify = slot_iter->second->strMaster;
+        unServer = stNode.unMaster;
         bIsMaster = true;
     }
     else
     {
-        slot_iter->second->iterFllower++;
-        if (slot_iter->second->iterFllower == slot_iter->second->setFllower.end())
+        if (++stNode.uiFollowerPos >= stNode.vecFollower.size())
         {
-            slot_iter->second->iterFllower = slot_iter->second->setFllower.begin();
+            stNode.uiFollowerPos = 0;
         }
-        strNodeIdentify = *(slot_iter->second->iterFllower);
+        unServer = stNode.vecFollower[stNode.uiFollowerPos];
         bIsMaster = false;
     }
     return(true);
@@ -633,6 +672,61 @@ bool StepRedisCluster::NeedSetReadOnly(const std::string& strNode) const
     return(false);
 }
 
+uint16 StepRedisCluster::InternServer(const std::string& strIdentify)
+{
+    auto iter = m_mapRedisServer.find(strIdentify);
+    if (iter != m_mapRedisServer.end())
+    {
+        return(iter->second);
+    }
+    uint16 unServer = (uint16)m_vecRedisServer.size();
+    RedisServer stServer;
+    stServer.strIdentify = strIdentify;
+    stServer.uiEndpoint = GetEndpoint(strIdentify);
+    m_vecRedisServer.push_back(std::move(stServer));
+    m_mapRedisServer.insert(std::make_pair(strIdentify, unServer));
+    return(unServer);
+}
+
+void StepRedisCluster::OnMoved(uint16 unSlot, const std::string& strIdentify)
+{
+    if (unSlot >= sc_unClusterSlots)
+    {
+        LOG4_ERROR("invalid slot %u in MOVED reply", unSlot);
+        return;
+    }
+    uint16 unServer = InternServer(strIdentify);
+    uint16 unNode = sc_unInvalidNode;
+    for (size_t i = 0; i < m_vecRedisNode.size(); ++i)
+    {
+        if (m_vecRedisNode[i].unMaster == unServer)
+        {
+            unNode = (uint16)i;
+            break;
+        }
+    }
+    if (sc_unInvalidNode == unNode)
+    {
+        // 新的主节点，其从节点未知，先只按主节点路由，再刷新整个槽位表
+        RedisNode stNode;
+        stNode.unMaster = unServer;
+        unNode = (uint16)m_vecRedisNode.size();
+        m_vecRedisNode.push_back(std::move(stNode));
+        RefreshClusterSlots();
+    }
+    LOG4_TRACE("slot %u moved to %s", unSlot, strIdentify.c_str());
+    m_aSlot2Node[unSlot] = unNode;
+}
+
+bool StepRedisCluster::RefreshClusterSlots()
+{
+    if (m_bSlotsRefreshing && GetNowTime() - m_lSlotsRefreshTime < (time_t)GetTimeout())
+    {
+        return(true);
+    }
+    return(SendCmdClusterSlots());
+}
+
 bool StepRedisCluster::SendCmdClusterSlots()
 {
     SetCmd("CLUSTER");
@@ -649,14 +743,19 @@ bool StepRedisCluster::SendCmdClusterSlots()
         m_uiAddressIndex = 0;
     }
     bool bResult = SendTo(m_vecAddress[m_uiAddressIndex++], pRedisRequest);
-    m_uiAddressIndex++;
+    m_bSlotsRefreshing = bResult;
+    m_lSlotsRefreshTime = GetNowTime();
     return(bResult);
 }
 
 bool StepRedisCluster::CmdClusterSlotsCallback(const RedisReply& oRedisReply)
 {
+    m_bSlotsRefreshing = false;
     if (REDIS_REPLY_ARRAY == oRedisReply.type())
     {
+        // 整表重建：未出现在响应中的槽位视为未分配
+        m_vecRedisNode.clear();
+        m_aSlot2Node.fill(sc_unInvalidNode);
         int iFromSlot = 0;
         int iToSlot = 0;
         for (int i = 0; i < oRedisReply.element_size(); ++i)
@@ -678,52 +777,69 @@ bool StepRedisCluster::CmdClusterSlotsCallback(const RedisReply& oRedisReply)
                 }
                 iFromSlot = oRedisReply.element(i).element(0).integer();
                 iToSlot = oRedisReply.element(i).element(1).integer();
-                auto pRedisNode = std::make_shared<RedisNode>();
+                if (iFromSlot < 0 || iToSlot >= sc_unClusterSlots || iFromSlot > iToSlot)
+                {
+                    LOG4_ERROR("invalid slot range [%d, %d] in element(%d)", iFromSlot, iToSlot, i);
+                    continue;
+                }
+                RedisNode stNode;
+                bool bHasMaster = false;
                 for (int j = 2; j < oRedisReply.element(i).element_size(); ++j)
                 {
-                    if (REDIS_REPLY_STRING != oRedisReply.element(i).element(j).element(0).type()
+                    if (oRedisReply.element(i).element(j).element_size() < 2
+                        || REDIS_REPLY_STRING != oRedisReply.element(i).element(j).element(0).type()
                         || REDIS_REPLY_INTEGER != oRedisReply.element(i).element(j).element(1).type())
                     {
-                        LOG4_ERROR("invalid element type %d or %d in element(%d).element(%d)",
-                                oRedisReply.element(i).element(j).element(0).type(),
-                                oRedisReply.element(i).element(j).element(1).type(), i, j);
+                        LOG4_ERROR("invalid element in element(%d).element(%d)", i, j);
                         break;
                     }
-                    std::ostringstream oss;
-                    oss << oRedisReply.element(i).element(j).element(0).str()
-                            << ":"
-                            << oRedisReply.element(i).element(j).element(1).integer();
+                    std::string strServer = oRedisReply.element(i).element(j).element(0).str()
+                            + ":" + std::to_string(oRedisReply.element(i).element(j).element(1).integer());
                     if (j == 2)
                     {
-                        pRedisNode->strMaster = oss.str();
+                        stNode.unMaster = InternServer(strServer);
+                        bHasMaster = true;
                     }
                     else
                     {
-                        pRedisNode->setFllower.insert(oss.str());
+                        stNode.vecFollower.push_back(InternServer(strServer));
                     }
                 }
-                pRedisNode->iterFllower = pRedisNode->setFllower.begin();
+                if (!bHasMaster)
+                {
+                    continue;
+                }
+                uint16 unNode = (uint16)m_vecRedisNode.size();
+                m_vecRedisNode.push_back(std::move(stNode));
                 for (int iSlotId = iFromSlot; iSlotId <= iToSlot; ++iSlotId)
                 {
-                    auto it = m_mapSlot2Node.find(iSlotId);
-                    if (it == m_mapSlot2Node.end())
-                    {
-                        m_mapSlot2Node.insert(std::make_pair(iSlotId, pRedisNode));
-                    }
-                    else
-                    {
-                        it->second = pRedisNode;
-                    }
+                    m_aSlot2Node[iSlotId] = unNode;
                 }
             }
             else
             {
-                LOG4_ERROR("redis reply type %d is invalid for CLUSTER SLOTS in element(%d)", i);
+                LOG4_ERROR("redis reply type %d is invalid for CLUSTER SLOTS in element(%d)",
+                        oRedisReply.element(i).type(), i);
             }
         }
+        RedisNearCache& oNearCache = GetLabor(this)->GetDispatcher()->GetRedisNearCache();
+        if (oNearCache.IsEnabled())
+        {
+            // 近端缓存须收到集群所有主从节点的失效通知
+            std::vector<std::string> vecServer;
+            for (auto& stNode : m_vecRedisNode)
+            {
+                vecServer.push_back(m_vecRedisServer[stNode.unMaster].strIdentify);
+                for (auto unFollower : stNode.vecFollower)
+                {
+                    vecServer.push_back(m_vecRedisServer[unFollower].strIdentify);
+                }
+            }
+            oNearCache.SetNamespaceNodes(m_strIdentify, vecServer);
+        }
         return(true);
     }
-    LOG4_ERROR("redis reply type %d is invalid for CLUSTER SLOTS");
+    LOG4_ERROR("redis reply type %d is invalid for CLUSTER SLOTS", oRedisReply.type());
     return(false);
 }
 
@@ -816,7 +932,8 @@ void StepRedisCluster::AskingQueueErrBack(
     auto step_iter = m_mapAskingRequest.find(pChannel->GetIdentify());
     if (step_iter == m_mapAskingRequest.end() || step_iter->second.size() == 0)
     {
-        LOG4_INFO("no \"%s\" found in m_mapPipelineStep", pChannel->GetIdentify().c_str());
+        LOG4_INFO("no \"%s\" found in m_mapAskingRequest", pChannel->GetIdentify().c_str());
+        return;
     }
     while (step_iter->second.size() > 0)
     {
@@ -827,61 +944,15 @@ void StepRedisCluster::AskingQueueErrBack(
         {
             SendCmdClusterSlots();
         }
-        else
+        else if (!IsExpiredSubRequest(*pRedisRequest))     // 已超时的子命令已回调过调用方
         {
-            auto num_iter = m_mapStepEmitNum.find(uiRealStepSeq);
-            if (num_iter == m_mapStepEmitNum.end()) // 单key请求的响应
+            if (m_mapGatherRequest.find(uiRealStepSeq) == m_mapGatherRequest.end()) // 未拆分的请求
             {
                 GetLabor(this)->GetActorBuilder()->OnError(pChannel, uiRealStepSeq, iErrno, strErrMsg);
             }
             else
             {
-                auto reply_iter = m_mapReply.find(uiRealStepSeq);
-                if (reply_iter == m_mapReply.end())
-                {
-                    LOG4_ERROR("no m_mapReply found for step %u", uiRealStepSeq);
-                    continue;
-                }
-                std::vector<uint32> vecElementIndex;
-                for (int i = 1; i < pRedisRequest->element_size(); ++i)  // element(0).str() is cmd
-                {
-                    if (pRedisRequest->element(i).integer() > 0 || i == 1)
-                    {
-                        vecElementIndex.push_back((uint32)pRedisRequest->element(i).integer());
-                    }
-                }
-                RedisReply oRedisReply;
-                oRedisReply.set_type(REDIS_REPLY_ERROR);
-                oRedisReply.set_str(strErrMsg);
-                for (uint32 j = 0; j < vecElementIndex.size(); ++j)
-                {
-                    if (vecElementIndex[j] < reply_iter->second.size())
-                    {
-                        if (reply_iter->second[vecElementIndex[j]] == nullptr)
-                        {
-                            reply_iter->second[vecElementIndex[j]] = new RedisReply();
-                        }
-                        reply_iter->second[vecElementIndex[j]]->CopyFrom(oRedisReply);
-                    }
-                    else
-                    {
-                        LOG4_ERROR("element index %u larger than reply size %u", vecElementIndex[j], reply_iter->second.size());
-                    }
-                }
-                num_iter->second--;
-                if (num_iter->second == 0)
-                {
-                    RedisReply oFinalReply;
-                    oFinalReply.set_type(REDIS_REPLY_ARRAY);
-                    for (size_t k = 0; k < reply_iter->second.size(); ++k)
-                    {
-                        oFinalReply.mutable_element()->AddAllocated(reply_iter->second[k]);
-                        reply_iter->second[k] = nullptr;
-                    }
-                    GetLabor(this)->GetActorBuilder()->OnMessage(pChannel, oFinalReply, uiRealStepSeq);
-                    m_mapStepEmitNum.erase(num_iter);
-                    m_mapReply.erase(reply_iter);
-                }
+                GatherError(pChannel, uiRealStepSeq, *pRedisRequest, strErrMsg);
             }
         }
     }
@@ -889,100 +960,139 @@ void StepRedisCluster::AskingQueueErrBack(
 
 bool StepRedisCluster::Dispatch(const RedisMsg& oRedisMsg, uint32 uiStepSeq)
 {
-    std::string strCmd;
-    std::vector<std::string> vecHashKey;
-    int iKeyInterval = 0;
-    int iReadOrWrite = 0;
-    if (!ExtractCmd(oRedisMsg, strCmd, vecHashKey, iReadOrWrite, iKeyInterval))
+    CheckGatherTimeout();
+    m_vecSlot.clear();
+    uint32 uiCmdFlag = 0;
+    if (!ExtractCmd(oRedisMsg, m_vecSlot, uiCmdFlag))
+    {
+        return(false);
+    }
+    if (m_vecSlot.empty())
     {
+        LOG4_ERROR("no hash key for %s", oRedisMsg.element(0).str().c_str());
         return(false);
     }
+    int iReadOrWrite = (uiCmdFlag & REDIS_CMD_FLAG_WRITE) ? REDIS_CMD_WRITE : REDIS_CMD_READ;
     bool bIsMasterNode = false;
-    std::string strRedisNode;
-    if (vecHashKey.size() == 1)
+    uint16 unRedisServer = 0;
+    bool bCrossSlot = false;
+    for (size_t i = 1; i < m_vecSlot.size(); ++i)
     {
-        uint16 unHash = crc16(vecHashKey[0].c_str(), vecHashKey[0].size());
-        int iSlotId =  (int)(unHash % sc_unClusterSlots);
-        if (!GetRedisNode(iSlotId, iReadOrWrite, strRedisNode, bIsMasterNode))
+        if (m_vecSlot[i] != m_vecSlot[0])
+        {
+            bCrossSlot = true;
+            break;
+        }
+    }
+    if (!bCrossSlot)    // 单key或所有key在同一槽位，原命令直接发送
+    {
+        if (!GetRedisNode(m_vecSlot[0], iReadOrWrite, unRedisServer, bIsMasterNode))
         {
             return(false);
         }
         auto pRedisRequest = std::make_shared<RedisMsg>(oRedisMsg);
         pRedisRequest->set_integer(uiStepSeq);    // 借用integer暂存seq
-        if (!bIsMasterNode && NeedSetReadOnly(strRedisNode))
+        pRedisRequest->mutable_element(0)->set_integer(0);  // 借用integer记录重定向次数
+        if (!bIsMasterNode && NeedSetReadOnly(m_vecRedisServer[unRedisServer].strIdentify))
         {
-            SendCmdReadOnly(strRedisNode);
+            SendCmdReadOnly(m_vecRedisServer[unRedisServer].strIdentify);
         }
-        return(SendTo(strRedisNode, pRedisRequest));
+        return(SendTo(unRedisServer, pRedisRequest));
     }
-    else if (vecHashKey.size() > 1)
+
+    if (!(uiCmdFlag & (REDIS_CMD_FLAG_MERGE_ARRAY | REDIS_CMD_FLAG_MERGE_SUM | REDIS_CMD_FLAG_MERGE_STATUS)))
     {
-        if ((int)vecHashKey.size() * iKeyInterval >= oRedisMsg.element_size())
+        LOG4_ERROR("keys of %s span multiple slots, which can not be split.", oRedisMsg.element(0).str().c_str());
+        return(false);
+    }
+    int iKeyInterval = (uiCmdFlag & REDIS_CMD_FLAG_MULTI_KEY_VALUE) ? 2 : 1;
+    if ((int)m_vecSlot.size() * iKeyInterval >= oRedisMsg.element_size())
+    {
+        LOG4_ERROR("element size error.");
+        return(false);
+    }
+    if (m_mapGatherRequest.find(uiStepSeq) != m_mapGatherRequest.end())
+    {
+        LOG4_ERROR("step %u already has a cross slot request in progress.", uiStepSeq);
+        return(false);
+    }
+
+    // 按槽位拆分子命令（redis cluster要求同一命令的key在同一槽位），再把同一节点的子命令合为一批
+    std::unordered_map<uint16, std::shared_ptr<RedisMsg>> mapSlotRequest;
+    for (uint32 i = 0; i < m_vecSlot.size(); ++i)
+    {
+        std::shared_ptr<RedisMsg>& pSubRequest = mapSlotRequest[m_vecSlot[i]];
+        if (nullptr == pSubRequest)
+        {
+            pSubRequest = std::make_shared<RedisMsg>();
+            pSubRequest->set_type(oRedisMsg.type());
+            pSubRequest->add_element()->CopyFrom(oRedisMsg.element(0));    // cmd
+            pSubRequest->mutable_element(0)->set_integer(0);
+            pSubRequest->set_integer(uiStepSeq);    // 借用integer暂存seq
+        }
+        auto pElement = pSubRequest->add_element();
+        pElement->CopyFrom(oRedisMsg.element(i * iKeyInterval + 1));  // key
+        pElement->set_integer(i);    // 借用integer暂存key的序号
+        for (int j = 2; j <= iKeyInterval; ++j)
+        {
+            pSubRequest->add_element()->CopyFrom(oRedisMsg.element(i * iKeyInterval + j));  // value
+        }
+    }
+    // 先确定所有子命令的目标节点，任一槽位无可用节点时整个命令不发送
+    std::unordered_map<uint16, std::vector<std::shared_ptr<RedisMsg>>> mapServerRequest;
+    for (auto req_iter = mapSlotRequest.begin(); req_iter != mapSlotRequest.end(); ++req_iter)
+    {
+        if (!GetRedisNode(req_iter->first, iReadOrWrite, unRedisServer, bIsMasterNode))
         {
-            LOG4_ERROR("element size error.");
             return(false);
         }
-        std::unordered_map<int, std::shared_ptr<RedisMsg>> mapRedisRequest;
-        for (uint32 i = 0; i < vecHashKey.size(); ++i)
+        auto& vecSubRequest = mapServerRequest[unRedisServer];
+        if (vecSubRequest.empty() && !bIsMasterNode && NeedSetReadOnly(m_vecRedisServer[unRedisServer].strIdentify))
         {
-            uint16 unHash = crc16(vecHashKey[i].c_str(), vecHashKey[i].size());
-            int iSlotId =  (int)(unHash % sc_unClusterSlots);
-            auto req_iter = mapRedisRequest.find(iSlotId);
-            if (req_iter == mapRedisRequest.end())
-            {
-                auto pSubRequest = std::make_shared<RedisMsg>();
-                pSubRequest->set_type(oRedisMsg.type());
-                auto pElement = pSubRequest->add_element();
-                pElement->CopyFrom(oRedisMsg.element(0));   // cmd
-                pElement = pSubRequest->add_element();
-                pElement->CopyFrom(oRedisMsg.element(i * iKeyInterval + 1)); // key
-                pElement->set_integer(i);    // 借用integer暂存key的序号
-                for (int j = 2; j <= iKeyInterval; ++j)
-                {
-                    pElement = pSubRequest->add_element();
-                    pElement->CopyFrom(oRedisMsg.element(i * iKeyInterval + j));  // value
-                }
-                pSubRequest->set_integer(uiStepSeq);    // 借用integer暂存seq
-                mapRedisRequest.insert(std::make_pair(iSlotId, pSubRequest));
-            }
-            else
-            {
-                auto pElement = req_iter->second->add_element();
-                pElement->CopyFrom(oRedisMsg.element(i * iKeyInterval + 1));  // key
-                pElement->set_integer(i);    // 借用integer暂存key的序号
-                for (int j = 2; j <= iKeyInterval; ++j)
-                {
-                    pElement = req_iter->second->add_element();
-                    pElement->CopyFrom(oRedisMsg.element(i * iKeyInterval + j));   // value
-                }
-            }
+            SendCmdReadOnly(m_vecRedisServer[unRedisServer].strIdentify);
         }
-        for (auto req_iter = mapRedisRequest.begin(); req_iter != mapRedisRequest.end(); ++req_iter)
+        vecSubRequest.push_back(req_iter->second);
+    }
+
+    RedisGather& stGather = m_mapGatherRequest[uiStepSeq];
+    stGather.uiCmdFlag = uiCmdFlag;
+    stGather.uiWaitingNum = mapSlotRequest.size();
+    stGather.lRegisterTime = GetNowTime();
+    stGather.vecSubRequest.reserve(mapSlotRequest.size());
+    for (auto req_iter = mapSlotRequest.begin(); req_iter != mapSlotRequest.end(); ++req_iter)
+    {
+        stGather.vecSubRequest.push_back(req_iter->second);
+    }
+    if (uiCmdFlag & REDIS_CMD_FLAG_MERGE_ARRAY)
+    {
+        stGather.oReply.set_type(REDIS_REPLY_ARRAY);
+        for (uint32 i = 0; i < m_vecSlot.size(); ++i)
         {
-            if (!GetRedisNode(req_iter->first, iReadOrWrite, strRedisNode, bIsMasterNode))
-            {
-                return(false);
-            }
-            if (!bIsMasterNode && NeedSetReadOnly(strRedisNode))
-            {
-                SendCmdReadOnly(strRedisNode);
-            }
-            SendTo(strRedisNode, req_iter->second);
+            stGather.oReply.add_element()->set_type(REDIS_REPLY_NIL);
         }
-        m_mapStepEmitNum[uiStepSeq] = mapRedisRequest.size();
-        std::vector<RedisReply*> vecReply;
-        auto iter_bool = m_mapReply.insert(std::make_pair(uiStepSeq, vecReply));
-        if (iter_bool.second == true)
+    }
+    std::vector<std::shared_ptr<RedisMsg>> vecFailedMsg;
+    for (auto server_iter = mapServerRequest.begin(); server_iter != mapServerRequest.end(); ++server_iter)
+    {
+        vecFailedMsg.clear();
+        if (!SendTo(server_iter->first, server_iter->second, vecFailedMsg))
         {
-            iter_bool.first->second.resize(vecHashKey.size(), nullptr);
+            // 未发出的子命令以错误合并，已发出的和其余节点的子命令照常等待响应
+            std::string strErrMsg = "failed to send to " + m_vecRedisServer[server_iter->first].strIdentify;
+            for (auto it = vecFailedMsg.begin(); it != vecFailedMsg.end(); ++it)
+            {
+                GatherError(nullptr, uiStepSeq, *(*it), strErrMsg);
+            }
         }
-        return(iter_bool.second);
     }
-    else
+    auto gather_iter = m_mapGatherRequest.find(uiStepSeq);
+    if (gather_iter != m_mapGatherRequest.end() && 0 == gather_iter->second.uiWaitingNum)
     {
-        LOG4_ERROR("no hash key for %s", strCmd.c_str());
+        m_mapGatherRequest.erase(gather_iter);
         return(false);
     }
+    RegisterStep(uiStepSeq);
+    return(true);
 }
 
 void StepRedisCluster::SendWaittingRequest()
@@ -996,17 +1106,7 @@ void StepRedisCluster::SendWaittingRequest()
 
 void StepRedisCluster::RegisterStep(uint32 uiStepSeq)
 {
-    auto iter = m_mapTimeoutStep.find(uiStepSeq);
-    if (iter == m_mapTimeoutStep.end())
-    {
-        std::vector<uint32> vecStep;
-        vecStep.push_back(uiStepSeq);
-        m_mapTimeoutStep.insert(std::make_pair(GetNowTime(), std::move(vecStep)));
-    }
-    else
-    {
-        iter->second.push_back(uiStepSeq);
-    }
+    m_mapTimeoutStep[GetNowTime()].push_back(uiStepSeq);
 }
 
 void StepRedisCluster::AddToAskingQueue(const std::string& strIdentify, std::shared_ptr<RedisMsg> pRedisMsg)
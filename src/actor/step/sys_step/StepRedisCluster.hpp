@@ -12,6 +12,7 @@
 
 #include <string>
 #include <vector>
+#include <array>
 #include <unordered_map>
 #include <unordered_set>
 #include <memory>
@@ -32,27 +33,51 @@ enum E_REDIS_CMD_TYPE
     REDIS_CMD_WRITE = 1,
 };
 
+/**
+ * @brief 命令分类（StepRedisCluster::ClassifyCmd()的返回值，按位组合）
+ */
+enum E_REDIS_CMD_FLAG
+{
+    REDIS_CMD_FLAG_SUPPORTED        = 0x01,     ///< 可按key路由的命令，不含此标志的命令不支持
+    REDIS_CMD_FLAG_WRITE            = 0x02,     ///< 写命令，只能发往主节点
+    REDIS_CMD_FLAG_MULTI_KEY        = 0x04,     ///< 多key命令（cmd key key ...）
+    REDIS_CMD_FLAG_MULTI_KEY_VALUE  = 0x08,     ///< 多key-value命令（cmd key value key value ...）
+    REDIS_CMD_FLAG_MERGE_ARRAY      = 0x10,     ///< 跨槽位时按槽位拆分，结果按key的原始顺序合并为数组（MGET）
+    REDIS_CMD_FLAG_MERGE_SUM        = 0x20,     ///< 跨槽位时按槽位拆分，结果为各子命令整数结果之和（DEL、EXISTS等）
+    REDIS_CMD_FLAG_MERGE_STATUS     = 0x40,     ///< 跨槽位时按槽位拆分，各子命令都成功时结果为OK（MSET）
+};
+
+/**
+ * @brief 集群中的一个redis实例
+ */
+struct RedisServer
+{
+    std::string strIdentify;                    ///< host:port
+    uint32 uiEndpoint = 0;                      ///< Dispatcher中的节点句柄
+};
+
+/**
+ * @brief 跨槽位多key命令的合并状态
+ */
+struct RedisGather
+{
+    uint32 uiCmdFlag = 0;
+    uint32 uiWaitingNum = 0;                    ///< 尚未响应的子命令数
+    time_t lRegisterTime = 0;                   ///< 登记超时的时间（m_mapTimeoutStep的key）
+    int64 llSum = 0;                            ///< REDIS_CMD_FLAG_MERGE_SUM的累计结果
+    std::string strErrMsg;                      ///< 首个失败子命令的错误信息
+    RedisReply oReply;                          ///< REDIS_CMD_FLAG_MERGE_ARRAY按key原始顺序的结果
+    std::vector<std::shared_ptr<RedisMsg>> vecSubRequest;  ///< 已发出的子命令（超时后标记，迟到的响应不再回调）
+};
+
+/**
+ * @brief 负责一段槽位的主从节点（值为m_vecRedisServer下标）
+ */
 struct RedisNode
 {
-    std::string strMaster;
-    std::unordered_set<std::string> setFllower;
-    std::unordered_set<std::string>::iterator iterFllower;
-    RedisNode(){}
-    RedisNode(const RedisNode& stNode) = delete;
-    RedisNode(RedisNode&& stNode)
-    {
-        strMaster = std::move(stNode.strMaster);
-        setFllower = std::move(stNode.setFllower);
-        iterFllower = setFllower.begin();
-    }
-    RedisNode& operator=(const RedisNode& stNode) = delete;
-    RedisNode& operator=(RedisNode&& stNode)
-    {
-        strMaster = std::move(stNode.strMaster);
-        setFllower = std::move(stNode.setFllower);
-        iterFllower = setFllower.begin();
-        return(*this);
-    }
+    uint16 unMaster = 0;
+    uint32 uiFollowerPos = 0;                   ///< 从节点轮询位置
+    std::vector<uint16> vecFollower;
 };
 
 class StepRedisCluster: public RedisStep,
@@ -78,13 +103,76 @@ public:
 
     virtual bool SendTo(const std::string& strIdentify, const RedisMsg& oRedisMsg,
             bool bWithSsl, bool bPipeline, uint32 uiStepSeq) override;
+    /**
+     * @brief 集群需保存请求以便重定向时重发，RespCmd先转换为RedisMsg
+     */
+    virtual bool SendTo(const std::string& strIdentify, const RespCmd& oRespCmd,
+            bool bWithSsl, bool bPipeline, uint32 uiStepSeq) override;
 
 protected:
     bool SendTo(const std::string& strIdentify, std::shared_ptr<RedisMsg> pRedisMsg);
-    bool ExtractCmd(const RedisMsg& oRedisMsg, std::string& strCmd,
-            std::vector<std::string>& vecHashKeys, int& iReadOrWrite, int& iKeyInterval);
-    bool GetRedisNode(int iSlotId, int iReadOrWrite, std::string& strNodeIdentify, bool& bIsMaster) const;
+    /**
+     * @brief 向实例发送一条命令并登记等待响应
+     * @note 所有发往集群节点的命令都经由本函数和下面的批量发送，派生类可覆盖以截获发出的命令
+     */
+    virtual bool SendTo(uint16 unServer, std::shared_ptr<RedisMsg> pRedisMsg);
+    /**
+     * @brief 以pipeline一次发送同一节点上的多条子命令
+     * @param[out] vecFailedMsg 未能发出的子命令（pipeline时全部成功或全部失败，非pipeline时逐条发送）
+     * @return 是否全部发出
+     */
+    virtual bool SendTo(uint16 unServer, const std::vector<std::shared_ptr<RedisMsg>>& vecRedisMsg,
+            std::vector<std::shared_ptr<RedisMsg>>& vecFailedMsg);
+    /**
+     * @brief 解析命令，得到各key所在的槽位
+     * @param[out] vecSlot 各key（或hash tag）所在槽位，按key在命令中的顺序
+     * @param[out] uiCmdFlag 命令分类（E_REDIS_CMD_FLAG）
+     */
+    bool ExtractCmd(const RedisMsg& oRedisMsg, std::vector<uint16>& vecSlot, uint32& uiCmdFlag);
+    /**
+     * @brief 按MOVED或ASK重定向请求
+     * @return 已重定向返回true，非重定向错误或重定向次数超过限制返回false
+     */
+    bool Redirect(const RedisReply& oRedisReply, std::shared_ptr<RedisMsg> pRedisRequest);
+    /**
+     * @brief 合并跨槽位多key命令的一个子命令结果，全部子命令都有结果后回调
+     * @param pChannel 回调所用连接，为nullptr时（子命令未能发出）只合并不回调
+     * @return 是否已全部合并完成
+     */
+    bool Gather(std::shared_ptr<SocketChannel> pChannel, uint32 uiStepSeq,
+            const RedisMsg& oSubRequest, const RedisReply& oSubReply);
+    /**
+     * @brief 子命令失败，对应key以错误结果合并
+     */
+    bool GatherError(std::shared_ptr<SocketChannel> pChannel, uint32 uiStepSeq,
+            const RedisMsg& oSubRequest, const std::string& strErrMsg);
+    /**
+     * @brief 合并超时的跨槽位命令以超时错误回调调用方，其子命令之后的响应丢弃
+     */
+    void CheckGatherTimeout();
+    /**
+     * @brief 是否为已超时的跨槽位命令的子命令
+     */
+    static bool IsExpiredSubRequest(const RedisMsg& oRedisRequest)
+    {
+        return(oRedisRequest.element_size() > 0 && oRedisRequest.element(0).integer() == sc_iExpiredSubRequest);
+    }
+    bool GetRedisNode(uint16 unSlot, int iReadOrWrite, uint16& unServer, bool& bIsMaster);
     bool NeedSetReadOnly(const std::string& strNode) const;
+    /**
+     * @brief 登记redis实例
+     * @return 实例编号（m_vecRedisServer下标），已登记的实例返回原编号
+     */
+    uint16 InternServer(const std::string& strIdentify);
+    /**
+     * @brief 按MOVED重定向更新槽位所属节点
+     * @note 只修改unSlot一个槽位；重定向到的主节点未知时（新增节点或主从切换）再刷新整个槽位表。
+     */
+    void OnMoved(uint16 unSlot, const std::string& strIdentify);
+    /**
+     * @brief 刷新槽位表，已有CLUSTER SLOTS请求未完成（且未超时）时不重复发送
+     */
+    bool RefreshClusterSlots();
     bool SendCmdClusterSlots();
     bool CmdClusterSlotsCallback(const RedisReply& oRedisReply);
     bool SendCmdAsking(const std::string& strIdentify);
@@ -103,23 +191,42 @@ private:
     bool m_bPipeline;                       ///< 是否支持pipeline
     bool m_bEnableReadOnly;                 ///< 是否对从节点启用只读
     uint32 m_uiAddressIndex;
+    bool m_bSlotsRefreshing;                ///< CLUSTER SLOTS请求已发出尚未响应
+    time_t m_lSlotsRefreshTime;             ///< 最近一次发出CLUSTER SLOTS请求的时间
 
     std::string m_strIdentify;      ///< 地址标识，由m_vecAddress合并而成，形如 192.168.47.101:6379,198.168.47.102:6379,192.168.47.103:6379
     std::vector<std::string> m_vecAddress;  ///< 集群地址
-    std::unordered_map<int, std::shared_ptr<RedisNode>> m_mapSlot2Node;    // redis cluster slot对应的节点
+    std::vector<RedisServer> m_vecRedisServer;                  ///< 集群中出现过的redis实例，下标为实例编号
+    std::unordered_map<std::string, uint16> m_mapRedisServer;   ///< key为实例标识，value为实例编号
+    std::vector<RedisNode> m_vecRedisNode;                      ///< 各段槽位的主从节点
+    std::vector<uint16> m_vecSlot;                              ///< Dispatch()解析槽位的临时缓冲区
+    RedisMsg m_oRespCmdRequest;                                 ///< RespCmd转换为RedisMsg的临时缓冲区
     std::unordered_map<std::string, std::queue<std::shared_ptr<RedisRequest>>> m_mapPipelineRequest;  ///< 等待回调的请求
     std::unordered_map<std::string, std::queue<std::shared_ptr<RedisRequest>>> m_mapAskingRequest;  ///< 等待Asking的请求
-    std::unordered_map<uint32, uint32> m_mapStepEmitNum;    // 每个step发出请求（等待响应）数量
-    std::unordered_map<uint32, std::vector<RedisReply*>> m_mapReply;
-    std::map<time_t, std::vector<uint32>> m_mapTimeoutStep;
+    std::unordered_map<uint32, RedisGather> m_mapGatherRequest;    ///< 跨槽位多key命令的合并状态，key为step seq
+    std::map<time_t, std::vector<uint32>> m_mapTimeoutStep;   ///< 跨槽位命令按登记时间排列，key为登记时间，value为step seq
     std::vector<std::pair<uint32, RedisRequest>> m_vecWaittingRequest;
 
-    static const uint16 sc_unClusterSlots;  ///< redis cluster槽位数
-    static const std::unordered_set<std::string> s_setSupportExtractCmd;
-    static const std::unordered_set<std::string> s_setReadCmd;
-    static const std::unordered_set<std::string> s_setWriteCmd;
-    static const std::unordered_set<std::string> s_setMultipleKeyCmd;
-    static const std::unordered_set<std::string> s_setMultipleKeyValueCmd;
+public:
+    /**
+     * @brief 命令分类
+     * @note 按命令名（不区分大小写）查静态开放寻址表，一次hash和一次比较。
+     * @return E_REDIS_CMD_FLAG按位组合，0表示不支持的命令
+     */
+    static uint32 ClassifyCmd(const std::string& strCmd);
+
+    /**
+     * @brief key所在槽位（有hash tag时按第一个“{”与其后第一个“}”之间的非空内容计算）
+     */
+    static uint16 GetSlot(const std::string& strKey);
+
+    static const uint16 sc_unClusterSlots = 16384;  ///< redis cluster槽位数
+    static const uint16 sc_unInvalidNode = 0xFFFF;  ///< 槽位未分配节点
+    static const int32 sc_iMaxRedirect = 5;         ///< 单个请求最多跟随MOVED、ASK重定向的次数
+    static const int32 sc_iExpiredSubRequest = -1;  ///< 子命令命令名元素的integer（平时为重定向次数）为此值表示所属命令已超时
+
+private:
+    std::array<uint16, sc_unClusterSlots> m_aSlot2Node;    ///< redis cluster slot对应的节点（m_vecRedisNode下标）
 };
 
 } /* namespace neb */
@@ -0,0 +1,53 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     StepRedisNearCacheFill.cpp
+ * @brief    redis近端缓存未命中时的回填步骤
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note
+ * Modify history:
+ ******************************************************************************/
+#include "actor/step/sys_step/StepRedisNearCacheFill.hpp"
+#include "ios/Dispatcher.hpp"
+
+namespace neb
+{
+
+StepRedisNearCacheFill::StepRedisNearCacheFill(uint32 uiCallerStepSeq, uint32 uiFillId, ev_tstamp dTimeout)
+    : RedisStep(nullptr, dTimeout),
+      m_uiCallerStepSeq(uiCallerStepSeq), m_uiFillId(uiFillId)
+{
+}
+
+StepRedisNearCacheFill::~StepRedisNearCacheFill()
+{
+}
+
+E_CMD_STATUS StepRedisNearCacheFill::Emit(int iErrno, const std::string& strErrMsg, void* data)
+{
+    return(CMD_STATUS_RUNNING);
+}
+
+E_CMD_STATUS StepRedisNearCacheFill::Callback(std::shared_ptr<SocketChannel> pChannel, const RedisReply& oRedisReply)
+{
+    GetLabor(this)->GetDispatcher()->GetRedisNearCache().Fill(m_uiFillId, oRedisReply);
+    GetLabor(this)->GetActorBuilder()->OnMessage(pChannel, oRedisReply, m_uiCallerStepSeq);
+    return(CMD_STATUS_COMPLETED);
+}
+
+E_CMD_STATUS StepRedisNearCacheFill::ErrBack(std::shared_ptr<SocketChannel> pChannel,
+        int iErrno, const std::string& strErrMsg)
+{
+    GetLabor(this)->GetDispatcher()->GetRedisNearCache().Cancel(m_uiFillId);
+    GetLabor(this)->GetActorBuilder()->OnError(pChannel, m_uiCallerStepSeq, iErrno, strErrMsg);
+    return(CMD_STATUS_FAULT);
+}
+
+E_CMD_STATUS StepRedisNearCacheFill::Timeout()
+{
+    // 调用方步骤超时时间相同，由其自身的Timeout()处理
+    GetLabor(this)->GetDispatcher()->GetRedisNearCache().Cancel(m_uiFillId);
+    return(CMD_STATUS_FAULT);
+}
+
+} /* namespace neb */
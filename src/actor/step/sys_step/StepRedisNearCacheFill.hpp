@@ -0,0 +1,59 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     StepRedisNearCacheFill.hpp
+ * @brief    redis近端缓存未命中时的回填步骤
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note
+ * Modify history:
+ ******************************************************************************/
+#ifndef SRC_ACTOR_STEP_SYS_STEP_STEPREDISNEARCACHEFILL_HPP_
+#define SRC_ACTOR_STEP_SYS_STEP_STEPREDISNEARCACHEFILL_HPP_
+
+#include "actor/ActorSys.hpp"
+#include "actor/step/RedisStep.hpp"
+#include "Definition.hpp"
+
+namespace neb
+{
+
+/**
+ * @brief redis近端缓存回填步骤
+ * @note 由Actor::SendWithNearCache()在缓存未命中时创建，代替调用方步骤发出请求，
+ * 收到响应后先回填缓存，再以该响应回调调用方步骤；请求出错时转为调用方步骤的ErrBack()。
+ */
+class StepRedisNearCacheFill: public RedisStep,
+    public DynamicCreator<StepRedisNearCacheFill, uint32, uint32, ev_tstamp>,
+    public ActorSys
+{
+public:
+    /**
+     * @param uiCallerStepSeq 调用方步骤的序号
+     * @param uiFillId RedisNearCache::Lookup()返回的回填序号
+     * @param dTimeout 超时时间，与调用方步骤相同
+     */
+    StepRedisNearCacheFill(uint32 uiCallerStepSeq, uint32 uiFillId, ev_tstamp dTimeout);
+    virtual ~StepRedisNearCacheFill();
+
+    virtual E_CMD_STATUS Emit(
+            int iErrno = 0,
+            const std::string& strErrMsg = "",
+            void* data = NULL);
+
+    virtual E_CMD_STATUS Callback(
+            std::shared_ptr<SocketChannel> pChannel,
+            const RedisReply& oRedisReply);
+
+    virtual E_CMD_STATUS ErrBack(std::shared_ptr<SocketChannel> pChannel,
+            int iErrno, const std::string& strErrMsg);
+
+    virtual E_CMD_STATUS Timeout();
+
+private:
+    uint32 m_uiCallerStepSeq;
+    uint32 m_uiFillId;
+};
+
+} /* namespace neb */
+
+#endif /* SRC_ACTOR_STEP_SYS_STEP_STEPREDISNEARCACHEFILL_HPP_ */
@@ -0,0 +1,474 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     SendQueue.cpp
+ * @brief    链式发送队列
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note
+ * Modify history:
+ ******************************************************************************/
+#include "SendQueue.hpp"
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#ifdef __linux__
+#include <linux/errqueue.h>
+#endif
+
+#if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY) && defined(SO_EE_ORIGIN_ZEROCOPY)
+#define NEB_MSG_ZEROCOPY
+#endif
+
+namespace neb
+{
+
+/** @brief 一次writev最多提交的段数 */
+static const int s_iMaxIov = 64;
+/** @brief 回收池中缓冲区的初始大小 */
+static const size_t s_uiSegmentSize = CBuffer::BUFFER_MAX_READ;
+/** @brief 尾部缓冲区剩余空间低于此值时，下一次写入前封存 */
+static const size_t s_uiTailLowWater = CBuffer::BUFFER_MAX_READ / 8;
+/** @brief 超过此容量的缓冲区不回收 */
+static const size_t s_uiMaxPooledCapacity = CBuffer::BUFFER_MAX_READ * 8;
+/** @brief 每个线程回收池最多保留的缓冲区数 */
+static const size_t s_uiMaxPooledBuffer = 64;
+/** @brief 每个线程回收池最多保留的发送队列数（每个连接两个队列） */
+static const size_t s_uiMaxPooledQueue = 8192;
+/** @brief 连接关闭后等待MSG_ZEROCOPY完成通知的最长时间（秒） */
+static const double s_dParkedZeroCopyTimeout = 60.0;
+
+// 发送缓冲区回收池，每个Worker（线程模式下每个线程）一份；池本身不随线程退出析构，
+// 避免晚于线程局部对象析构的通道归还缓冲区时访问已析构的池
+static thread_local std::vector<CBuffer*>* s_pBufferPool = nullptr;
+static thread_local std::vector<SendQueue*>* s_pQueuePool = nullptr;
+thread_local std::list<SendQueue::tagParkedZeroCopy>* SendQueue::s_pParkedZeroCopy = nullptr;
+// 为true时ReleaseBuffer()直接释放缓冲区，不放回回收池（丢弃超时的零拷贝数据时）
+static thread_local bool s_bDiscardBuffer = false;
+
+static double MonotonicTime()
+{
+    struct timespec stTime;
+    clock_gettime(CLOCK_MONOTONIC, &stTime);
+    return((double)stTime.tv_sec + (double)stTime.tv_nsec / 1000000000.0);
+}
+
+SendQueue::SendQueue()
+    : m_pTail(AcquireBuffer()), m_uiQueuedBytes(0),
+      m_uiZeroCopyId(0), m_cZeroCopyState(0)
+{
+}
+
+SendQueue::~SendQueue()
+{
+    ParkZeroCopy(-1);
+    m_dequeSegment.clear();
+    ReleaseBuffer(m_pTail);
+    m_pTail = nullptr;
+}
+
+CBuffer* SendQueue::GetTail(size_t uiReserve)
+{
+    if (m_pTail->ReadableBytes() > 0
+            && m_pTail->WriteableBytes() < ((uiReserve > s_uiTailLowWater) ? uiReserve : s_uiTailLowWater))
+    {
+        Seal();
+    }
+    return(m_pTail);
+}
+
+void SendQueue::Append(std::shared_ptr<const CBuffer> pData, size_t uiOffset, size_t uiLength)
+{
+    if (nullptr == pData || 0 == uiLength)
+    {
+        return;
+    }
+    Seal();
+    tagSegment stSegment;
+    stSegment.pData = pData;
+    stSegment.uiOffset = uiOffset;
+    stSegment.uiLength = uiLength;
+    m_dequeSegment.push_back(stSegment);
+    m_uiQueuedBytes += uiLength;
+}
+
+void SendQueue::Seal()
+{
+    size_t uiLength = m_pTail->ReadableBytes();
+    if (0 == uiLength)
+    {
+        return;
+    }
+    tagSegment stSegment;
+    stSegment.pData = std::shared_ptr<const CBuffer>(m_pTail, &SendQueue::ReleaseBuffer);
+    stSegment.uiOffset = 0;
+    stSegment.uiLength = uiLength;
+    m_dequeSegment.push_back(stSegment);
+    m_uiQueuedBytes += uiLength;
+    m_pTail = AcquireBuffer();
+}
+
+int SendQueue::WriteFD(int iFd, int& iErrno, uint32 uiZeroCopyThreshold)
+{
+    if (uiZeroCopyThreshold > 0 && m_cZeroCopyState >= 0)
+    {
+        if (m_pTail->ReadableBytes() >= uiZeroCopyThreshold)
+        {
+            Seal();     // 尾部缓冲区发送完成前不能被复用，大段数据封存后才可零拷贝发送
+        }
+        if (!m_dequeSegment.empty() && m_dequeSegment.front().uiLength >= uiZeroCopyThreshold)
+        {
+            int iWriteLen = WriteZeroCopy(iFd, iErrno, uiZeroCopyThreshold);
+            if (iWriteLen >= 0 || ENOBUFS != iErrno)
+            {
+                return(iWriteLen);
+            }
+            // ENOBUFS（超出optmem限制）时退回普通发送
+        }
+    }
+
+    struct iovec aIov[s_iMaxIov];
+    int iIovCnt = 0;
+    for (auto it = m_dequeSegment.begin(); it != m_dequeSegment.end() && iIovCnt < s_iMaxIov; ++it)
+    {
+        aIov[iIovCnt].iov_base = (void*)(it->pData->GetRawReadBuffer() + it->uiOffset);
+        aIov[iIovCnt].iov_len = it->uiLength;
+        ++iIovCnt;
+    }
+    if (iIovCnt < s_iMaxIov && m_pTail->ReadableBytes() > 0)
+    {
+        aIov[iIovCnt].iov_base = (void*)m_pTail->GetRawReadBuffer();
+        aIov[iIovCnt].iov_len = m_pTail->ReadableBytes();
+        ++iIovCnt;
+    }
+    if (0 == iIovCnt)
+    {
+        return(0);
+    }
+
+    ssize_t iWriteLen = -1;
+    if (1 == iIovCnt)
+    {
+        iWriteLen = ::send(iFd, aIov[0].iov_base, aIov[0].iov_len, MSG_NOSIGNAL);
+    }
+    else
+    {
+        struct msghdr stMsg;
+        memset(&stMsg, 0, sizeof(stMsg));
+        stMsg.msg_iov = aIov;
+        stMsg.msg_iovlen = iIovCnt;
+        iWriteLen = ::sendmsg(iFd, &stMsg, MSG_NOSIGNAL);
+    }
+    if (iWriteLen < 0)
+    {
+        iErrno = errno;
+        return(-1);
+    }
+    Skip(iWriteLen);    // 未发完的数据留在尾部缓冲区，后续编码继续追加，空间不足时由GetTail()封存
+    return((int)iWriteLen);
+}
+
+int SendQueue::WriteZeroCopy(int iFd, int& iErrno, uint32 uiZeroCopyThreshold)
+{
+#ifdef NEB_MSG_ZEROCOPY
+    if (0 == m_cZeroCopyState)
+    {
+        int iFlag = 1;
+        if (0 != setsockopt(iFd, SOL_SOCKET, SO_ZEROCOPY, &iFlag, sizeof(iFlag)))
+        {
+            m_cZeroCopyState = -1;
+            iErrno = ENOBUFS;
+            return(-1);
+        }
+        m_cZeroCopyState = 1;
+    }
+
+    struct iovec aIov[s_iMaxIov];
+    int iIovCnt = 0;
+    for (auto it = m_dequeSegment.begin();
+            it != m_dequeSegment.end() && iIovCnt < s_iMaxIov && it->uiLength >= uiZeroCopyThreshold; ++it)
+    {
+        aIov[iIovCnt].iov_base = (void*)(it->pData->GetRawReadBuffer() + it->uiOffset);
+        aIov[iIovCnt].iov_len = it->uiLength;
+        ++iIovCnt;
+    }
+    struct msghdr stMsg;
+    memset(&stMsg, 0, sizeof(stMsg));
+    stMsg.msg_iov = aIov;
+    stMsg.msg_iovlen = iIovCnt;
+    ssize_t iWriteLen = ::sendmsg(iFd, &stMsg, MSG_NOSIGNAL | MSG_ZEROCOPY);
+    if (iWriteLen < 0)
+    {
+        iErrno = errno;
+        return(-1);
+    }
+    if (iWriteLen > 0)
+    {
+        // 内核完成通知之前数据不能释放或复用，持有本次发送涉及的所有段
+        tagZeroCopy stZeroCopy;
+        stZeroCopy.uiZeroCopyId = m_uiZeroCopyId++;
+        size_t uiCovered = 0;
+        for (auto it = m_dequeSegment.begin(); it != m_dequeSegment.end() && uiCovered < (size_t)iWriteLen; ++it)
+        {
+            stZeroCopy.dequeData.push_back(it->pData);
+            uiCovered += it->uiLength;
+        }
+        m_dequeZeroCopyPending.push_back(std::move(stZeroCopy));
+        Skip(iWriteLen);
+    }
+    return((int)iWriteLen);
+#else
+    m_cZeroCopyState = -1;
+    iErrno = ENOBUFS;
+    return(-1);
+#endif
+}
+
+void SendQueue::ReapZeroCopy(int iFd)
+{
+    ReapZeroCopy(iFd, m_dequeZeroCopyPending);
+}
+
+void SendQueue::ReapZeroCopy(int iFd, std::deque<tagZeroCopy>& dequePending)
+{
+#ifdef NEB_MSG_ZEROCOPY
+    char szControl[128];
+    while (!dequePending.empty())
+    {
+        struct msghdr stMsg;
+        memset(&stMsg, 0, sizeof(stMsg));
+        stMsg.msg_control = szControl;
+        stMsg.msg_controllen = sizeof(szControl);
+        if (::recvmsg(iFd, &stMsg, MSG_ERRQUEUE) < 0)
+        {
+            return;     // EAGAIN：暂无完成通知
+        }
+        for (struct cmsghdr* pCmsg = CMSG_FIRSTHDR(&stMsg); pCmsg != nullptr; pCmsg = CMSG_NXTHDR(&stMsg, pCmsg))
+        {
+            if (!((SOL_IP == pCmsg->cmsg_level && IP_RECVERR == pCmsg->cmsg_type)
+                    || (SOL_IPV6 == pCmsg->cmsg_level && IPV6_RECVERR == pCmsg->cmsg_type)))
+            {
+                continue;
+            }
+            struct sock_extended_err* pErr = (struct sock_extended_err*)CMSG_DATA(pCmsg);
+            if (0 != pErr->ee_errno || SO_EE_ORIGIN_ZEROCOPY != pErr->ee_origin)
+            {
+                continue;
+            }
+            // 通知的是[ee_info, ee_data]区间的发送序号，TCP连接上按序完成
+            uint32 uiLastId = pErr->ee_data;
+            while (!dequePending.empty()
+                    && (int32)(dequePending.front().uiZeroCopyId - uiLastId) <= 0)
+            {
+                dequePending.pop_front();
+            }
+        }
+    }
+#endif
+}
+
+void SendQueue::ParkZeroCopy(int iFd)
+{
+    if (m_dequeZeroCopyPending.empty())
+    {
+        return;
+    }
+    if (iFd >= 0)
+    {
+        ReapZeroCopy(iFd);
+        if (m_dequeZeroCopyPending.empty())
+        {
+            return;
+        }
+    }
+    if (nullptr == s_pParkedZeroCopy)
+    {
+        s_pParkedZeroCopy = new std::list<tagParkedZeroCopy>();
+    }
+    tagParkedZeroCopy stParked;
+    if (iFd >= 0)
+    {
+        // 副本使socket在调用者关闭iFd后仍可读取完成通知；先shutdown以保持原close()发送FIN的行为
+        stParked.iFd = dup(iFd);
+        if (stParked.iFd >= 0)
+        {
+            shutdown(iFd, SHUT_RDWR);
+        }
+    }
+    stParked.dDeadline = MonotonicTime() + s_dParkedZeroCopyTimeout;
+    stParked.dequePending.swap(m_dequeZeroCopyPending);
+    s_pParkedZeroCopy->push_back(std::move(stParked));
+}
+
+void SendQueue::CheckParkedZeroCopy()
+{
+    if (nullptr == s_pParkedZeroCopy)
+    {
+        return;
+    }
+    double dNow = MonotonicTime();
+    for (auto it = s_pParkedZeroCopy->begin(); it != s_pParkedZeroCopy->end(); )
+    {
+        if (it->iFd >= 0)
+        {
+            ReapZeroCopy(it->iFd, it->dequePending);
+        }
+        if (!it->dequePending.empty() && dNow < it->dDeadline)
+        {
+            ++it;
+            continue;
+        }
+        if (it->iFd >= 0)
+        {
+            close(it->iFd);
+        }
+        // 超时仍未完成的数据内核可能还会读取，释放内存但不放回回收池复用
+        s_bDiscardBuffer = !it->dequePending.empty();
+        it = s_pParkedZeroCopy->erase(it);
+        s_bDiscardBuffer = false;
+    }
+}
+
+bool SendQueue::Front(const char*& pData, size_t& uiLength) const
+{
+    if (!m_dequeSegment.empty())
+    {
+        const tagSegment& stSegment = m_dequeSegment.front();
+        pData = stSegment.pData->GetRawReadBuffer() + stSegment.uiOffset;
+        uiLength = stSegment.uiLength;
+        return(true);
+    }
+    if (m_pTail->ReadableBytes() > 0)
+    {
+        pData = m_pTail->GetRawReadBuffer();
+        uiLength = m_pTail->ReadableBytes();
+        return(true);
+    }
+    return(false);
+}
+
+void SendQueue::Skip(size_t uiLength)
+{
+    while (uiLength > 0 && !m_dequeSegment.empty())
+    {
+        tagSegment& stSegment = m_dequeSegment.front();
+        if (uiLength < stSegment.uiLength)
+        {
+            stSegment.uiOffset += uiLength;
+            stSegment.uiLength -= uiLength;
+            m_uiQueuedBytes -= uiLength;
+            return;
+        }
+        uiLength -= stSegment.uiLength;
+        m_uiQueuedBytes -= stSegment.uiLength;
+        m_dequeSegment.pop_front();
+    }
+    if (uiLength > 0)
+    {
+        m_pTail->SkipBytes(uiLength);
+    }
+    if (0 == m_pTail->ReadableBytes())
+    {
+        m_pTail->Clear();
+    }
+}
+
+void SendQueue::Shrink()
+{
+    if (m_pTail->Capacity() > CBuffer::BUFFER_MAX_READ
+        && (m_pTail->ReadableBytes() < m_pTail->Capacity() / 2))
+    {
+        m_pTail->Compact(m_pTail->ReadableBytes() * 2);
+    }
+}
+
+void SendQueue::Reset()
+{
+    ParkZeroCopy(-1);
+    m_dequeSegment.clear();
+    m_uiQueuedBytes = 0;
+    m_uiZeroCopyId = 0;
+    m_cZeroCopyState = 0;
+    if (m_pTail->Capacity() < s_uiSegmentSize || m_pTail->Capacity() > s_uiMaxPooledCapacity)
+    {
+        ReleaseBuffer(m_pTail);
+        m_pTail = AcquireBuffer();
+    }
+    else
+    {
+        m_pTail->Clear();
+    }
+}
+
+SendQueue* SendQueue::Acquire()
+{
+    if (nullptr != s_pQueuePool && !s_pQueuePool->empty())
+    {
+        SendQueue* pQueue = s_pQueuePool->back();
+        s_pQueuePool->pop_back();
+        return(pQueue);
+    }
+    return(new SendQueue());
+}
+
+void SendQueue::Release(SendQueue* pQueue)
+{
+    if (nullptr == pQueue)
+    {
+        return;
+    }
+    if (nullptr == s_pQueuePool)
+    {
+        s_pQueuePool = new std::vector<SendQueue*>();
+        s_pQueuePool->reserve(64);
+    }
+    if (s_pQueuePool->size() < s_uiMaxPooledQueue)
+    {
+        pQueue->Reset();
+        s_pQueuePool->push_back(pQueue);
+    }
+    else
+    {
+        delete pQueue;
+    }
+}
+
+CBuffer* SendQueue::AcquireBuffer()
+{
+    if (nullptr != s_pBufferPool && !s_pBufferPool->empty())
+    {
+        CBuffer* pBuff = s_pBufferPool->back();
+        s_pBufferPool->pop_back();
+        return(pBuff);
+    }
+    return(new CBuffer(s_uiSegmentSize));
+}
+
+void SendQueue::ReleaseBuffer(CBuffer* pBuff)
+{
+    if (nullptr == pBuff)
+    {
+        return;
+    }
+    if (nullptr == s_pBufferPool)
+    {
+        s_pBufferPool = new std::vector<CBuffer*>();
+        s_pBufferPool->reserve(s_uiMaxPooledBuffer);
+    }
+    if (!s_bDiscardBuffer && s_pBufferPool->size() < s_uiMaxPooledBuffer
+            && pBuff->Capacity() >= s_uiSegmentSize
+            && pBuff->Capacity() <= s_uiMaxPooledCapacity)
+    {
+        pBuff->Clear();
+        s_pBufferPool->push_back(pBuff);
+    }
+    else
+    {
+        delete pBuff;
+    }
+}
+
+} /* namespace neb */
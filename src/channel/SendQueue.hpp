@@ -0,0 +1,188 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     SendQueue.hpp
+ * @brief    链式发送队列
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note     编码器始终写入队列尾部缓冲区，未发完的数据留在尾部缓冲区继续追加；尾部
+ * 缓冲区剩余空间不足（再写入就要扩容）或需引用外部数据时才封存为队列中的一段，之后
+ * 的编码写入新的尾部缓冲区，已排队数据不再随缓冲区扩容而搬移。发送时以writev一次
+ * 提交多段；大段数据可选以MSG_ZEROCOPY发送。
+ * Modify history:
+ ******************************************************************************/
+#ifndef SRC_CHANNEL_SENDQUEUE_HPP_
+#define SRC_CHANNEL_SENDQUEUE_HPP_
+
+#include <deque>
+#include <list>
+#include <memory>
+#include "util/CBuffer.hpp"
+#include "Definition.hpp"
+
+namespace neb
+{
+
+/**
+ * @brief 链式发送队列
+ * @note 非线程安全，与所属通道在同一线程中使用。
+ */
+class SendQueue
+{
+public:
+    SendQueue();
+    SendQueue(const SendQueue&) = delete;
+    SendQueue& operator=(const SendQueue&) = delete;
+    virtual ~SendQueue();
+
+    /**
+     * @brief 从回收池获取发送队列
+     * @note 与Release()配对使用，连接频繁建立和关闭时不再逐次构造和析构队列。
+     */
+    static SendQueue* Acquire();
+
+    /**
+     * @brief 清空发送队列并放回回收池
+     */
+    static void Release(SendQueue* pQueue);
+
+    /**
+     * @brief 从回收池获取缓冲区（初始容量CBuffer::BUFFER_MAX_READ）
+     */
+    static CBuffer* AcquireBuffer();
+
+    /**
+     * @brief 缓冲区放回回收池（容量不在回收范围内的直接释放）
+     */
+    static void ReleaseBuffer(CBuffer* pBuff);
+
+    /**
+     * @brief 获取尾部缓冲区（编码器写入位置）
+     * @note 尾部缓冲区已有数据且剩余空间小于uiReserve（至少为一个较小的低水位）时先封存，
+     * 换上新的尾部缓冲区，避免已排队数据随扩容搬移；空间足够时继续追加，不额外占用缓冲区。
+     * @param uiReserve 预计写入的字节数，未知时为0
+     */
+    CBuffer* GetTail(size_t uiReserve = 0);
+
+    /**
+     * @brief 待发送字节数
+     */
+    size_t ReadableBytes() const
+    {
+        return(m_uiQueuedBytes + m_pTail->ReadableBytes());
+    }
+
+    /**
+     * @brief 引用一段只读数据排队发送（不拷贝）
+     * @note 数据发送完毕（MSG_ZEROCOPY时为内核通知完成）后释放引用，期间pData不可修改。
+     * @param pData 数据缓冲区
+     * @param uiOffset 数据在缓冲区可读部分中的起始偏移
+     * @param uiLength 数据长度
+     */
+    void Append(std::shared_ptr<const CBuffer> pData, size_t uiOffset, size_t uiLength);
+
+    /**
+     * @brief 将尾部缓冲区中的待发送数据封存为队列中的一段，并换上新的尾部缓冲区
+     */
+    void Seal();
+
+    /**
+     * @brief 以writev（或sendmsg(MSG_ZEROCOPY)）发送队列中的数据
+     * @param iFd 文件描述符
+     * @param[out] iErrno 发送失败时的错误码
+     * @param uiZeroCopyThreshold 不小于此长度的封存段以MSG_ZEROCOPY发送，0表示不使用
+     * @return 发送字节数，失败返回-1
+     */
+    int WriteFD(int iFd, int& iErrno, uint32 uiZeroCopyThreshold = 0);
+
+    /**
+     * @brief 获取队首连续数据（用于SSL_write等不支持分散写的发送）
+     * @return 是否有数据
+     */
+    bool Front(const char*& pData, size_t& uiLength) const;
+
+    /**
+     * @brief 丢弃队首已发送的数据
+     */
+    void Skip(size_t uiLength);
+
+    /**
+     * @brief 是否有MSG_ZEROCOPY发送尚未收到内核完成通知
+     */
+    bool HasZeroCopyPending() const
+    {
+        return(!m_dequeZeroCopyPending.empty());
+    }
+
+    /**
+     * @brief 读取socket错误队列中的MSG_ZEROCOPY完成通知，释放已完成的数据引用
+     * @note 完成通知会使fd持续可读（EPOLLERR），有未完成的零拷贝发送时每次读写前都应调用。
+     */
+    void ReapZeroCopy(int iFd);
+
+    /**
+     * @brief 将尚未收到完成通知的MSG_ZEROCOPY数据移交线程的暂存列表（连接关闭前）
+     * @note 内核在完成通知之前仍可能读取（包括重传）这些数据，其缓冲区不能释放或放回回收池。
+     * 暂存列表持有fd的副本以继续读取完成通知，由CheckParkedZeroCopy()在完成后释放；
+     * iFd为-1（已无法读取完成通知）或超时的数据直接释放内存，不放回回收池。
+     * 调用后本队列可照常Reset()和回收。
+     * @param iFd 连接的文件描述符，调用者随后关闭它
+     */
+    void ParkZeroCopy(int iFd);
+
+    /**
+     * @brief 读取暂存列表中各连接的完成通知，释放已完成或超时的数据
+     * @note 由Dispatcher的周期任务调用。
+     */
+    static void CheckParkedZeroCopy();
+
+    /**
+     * @brief 收缩尾部缓冲区
+     * @note 尾部缓冲区远大于待发送数据时释放多余内存（原CBuffer::Compact()的使用方式）。
+     */
+    void Shrink();
+
+    /**
+     * @brief 丢弃所有待发送数据，恢复为新建状态（连接关闭时）
+     * @note 尚未收到完成通知的MSG_ZEROCOPY数据移交暂存列表（见ParkZeroCopy()），不随之释放。
+     */
+    void Reset();
+
+private:
+    struct tagSegment
+    {
+        std::shared_ptr<const CBuffer> pData;
+        size_t uiOffset     = 0;       ///< 相对于pData可读部分的偏移
+        size_t uiLength     = 0;
+    };
+
+    struct tagZeroCopy
+    {
+        uint32 uiZeroCopyId = 0;        ///< 内核为每次MSG_ZEROCOPY发送分配的序号
+        std::deque<std::shared_ptr<const CBuffer>> dequeData;
+    };
+
+    struct tagParkedZeroCopy
+    {
+        int iFd             = -1;       ///< 连接fd的副本，-1表示无法读取完成通知
+        double dDeadline    = 0.0;      ///< 超时时间（单调时钟，单位：秒）
+        std::deque<tagZeroCopy> dequePending;
+    };
+
+    int WriteZeroCopy(int iFd, int& iErrno, uint32 uiZeroCopyThreshold);
+    static void ReapZeroCopy(int iFd, std::deque<tagZeroCopy>& dequePending);
+
+    // 连接关闭时尚未收到完成通知的MSG_ZEROCOPY数据，每个线程一份
+    static thread_local std::list<tagParkedZeroCopy>* s_pParkedZeroCopy;
+
+private:
+    CBuffer* m_pTail;
+    size_t m_uiQueuedBytes;
+    std::deque<tagSegment> m_dequeSegment;
+    std::deque<tagZeroCopy> m_dequeZeroCopyPending;
+    uint32 m_uiZeroCopyId;              ///< 下一次MSG_ZEROCOPY发送的序号
+    int8 m_cZeroCopyState;              ///< 0 未开启，1 已开启SO_ZEROCOPY，-1 不支持
+};
+
+} /* namespace neb */
+
+#endif /* SRC_CHANNEL_SENDQUEUE_HPP_ */
@@ -15,6 +15,7 @@
 #include <arpa/inet.h>
 #include "pb/msg.pb.h"
 #include "pb/http.pb.h"
+#include "util/MemoryPool.hpp"
 #include "SocketChannel.hpp"
 
 namespace neb
@@ -27,16 +28,16 @@ SocketChannel::SocketChannel(std::shared_ptr<NetLogger> pLogger, int iFd, uint32
     {
 #ifdef WITH_OPENSSL
         pLogger->WriteLog(Logger::TRACE, __FILE__, __LINE__, __FUNCTION__, "with openssl, create SocekChannelSslImpl.");
-        m_pImpl = std::dynamic_pointer_cast<SocketChannelImpl>(std::make_shared<SocketChannelSslImpl>(this, pLogger, iFd, ulSeq, dKeepAlive));
+        m_pImpl = std::dynamic_pointer_cast<SocketChannelImpl>(std::allocate_shared<SocketChannelSslImpl>(PoolAllocator<SocketChannelSslImpl>(), this, pLogger, iFd, ulSeq, dKeepAlive));
 #else
         pLogger->WriteLog(Logger::TRACE, __FILE__, __LINE__, __FUNCTION__, "without openssl, SocekChannelImpl instead.");
-        m_pImpl = std::make_shared<SocketChannelImpl>(this, pLogger, iFd, ulSeq, dKeepAlive);
+        m_pImpl = std::allocate_shared<SocketChannelImpl>(PoolAllocator<SocketChannelImpl>(), this, pLogger, iFd, ulSeq, dKeepAlive);
 #endif
     }
     else
     {
         pLogger->WriteLog(Logger::TRACE, __FILE__, __LINE__, __FUNCTION__, "create SocekChannelImpl.");
-        m_pImpl = std::make_shared<SocketChannelImpl>(this, pLogger, iFd, ulSeq, dKeepAlive);
+        m_pImpl = std::allocate_shared<SocketChannelImpl>(PoolAllocator<SocketChannelImpl>(), this, pLogger, iFd, ulSeq, dKeepAlive);
     }
 }
 
@@ -12,9 +12,11 @@
 #include "codec/CodecPrivate.hpp"
 #include "codec/CodecHttp.hpp"
 #include "codec/CodecResp.hpp"
+#include "codec/RespCmd.hpp"
 #include "labor/Labor.hpp"
 #include "labor/Manager.hpp"
 #include "logger/NetLogger.hpp"
+#include "util/MemoryPool.hpp"
 #include "SocketChannelImpl.hpp"
 
 namespace neb
@@ -27,7 +29,8 @@ SocketChannelImpl::SocketChannelImpl(SocketChannel* pSocketChannel, std::shared_
       m_dActiveTime(0.0), m_dKeepAlive(dKeepAlive),
       m_pIoWatcher(NULL), m_pTimerWatcher(NULL),
       m_pRecvBuff(nullptr), m_pSendBuff(nullptr), m_pWaitForSendBuff(nullptr),
-      m_pCodec(nullptr), m_iErrno(0), m_pLabor(nullptr), m_pSocketChannel(pSocketChannel), m_pLogger(pLogger)
+      m_pCodec(nullptr), m_iErrno(0), m_pLabor(nullptr), m_pSocketChannel(pSocketChannel), m_pLogger(pLogger),
+      m_bResolving(false)
 {
     memset(m_szErrBuff, 0, sizeof(m_szErrBuff));
 }
@@ -40,11 +43,22 @@ SocketChannelImpl::~SocketChannelImpl()
     {
         Close();
     }
-    FREE(m_pIoWatcher);
-    FREE(m_pTimerWatcher);
-    DELETE(m_pRecvBuff);
-    DELETE(m_pSendBuff);
-    DELETE(m_pWaitForSendBuff);
+    if (NULL != m_pIoWatcher)
+    {
+        MemoryPool::Deallocate(m_pIoWatcher, sizeof(ev_io));
+        m_pIoWatcher = NULL;
+    }
+    if (NULL != m_pTimerWatcher)
+    {
+        MemoryPool::Deallocate(m_pTimerWatcher, sizeof(ev_timer));
+        m_pTimerWatcher = NULL;
+    }
+    SendQueue::ReleaseBuffer(m_pRecvBuff);
+    m_pRecvBuff = nullptr;
+    SendQueue::Release(m_pSendBuff);
+    m_pSendBuff = nullptr;
+    SendQueue::Release(m_pWaitForSendBuff);
+    m_pWaitForSendBuff = nullptr;
     DELETE(m_pCodec);
 }
 
@@ -55,15 +69,15 @@ bool SocketChannelImpl::Init(E_CODEC_TYPE eCodecType, bool bIsClient)
     {
         if (m_pRecvBuff == nullptr)
         {
-            m_pRecvBuff = new CBuffer();
+            m_pRecvBuff = SendQueue::AcquireBuffer();
         }
         if (m_pSendBuff == nullptr)
         {
-            m_pSendBuff = new CBuffer();
+            m_pSendBuff = SendQueue::Acquire();
         }
         if (m_pWaitForSendBuff == nullptr)
         {
-            m_pWaitForSendBuff = new CBuffer();
+            m_pWaitForSendBuff = SendQueue::Acquire();
         }
         if (m_pCodec != nullptr)
         {
@@ -172,10 +186,10 @@ E_CODEC_STATUS SocketChannelImpl::Send()
         }
         else
         {
-            CBuffer* pExchangeBuff = m_pSendBuff;
+            SendQueue* pExchangeBuff = m_pSendBuff;
             m_pSendBuff = m_pWaitForSendBuff;
             m_pWaitForSendBuff = pExchangeBuff;
-            m_pWaitForSendBuff->Compact(1);
+            m_pWaitForSendBuff->Shrink();
         }
     }
 
@@ -184,11 +198,7 @@ E_CODEC_STATUS SocketChannelImpl::Send()
     LOG4_TRACE("iNeedWriteLen = %d, iWrittenLen = %d", iNeedWriteLen, iWrittenLen);
     if (iWrittenLen >= 0)
     {
-        if (m_pSendBuff->Capacity() > CBuffer::BUFFER_MAX_READ
-            && (m_pSendBuff->ReadableBytes() < m_pSendBuff->Capacity() / 2))
-        {
-            m_pSendBuff->Compact(m_pSendBuff->ReadableBytes() * 2);
-        }
+        m_pSendBuff->Shrink();
         m_dActiveTime = m_pLabor->GetNowTime();
         if (iNeedWriteLen == iWrittenLen && 0 == m_pWaitForSendBuff->ReadableBytes())
         {
@@ -222,7 +232,7 @@ E_CODEC_STATUS SocketChannelImpl::Send(int32 iCmd, uint32 uiSeq, const MsgBody&
         return(CODEC_STATUS_ERR);
     }
     E_CODEC_STATUS eCodecStatus = CODEC_STATUS_OK;
-    int32 iMsgBodyLen = oMsgBody.ByteSize();
+    int32 iMsgBodyLen = (int32)oMsgBody.ByteSizeLong();
     MsgHead oMsgHead;
     oMsgHead.set_cmd(iCmd);
     oMsgHead.set_seq(uiSeq);
@@ -231,7 +241,7 @@ E_CODEC_STATUS SocketChannelImpl::Send(int32 iCmd, uint32 uiSeq, const MsgBody&
     switch (m_ucChannelStatus)
     {
         case CHANNEL_STATUS_ESTABLISHED:
-            eCodecStatus = m_pCodec->Encode(oMsgHead, oMsgBody, m_pSendBuff);
+            eCodecStatus = m_pCodec->Encode(oMsgHead, oMsgBody, m_pSendBuff->GetTail());
             break;
         case CHANNEL_STATUS_CLOSED:
             LOG4_WARNING("channel_fd[%d], channel_seq[%d], channel_status[%d] send EOF.", m_iFd, m_uiSeq, m_ucChannelStatus);
@@ -248,22 +258,22 @@ E_CODEC_STATUS SocketChannelImpl::Send(int32 iCmd, uint32 uiSeq, const MsgBody&
                 case CMD_RSP_TELL_WORKER:
                     m_ucChannelStatus = CHANNEL_STATUS_ESTABLISHED;
                     m_dKeepAlive = m_pLabor->GetNodeInfo().dIoTimeout;
-                    eCodecStatus = m_pCodec->Encode(oMsgHead, oMsgBody, m_pSendBuff);
+                    eCodecStatus = m_pCodec->Encode(oMsgHead, oMsgBody, m_pSendBuff->GetTail());
                     break;
                 case CMD_REQ_TELL_WORKER:
                     m_ucChannelStatus = CHANNEL_STATUS_TELL_WORKER;
-                    eCodecStatus = m_pCodec->Encode(oMsgHead, oMsgBody, m_pSendBuff);
+                    eCodecStatus = m_pCodec->Encode(oMsgHead, oMsgBody, m_pSendBuff->GetTail());
                     break;
                 case CMD_RSP_CONNECT_TO_WORKER:
                     m_ucChannelStatus = CHANNEL_STATUS_WORKER;
-                    eCodecStatus = m_pCodec->Encode(oMsgHead, oMsgBody, m_pSendBuff);
+                    eCodecStatus = m_pCodec->Encode(oMsgHead, oMsgBody, m_pSendBuff->GetTail());
                     break;
                 case CMD_REQ_CONNECT_TO_WORKER:
                     m_ucChannelStatus = CHANNEL_STATUS_TRANSFER_TO_WORKER;
-                    eCodecStatus = m_pCodec->Encode(oMsgHead, oMsgBody, m_pSendBuff);
+                    eCodecStatus = m_pCodec->Encode(oMsgHead, oMsgBody, m_pSendBuff->GetTail());
                     break;
                 default:
-                    eCodecStatus = m_pCodec->Encode(oMsgHead, oMsgBody, m_pWaitForSendBuff);
+                    eCodecStatus = m_pCodec->Encode(oMsgHead, oMsgBody, m_pWaitForSendBuff->GetTail());
                     if (CODEC_STATUS_OK == eCodecStatus && (gc_uiCmdReq & iCmd))
                     {
                         eCodecStatus = CODEC_STATUS_PAUSE;
@@ -294,11 +304,7 @@ E_CODEC_STATUS SocketChannelImpl::Send(int32 iCmd, uint32 uiSeq, const MsgBody&
     LOG4_TRACE("iNeedWriteLen = %d, iWrittenLen = %d", iNeedWriteLen, iWrittenLen);
     if (iWrittenLen >= 0)
     {
-        if (m_pSendBuff->Capacity() > CBuffer::BUFFER_MAX_READ
-            && (m_pSendBuff->ReadableBytes() < m_pSendBuff->Capacity() / 2))
-        {
-            m_pSendBuff->Compact(m_pSendBuff->ReadableBytes() * 2);
-        }
+        m_pSendBuff->Shrink();
         m_dActiveTime = m_pLabor->GetNowTime();
         if (iNeedWriteLen == iWrittenLen)
         {
@@ -330,6 +336,22 @@ E_CODEC_STATUS SocketChannelImpl::Send(int32 iCmd, uint32 uiSeq, const MsgBody&
     }
 }
 
+E_CODEC_STATUS SocketChannelImpl::Send(EncodedFrame& oFrame)
+{
+    LOG4_TRACE("channel_fd[%d], channel_seq[%d], cmd[%u], seq[%u]", m_iFd, m_uiSeq, oFrame.GetCmd(), oFrame.GetSeq());
+    if (CHANNEL_STATUS_ESTABLISHED == m_ucChannelStatus)
+    {
+        // 已编码的数据以引用方式挂入发送队列，多个连接共享同一份编码结果
+        std::shared_ptr<const CBuffer> pEncoded = oFrame.GetEncoded(m_pCodec);
+        if (nullptr != pEncoded)
+        {
+            m_pSendBuff->Append(pEncoded, 0, pEncoded->ReadableBytes());
+            return(Send());
+        }
+    }
+    return(Send(oFrame.GetCmd(), oFrame.GetSeq(), oFrame.GetMsgBody()));
+}
+
 E_CODEC_STATUS SocketChannelImpl::Send(const HttpMsg& oHttpMsg, uint32 uiStepSeq)
 {
     LOG4_TRACE("channel_fd[%d], channel_seq[%d], channel_status[%d]", m_iFd, m_uiSeq, m_ucChannelStatus);
@@ -342,7 +364,7 @@ E_CODEC_STATUS SocketChannelImpl::Send(const HttpMsg& oHttpMsg, uint32 uiStepSeq
     switch (m_ucChannelStatus)
     {
         case CHANNEL_STATUS_ESTABLISHED:
-            eCodecStatus = ((CodecHttp*)m_pCodec)->Encode(oHttpMsg, m_pSendBuff);
+            eCodecStatus = ((CodecHttp*)m_pCodec)->Encode(oHttpMsg, m_pSendBuff->GetTail());
             break;
         case CHANNEL_STATUS_CLOSED:
             LOG4_WARNING("channel_fd[%d], channel_seq[%d], channel_status[%d] send EOF.", m_iFd, m_uiSeq, m_ucChannelStatus);
@@ -353,7 +375,7 @@ E_CODEC_STATUS SocketChannelImpl::Send(const HttpMsg& oHttpMsg, uint32 uiStepSeq
         case CHANNEL_STATUS_CONNECTED:
         case CHANNEL_STATUS_TRY_CONNECT:
         case CHANNEL_STATUS_INIT:
-            eCodecStatus = ((CodecHttp*)m_pCodec)->Encode(oHttpMsg, m_pWaitForSendBuff);
+            eCodecStatus = ((CodecHttp*)m_pCodec)->Encode(oHttpMsg, m_pWaitForSendBuff->GetTail());
             if (CODEC_STATUS_OK == eCodecStatus && uiStepSeq > 0)
             {
                 eCodecStatus = CODEC_STATUS_PAUSE;
@@ -381,11 +403,7 @@ E_CODEC_STATUS SocketChannelImpl::Send(const HttpMsg& oHttpMsg, uint32 uiStepSeq
             GetFd(), GetSequence(), iWrittenLen, m_iErrno);
     if (iWrittenLen >= 0)
     {
-        if (m_pSendBuff->Capacity() > CBuffer::BUFFER_MAX_READ
-            && (m_pSendBuff->ReadableBytes() < m_pSendBuff->Capacity() / 2))
-        {
-            m_pSendBuff->Compact(m_pSendBuff->ReadableBytes() * 2);
-        }
+        m_pSendBuff->Shrink();
         if (uiStepSeq > 0)
         {
             m_listPipelineStepSeq.push_back(uiStepSeq);
@@ -414,19 +432,16 @@ E_CODEC_STATUS SocketChannelImpl::Send(const HttpMsg& oHttpMsg, uint32 uiStepSeq
     }
 }
 
-E_CODEC_STATUS SocketChannelImpl::Send(const RedisMsg& oRedisMsg, uint32 uiStepSeq)
+template <typename T_ENCODER>
+E_CODEC_STATUS SocketChannelImpl::SendResp(uint32 uiMsgNum, uint32 uiStepSeq, T_ENCODER fnEncode)
 {
-    LOG4_TRACE("channel_fd[%d], channel_seq[%d], channel_status[%d]", m_iFd, m_uiSeq, m_ucChannelStatus);
-    if (m_pCodec == nullptr)
-    {
-        LOG4_ERROR("no codec found, please check whether the CODEC_TYPE is valid.");
-        return(CODEC_STATUS_ERR);
-    }
-    E_CODEC_STATUS eCodecStatus = CODEC_STATUS_OK;
+    LOG4_TRACE("channel_fd[%d], channel_seq[%d], channel_status[%d], msg num %u",
+            m_iFd, m_uiSeq, m_ucChannelStatus, uiMsgNum);
+    CBuffer* pBuff = nullptr;
     switch (m_ucChannelStatus)
     {
         case CHANNEL_STATUS_ESTABLISHED:
-            eCodecStatus = ((CodecResp*)m_pCodec)->Encode(oRedisMsg, m_pSendBuff);
+            pBuff = m_pSendBuff->GetTail();
             break;
         case CHANNEL_STATUS_CLOSED:
             LOG4_WARNING("channel_fd[%d], channel_seq[%d], channel_status[%d] send EOF.", m_iFd, m_uiSeq, m_ucChannelStatus);
@@ -437,43 +452,45 @@ E_CODEC_STATUS SocketChannelImpl::Send(const RedisMsg& oRedisMsg, uint32 uiStepS
         case CHANNEL_STATUS_CONNECTED:
         case CHANNEL_STATUS_TRY_CONNECT:
         case CHANNEL_STATUS_INIT:
-            eCodecStatus = ((CodecResp*)m_pCodec)->Encode(oRedisMsg, m_pWaitForSendBuff);
-            if (CODEC_STATUS_OK == eCodecStatus && uiStepSeq > 0)
-            {
-                eCodecStatus = CODEC_STATUS_PAUSE;
-                m_listPipelineStepSeq.push_back(uiStepSeq);
-            }
+            pBuff = m_pWaitForSendBuff->GetTail();
             break;
         default:
             LOG4_ERROR("%s invalid connect status %d!", m_strIdentify.c_str(), m_ucChannelStatus);
             return(CODEC_STATUS_OK);
     }
 
+    // 任一条编码失败则整批不发送：缓冲区回退到本批编码之前的长度（编码扩容时数据可能整体前移，按可读长度回退）
+    size_t uiReadableBytes = pBuff->ReadableBytes();
+    E_CODEC_STATUS eCodecStatus = CODEC_STATUS_OK;
+    for (uint32 i = 0; i < uiMsgNum && CODEC_STATUS_OK == eCodecStatus; ++i)
+    {
+        eCodecStatus = fnEncode(i, pBuff);
+    }
     if (CODEC_STATUS_OK != eCodecStatus)
     {
+        pBuff->SetWriteIndex(pBuff->GetReadIndex() + uiReadableBytes);
+        LOG4_ERROR("%s encode failed, %u redis msg discarded.", m_strIdentify.c_str(), uiMsgNum);
         return(eCodecStatus);
     }
-
-    int iNeedWriteLen = m_pSendBuff->ReadableBytes();
-    if (iNeedWriteLen <= 0)
+    if (uiStepSeq > 0)
     {
-        return(eCodecStatus);
+        for (uint32 i = 0; i < uiMsgNum; ++i)
+        {
+            m_listPipelineStepSeq.push_back(uiStepSeq);
+        }
+    }
+    if (CHANNEL_STATUS_ESTABLISHED != m_ucChannelStatus)
+    {
+        return(CODEC_STATUS_PAUSE);
     }
 
+    int iNeedWriteLen = m_pSendBuff->ReadableBytes();
     int iWrittenLen = Write(m_pSendBuff, m_iErrno);
     LOG4_TRACE("fd[%d], channel_seq[%u] iWrittenLen = %d, m_iErrno = %d",
             GetFd(), GetSequence(), iWrittenLen, m_iErrno);
     if (iWrittenLen >= 0)
     {
-        if (m_pSendBuff->Capacity() > CBuffer::BUFFER_MAX_READ
-            && (m_pSendBuff->ReadableBytes() < m_pSendBuff->Capacity() / 2))
-        {
-            m_pSendBuff->Compact(m_pSendBuff->ReadableBytes() * 2);
-        }
-        if (uiStepSeq > 0)
-        {
-            m_listPipelineStepSeq.push_back(uiStepSeq);
-        }
+        m_pSendBuff->Shrink();
         m_dActiveTime = m_pLabor->GetNowTime();
         if (iNeedWriteLen == iWrittenLen)
         {
@@ -498,6 +515,50 @@ E_CODEC_STATUS SocketChannelImpl::Send(const RedisMsg& oRedisMsg, uint32 uiStepS
     }
 }
 
+E_CODEC_STATUS SocketChannelImpl::Send(const RedisMsg& oRedisMsg, uint32 uiStepSeq)
+{
+    if (m_pCodec == nullptr)
+    {
+        LOG4_ERROR("no codec found, please check whether the CODEC_TYPE is valid.");
+        return(CODEC_STATUS_ERR);
+    }
+    CodecResp* pCodec = (CodecResp*)m_pCodec;
+    return(SendResp(1, uiStepSeq, [pCodec, &oRedisMsg](uint32 i, CBuffer* pBuff)
+            { return(pCodec->Encode(oRedisMsg, pBuff)); }));
+}
+
+E_CODEC_STATUS SocketChannelImpl::Send(const std::vector<std::shared_ptr<RedisMsg> >& vecRedisMsg, uint32 uiStepSeq)
+{
+    if (m_pCodec == nullptr)
+    {
+        LOG4_ERROR("no codec found, please check whether the CODEC_TYPE is valid.");
+        return(CODEC_STATUS_ERR);
+    }
+    if (vecRedisMsg.empty())
+    {
+        return(CODEC_STATUS_OK);
+    }
+    CodecResp* pCodec = (CodecResp*)m_pCodec;
+    return(SendResp(vecRedisMsg.size(), uiStepSeq, [pCodec, &vecRedisMsg](uint32 i, CBuffer* pBuff)
+            { return(pCodec->Encode(*vecRedisMsg[i], pBuff)); }));
+}
+
+E_CODEC_STATUS SocketChannelImpl::Send(const RespCmd& oRespCmd, uint32 uiStepSeq)
+{
+    return(SendResp(1, uiStepSeq, [&oRespCmd](uint32 i, CBuffer* pBuff)
+            { return(oRespCmd.Encode(pBuff)); }));
+}
+
+E_CODEC_STATUS SocketChannelImpl::Send(const std::vector<RespCmd>& vecRespCmd, uint32 uiStepSeq)
+{
+    if (vecRespCmd.empty())
+    {
+        return(CODEC_STATUS_OK);
+    }
+    return(SendResp(vecRespCmd.size(), uiStepSeq, [&vecRespCmd](uint32 i, CBuffer* pBuff)
+            { return(vecRespCmd[i].Encode(pBuff)); }));
+}
+
 E_CODEC_STATUS SocketChannelImpl::Send(const char* pRaw, uint32 uiRawSize, uint32 uiStepSeq)
 {
     LOG4_TRACE("channel_fd[%d], channel_seq[%d], channel_status[%d]", m_iFd, m_uiSeq, m_ucChannelStatus);
@@ -505,7 +566,7 @@ E_CODEC_STATUS SocketChannelImpl::Send(const char* pRaw, uint32 uiRawSize, uint3
     switch (m_ucChannelStatus)
     {
         case CHANNEL_STATUS_ESTABLISHED:
-            m_pSendBuff->Write(pRaw, uiRawSize);
+            m_pSendBuff->GetTail(uiRawSize)->Write(pRaw, uiRawSize);
             break;
         case CHANNEL_STATUS_CLOSED:
             LOG4_WARNING("channel_fd[%d], channel_seq[%d], channel_status[%d] send EOF.", m_iFd, m_uiSeq, m_ucChannelStatus);
@@ -516,7 +577,7 @@ E_CODEC_STATUS SocketChannelImpl::Send(const char* pRaw, uint32 uiRawSize, uint3
         case CHANNEL_STATUS_CONNECTED:
         case CHANNEL_STATUS_TRY_CONNECT:
         case CHANNEL_STATUS_INIT:
-            m_pWaitForSendBuff->Write(pRaw, uiRawSize);
+            m_pWaitForSendBuff->GetTail(uiRawSize)->Write(pRaw, uiRawSize);
             eCodecStatus = CODEC_STATUS_PAUSE;
             break;
         default:
@@ -540,11 +601,7 @@ E_CODEC_STATUS SocketChannelImpl::Send(const char* pRaw, uint32 uiRawSize, uint3
             GetFd(), GetSequence(), iWrittenLen, m_iErrno);
     if (iWrittenLen >= 0)
     {
-        if (m_pSendBuff->Capacity() > CBuffer::BUFFER_MAX_READ
-            && (m_pSendBuff->ReadableBytes() < m_pSendBuff->Capacity() / 2))
-        {
-            m_pSendBuff->Compact(m_pSendBuff->ReadableBytes() * 2);
-        }
+        m_pSendBuff->Shrink();
         if (uiStepSeq > 0)
         {
             m_listPipelineStepSeq.push_back(uiStepSeq);
@@ -758,6 +815,17 @@ E_CODEC_STATUS SocketChannelImpl::Recv(HttpMsg& oHttpMsg)
 }
 
 E_CODEC_STATUS SocketChannelImpl::Recv(RedisReply& oRedisReply)
+{
+    RespView oRespView;
+    E_CODEC_STATUS eCodecStatus = Recv(oRespView);
+    if (CODEC_STATUS_OK == eCodecStatus && !oRespView.ToRedisReply(oRedisReply))
+    {
+        return(CODEC_STATUS_ERR);
+    }
+    return(eCodecStatus);
+}
+
+E_CODEC_STATUS SocketChannelImpl::Recv(RespView& oRespView)
 {
     LOG4_TRACE("channel_fd[%d], channel_seq[%d]", m_iFd, m_uiSeq);
     if (CHANNEL_STATUS_CLOSED == m_ucChannelStatus)
@@ -782,7 +850,7 @@ E_CODEC_STATUS SocketChannelImpl::Recv(RedisReply& oRedisReply)
             m_pRecvBuff->Compact(m_pRecvBuff->ReadableBytes() * 2);
         }
         m_dActiveTime = m_pLabor->GetNowTime();
-        E_CODEC_STATUS eCodecStatus = ((CodecResp*)m_pCodec)->Decode(m_pRecvBuff, oRedisReply);
+        E_CODEC_STATUS eCodecStatus = ((CodecResp*)m_pCodec)->Decode(m_pRecvBuff, oRespView);
         if (CODEC_STATUS_OK == eCodecStatus)
         {
             ++m_uiUnitTimeMsgNum;
@@ -809,7 +877,7 @@ E_CODEC_STATUS SocketChannelImpl::Recv(RedisReply& oRedisReply)
                         m_iFd, m_iErrno, m_strErrMsg.c_str());
         if (m_pRecvBuff->ReadableBytes() > 0)
         {
-            ((CodecResp*)m_pCodec)->Decode(m_pRecvBuff, oRedisReply);
+            ((CodecResp*)m_pCodec)->Decode(m_pRecvBuff, oRespView);
         }
         return(CODEC_STATUS_EOF);
     }
@@ -935,6 +1003,17 @@ E_CODEC_STATUS SocketChannelImpl::Fetch(HttpMsg& oHttpMsg)
 }
 
 E_CODEC_STATUS SocketChannelImpl::Fetch(RedisReply& oRedisReply)
+{
+    RespView oRespView;
+    E_CODEC_STATUS eCodecStatus = Fetch(oRespView);
+    if (CODEC_STATUS_OK == eCodecStatus && !oRespView.ToRedisReply(oRedisReply))
+    {
+        return(CODEC_STATUS_ERR);
+    }
+    return(eCodecStatus);
+}
+
+E_CODEC_STATUS SocketChannelImpl::Fetch(RespView& oRespView)
 {
     LOG4_TRACE("channel_fd[%d], channel_seq[%d]", m_iFd, m_uiSeq);
     if (CHANNEL_STATUS_CLOSED == m_ucChannelStatus)
@@ -942,7 +1021,7 @@ E_CODEC_STATUS SocketChannelImpl::Fetch(RedisReply& oRedisReply)
         LOG4_WARNING("channel_fd[%d], channel_seq[%d], channel_status[%d] recv EOF.", m_iFd, m_uiSeq, m_ucChannelStatus);
         return(CODEC_STATUS_EOF);
     }
-    E_CODEC_STATUS eCodecStatus = ((CodecResp*)m_pCodec)->Decode(m_pRecvBuff, oRedisReply);
+    E_CODEC_STATUS eCodecStatus = ((CodecResp*)m_pCodec)->Decode(m_pRecvBuff, oRespView);
     if (CODEC_STATUS_OK == eCodecStatus)
     {
         ++m_uiUnitTimeMsgNum;
@@ -1065,7 +1144,7 @@ ev_io* SocketChannelImpl::MutableIoWatcher()
 {
     if (NULL == m_pIoWatcher)
     {
-        m_pIoWatcher = (ev_io*)malloc(sizeof(ev_io));
+        m_pIoWatcher = (ev_io*)MemoryPool::Allocate(sizeof(ev_io));
         if (NULL != m_pIoWatcher)
         {
             memset(m_pIoWatcher, 0, sizeof(ev_io));
@@ -1080,7 +1159,7 @@ ev_timer* SocketChannelImpl::MutableTimerWatcher()
 {
     if (NULL == m_pTimerWatcher)
     {
-        m_pTimerWatcher = (ev_timer*)malloc(sizeof(ev_timer));
+        m_pTimerWatcher = (ev_timer*)MemoryPool::Allocate(sizeof(ev_timer));
         if (NULL != m_pTimerWatcher)
         {
             memset(m_pTimerWatcher, 0, sizeof(ev_timer));
@@ -1095,11 +1174,27 @@ bool SocketChannelImpl::Close()
     LOG4_TRACE("channel[%d] channel_status %d", m_iFd, m_ucChannelStatus);
     if (CHANNEL_STATUS_CLOSED != m_ucChannelStatus)
     {
-        m_pSendBuff->Compact(1);
-        m_pWaitForSendBuff->Compact(1);
+        // 内核仍可能读取尚未完成的零拷贝数据，移交暂存列表后才能释放发送队列（两个队列会交换使用）
+        if (nullptr != m_pSendBuff)
+        {
+            m_pSendBuff->ParkZeroCopy(m_iFd);
+        }
+        if (nullptr != m_pWaitForSendBuff)
+        {
+            m_pWaitForSendBuff->ParkZeroCopy(m_iFd);
+        }
         if (0 == close(m_iFd))
         {
             m_ucChannelStatus = CHANNEL_STATUS_CLOSED;
+            // 关闭后的连接可能仍被Actor引用一段时间，待发送数据已无法发送，提前释放
+            if (nullptr != m_pSendBuff)
+            {
+                m_pSendBuff->Reset();
+            }
+            if (nullptr != m_pWaitForSendBuff)
+            {
+                m_pWaitForSendBuff->Reset();
+            }
             LOG4_TRACE("channel[%d], channel_seq[%u] close successfully.", m_iFd, GetSequence());
             return(true);
         }
@@ -1116,15 +1211,27 @@ bool SocketChannelImpl::Close()
     }
 }
 
-int SocketChannelImpl::Write(CBuffer* pBuff, int& iErrno)
+int SocketChannelImpl::Write(SendQueue* pBuff, int& iErrno)
 {
     LOG4_TRACE("fd[%d], channel_seq[%u]", GetFd(), GetSequence());
-    return(pBuff->WriteFD(m_iFd, iErrno));
+    if (pBuff->HasZeroCopyPending())
+    {
+        pBuff->ReapZeroCopy(m_iFd);
+    }
+    return(pBuff->WriteFD(m_iFd, iErrno, m_pLabor->GetNodeInfo().uiZeroCopyThreshold));
 }
 
 int SocketChannelImpl::Read(CBuffer* pBuff, int& iErrno)
 {
     LOG4_TRACE("fd[%d], channel_seq[%u]", GetFd(), GetSequence());
+    if (nullptr != m_pSendBuff && m_pSendBuff->HasZeroCopyPending())
+    {
+        m_pSendBuff->ReapZeroCopy(m_iFd);   // 零拷贝完成通知使fd可读，须先读走
+    }
+    if (nullptr != m_pWaitForSendBuff && m_pWaitForSendBuff->HasZeroCopyPending())
+    {
+        m_pWaitForSendBuff->ReapZeroCopy(m_iFd);
+    }
     return(pBuff->ReadFD(m_iFd, iErrno));
 }
 
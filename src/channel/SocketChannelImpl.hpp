@@ -11,6 +11,7 @@
 #define SRC_CHANNEL_SOCKETCHANNELIMPL_HPP_
 
 #include <memory>
+#include <vector>
 
 #ifdef __GNUC__
 #pragma GCC diagnostic push
@@ -22,12 +23,14 @@
 #endif
 
 #include "util/CBuffer.hpp"
+#include "SendQueue.hpp"
 #include "util/StreamCodec.hpp"
 #include "util/json/CJsonObject.hpp"
 
 #include "pb/http.pb.h"
 #include "pb/redis.pb.h"
 #include "codec/Codec.hpp"
+#include "codec/EncodedFrame.hpp"
 #include "Channel.hpp"
 #include "Definition.hpp"
 #include "logger/NetLogger.hpp"
@@ -40,6 +43,8 @@ typedef RedisReply RedisMsg;
 class Labor;
 class NetLogger;
 class SocketChannel;
+class RespView;
+class RespCmd;
 
 class SocketChannelImpl: public Channel
 {
@@ -55,17 +60,36 @@ public:
     virtual E_CODEC_STATUS Send(int32 iCmd, uint32 uiSeq, const MsgBody& oMsgBody);
     virtual E_CODEC_STATUS Send(const HttpMsg& oHttpMsg, uint32 uiStepSeq);
     virtual E_CODEC_STATUS Send(const RedisMsg& oRedisMsg, uint32 uiStepSeq);
+    /**
+     * @brief 批量发送redis命令（pipeline），全部编码后一次写出，每条命令登记一个uiStepSeq
+     */
+    virtual E_CODEC_STATUS Send(const std::vector<std::shared_ptr<RedisMsg> >& vecRedisMsg, uint32 uiStepSeq);
+    /**
+     * @brief 发送redis命令，命令直接编码进发送缓冲区，不经RedisMsg
+     */
+    virtual E_CODEC_STATUS Send(const RespCmd& oRespCmd, uint32 uiStepSeq);
+    /**
+     * @brief 批量发送redis命令（pipeline），每条命令登记一个uiStepSeq
+     */
+    virtual E_CODEC_STATUS Send(const std::vector<RespCmd>& vecRespCmd, uint32 uiStepSeq);
     virtual E_CODEC_STATUS Send(const char* pRaw, uint32 uiRawSize, uint32 uiStepSeq);
+    virtual E_CODEC_STATUS Send(EncodedFrame& oFrame);
     virtual E_CODEC_STATUS Recv(MsgHead& oMsgHead, MsgBody& oMsgBody);
     virtual E_CODEC_STATUS Recv(HttpMsg& oHttpMsg);
     virtual E_CODEC_STATUS Recv(RedisReply& oRedisReply);
+    /**
+     * @brief 零拷贝接收redis消息，oRespView引用接收缓冲区，下一次Recv()或Fetch()之前有效
+     */
+    virtual E_CODEC_STATUS Recv(RespView& oRespView);
     virtual E_CODEC_STATUS Recv(CBuffer& oRawBuff);
     E_CODEC_STATUS Fetch(MsgHead& oMsgHead, MsgBody& oMsgBody);
     E_CODEC_STATUS Fetch(HttpMsg& oHttpMsg);
     E_CODEC_STATUS Fetch(RedisReply& oRedisReply);
+    E_CODEC_STATUS Fetch(RespView& oRespView);
     E_CODEC_STATUS Fetch(CBuffer& oRawBuff);
 
     template <typename ...Targs> void Logger(int iLogLevel, const char* szFileName, unsigned int uiFileLine, const char* szFunction, Targs&&... args);
+    bool IsLogLevelEnabled(int iLogLevel) const;
 
 public:
     int GetFd() const
@@ -90,6 +114,11 @@ public:
         return(m_bPipeline);
     }
 
+    bool IsResolving() const
+    {
+        return(m_bResolving);
+    }
+
     ev_tstamp GetKeepAlive();
 
     uint8 GetChannelStatus() const
@@ -139,6 +168,15 @@ public:
         return(m_listPipelineStepSeq);
     }
 
+    /**
+     * @brief 发送队列和等待发送队列中尚未写出的字节数
+     */
+    size_t GetQueuedBytes() const
+    {
+        return(((nullptr == m_pSendBuff) ? 0 : m_pSendBuff->ReadableBytes())
+                + ((nullptr == m_pWaitForSendBuff) ? 0 : m_pWaitForSendBuff->ReadableBytes()));
+    }
+
     Labor* GetLabor()
     {
         return(m_pLabor);
@@ -182,6 +220,11 @@ public:
         m_bPipeline = bPipeline;
     }
 
+    void SetResolving(bool bResolving)
+    {
+        m_bResolving = bResolving;
+    }
+
     void SetClientData(const std::string& strClientData)
     {
         m_strClientData = strClientData;
@@ -211,7 +254,14 @@ public:
     virtual bool Close();
 
 protected:
-    virtual int Write(CBuffer* pBuff, int& iErrno);
+    /**
+     * @brief 编码并发送一批redis消息（RedisMsg或RespCmd），各Send()重载共用
+     * @note 任一条编码失败时整批丢弃，不发送已编码的部分；编码成功的每条消息登记一次uiStepSeq。
+     * @param fnEncode E_CODEC_STATUS(uint32 uiIndex, CBuffer* pBuff)，编码第uiIndex条消息
+     */
+    template <typename T_ENCODER>
+    E_CODEC_STATUS SendResp(uint32 uiMsgNum, uint32 uiStepSeq, T_ENCODER fnEncode);
+    virtual int Write(SendQueue* pBuff, int& iErrno);
     virtual int Read(CBuffer* pBuff, int& iErrno);
 
 private:
@@ -229,8 +279,8 @@ private:
     ev_io* m_pIoWatcher;                  ///< 不在结构体析构时回收
     ev_timer* m_pTimerWatcher;            ///< 不在结构体析构时回收
     CBuffer* m_pRecvBuff;
-    CBuffer* m_pSendBuff;
-    CBuffer* m_pWaitForSendBuff;    ///< 等待发送的数据缓冲区（数据到达时，连接并未建立，等连接建立并且pSendBuff发送完毕后立即发送）
+    SendQueue* m_pSendBuff;               ///< 发送队列（编码写入队尾，链式分段以writev发送）
+    SendQueue* m_pWaitForSendBuff;        ///< 等待发送的数据缓冲区（数据到达时，连接并未建立，等连接建立并且pSendBuff发送完毕后立即发送）
     Codec* m_pCodec;                      ///< 编解码器
     int m_iErrno;
     std::string m_strKey;                 ///< 密钥
@@ -243,6 +293,7 @@ private:
     Labor* m_pLabor;
     SocketChannel* m_pSocketChannel;
     std::shared_ptr<NetLogger> m_pLogger;
+    bool m_bResolving;                    ///< 对端域名解析中，尚未发起连接（不能加入IO事件）
 };
 
 template <typename ...Targs>
@@ -251,6 +302,11 @@ void SocketChannelImpl::Logger(int iLogLevel, const char* szFileName, unsigned i
     m_pLogger->WriteLog(iLogLevel, szFileName, uiFileLine, szFunction, std::forward<Targs>(args)...);
 }
 
+inline bool SocketChannelImpl::IsLogLevelEnabled(int iLogLevel) const
+{
+    return(m_pLogger->IsLevelEnabled(iLogLevel));
+}
+
 } /* namespace neb */
 
 #endif /* SRC_CHANNEL_SOCKETCHANNELIMPL_HPP_ */
@@ -10,17 +10,30 @@
 
 #ifdef WITH_OPENSSL
 #include "SocketChannelSslImpl.hpp"
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#ifndef TCP_ULP
+#define TCP_ULP 31      // linux/tcp.h，旧版本glibc的netinet/tcp.h中没有
+#endif
 
 namespace neb
 {
 
 SSL_CTX* SocketChannelSslImpl::s_pServerSslCtx = NULL;
 SSL_CTX* SocketChannelSslImpl::s_pClientSslCtx = NULL;
+bool SocketChannelSslImpl::s_bKtls = false;
 
 SocketChannelSslImpl::SocketChannelSslImpl(
     SocketChannel* pSocketChannel, std::shared_ptr<NetLogger> pLogger, int iFd, uint32 ulSeq, ev_tstamp dKeepAlive)
     : SocketChannelImpl(pSocketChannel, pLogger, iFd, ulSeq, dKeepAlive),
-      m_eSslChannelStatus(SSL_CHANNEL_INIT), m_bIsClientConnection(false), m_pSslConnection(NULL)
+      m_eSslChannelStatus(SSL_CHANNEL_INIT), m_bIsClientConnection(false), m_pSslConnection(NULL),
+      m_ullHandshakeCpuNs(0), m_bKtlsSend(false), m_bKtlsRecv(false)
 {
 }
 
@@ -143,6 +156,53 @@ int SocketChannelSslImpl::SslServerCertificate(std::shared_ptr<NetLogger> pLogge
     return(ERR_OK);
 }
 
+void SocketChannelSslImpl::SslServerSessionResumption(bool bTicket, long lTimeout)
+{
+    SslResumption::Setup(s_pServerSslCtx, bTicket, lTimeout);
+}
+
+void SocketChannelSslImpl::SslEnableKtls(std::shared_ptr<NetLogger> pLogger)
+{
+#ifdef SSL_OP_ENABLE_KTLS
+    int iErrno = 0;
+    if (!KtlsProbe(iErrno))
+    {
+        // 不关闭read_ahead，避免内核不支持时白白增加一次read()调用
+        pLogger->WriteLog(neb::Logger::WARNING, __FILE__, __LINE__, __FUNCTION__,
+                "ktls is not supported by the kernel (setsockopt TCP_ULP \"tls\": %s), ignored.",
+                strerror(iErrno));
+        return;
+    }
+    s_bKtls = true;
+    SSL_CTX_set_options(s_pServerSslCtx, SSL_OP_ENABLE_KTLS);
+    // read_ahead时握手结束后OpenSSL的缓冲区里可能已有后续记录，OpenSSL不会再开启接收方向的kTLS
+    SSL_CTX_set_read_ahead(s_pServerSslCtx, 0);
+    if (s_pClientSslCtx != NULL)
+    {
+        SSL_CTX_set_options(s_pClientSslCtx, SSL_OP_ENABLE_KTLS);
+    }
+    pLogger->WriteLog(neb::Logger::INFO, __FILE__, __LINE__, __FUNCTION__, "ktls enabled.");
+#else
+    pLogger->WriteLog(neb::Logger::WARNING, __FILE__, __LINE__, __FUNCTION__,
+            "ktls is not supported by this OpenSSL version, ignored.");
+#endif
+}
+
+bool SocketChannelSslImpl::KtlsProbe(int& iErrno)
+{
+    int iFd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (iFd < 0)
+    {
+        iErrno = errno;
+        return(false);
+    }
+    // 内核找到（或自动加载了）tls模块后，对未连接的socket返回ENOTCONN；没有tls模块时返回ENOENT
+    bool bSupported = (0 == setsockopt(iFd, SOL_TCP, TCP_ULP, "tls", sizeof("tls")) || ENOTCONN == errno);
+    iErrno = errno;
+    close(iFd);
+    return(bSupported);
+}
+
 void SocketChannelSslImpl::SslFree()
 {
     if (s_pServerSslCtx)
@@ -167,6 +227,12 @@ int SocketChannelSslImpl::SslClientCtxCreate()
             LOG4_ERROR("SSL_CTX_new() failed!");
             return(ERR_SSL_CTX);
         }
+#ifdef SSL_OP_ENABLE_KTLS
+        if (s_bKtls)
+        {
+            SSL_CTX_set_options(s_pClientSslCtx, SSL_OP_ENABLE_KTLS);
+        }
+#endif
     }
     return(ERR_OK);
 }
@@ -188,6 +254,9 @@ int SocketChannelSslImpl::SslCreateConnection()
         return(ERR_SSL_NEW_CONNECTION);
     }
 
+    // 发送队列的尾部缓冲区在SSL_write()重试之间可能因继续编码而扩容搬移
+    SSL_set_mode(m_pSslConnection, SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+
     if (!SSL_set_fd(m_pSslConnection, GetFd()))
     {
         LOG4_ERROR("SSL_set_fd() failed!");
@@ -209,11 +278,26 @@ int SocketChannelSslImpl::SslCreateConnection()
 int SocketChannelSslImpl::SslHandshake()
 {
     LOG4_TRACE("");
+    struct timespec stCpuBegin;
+    struct timespec stCpuEnd;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &stCpuBegin);
     int iHandshakeResult = SSL_do_handshake(m_pSslConnection);
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &stCpuEnd);
+    m_ullHandshakeCpuNs += (stCpuEnd.tv_sec - stCpuBegin.tv_sec) * 1000000000LL
+        + (stCpuEnd.tv_nsec - stCpuBegin.tv_nsec);
     if (iHandshakeResult == 1)
     {
         LOG4_TRACE("fd %d ssl handshake was successful.", GetFd());
         m_eSslChannelStatus = SSL_CHANNEL_ESTABLISHED;
+        if (!m_bIsClientConnection)
+        {
+            SslResumption::AddHandshake(SSL_session_reused(m_pSslConnection), m_ullHandshakeCpuNs / 1000);
+        }
+#ifdef SSL_OP_ENABLE_KTLS
+        m_bKtlsSend = (BIO_get_ktls_send(SSL_get_wbio(m_pSslConnection)) > 0);
+        m_bKtlsRecv = (BIO_get_ktls_recv(SSL_get_rbio(m_pSslConnection)) > 0);
+        LOG4_DEBUG("fd %d ktls send %d, ktls recv %d.", GetFd(), m_bKtlsSend, m_bKtlsRecv);
+#endif
         return(ERR_OK);
     }
     else    // 0 and < 0
@@ -374,14 +458,11 @@ int SocketChannelSslImpl::SslShutdown()
         m_eSslChannelStatus = SSL_CHANNEL_SHUTDOWN;
     }
 
+    // 服务端会话须保留以供客户端重连时复用，未正常关闭的会话SSL_free()会标记为不可复用
     if (m_bIsClientConnection)
     {
         SSL_CTX_remove_session(s_pClientSslCtx, SSL_get0_session(m_pSslConnection));
     }
-    else
-    {
-        SSL_CTX_remove_session(s_pServerSslCtx, SSL_get0_session(m_pSslConnection));
-    }
 
     SSL_free(m_pSslConnection);
     m_pSslConnection = NULL;
@@ -551,6 +632,16 @@ E_CODEC_STATUS SocketChannelSslImpl::Send(int32 iCmd, uint32 uiSeq, const MsgBod
     }
 }
 
+E_CODEC_STATUS SocketChannelSslImpl::Send(EncodedFrame& oFrame)
+{
+    LOG4_TRACE("");
+    if (SSL_CHANNEL_ESTABLISHED == m_eSslChannelStatus)
+    {
+        return(SocketChannelImpl::Send(oFrame));
+    }
+    return(Send(oFrame.GetCmd(), oFrame.GetSeq(), oFrame.GetMsgBody()));  // 握手未完成，走握手流程
+}
+
 E_CODEC_STATUS SocketChannelSslImpl::Send(const HttpMsg& oHttpMsg, uint32 ulStepSeq)
 {
     LOG4_TRACE("");
@@ -833,17 +924,35 @@ bool SocketChannelSslImpl::Close()
     return(SocketChannelImpl::Close());
 }
 
-int SocketChannelSslImpl::Write(CBuffer* pBuff, int& iErrno)
+int SocketChannelSslImpl::Write(SendQueue* pBuff, int& iErrno)
 {
     LOG4_TRACE("");
-    int iNeedWriteLen = (int)pBuff->ReadableBytes();
-    int iWritenLen = SSL_write(m_pSslConnection, pBuff->GetRawReadBuffer(), iNeedWriteLen);
-    if (iWritenLen > 0)
+    if (m_bKtlsSend)
     {
-        pBuff->AdvanceReadIndex(iWritenLen);
+        // 内核加密，明文直接分散写到socket，内核按应用数据记录封装；kTLS的socket不支持MSG_ZEROCOPY
+        return(pBuff->WriteFD(GetFd(), iErrno, 0));
     }
-    else
+    // SSL_write()不支持分散写，逐段写入；部分写入后出错时返回已写入的长度
+    int iHadWriteLen = 0;
+    const char* pData = nullptr;
+    size_t uiNeedWriteLen = 0;
+    while (pBuff->Front(pData, uiNeedWriteLen))
     {
+        int iWritenLen = SSL_write(m_pSslConnection, pData, (int)uiNeedWriteLen);
+        if (iWritenLen > 0)
+        {
+            pBuff->Skip(iWritenLen);
+            iHadWriteLen += iWritenLen;
+            if ((size_t)iWritenLen < uiNeedWriteLen)
+            {
+                break;
+            }
+            continue;
+        }
+        if (iHadWriteLen > 0)
+        {
+            break;
+        }
         iErrno = errno;
         int iErrCode = SSL_get_error(m_pSslConnection, iWritenLen);
         switch (iErrCode)
@@ -860,13 +969,24 @@ int SocketChannelSslImpl::Write(CBuffer* pBuff, int& iErrno)
                 LOG4_ERROR("SSL_write() error code %d, see SSL_get_error() manual for error code detail.", iErrCode);
                 ;
         }
+        return(iWritenLen);
     }
-    return(iWritenLen);
+    return(iHadWriteLen);
 }
 
 int SocketChannelSslImpl::Read(CBuffer* pBuff, int& iErrno)
 {
     LOG4_TRACE("");
+    if (m_bKtlsRecv && SSL_pending(m_pSslConnection) == 0)
+    {
+        // 内核解密，直接读出明文；下一个记录不是应用数据（alert、握手消息等）时
+        // 内核返回EIO且不取走该记录，交给SSL_read()处理
+        int iReadLen = pBuff->ReadFD(GetFd(), iErrno);
+        if (iReadLen >= 0 || EIO != iErrno)
+        {
+            return(iReadLen);
+        }
+    }
     if (pBuff->WriteableBytes() < 1024)
     {
         pBuff->EnsureWritableBytes(8192);
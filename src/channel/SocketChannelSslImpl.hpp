@@ -31,6 +31,7 @@
 #include <openssl/x509v3.h>
 
 #include "SocketChannelImpl.hpp"
+#include "SslResumption.hpp"
 
 namespace neb 
 {
@@ -56,6 +57,24 @@ public:
     static int SslServerCtxCreate(std::shared_ptr<NetLogger> pLogger);
     static int SslServerCertificate(std::shared_ptr<NetLogger> pLogger,
                 const std::string& strCertFile, const std::string& strKeyFile);
+    /**
+     * @brief 开启服务端会话复用（session ticket及共享会话缓存，见SslResumption）
+     * @param bTicket 是否签发session ticket
+     * @param lTimeout 会话有效期（秒）
+     */
+    static void SslServerSessionResumption(bool bTicket, long lTimeout);
+    /**
+     * @brief 开启内核TLS（kTLS）
+     * @note 握手仍由OpenSSL完成，握手后OpenSSL把密钥交给内核（SSL_OP_ENABLE_KTLS），
+     * 之后应用数据的加解密在内核中完成。开启前先探测内核是否有tls模块，没有时不开启，
+     * 也不关闭read_ahead；协商到的加密套件内核不支持时连接照常走SSL_read()/SSL_write()。
+     */
+    static void SslEnableKtls(std::shared_ptr<NetLogger> pLogger);
+    /**
+     * @brief 在一个新建的TCP socket上设置TCP_ULP为"tls"，探测内核是否支持kTLS
+     * @param[out] iErrno 不支持时的错误码
+     */
+    static bool KtlsProbe(int& iErrno);
     static void SslFree();
 
     int SslClientCtxCreate();
@@ -67,22 +86,27 @@ public:
     virtual E_CODEC_STATUS Send() override;      ///< 覆盖基类的Send()方法，实现非阻塞socket连接建立后继续建立SSL连接
     virtual E_CODEC_STATUS Send(int32 iCmd, uint32 uiSeq, const MsgBody& oMsgBody) override;
     virtual E_CODEC_STATUS Send(const HttpMsg& oHttpMsg, uint32 ulStepSeq) override;
+    virtual E_CODEC_STATUS Send(EncodedFrame& oFrame) override;
     virtual E_CODEC_STATUS Recv(MsgHead& oMsgHead, MsgBody& oMsgBody) override;
     virtual E_CODEC_STATUS Recv(HttpMsg& oHttpMsg) override;
     //virtual E_CODEC_STATUS Recv(MsgHead& oMsgHead, MsgBody& oMsgBody, HttpMsg& oHttpMsg) override;
     virtual bool Close() override;
 
 protected:
-    virtual int Write(CBuffer* pBuff, int& iErrno) override;
+    virtual int Write(SendQueue* pBuff, int& iErrno) override;
     virtual int Read(CBuffer* pBuff, int& iErrno) override;
 
 private: 
     E_SSL_CHANNEL_STATUS m_eSslChannelStatus;
     bool m_bIsClientConnection;
     SSL* m_pSslConnection;
+    uint64 m_ullHandshakeCpuNs;         ///< 握手已耗费的CPU时间（纳秒），握手跨多次可读可写事件完成
+    bool m_bKtlsSend;                   ///< 发送方向已由内核加密
+    bool m_bKtlsRecv;                   ///< 接收方向已由内核解密
 
     static SSL_CTX* s_pServerSslCtx;
     static SSL_CTX* s_pClientSslCtx;
+    static bool s_bKtls;
 };
 
 }
@@ -0,0 +1,350 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     SslResumption.cpp
+ * @brief    TLS会话复用
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note
+ * Modify history:
+ ******************************************************************************/
+
+#ifdef WITH_OPENSSL
+#include "SslResumption.hpp"
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <openssl/rand.h>
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#include <openssl/core_names.h>
+#include <openssl/params.h>
+#endif
+
+namespace neb
+{
+
+const size_t SslResumption::sc_uiTicketKeyLen;
+const size_t SslResumption::sc_uiMaxSessionSize;
+const uint32 SslResumption::sc_uiCacheWays;
+
+std::mutex SslResumption::s_mutexTicketKey;
+std::vector<SslResumption::tagTicketKey> SslResumption::s_vecTicketKey;
+SslResumption::tagCacheHead* SslResumption::s_pCacheHead = nullptr;
+SslResumption::tagCacheEntry* SslResumption::s_pCacheEntry = nullptr;
+thread_local SslResumption::tagStat SslResumption::s_stStat;
+
+std::string SslResumption::MakeTicketKey()
+{
+    std::string strKey;
+    strKey.resize(sc_uiTicketKeyLen);
+    if (RAND_bytes((unsigned char*)&strKey[0], sc_uiTicketKeyLen) != 1)
+    {
+        strKey.clear();
+    }
+    return(strKey);
+}
+
+bool SslResumption::SetTicketKeys(const std::string& strKeys)
+{
+    static_assert(sizeof(tagTicketKey) == sc_uiTicketKeyLen, "tagTicketKey must be packed");
+    if (strKeys.size() % sc_uiTicketKeyLen != 0)
+    {
+        return(false);
+    }
+    std::vector<tagTicketKey> vecTicketKey(strKeys.size() / sc_uiTicketKeyLen);
+    if (!vecTicketKey.empty())
+    {
+        memcpy(&vecTicketKey[0], strKeys.data(), strKeys.size());
+    }
+    std::lock_guard<std::mutex> oLock(s_mutexTicketKey);
+    s_vecTicketKey.swap(vecTicketKey);
+    return(true);
+}
+
+std::string SslResumption::GetTicketKeys()
+{
+    std::lock_guard<std::mutex> oLock(s_mutexTicketKey);
+    if (s_vecTicketKey.empty())
+    {
+        return("");
+    }
+    return(std::string((const char*)&s_vecTicketKey[0], s_vecTicketKey.size() * sc_uiTicketKeyLen));
+}
+
+bool SslResumption::CreateSharedCache(uint32 uiEntryNum)
+{
+    if (uiEntryNum == 0 || s_pCacheHead != nullptr)
+    {
+        return(true);
+    }
+    uint32 uiSetNum = (uiEntryNum + sc_uiCacheWays - 1) / sc_uiCacheWays;
+    size_t uiSize = sizeof(tagCacheHead) + (size_t)uiSetNum * sc_uiCacheWays * sizeof(tagCacheEntry);
+    // 匿名共享内存随进程退出释放，fork出的Worker进程共用同一块
+    void* pShm = mmap(NULL, uiSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (pShm == MAP_FAILED)
+    {
+        return(false);
+    }
+    tagCacheHead* pHead = (tagCacheHead*)pShm;
+    pthread_mutexattr_t stAttr;
+    pthread_mutexattr_init(&stAttr);
+    pthread_mutexattr_setpshared(&stAttr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&stAttr, PTHREAD_MUTEX_ROBUST);   // 持锁的Worker崩溃后其他Worker仍可加锁
+    int iResult = pthread_mutex_init(&pHead->stMutex, &stAttr);
+    pthread_mutexattr_destroy(&stAttr);
+    if (iResult != 0)
+    {
+        munmap(pShm, uiSize);
+        return(false);
+    }
+    pHead->uiSetNum = uiSetNum;
+    s_pCacheHead = pHead;
+    s_pCacheEntry = (tagCacheEntry*)((char*)pShm + sizeof(tagCacheHead));
+    return(true);
+}
+
+void SslResumption::Setup(SSL_CTX* pCtx, bool bTicket, long lTimeout)
+{
+    // 会话须绑定上下文，否则开启客户端证书校验时会话不能复用
+    static const unsigned char s_aucSessionIdContext[] = "nebula";
+    SSL_CTX_set_session_id_context(pCtx, s_aucSessionIdContext, sizeof(s_aucSessionIdContext) - 1);
+    SSL_CTX_set_timeout(pCtx, lTimeout);
+    if (bTicket)
+    {
+        SSL_CTX_clear_options(pCtx, SSL_OP_NO_TICKET);
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+        SSL_CTX_set_tlsext_ticket_key_evp_cb(pCtx, TicketKeyCallback);
+#else
+        SSL_CTX_set_tlsext_ticket_key_cb(pCtx, TicketKeyCallback);
+#endif
+    }
+    else
+    {
+        SSL_CTX_set_options(pCtx, SSL_OP_NO_TICKET);
+    }
+    if (s_pCacheHead != nullptr)
+    {
+        // 只用共享缓存，进程内缓存既不能跨Worker命中，又会多占一份内存
+        SSL_CTX_set_session_cache_mode(pCtx, SSL_SESS_CACHE_SERVER | SSL_SESS_CACHE_NO_INTERNAL);
+        SSL_CTX_sess_set_new_cb(pCtx, NewSessionCallback);
+        SSL_CTX_sess_set_get_cb(pCtx, GetSessionCallback);
+        SSL_CTX_sess_set_remove_cb(pCtx, RemoveSessionCallback);
+    }
+    else
+    {
+        SSL_CTX_set_session_cache_mode(pCtx, SSL_SESS_CACHE_SERVER);
+    }
+}
+
+void SslResumption::AddHandshake(bool bResumed, uint64 ullCpuUs)
+{
+    if (bResumed)
+    {
+        ++s_stStat.ullResumedHandshake;
+        s_stStat.ullResumedHandshakeCpuUs += ullCpuUs;
+    }
+    else
+    {
+        ++s_stStat.ullFullHandshake;
+        s_stStat.ullFullHandshakeCpuUs += ullCpuUs;
+    }
+}
+
+bool SslResumption::FindTicketKey(const unsigned char* pName, tagTicketKey& stKey, bool& bCurrent)
+{
+    std::lock_guard<std::mutex> oLock(s_mutexTicketKey);
+    for (size_t i = 0; i < s_vecTicketKey.size(); ++i)
+    {
+        if (pName == nullptr || memcmp(pName, s_vecTicketKey[i].aucName, sizeof(stKey.aucName)) == 0)
+        {
+            stKey = s_vecTicketKey[i];
+            bCurrent = (i == 0);
+            return(true);
+        }
+    }
+    return(false);
+}
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+int SslResumption::TicketKeyCallback(SSL* pSsl, unsigned char* pName, unsigned char* pIv,
+        EVP_CIPHER_CTX* pCipherCtx, EVP_MAC_CTX* pMacCtx, int iEncrypt)
+#else
+int SslResumption::TicketKeyCallback(SSL* pSsl, unsigned char* pName, unsigned char* pIv,
+        EVP_CIPHER_CTX* pCipherCtx, HMAC_CTX* pHmacCtx, int iEncrypt)
+#endif
+{
+    tagTicketKey stKey;
+    bool bCurrent = false;
+    // 加密取当前密钥，解密按ticket中的密钥名查找；找不到时不签发ticket或退回完整握手
+    if (!FindTicketKey(iEncrypt ? nullptr : pName, stKey, bCurrent))
+    {
+        return(0);
+    }
+    if (iEncrypt)
+    {
+        if (RAND_bytes(pIv, EVP_CIPHER_iv_length(EVP_aes_256_cbc())) != 1
+                || EVP_EncryptInit_ex(pCipherCtx, EVP_aes_256_cbc(), NULL, stKey.aucAesKey, pIv) != 1)
+        {
+            return(-1);
+        }
+        memcpy(pName, stKey.aucName, sizeof(stKey.aucName));
+    }
+    else if (EVP_DecryptInit_ex(pCipherCtx, EVP_aes_256_cbc(), NULL, stKey.aucAesKey, pIv) != 1)
+    {
+        return(-1);
+    }
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    OSSL_PARAM astParam[3];
+    astParam[0] = OSSL_PARAM_construct_octet_string(OSSL_MAC_PARAM_KEY,
+            stKey.aucHmacKey, sizeof(stKey.aucHmacKey));
+    astParam[1] = OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, (char*)"SHA256", 0);
+    astParam[2] = OSSL_PARAM_construct_end();
+    if (EVP_MAC_CTX_set_params(pMacCtx, astParam) != 1)
+    {
+        return(-1);
+    }
+#else
+    if (HMAC_Init_ex(pHmacCtx, stKey.aucHmacKey, sizeof(stKey.aucHmacKey), EVP_sha256(), NULL) != 1)
+    {
+        return(-1);
+    }
+#endif
+    // 上一个密钥签发的ticket解密成功后返回2，由OpenSSL以当前密钥换发新ticket
+    return((iEncrypt || bCurrent) ? 1 : 2);
+}
+
+int SslResumption::NewSessionCallback(SSL* pSsl, SSL_SESSION* pSession)
+{
+    // TLS 1.3签发ticket时也会回调，会话全在ticket中，无须缓存
+    if (SSL_version(pSsl) >= TLS1_3_VERSION && !(SSL_get_options(pSsl) & SSL_OP_NO_TICKET))
+    {
+        return(0);
+    }
+    unsigned int uiIdLen = 0;
+    const unsigned char* pId = SSL_SESSION_get_id(pSession, &uiIdLen);
+    int iDataLen = i2d_SSL_SESSION(pSession, NULL);
+    if (uiIdLen == 0 || uiIdLen > SSL_MAX_SSL_SESSION_ID_LENGTH
+            || iDataLen <= 0 || iDataLen > (int)sc_uiMaxSessionSize)
+    {
+        return(0);
+    }
+    unsigned char aucData[sc_uiMaxSessionSize];
+    unsigned char* pData = aucData;
+    i2d_SSL_SESSION(pSession, &pData);
+    int64 llNow = time(NULL);
+    int64 llExpireTime = (int64)SSL_SESSION_get_time(pSession) + SSL_SESSION_get_timeout(pSession);
+    if (!LockCache())
+    {
+        return(0);
+    }
+    // 同一会话覆盖原槽位，否则优先取空闲或过期的槽位，都没有时淘汰最早过期的
+    tagCacheEntry* pSet = CacheSet(pId, uiIdLen);
+    tagCacheEntry* pEntry = &pSet[0];
+    for (uint32 i = 0; i < sc_uiCacheWays; ++i)
+    {
+        if (pSet[i].llExpireTime > 0 && pSet[i].uiIdLen == uiIdLen && memcmp(pSet[i].aucId, pId, uiIdLen) == 0)
+        {
+            pEntry = &pSet[i];
+            break;
+        }
+        if (pSet[i].llExpireTime <= llNow)
+        {
+            pEntry = &pSet[i];
+        }
+        else if (pEntry->llExpireTime > llNow && pSet[i].llExpireTime < pEntry->llExpireTime)
+        {
+            pEntry = &pSet[i];
+        }
+    }
+    pEntry->llExpireTime = llExpireTime;
+    pEntry->uiIdLen = uiIdLen;
+    pEntry->uiDataLen = iDataLen;
+    memcpy(pEntry->aucId, pId, uiIdLen);
+    memcpy(pEntry->aucData, aucData, iDataLen);
+    UnlockCache();
+    return(0);      // 未持有pSession的引用
+}
+
+SSL_SESSION* SslResumption::GetSessionCallback(SSL* pSsl, const unsigned char* pId, int iIdLen, int* pCopy)
+{
+    *pCopy = 0;
+    if (iIdLen <= 0 || iIdLen > SSL_MAX_SSL_SESSION_ID_LENGTH)
+    {
+        return(nullptr);
+    }
+    unsigned char aucData[sc_uiMaxSessionSize];
+    uint32 uiDataLen = 0;
+    int64 llNow = time(NULL);
+    if (!LockCache())
+    {
+        return(nullptr);
+    }
+    tagCacheEntry* pSet = CacheSet(pId, iIdLen);
+    for (uint32 i = 0; i < sc_uiCacheWays; ++i)
+    {
+        if (pSet[i].llExpireTime > llNow && pSet[i].uiIdLen == (uint32)iIdLen
+                && memcmp(pSet[i].aucId, pId, iIdLen) == 0)
+        {
+            uiDataLen = pSet[i].uiDataLen;
+            memcpy(aucData, pSet[i].aucData, uiDataLen);
+            break;
+        }
+    }
+    UnlockCache();
+    if (uiDataLen == 0)
+    {
+        return(nullptr);
+    }
+    const unsigned char* pData = aucData;
+    return(d2i_SSL_SESSION(NULL, &pData, uiDataLen));
+}
+
+void SslResumption::RemoveSessionCallback(SSL_CTX* pCtx, SSL_SESSION* pSession)
+{
+    unsigned int uiIdLen = 0;
+    const unsigned char* pId = SSL_SESSION_get_id(pSession, &uiIdLen);
+    if (uiIdLen == 0 || uiIdLen > SSL_MAX_SSL_SESSION_ID_LENGTH || !LockCache())
+    {
+        return;
+    }
+    tagCacheEntry* pSet = CacheSet(pId, uiIdLen);
+    for (uint32 i = 0; i < sc_uiCacheWays; ++i)
+    {
+        if (pSet[i].uiIdLen == uiIdLen && memcmp(pSet[i].aucId, pId, uiIdLen) == 0)
+        {
+            pSet[i].llExpireTime = 0;
+        }
+    }
+    UnlockCache();
+}
+
+bool SslResumption::LockCache()
+{
+    int iResult = pthread_mutex_lock(&s_pCacheHead->stMutex);
+    if (iResult == EOWNERDEAD)
+    {
+        // 前一个持锁者写到一半的槽位最多解析失败，按未命中处理即可
+        pthread_mutex_consistent(&s_pCacheHead->stMutex);
+        return(true);
+    }
+    return(iResult == 0);
+}
+
+void SslResumption::UnlockCache()
+{
+    pthread_mutex_unlock(&s_pCacheHead->stMutex);
+}
+
+SslResumption::tagCacheEntry* SslResumption::CacheSet(const unsigned char* pId, uint32 uiIdLen)
+{
+    uint32 uiHash = 2166136261u;     // FNV-1a
+    for (uint32 i = 0; i < uiIdLen; ++i)
+    {
+        uiHash = (uiHash ^ pId[i]) * 16777619u;
+    }
+    return(&s_pCacheEntry[(size_t)(uiHash % s_pCacheHead->uiSetNum) * sc_uiCacheWays]);
+}
+
+} /* namespace neb */
+
+#endif  // ifdef WITH_OPENSSL
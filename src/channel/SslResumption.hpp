@@ -0,0 +1,147 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     SslResumption.hpp
+ * @brief    TLS会话复用
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note     客户端连接按轮询或SO_REUSEPORT分散到各Worker，每个Worker各自的SSL_CTX
+ * 生成的session ticket和会话缓存其他Worker都不认识，重连的客户端几乎总是要做完整握手。
+ * 这里让所有Worker共用：
+ * 1. session ticket密钥（TLS 1.3及支持ticket的TLS 1.2客户端）：由Manager生成并定期
+ *    轮换，通过CMD_REQ_SET_SSL_TICKET_KEY下发给Worker。Worker保留当前密钥和上一个密钥，
+ *    当前密钥加密新ticket，上一个密钥签发的ticket仍可解密并会换发新ticket。Worker进程
+ *    由Manager fork，重启的Worker直接继承Manager当前的密钥。
+ * 2. 可选的共享内存会话缓存（不支持ticket的TLS 1.2客户端）：Manager在fork Worker之前
+ *    创建匿名共享内存，会话以DER格式存放在组相联的定长槽位中，进程间以robust互斥锁保护。
+ * 握手次数和握手CPU时间按完整握手、复用握手分别统计，由Dispatcher随数据上报。
+ * Modify history:
+ ******************************************************************************/
+#ifndef SRC_CHANNEL_SSLRESUMPTION_HPP_
+#define SRC_CHANNEL_SSLRESUMPTION_HPP_
+
+#ifdef WITH_OPENSSL
+#include <pthread.h>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <openssl/ssl.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include "Definition.hpp"
+
+namespace neb
+{
+
+class SslResumption
+{
+public:
+    struct tagStat
+    {
+        uint64 ullFullHandshake = 0;
+        uint64 ullResumedHandshake = 0;
+        uint64 ullFullHandshakeCpuUs = 0;       ///< 完整握手耗费的CPU时间（微秒）
+        uint64 ullResumedHandshakeCpuUs = 0;    ///< 复用握手耗费的CPU时间（微秒）
+    };
+
+    /**
+     * @brief 生成一个随机的ticket密钥（sc_uiTicketKeyLen字节：名字、HMAC密钥、AES密钥）
+     * @return 失败返回空串
+     */
+    static std::string MakeTicketKey();
+
+    /**
+     * @brief 设置ticket密钥
+     * @param strKeys 若干个密钥首尾相连，第一个为当前密钥（加密新ticket），其余只用于解密
+     * @return 长度不是sc_uiTicketKeyLen的整数倍时返回false
+     */
+    static bool SetTicketKeys(const std::string& strKeys);
+
+    static std::string GetTicketKeys();
+
+    /**
+     * @brief 创建共享内存会话缓存，须在fork Worker之前调用
+     * @param uiEntryNum 缓存的会话数上限，0表示不创建
+     */
+    static bool CreateSharedCache(uint32 uiEntryNum);
+
+    /**
+     * @brief 在服务端SSL_CTX上开启会话复用
+     * @param bTicket 是否签发session ticket
+     * @param lTimeout 会话（及ticket）有效期（秒）
+     */
+    static void Setup(SSL_CTX* pCtx, bool bTicket, long lTimeout);
+
+    /**
+     * @brief 握手完成，计入统计
+     * @param ullCpuUs 该连接握手耗费的CPU时间（微秒）
+     */
+    static void AddHandshake(bool bResumed, uint64 ullCpuUs);
+
+    /**
+     * @brief 本线程的握手统计（每个Worker一份）
+     */
+    static const tagStat& GetStat()
+    {
+        return(s_stStat);
+    }
+
+    static void ResetStat()
+    {
+        s_stStat = tagStat();
+    }
+
+    static const size_t sc_uiTicketKeyLen = 80;
+    static const size_t sc_uiMaxSessionSize = 1024;     ///< 共享缓存中单个会话DER的长度上限，超过的不缓存
+    static const uint32 sc_uiCacheWays = 4;             ///< 共享缓存每组的槽位数
+
+private:
+    struct tagTicketKey
+    {
+        unsigned char aucName[16];
+        unsigned char aucHmacKey[32];
+        unsigned char aucAesKey[32];
+    };
+
+    struct tagCacheEntry
+    {
+        int64 llExpireTime;                             ///< 为0表示空闲槽位
+        uint32 uiIdLen;
+        uint32 uiDataLen;
+        unsigned char aucId[SSL_MAX_SSL_SESSION_ID_LENGTH];
+        unsigned char aucData[sc_uiMaxSessionSize];
+    };
+
+    struct tagCacheHead
+    {
+        pthread_mutex_t stMutex;
+        uint32 uiSetNum;
+    };
+
+    static bool FindTicketKey(const unsigned char* pName, tagTicketKey& stKey, bool& bCurrent);
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    static int TicketKeyCallback(SSL* pSsl, unsigned char* pName, unsigned char* pIv,
+            EVP_CIPHER_CTX* pCipherCtx, EVP_MAC_CTX* pMacCtx, int iEncrypt);
+#else
+    static int TicketKeyCallback(SSL* pSsl, unsigned char* pName, unsigned char* pIv,
+            EVP_CIPHER_CTX* pCipherCtx, HMAC_CTX* pHmacCtx, int iEncrypt);
+#endif
+    static int NewSessionCallback(SSL* pSsl, SSL_SESSION* pSession);
+    static SSL_SESSION* GetSessionCallback(SSL* pSsl, const unsigned char* pId, int iIdLen, int* pCopy);
+    static void RemoveSessionCallback(SSL_CTX* pCtx, SSL_SESSION* pSession);
+
+    static bool LockCache();
+    static void UnlockCache();
+    static tagCacheEntry* CacheSet(const unsigned char* pId, uint32 uiIdLen);
+
+private:
+    static std::mutex s_mutexTicketKey;                 ///< 线程模式下Manager和各Worker线程共用密钥
+    static std::vector<tagTicketKey> s_vecTicketKey;
+    static tagCacheHead* s_pCacheHead;                  ///< 共享内存，fork后各Worker进程共用
+    static tagCacheEntry* s_pCacheEntry;
+    static thread_local tagStat s_stStat;
+};
+
+} /* namespace neb */
+
+#endif  // ifdef WITH_OPENSSL
+#endif  // SRC_CHANNEL_SSLRESUMPTION_HPP_
@@ -41,6 +41,43 @@ void Codec::AddAutoSwitchCodecType(E_CODEC_TYPE eCodecType)
     m_vecAutoSwitchCodecType.push_back(eCodecType);
 }
 
+int Codec::GetBodySize(const MsgBody& oMsgBody)
+{
+    return((int)oMsgBody.ByteSizeLong());
+}
+
+int Codec::SerializeWithCachedSize(const google::protobuf::MessageLite& oMessage, int iByteSize, CBuffer* pBuff)
+{
+    if (iByteSize <= 0)
+    {
+        return(0);
+    }
+    if (!pBuff->EnsureWritableBytes(iByteSize))
+    {
+        return(-1);
+    }
+    uint8* pStart = (uint8*)pBuff->GetRawWriteBuffer();
+    uint8* pEnd = oMessage.SerializeWithCachedSizesToArray(pStart);
+    if (pEnd - pStart != iByteSize)
+    {
+        return(-1);
+    }
+    pBuff->AdvanceWriteIndex(iByteSize);
+    return(iByteSize);
+}
+
+bool Codec::SerializeWithCachedSize(const google::protobuf::MessageLite& oMessage, int iByteSize, std::string& strDest)
+{
+    strDest.resize(iByteSize);
+    if (iByteSize <= 0)
+    {
+        return(true);
+    }
+    uint8* pStart = (uint8*)&strDest[0];
+    uint8* pEnd = oMessage.SerializeWithCachedSizesToArray(pStart);
+    return(pEnd - pStart == iByteSize);
+}
+
 bool Codec::Zip(const std::string& strSrc, std::string& strDest)
 {
     /*
@@ -17,6 +17,7 @@
 #include <vector>
 #include <actor/cmd/CW.hpp>
 #include "util/CBuffer.hpp"
+#include "util/MemoryPool.hpp"
 #include "pb/msg.pb.h"
 #include "Error.hpp"
 #include "Definition.hpp"
@@ -72,6 +73,19 @@ public:
     Codec(std::shared_ptr<NetLogger> pLogger, E_CODEC_TYPE eCodecType);
     virtual ~Codec();
 
+    /**
+     * @brief 编解码器随连接创建和销毁，从回收池分配（各派生类按实际大小分级回收）
+     */
+    static void* operator new(size_t uiSize)
+    {
+        return(MemoryPool::Allocate(uiSize));
+    }
+
+    static void operator delete(void* pCodec, size_t uiSize)
+    {
+        MemoryPool::Deallocate(pCodec, uiSize);
+    }
+
     E_CODEC_TYPE GetCodecType() const
     {
         return(m_eCodecType);
@@ -79,6 +93,8 @@ public:
 
     /**
      * @brief 字节流编码
+     * @note 编码器在编码时计算一次oMsgBody的序列化长度，按此长度预留空间并直接序列化，
+     * 不依赖调用方此前计算并缓存的长度。
      * @param[in] oMsgHead  消息包头
      * @param[in] oMsgBody  消息包体
      * @param[out] pBuff  数据缓冲区
@@ -109,6 +125,7 @@ public:
     static void AddAutoSwitchCodecType(E_CODEC_TYPE eCodecType);
 
     template <typename ...Targs> void Logger(int iLogLevel, const char* szFileName, unsigned int uiFileLine, const char* szFunction, Targs&&... args);
+    bool IsLogLevelEnabled(int iLogLevel) const;
 
     inline void SetErrno(int32 iErrno)
     {
@@ -120,6 +137,28 @@ protected:
         return(m_strKey);
     }
 
+    /**
+     * @brief 计算消息体序列化长度
+     * @note 以ByteSizeLong()计算并缓存长度，每次编码调用一次，之后按返回值调用
+     * SerializeWithCachedSize()，期间不能修改oMsgBody。调用方此前缓存的长度可能已因
+     * 修改消息而失效，不能代替这次计算。
+     */
+    static int GetBodySize(const MsgBody& oMsgBody);
+
+    /**
+     * @brief 按已缓存的长度将pb消息直接序列化到缓冲区（不经过临时string）
+     * @param[in] oMessage pb消息
+     * @param[in] iByteSize 本次编码中ByteSizeLong()的结果
+     * @param[out] pBuff 数据缓冲区
+     * @return 写入字节数，失败返回-1
+     */
+    static int SerializeWithCachedSize(const google::protobuf::MessageLite& oMessage, int iByteSize, CBuffer* pBuff);
+
+    /**
+     * @brief 按已缓存的长度将pb消息序列化到string（用于压缩或加密前的明文）
+     */
+    static bool SerializeWithCachedSize(const google::protobuf::MessageLite& oMessage, int iByteSize, std::string& strDest);
+
     bool Zip(const std::string& strSrc, std::string& strDest);
     bool Unzip(const std::string& strSrc, std::string& strDest);
     bool Gzip(const std::string& strSrc, std::string& strDest);
@@ -147,6 +186,11 @@ void Codec::Logger(int iLogLevel, const char* szFileName, unsigned int uiFileLin
     m_pLogger->WriteLog(iLogLevel, szFileName, uiFileLine, szFunction, std::forward<Targs>(args)...);
 }
 
+inline bool Codec::IsLogLevelEnabled(int iLogLevel) const
+{
+    return(m_pLogger->IsLevelEnabled(iLogLevel));
+}
+
 } /* namespace neb */
 
 #endif /* SRC_CODEC_CODEC_HPP_ */
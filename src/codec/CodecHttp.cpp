@@ -8,6 +8,10 @@
  * Modify history:
  ******************************************************************************/
 #include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <strings.h>
+#include <vector>
 #include "util/StringCoder.hpp"
 #include "logger/NetLogger.hpp"
 #include "CodecHttp.hpp"
@@ -78,6 +82,14 @@ static const char * status_string(int code)
 namespace neb
 {
 
+const int32 CodecHttp::sc_iMinStatusCode;
+const int32 CodecHttp::sc_iMaxStatusCode;
+const std::string CodecHttp::sc_strConnection = "Connection";
+const std::string CodecHttp::sc_strServer = "Server";
+const std::string CodecHttp::sc_strAllow = "Allow";
+const std::string CodecHttp::sc_strEmptyHeaderBlock;
+std::string CodecHttp::s_strResponseHeaderBlock;
+
 CodecHttp::CodecHttp(std::shared_ptr<NetLogger> pLogger, E_CODEC_TYPE eCodecType, ev_tstamp dKeepAlive)
     : Codec(pLogger, eCodecType),
       m_bChannelIsClient(false), m_uiEncodedNum(0), m_uiDecodedNum(0),
@@ -145,6 +157,51 @@ E_CODEC_STATUS CodecHttp::Decode(CBuffer* pBuff, MsgHead& oMsgHead, MsgBody& oMs
     return(eCodecStatus);
 }
 
+template <typename F>
+void CodecHttp::ForEachHeader(const HttpMsg& oHttpMsg, bool bIsResponse, F&& fnVisit) const
+{
+    // 优先级：AddHttpHeader()添加的头 > 框架的响应头 > 消息中的头，同名只取优先级最高的一个
+    for (auto h_iter = m_mapAddingHttpHeader.begin(); h_iter != m_mapAddingHttpHeader.end(); ++h_iter)
+    {
+        fnVisit(h_iter->first, h_iter->second.data(), h_iter->second.size());
+    }
+    if (bIsResponse)
+    {
+        if (!m_bChannelIsClient && !HasAddingHeader(sc_strConnection))
+        {
+            if (m_dKeepAlive == 0)
+            {
+                fnVisit(sc_strConnection, "close", 5);
+            }
+            else
+            {
+                fnVisit(sc_strConnection, "keep-alive", 10);
+            }
+        }
+        if (!HasAddingHeader(sc_strServer))
+        {
+            fnVisit(sc_strServer, "NebulaHttp", 10);
+        }
+        if (!HasAddingHeader(sc_strAllow))
+        {
+            fnVisit(sc_strAllow, "POST,GET", 8);
+        }
+    }
+    for (auto h_iter = oHttpMsg.headers().begin(); h_iter != oHttpMsg.headers().end(); ++h_iter)
+    {
+        if (h_iter->first == "Content-Length" || h_iter->first == "Host" || HasAddingHeader(h_iter->first))
+        {
+            continue;
+        }
+        if (bIsResponse && ((!m_bChannelIsClient && h_iter->first == sc_strConnection)
+                || h_iter->first == sc_strServer || h_iter->first == sc_strAllow))
+        {
+            continue;
+        }
+        fnVisit(h_iter->first, h_iter->second.data(), h_iter->second.size());
+    }
+}
+
 E_CODEC_STATUS CodecHttp::Encode(const HttpMsg& oHttpMsg, CBuffer* pBuff)
 {
     LOG4_TRACE("pBuff->ReadableBytes() = %u, ReadIndex = %u, WriteIndex = %u",
@@ -154,391 +211,305 @@ E_CODEC_STATUS CodecHttp::Encode(const HttpMsg& oHttpMsg, CBuffer* pBuff)
     {
         m_bChannelIsClient = true;
     }
+    E_CODEC_STATUS eCodecStatus = EncodeHttp(oHttpMsg, pBuff);
+    if (!m_mapAddingHttpHeader.empty())
+    {
+        m_mapAddingHttpHeader.clear();
+    }
+    return(eCodecStatus);
+}
+
+E_CODEC_STATUS CodecHttp::EncodeHttp(const HttpMsg& oHttpMsg, CBuffer* pBuff)
+{
     if (0 == oHttpMsg.http_major())
     {
         LOG4_WARNING("miss http version!");
-        m_mapAddingHttpHeader.clear();
         return(CODEC_STATUS_ERR);
     }
 
-    int iWriteSize = 0;
-    int iHadEncodedSize = 0;
+    // 先确定各部分及总长度，一次预留后直接写入，中途不会失败，无需回退写位置
+    const bool bIsResponse = (HTTP_RESPONSE == oHttpMsg.type());
+    const std::string& strUrl = oHttpMsg.url();
+    struct http_parser_url stUrl;
+    const char* szMethod = "";
+    size_t uiMethodLen = 0;
+    size_t uiPathOffset = 0;
+    int iPort = 0;
+    const char* pStatusLine = nullptr;
+    size_t uiStatusLineLen = 0;
+    size_t uiHeadLen = 0;
     if (HTTP_REQUEST == oHttpMsg.type())
     {
-        if (oHttpMsg.url().size() == 0)
+        if (strUrl.size() == 0)
         {
             LOG4_WARNING("miss url!");
-            m_mapAddingHttpHeader.clear();
             return(CODEC_STATUS_ERR);
         }
-        int iPort = 0;
-        std::string strHost;
-        std::string strPath;
-        struct http_parser_url stUrl;
-        if(0 == http_parser_parse_url(oHttpMsg.url().c_str(), oHttpMsg.url().length(), 0, &stUrl))
-        {
-            if(stUrl.field_set & (1 << UF_PORT))
-            {
-                iPort = stUrl.port;
-            }
-            else
-            {
-                iPort = 80;
-            }
-
-            if(stUrl.field_set & (1 << UF_HOST) )
-            {
-                strHost = oHttpMsg.url().substr(stUrl.field_data[UF_HOST].off, stUrl.field_data[UF_HOST].len);
-            }
-
-            if(stUrl.field_set & (1 << UF_PATH))
-            {
-                strPath = oHttpMsg.url().substr(stUrl.field_data[UF_PATH].off, stUrl.field_data[UF_PATH].len);
-            }
-
-            if (iPort == 80)
-            {
-                std::string strSchema = oHttpMsg.url().substr(0, oHttpMsg.url().find_first_of(':'));
-                std::transform(strSchema.begin(), strSchema.end(), strSchema.begin(), [](unsigned char c) -> unsigned char { return std::tolower(c); });
-                if (strSchema == std::string("https"))
-                {
-                    iPort = 443;
-                }
-            }
-        }
-        else
+        if (0 != http_parser_parse_url(strUrl.c_str(), strUrl.length(), 0, &stUrl))
         {
             LOG4_WARNING("http_parser_parse_url error!");
-            m_mapAddingHttpHeader.clear();
-            return(CODEC_STATUS_ERR);
-        }
-        if (stUrl.field_data[UF_PATH].off >= oHttpMsg.url().size())
-        {
-            LOG4_WARNING("invalid url \"%s\"!", oHttpMsg.url().c_str());
-            m_mapAddingHttpHeader.clear();
             return(CODEC_STATUS_ERR);
         }
-        iWriteSize = pBuff->Printf("%s %s HTTP/%u.%u\r\n", http_method_str((http_method)oHttpMsg.method()),
-                        oHttpMsg.url().substr(stUrl.field_data[UF_PATH].off, std::string::npos).c_str(),
-                        oHttpMsg.http_major(), oHttpMsg.http_minor());
-        if (iWriteSize < 0)
+        if (stUrl.field_data[UF_PATH].off >= strUrl.size())
         {
-            pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadEncodedSize);
-            m_mapAddingHttpHeader.clear();
+            LOG4_WARNING("invalid url \"%s\"!", strUrl.c_str());
             return(CODEC_STATUS_ERR);
         }
-        else
+        iPort = (stUrl.field_set & (1 << UF_PORT)) ? stUrl.port : 80;
+        if (80 == iPort && (stUrl.field_set & (1 << UF_SCHEMA))
+                && 5 == stUrl.field_data[UF_SCHEMA].len
+                && 0 == strncasecmp(strUrl.data() + stUrl.field_data[UF_SCHEMA].off, "https", 5))
         {
-            iHadEncodedSize += iWriteSize;
+            iPort = 443;
         }
-        iWriteSize = pBuff->Printf("Host: %s:%d\r\n", strHost.c_str(), iPort);
-        if (iWriteSize < 0)
+        if (!(stUrl.field_set & (1 << UF_HOST)))
         {
-            pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadEncodedSize);
-            m_mapAddingHttpHeader.clear();
-            return(CODEC_STATUS_ERR);
-        }
-        else
-        {
-            iHadEncodedSize += iWriteSize;
+            stUrl.field_data[UF_HOST].off = 0;
+            stUrl.field_data[UF_HOST].len = 0;
         }
+        szMethod = http_method_str((http_method)oHttpMsg.method());
+        uiMethodLen = strlen(szMethod);
+        uiPathOffset = stUrl.field_data[UF_PATH].off;
+        // "<method> <path> HTTP/x.y\r\n" "Host: <host>:<port>\r\n"
+        uiHeadLen += uiMethodLen + 1 + (strUrl.size() - uiPathOffset) + 6
+            + DecimalDigits(oHttpMsg.http_major()) + 1 + DecimalDigits(oHttpMsg.http_minor()) + 2;
+        uiHeadLen += 6 + stUrl.field_data[UF_HOST].len + 1 + DecimalDigits(iPort) + 2;
     }
-    else if (HTTP_RESPONSE == oHttpMsg.type())
+    else if (bIsResponse)
     {
         if (0 == oHttpMsg.status_code())
         {
             LOG4_WARNING("miss status code!");
-            pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadEncodedSize);
-            m_mapAddingHttpHeader.clear();
-            return(CODEC_STATUS_ERR);
-        }
-        iWriteSize = pBuff->Printf("HTTP/%u.%u %u %s\r\n", m_iHttpMajor, m_iHttpMinor,
-                        oHttpMsg.status_code(), status_string(oHttpMsg.status_code()));
-        if (iWriteSize < 0)
-        {
-            pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadEncodedSize);
-            m_mapAddingHttpHeader.clear();
             return(CODEC_STATUS_ERR);
         }
-        else
-        {
-            iHadEncodedSize += iWriteSize;
-        }
-        if (!m_bChannelIsClient)
-        {
-            if (m_dKeepAlive == 0)
-            {
-                m_mapAddingHttpHeader.insert(std::pair<std::string, std::string>("Connection", "close"));
-            }
-            else
-            {
-                m_mapAddingHttpHeader.insert(std::pair<std::string, std::string>("Connection", "keep-alive"));
-            }
-        }
-        m_mapAddingHttpHeader.insert(std::make_pair("Server", "NebulaHttp"));
-        m_mapAddingHttpHeader.insert(std::make_pair("Allow", "POST,GET"));
-        //m_mapAddingHttpHeader.insert(std::make_pair("Content-Type", "application/json;charset=UTF-8"));
+        // "HTTP/x.y " + 状态行表中的"<code> <reason>\r\n"
+        GetStatusLine(oHttpMsg.status_code(), pStatusLine, uiStatusLineLen);
+        uiHeadLen += 5 + DecimalDigits(m_iHttpMajor) + 1 + DecimalDigits(m_iHttpMinor) + 1 + uiStatusLineLen;
     }
+
     bool bIsChunked = false;
     bool bIsGzip = false;   // 是否用gizp压缩传输包
-    for (auto h_iter = oHttpMsg.headers().begin(); h_iter != oHttpMsg.headers().end(); ++h_iter)
+    bool bHasDate = !bIsResponse;
+    ForEachHeader(oHttpMsg, bIsResponse,
+            [&uiHeadLen, &bIsChunked, &bIsGzip, &bHasDate](const std::string& strName, const char* pValue, size_t uiValueLen)
+            {
+                uiHeadLen += strName.size() + 2 + uiValueLen + 2;
+                if (strName == "Content-Encoding" && 4 == uiValueLen && 0 == memcmp(pValue, "gzip", 4))
+                {
+                    bIsGzip = true;
+                }
+                else if (strName == "Transfer-Encoding" && 7 == uiValueLen && 0 == memcmp(pValue, "chunked", 7))
+                {
+                    bIsChunked = true;
+                }
+                else if (strName == "Date")
+                {
+                    bHasDate = true;
+                }
+            });
+    size_t uiDateLen = 0;
+    const char* pDate = bHasDate ? "" : GetDateHeader(uiDateLen);
+    const std::string& strHeaderBlock = bIsResponse ? s_strResponseHeaderBlock : sc_strEmptyHeaderBlock;
+    uiHeadLen += uiDateLen + strHeaderBlock.size() + oHttpMsg.header_block().size();
+
+    const char* pBody = oHttpMsg.body().data();
+    size_t uiBodyLen = oHttpMsg.body().size();
+    std::string strGzipData;
+    if (bIsGzip && uiBodyLen > 0)
     {
-        if (h_iter->first == "Content-Length" || h_iter->first == "Host")
-        {
-            continue;
-        }
-        auto h_a_iter = m_mapAddingHttpHeader.find(h_iter->first);
-        if (h_a_iter == m_mapAddingHttpHeader.end())
+        if (!Gzip(oHttpMsg.body(), strGzipData))
         {
-            m_mapAddingHttpHeader.insert(std::make_pair(h_iter->first, h_iter->second));
+            LOG4_WARNING("gzip error!");
+            return(CODEC_STATUS_ERR);
         }
+        pBody = strGzipData.data();
+        uiBodyLen = strGzipData.size();
     }
-    for (auto h_iter = m_mapAddingHttpHeader.begin(); h_iter != m_mapAddingHttpHeader.end(); ++h_iter)
+
+    // 分块传输的后续分块（encoding > 0）只有分块数据，不再有起始行和头
+    bool bWithHead = !(bIsChunked && oHttpMsg.encoding() != 0);
+    size_t uiLength = bWithHead ? uiHeadLen : 0;
+    if (bIsChunked)
     {
-        iWriteSize = pBuff->Printf("%s: %s\r\n", h_iter->first.c_str(), h_iter->second.c_str());
-        if (iWriteSize < 0)
-        {
-            pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadEncodedSize);
-            m_mapAddingHttpHeader.clear();
-            return(CODEC_STATUS_ERR);
-        }
-        else
-        {
-            iHadEncodedSize += iWriteSize;
-        }
-        if (std::string("Content-Encoding") == h_iter->first && std::string("gzip") == h_iter->second)
-        {
-            bIsGzip = true;
-        }
-        if (std::string("Transfer-Encoding") == h_iter->first && std::string("chunked") == h_iter->second)
-        {
-            bIsChunked = true;
-        }
+        uiLength += bWithHead ? 2 : 0;                                      // "\r\n"
+        uiLength += (uiBodyLen > 0) ? (HexDigits(uiBodyLen) + 2 + uiBodyLen + 2) : 0;    // "<size>\r\n<data>\r\n"
+        uiLength += 5;                                                      // "0\r\n\r\n"
     }
-    if (oHttpMsg.body().size() > 0)
+    else
     {
-        std::string strGzipData;
-        if (bIsGzip)
-        {
-            if (!Gzip(oHttpMsg.body(), strGzipData))
-            {
-                LOG4_WARNING("gzip error!");
-                pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadEncodedSize);
-                m_mapAddingHttpHeader.clear();
-                return(CODEC_STATUS_ERR);
-            }
-        }
+        uiLength += 16 + DecimalDigits(uiBodyLen) + 4 + uiBodyLen;          // "Content-Length: <n>\r\n\r\n<data>"
+    }
+    if (!pBuff->EnsureWritableBytes(uiLength + 1))      // 多预留的1字节用于追踪日志的'\0'
+    {
+        LOG4_ERROR("failed to reserve %u bytes for http message!", uiLength);
+        return(CODEC_STATUS_ERR);
+    }
 
-        if (bIsChunked)     // Transfer-Encoding: chunked
+    char* pPos = pBuff->GetRawWriteBuffer();
+    if (bWithHead)
+    {
+        if (HTTP_REQUEST == oHttpMsg.type())
         {
-            if (oHttpMsg.encoding() == 0)
-            {
-                iWriteSize = pBuff->Printf("\r\n");
-                if (iWriteSize < 0)
-                {
-                    pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadEncodedSize);
-                    m_mapAddingHttpHeader.clear();
-                    return(CODEC_STATUS_ERR);
-                }
-                else
-                {
-                    iHadEncodedSize += iWriteSize;
-                }
-            }
-            else
-            {
-                pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadEncodedSize);
-                iHadEncodedSize = 0;
-            }
-            if (strGzipData.size() > 0)
-            {
-                iWriteSize = pBuff->Printf("%x\r\n", strGzipData.size());
-                if (iWriteSize < 0)
-                {
-                    pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadEncodedSize);
-                    m_mapAddingHttpHeader.clear();
-                    return(CODEC_STATUS_ERR);
-                }
-                else
-                {
-                    iHadEncodedSize += iWriteSize;
-                }
-                iWriteSize = pBuff->Write(strGzipData.c_str(), strGzipData.size());
-                if (iWriteSize < 0)
-                {
-                    pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadEncodedSize);
-                    m_mapAddingHttpHeader.clear();
-                    return(CODEC_STATUS_ERR);
-                }
-                else
-                {
-                    iHadEncodedSize += iWriteSize;
-                }
-                iWriteSize = pBuff->Printf("\r\n0\r\n\r\n");
-                if (iWriteSize < 0)
-                {
-                    pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadEncodedSize);
-                    m_mapAddingHttpHeader.clear();
-                    return(CODEC_STATUS_ERR);
-                }
-                else
-                {
-                    iHadEncodedSize += iWriteSize;
-                }
-            }
-            else
-            {
-                if (oHttpMsg.body().size() > 0)
-                {
-                    iWriteSize = pBuff->Printf("%x\r\n", oHttpMsg.body().size());
-                    if (iWriteSize < 0)
-                    {
-                        pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadEncodedSize);
-                        m_mapAddingHttpHeader.clear();
-                        return(CODEC_STATUS_ERR);
-                    }
-                    else
-                    {
-                        iHadEncodedSize += iWriteSize;
-                    }
-                    iWriteSize = pBuff->Write(oHttpMsg.body().c_str(), oHttpMsg.body().size());
-                    if (iWriteSize < 0)
-                    {
-                        pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadEncodedSize);
-                        m_mapAddingHttpHeader.clear();
-                        return(CODEC_STATUS_ERR);
-                    }
-                    else
-                    {
-                        iHadEncodedSize += iWriteSize;
-                    }
-                }
-                iWriteSize = pBuff->Printf("\r\n0\r\n\r\n");
-                if (iWriteSize < 0)
-                {
-                    pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadEncodedSize);
-                    m_mapAddingHttpHeader.clear();
-                    return(CODEC_STATUS_ERR);
-                }
-                else
-                {
-                    iHadEncodedSize += iWriteSize;
-                }
-            }
+            pPos = WriteData(pPos, szMethod, uiMethodLen);
+            *pPos++ = ' ';
+            pPos = WriteData(pPos, strUrl.data() + uiPathOffset, strUrl.size() - uiPathOffset);
+            pPos = WriteData(pPos, " HTTP/", 6);
+            pPos = WriteDecimal(pPos, oHttpMsg.http_major());
+            *pPos++ = '.';
+            pPos = WriteDecimal(pPos, oHttpMsg.http_minor());
+            pPos = WriteData(pPos, "\r\nHost: ", 8);
+            pPos = WriteData(pPos, strUrl.data() + stUrl.field_data[UF_HOST].off, stUrl.field_data[UF_HOST].len);
+            *pPos++ = ':';
+            pPos = WriteDecimal(pPos, iPort);
+            pPos = WriteData(pPos, "\r\n", 2);
         }
-        else    // Content-Length: %u
+        else if (bIsResponse)
         {
-            if (strGzipData.size() > 0)
-            {
-                iWriteSize = pBuff->Printf("Content-Length: %u\r\n\r\n", strGzipData.size());
-                if (iWriteSize < 0)
-                {
-                    pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadEncodedSize);
-                    m_mapAddingHttpHeader.clear();
-                    return(CODEC_STATUS_ERR);
-                }
-                else
-                {
-                    iHadEncodedSize += iWriteSize;
-                }
-                iWriteSize = pBuff->Write(strGzipData.c_str(), strGzipData.size());
-                if (iWriteSize < 0)
-                {
-                    pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadEncodedSize);
-                    m_mapAddingHttpHeader.clear();
-                    return(CODEC_STATUS_ERR);
-                }
-                else
-                {
-                    iHadEncodedSize += iWriteSize;
-                }
-            }
-            else
-            {
-                iWriteSize = pBuff->Printf("Content-Length: %u\r\n\r\n", oHttpMsg.body().size());
-                if (iWriteSize < 0)
-                {
-                    pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadEncodedSize);
-                    m_mapAddingHttpHeader.clear();
-                    return(CODEC_STATUS_ERR);
-                }
-                else
-                {
-                    iHadEncodedSize += iWriteSize;
-                }
-                iWriteSize = pBuff->Write(oHttpMsg.body().c_str(), oHttpMsg.body().size());
-                if (iWriteSize < 0)
-                {
-                    pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadEncodedSize);
-                    m_mapAddingHttpHeader.clear();
-                    return(CODEC_STATUS_ERR);
-                }
-                else
-                {
-                    iHadEncodedSize += iWriteSize;
-                }
-            }
+            pPos = WriteData(pPos, "HTTP/", 5);
+            pPos = WriteDecimal(pPos, m_iHttpMajor);
+            *pPos++ = '.';
+            pPos = WriteDecimal(pPos, m_iHttpMinor);
+            *pPos++ = ' ';
+            pPos = WriteData(pPos, pStatusLine, uiStatusLineLen);
         }
+        ForEachHeader(oHttpMsg, bIsResponse,
+                [&pPos](const std::string& strName, const char* pValue, size_t uiValueLen)
+                {
+                    pPos = WriteData(pPos, strName.data(), strName.size());
+                    pPos = WriteData(pPos, ": ", 2);
+                    pPos = WriteData(pPos, pValue, uiValueLen);
+                    pPos = WriteData(pPos, "\r\n", 2);
+                });
+        pPos = WriteData(pPos, pDate, uiDateLen);
+        pPos = WriteData(pPos, strHeaderBlock.data(), strHeaderBlock.size());
+        pPos = WriteData(pPos, oHttpMsg.header_block().data(), oHttpMsg.header_block().size());
     }
-    else
+    if (bIsChunked)
     {
-        if (bIsChunked)
+        if (bWithHead)
         {
-            if (oHttpMsg.encoding() == 0)
-            {
-                iWriteSize = pBuff->Printf("\r\n");
-                if (iWriteSize < 0)
-                {
-                    pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadEncodedSize);
-                    m_mapAddingHttpHeader.clear();
-                    return(CODEC_STATUS_ERR);
-                }
-                else
-                {
-                    iHadEncodedSize += iWriteSize;
-                }
-            }
-            else
-            {
-                pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadEncodedSize);
-            }
-            iWriteSize = pBuff->Printf("0\r\n\r\n");
-            if (iWriteSize < 0)
-            {
-                pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadEncodedSize);
-                m_mapAddingHttpHeader.clear();
-                return(CODEC_STATUS_ERR);
-            }
-            else
-            {
-                iHadEncodedSize += iWriteSize;
-            }
+            pPos = WriteData(pPos, "\r\n", 2);
         }
-        else
+        if (uiBodyLen > 0)
         {
-            iWriteSize = pBuff->Printf("Content-Length: 0\r\n\r\n");
-            if (iWriteSize < 0)
-            {
-                pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadEncodedSize);
-                m_mapAddingHttpHeader.clear();
-                return(CODEC_STATUS_ERR);
-            }
-            else
-            {
-                iHadEncodedSize += iWriteSize;
-            }
+            pPos = WriteHex(pPos, uiBodyLen);
+            pPos = WriteData(pPos, "\r\n", 2);
+            pPos = WriteData(pPos, pBody, uiBodyLen);
+            pPos = WriteData(pPos, "\r\n", 2);
         }
+        pPos = WriteData(pPos, "0\r\n\r\n", 5);
     }
-    iWriteSize = pBuff->WriteByte('\0');
-    size_t iWriteIndex = pBuff->GetWriteIndex();
+    else
+    {
+        pPos = WriteData(pPos, "Content-Length: ", 16);
+        pPos = WriteDecimal(pPos, uiBodyLen);
+        pPos = WriteData(pPos, "\r\n\r\n", 4);
+        pPos = WriteData(pPos, pBody, uiBodyLen);
+    }
+    *pPos = '\0';
+    pBuff->AdvanceWriteIndex(uiLength);
     LOG4_TRACE("%s", pBuff->GetRawReadBuffer());
-    pBuff->SetWriteIndex(iWriteIndex - iWriteSize);
-    LOG4_TRACE("pBuff->ReadableBytes() = %u, ReadIndex = %u, WriteIndex = %u, iHadEncodedSize = %d",
-                    pBuff->ReadableBytes(), pBuff->GetReadIndex(), pBuff->GetWriteIndex(), iHadEncodedSize);
-    m_mapAddingHttpHeader.clear();
+    LOG4_TRACE("pBuff->ReadableBytes() = %u, ReadIndex = %u, WriteIndex = %u, iHadEncodedSize = %u",
+                    pBuff->ReadableBytes(), pBuff->GetReadIndex(), pBuff->GetWriteIndex(), uiLength);
     return(CODEC_STATUS_OK);
 }
 
+void CodecHttp::GetStatusLine(int32 iStatusCode, const char*& pStatusLine, size_t& uiLength)
+{
+    static const std::vector<std::string> s_vecStatusLine = []()
+    {
+        std::vector<std::string> vecStatusLine(sc_iMaxStatusCode - sc_iMinStatusCode + 1);
+        for (int32 i = sc_iMinStatusCode; i <= sc_iMaxStatusCode; ++i)
+        {
+            const char* szReason = status_string(i);
+            vecStatusLine[i - sc_iMinStatusCode] = std::to_string(i) + " "
+                + ((nullptr == szReason) ? "" : szReason) + "\r\n";
+        }
+        return(vecStatusLine);
+    }();
+    thread_local std::string s_strOtherStatusLine;
+    if (iStatusCode >= sc_iMinStatusCode && iStatusCode <= sc_iMaxStatusCode)
+    {
+        const std::string& strStatusLine = s_vecStatusLine[iStatusCode - sc_iMinStatusCode];
+        pStatusLine = strStatusLine.data();
+        uiLength = strStatusLine.size();
+        return;
+    }
+    s_strOtherStatusLine = std::to_string((uint32)iStatusCode) + " \r\n";
+    pStatusLine = s_strOtherStatusLine.data();
+    uiLength = s_strOtherStatusLine.size();
+}
+
+const char* CodecHttp::GetDateHeader(size_t& uiLength)
+{
+    static const char* s_aWeekDay[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+    static const char* s_aMonth[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+        "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+    thread_local time_t s_lLastTime = 0;
+    thread_local char s_szDate[48] = {0};
+    thread_local size_t s_uiDateLen = 0;
+    time_t lNow = time(NULL);
+    if (lNow != s_lLastTime)
+    {
+        struct tm stTime;
+        gmtime_r(&lNow, &stTime);
+        int iLength = snprintf(s_szDate, sizeof(s_szDate), "Date: %s, %02d %s %04d %02d:%02d:%02d GMT\r\n",
+                s_aWeekDay[stTime.tm_wday], stTime.tm_mday, s_aMonth[stTime.tm_mon], stTime.tm_year + 1900,
+                stTime.tm_hour, stTime.tm_min, stTime.tm_sec);
+        s_uiDateLen = (iLength > 0 && iLength < (int)sizeof(s_szDate)) ? iLength : 0;
+        s_lLastTime = lNow;
+    }
+    uiLength = s_uiDateLen;
+    return(s_szDate);
+}
+
+uint32 CodecHttp::DecimalDigits(uint64 ullValue)
+{
+    uint32 uiDigits = 1;
+    while (ullValue >= 10)
+    {
+        ullValue /= 10;
+        ++uiDigits;
+    }
+    return(uiDigits);
+}
+
+uint32 CodecHttp::HexDigits(uint64 ullValue)
+{
+    uint32 uiDigits = 1;
+    while (ullValue >= 16)
+    {
+        ullValue >>= 4;
+        ++uiDigits;
+    }
+    return(uiDigits);
+}
+
+char* CodecHttp::WriteDecimal(char* pPos, uint64 ullValue)
+{
+    char* pEnd = pPos + DecimalDigits(ullValue);
+    char* pDigit = pEnd;
+    do
+    {
+        *--pDigit = '0' + (ullValue % 10);
+        ullValue /= 10;
+    } while (pDigit > pPos);
+    return(pEnd);
+}
+
+char* CodecHttp::WriteHex(char* pPos, uint64 ullValue)
+{
+    static const char sc_szHex[] = "0123456789abcdef";
+    char* pEnd = pPos + HexDigits(ullValue);
+    char* pDigit = pEnd;
+    do
+    {
+        *--pDigit = sc_szHex[ullValue & 0xF];
+        ullValue >>= 4;
+    } while (pDigit > pPos);
+    return(pEnd);
+}
+
 E_CODEC_STATUS CodecHttp::Decode(CBuffer* pBuff, HttpMsg& oHttpMsg)
 {
     LOG4_TRACE(" ");
@@ -605,6 +576,11 @@ E_CODEC_STATUS CodecHttp::Decode(CBuffer* pBuff, HttpMsg& oHttpMsg)
     return(CODEC_STATUS_OK);
 }
 
+void CodecHttp::SetResponseHeaderBlock(const std::string& strHeaderBlock)
+{
+    s_strResponseHeaderBlock = strHeaderBlock;
+}
+
 void CodecHttp::AddHttpHeader(const std::string& strHeaderName, const std::string& strHeaderValue)
 {
     m_mapAddingHttpHeader.insert(std::pair<std::string, std::string>(strHeaderName, strHeaderValue));
@@ -643,6 +619,7 @@ const std::string& CodecHttp::ToString(const HttpMsg& oHttpMsg)
         m_strHttpString += it->second;
         m_strHttpString += "\r\n";
     }
+    m_strHttpString += oHttpMsg.header_block();
     m_strHttpString += "\r\n";
 
     if (oHttpMsg.body().size() > 0)
@@ -10,6 +10,9 @@
 #ifndef SRC_CODEC_CODECHTTP_HPP_
 #define SRC_CODEC_CODECHTTP_HPP_
 
+#include <cstring>
+#include <string>
+#include <unordered_map>
 #include "util/http/http_parser.h"
 #include "pb/http.pb.h"
 #include "Codec.hpp"
@@ -37,6 +40,15 @@ public:
 
     const std::string& ToString(const HttpMsg& oHttpMsg);
 
+    /**
+     * @brief 设置预先序列化的响应头
+     * @note 每个头以"\r\n"结尾（如"X-Frame-Options: DENY\r\n"），编码响应时原样写在其他
+     * 头之后，不再逐个格式化。只在初始化时设置（见配置http_response_headers），不应包含
+     * Content-Length、Transfer-Encoding、Content-Encoding。每个消息各自的预序列化头见
+     * HttpMsg.header_block，写在此块之后。
+     */
+    static void SetResponseHeaderBlock(const std::string& strHeaderBlock);
+
 public:
     ev_tstamp GetKeepAlive() const
     {
@@ -57,6 +69,52 @@ protected:
     static int OnChunkHeader(http_parser *parser);
     static int OnChunkComplete(http_parser *parser);
 
+private:
+    /**
+     * @brief 编码http消息
+     * @note 先计算起始行、头和消息体的总长度，一次预留发送缓冲区后逐段memcpy写入。
+     */
+    E_CODEC_STATUS EncodeHttp(const HttpMsg& oHttpMsg, CBuffer* pBuff);
+
+    /**
+     * @brief 按优先级依次访问要编码的http头（不含Content-Length、Host和Date）
+     */
+    template <typename F>
+    void ForEachHeader(const HttpMsg& oHttpMsg, bool bIsResponse, F&& fnVisit) const;
+
+    bool HasAddingHeader(const std::string& strHeaderName) const
+    {
+        return(!m_mapAddingHttpHeader.empty() && m_mapAddingHttpHeader.find(strHeaderName) != m_mapAddingHttpHeader.end());
+    }
+
+    /**
+     * @brief 状态行中状态码之后的部分，如"200 OK\r\n"，首次调用时生成整张表
+     */
+    static void GetStatusLine(int32 iStatusCode, const char*& pStatusLine, size_t& uiLength);
+
+    /**
+     * @brief "Date: ...\r\n"头，每个线程每秒只格式化一次
+     */
+    static const char* GetDateHeader(size_t& uiLength);
+
+    static uint32 DecimalDigits(uint64 ullValue);
+    static uint32 HexDigits(uint64 ullValue);
+    static char* WriteDecimal(char* pPos, uint64 ullValue);
+    static char* WriteHex(char* pPos, uint64 ullValue);
+    static char* WriteData(char* pPos, const char* pData, size_t uiLength)
+    {
+        memcpy(pPos, pData, uiLength);
+        return(pPos + uiLength);
+    }
+
+    static const int32 sc_iMinStatusCode = 100;
+    static const int32 sc_iMaxStatusCode = 599;
+    static const std::string sc_strConnection;
+    static const std::string sc_strServer;
+    static const std::string sc_strAllow;
+    static const std::string sc_strEmptyHeaderBlock;
+    static std::string s_strResponseHeaderBlock;        ///< 预先序列化的响应头
+
 private:
     bool m_bChannelIsClient;    // 当前编解码器所在channel是作为http客户端还是作为http服务端
     uint32 m_uiEncodedNum;
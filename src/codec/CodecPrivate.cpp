@@ -34,12 +34,13 @@ E_CODEC_STATUS CodecPrivate::Encode(const MsgHead& oMsgHead, const MsgBody& oMsg
     stMsgHead.body_len = htonl((unsigned int)oMsgHead.len());
     stMsgHead.seq = htonl(oMsgHead.seq());
     //stMsgHead.checksum = htons((unsigned short)stMsgHead.checksum);
-    if (oMsgBody.ByteSize() > 1000000) // pb 最大限制
+    int iBodySize = GetBodySize(oMsgBody);
+    if (iBodySize > 1000000) // pb 最大限制
     {
         LOG4_ERROR("oMsgBody.ByteSize() > 1000000");
         return(CODEC_STATUS_ERR);
     }
-    int iHadWriteLen = 0;
+    size_t uiWriteIndex = pBuff->GetWriteIndex();
     int iWriteLen = 0;
     int iNeedWriteLen = sizeof(stMsgHead);
     LOG4_TRACE("cmd %u, seq %u, len %u", oMsgHead.cmd(), oMsgHead.seq(), oMsgHead.len());
@@ -50,41 +51,27 @@ E_CODEC_STATUS CodecPrivate::Encode(const MsgHead& oMsgHead, const MsgBody& oMsg
         if (iWriteLen != iNeedWriteLen)
         {
             LOG4_ERROR("buff write head iWriteLen != sizeof(stClientMsgHead)");
-            pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadWriteLen);
+            pBuff->SetWriteIndex(uiWriteIndex);
             return(CODEC_STATUS_ERR);
         }
         return(CODEC_STATUS_OK);
     }
-    iHadWriteLen += iWriteLen;
     std::string strTmpData;
-    if (stMsgHead.encript == 0)       // 不压缩也不加密
+    std::string strCompressData;
+    std::string strEncryptData;
+    if (stMsgHead.encript != 0)
     {
-        iWriteLen = pBuff->Write(&stMsgHead, iNeedWriteLen);
-        LOG4_TRACE("sizeof(stClientMsgHead) = %d, iWriteLen = %d", sizeof(stMsgHead), iWriteLen);
-        if (iWriteLen != iNeedWriteLen)
+        // 压缩或加密只需要一份明文，按缓存的长度序列化一次
+        if ((gc_uiZipBit | gc_uiGzipBit | gc_uiRc5Bit) & oMsgHead.cmd())
         {
-            LOG4_ERROR("buff write head iWriteLen != sizeof(stClientMsgHead)");
-            pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadWriteLen);
-            return(CODEC_STATUS_ERR);
-        }
-        iNeedWriteLen = oMsgBody.ByteSize();
-        oMsgBody.SerializeToString(&strTmpData);
-        iWriteLen = pBuff->Write(strTmpData.c_str(), oMsgBody.ByteSize());
-        if (iWriteLen != iNeedWriteLen)
-        {
-            LOG4_ERROR("buff write head iWriteLen != sizeof(stClientMsgHead)");
-            pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadWriteLen);
-            return(CODEC_STATUS_ERR);
+            if (!SerializeWithCachedSize(oMsgBody, iBodySize, strTmpData))
+            {
+                LOG4_ERROR("oMsgBody serialize error!");
+                return(CODEC_STATUS_ERR);
+            }
         }
-        iHadWriteLen += iWriteLen;
-    }
-    else
-    {
-        std::string strCompressData;
-        std::string strEncryptData;
         if (gc_uiZipBit & oMsgHead.cmd())
         {
-            oMsgBody.SerializeToString(&strTmpData);
             if (!Zip(strTmpData, strCompressData))
             {
                 LOG4_ERROR("zip error!");
@@ -93,7 +80,6 @@ E_CODEC_STATUS CodecPrivate::Encode(const MsgHead& oMsgHead, const MsgBody& oMsg
         }
         else if (gc_uiGzipBit & oMsgHead.cmd())
         {
-            oMsgBody.SerializeToString(&strTmpData);
             if (!Gzip(strTmpData, strCompressData))
             {
                 LOG4_ERROR("gzip error!");
@@ -102,90 +88,56 @@ E_CODEC_STATUS CodecPrivate::Encode(const MsgHead& oMsgHead, const MsgBody& oMsg
         }
         if (gc_uiRc5Bit & oMsgHead.cmd())
         {
-            if (strCompressData.size() > 0)
-            {
-                if (!Rc5Encrypt(strCompressData, strEncryptData))
-                {
-                    LOG4_ERROR("Rc5Encrypt error!");
-                    return(CODEC_STATUS_ERR);
-                }
-            }
-            else
-            {
-                oMsgBody.SerializeToString(&strTmpData);
-                if (!Rc5Encrypt(strTmpData, strEncryptData))
-                {
-                    LOG4_ERROR("Rc5Encrypt error!");
-                    return(CODEC_STATUS_ERR);
-                }
-            }
-        }
-
-        if (strEncryptData.size() > 0)              // 加密后的数据包
-        {
-            stMsgHead.body_len = htonl((unsigned int)strEncryptData.size());
-            iWriteLen = pBuff->Write(&stMsgHead, iNeedWriteLen);
-            LOG4_TRACE("sizeof(stClientMsgHead) = %d, iWriteLen = %d", sizeof(stMsgHead), iWriteLen);
-            if (iWriteLen != iNeedWriteLen)
-            {
-                LOG4_ERROR("buff write head iWriteLen != sizeof(stClientMsgHead)");
-                pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadWriteLen);
-                return(CODEC_STATUS_ERR);
-            }
-            iHadWriteLen += iWriteLen;
-            iNeedWriteLen = strEncryptData.size();
-            iWriteLen = pBuff->Write(strEncryptData.c_str(), strEncryptData.size());
-            if (iWriteLen != iNeedWriteLen)
+            if (!Rc5Encrypt((strCompressData.size() > 0) ? strCompressData : strTmpData, strEncryptData))
             {
-                pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadWriteLen);
+                LOG4_ERROR("Rc5Encrypt error!");
                 return(CODEC_STATUS_ERR);
             }
-            iHadWriteLen += iWriteLen;
-        }
-        else if (strCompressData.size() > 0)        // 压缩后的数据包
-        {
-            stMsgHead.body_len = htonl((unsigned int)strCompressData.size());
-            iWriteLen = pBuff->Write(&stMsgHead, iNeedWriteLen);
-            LOG4_TRACE("sizeof(stClientMsgHead) = %d, iWriteLen = %d", sizeof(stMsgHead), iWriteLen);
-            if (iWriteLen != iNeedWriteLen)
-            {
-                LOG4_ERROR("buff write head iWriteLen != sizeof(stClientMsgHead)");
-                pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadWriteLen);
-                return(CODEC_STATUS_ERR);
-            }
-            iHadWriteLen += iWriteLen;
-            iNeedWriteLen = strCompressData.size();
-            iWriteLen = pBuff->Write(strCompressData.c_str(), strCompressData.size());
-            if (iWriteLen != iNeedWriteLen)
-            {
-                pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadWriteLen);
-                return(CODEC_STATUS_ERR);
-            }
-            iHadWriteLen += iWriteLen;
-        }
-        else    // 无效的压缩或加密算法，打包原数据
-        {
-            iWriteLen = pBuff->Write(&stMsgHead, iNeedWriteLen);
-            LOG4_TRACE("sizeof(stClientMsgHead) = %d, iWriteLen = %d", sizeof(stMsgHead), iWriteLen);
-            if (iWriteLen != iNeedWriteLen)
-            {
-                LOG4_ERROR("buff write head iWriteLen != sizeof(stClientMsgHead)");
-                pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadWriteLen);
-                return(CODEC_STATUS_ERR);
-            }
-            iHadWriteLen += iWriteLen;
-            iNeedWriteLen = oMsgBody.ByteSize();
-            oMsgBody.SerializeToString(&strTmpData);
-            iWriteLen = pBuff->Write(strTmpData.c_str(), oMsgBody.ByteSize());
-            if (iWriteLen != iNeedWriteLen)
-            {
-                pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadWriteLen);
-                return(CODEC_STATUS_ERR);
-            }
-            iHadWriteLen += iWriteLen;
         }
     }
-    LOG4_TRACE("oMsgBody.ByteSize() = %d, iWriteLen = %d(compress or encrypt maybe)", oMsgBody.ByteSize(), iWriteLen);
+
+    const std::string* pData = nullptr;
+    if (strEncryptData.size() > 0)              // 加密后的数据包
+    {
+        pData = &strEncryptData;
+    }
+    else if (strCompressData.size() > 0)        // 压缩后的数据包
+    {
+        pData = &strCompressData;
+    }
+    if (pData != nullptr)
+    {
+        stMsgHead.body_len = htonl((unsigned int)pData->size());
+        iNeedWriteLen += pData->size();
+    }
+    else    // 不压缩也不加密，或无效的压缩或加密算法，打包原数据
+    {
+        iNeedWriteLen += iBodySize;
+    }
+    if (!pBuff->EnsureWritableBytes(iNeedWriteLen))
+    {
+        LOG4_ERROR("buff EnsureWritableBytes(%d) failed!", iNeedWriteLen);
+        return(CODEC_STATUS_ERR);
+    }
+    iWriteLen = pBuff->Write(&stMsgHead, sizeof(stMsgHead));
+    LOG4_TRACE("sizeof(stClientMsgHead) = %d, iWriteLen = %d", sizeof(stMsgHead), iWriteLen);
+    if (pData != nullptr)
+    {
+        iWriteLen = pBuff->Write(pData->data(), pData->size());
+        iNeedWriteLen = pData->size();
+    }
+    else
+    {
+        iWriteLen = SerializeWithCachedSize(oMsgBody, iBodySize, pBuff);
+        iNeedWriteLen = iBodySize;
+    }
+    if (iWriteLen != iNeedWriteLen)
+    {
+        LOG4_ERROR("buff write body iWriteLen != iNeedWriteLen");
+        pBuff->SetWriteIndex(uiWriteIndex);
+        return(CODEC_STATUS_ERR);
+    }
+    LOG4_TRACE("oMsgBody.ByteSize() = %d, iWriteLen = %d(compress or encrypt maybe)", iBodySize, iWriteLen);
     return(CODEC_STATUS_OK);
 }
 
@@ -25,37 +25,39 @@ CodecProto::~CodecProto()
 
 E_CODEC_STATUS CodecProto::Encode(const MsgHead& oMsgHead, const MsgBody& oMsgBody, CBuffer* pBuff)
 {
-    LOG4_TRACE("pBuff->ReadableBytes()=%u, oMsgHead.ByteSize() = %d", pBuff->ReadableBytes(), oMsgHead.ByteSize());
-    int iHadWriteLen = 0;
-    int iWriteLen = 0;
-    int iNeedWriteLen = gc_uiMsgHeadSize;
-    std::string strTmpData;
-    oMsgHead.SerializeToString(&strTmpData);
-    iWriteLen = pBuff->Write(strTmpData.c_str(), gc_uiMsgHeadSize);
-    if (iWriteLen != iNeedWriteLen)
+    LOG4_TRACE("pBuff->ReadableBytes()=%u, oMsgHead.len() = %d", pBuff->ReadableBytes(), oMsgHead.len());
+    int iHeadSize = (int)oMsgHead.ByteSizeLong();
+    if (iHeadSize != (int)gc_uiMsgHeadSize)
     {
-        LOG4_ERROR("buff write head iWriteLen != iNeedWriteLen!");
-        pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadWriteLen);
+        LOG4_ERROR("oMsgHead.ByteSize() %d != %u, cmd, seq and len of MsgHead must not be 0!",
+                iHeadSize, gc_uiMsgHeadSize);
         return(CODEC_STATUS_ERR);
     }
-    iHadWriteLen += iWriteLen;
-    if (oMsgHead.len() <= 0)    // 无包体（心跳包等），nebula在proto3的使用上以-1表示包体长度为0
+    int iBodySize = 0;
+    if (oMsgHead.len() > 0)     // 无包体（心跳包等），nebula在proto3的使用上以-1表示包体长度为0
     {
-        return(CODEC_STATUS_OK);
+        iBodySize = GetBodySize(oMsgBody);
     }
-    iNeedWriteLen = oMsgBody.ByteSize();
-    oMsgBody.SerializeToString(&strTmpData);
-    iWriteLen = pBuff->Write(strTmpData.c_str(), oMsgBody.ByteSize());
-    if (iWriteLen == iNeedWriteLen)
+    // 一次预留包头和包体空间，直接在缓冲区上序列化
+    if (!pBuff->EnsureWritableBytes(iHeadSize + iBodySize))
     {
-        return(CODEC_STATUS_OK);
+        LOG4_ERROR("buff EnsureWritableBytes(%d) failed!", iHeadSize + iBodySize);
+        return(CODEC_STATUS_ERR);
     }
-    else
+    size_t uiWriteIndex = pBuff->GetWriteIndex();
+    if (SerializeWithCachedSize(oMsgHead, iHeadSize, pBuff) != iHeadSize)
+    {
+        LOG4_ERROR("buff write head iWriteLen != iNeedWriteLen!");
+        pBuff->SetWriteIndex(uiWriteIndex);
+        return(CODEC_STATUS_ERR);
+    }
+    if (SerializeWithCachedSize(oMsgBody, iBodySize, pBuff) != iBodySize)
     {
         LOG4_ERROR("buff write body iWriteLen != iNeedWriteLen!");
-        pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadWriteLen);
+        pBuff->SetWriteIndex(uiWriteIndex);
         return(CODEC_STATUS_ERR);
     }
+    return(CODEC_STATUS_OK);
 }
 
 E_CODEC_STATUS CodecProto::Decode(CBuffer* pBuff, MsgHead& oMsgHead, MsgBody& oMsgBody)
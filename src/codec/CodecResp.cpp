@@ -8,7 +8,6 @@
  * Modify history:
  ******************************************************************************/
 #include "CodecResp.hpp"
-#include "util/StringConverter.hpp"
 
 namespace neb
 {
@@ -75,39 +74,35 @@ E_CODEC_STATUS CodecResp::Encode(const RedisReply& oReply, CBuffer* pBuff)
 
 E_CODEC_STATUS CodecResp::Decode(CBuffer* pBuff, RedisReply& oReply)
 {
-    if (pBuff->ReadableBytes() < 1)
+    RespView oView;
+    E_CODEC_STATUS eStatus = Decode(pBuff, oView);
+    if (CODEC_STATUS_OK == eStatus)
     {
-        return(CODEC_STATUS_PAUSE);
+        if (!oView.ToRedisReply(oReply))
+        {
+            LOG4_ERROR("failed to convert resp type %d to RedisReply", oView.Type());
+            return(CODEC_STATUS_ERR);
+        }
     }
-    char cFirstByte = 0;
-    size_t uiReadIndex = pBuff->GetReadIndex();
-    pBuff->ReadByte(cFirstByte);
-    E_CODEC_STATUS eStatus = CODEC_STATUS_OK;
-    switch (cFirstByte)
+    else if (CODEC_STATUS_ERR == eStatus)
     {
-        case RESP_SIMPLE_STRING:
-            eStatus = DecodeSimpleString(pBuff, oReply);
-            break;
-        case RESP_INTEGER:
-            eStatus = DecodeInteger(pBuff, oReply);
-            break;
-        case RESP_BULK_STRING:
-            eStatus = DecodeBulkString(pBuff, oReply);
-            break;
-        case RESP_ARRAY:
-            eStatus = DecodeArray(pBuff, oReply);
-            break;
-        case RESP_ERROR:
-            eStatus = DecodeError(pBuff, oReply);
-            break;
-        default:
-            oReply.set_type(REDIS_REPLY_ERROR);
-            oReply.set_integer(REDIS_ERR_PROTOCOL);
-            return(CODEC_STATUS_ERR);
+        oReply.set_type(REDIS_REPLY_ERROR);
+        oReply.set_integer(REDIS_ERR_PROTOCOL);
     }
-    if (CODEC_STATUS_PAUSE == eStatus)
+    return(eStatus);
+}
+
+E_CODEC_STATUS CodecResp::Decode(CBuffer* pBuff, RespView& oView)
+{
+    // 先校验整帧完整再前进读位置，数据不完整时不产生任何中间结果，下次收到数据后重新解析
+    E_CODEC_STATUS eStatus = RespView::Parse(pBuff->GetRawReadBuffer(), pBuff->ReadableBytes(), oView);
+    if (CODEC_STATUS_OK == eStatus)
+    {
+        pBuff->AdvanceReadIndex(oView.GetFrameLength());
+    }
+    else if (CODEC_STATUS_ERR == eStatus)
     {
-        pBuff->SetReadIndex(uiReadIndex);
+        LOG4_ERROR("invalid resp data.");
     }
     return(eStatus);
 }
@@ -213,252 +208,4 @@ E_CODEC_STATUS CodecResp::EncodeNull(const RedisReply& oReply, CBuffer* pBuff)
     return(CODEC_STATUS_OK);
 }
 
-E_CODEC_STATUS CodecResp::DecodeSimpleString(CBuffer* pBuff, RedisReply& oReply)
-{
-    size_t uiReadableBytes = pBuff->ReadableBytes();
-    char cLastChar = 0;
-    uint32 uiStringLen = 0;
-    const char* pData = pBuff->GetRawReadBuffer();
-    const char* pPartBegin = pData;
-    for (size_t i = 0; i < uiReadableBytes; ++i)
-    {
-        switch (pData[i])
-        {
-            case '\n':
-                if ('\r' == cLastChar)
-                {
-                    cLastChar = '\n';
-                    oReply.set_type(REDIS_REPLY_STATUS);
-                    oReply.set_str(pPartBegin, uiStringLen);
-                    pBuff->AdvanceReadIndex(i + 1);
-                    return(CODEC_STATUS_OK);
-                }
-                else
-                {
-                    return(CODEC_STATUS_ERR);
-                }
-                break;
-            case '\r':
-                cLastChar = '\r';
-                break;
-            default:
-                ++uiStringLen;
-        }
-    }
-    return(CODEC_STATUS_PAUSE);
-}
-
-E_CODEC_STATUS CodecResp::DecodeError(CBuffer* pBuff, RedisReply& oReply)
-{
-    size_t uiReadableBytes = pBuff->ReadableBytes();
-    char cLastChar = 0;
-    uint32 uiStringLen = 0;
-    const char* pData = pBuff->GetRawReadBuffer();
-    const char* pPartBegin = pData;
-    for (size_t i = 0; i < uiReadableBytes; ++i)
-    {
-        switch (pData[i])
-        {
-            case '\n':
-                if ('\r' == cLastChar)
-                {
-                    cLastChar = '\n';
-                    oReply.set_type(REDIS_REPLY_ERROR);
-                    oReply.set_str(pPartBegin, uiStringLen);
-                    pBuff->AdvanceReadIndex(i + 1);
-                    return(CODEC_STATUS_OK);
-                }
-                else
-                {
-                    return(CODEC_STATUS_ERR);
-                }
-                break;
-            case '\r':
-                cLastChar = '\r';
-                break;
-            default:
-                ++uiStringLen;
-        }
-    }
-    return(CODEC_STATUS_PAUSE);
-}
-
-E_CODEC_STATUS CodecResp::DecodeInteger(CBuffer* pBuff, RedisReply& oReply)
-{
-    size_t uiReadableBytes = pBuff->ReadableBytes();
-    char cLastChar = 0;
-    const char* pData = pBuff->GetRawReadBuffer();
-    const char* pPartBegin = pData;
-    for (size_t i = 0; i < uiReadableBytes; ++i)
-    {
-        switch (pData[i])
-        {
-            case '\n':
-                if ('\r' == cLastChar)
-                {
-                    cLastChar = '\n';
-                    oReply.set_type(REDIS_REPLY_INTEGER);
-                    oReply.set_integer(StringConverter::RapidAtoi<int64>(pPartBegin));
-                    pBuff->AdvanceReadIndex(i + 1);
-                    return(CODEC_STATUS_OK);
-                }
-                else
-                {
-                    return(CODEC_STATUS_ERR);
-                }
-                break;
-            case '\r':
-                cLastChar = '\r';
-                break;
-            default:
-                ;
-        }
-    }
-    return(CODEC_STATUS_PAUSE);
-}
-
-E_CODEC_STATUS CodecResp::DecodeBulkString(CBuffer* pBuff, RedisReply& oReply)
-{
-    size_t uiReadableBytes = pBuff->ReadableBytes();
-    char cLastChar = 0;
-    int32 iStringLen = 0;
-    bool bGotStringLen = false;
-    const char* pData = pBuff->GetRawReadBuffer();
-    const char* pPartBegin = pData;
-    for (size_t i = 0; i <= uiReadableBytes; ++i)
-    {
-        switch (pData[i])
-        {
-            case '\n':
-                if ('\r' == cLastChar)
-                {
-                    cLastChar = '\n';
-                    if (bGotStringLen)
-                    {
-                        oReply.set_type(REDIS_REPLY_STRING);
-                        oReply.set_str(pPartBegin, iStringLen);
-                        pBuff->AdvanceReadIndex(i + 1);
-                        return(CODEC_STATUS_OK);
-                    }
-                    else
-                    {
-                        iStringLen = StringConverter::RapidAtoi<int32>(pPartBegin);
-                        pPartBegin = pData + i + 1;
-                        bGotStringLen = true;
-                        if (iStringLen == -1)
-                        {
-                            oReply.set_type(REDIS_REPLY_NIL);
-                            pBuff->AdvanceReadIndex(i + 1);
-                            return(CODEC_STATUS_OK);
-                        }
-                        if (uiReadableBytes - i < (uint32)iStringLen)
-                        {
-                            return(CODEC_STATUS_PAUSE);
-                        }
-                        else
-                        {
-                            i += (uint32)iStringLen;
-                        }
-                    }
-                }
-                else
-                {
-                    return(CODEC_STATUS_ERR);
-                }
-                break;
-            case '\r':
-                cLastChar = '\r';
-                break;
-            default:
-                ;
-        }
-    }
-    return(CODEC_STATUS_PAUSE);
-}
-
-E_CODEC_STATUS CodecResp::DecodeArray(CBuffer* pBuff, RedisReply& oReply)
-{
-    size_t uiReadableBytes = pBuff->ReadableBytes();
-    char cLastChar = 0;
-    int32 iArraySize = 0;
-    size_t uiReadIndex = pBuff->GetReadIndex();
-    const char* pData = pBuff->GetRawReadBuffer();
-    const char* pPartBegin = pData;
-    for (size_t i = 0; i < uiReadableBytes; ++i)
-    {
-        switch (pData[i])
-        {
-            case '\n':
-                if ('\r' == cLastChar)
-                {
-                    cLastChar = '\n';
-                    iArraySize = StringConverter::RapidAtoi<int32>(pPartBegin);
-                    pBuff->AdvanceReadIndex(i + 1);
-
-                    if (iArraySize == -1)
-                    {
-                        oReply.set_type(REDIS_REPLY_NIL);
-                        return(CODEC_STATUS_OK);
-                    }
-                    else
-                    {
-                        oReply.set_type(REDIS_REPLY_ARRAY);
-                        for (int32 j = 0; j < iArraySize; ++j)
-                        {
-                            if (pBuff->ReadableBytes() == 0)
-                            {
-                                return(CODEC_STATUS_PAUSE);
-                            }
-                            uiReadIndex = pBuff->GetReadIndex();
-                            char cFirstByte = 0;
-                            auto pElement = oReply.add_element();
-                            pBuff->ReadByte(cFirstByte);
-                            E_CODEC_STATUS eStatus = CODEC_STATUS_OK;
-                            switch (cFirstByte)
-                            {
-                                case RESP_SIMPLE_STRING:
-                                    eStatus = DecodeSimpleString(pBuff, *pElement);
-                                    break;
-                                case RESP_INTEGER:
-                                    eStatus = DecodeInteger(pBuff, *pElement);
-                                    break;
-                                case RESP_BULK_STRING:
-                                    eStatus = DecodeBulkString(pBuff, *pElement);
-                                    break;
-                                case RESP_ARRAY:
-                                    eStatus = DecodeArray(pBuff, *pElement);
-                                    break;
-                                case RESP_ERROR:
-                                    eStatus = DecodeError(pBuff, *pElement);
-                                    break;
-                                default:
-                                    oReply.set_type(REDIS_REPLY_ERROR);
-                                    oReply.set_integer(REDIS_ERR_PROTOCOL);
-                                    return(CODEC_STATUS_ERR);
-                            }
-                            if (CODEC_STATUS_OK != eStatus)
-                            {
-                                return(eStatus);
-                            }
-                            i += (pBuff->GetReadIndex() - uiReadIndex);
-                        }
-                        return(CODEC_STATUS_OK);
-                    }
-                }
-                else
-                {
-                    return(CODEC_STATUS_ERR);
-                }
-                break;
-            case '\r':
-                cLastChar = '\r';
-                break;
-            default:
-                ;
-        }
-    }
-    return(CODEC_STATUS_PAUSE);
-}
-
-}
-
+} /* namespace neb */
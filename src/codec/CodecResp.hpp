@@ -12,6 +12,7 @@
 
 #include "Codec.hpp"
 #include "pb/redis.pb.h"
+#include "RespView.hpp"
 
 namespace neb
 {
@@ -30,6 +31,11 @@ public:
     virtual E_CODEC_STATUS Encode(const RedisReply& oReply, CBuffer* pBuff);
     virtual E_CODEC_STATUS Decode(CBuffer* pBuff, RedisReply& oReply);
 
+    /**
+     * @brief 零拷贝解码，oView引用pBuff中的数据，pBuff下次写入（或Compact）之前有效
+     */
+    E_CODEC_STATUS Decode(CBuffer* pBuff, RespView& oView);
+
 protected:
     E_CODEC_STATUS EncodeSimpleString(const RedisReply& oReply, CBuffer* pBuff);
     E_CODEC_STATUS EncodeError(const RedisReply& oReply, CBuffer* pBuff);
@@ -37,11 +43,6 @@ protected:
     E_CODEC_STATUS EncodeBulkString(const RedisReply& oReply, CBuffer* pBuff);
     E_CODEC_STATUS EncodeArray(const RedisReply& oReply, CBuffer* pBuff);
     E_CODEC_STATUS EncodeNull(const RedisReply& oReply, CBuffer* pBuff);
-    E_CODEC_STATUS DecodeSimpleString(CBuffer* pBuff, RedisReply& oReply);
-    E_CODEC_STATUS DecodeError(CBuffer* pBuff, RedisReply& oReply);
-    E_CODEC_STATUS DecodeInteger(CBuffer* pBuff, RedisReply& oReply);
-    E_CODEC_STATUS DecodeBulkString(CBuffer* pBuff, RedisReply& oReply);
-    E_CODEC_STATUS DecodeArray(CBuffer* pBuff, RedisReply& oReply);
 
 private:
     static const char RESP_SIMPLE_STRING;
@@ -38,13 +38,14 @@ E_CODEC_STATUS CodecWsExtentPb::Encode(const MsgHead& oMsgHead,
     stMsgHead.body_len = htonl((unsigned int) oMsgHead.len());
     stMsgHead.seq = htonl(oMsgHead.seq());
 //stMsgHead.checksum = htons((unsigned short)stMsgHead.checksum);
-    if (oMsgBody.ByteSize() > 1000000) // pb 最大限制
+    int iBodySize = GetBodySize(oMsgBody);
+    if (iBodySize > 1000000) // pb 最大限制
     {
         LOG4_ERROR("oMsgBody.ByteSize() > 1000000");
         return (CODEC_STATUS_ERR);
     }
+    size_t uiWriteIndex = pBuff->GetWriteIndex();
     int iNeedWriteLen = 0;
-    int iHadWriteLen = 0;
     int iWriteLen = 0;
     LOG4_TRACE("cmd %u, seq %u, len %u", oMsgHead.cmd(), oMsgHead.seq(), oMsgHead.len());
     if (oMsgHead.len() == 0)    // 无包体（心跳包等）
@@ -77,9 +78,17 @@ E_CODEC_STATUS CodecWsExtentPb::Encode(const MsgHead& oMsgHead,
         std::string strCompressData;
         std::string strEncryptData;
         std::string strTmpData;
+        // 压缩或加密只需要一份明文，按缓存的长度序列化一次
+        if ((gc_uiZipBit | gc_uiGzipBit | gc_uiRc5Bit) & oMsgHead.cmd())
+        {
+            if (!SerializeWithCachedSize(oMsgBody, iBodySize, strTmpData))
+            {
+                LOG4_ERROR("oMsgBody serialize error!");
+                return (CODEC_STATUS_ERR);
+            }
+        }
         if (gc_uiZipBit & oMsgHead.cmd())
         {
-            oMsgBody.SerializeToString(&strTmpData);
             if (!Zip(strTmpData, strCompressData))
             {
                 LOG4_ERROR("zip error!");
@@ -88,7 +97,6 @@ E_CODEC_STATUS CodecWsExtentPb::Encode(const MsgHead& oMsgHead,
         }
         else if (gc_uiGzipBit & oMsgHead.cmd())
         {
-            oMsgBody.SerializeToString(&strTmpData);
             if (!Gzip(strTmpData, strCompressData))
             {
                 LOG4_ERROR("gzip error!");
@@ -97,109 +105,81 @@ E_CODEC_STATUS CodecWsExtentPb::Encode(const MsgHead& oMsgHead,
         }
         if (gc_uiRc5Bit & oMsgHead.cmd())
         {
-            if (strCompressData.size() > 0)
-            {
-                if (!Rc5Encrypt(strCompressData, strEncryptData))
-                {
-                    LOG4_ERROR("Rc5Encrypt error!");
-                    return (CODEC_STATUS_ERR);
-                }
-            }
-            else
+            if (!Rc5Encrypt((strCompressData.size() > 0) ? strCompressData : strTmpData, strEncryptData))
             {
-                oMsgBody.SerializeToString(&strTmpData);
-                if (!Rc5Encrypt(strTmpData, strEncryptData))
-                {
-                    LOG4_ERROR("Rc5Encrypt error!");
-                    return (CODEC_STATUS_ERR);
-                }
+                LOG4_ERROR("Rc5Encrypt error!");
+                return (CODEC_STATUS_ERR);
             }
         }
 
+        const std::string* pData = nullptr;
         if (strEncryptData.size() > 0)              // 加密后的数据包
         {
-            stMsgHead.body_len = htonl((unsigned int) strEncryptData.size());
+            pData = &strEncryptData;
         }
         else if (strCompressData.size() > 0)        // 压缩后的数据包
         {
-            stMsgHead.body_len = htonl((unsigned int) strCompressData.size());
+            pData = &strCompressData;
         }
-        else    // 不需要压缩加密或无效的压缩或加密算法，打包原数据
+        int iBodyLen = iBodySize;                   // 不需要压缩加密或无效的压缩或加密算法，打包原数据
+        if (pData != nullptr)
         {
-            iNeedWriteLen = oMsgBody.ByteSize();
+            iBodyLen = pData->size();
+            stMsgHead.body_len = htonl((unsigned int) iBodyLen);
         }
 
-        iNeedWriteLen = sizeof(stMsgHead) + oMsgHead.len();
+        // websocket帧头最长10字节，帧头、消息头和消息体一次预留
+        iNeedWriteLen = sizeof(stMsgHead) + iBodyLen;
+        if (!pBuff->EnsureWritableBytes(10 + iNeedWriteLen))
+        {
+            LOG4_ERROR("buff EnsureWritableBytes(%d) failed!", 10 + iNeedWriteLen);
+            return (CODEC_STATUS_ERR);
+        }
         if (iNeedWriteLen > 65535)
         {
             ucSecondByte |= WEBSOCKET_PAYLOAD_LEN_UINT64;
-            iWriteLen = pBuff->Write(&ucFirstByte, 1);
-            iHadWriteLen += iWriteLen;
-            iWriteLen = pBuff->Write(&ucSecondByte, 1);
-            iHadWriteLen += iWriteLen;
+            pBuff->Write(&ucFirstByte, 1);
+            pBuff->Write(&ucSecondByte, 1);
             uint64 ullPayload = iNeedWriteLen;
             ullPayload = CodecUtil::H2N(ullPayload);
-            iWriteLen = pBuff->Write(&ullPayload, sizeof(ullPayload));
-            iHadWriteLen += iWriteLen;
+            pBuff->Write(&ullPayload, sizeof(ullPayload));
         }
         else if (iNeedWriteLen >= 126)
         {
             ucSecondByte |= WEBSOCKET_PAYLOAD_LEN_UINT16;
-            iWriteLen = pBuff->Write(&ucFirstByte, 1);
-            iHadWriteLen += iWriteLen;
-            iWriteLen = pBuff->Write(&ucSecondByte, 1);
-            iHadWriteLen += iWriteLen;
+            pBuff->Write(&ucFirstByte, 1);
+            pBuff->Write(&ucSecondByte, 1);
             uint16 unPayload = iNeedWriteLen;
             unPayload = htons(unPayload);
-            iWriteLen = pBuff->Write(&unPayload, sizeof(unPayload));
-            iHadWriteLen += iWriteLen;
+            pBuff->Write(&unPayload, sizeof(unPayload));
         }
         else
         {
             ucSecondByte |= iNeedWriteLen;
-            iWriteLen = pBuff->Write(&ucFirstByte, 1);
-            iHadWriteLen += iWriteLen;
-            iWriteLen = pBuff->Write(&ucSecondByte, 1);
-            iHadWriteLen += iWriteLen;
+            pBuff->Write(&ucFirstByte, 1);
+            pBuff->Write(&ucSecondByte, 1);
         }
 
-        iNeedWriteLen = sizeof(stMsgHead);
-        iWriteLen = pBuff->Write(&stMsgHead, iNeedWriteLen);
+        iWriteLen = pBuff->Write(&stMsgHead, sizeof(stMsgHead));
         LOG4_TRACE("sizeof(stClientMsgHead) = %d, iWriteLen = %d",
                 sizeof(stMsgHead), iWriteLen);
-        if (iWriteLen != iNeedWriteLen)
+        if (pData != nullptr)
         {
-            LOG4_ERROR("buff write head iWriteLen != sizeof(stClientMsgHead)");
-            pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadWriteLen);
-            return (CODEC_STATUS_ERR);
+            iWriteLen = pBuff->Write(pData->data(), pData->size());
         }
-
-        if (strEncryptData.size() > 0)              // 加密后的数据包
-        {
-            iNeedWriteLen = strEncryptData.size();
-            iWriteLen = pBuff->Write(strEncryptData.c_str(), strEncryptData.size());
-        }
-        else if (strCompressData.size() > 0)        // 压缩后的数据包
-        {
-            iNeedWriteLen = strCompressData.size();
-            iWriteLen = pBuff->Write(strCompressData.c_str(), strCompressData.size());
-        }
-        else    // 无效的压缩或加密算法，打包原数据
+        else
         {
-            iNeedWriteLen = oMsgBody.ByteSize();
-            oMsgBody.SerializeToString(&strTmpData);
-            iWriteLen = pBuff->Write(strTmpData.c_str(), oMsgBody.ByteSize());
+            iWriteLen = SerializeWithCachedSize(oMsgBody, iBodySize, pBuff);
         }
-        if (iWriteLen != iNeedWriteLen)
+        if (iWriteLen != iBodyLen)
         {
             LOG4_ERROR("buff iWriteLen != iNeedWriteLen");
-            pBuff->SetWriteIndex(pBuff->GetWriteIndex() - iHadWriteLen);
+            pBuff->SetWriteIndex(uiWriteIndex);
             return (CODEC_STATUS_ERR);
         }
-        iHadWriteLen += iWriteLen;
     }
     LOG4_TRACE("oMsgBody.ByteSize() = %d, iWriteLen = %d(compress or encrypt maybe)",
-            oMsgBody.ByteSize(), iWriteLen);
+            iBodySize, iWriteLen);
     return (CODEC_STATUS_OK);
 }
 
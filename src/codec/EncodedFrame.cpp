@@ -0,0 +1,79 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     EncodedFrame.cpp
+ * @brief    预编码消息帧
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note
+ * Modify history:
+ ******************************************************************************/
+#include "EncodedFrame.hpp"
+
+namespace neb
+{
+
+EncodedFrame::EncodedFrame(int32 iCmd, uint32 uiSeq, const MsgBody& oMsgBody)
+    : m_oMsgBody(oMsgBody)
+{
+    int32 iMsgBodyLen = (int32)oMsgBody.ByteSizeLong();   // 只用于MsgHead.len，各编码器编码时自行计算消息体长度
+    m_oMsgHead.set_cmd(iCmd);
+    m_oMsgHead.set_seq(uiSeq);
+    m_oMsgHead.set_len((iMsgBodyLen > 0) ? iMsgBodyLen : -1);  // proto3里int赋值为0会在指定固定大小的message时有问题
+    for (int i = 0; i < s_iCacheSize; ++i)
+    {
+        m_aEncodeFailed[i] = false;
+    }
+}
+
+EncodedFrame::~EncodedFrame()
+{
+}
+
+std::shared_ptr<const CBuffer> EncodedFrame::GetEncoded(Codec* pCodec)
+{
+    if (nullptr == pCodec)
+    {
+        return(nullptr);
+    }
+    int iIndex = GetCacheIndex(pCodec->GetCodecType());
+    if (iIndex < 0 || m_aEncodeFailed[iIndex])
+    {
+        return(nullptr);
+    }
+    if ((gc_uiRc5Bit | gc_uiAesBit) & m_oMsgHead.cmd())
+    {
+        return(nullptr);
+    }
+    if (nullptr == m_aEncoded[iIndex])
+    {
+        std::shared_ptr<CBuffer> pBuff = std::make_shared<CBuffer>();
+        if (CODEC_STATUS_OK != pCodec->Encode(m_oMsgHead, m_oMsgBody, pBuff.get()))
+        {
+            m_aEncodeFailed[iIndex] = true;
+            return(nullptr);
+        }
+        m_aEncoded[iIndex] = pBuff;
+    }
+    return(m_aEncoded[iIndex]);
+}
+
+int EncodedFrame::GetCacheIndex(E_CODEC_TYPE eCodecType)
+{
+    switch (eCodecType)
+    {
+        case CODEC_PROTO:
+        case CODEC_NEBULA:
+        case CODEC_NEBULA_IN_NODE:      // 三者使用同一编解码类，编码结果相同
+            return(0);
+        case CODEC_PRIVATE:
+            return(1);
+        case CODEC_WS_EXTEND_PB:
+            return(2);
+        case CODEC_WS_EXTEND_JSON:
+            return(3);
+        default:
+            return(-1);
+    }
+}
+
+} /* namespace neb */
@@ -0,0 +1,79 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     EncodedFrame.hpp
+ * @brief    预编码消息帧
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note     同一消息发往多个连接（节点广播、群聊推送）时，每种编解码方式只编码一次，
+ * 编码结果以引用计数的只读缓冲区挂入各连接的发送队列，不再逐连接重复序列化。
+ * Modify history:
+ ******************************************************************************/
+#ifndef SRC_CODEC_ENCODEDFRAME_HPP_
+#define SRC_CODEC_ENCODEDFRAME_HPP_
+
+#include <memory>
+#include "pb/msg.pb.h"
+#include "util/CBuffer.hpp"
+#include "Codec.hpp"
+
+namespace neb
+{
+
+/**
+ * @brief 预编码消息帧
+ * @note 只在构造所在的调用栈内使用，不复制oMsgBody，oMsgBody在帧的生命期内不可修改。
+ * 编码结果与连接无关的编解码方式（CODEC_PROTO、CODEC_NEBULA、CODEC_NEBULA_IN_NODE、
+ * CODEC_PRIVATE、CODEC_WS_EXTEND_PB、CODEC_WS_EXTEND_JSON）才缓存编码结果；命令字带
+ * 加密位时密钥是连接各自的，仍由各连接单独编码。
+ */
+class EncodedFrame
+{
+public:
+    EncodedFrame(int32 iCmd, uint32 uiSeq, const MsgBody& oMsgBody);
+    EncodedFrame(const EncodedFrame&) = delete;
+    EncodedFrame& operator=(const EncodedFrame&) = delete;
+    virtual ~EncodedFrame();
+
+    int32 GetCmd() const
+    {
+        return(m_oMsgHead.cmd());
+    }
+
+    uint32 GetSeq() const
+    {
+        return(m_oMsgHead.seq());
+    }
+
+    const MsgHead& GetMsgHead() const
+    {
+        return(m_oMsgHead);
+    }
+
+    const MsgBody& GetMsgBody() const
+    {
+        return(m_oMsgBody);
+    }
+
+    /**
+     * @brief 获取以pCodec编码的数据
+     * @note 同类编解码器首次调用时编码，之后返回同一缓冲区。
+     * @param pCodec 连接的编解码器
+     * @return 编码结果（只读），编码结果与连接相关或编码失败时返回nullptr，调用方应退回逐连接编码
+     */
+    std::shared_ptr<const CBuffer> GetEncoded(Codec* pCodec);
+
+private:
+    static int GetCacheIndex(E_CODEC_TYPE eCodecType);
+
+private:
+    static const int s_iCacheSize = 4;
+
+    MsgHead m_oMsgHead;
+    const MsgBody& m_oMsgBody;
+    std::shared_ptr<const CBuffer> m_aEncoded[s_iCacheSize];
+    bool m_aEncodeFailed[s_iCacheSize];
+};
+
+} /* namespace neb */
+
+#endif /* SRC_CODEC_ENCODEDFRAME_HPP_ */
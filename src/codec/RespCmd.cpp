@@ -0,0 +1,201 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     RespCmd.cpp
+ * @brief    redis请求命令构造
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note
+ * Modify history:
+ ******************************************************************************/
+#include <cstring>
+#include "RespCmd.hpp"
+
+namespace neb
+{
+
+const uint32 RespCmd::sc_uiInlineArgNum;
+
+RespCmd::RespCmd()
+    : m_uiArgNum(0)
+{
+}
+
+RespCmd::~RespCmd()
+{
+}
+
+RespCmd& RespCmd::Append(const char* szArg)
+{
+    return(Append(szArg, (nullptr == szArg) ? 0 : strlen(szArg)));
+}
+
+RespCmd& RespCmd::Append(const char* pData, size_t uiLength)
+{
+    tagArg stArg;
+    stArg.pData = (nullptr == pData) ? "" : pData;
+    stArg.uiLength = uiLength;
+    return(AppendArg(stArg));
+}
+
+RespCmd& RespCmd::Append(const std::string& strArg)
+{
+    return(Append(strArg.data(), strArg.size()));
+}
+
+RespCmd& RespCmd::AppendArg(const tagArg& stArg)
+{
+    if (m_uiArgNum < sc_uiInlineArgNum)
+    {
+        m_aArg[m_uiArgNum] = stArg;
+    }
+    else
+    {
+        m_vecExtraArg.push_back(stArg);
+    }
+    ++m_uiArgNum;
+    return(*this);
+}
+
+void RespCmd::Clear()
+{
+    m_uiArgNum = 0;
+    m_vecExtraArg.clear();
+}
+
+std::string RespCmd::GetArgString(uint32 uiIndex) const
+{
+    if (uiIndex >= m_uiArgNum)
+    {
+        return("");
+    }
+    const tagArg& stArg = GetArg(uiIndex);
+    if (nullptr != stArg.pData)
+    {
+        return(std::string(stArg.pData, stArg.uiLength));
+    }
+    char szInteger[24];
+    char* pPos = szInteger;
+    if (stArg.bNegative)
+    {
+        *pPos++ = '-';
+    }
+    char* pEnd = WriteInteger(pPos, stArg.ullInteger, Digits(stArg.ullInteger));
+    return(std::string(szInteger, pEnd - szInteger));
+}
+
+size_t RespCmd::GetEncodedLength() const
+{
+    // *<argc>\r\n 以及每个参数的 $<len>\r\n<data>\r\n
+    size_t uiLength = 1 + Digits(m_uiArgNum) + 2;
+    for (uint32 i = 0; i < m_uiArgNum; ++i)
+    {
+        const tagArg& stArg = GetArg(i);
+        uiLength += 1 + Digits(stArg.uiLength) + 2 + stArg.uiLength + 2;
+    }
+    return(uiLength);
+}
+
+E_CODEC_STATUS RespCmd::Encode(CBuffer* pBuff) const
+{
+    if (0 == m_uiArgNum)
+    {
+        return(CODEC_STATUS_ERR);
+    }
+    size_t uiLength = GetEncodedLength();
+    if (!pBuff->EnsureWritableBytes(uiLength))
+    {
+        return(CODEC_STATUS_ERR);
+    }
+    char* pPos = pBuff->GetRawWriteBuffer();
+    pPos = WriteLength(pPos, '*', m_uiArgNum);
+    for (uint32 i = 0; i < m_uiArgNum; ++i)
+    {
+        const tagArg& stArg = GetArg(i);
+        pPos = WriteLength(pPos, '$', stArg.uiLength);
+        if (nullptr != stArg.pData)
+        {
+            memcpy(pPos, stArg.pData, stArg.uiLength);
+            pPos += stArg.uiLength;
+        }
+        else
+        {
+            if (stArg.bNegative)
+            {
+                *pPos++ = '-';
+            }
+            pPos = WriteInteger(pPos, stArg.ullInteger, stArg.uiLength - (stArg.bNegative ? 1 : 0));
+        }
+        *pPos++ = '\r';
+        *pPos++ = '\n';
+    }
+    pBuff->AdvanceWriteIndex(uiLength);
+    return(CODEC_STATUS_OK);
+}
+
+void RespCmd::ToRedisMsg(RedisReply& oRedisMsg) const
+{
+    oRedisMsg.set_type(REDIS_REPLY_ARRAY);
+    oRedisMsg.mutable_element()->Reserve(m_uiArgNum);
+    for (uint32 i = 0; i < m_uiArgNum; ++i)
+    {
+        auto pElement = oRedisMsg.add_element();
+        pElement->set_type(REDIS_REPLY_STRING);
+        const tagArg& stArg = GetArg(i);
+        if (nullptr != stArg.pData)
+        {
+            pElement->set_str(stArg.pData, stArg.uiLength);
+        }
+        else
+        {
+            pElement->set_str(GetArgString(i));
+        }
+    }
+}
+
+std::string RespCmd::ToString() const
+{
+    std::string strCmd;
+    for (uint32 i = 0; i < m_uiArgNum; ++i)
+    {
+        if (i > 0)
+        {
+            strCmd.append(" ");
+        }
+        strCmd.append(GetArgString(i));
+    }
+    return(strCmd);
+}
+
+uint32 RespCmd::Digits(uint64 ullValue)
+{
+    uint32 uiDigits = 1;
+    while (ullValue >= 10)
+    {
+        ullValue /= 10;
+        ++uiDigits;
+    }
+    return(uiDigits);
+}
+
+char* RespCmd::WriteInteger(char* pPos, uint64 ullValue, uint32 uiDigits)
+{
+    char* pEnd = pPos + uiDigits;
+    char* pDigit = pEnd;
+    do
+    {
+        *--pDigit = '0' + (ullValue % 10);
+        ullValue /= 10;
+    } while (pDigit > pPos);
+    return(pEnd);
+}
+
+char* RespCmd::WriteLength(char* pPos, char cType, uint64 ullLength)
+{
+    *pPos++ = cType;
+    pPos = WriteInteger(pPos, ullLength, Digits(ullLength));
+    *pPos++ = '\r';
+    *pPos++ = '\n';
+    return(pPos);
+}
+
+} /* namespace neb */
@@ -0,0 +1,153 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     RespCmd.hpp
+ * @brief    redis请求命令构造
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note     RespCmd只记录命令各参数的位置和长度（整数参数记录数值），不复制参数
+ * 内容，发送时直接按RESP格式写入连接的发送缓冲区，不再先构造RedisReply消息再逐
+ * 元素序列化。不超过sc_uiInlineArgNum个参数的命令构造和编码都不分配内存。
+ * Modify history:
+ ******************************************************************************/
+#ifndef SRC_CODEC_RESPCMD_HPP_
+#define SRC_CODEC_RESPCMD_HPP_
+
+#include <string>
+#include <vector>
+#include <type_traits>
+#include "util/CBuffer.hpp"
+#include "Codec.hpp"
+#include "pb/redis.pb.h"
+
+namespace neb
+{
+
+/**
+ * @brief redis请求命令
+ * @note 参数引用调用方的数据，RespCmd只在构造所在的调用栈内使用，发送（编码进发送
+ * 缓冲区）之前参数不可修改或释放。例：
+ *     Actor::SendTo(strIdentify, RespCmd("HSET", strKey, strField, strValue));
+ *     Actor::SendTo(strIdentify, RespCmd("EXPIRE", strKey, 3600));
+ * pipeline批量发送用std::vector<RespCmd>，每条命令各对应一个响应。
+ */
+class RespCmd
+{
+public:
+    struct tagArg
+    {
+        const char* pData = nullptr;    ///< 字符串参数，整数参数为nullptr
+        size_t uiLength = 0;            ///< 字符串参数的长度，整数参数的十进制位数（含负号）
+        uint64 ullInteger = 0;          ///< 整数参数的绝对值
+        bool bNegative = false;
+    };
+
+public:
+    RespCmd();
+
+    /**
+     * @brief 以命令和参数构造
+     * @note 参数可以是const char*（以'\0'结尾）、std::string和整数类型，二进制
+     * 数据用Append(pData, uiLength)追加。
+     */
+    template <typename T, typename ...Targs,
+             typename = typename std::enable_if<!std::is_same<typename std::decay<T>::type, RespCmd>::value>::type>
+    explicit RespCmd(const T& oCmd, const Targs&... args)
+        : RespCmd()
+    {
+        AppendArgs(oCmd, args...);
+    }
+
+    RespCmd(const RespCmd&) = default;
+    RespCmd& operator=(const RespCmd&) = default;
+    virtual ~RespCmd();
+
+    RespCmd& Append(const char* szArg);
+    RespCmd& Append(const char* pData, size_t uiLength);
+    RespCmd& Append(const std::string& strArg);
+
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, RespCmd&>::type
+    Append(T tInteger)
+    {
+        tagArg stArg;
+        if (tInteger < 0)
+        {
+            stArg.bNegative = true;
+            stArg.ullInteger = 0 - (uint64)tInteger;
+        }
+        else
+        {
+            stArg.ullInteger = (uint64)tInteger;
+        }
+        stArg.uiLength = Digits(stArg.ullInteger) + (stArg.bNegative ? 1 : 0);
+        return(AppendArg(stArg));
+    }
+
+    /**
+     * @brief 清空参数，之后可重新构造一条命令
+     */
+    void Clear();
+
+    uint32 GetArgNum() const
+    {
+        return(m_uiArgNum);
+    }
+
+    const tagArg& GetArg(uint32 uiIndex) const
+    {
+        return((uiIndex < sc_uiInlineArgNum) ? m_aArg[uiIndex] : m_vecExtraArg[uiIndex - sc_uiInlineArgNum]);
+    }
+
+    /**
+     * @brief 第uiIndex个参数的字符串形式
+     */
+    std::string GetArgString(uint32 uiIndex) const;
+
+    /**
+     * @brief 编码后的长度
+     */
+    size_t GetEncodedLength() const;
+
+    /**
+     * @brief 按RESP数组格式写入pBuff
+     * @note 一次预留整条命令所需空间后逐段拷贝，整数参数直接格式化到pBuff中。
+     */
+    E_CODEC_STATUS Encode(CBuffer* pBuff) const;
+
+    /**
+     * @brief 转换为RedisMsg（需要保存请求以便重试或重定向时使用）
+     */
+    void ToRedisMsg(RedisReply& oRedisMsg) const;
+
+    std::string ToString() const;
+
+    static const uint32 sc_uiInlineArgNum = 16;       ///< 不超过此参数个数时不分配内存
+
+protected:
+    static uint32 Digits(uint64 ullValue);
+    static char* WriteInteger(char* pPos, uint64 ullValue, uint32 uiDigits);
+    static char* WriteLength(char* pPos, char cType, uint64 ullLength);
+
+private:
+    RespCmd& AppendArg(const tagArg& stArg);
+
+    void AppendArgs()
+    {
+    }
+
+    template <typename T, typename ...Targs>
+    void AppendArgs(const T& oArg, const Targs&... args)
+    {
+        Append(oArg);
+        AppendArgs(args...);
+    }
+
+private:
+    uint32 m_uiArgNum;
+    tagArg m_aArg[sc_uiInlineArgNum];
+    std::vector<tagArg> m_vecExtraArg;      ///< 超出sc_uiInlineArgNum的参数
+};
+
+} /* namespace neb */
+
+#endif /* SRC_CODEC_RESPCMD_HPP_ */
@@ -0,0 +1,356 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     RespView.cpp
+ * @brief    RESP响应的零拷贝视图
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note
+ * Modify history:
+ ******************************************************************************/
+#include <cstring>
+#include <cstdlib>
+#include "RespView.hpp"
+
+namespace neb
+{
+
+const uint32 RespView::sc_uiMaxDepth;
+const int64 RespView::sc_llMaxBulkLength;
+
+/**
+ * @brief 查找行尾
+ * @return 行尾"\r\n"中'\r'的位置；数据不完整返回nullptr，pbError置为false；
+ * 格式错误（单独出现'\n'）返回nullptr，pbError置为true
+ */
+static inline const char* FindLineEnd(const char* pData, const char* pEnd, bool& bError)
+{
+    const char* pLf = (const char*)memchr(pData, '\n', pEnd - pData);
+    if (nullptr == pLf)
+    {
+        bError = false;
+        return(nullptr);
+    }
+    if (pLf == pData || *(pLf - 1) != '\r')
+    {
+        bError = true;
+        return(nullptr);
+    }
+    return(pLf - 1);
+}
+
+/**
+ * @brief 严格解析十进制整数（可带负号，不允许空串和其他字符）
+ */
+static inline bool ParseInteger(const char* pData, const char* pEnd, int64& llValue)
+{
+    bool bNegative = false;
+    if (pData < pEnd && '-' == *pData)
+    {
+        bNegative = true;
+        ++pData;
+    }
+    if (pData == pEnd || pEnd - pData > 19)
+    {
+        return(false);
+    }
+    uint64 ullValue = 0;
+    for (; pData < pEnd; ++pData)
+    {
+        if (*pData < '0' || *pData > '9')
+        {
+            return(false);
+        }
+        ullValue = ullValue * 10 + (*pData - '0');
+    }
+    if (ullValue > (uint64)INT64_MAX + (bNegative ? 1 : 0))
+    {
+        return(false);
+    }
+    llValue = bNegative ? (int64)(0 - ullValue) : (int64)ullValue;
+    return(true);
+}
+
+E_CODEC_STATUS RespView::Parse(const char* pData, size_t uiSize, RespView& oView)
+{
+    if (0 == uiSize)
+    {
+        return(CODEC_STATUS_PAUSE);
+    }
+    return(ParseFrame(pData, pData + uiSize, oView, 0));
+}
+
+E_CODEC_STATUS RespView::ParseFrame(const char* pData, const char* pEnd, RespView& oView, uint32 uiDepth)
+{
+    if (pData >= pEnd)
+    {
+        return(CODEC_STATUS_PAUSE);
+    }
+    if (uiDepth > sc_uiMaxDepth)
+    {
+        return(CODEC_STATUS_ERR);
+    }
+    bool bError = false;
+    const char* pLineEnd = FindLineEnd(pData + 1, pEnd, bError);
+    if (nullptr == pLineEnd)
+    {
+        return(bError ? CODEC_STATUS_ERR : CODEC_STATUS_PAUSE);
+    }
+    const char* pLine = pData + 1;
+    const char* pNext = pLineEnd + 2;
+    oView.m_pFrame = pData;
+    oView.m_ucType = (uint8)pData[0];
+    oView.m_pData = pLine;
+    oView.m_uiDataLen = 0;
+    oView.m_llInteger = 0;
+    switch (pData[0])
+    {
+        case RESP_TYPE_SIMPLE_STRING:
+        case RESP_TYPE_ERROR:
+        case RESP_TYPE_BIG_NUMBER:
+        case RESP_TYPE_DOUBLE:
+            oView.m_uiDataLen = pLineEnd - pLine;
+            break;
+        case RESP_TYPE_INTEGER:
+            if (!ParseInteger(pLine, pLineEnd, oView.m_llInteger))
+            {
+                return(CODEC_STATUS_ERR);
+            }
+            break;
+        case RESP_TYPE_BOOLEAN:
+            if (pLineEnd - pLine != 1 || ('t' != *pLine && 'f' != *pLine))
+            {
+                return(CODEC_STATUS_ERR);
+            }
+            oView.m_llInteger = ('t' == *pLine) ? 1 : 0;
+            break;
+        case RESP_TYPE_NULL:
+            if (pLineEnd != pLine)
+            {
+                return(CODEC_STATUS_ERR);
+            }
+            break;
+        case RESP_TYPE_BULK_STRING:
+        case RESP_TYPE_BLOB_ERROR:
+        case RESP_TYPE_VERBATIM_STRING:
+        {
+            int64 llLength = 0;
+            if (!ParseInteger(pLine, pLineEnd, llLength))
+            {
+                return(CODEC_STATUS_ERR);
+            }
+            if (-1 == llLength && RESP_TYPE_BULK_STRING == pData[0])   // RESP2 null bulk string
+            {
+                oView.m_ucType = RESP_TYPE_NULL;
+                break;
+            }
+            if (llLength < 0 || llLength > sc_llMaxBulkLength)
+            {
+                return(CODEC_STATUS_ERR);
+            }
+            if (pEnd - pNext < llLength + 2)
+            {
+                return(CODEC_STATUS_PAUSE);
+            }
+            if (pNext[llLength] != '\r' || pNext[llLength + 1] != '\n')
+            {
+                return(CODEC_STATUS_ERR);
+            }
+            oView.m_pData = pNext;
+            oView.m_uiDataLen = (size_t)llLength;
+            if (RESP_TYPE_VERBATIM_STRING == pData[0])
+            {
+                if (llLength < 4 || ':' != pNext[3])
+                {
+                    return(CODEC_STATUS_ERR);
+                }
+                oView.m_pData += 4;
+                oView.m_uiDataLen -= 4;
+            }
+            pNext += llLength + 2;
+        }
+            break;
+        case RESP_TYPE_ARRAY:
+        case RESP_TYPE_SET:
+        case RESP_TYPE_PUSH:
+        case RESP_TYPE_MAP:
+        case RESP_TYPE_ATTRIBUTE:
+        {
+            int64 llCount = 0;
+            if (!ParseInteger(pLine, pLineEnd, llCount))
+            {
+                return(CODEC_STATUS_ERR);
+            }
+            if (-1 == llCount && RESP_TYPE_ARRAY == pData[0])   // RESP2 null array
+            {
+                oView.m_ucType = RESP_TYPE_NULL;
+                break;
+            }
+            if (llCount < 0 || llCount > INT32_MAX)
+            {
+                return(CODEC_STATUS_ERR);
+            }
+            if (RESP_TYPE_MAP == pData[0] || RESP_TYPE_ATTRIBUTE == pData[0])
+            {
+                llCount *= 2;
+            }
+            // 每个元素至少3字节（如"_\r\n"），剩余数据不够时不必逐个解析
+            if ((pEnd - pNext) / 3 < llCount)
+            {
+                return(CODEC_STATUS_PAUSE);
+            }
+            oView.m_pData = pNext;
+            oView.m_llInteger = llCount;
+            RespView oElement;
+            for (int64 i = 0; i < llCount; ++i)
+            {
+                E_CODEC_STATUS eStatus = ParseFrame(pNext, pEnd, oElement, uiDepth + 1);
+                if (CODEC_STATUS_OK != eStatus)
+                {
+                    return(eStatus);
+                }
+                pNext += oElement.m_uiFrameLen;
+            }
+            if (RESP_TYPE_ATTRIBUTE == pData[0])
+            {
+                // attribute之后紧跟真正的值，视图取该值，帧包含attribute
+                E_CODEC_STATUS eStatus = ParseFrame(pNext, pEnd, oView, uiDepth);
+                if (CODEC_STATUS_OK != eStatus)
+                {
+                    return(eStatus);
+                }
+                if (RESP_TYPE_ATTRIBUTE == pNext[0])
+                {
+                    return(CODEC_STATUS_ERR);
+                }
+                oView.m_pFrame = pData;
+                oView.m_uiFrameLen += (pNext - pData);
+                return(CODEC_STATUS_OK);
+            }
+        }
+            break;
+        default:    // 含流式字符串和流式聚合类型的'?'长度，均不支持
+            return(CODEC_STATUS_ERR);
+    }
+    oView.m_uiFrameLen = pNext - pData;
+    return(CODEC_STATUS_OK);
+}
+
+bool RespView::Iterator::Next(RespView& oElement)
+{
+    if (m_llRemain <= 0)
+    {
+        return(false);
+    }
+    // 整帧已在Parse()时校验过，这里不会失败
+    if (CODEC_STATUS_OK != RespView::ParseFrame(m_pPos, m_pEnd, oElement, 0))
+    {
+        m_llRemain = 0;
+        return(false);
+    }
+    m_pPos += oElement.m_uiFrameLen;
+    --m_llRemain;
+    return(true);
+}
+
+bool RespView::Equals(const char* szValue) const
+{
+    size_t uiLength = strlen(szValue);
+    return(uiLength == m_uiDataLen && 0 == memcmp(m_pData, szValue, uiLength));
+}
+
+double RespView::Double() const
+{
+    if (RESP_TYPE_DOUBLE != m_ucType && RESP_TYPE_BIG_NUMBER != m_ucType)
+    {
+        return((double)m_llInteger);
+    }
+    char szDouble[64] = {0};
+    size_t uiLength = (m_uiDataLen < sizeof(szDouble) - 1) ? m_uiDataLen : sizeof(szDouble) - 1;
+    memcpy(szDouble, m_pData, uiLength);
+    return(strtod(szDouble, nullptr));     // 可解析inf、-inf、nan
+}
+
+std::string RespView::GetVerbatimFormat() const
+{
+    if (RESP_TYPE_VERBATIM_STRING != m_ucType)
+    {
+        return("");
+    }
+    return(std::string(m_pData - 4, 3));
+}
+
+bool RespView::GetAttribute(RespView& oAttribute) const
+{
+    if (nullptr == m_pFrame || RESP_TYPE_ATTRIBUTE != m_pFrame[0])
+    {
+        return(false);
+    }
+    // attribute按map解析（不再跟随其后的值）
+    oAttribute = RespView();
+    bool bError = false;
+    const char* pLineEnd = FindLineEnd(m_pFrame + 1, m_pFrame + m_uiFrameLen, bError);
+    int64 llCount = 0;
+    if (nullptr == pLineEnd || !ParseInteger(m_pFrame + 1, pLineEnd, llCount))
+    {
+        return(false);
+    }
+    oAttribute.m_pFrame = m_pFrame;
+    oAttribute.m_ucType = RESP_TYPE_MAP;
+    oAttribute.m_pData = pLineEnd + 2;
+    oAttribute.m_llInteger = llCount * 2;
+    oAttribute.m_uiFrameLen = m_uiFrameLen;
+    return(true);
+}
+
+bool RespView::ToRedisReply(RedisReply& oReply) const
+{
+    switch (m_ucType)
+    {
+        case RESP_TYPE_SIMPLE_STRING:
+            oReply.set_type(REDIS_REPLY_STATUS);
+            oReply.set_str(m_pData, m_uiDataLen);
+            return(true);
+        case RESP_TYPE_ERROR:
+        case RESP_TYPE_BLOB_ERROR:
+            oReply.set_type(REDIS_REPLY_ERROR);
+            oReply.set_str(m_pData, m_uiDataLen);
+            return(true);
+        case RESP_TYPE_INTEGER:
+        case RESP_TYPE_BOOLEAN:
+            oReply.set_type(REDIS_REPLY_INTEGER);
+            oReply.set_integer(m_llInteger);
+            return(true);
+        case RESP_TYPE_BULK_STRING:
+        case RESP_TYPE_VERBATIM_STRING:
+        case RESP_TYPE_DOUBLE:
+        case RESP_TYPE_BIG_NUMBER:
+            oReply.set_type(REDIS_REPLY_STRING);
+            oReply.set_str(m_pData, m_uiDataLen);
+            return(true);
+        case RESP_TYPE_NULL:
+            oReply.set_type(REDIS_REPLY_NIL);
+            return(true);
+        case RESP_TYPE_ARRAY:
+        case RESP_TYPE_SET:
+        case RESP_TYPE_PUSH:
+        case RESP_TYPE_MAP:
+        {
+            oReply.set_type(REDIS_REPLY_ARRAY);
+            oReply.mutable_element()->Reserve((int)m_llInteger);
+            RespView oElement;
+            Iterator oIter = Begin();
+            while (oIter.Next(oElement))
+            {
+                if (!oElement.ToRedisReply(*oReply.add_element()))
+                {
+                    return(false);
+                }
+            }
+            return(true);
+        }
+        default:
+            return(false);
+    }
+}
+
+} /* namespace neb */
@@ -0,0 +1,209 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     RespView.hpp
+ * @brief    RESP响应的零拷贝视图
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note     RespView不复制数据，只记录一个完整RESP帧在接收缓冲区中的位置。解析时
+ * 一次校验整帧（含所有嵌套元素）的完整性和格式，不分配内存；字符串取值直接指向
+ * 缓冲区，聚合类型的元素在遍历时才逐个解析。支持RESP2和RESP3的全部类型（流式
+ * 字符串和流式聚合类型除外）。需要与原有接口兼容时可以ToRedisReply()转换。
+ * Modify history:
+ ******************************************************************************/
+#ifndef SRC_CODEC_RESPVIEW_HPP_
+#define SRC_CODEC_RESPVIEW_HPP_
+
+#include <string>
+#include "Codec.hpp"
+#include "pb/redis.pb.h"
+
+namespace neb
+{
+
+/**
+ * @brief RESP帧的只读视图
+ * @note 视图引用接收缓冲区，只在框架回调期间有效，回调之外需要继续使用时须复制
+ * 所需的值或转换为RedisReply。
+ */
+class RespView
+{
+public:
+    /**
+     * @brief RESP类型，取值为类型首字节
+     */
+    enum E_RESP_TYPE
+    {
+        RESP_TYPE_UNDEFINE          = 0,
+        RESP_TYPE_SIMPLE_STRING     = '+',
+        RESP_TYPE_ERROR             = '-',
+        RESP_TYPE_INTEGER           = ':',
+        RESP_TYPE_BULK_STRING       = '$',
+        RESP_TYPE_ARRAY             = '*',
+        RESP_TYPE_NULL              = '_',      ///< RESP3的null，以及RESP2的$-1和*-1
+        RESP_TYPE_DOUBLE            = ',',
+        RESP_TYPE_BOOLEAN           = '#',
+        RESP_TYPE_BLOB_ERROR        = '!',
+        RESP_TYPE_VERBATIM_STRING   = '=',
+        RESP_TYPE_BIG_NUMBER        = '(',
+        RESP_TYPE_MAP               = '%',
+        RESP_TYPE_SET               = '~',
+        RESP_TYPE_ATTRIBUTE         = '|',      ///< 只作为其他类型的前缀出现，见GetAttribute()
+        RESP_TYPE_PUSH              = '>',
+    };
+
+    /**
+     * @brief 聚合类型的元素迭代器
+     * @note map和attribute的元素依次为key、value、key、value...
+     */
+    class Iterator
+    {
+    public:
+        Iterator() = default;
+
+        /**
+         * @brief 取下一个元素
+         * @return 已无元素时返回false
+         */
+        bool Next(RespView& oElement);
+
+    private:
+        Iterator(const char* pPos, const char* pEnd, int64 llRemain)
+            : m_pPos(pPos), m_pEnd(pEnd), m_llRemain(llRemain)
+        {
+        }
+
+        const char* m_pPos = nullptr;
+        const char* m_pEnd = nullptr;
+        int64 m_llRemain = 0;
+
+        friend class RespView;
+    };
+
+public:
+    RespView() = default;
+
+    /**
+     * @brief 解析pData起始的一个完整RESP帧
+     * @return CODEC_STATUS_OK 解析成功，帧长度为GetFrameLength()；
+     *         CODEC_STATUS_PAUSE 数据不完整；
+     *         CODEC_STATUS_ERR 格式错误
+     */
+    static E_CODEC_STATUS Parse(const char* pData, size_t uiSize, RespView& oView);
+
+    E_RESP_TYPE Type() const
+    {
+        return((E_RESP_TYPE)m_ucType);
+    }
+
+    /**
+     * @brief 整帧长度（含attribute前缀），解码后接收缓冲区前进此长度
+     */
+    size_t GetFrameLength() const
+    {
+        return(m_uiFrameLen);
+    }
+
+    bool IsNull() const
+    {
+        return(RESP_TYPE_NULL == m_ucType);
+    }
+
+    bool IsError() const
+    {
+        return(RESP_TYPE_ERROR == m_ucType || RESP_TYPE_BLOB_ERROR == m_ucType);
+    }
+
+    bool IsAggregate() const
+    {
+        return(RESP_TYPE_ARRAY == m_ucType || RESP_TYPE_MAP == m_ucType
+                || RESP_TYPE_SET == m_ucType || RESP_TYPE_PUSH == m_ucType);
+    }
+
+    /**
+     * @brief 字符串类（simple string、error、bulk string、blob error、verbatim string、
+     * double、big number）的内容，指向接收缓冲区，不以'\0'结尾
+     * @note verbatim string不含“txt:”之类的格式前缀，格式见GetVerbatimFormat()。
+     */
+    const char* Data() const
+    {
+        return(m_pData);
+    }
+
+    size_t Size() const
+    {
+        return(m_uiDataLen);
+    }
+
+    std::string Str() const
+    {
+        return(std::string(m_pData, m_uiDataLen));
+    }
+
+    bool Equals(const char* szValue) const;
+
+    /**
+     * @brief integer的值，boolean为0或1
+     */
+    int64 Integer() const
+    {
+        return(m_llInteger);
+    }
+
+    bool Boolean() const
+    {
+        return(m_llInteger != 0);
+    }
+
+    double Double() const;
+
+    /**
+     * @brief verbatim string的格式（如“txt”、“mkd”）
+     */
+    std::string GetVerbatimFormat() const;
+
+    /**
+     * @brief 聚合类型的元素个数，map为key和value的总数
+     */
+    uint32 ElementNum() const
+    {
+        return(IsAggregate() ? (uint32)m_llInteger : 0);
+    }
+
+    Iterator Begin() const
+    {
+        return(IsAggregate() ? Iterator(m_pData, m_pFrame + m_uiFrameLen, m_llInteger) : Iterator());
+    }
+
+    /**
+     * @brief 取帧前的attribute（RESP3）
+     * @return 无attribute时返回false
+     */
+    bool GetAttribute(RespView& oAttribute) const;
+
+    /**
+     * @brief 转换为RedisReply
+     * @note 在Clear()过的RedisReply上转换可复用其已分配的element和字符串。RESP3类型
+     * 映射到最接近的RedisReply类型：double、big number、verbatim string为
+     * REDIS_REPLY_STRING，boolean为REDIS_REPLY_INTEGER，blob error为REDIS_REPLY_ERROR，
+     * map（key和value依次排列）、set、push为REDIS_REPLY_ARRAY。
+     */
+    bool ToRedisReply(RedisReply& oReply) const;
+
+    static const uint32 sc_uiMaxDepth = 64;                         ///< 聚合类型最大嵌套层数
+    static const int64 sc_llMaxBulkLength = 512 * 1024 * 1024;      ///< 与redis的proto-max-bulk-len默认值一致
+
+private:
+    static E_CODEC_STATUS ParseFrame(const char* pData, const char* pEnd, RespView& oView, uint32 uiDepth);
+
+private:
+    const char* m_pFrame = nullptr;     ///< 帧起始（有attribute时为attribute起始）
+    const char* m_pData = nullptr;      ///< 字符串内容或聚合类型的首个元素
+    size_t m_uiFrameLen = 0;
+    size_t m_uiDataLen = 0;
+    int64 m_llInteger = 0;              ///< integer、boolean的值或聚合类型的元素个数
+    uint8 m_ucType = RESP_TYPE_UNDEFINE;
+};
+
+} /* namespace neb */
+
+#endif /* SRC_CODEC_RESPVIEW_HPP_ */
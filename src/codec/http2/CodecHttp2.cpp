@@ -8,6 +8,7 @@
  * Modify history:
  ******************************************************************************/
 #include "CodecHttp2.hpp"
+#include <algorithm>
 #include "Http2Stream.hpp"
 #include "Http2Frame.hpp"
 #include "Http2Header.hpp"
@@ -15,8 +16,12 @@
 namespace neb
 {
 
+const uint32 CodecHttp2::sc_uiWindowUpdateThreshold;
+
 CodecHttp2::CodecHttp2(std::shared_ptr<NetLogger> pLogger, E_CODEC_TYPE eCodecType)
-    : Codec(pLogger, eCodecType)
+    : Codec(pLogger, eCodecType),
+      m_oEncodingDynamicTable(DEFAULT_SETTINGS_HEADER_TABLE_SIZE, true),
+      m_oDecodingDynamicTable(DEFAULT_SETTINGS_HEADER_TABLE_SIZE, false)
 {
 #if __cplusplus >= 201401L
     m_pFrame = std::make_unique<Http2Frame>(pLogger, eCodecType);
@@ -27,8 +32,6 @@ CodecHttp2::CodecHttp2(std::shared_ptr<NetLogger> pLogger, E_CODEC_TYPE eCodecTy
 
 CodecHttp2::~CodecHttp2()
 {
-    ReleaseStreamWeight(m_pStreamWeight);
-    m_pStreamWeight = nullptr;
     for (auto iter = m_mapStream.begin(); iter != m_mapStream.end(); ++iter)
     {
         delete iter->second;
@@ -54,19 +57,22 @@ E_CODEC_STATUS CodecHttp2::Encode(const HttpMsg& oHttpMsg, CBuffer* pBuff)
 E_CODEC_STATUS CodecHttp2::Decode(CBuffer* pBuff, HttpMsg& oHttpMsg, CBuffer* pReactBuff)
 {
     LOG4_TRACE("pBuff->ReadableBytes() = %u", pBuff->ReadableBytes());
-    if (pBuff->ReadableBytes() <= H2_FRAME_HEAD_SIZE)
+    if (pBuff->ReadableBytes() < H2_FRAME_HEAD_SIZE)
     {
         return(CODEC_STATUS_PAUSE);
     }
 
     int iReadIdx = pBuff->GetReadIndex();
-    pBuff->Read(&m_stFrameHead.uiLength, 3);
-    pBuff->Read(&m_stFrameHead.ucType, 1);
-    pBuff->Read(&m_stFrameHead.ucFlag, 1);
-    pBuff->Read(&m_stFrameHead.uiStreamIdentifier, 4);
-    m_stFrameHead.cR = (m_stFrameHead.uiStreamIdentifier & H2_DATA_MASK_4_BYTE_HIGHEST_BIT) >> 31;
-    m_stFrameHead.uiLength = ntohl(m_stFrameHead.uiLength);
-    m_stFrameHead.uiStreamIdentifier = ntohl(m_stFrameHead.uiStreamIdentifier & H2_DATA_MASK_4_BYTE_LOW_31_BIT);
+    const uint8* pHead = (const uint8*)pBuff->GetRawReadBuffer();
+    m_stFrameHead.uiLength = ((uint32)pHead[0] << 16) | ((uint32)pHead[1] << 8) | (uint32)pHead[2];
+    m_stFrameHead.ucType = pHead[3];
+    m_stFrameHead.ucFlag = pHead[4];
+    uint32 uiIdentifier = 0;
+    memcpy(&uiIdentifier, pHead + 5, 4);
+    uiIdentifier = ntohl(uiIdentifier);
+    m_stFrameHead.cR = (uiIdentifier & H2_DATA_MASK_4_BYTE_HIGHEST_BIT) >> 31;
+    m_stFrameHead.uiStreamIdentifier = uiIdentifier & H2_DATA_MASK_4_BYTE_LOW_31_BIT;
+    pBuff->AdvanceReadIndex(H2_FRAME_HEAD_SIZE);
     if (m_stFrameHead.uiLength > m_uiSettingsMaxFrameSize)
     {
         SetErrno(H2_ERR_FRAME_SIZE_ERROR);
@@ -129,6 +135,7 @@ E_CODEC_STATUS CodecHttp2::Decode(CBuffer* pBuff, HttpMsg& oHttpMsg, CBuffer* pR
             {
                 m_pCodingStream = new Http2Stream(m_pLogger, GetCodecType());
                 m_mapStream.insert(std::make_pair(m_stFrameHead.uiStreamIdentifier, m_pCodingStream));
+                m_oWriteScheduler.Add(m_stFrameHead.uiStreamIdentifier);
             }
             catch(std::bad_alloc& e)
             {
@@ -150,118 +157,26 @@ E_CODEC_STATUS CodecHttp2::Decode(CBuffer* pBuff, HttpMsg& oHttpMsg, CBuffer* pR
 
 void CodecHttp2::SetPriority(uint32 uiStreamId, const tagPriority& stPriority)
 {
-    if (m_pStreamWeight == nullptr)
+    // 只采用权重，依赖关系已被rfc9113废弃，客户端普遍不再发送或发送的依赖树并不可靠
+    if (m_mapStream.find(uiStreamId) == m_mapStream.end())
     {
-        try
-        {
-            m_pStreamWeight = new TreeNode<tagStreamWeight>();
-            m_pStreamWeight->pData = new tagStreamWeight();
-            m_pStreamWeight->pData->uiStreamId = stPriority.uiDependency;
-            m_pStreamWeight->pFirstChild = new TreeNode<tagStreamWeight>();
-            m_pStreamWeight->pFirstChild->pData = new tagStreamWeight();
-            m_pStreamWeight->pFirstChild->pData->uiStreamId = uiStreamId;
-            m_pStreamWeight->pFirstChild->pData->ucWeight = stPriority.ucWeight;
-            m_pStreamWeight->pFirstChild->pParent = m_pStreamWeight;
-        }
-        catch(std::bad_alloc& e)
-        {
-            LOG4_ERROR("%s", e.what());
-            return;
-        }
+        return;     // 对端可以对任意流ID发送PRIORITY，不为未打开的流保留状态
     }
+    m_oWriteScheduler.SetWeight(uiStreamId, (uint32)stPriority.ucWeight + 1);
+}
 
-    auto pCurrentStreamWeight = FindStreamWeight(uiStreamId, m_pStreamWeight);
-    if (pCurrentStreamWeight == nullptr)
-    {
-        try
-        {
-            pCurrentStreamWeight = new TreeNode<tagStreamWeight>();
-            pCurrentStreamWeight->pData = new tagStreamWeight();
-            pCurrentStreamWeight->pData->uiStreamId = uiStreamId;
-            pCurrentStreamWeight->pData->ucWeight = stPriority.ucWeight;
-        }
-        catch(std::bad_alloc& e)
-        {
-            LOG4_ERROR("%s", e.what());
-            return;
-        }
-    }
-    if (pCurrentStreamWeight->pParent != nullptr)
-    {
-        if (pCurrentStreamWeight->pParent->pFirstChild == pCurrentStreamWeight)
-        {
-            pCurrentStreamWeight->pParent->pFirstChild = pCurrentStreamWeight->pRightBrother;
-        }
-        else
-        {
-            auto pLast = pCurrentStreamWeight->pParent->pFirstChild;
-            while (pLast->pRightBrother != pCurrentStreamWeight)
-            {
-                pLast = pLast->pRightBrother;
-            }
-            pLast->pRightBrother = pCurrentStreamWeight->pRightBrother;
-        }
-    }
-    auto pDependencyStreamWeight = FindStreamWeight(stPriority.uiDependency, m_pStreamWeight);
-    if (pDependencyStreamWeight == nullptr)
-    {
-        pCurrentStreamWeight->pRightBrother = m_pStreamWeight->pRightBrother;
-        m_pStreamWeight->pRightBrother = pCurrentStreamWeight;
-    }
-    else
-    {
-        if (stPriority.E)
-        {
-            pCurrentStreamWeight->pFirstChild = pDependencyStreamWeight->pFirstChild;
-        }
-        else
-        {
-            pCurrentStreamWeight->pRightBrother = pDependencyStreamWeight->pFirstChild;
-        }
-        pDependencyStreamWeight->pFirstChild = pCurrentStreamWeight;
-        pCurrentStreamWeight->pParent = pDependencyStreamWeight;
-    }
+void CodecHttp2::DropPendingData(uint32 uiStreamId)
+{
+    m_oWriteScheduler.Remove(uiStreamId);
 }
 
 void CodecHttp2::RstStream(uint32 uiStreamId)
 {
+    m_oWriteScheduler.Remove(uiStreamId);
+    m_mapRecvWindowConsumed.erase(uiStreamId);
     auto iter = m_mapStream.find(uiStreamId);
     if (iter != m_mapStream.end())
     {
-        auto pStreamWeight = FindStreamWeight(uiStreamId, m_pStreamWeight);
-        if (pStreamWeight != nullptr)
-        {
-            auto pParent = pStreamWeight->pParent;
-            if (pParent != nullptr)
-            {
-                if (pParent->pFirstChild == pStreamWeight)
-                {
-                    if (pStreamWeight->pFirstChild != nullptr)
-                    {
-                        pParent->pFirstChild = pStreamWeight->pFirstChild;
-                    }
-                    else
-                    {
-                        pParent->pFirstChild = pStreamWeight->pRightBrother;
-                    }
-                }
-                else
-                {
-                    auto pBrother = pParent->pFirstChild;
-                    while (pBrother->pRightBrother != pStreamWeight)
-                    {
-                        pBrother = pBrother->pRightBrother;
-                    }
-                    pBrother->pRightBrother = pStreamWeight->pRightBrother;
-                }
-                delete pStreamWeight;
-            }
-        }
-        else
-        {
-            // TODO?
-        }
-
         if (iter->second == m_pCodingStream)
         {
             m_pCodingStream = nullptr;
@@ -279,9 +194,14 @@ E_H2_ERR_CODE CodecHttp2::Setting(const std::vector<tagSetting>& vecSetting)
         switch (vecSetting[i].unIdentifier)
         {
             case H2_SETTINGS_HEADER_TABLE_SIZE:
-                if (vecSetting[i].uiValue <= SETTINGS_MAX_FRAME_SIZE)
+                m_uiSettingsHeaderTableSize = vecSetting[i].uiValue;
+                // 编码动态表不超过对端解码动态表的上限，对端放大上限时仍以默认值为限
+                if (std::min(m_uiSettingsHeaderTableSize, DEFAULT_SETTINGS_HEADER_TABLE_SIZE)
+                        != m_oEncodingDynamicTable.GetMaxSize())
                 {
-                    m_uiSettingsHeaderTableSize = vecSetting[i].uiValue;
+                    m_oEncodingDynamicTable.SetMaxSize(
+                            std::min(m_uiSettingsHeaderTableSize, DEFAULT_SETTINGS_HEADER_TABLE_SIZE));
+                    m_bEncodingTableSizeChanged = true;
                 }
                 break;
             case H2_SETTINGS_ENABLE_PUSH:
@@ -298,7 +218,8 @@ E_H2_ERR_CODE CodecHttp2::Setting(const std::vector<tagSetting>& vecSetting)
                 m_uiSettingsMaxConcurrentStreams = vecSetting[i].uiValue;
                 break;
             case H2_SETTINGS_INITIAL_WINDOW_SIZE:
-                if (vecSetting[i].uiValue <= SETTINGS_MAX_INITIAL_WINDOW_SIZE)
+                if (vecSetting[i].uiValue <= SETTINGS_MAX_INITIAL_WINDOW_SIZE
+                        && m_oWriteScheduler.SetInitialWindowSize(vecSetting[i].uiValue))
                 {
                     m_uiSettingsMaxWindowSize = vecSetting[i].uiValue;
                 }
@@ -327,9 +248,59 @@ E_H2_ERR_CODE CodecHttp2::Setting(const std::vector<tagSetting>& vecSetting)
     return(H2_ERR_NO_ERROR);
 }
 
-void CodecHttp2::WindowUpdate(uint32 uiStreamId, uint32 uiIncrement)
+bool CodecHttp2::WindowUpdate(uint32 uiStreamId, uint32 uiIncrement)
+{
+    if (uiStreamId > 0 && m_mapStream.find(uiStreamId) == m_mapStream.end())
+    {
+        return(true);   // 已关闭的流可能仍会收到WINDOW_UPDATE，忽略
+    }
+    return(m_oWriteScheduler.UpdateWindow(uiStreamId, uiIncrement));
+}
+
+bool CodecHttp2::ConsumeRecvWindow(const tagH2FrameHead& stFrameHead, CBuffer* pReactBuff)
+{
+    if (stFrameHead.uiLength == 0)
+    {
+        return(true);
+    }
+    m_uiRecvWindowConsumed += stFrameHead.uiLength;
+    if (m_uiRecvWindowConsumed > DEFAULT_SETTINGS_MAX_INITIAL_WINDOW_SIZE)
+    {
+        return(false);
+    }
+    // 累计消耗达到窗口的一半才发一个WINDOW_UPDATE，而不是每个DATA帧回一个
+    if (m_uiRecvWindowConsumed >= sc_uiWindowUpdateThreshold)
+    {
+        m_pFrame->EncodeWindowUpdate(this, 0, m_uiRecvWindowConsumed, pReactBuff);
+        m_uiRecvWindowConsumed = 0;
+    }
+
+    uint32& uiStreamConsumed = m_mapRecvWindowConsumed[stFrameHead.uiStreamIdentifier];
+    uiStreamConsumed += stFrameHead.uiLength;
+    if (uiStreamConsumed > DEFAULT_SETTINGS_MAX_INITIAL_WINDOW_SIZE)
+    {
+        return(false);
+    }
+    if (H2_FRAME_FLAG_END_STREAM & stFrameHead.ucFlag)
+    {
+        m_mapRecvWindowConsumed.erase(stFrameHead.uiStreamIdentifier);  // 对端不会再发送DATA，无须更新流窗口
+    }
+    else if (uiStreamConsumed >= sc_uiWindowUpdateThreshold)
+    {
+        m_pFrame->EncodeWindowUpdate(this, stFrameHead.uiStreamIdentifier, uiStreamConsumed, pReactBuff);
+        uiStreamConsumed = 0;
+    }
+    return(true);
+}
+
+void CodecHttp2::SendData(uint32 uiStreamId, const std::string& strData, bool bEndStream)
+{
+    m_oWriteScheduler.Push(uiStreamId, strData.data(), strData.size(), bEndStream);
+}
+
+size_t CodecHttp2::FlushData(CBuffer* pBuff, size_t uiMaxBytes)
 {
-    // TODO window update
+    return(m_oWriteScheduler.Flush(m_uiSettingsMaxFrameSize, uiMaxBytes, pBuff));
 }
 
 E_CODEC_STATUS CodecHttp2::UnpackHeader(uint32 uiHeaderBlockEndPos, CBuffer* pBuff, HttpMsg& oHttpMsg)
@@ -366,8 +337,21 @@ E_CODEC_STATUS CodecHttp2::UnpackHeader(uint32 uiHeaderBlockEndPos, CBuffer* pBu
                 return(eStatus);
             }
             pHeader->insert({strHeaderName, strHeaderValue});
-            //UpdateDecodingDynamicTable(iDynamicTableIndex, strHeaderName, strHeaderValue);
-            UpdateDecodingDynamicTable(-1, strHeaderName, strHeaderValue);
+            m_oDecodingDynamicTable.Add(strHeaderName, strHeaderValue);
+        }
+        else if (H2_HPACK_CONDITION_DYNAMIC_TABLE_SIZE_UPDATE & B)    // 001xxxxx，须先于0001xxxx判断
+        {
+            uint32 uiTableSize = (uint32)Http2Header::DecodeInt(H2_HPACK_PREFIX_5_BITS, pBuff);
+            // 本端未通过SETTINGS修改SETTINGS_HEADER_TABLE_SIZE，上限为初始值
+            if (uiTableSize > DEFAULT_SETTINGS_HEADER_TABLE_SIZE)
+            {
+                SetErrno(H2_ERR_COMPRESSION_ERROR);
+                LOG4_ERROR("The new maximum size MUST be lower than or equal to "
+                        "the limit(SETTINGS_HEADER_TABLE_SIZE) determined by the"
+                        " protocol using HPACK!");
+                return(CODEC_STATUS_ERR);
+            }
+            m_oDecodingDynamicTable.SetMaxSize(uiTableSize);
         }
         else if (H2_HPACK_CONDITION_LITERAL_HEADER_NEVER_INDEXED & B)
         {
@@ -381,20 +365,6 @@ E_CODEC_STATUS CodecHttp2::UnpackHeader(uint32 uiHeaderBlockEndPos, CBuffer* pBu
             pHeader->insert({strHeaderName, strHeaderValue});
             oHttpMsg.add_adding_never_index_headers(strHeaderName);
         }
-        else if (H2_HPACK_CONDITION_DYNAMIC_TABLE_SIZE_UPDATE & B)
-        {
-            uint32 uiTableSize = (uint32)Http2Header::DecodeInt(H2_HPACK_PREFIX_5_BITS, pBuff);
-            if (uiTableSize > m_uiSettingsHeaderTableSize)
-            {
-                SetErrno(H2_ERR_COMPRESSION_ERROR);
-                LOG4_ERROR("The new maximum size MUST be lower than or equal to "
-                        "the limit(SETTINGS_HEADER_TABLE_SIZE) determined by the"
-                        " protocol using HPACK!");
-                return(CODEC_STATUS_ERR);
-            }
-            pHeader->insert({strHeaderName, strHeaderValue});
-            UpdateDecodingDynamicTable(uiTableSize);
-        }
         else    // H2_HPACK_CONDITION_LITERAL_HEADER_WITHOUT_INDEXING
         {
             eStatus = UnpackHeaderLiteralIndexing(pBuff, B,
@@ -418,25 +388,27 @@ void CodecHttp2::PackHeader(const HttpMsg& oHttpMsg, CBuffer* pBuff)
 
     if (oHttpMsg.dynamic_table_update_size() > 0)
     {
-        if (oHttpMsg.dynamic_table_update_size() > SETTINGS_MAX_FRAME_SIZE)
+        if (oHttpMsg.dynamic_table_update_size() > m_uiSettingsHeaderTableSize)
         {
             LOG4_WARNING("invalid dynamic table update size %u, the size must smaller than %u.",
-                    oHttpMsg.dynamic_table_update_size(), SETTINGS_MAX_FRAME_SIZE);
+                    oHttpMsg.dynamic_table_update_size(), m_uiSettingsHeaderTableSize);
         }
         else
         {
-            PackHeaderDynamicTableSize(oHttpMsg.dynamic_table_update_size(), pBuff);
+            m_oEncodingDynamicTable.SetMaxSize(oHttpMsg.dynamic_table_update_size());
+            m_bEncodingTableSizeChanged = true;
         }
     }
+    if (m_bEncodingTableSizeChanged)
+    {
+        PackHeaderDynamicTableSize(m_oEncodingDynamicTable.GetMaxSize(), pBuff);
+        m_bEncodingTableSizeChanged = false;
+    }
 
     for (auto c_iter = oHttpMsg.headers().begin();
             c_iter != oHttpMsg.headers().end(); ++c_iter)
     {
-        uiTableIndex = Http2Header::GetStaticTableIndex(c_iter->first, c_iter->second);
-        if (uiTableIndex == 0)
-        {
-            uiTableIndex = GetEncodingTableIndex(c_iter->first, c_iter->second);
-        }
+        uiTableIndex = GetEncodingTableIndex(c_iter->first, c_iter->second);
         if (uiTableIndex > 0)
         {
             PackHeaderIndexed(uiTableIndex, pBuff);
@@ -488,6 +460,7 @@ E_CODEC_STATUS CodecHttp2::PromiseStream(uint32 uiStreamId, CBuffer* pReactBuff)
         pPromiseStream = new Http2Stream(m_pLogger, GetCodecType());
         pPromiseStream->SetState(H2_STREAM_RESERVED_REMOTE);
         m_mapStream.insert(std::make_pair(uiStreamId, pPromiseStream));
+        m_oWriteScheduler.Add(uiStreamId);
     }
     catch(std::bad_alloc& e)
     {
@@ -524,43 +497,6 @@ uint32 CodecHttp2::StreamIdGenerate()
     return(m_uiStreamIdGenerate);
 }
 
-TreeNode<tagStreamWeight>* CodecHttp2::FindStreamWeight(uint32 uiStreamId, TreeNode<tagStreamWeight>* pTarget)
-{
-    if (pTarget == nullptr)
-    {
-        return(nullptr);
-    }
-    if (pTarget->pData->uiStreamId == uiStreamId)
-    {
-        return(pTarget);
-    }
-    else
-    {
-        auto pFound = FindStreamWeight(uiStreamId, pTarget->pFirstChild);
-        if (pFound == nullptr)
-        {
-            pFound = FindStreamWeight(uiStreamId, pTarget->pRightBrother);
-        }
-        return(pFound);
-    }
-}
-
-void CodecHttp2::ReleaseStreamWeight(TreeNode<tagStreamWeight>* pNode)
-{
-    if (pNode == nullptr)
-    {
-        return;
-    }
-    ReleaseStreamWeight(pNode->pFirstChild);
-    pNode->pFirstChild = nullptr;
-    ReleaseStreamWeight(pNode->pRightBrother);
-    pNode->pRightBrother = nullptr;
-    pNode->pParent = nullptr;
-    delete pNode->pData;
-    pNode->pData = nullptr;
-    delete pNode;
-}
-
 E_CODEC_STATUS CodecHttp2::UnpackHeaderIndexed(CBuffer* pBuff,
         ::google::protobuf::Map< ::std::string, ::std::string >* pHeader)
 {
@@ -571,19 +507,11 @@ E_CODEC_STATUS CodecHttp2::UnpackHeaderIndexed(CBuffer* pBuff,
         LOG4_ERROR("hpack index value of 0 is not used!");
         return(CODEC_STATUS_ERR);
     }
-    else if (uiTableIndex <= Http2Header::sc_uiMaxStaticTableIndex)
-    {
-        pHeader->insert({
-            Http2Header::sc_vecStaticTable[uiTableIndex].first,
-            Http2Header::sc_vecStaticTable[uiTableIndex].second});
-        return(CODEC_STATUS_PART_OK);
-    }
-    else if (uiTableIndex <= Http2Header::sc_uiMaxStaticTableIndex + m_vecDecodingDynamicTable.size())
+    const std::string* pHeaderName = nullptr;
+    const std::string* pHeaderValue = nullptr;
+    if (GetDecodingTableEntry(uiTableIndex, pHeaderName, pHeaderValue))
     {
-        uint32 uiDynamicTableIndex = uiTableIndex - Http2Header::sc_uiMaxStaticTableIndex - 1;
-        pHeader->insert({
-            m_vecDecodingDynamicTable[uiDynamicTableIndex].Name(),
-            m_vecDecodingDynamicTable[uiDynamicTableIndex].Value()});
+        pHeader->insert({*pHeaderName, *pHeaderValue});
         return(CODEC_STATUS_PART_OK);
     }
     else
@@ -608,27 +536,17 @@ E_CODEC_STATUS CodecHttp2::UnpackHeaderLiteralIndexing(CBuffer* pBuff, uint8 ucF
             LOG4_ERROR("hpack index value of 0 is not used!");
             return(CODEC_STATUS_ERR);
         }
-        else if (uiTableIndex <= Http2Header::sc_uiMaxStaticTableIndex)
+        const std::string* pHeaderName = nullptr;
+        const std::string* pHeaderValue = nullptr;
+        if (GetDecodingTableEntry(uiTableIndex, pHeaderName, pHeaderValue))
         {
+            strHeaderName = *pHeaderName;
             if (!Http2Header::DecodeStringLiteral(pBuff, strHeaderValue, bWithHuffman))
             {
                 SetErrno(H2_ERR_COMPRESSION_ERROR);
                 LOG4_ERROR("DecodeStringLiteral failed!");
                 return(CODEC_STATUS_ERR);
             }
-            strHeaderName = Http2Header::sc_vecStaticTable[uiTableIndex].first;
-            return(CODEC_STATUS_PART_OK);
-        }
-        else if (uiTableIndex < Http2Header::sc_uiMaxStaticTableIndex + m_vecDecodingDynamicTable.size())
-        {
-            uint32 uiDynamicTableIndex = uiTableIndex - Http2Header::sc_uiMaxStaticTableIndex - 1;
-            if (!Http2Header::DecodeStringLiteral(pBuff, strHeaderValue, bWithHuffman))
-            {
-                SetErrno(H2_ERR_COMPRESSION_ERROR);
-                LOG4_ERROR("DecodeStringLiteral failed!");
-                return(CODEC_STATUS_ERR);
-            }
-            strHeaderName = m_vecDecodingDynamicTable[uiDynamicTableIndex].Name();
             return(CODEC_STATUS_PART_OK);
         }
         else
@@ -662,12 +580,7 @@ void CodecHttp2::PackHeaderIndexed(size_t uiTableIndex, CBuffer* pBuff)
 void CodecHttp2::PackHeaderWithIndexing(const std::string& strHeaderName,
         const std::string& strHeaderValue, bool bWithHuffman, CBuffer* pBuff)
 {
-    size_t uiTableIndex = 0;
-    uiTableIndex = Http2Header::GetStaticTableIndex(strHeaderName);
-    if (uiTableIndex == 0)
-    {
-        uiTableIndex = GetEncodingTableIndex(strHeaderName);
-    }
+    size_t uiTableIndex = GetEncodingTableIndex(strHeaderName);
 
     if (uiTableIndex > 0)
     {
@@ -697,17 +610,13 @@ void CodecHttp2::PackHeaderWithIndexing(const std::string& strHeaderName,
             Http2Header::EncodeStringLiteral(strHeaderValue, pBuff);
         }
     }
+    m_oEncodingDynamicTable.Add(strHeaderName, strHeaderValue);
 }
 
 void CodecHttp2::PackHeaderWithoutIndexing(const std::string& strHeaderName,
         const std::string& strHeaderValue, bool bWithHuffman, CBuffer* pBuff)
 {
-    size_t uiTableIndex = 0;
-    uiTableIndex = Http2Header::GetStaticTableIndex(strHeaderName);
-    if (uiTableIndex == 0)
-    {
-        uiTableIndex = GetEncodingTableIndex(strHeaderName);
-    }
+    size_t uiTableIndex = GetEncodingTableIndex(strHeaderName);
 
     if (uiTableIndex > 0)
     {
@@ -742,12 +651,7 @@ void CodecHttp2::PackHeaderWithoutIndexing(const std::string& strHeaderName,
 void CodecHttp2::PackHeaderNeverIndexing(const std::string& strHeaderName,
         const std::string& strHeaderValue, bool bWithHuffman, CBuffer* pBuff)
 {
-    size_t uiTableIndex = 0;
-    uiTableIndex = Http2Header::GetStaticTableIndex(strHeaderName);
-    if (uiTableIndex == 0)
-    {
-        uiTableIndex = GetEncodingTableIndex(strHeaderName);
-    }
+    size_t uiTableIndex = GetEncodingTableIndex(strHeaderName);
 
     if (uiTableIndex > 0)
     {
@@ -785,178 +689,55 @@ void CodecHttp2::PackHeaderDynamicTableSize(uint32 uiDynamicTableSize, CBuffer*
             (char)H2_HPACK_CONDITION_DYNAMIC_TABLE_SIZE_UPDATE, pBuff);
 }
 
-size_t CodecHttp2::GetEncodingTableIndex(const std::string& strHeaderName, const std::string& strHeaderValue)
+size_t CodecHttp2::GetEncodingTableIndex(const std::string& strHeaderName)
 {
-    size_t uiTableIndex = 0;
-    if (strHeaderValue.size() == 0)
-    {
-        for (size_t i = 0; i < m_vecEncodingDynamicTable.size(); ++i)
-        {
-            if (m_vecEncodingDynamicTable[i].Name() == strHeaderName)
-            {
-                uiTableIndex = Http2Header::sc_uiMaxStaticTableIndex + i + 1;
-                break;
-            }
-        }
-    }
-    else
+    size_t uiTableIndex = Http2Header::GetStaticTableIndex(strHeaderName);
+    if (uiTableIndex == 0)
     {
-        for (size_t i = 0; i < m_vecEncodingDynamicTable.size(); ++i)
+        uiTableIndex = m_oEncodingDynamicTable.Find(strHeaderName);
+        if (uiTableIndex > 0)
         {
-            if (m_vecEncodingDynamicTable[i].Name() == strHeaderName
-                    && m_vecEncodingDynamicTable[i].Value() == strHeaderValue)
-            {
-                uiTableIndex = Http2Header::sc_uiMaxStaticTableIndex + i + 1;
-                break;
-            }
+            uiTableIndex += Http2Header::sc_uiMaxStaticTableIndex;
         }
     }
     return(uiTableIndex);
 }
 
-//size_t CodecHttp2::GetDecodingTableIndex(const std::string& strHeaderName, const std::string& strHeaderValue)
-//{
-//    size_t uiTableIndex = 0;
-//    if (strHeaderValue.size() == 0)
-//    {
-//        for (size_t i = 0; i < m_vecDecodingDynamicTable.size(); ++i)
-//        {
-//            if (m_vecDecodingDynamicTable[i].Name() == strHeaderName)
-//            {
-//                uiTableIndex = Http2Header::sc_uiMaxStaticTableIndex + i + 1;
-//                break;
-//            }
-//        }
-//    }
-//    else
-//    {
-//        for (size_t i = 0; i < m_vecDecodingDynamicTable.size(); ++i)
-//        {
-//            if (m_vecDecodingDynamicTable[i].Name() == strHeaderName
-//                    && m_vecDecodingDynamicTable[i].Value() == strHeaderValue)
-//            {
-//                uiTableIndex = Http2Header::sc_uiMaxStaticTableIndex + i + 1;
-//                break;
-//            }
-//        }
-//    }
-//    return(uiTableIndex);
-//}
-
-void CodecHttp2::UpdateEncodingDynamicTable(int iDynamicTableIndex, const std::string& strHeaderName, const std::string& strHeaderValue)
+size_t CodecHttp2::GetEncodingTableIndex(const std::string& strHeaderName, const std::string& strHeaderValue)
 {
-    Http2Header oHeader(strHeaderName, strHeaderValue);
-    if (iDynamicTableIndex < 0 || iDynamicTableIndex >= (int)m_vecEncodingDynamicTable.size())   // new header
-    {
-        while (m_uiEncodingDynamicTableSize + oHeader.HpackSize() > m_uiSettingsMaxFrameSize
-                && m_uiEncodingDynamicTableSize > 0)
-        {
-            auto& rLastElement = m_vecEncodingDynamicTable.back();
-            m_uiEncodingDynamicTableSize -= rLastElement.HpackSize();
-            m_vecEncodingDynamicTable.pop_back();
-        }
-        if (oHeader.HpackSize() <= m_uiSettingsMaxFrameSize)
-        {
-            m_vecEncodingDynamicTable.insert(m_vecEncodingDynamicTable.begin(),
-                    std::move(oHeader));
-            m_uiEncodingDynamicTableSize += oHeader.HpackSize();
-        }
-    }
-    else    // replace header ?
+    size_t uiTableIndex = Http2Header::GetStaticTableIndex(strHeaderName, strHeaderValue);
+    if (uiTableIndex == 0)
     {
-        while ((m_uiEncodingDynamicTableSize + oHeader.HpackSize()
-                - m_vecEncodingDynamicTable[iDynamicTableIndex].HpackSize())
-                > m_uiSettingsMaxFrameSize
-                && m_uiEncodingDynamicTableSize > 0)
-        {
-            auto& rLastElement = m_vecEncodingDynamicTable.back();
-            m_uiEncodingDynamicTableSize -= rLastElement.HpackSize();
-            m_vecEncodingDynamicTable.pop_back();
-        }
-        if (oHeader.HpackSize() <= m_uiSettingsMaxFrameSize)
+        uiTableIndex = m_oEncodingDynamicTable.Find(strHeaderName, strHeaderValue);
+        if (uiTableIndex > 0)
         {
-            if (iDynamicTableIndex < (int)m_vecEncodingDynamicTable.size())  // replace header
-            {
-                m_vecEncodingDynamicTable[iDynamicTableIndex] = std::move(oHeader);
-            }
-            else    // new header
-            {
-                m_vecEncodingDynamicTable.insert(m_vecEncodingDynamicTable.begin(),
-                        std::move(oHeader));
-            }
-            m_uiEncodingDynamicTableSize += oHeader.HpackSize();
+            uiTableIndex += Http2Header::sc_uiMaxStaticTableIndex;
         }
     }
+    return(uiTableIndex);
 }
 
-void CodecHttp2::UpdateEncodingDynamicTable(uint32 uiTableSize)
+bool CodecHttp2::GetDecodingTableEntry(size_t uiTableIndex,
+        const std::string*& pHeaderName, const std::string*& pHeaderValue) const
 {
-    m_uiSettingsMaxFrameSize = uiTableSize;
-    while (m_uiEncodingDynamicTableSize > m_uiSettingsMaxFrameSize
-            && m_uiEncodingDynamicTableSize > 0)
+    if (uiTableIndex == 0)
     {
-        auto& rLastElement = m_vecEncodingDynamicTable.back();
-        m_uiEncodingDynamicTableSize -= rLastElement.HpackSize();
-        m_vecEncodingDynamicTable.pop_back();
+        return(false);
     }
-}
-
-void CodecHttp2::UpdateDecodingDynamicTable(int iDynamicTableIndex, const std::string& strHeaderName, const std::string& strHeaderValue)
-{
-    Http2Header oHeader(strHeaderName, strHeaderValue);
-    if (iDynamicTableIndex < 0 || iDynamicTableIndex >= (int)m_vecDecodingDynamicTable.size())   // new header
+    if (uiTableIndex <= Http2Header::sc_uiMaxStaticTableIndex)
     {
-        while (m_uiDecodingDynamicTableSize + oHeader.HpackSize() > m_uiSettingsMaxFrameSize
-                && m_uiDecodingDynamicTableSize > 0)
-        {
-            auto& rLastElement = m_vecDecodingDynamicTable.back();
-            m_uiDecodingDynamicTableSize -= rLastElement.HpackSize();
-            m_vecDecodingDynamicTable.pop_back();
-        }
-        if (oHeader.HpackSize() <= m_uiSettingsMaxFrameSize)
-        {
-            m_vecDecodingDynamicTable.insert(m_vecDecodingDynamicTable.begin(),
-                    std::move(oHeader));
-            m_uiDecodingDynamicTableSize += oHeader.HpackSize();
-        }
+        pHeaderName = &Http2Header::sc_vecStaticTable[uiTableIndex].first;
+        pHeaderValue = &Http2Header::sc_vecStaticTable[uiTableIndex].second;
+        return(true);
     }
-    else    // replace header ?
-    {
-        while ((m_uiDecodingDynamicTableSize + oHeader.HpackSize()
-                - m_vecDecodingDynamicTable[iDynamicTableIndex].HpackSize())
-                > m_uiSettingsMaxFrameSize
-                && m_uiDecodingDynamicTableSize > 0)
-        {
-            auto& rLastElement = m_vecDecodingDynamicTable.back();
-            m_uiDecodingDynamicTableSize -= rLastElement.HpackSize();
-            m_vecDecodingDynamicTable.pop_back();
-        }
-        if (oHeader.HpackSize() <= m_uiSettingsMaxFrameSize)
-        {
-            if (iDynamicTableIndex < (int)m_vecDecodingDynamicTable.size())  // replace header
-            {
-                m_vecDecodingDynamicTable[iDynamicTableIndex] = std::move(oHeader);
-            }
-            else    // new header
-            {
-                m_vecDecodingDynamicTable.insert(m_vecDecodingDynamicTable.begin(),
-                        std::move(oHeader));
-            }
-            m_uiDecodingDynamicTableSize += oHeader.HpackSize();
-        }
-    }
-}
-
-void CodecHttp2::UpdateDecodingDynamicTable(uint32 uiTableSize)
-{
-    m_uiSettingsMaxFrameSize = uiTableSize;
-    while (m_uiDecodingDynamicTableSize > m_uiSettingsMaxFrameSize
-            && m_uiDecodingDynamicTableSize > 0)
+    auto pEntry = m_oDecodingDynamicTable.Get(uiTableIndex - Http2Header::sc_uiMaxStaticTableIndex);
+    if (pEntry == nullptr)
     {
-        auto& rLastElement = m_vecDecodingDynamicTable.back();
-        m_uiDecodingDynamicTableSize -= rLastElement.HpackSize();
-        m_vecDecodingDynamicTable.pop_back();
+        return(false);
     }
+    pHeaderName = &pEntry->strName;
+    pHeaderValue = &pEntry->strValue;
+    return(true);
 }
 
 } /* namespace neb */
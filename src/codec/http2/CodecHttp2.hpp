@@ -11,24 +11,19 @@
 #define SRC_CODEC_HTTP2_CODECHTTP2_HPP_
 
 #include <unordered_map>
+#include <unordered_set>
 #include "codec/Codec.hpp"
 #include "pb/http.pb.h"
 #include "H2Comm.hpp"
-#include "Tree.hpp"
 #include "Http2Header.hpp"
+#include "HpackDynamicTable.hpp"
+#include "Http2WriteScheduler.hpp"
 
 namespace neb
 {
 
 const uint32 STREAM_IDENTIFY_MASK = 0x7FFFFFFF;
 
-struct tagStreamWeight
-{
-    uint32 uiStreamId                       = 0;
-    uint8 ucWeight                          = 0;
-    uint8 ucCurrentWeight                   = 0;
-};
-
 class Http2Frame;
 class Http2Stream;
 
@@ -57,8 +52,43 @@ public:
     }
     void SetPriority(uint32 uiStreamId, const tagPriority& stPriority);
     void RstStream(uint32 uiStreamId);
+    /**
+     * @brief 本端重置流（发送RST_STREAM）时丢弃调度器中该流未发送的数据
+     * @note 只删除调度器中的条目，Http2Stream对象可能正在解码，不在这里释放
+     */
+    void DropPendingData(uint32 uiStreamId);
     E_H2_ERR_CODE Setting(const std::vector<tagSetting>& vecSetting);
-    void WindowUpdate(uint32 uiStreamId, uint32 uiIncrement);
+    /**
+     * @brief 对端的WINDOW_UPDATE
+     * @return 窗口超过2^31-1时返回false（FLOW_CONTROL_ERROR）
+     */
+    bool WindowUpdate(uint32 uiStreamId, uint32 uiIncrement);
+    /**
+     * @brief 收到DATA帧，扣减本端的接收窗口
+     * @note 连接和流各自累计已接收的字节数，达到窗口的一半时才在pReactBuff中写入
+     * 一个WINDOW_UPDATE帧，避免每个DATA帧都回一个WINDOW_UPDATE。
+     * @return 对端发送的数据超出窗口时返回false（FLOW_CONTROL_ERROR）
+     */
+    bool ConsumeRecvWindow(const tagH2FrameHead& stFrameHead, CBuffer* pReactBuff);
+    /**
+     * @brief 把流的响应数据交给发送调度器，由FlushData()按权重和流量控制窗口输出DATA帧
+     * @param bEndStream 是否是流的最后一段数据
+     */
+    void SendData(uint32 uiStreamId, const std::string& strData, bool bEndStream);
+    /**
+     * @brief 输出调度器中可发送的DATA帧
+     * @param uiMaxBytes 本次最多输出的字节数（含帧头），一般为连接当次可写的量，
+     * 余下的数据等连接再次可写时继续输出
+     * @return 输出的字节数
+     */
+    size_t FlushData(CBuffer* pBuff, size_t uiMaxBytes);
+    /**
+     * @brief 调度器中是否有可以立即发送的数据
+     */
+    bool HasPendingData() const
+    {
+        return(m_oWriteScheduler.IsWritable());
+    }
     uint32 GetMaxFrameSize()
     {
         return(m_uiSettingsMaxFrameSize);
@@ -77,9 +107,6 @@ public:
 
 protected:
     uint32 StreamIdGenerate();
-    TreeNode<tagStreamWeight>* FindStreamWeight(uint32 uiStreamId, TreeNode<tagStreamWeight>* pTarget);
-    TreeNode<tagStreamWeight>* FindHighestWeightStream();
-    void ReleaseStreamWeight(TreeNode<tagStreamWeight>* pNode);
 
     E_CODEC_STATUS UnpackHeaderIndexed(CBuffer* pBuff,
             ::google::protobuf::Map< ::std::string, ::std::string >* pHeader);
@@ -94,12 +121,23 @@ protected:
     void PackHeaderNeverIndexing(const std::string& strHeaderName,
             const std::string& strHeaderValue, bool bWithHuffman, CBuffer* pBuff);
     void PackHeaderDynamicTableSize(uint32 uiDynamicTableSize, CBuffer* pBuff);
-    size_t GetEncodingTableIndex(const std::string& strHeaderName, const std::string& strHeaderValue = "");
-//    size_t GetDecodingTableIndex(const std::string& strHeaderName, const std::string& strHeaderValue = "");
-    void UpdateEncodingDynamicTable(int iDynamicTableIndex, const std::string& strHeaderName, const std::string& strHeaderValue);
-    void UpdateEncodingDynamicTable(uint32 uiTableSize);
-    void UpdateDecodingDynamicTable(int iDynamicTableIndex, const std::string& strHeaderName, const std::string& strHeaderValue);
-    void UpdateDecodingDynamicTable(uint32 uiTableSize);
+    /**
+     * @brief 在静态表和编码动态表中查找名字相同的条目
+     * @return HPACK索引，未找到返回0
+     */
+    size_t GetEncodingTableIndex(const std::string& strHeaderName);
+    /**
+     * @brief 在静态表和编码动态表中查找名字和值都相同的条目
+     * @return HPACK索引，未找到返回0
+     */
+    size_t GetEncodingTableIndex(const std::string& strHeaderName, const std::string& strHeaderValue);
+    /**
+     * @brief 按HPACK索引在静态表和解码动态表中取条目
+     * @return 索引为0或超出两表长度之和返回false
+     */
+    bool GetDecodingTableEntry(size_t uiTableIndex, const std::string*& pHeaderName, const std::string*& pHeaderValue) const;
+
+    static const uint32 sc_uiWindowUpdateThreshold = DEFAULT_SETTINGS_MAX_INITIAL_WINDOW_SIZE / 2;
 
 private:
     bool m_bChannelIsClient = false;    // 当前编解码器所在channel是作为http客户端还是作为http服务端
@@ -116,12 +154,13 @@ private:
     std::unique_ptr<Http2Frame> m_pFrame = nullptr;
     Http2Stream* m_pCodingStream = nullptr;
     std::unordered_map<uint32, Http2Stream*> m_mapStream;
-    TreeNode<tagStreamWeight>* m_pStreamWeight = nullptr;
+    uint32 m_uiRecvWindowConsumed = 0;          // 连接上已接收但尚未以WINDOW_UPDATE归还的字节数
+    std::unordered_map<uint32, uint32> m_mapRecvWindowConsumed;     // 各流已接收但尚未归还的字节数
+    Http2WriteScheduler m_oWriteScheduler;
 
-    uint32 m_uiEncodingDynamicTableSize = 0;
-    uint32 m_uiDecodingDynamicTableSize = 0;
-    std::vector<Http2Header> m_vecEncodingDynamicTable;
-    std::vector<Http2Header> m_vecDecodingDynamicTable;
+    bool m_bEncodingTableSizeChanged = false;     // 编码动态表大小上限有变化，须在下一个头块开头通知对端
+    HpackDynamicTable m_oEncodingDynamicTable;
+    HpackDynamicTable m_oDecodingDynamicTable;
     std::unordered_set<std::string> m_setEncodingWithoutIndexHeaders;
     std::unordered_set<std::string> m_setEncodingNeverIndexHeaders;
 };
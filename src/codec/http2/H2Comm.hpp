@@ -13,11 +13,12 @@
 namespace neb
 {
 
-const uint32 H2_FRAME_HEAD_SIZE = 72;
-const uint32 SETTINGS_MAX_FRAME_SIZE = (2^24) - 1;
-const uint32 DEFAULT_SETTINGS_MAX_FRAME_SIZE = (2^14);
-const uint32 SETTINGS_MAX_INITIAL_WINDOW_SIZE = (2^31) - 1;
-const uint32 DEFAULT_SETTINGS_MAX_INITIAL_WINDOW_SIZE = (2^16) - 1;
+const uint32 H2_FRAME_HEAD_SIZE = 9;                                    ///< 帧头9个字节（72位）
+const uint32 SETTINGS_MAX_FRAME_SIZE = (1u << 24) - 1;
+const uint32 DEFAULT_SETTINGS_MAX_FRAME_SIZE = (1u << 14);
+const uint32 SETTINGS_MAX_INITIAL_WINDOW_SIZE = (1u << 31) - 1;
+const uint32 DEFAULT_SETTINGS_MAX_INITIAL_WINDOW_SIZE = (1u << 16) - 1;
+const uint32 DEFAULT_SETTINGS_HEADER_TABLE_SIZE = 4096;      ///< rfc7540 6.5.2 SETTINGS_HEADER_TABLE_SIZE初始值
 
 /*
  * @see https://httpwg.org/specs/rfc7540.html#FRAME_SIZE_ERROR
@@ -0,0 +1,142 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     HpackDynamicTable.cpp
+ * @brief    HPACK动态表
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note
+ * Modify history:
+ ******************************************************************************/
+#include "HpackDynamicTable.hpp"
+#include "Http2Header.hpp"
+
+namespace neb
+{
+
+const uint32 HpackDynamicTable::sc_uiEntryOverhead;
+
+HpackDynamicTable::HpackDynamicTable(uint32 uiMaxSize, bool bWithIndex)
+    : m_bWithIndex(bWithIndex), m_uiMaxSize(uiMaxSize), m_uiSize(0),
+      m_uiEntryNum(0), m_ullNextSequence(0)
+{
+}
+
+HpackDynamicTable::~HpackDynamicTable()
+{
+}
+
+void HpackDynamicTable::SetMaxSize(uint32 uiMaxSize)
+{
+    m_uiMaxSize = uiMaxSize;
+    while (m_uiSize > m_uiMaxSize)
+    {
+        EvictOldest();
+    }
+}
+
+void HpackDynamicTable::Add(const std::string& strName, const std::string& strValue)
+{
+    size_t uiEntrySize = strName.size() + strValue.size() + sc_uiEntryOverhead;
+    while (m_uiEntryNum > 0 && m_uiSize + uiEntrySize > m_uiMaxSize)
+    {
+        EvictOldest();
+    }
+    if (uiEntrySize > m_uiMaxSize)
+    {
+        return;
+    }
+    if (m_uiEntryNum == m_vecRing.size())
+    {
+        Grow();
+    }
+    uint64 ullSequence = m_ullNextSequence++;
+    tagEntry& stEntry = Slot(ullSequence);
+    stEntry.strName.assign(strName);        // 复用淘汰条目的内存
+    stEntry.strValue.assign(strValue);
+    m_uiSize += uiEntrySize;
+    ++m_uiEntryNum;
+    if (m_bWithIndex)
+    {
+        m_mapName[Http2Header::Hash(strName)] = ullSequence;
+        m_mapField[Http2Header::Hash(strName, strValue)] = ullSequence;
+    }
+}
+
+const HpackDynamicTable::tagEntry* HpackDynamicTable::Get(size_t uiIndex) const
+{
+    if (uiIndex == 0 || uiIndex > m_uiEntryNum)
+    {
+        return(nullptr);
+    }
+    return(&Slot(m_ullNextSequence - uiIndex));
+}
+
+size_t HpackDynamicTable::Find(const std::string& strName) const
+{
+    if (m_uiEntryNum == 0)
+    {
+        return(0);
+    }
+    return(FindBySequence(m_mapName, Http2Header::Hash(strName), strName, nullptr));
+}
+
+size_t HpackDynamicTable::Find(const std::string& strName, const std::string& strValue) const
+{
+    if (m_uiEntryNum == 0)
+    {
+        return(0);
+    }
+    return(FindBySequence(m_mapField, Http2Header::Hash(strName, strValue), strName, &strValue));
+}
+
+size_t HpackDynamicTable::FindBySequence(const std::unordered_map<uint64, uint64>& mapIndex, uint64 ullHash,
+        const std::string& strName, const std::string* pValue) const
+{
+    auto iter = mapIndex.find(ullHash);
+    if (iter == mapIndex.end())
+    {
+        return(0);
+    }
+    // 哈希冲突时索引里只保留较新的条目，这里须核对内容，冲突只会少一次命中，不会出错
+    const tagEntry& stEntry = Slot(iter->second);
+    if (stEntry.strName != strName || (pValue != nullptr && stEntry.strValue != *pValue))
+    {
+        return(0);
+    }
+    return(m_ullNextSequence - iter->second);
+}
+
+void HpackDynamicTable::Grow()
+{
+    // 动态表最多容纳 m_uiMaxSize / 32 个条目，环形缓冲区按需翻倍
+    std::vector<tagEntry> vecRing((m_vecRing.size() == 0) ? 16 : m_vecRing.size() * 2);
+    for (uint64 ullSequence = m_ullNextSequence - m_uiEntryNum; ullSequence < m_ullNextSequence; ++ullSequence)
+    {
+        vecRing[ullSequence & (vecRing.size() - 1)] = std::move(Slot(ullSequence));
+    }
+    m_vecRing.swap(vecRing);
+}
+
+void HpackDynamicTable::EvictOldest()
+{
+    uint64 ullSequence = m_ullNextSequence - m_uiEntryNum;
+    tagEntry& stEntry = Slot(ullSequence);
+    if (m_bWithIndex)
+    {
+        // 索引指向的是同名（同名同值）的最新条目，只有它本身就是被淘汰的条目时才删除
+        auto name_iter = m_mapName.find(Http2Header::Hash(stEntry.strName));
+        if (name_iter != m_mapName.end() && name_iter->second == ullSequence)
+        {
+            m_mapName.erase(name_iter);
+        }
+        auto field_iter = m_mapField.find(Http2Header::Hash(stEntry.strName, stEntry.strValue));
+        if (field_iter != m_mapField.end() && field_iter->second == ullSequence)
+        {
+            m_mapField.erase(field_iter);
+        }
+    }
+    m_uiSize -= stEntry.strName.size() + stEntry.strValue.size() + sc_uiEntryOverhead;
+    --m_uiEntryNum;
+}
+
+} /* namespace neb */
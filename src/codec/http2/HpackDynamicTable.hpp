@@ -0,0 +1,118 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     HpackDynamicTable.hpp
+ * @brief    HPACK动态表
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note     动态表（rfc7541 2.3.2）是先进先出的队列：新条目插入到表头（索引最小），
+ * 超出大小上限时从表尾（最早插入的条目）淘汰。这里用环形缓冲区存放，每个条目有一个
+ * 递增的绝对序号，HPACK索引与绝对序号互相换算，插入和淘汰都是O(1)，不移动其他条目。
+ * 编码端另有按名字、按名字+值的哈希索引，查找也是O(1)。
+ * Modify history:
+ ******************************************************************************/
+#ifndef SRC_CODEC_HTTP2_HPACKDYNAMICTABLE_HPP_
+#define SRC_CODEC_HTTP2_HPACKDYNAMICTABLE_HPP_
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "Definition.hpp"
+
+namespace neb
+{
+
+class HpackDynamicTable
+{
+public:
+    struct tagEntry
+    {
+        std::string strName;
+        std::string strValue;
+    };
+
+    /**
+     * @param uiMaxSize 动态表大小上限（rfc7541 4.2）
+     * @param bWithIndex 是否建立查找用的哈希索引（编码端需要，解码端只按索引取条目）
+     */
+    HpackDynamicTable(uint32 uiMaxSize, bool bWithIndex);
+    HpackDynamicTable(const HpackDynamicTable&) = delete;
+    HpackDynamicTable& operator=(const HpackDynamicTable&) = delete;
+    virtual ~HpackDynamicTable();
+
+    /**
+     * @brief 动态表当前大小（rfc7541 4.1，每个条目为名字长度 + 值长度 + 32）
+     */
+    uint32 GetSize() const
+    {
+        return(m_uiSize);
+    }
+
+    uint32 GetMaxSize() const
+    {
+        return(m_uiMaxSize);
+    }
+
+    size_t GetEntryNum() const
+    {
+        return(m_uiEntryNum);
+    }
+
+    /**
+     * @brief 修改大小上限，超出的条目从最早插入的开始淘汰（rfc7541 4.3）
+     */
+    void SetMaxSize(uint32 uiMaxSize);
+
+    /**
+     * @brief 插入条目（rfc7541 4.4），条目大于上限时清空动态表且不插入
+     */
+    void Add(const std::string& strName, const std::string& strValue);
+
+    /**
+     * @brief 按动态表内的索引取条目
+     * @param uiIndex 动态表内的索引，从1开始（即HPACK索引减去静态表长度），1为最新插入的条目
+     * @return 索引超出范围返回nullptr
+     */
+    const tagEntry* Get(size_t uiIndex) const;
+
+    /**
+     * @brief 查找名字相同的最新条目
+     * @return 动态表内的索引，未找到返回0
+     */
+    size_t Find(const std::string& strName) const;
+
+    /**
+     * @brief 查找名字和值都相同的最新条目
+     * @return 动态表内的索引，未找到返回0
+     */
+    size_t Find(const std::string& strName, const std::string& strValue) const;
+
+    static const uint32 sc_uiEntryOverhead = 32;    ///< rfc7541 4.1 每个条目的额外大小
+
+private:
+    tagEntry& Slot(uint64 ullSequence)
+    {
+        return(m_vecRing[ullSequence & (m_vecRing.size() - 1)]);
+    }
+    const tagEntry& Slot(uint64 ullSequence) const
+    {
+        return(m_vecRing[ullSequence & (m_vecRing.size() - 1)]);
+    }
+    size_t FindBySequence(const std::unordered_map<uint64, uint64>& mapIndex, uint64 ullHash,
+            const std::string& strName, const std::string* pValue) const;
+    void Grow();
+    void EvictOldest();
+
+private:
+    bool m_bWithIndex;
+    uint32 m_uiMaxSize;
+    uint32 m_uiSize;
+    size_t m_uiEntryNum;
+    uint64 m_ullNextSequence;                           ///< 下一个插入条目的绝对序号，最新条目为m_ullNextSequence - 1
+    std::vector<tagEntry> m_vecRing;                    ///< 长度为2的幂，序号为s的条目存放在s & (size - 1)
+    std::unordered_map<uint64, uint64> m_mapName;       ///< 名字的哈希 -> 该名字最新条目的序号
+    std::unordered_map<uint64, uint64> m_mapField;      ///< 名字+值的哈希 -> 最新条目的序号
+};
+
+} /* namespace neb */
+
+#endif /* SRC_CODEC_HTTP2_HPACKDYNAMICTABLE_HPP_ */
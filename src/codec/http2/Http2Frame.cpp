@@ -99,6 +99,14 @@ E_CODEC_STATUS Http2Frame::DecodeData(CodecHttp2* pCodecH2,
         oHttpMsg.mutable_body()->append(pBuff->GetRawReadBuffer(), stFrameHead.uiLength);
         pBuff->AdvanceReadIndex(stFrameHead.uiLength);
     }
+    // 整个DATA帧（含填充）计入流量控制窗口
+    if (!pCodecH2->ConsumeRecvWindow(stFrameHead, pReactBuff))
+    {
+        pCodecH2->SetErrno(H2_ERR_FLOW_CONTROL_ERROR);
+        EncodeGoaway(pCodecH2, H2_ERR_FLOW_CONTROL_ERROR, "The endpoint detected that its peer"
+                " violated the flow-control protocol.", pReactBuff);
+        return(CODEC_STATUS_ERR);
+    }
     return(CODEC_STATUS_PART_OK);
 }
 
@@ -392,7 +400,7 @@ E_CODEC_STATUS Http2Frame::DecodeWindowUpdate(CodecHttp2* pCodecH2,
     }
     uint32 uiIncrement = 0;
     pBuff->Read(&uiIncrement, 4);
-    uiIncrement &= H2_DATA_MASK_4_BYTE_LOW_31_BIT;
+    uiIncrement = ntohl(uiIncrement) & H2_DATA_MASK_4_BYTE_LOW_31_BIT;
     if (uiIncrement == 0)
     {
         if (stFrameHead.uiStreamIdentifier == 0)
@@ -408,9 +416,17 @@ E_CODEC_STATUS Http2Frame::DecodeWindowUpdate(CodecHttp2* pCodecH2,
             return(CODEC_STATUS_PART_ERR);
         }
     }
-    else
+    else if (!pCodecH2->WindowUpdate(stFrameHead.uiStreamIdentifier, uiIncrement))
     {
-        pCodecH2->WindowUpdate(stFrameHead.uiStreamIdentifier, uiIncrement);
+        // A sender MUST NOT allow a flow-control window to exceed 2^31-1 octets.
+        pCodecH2->SetErrno(H2_ERR_FLOW_CONTROL_ERROR);
+        if (stFrameHead.uiStreamIdentifier == 0)
+        {
+            EncodeGoaway(pCodecH2, H2_ERR_FLOW_CONTROL_ERROR, "flow-control window exceeds 2^31-1", pReactBuff);
+            return(CODEC_STATUS_ERR);
+        }
+        EncodeRstStream(pCodecH2, stFrameHead.uiStreamIdentifier, H2_ERR_FLOW_CONTROL_ERROR, pReactBuff);
+        return(CODEC_STATUS_PART_ERR);
     }
     return(CODEC_STATUS_OK);
 }
@@ -447,14 +463,18 @@ E_CODEC_STATUS Http2Frame::DecodeContinuation(CodecHttp2* pCodecH2,
 
 void Http2Frame::EncodeFrameHeader(const tagH2FrameHead& stFrameHead, CBuffer* pBuff)
 {
-    uint32 uiIdentifier = stFrameHead.cR;
-    uiIdentifier <<= 31;
-    uiIdentifier |= (htonl(stFrameHead.uiStreamIdentifier));
-    uint32 uiNetLength = htonl(stFrameHead.uiLength);
-    pBuff->Write(&uiNetLength, 3);
-    pBuff->Write(&stFrameHead.ucType, 1);
-    pBuff->Write(&stFrameHead.ucFlag, 1);
-    pBuff->Write(&uiIdentifier, 4);
+    // 长度是24位大端整数，须逐字节写出（htonl后取前3个字节取到的是高位的0）
+    char szHead[H2_FRAME_HEAD_SIZE];
+    uint32 uiIdentifier = ((uint32)stFrameHead.cR << 31)
+        | (stFrameHead.uiStreamIdentifier & H2_DATA_MASK_4_BYTE_LOW_31_BIT);
+    szHead[0] = (char)(stFrameHead.uiLength >> 16);
+    szHead[1] = (char)(stFrameHead.uiLength >> 8);
+    szHead[2] = (char)stFrameHead.uiLength;
+    szHead[3] = (char)stFrameHead.ucType;
+    szHead[4] = (char)stFrameHead.ucFlag;
+    uiIdentifier = htonl(uiIdentifier);
+    memcpy(szHead + 5, &uiIdentifier, 4);
+    pBuff->Write(szHead, H2_FRAME_HEAD_SIZE);
 }
 
 void Http2Frame::EncodePriority(const tagPriority& stPriority, CBuffer* pBuff)
@@ -629,6 +649,7 @@ E_CODEC_STATUS Http2Frame::EncodeRstStream(CodecHttp2* pCodecH2,
     EncodeFrameHeader(stFrameHead, pBuff);
     uint32 uiErrCode = htonl(iErrCode);
     pBuff->Write(&uiErrCode, 4);
+    pCodecH2->DropPendingData(uiStreamId);     // 流已关闭，不能再发送DATA帧
     return(CODEC_STATUS_OK);
 }
 
@@ -794,7 +815,8 @@ E_CODEC_STATUS Http2Frame::EncodeWindowUpdate(CodecHttp2* pCodecH2,
     stFrameHead.uiStreamIdentifier = uiStreamId;
     stFrameHead.uiLength = 4;
     EncodeFrameHeader(stFrameHead, pBuff);
-    pBuff->Write(&uiIncrement, 4);
+    uint32 uiNetIncrement = htonl(uiIncrement);
+    pBuff->Write(&uiNetIncrement, 4);
     return(CODEC_STATUS_OK);
 }
 
@@ -7,6 +7,7 @@
  * @note     
  * Modify history:
  ******************************************************************************/
+#include <cstring>
 #include "Http2Header.hpp"
 #include "Huffman.hpp"
 
@@ -79,69 +80,8 @@ const std::vector<std::pair<std::string, std::string>> Http2Header::sc_vecStatic
         {"www-authenticate", ""}                    ///< 61
 };
 
-const std::unordered_map<std::string, size_t> Http2Header::sc_mapStaticTable = {
-        {":authority", 1},
-        {":method GET", 2},
-        {":method POST", 3},
-        {":path /", 4},
-        {":path /index.html", 5},
-        {":scheme http", 6},
-        {":scheme https", 7},
-        {":status 200", 8},
-        {":status 204", 9},
-        {":status 206", 10},
-        {":status 304", 11},
-        {":status 400", 12},
-        {":status 404", 13},
-        {":status 500", 14},
-        {"accept-charset", 15},
-        {"accept-encoding gzip, deflate", 16},
-        {"accept-language", 17},
-        {"accept-ranges", 18},
-        {"accept", 19},
-        {"access-control-allow-origin", 20},
-        {"age", 21},
-        {"allow", 22},
-        {"authorization", 23},
-        {"cache-control", 24},
-        {"content-disposition", 25},
-        {"content-encoding", 26},
-        {"content-language", 27},
-        {"content-length", 28},
-        {"content-location", 29},
-        {"content-range", 30},
-        {"content-type", 31},
-        {"cookie", 32},
-        {"date", 33},
-        {"etag", 34},
-        {"expect", 35},
-        {"expires", 36},
-        {"from", 37},
-        {"host", 38},
-        {"if-match", 39},
-        {"if-modified-since", 40},
-        {"if-none-match", 41},
-        {"if-range", 42},
-        {"if-unmodified-since", 43},
-        {"last-modified", 44},
-        {"link", 45},
-        {"location", 46},
-        {"max-forwards", 47},
-        {"proxy-authenticate", 48},
-        {"proxy-authorization", 49},
-        {"range", 50},
-        {"referer", 51},
-        {"refresh", 52},
-        {"retry-after", 53},
-        {"server", 54},
-        {"set-cookie", 55},
-        {"strict-transport-security", 56},
-        {"transfer-encoding", 57},
-        {"user-agent", 58},
-        {"vary", 59},
-        {"via", 60},
-        {"www-authenticate", 61}
-};
+const uint64 Http2Header::sc_ullHashOffsetBasis;
+const uint64 Http2Header::sc_ullHashPrime;
 
 Http2Header::Http2Header(const std::string& strName, const std::string& strValue)
     : m_strName(strName), m_strValue(strValue), m_uiHpackSize(0)
@@ -224,6 +164,14 @@ void Http2Header::EncodeStringLiteral(const std::string& strLiteral, CBuffer* pB
 
 void Http2Header::EncodeStringLiteralWithHuffman(const std::string& strLiteral, CBuffer* pBuff)
 {
+    size_t uiHuffmanLength = Huffman::EncodedLength(strLiteral);
+    if (uiHuffmanLength >= strLiteral.size())   // 哈夫曼编码不比原文短时按原文发送
+    {
+        EncodeStringLiteral(strLiteral, pBuff);
+        return;
+    }
+    Http2Header::EncodeInt(uiHuffmanLength, (size_t)H2_HPACK_PREFIX_7_BITS,
+            (char)0x80, pBuff);     // H位置1
     Huffman::Instance()->Encode(strLiteral, pBuff);
 }
 
@@ -252,26 +200,66 @@ bool Http2Header::DecodeStringLiteral(CBuffer* pBuff, std::string& strLiteral, b
     }
 }
 
-size_t Http2Header::GetStaticTableIndex(const std::string& strHeaderName, const std::string& strHeaderValue)
+const Http2Header::tagStaticTableHash& Http2Header::GetStaticTableHash()
 {
-    if (strHeaderValue.size() == 0)
+    static const tagStaticTableHash s_stHash = []()
     {
-        auto c_iter = sc_mapStaticTable.find(strHeaderName);
-        if (c_iter == sc_mapStaticTable.end())
+        tagStaticTableHash stHash;
+        for (uint64 ullSeed = sc_ullHashOffsetBasis; ; ++ullSeed)
         {
-            return(0);
+            bool bCollision = false;
+            memset(stHash.aucSlot, 0, sizeof(stHash.aucSlot));
+            for (size_t i = 1; i <= sc_uiMaxStaticTableIndex; ++i)
+            {
+                const std::string& strName = sc_vecStaticTable[i].first;
+                if (strName == sc_vecStaticTable[i - 1].first)
+                {
+                    continue;   // 同名条目在静态表中相邻，只登记第一个
+                }
+                size_t uiSlot = StaticTableSlot(strName, ullSeed);
+                if (stHash.aucSlot[uiSlot] != 0)
+                {
+                    bCollision = true;
+                    break;
+                }
+                stHash.aucSlot[uiSlot] = (uint8)i;
+            }
+            if (!bCollision)
+            {
+                stHash.ullSeed = ullSeed;
+                return(stHash);
+            }
         }
-        return(c_iter->second);
+    }();
+    return(s_stHash);
+}
+
+size_t Http2Header::GetStaticTableIndex(const std::string& strHeaderName)
+{
+    const tagStaticTableHash& stHash = GetStaticTableHash();
+    size_t uiIndex = stHash.aucSlot[StaticTableSlot(strHeaderName, stHash.ullSeed)];
+    if (uiIndex == 0 || sc_vecStaticTable[uiIndex].first != strHeaderName)
+    {
+        return(0);
     }
-    else
+    return(uiIndex);
+}
+
+size_t Http2Header::GetStaticTableIndex(const std::string& strHeaderName, const std::string& strHeaderValue)
+{
+    size_t uiIndex = GetStaticTableIndex(strHeaderName);
+    if (uiIndex == 0)
+    {
+        return(0);
+    }
+    for (; uiIndex <= sc_uiMaxStaticTableIndex && sc_vecStaticTable[uiIndex].first == strHeaderName; ++uiIndex)
     {
-        auto c_iter = sc_mapStaticTable.find(strHeaderName + " " + strHeaderValue);
-        if (c_iter == sc_mapStaticTable.end())
+        if (sc_vecStaticTable[uiIndex].second == strHeaderValue)
         {
-            return(0);
+            return(uiIndex);
         }
-        return(c_iter->second);
     }
+    return(0);
 }
 
 } /* namespace neb */
@@ -13,6 +13,7 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include "Definition.hpp"
 #include "util/CBuffer.hpp"
 
 namespace neb
@@ -110,12 +111,67 @@ public:
      */
     static bool DecodeStringLiteral(CBuffer* pBuff, std::string& strLiteral, bool& bWithHuffman);
 
-    static size_t GetStaticTableIndex(const std::string& strHeaderName, const std::string& strHeaderValue = "");
+    /**
+     * @brief 查找静态表中名字相同的第一个条目
+     * @return 静态表索引，未找到返回0
+     */
+    static size_t GetStaticTableIndex(const std::string& strHeaderName);
+
+    /**
+     * @brief 查找静态表中名字和值都相同的条目
+     * @return 静态表索引，未找到返回0
+     */
+    static size_t GetStaticTableIndex(const std::string& strHeaderName, const std::string& strHeaderValue);
+
+    /**
+     * @brief FNV-1a哈希，用于静态表和动态表的查找
+     */
+    static inline uint64 Hash(const char* pData, size_t uiLength, uint64 ullHash = sc_ullHashOffsetBasis)
+    {
+        for (size_t i = 0; i < uiLength; ++i)
+        {
+            ullHash ^= (uint8)pData[i];
+            ullHash *= sc_ullHashPrime;
+        }
+        return(ullHash);
+    }
+
+    static inline uint64 Hash(const std::string& strHeaderName)
+    {
+        return(Hash(strHeaderName.data(), strHeaderName.size()));
+    }
+
+    static inline uint64 Hash(const std::string& strHeaderName, const std::string& strHeaderValue)
+    {
+        // 名字和值之间插入一个分隔字节，避免("ab", "c")与("a", "bc")相同
+        uint64 ullHash = (Hash(strHeaderName) ^ 0xFF) * sc_ullHashPrime;
+        return(Hash(strHeaderValue.data(), strHeaderValue.size(), ullHash));
+    }
 
 public:
     static const size_t sc_uiMaxStaticTableIndex;
     static const std::vector<std::pair<std::string, std::string>> sc_vecStaticTable;
-    static const std::unordered_map<std::string, size_t> sc_mapStaticTable;
+    static const uint64 sc_ullHashOffsetBasis = 0xcbf29ce484222325ULL;
+    static const uint64 sc_ullHashPrime = 0x100000001b3ULL;
+
+private:
+    /**
+     * @brief 静态表名字的完美哈希
+     * @note 启动后第一次查找时选取一个使静态表中所有名字互不冲突的哈希种子，
+     * 此后查找只需一次哈希和一次字符串比较，不分配内存。
+     */
+    struct tagStaticTableHash
+    {
+        uint64 ullSeed = 0;
+        uint8 aucSlot[256] = {0};       ///< 哈希槽 -> 该名字在静态表中的第一个索引，0为空槽
+    };
+    static const tagStaticTableHash& GetStaticTableHash();
+
+    static inline size_t StaticTableSlot(const std::string& strHeaderName, uint64 ullSeed)
+    {
+        // FNV乘法的低位只取决于种子的低位，取高8位作为槽位
+        return(Hash(strHeaderName.data(), strHeaderName.size(), ullSeed) >> 56);
+    }
 };
 
 } /* namespace neb */
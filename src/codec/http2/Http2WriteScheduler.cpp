@@ -0,0 +1,247 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     Http2WriteScheduler.cpp
+ * @brief    http2 DATA帧发送调度
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note
+ * Modify history:
+ ******************************************************************************/
+#include "Http2WriteScheduler.hpp"
+#include <algorithm>
+#include "Http2Frame.hpp"
+
+namespace neb
+{
+
+const uint32 Http2WriteScheduler::sc_uiDefaultWeight;
+const uint32 Http2WriteScheduler::sc_uiFrameHeadSize;
+
+Http2WriteScheduler::Http2WriteScheduler()
+    : m_llConnectionWindow(DEFAULT_SETTINGS_MAX_INITIAL_WINDOW_SIZE),
+      m_uiInitialWindowSize(DEFAULT_SETTINGS_MAX_INITIAL_WINDOW_SIZE),
+      m_ullVirtualTime(0), m_uiPendingBytes(0), m_uiReadyEmptyEnd(0)
+{
+}
+
+Http2WriteScheduler::~Http2WriteScheduler()
+{
+}
+
+bool Http2WriteScheduler::SetInitialWindowSize(uint32 uiWindowSize)
+{
+    int64 llDelta = (int64)uiWindowSize - (int64)m_uiInitialWindowSize;
+    m_uiInitialWindowSize = uiWindowSize;
+    bool bValid = true;
+    for (auto iter = m_mapStream.begin(); iter != m_mapStream.end(); ++iter)
+    {
+        iter->second.llWindow += llDelta;
+        if (iter->second.llWindow > (int64)SETTINGS_MAX_INITIAL_WINDOW_SIZE)
+        {
+            bValid = false;
+        }
+        Reschedule(iter->first, iter->second);
+    }
+    return(bValid);
+}
+
+bool Http2WriteScheduler::UpdateWindow(uint32 uiStreamId, uint32 uiIncrement)
+{
+    if (uiStreamId == 0)
+    {
+        m_llConnectionWindow += uiIncrement;
+        return(m_llConnectionWindow <= (int64)SETTINGS_MAX_INITIAL_WINDOW_SIZE);
+    }
+    tagStream* pStream = FindStream(uiStreamId);
+    if (pStream == nullptr)
+    {
+        return(true);   // 流已关闭，对端仍可能发送WINDOW_UPDATE
+    }
+    pStream->llWindow += uiIncrement;
+    Reschedule(uiStreamId, *pStream);
+    return(pStream->llWindow <= (int64)SETTINGS_MAX_INITIAL_WINDOW_SIZE);
+}
+
+void Http2WriteScheduler::Add(uint32 uiStreamId)
+{
+    auto iter = m_mapStream.find(uiStreamId);
+    if (iter == m_mapStream.end())
+    {
+        iter = m_mapStream.insert(std::make_pair(uiStreamId, tagStream())).first;
+        iter->second.llWindow = m_uiInitialWindowSize;
+    }
+}
+
+void Http2WriteScheduler::SetWeight(uint32 uiStreamId, uint32 uiWeight)
+{
+    tagStream* pStream = FindStream(uiStreamId);
+    if (pStream != nullptr)
+    {
+        pStream->uiWeight = std::max(1u, std::min(uiWeight, 256u));
+    }
+}
+
+void Http2WriteScheduler::Push(uint32 uiStreamId, const char* pData, size_t uiLength, bool bEndStream)
+{
+    tagStream* pStream = FindStream(uiStreamId);
+    if (pStream == nullptr)
+    {
+        return;
+    }
+    tagStream& stStream = *pStream;
+    Unready(uiStreamId, stStream);
+    if (stStream.uiOffset > 0 && stStream.uiOffset >= stStream.strData.size() / 2)
+    {
+        stStream.strData.erase(0, stStream.uiOffset);
+        stStream.uiOffset = 0;
+    }
+    stStream.strData.append(pData, uiLength);
+    stStream.bEndStream = stStream.bEndStream || bEndStream;
+    m_uiPendingBytes += uiLength;
+    Reschedule(uiStreamId, stStream);
+}
+
+void Http2WriteScheduler::Remove(uint32 uiStreamId)
+{
+    auto iter = m_mapStream.find(uiStreamId);
+    if (iter == m_mapStream.end())
+    {
+        return;
+    }
+    Unready(uiStreamId, iter->second);
+    m_uiPendingBytes -= iter->second.strData.size() - iter->second.uiOffset;
+    m_mapStream.erase(iter);
+}
+
+size_t Http2WriteScheduler::Flush(uint32 uiMaxFrameSize, size_t uiMaxBytes, CBuffer* pBuff)
+{
+    size_t uiWritten = 0;
+    while (!m_setReady.empty() && uiWritten + sc_uiFrameHeadSize <= uiMaxBytes)
+    {
+        auto ready_iter = m_setReady.begin();
+        if (m_llConnectionWindow <= 0)
+        {
+            if (m_uiReadyEmptyEnd == 0)
+            {
+                break;      // 连接窗口耗尽，等待对端WINDOW_UPDATE
+            }
+            // 连接窗口耗尽时仍可以发送空的END_STREAM帧
+            while (ready_iter != m_setReady.end())
+            {
+                const tagStream& stStream = m_mapStream[ready_iter->second];
+                if (stStream.uiOffset == stStream.strData.size())
+                {
+                    break;
+                }
+                ++ready_iter;
+            }
+            if (ready_iter == m_setReady.end())
+            {
+                break;
+            }
+        }
+        uint32 uiStreamId = ready_iter->second;
+        tagStream& stStream = m_mapStream[uiStreamId];
+        size_t uiRemain = stStream.strData.size() - stStream.uiOffset;
+        size_t uiLength = uiRemain;
+        if (uiLength > 0)
+        {
+            uiLength = std::min(uiLength, (size_t)uiMaxFrameSize);
+            uiLength = std::min(uiLength, (size_t)stStream.llWindow);
+            uiLength = std::min(uiLength, (size_t)m_llConnectionWindow);
+            uiLength = std::min(uiLength, uiMaxBytes - uiWritten - sc_uiFrameHeadSize);
+            if (uiLength == 0)
+            {
+                break;
+            }
+        }
+        bool bEndStream = (stStream.bEndStream && uiLength == uiRemain);
+        if (!pBuff->EnsureWritableBytes(sc_uiFrameHeadSize + uiLength))
+        {
+            break;
+        }
+        char* pPos = pBuff->GetRawWriteBuffer();
+        WriteFrameHead(uiLength, bEndStream ? H2_FRAME_FLAG_END_STREAM : 0, uiStreamId, pPos);
+        memcpy(pPos + sc_uiFrameHeadSize, stStream.strData.data() + stStream.uiOffset, uiLength);
+        pBuff->AdvanceWriteIndex(sc_uiFrameHeadSize + uiLength);
+        uiWritten += sc_uiFrameHeadSize + uiLength;
+
+        Unready(uiStreamId, stStream);
+        stStream.uiOffset += uiLength;
+        stStream.llWindow -= uiLength;
+        m_llConnectionWindow -= uiLength;
+        m_uiPendingBytes -= uiLength;
+        if (bEndStream)
+        {
+            m_mapStream.erase(uiStreamId);
+            continue;
+        }
+        // 权重越大虚拟时间增长越慢，空帧也前进一步，保证同一虚拟时间的流轮流发送
+        m_ullVirtualTime = stStream.ullVirtualTime;
+        stStream.ullVirtualTime += std::max((uint64)1, ((uint64)uiLength << 8) / stStream.uiWeight);
+        Reschedule(uiStreamId, stStream);
+    }
+    return(uiWritten);
+}
+
+Http2WriteScheduler::tagStream* Http2WriteScheduler::FindStream(uint32 uiStreamId)
+{
+    auto iter = m_mapStream.find(uiStreamId);
+    if (iter == m_mapStream.end())
+    {
+        return(nullptr);
+    }
+    return(&iter->second);
+}
+
+void Http2WriteScheduler::Reschedule(uint32 uiStreamId, tagStream& stStream)
+{
+    bool bReady = IsReady(stStream);
+    if (bReady == stStream.bReady)
+    {
+        return;
+    }
+    if (!bReady)
+    {
+        Unready(uiStreamId, stStream);
+        return;
+    }
+    // 空闲后重新就绪的流不保留空闲期间的“欠账”，从当前虚拟时间开始，避免突发占满连接
+    stStream.ullVirtualTime = std::max(stStream.ullVirtualTime, m_ullVirtualTime);
+    m_setReady.insert(std::make_pair(stStream.ullVirtualTime, uiStreamId));
+    stStream.bReady = true;
+    if (stStream.uiOffset == stStream.strData.size())
+    {
+        ++m_uiReadyEmptyEnd;
+    }
+}
+
+void Http2WriteScheduler::Unready(uint32 uiStreamId, tagStream& stStream)
+{
+    if (!stStream.bReady)
+    {
+        return;
+    }
+    m_setReady.erase(std::make_pair(stStream.ullVirtualTime, uiStreamId));
+    stStream.bReady = false;
+    if (stStream.uiOffset == stStream.strData.size())
+    {
+        --m_uiReadyEmptyEnd;
+    }
+}
+
+void Http2WriteScheduler::WriteFrameHead(uint32 uiLength, uint8 ucFlag, uint32 uiStreamId, char* pPos)
+{
+    pPos[0] = (char)(uiLength >> 16);
+    pPos[1] = (char)(uiLength >> 8);
+    pPos[2] = (char)uiLength;
+    pPos[3] = (char)H2_FRAME_DATA;
+    pPos[4] = (char)ucFlag;
+    uiStreamId &= H2_DATA_MASK_4_BYTE_LOW_31_BIT;
+    pPos[5] = (char)(uiStreamId >> 24);
+    pPos[6] = (char)(uiStreamId >> 16);
+    pPos[7] = (char)(uiStreamId >> 8);
+    pPos[8] = (char)uiStreamId;
+}
+
+} /* namespace neb */
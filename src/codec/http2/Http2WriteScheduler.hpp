@@ -0,0 +1,148 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     Http2WriteScheduler.hpp
+ * @brief    http2 DATA帧发送调度
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note     各流待发送的数据先进入调度器，发送时按权重公平地交替输出DATA帧：
+ * 每个有数据且流窗口未耗尽的流有一个虚拟时间，每发出一帧虚拟时间增加
+ * 帧长 * 256 / 权重，每次取虚拟时间最小的流（std::set，O(log n)）。单帧不超过
+ * SETTINGS_MAX_FRAME_SIZE，并同时受流窗口和连接窗口限制，因此一个大响应只会
+ * 每轮占用一帧，不会阻塞同一连接上的小响应。
+ * 优先级只采用权重，不采用依赖关系（rfc9113已废弃rfc7540的优先级树）。
+ * Modify history:
+ ******************************************************************************/
+#ifndef SRC_CODEC_HTTP2_HTTP2WRITESCHEDULER_HPP_
+#define SRC_CODEC_HTTP2_HTTP2WRITESCHEDULER_HPP_
+
+#include <set>
+#include <string>
+#include <unordered_map>
+#include "Definition.hpp"
+#include "util/CBuffer.hpp"
+#include "H2Comm.hpp"
+
+namespace neb
+{
+
+class Http2WriteScheduler
+{
+public:
+    Http2WriteScheduler();
+    Http2WriteScheduler(const Http2WriteScheduler&) = delete;
+    Http2WriteScheduler& operator=(const Http2WriteScheduler&) = delete;
+    virtual ~Http2WriteScheduler();
+
+    /**
+     * @brief 对端修改SETTINGS_INITIAL_WINDOW_SIZE，所有流的窗口按差值调整（rfc7540 6.9.2）
+     * @return 调整后有流窗口超过2^31-1时返回false（FLOW_CONTROL_ERROR）
+     */
+    bool SetInitialWindowSize(uint32 uiWindowSize);
+
+    /**
+     * @brief 对端的WINDOW_UPDATE，未登记或已删除的流忽略
+     * @param uiStreamId 流ID，0为连接窗口
+     * @return 窗口超过2^31-1时返回false（FLOW_CONTROL_ERROR）
+     */
+    bool UpdateWindow(uint32 uiStreamId, uint32 uiIncrement);
+
+    /**
+     * @brief 登记新打开的流，流窗口为当前的初始窗口
+     * @note 只有登记过且未删除的流才接受权重、窗口更新和数据，对端可以对任意流ID
+     * 发送PRIORITY和WINDOW_UPDATE，不能因此在调度器中产生条目。
+     */
+    void Add(uint32 uiStreamId);
+
+    /**
+     * @brief 设置流的权重，未登记的流忽略
+     * @param uiWeight 1到256（PRIORITY帧和HEADERS帧中的权重字段加1）
+     */
+    void SetWeight(uint32 uiStreamId, uint32 uiWeight);
+
+    /**
+     * @brief 追加流待发送的数据，未登记或已删除（已发完或被重置）的流丢弃
+     * @param bEndStream 是否是流的最后一段数据（最后一个DATA帧带END_STREAM）
+     */
+    void Push(uint32 uiStreamId, const char* pData, size_t uiLength, bool bEndStream);
+
+    /**
+     * @brief 删除流（流关闭或被重置），未发送的数据丢弃
+     * @note 发出带END_STREAM的帧后流自动删除
+     */
+    void Remove(uint32 uiStreamId);
+
+    /**
+     * @brief 按调度顺序输出DATA帧
+     * @param uiMaxFrameSize 对端的SETTINGS_MAX_FRAME_SIZE
+     * @param uiMaxBytes 本次最多输出的字节数（含帧头），用于按连接的发送能力分批输出，
+     * 其余数据留在调度器中等下次可写时再输出
+     * @param pBuff 输出缓冲区
+     * @return 输出的字节数
+     */
+    size_t Flush(uint32 uiMaxFrameSize, size_t uiMaxBytes, CBuffer* pBuff);
+
+    /**
+     * @brief 是否有可以立即发送的数据（有数据且流窗口和连接窗口都未耗尽）
+     */
+    bool IsWritable() const
+    {
+        return(!m_setReady.empty() && (m_llConnectionWindow > 0 || m_uiReadyEmptyEnd > 0));
+    }
+
+    /**
+     * @brief 所有流待发送的数据总量（受窗口限制暂不能发送的也计算在内）
+     */
+    size_t GetPendingBytes() const
+    {
+        return(m_uiPendingBytes);
+    }
+
+    int64 GetConnectionWindow() const
+    {
+        return(m_llConnectionWindow);
+    }
+
+    static const uint32 sc_uiDefaultWeight = 16;        ///< rfc7540 5.3.5
+    static const uint32 sc_uiFrameHeadSize = 9;
+
+private:
+    struct tagStream
+    {
+        int64 llWindow = 0;                 ///< 流发送窗口，对端减小初始窗口时可能为负
+        uint32 uiWeight = sc_uiDefaultWeight;
+        uint64 ullVirtualTime = 0;
+        std::string strData;                ///< 待发送的数据，从uiOffset开始
+        size_t uiOffset = 0;
+        bool bEndStream = false;            ///< 数据发完后须带END_STREAM
+        bool bReady = false;                ///< 是否在m_setReady中
+    };
+
+    /**
+     * @return 未登记的流返回nullptr
+     */
+    tagStream* FindStream(uint32 uiStreamId);
+    bool IsReady(const tagStream& stStream) const
+    {
+        size_t uiRemain = stStream.strData.size() - stStream.uiOffset;
+        return((uiRemain > 0 && stStream.llWindow > 0) || (uiRemain == 0 && stStream.bEndStream));
+    }
+    /**
+     * @brief 按流当前状态加入或移出就绪集合
+     */
+    void Reschedule(uint32 uiStreamId, tagStream& stStream);
+    void Unready(uint32 uiStreamId, tagStream& stStream);
+    static void WriteFrameHead(uint32 uiLength, uint8 ucFlag, uint32 uiStreamId, char* pPos);
+
+private:
+    int64 m_llConnectionWindow;
+    uint32 m_uiInitialWindowSize;
+    uint64 m_ullVirtualTime;                ///< 最近一次发送的流的虚拟时间，新就绪的流从这里开始
+    size_t m_uiPendingBytes;
+    size_t m_uiReadyEmptyEnd;               ///< 就绪集合中只差一个空的END_STREAM帧的流数量（不受连接窗口限制）
+    std::unordered_map<uint32, tagStream> m_mapStream;
+    std::set<std::pair<uint64, uint32> > m_setReady;     ///< (虚拟时间, 流ID)
+};
+
+} /* namespace neb */
+
+#endif /* SRC_CODEC_HTTP2_HTTP2WRITESCHEDULER_HPP_ */
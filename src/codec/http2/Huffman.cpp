@@ -8,6 +8,8 @@
  * Modify history:
  ******************************************************************************/
 #include <codec/http2/Huffman.hpp>
+#include <cstring>
+#include <arpa/inet.h>
 
 namespace neb
 {
@@ -74,19 +76,12 @@ const uint8_t Huffman::CODE_LENGTHS[] =
 };
 
 Huffman::Huffman()
-    : m_pRoot(nullptr)
 {
-    m_pRoot = new Node();
-    BuildTree();
+    BuildDecodeTable();
 }
 
 Huffman::~Huffman()
 {
-    if (m_pRoot != nullptr)
-    {
-        delete m_pRoot;
-        m_pRoot = nullptr;
-    }
 }
 
 Huffman* Huffman::Instance()
@@ -98,127 +93,153 @@ Huffman* Huffman::Instance()
     return(m_pInstance);
 }
 
-void Huffman::Encode(const std::string& strData, CBuffer* pBuff)
+size_t Huffman::EncodedLength(const std::string& strData)
 {
-    uint32_t uiCurrent = 0;
-    uint32_t uiNotWrittenBits = 0;
-    int iByte = 0;
-    uint32_t uiCode = 0;
-    uint8_t ucBits = 0;
-    uint8_t ucMask = 0xFF;
-
+    size_t uiBits = 0;
     for (size_t i = 0; i < strData.size(); ++i)
     {
-        iByte = strData[i];
-        uiCode = CODES[iByte];
-        ucBits = CODE_LENGTHS[iByte];
-
-        uiCurrent <<= ucBits;
-        uiCurrent |= uiCode;
-        uiNotWrittenBits += ucBits;
+        uiBits += CODE_LENGTHS[(uint8_t)strData[i]];
+    }
+    return((uiBits + 7) / 8);
+}
 
-        while (uiNotWrittenBits >= 8)
+void Huffman::Encode(const std::string& strData, CBuffer* pBuff)
+{
+    size_t uiLength = EncodedLength(strData);
+    if (uiLength == 0 || !pBuff->EnsureWritableBytes(uiLength))
+    {
+        return;
+    }
+    char* pPos = pBuff->GetRawWriteBuffer();
+    uint64_t ullAccumulator = 0;    // 低uiBits位为待写出的码，最长码30位，不会溢出
+    uint32_t uiBits = 0;
+    uint32_t uiWord = 0;
+    for (size_t i = 0; i < strData.size(); ++i)
+    {
+        uint8_t ucSymbol = (uint8_t)strData[i];
+        ullAccumulator = (ullAccumulator << CODE_LENGTHS[ucSymbol]) | CODES[ucSymbol];
+        uiBits += CODE_LENGTHS[ucSymbol];
+        if (uiBits >= 32)
         {
-            uiNotWrittenBits -= 8;
-            pBuff->WriteByte((uiCurrent >> uiNotWrittenBits));
+            uiBits -= 32;
+            uiWord = htonl((uint32_t)(ullAccumulator >> uiBits));
+            memcpy(pPos, &uiWord, 4);
+            pPos += 4;
         }
     }
-
-    if (uiNotWrittenBits > 0)
+    if (uiBits > 0)
     {
-        uiCurrent <<= (8 - uiNotWrittenBits);
-        uiCurrent |= (ucMask >> uiNotWrittenBits);
-        pBuff->WriteByte((uiCurrent));
+        // 不足一个字节的部分以EOS码的高位（全1）补齐
+        uint32_t uiPadding = (8 - (uiBits & 0x07)) & 0x07;
+        ullAccumulator = (ullAccumulator << uiPadding) | ((1u << uiPadding) - 1);
+        uiBits += uiPadding;
+        while (uiBits > 0)
+        {
+            uiBits -= 8;
+            *pPos++ = (char)(ullAccumulator >> uiBits);
+        }
     }
+    pBuff->AdvanceWriteIndex(uiLength);
 }
 
 bool Huffman::Decode(CBuffer* pBuff, int iBuffLength, std::string& strData)
 {
-    Node *pNode = m_pRoot;
-    uint32_t uiCurrent = 0;
-    uint8_t ucBits = 0;
-    char c = 0;
-    for (int i = 0; i < iBuffLength; ++i)
+    strData.clear();
+    if (iBuffLength <= 0)
     {
-        pBuff->ReadByte(c);
-        uiCurrent = (uiCurrent << 8) | c;
-        ucBits += 8;
-        while (ucBits >= 8)
-        {
-            uint32_t uiChild = (uiCurrent >> (ucBits - 8)) & 0xFF;
-            pNode = pNode->vecChildren[uiChild];
-            if (pNode->vecChildren.size() == 0)
-            {
-                // terminal pNode
-                strData.append(1, pNode->ucSymbol);
-                ucBits -= pNode->ucTerminalBits;
-                pNode = m_pRoot;
-            }
-            else
-            {
-                // non-terminal pNode
-                ucBits -= 8;
-            }
-        }
+        return(iBuffLength == 0);
     }
-
-    /* TODO confirm
-       A padding strictly longer than 7 bits MUST be treated as a decoding error.
-       A padding not corresponding to the most significant bits of the code for the EOS symbol MUST be treated as a decoding error.
-       A Huffman-encoded string literal containing the EOS symbol MUST be treated as a decoding error.
-    */
-    while (ucBits > 0)
+    const uint8_t* pData = (const uint8_t*)pBuff->GetRawReadBuffer();
+    strData.resize((size_t)iBuffLength * 8 / 5);    // 最短码长5位
+    char* pOut = &strData[0];
+    uint8_t ucState = 0;
+    uint8_t ucFlags = DECODE_FLAG_ACCEPTED;
+    for (int i = 0; i < iBuffLength; ++i)
     {
-        uint32_t uiChild = (uiCurrent << (8 - ucBits)) & 0xFF;
-        pNode = pNode->vecChildren[uiChild];
-        if (pNode->vecChildren.size() > 0 || pNode->ucTerminalBits > ucBits)
+        const tagDecodeTransition& stHigh = m_aDecodeTable[ucState][pData[i] >> 4];
+        const tagDecodeTransition& stLow = m_aDecodeTable[stHigh.ucState][pData[i] & 0x0F];
+        if ((stHigh.ucFlags | stLow.ucFlags) & DECODE_FLAG_FAIL)
         {
             return(false);
         }
-        strData.append(1, pNode->ucSymbol);
-        ucBits -= pNode->ucTerminalBits;
-        pNode = m_pRoot;
+        if (stHigh.ucFlags & DECODE_FLAG_SYMBOL)
+        {
+            *pOut++ = (char)stHigh.ucSymbol;
+        }
+        if (stLow.ucFlags & DECODE_FLAG_SYMBOL)
+        {
+            *pOut++ = (char)stLow.ucSymbol;
+        }
+        ucState = stLow.ucState;
+        ucFlags = stLow.ucFlags;
     }
-    return(true);
+    pBuff->AdvanceReadIndex(iBuffLength);
+    strData.resize(pOut - strData.data());
+    return(ucFlags & DECODE_FLAG_ACCEPTED);
 }
 
-void Huffman::BuildTree()
+void Huffman::BuildDecodeTable()
 {
-    uint8_t ucSym = 0;
-    uint32_t uiCode = 0;
-    uint8_t ucLen = 0;
-    for (int i = 0; i < 256; i++)
+    // 建哈夫曼树：内部节点编号0为根，子节点值大于0为内部节点编号，小于0为-(字符 + 1)，0为未建立
+    const uint32_t uiEosCode = 0x3fffffff;
+    const uint8_t ucEosLength = 30;
+    const int iEos = 256;
+    int16_t aChild[256][2] = {{0}};
+    uint8_t aucDepth[256] = {0};
+    bool abAccepted[256] = {false};         // 从根到该节点的路径全为1且不超过7位，即可作为填充
+    abAccepted[0] = true;
+    int iNodeNum = 1;
+    for (int iSymbol = 0; iSymbol <= iEos; ++iSymbol)
     {
-        Node* pTerminal = new Node(ucSym, ucLen);
+        uint32_t uiCode = (iSymbol == iEos) ? uiEosCode : CODES[iSymbol];
+        uint8_t ucLength = (iSymbol == iEos) ? ucEosLength : CODE_LENGTHS[iSymbol];
+        int iNode = 0;
+        for (int iBit = ucLength - 1; iBit > 0; --iBit)
+        {
+            int b = (uiCode >> iBit) & 0x01;
+            if (aChild[iNode][b] == 0)
+            {
+                aChild[iNode][b] = iNodeNum;
+                aucDepth[iNodeNum] = aucDepth[iNode] + 1;
+                abAccepted[iNodeNum] = abAccepted[iNode] && b == 1 && aucDepth[iNodeNum] <= 7;
+                ++iNodeNum;
+            }
+            iNode = aChild[iNode][b];
+        }
+        aChild[iNode][uiCode & 0x01] = -(iSymbol + 1);
+    }
 
-        Node* pCurrent = m_pRoot;
-        while (ucLen > 8)
+    // 每个状态（内部节点）每输入4位的转移
+    for (int iState = 0; iState < 256; ++iState)
+    {
+        for (int iNibble = 0; iNibble < 16; ++iNibble)
         {
-            ucLen -= 8;
-            int i = ((uiCode >> ucLen) & 0xFF);
-            if (pCurrent->vecChildren.size() > 0)
+            tagDecodeTransition& stTransition = m_aDecodeTable[iState][iNibble];
+            int iNode = iState;
+            for (int iBit = 3; iBit >= 0; --iBit)
             {
-                if (pCurrent->vecChildren[i] == nullptr)
+                int iChild = aChild[iNode][(iNibble >> iBit) & 0x01];
+                if (iChild >= 0)
+                {
+                    iNode = iChild;
+                    continue;
+                }
+                if (-iChild - 1 == iEos)
                 {
-                    pCurrent->vecChildren[i] = new Node();
+                    stTransition.ucFlags |= DECODE_FLAG_FAIL;
+                    break;
                 }
-                pCurrent = pCurrent->vecChildren[i];
+                stTransition.ucFlags |= DECODE_FLAG_SYMBOL;
+                stTransition.ucSymbol = (uint8_t)(-iChild - 1);
+                iNode = 0;
             }
-            else    // Impossible to reach
+            stTransition.ucState = (uint8_t)iNode;
+            if (abAccepted[iNode])
             {
-                ; //error
+                stTransition.ucFlags |= DECODE_FLAG_ACCEPTED;
             }
         }
-
-        uint8_t ucShift = 8 - ucLen;
-        uint32_t uiStart = (uiCode << ucShift) & 0xFF;
-        uint32_t uiEnd = 1 << ucShift;
-        for (uint32_t i = uiStart; i < uiStart + uiEnd; i++)
-        {
-            pCurrent->vecChildren[i] = pTerminal;
-        }
     }
 }
 
 } /* namespace neb */
-
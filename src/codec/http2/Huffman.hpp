@@ -11,71 +11,18 @@
 #define SRC_CODEC_HTTP2_HUFFMAN_HPP_
 
 #include <string>
-#include <vector>
 #include "util/CBuffer.hpp"
 
 namespace neb
 {
 
-struct Node
-{
-    // Terminal nodes have a symbol.
-    uint8_t ucSymbol;
-    // Number of bits represented in the terminal node.
-    uint8_t ucTerminalBits;
-    // size() = 0 if terminal.
-    std::vector<Node*> vecChildren;
-
-    Node()
-    {
-        ucSymbol = 0;
-        ucTerminalBits = 0;
-        vecChildren.resize(256, nullptr);
-    }
-
-    Node(uint8_t ucSym, uint8_t ucBits)
-    {
-        ucSymbol = ucSym;
-        uint8_t b = ucBits & 0x07;
-        ucTerminalBits = (b == 0) ? 8 : b;
-    }
-
-    Node(const Node& stNode) = delete;
-
-    Node(Node&& stNode)
-    {
-        ucSymbol = stNode.ucSymbol;
-        stNode.ucSymbol = 0;
-        ucTerminalBits = stNode.ucTerminalBits;
-        stNode.ucTerminalBits = 0;
-        vecChildren = std::move(stNode.vecChildren);
-    }
-
-    virtual ~Node()
-    {
-        for (auto it = vecChildren.begin(); it != vecChildren.end(); ++it)
-        {
-            if (*it != nullptr)
-            {
-                delete (*it);
-            }
-        }
-        vecChildren.clear();
-    }
-
-    Node& operator=(const Node& stNode) = delete;
-
-    Node& operator=(Node&& stNode)
-    {
-        ucSymbol = stNode.ucSymbol;
-        stNode.ucSymbol = 0;
-        ucTerminalBits = stNode.ucTerminalBits;
-        stNode.ucTerminalBits = 0;
-        vecChildren = std::move(stNode.vecChildren);
-        return(*this);
-    }
-};
-
+/**
+ * @brief HPACK哈夫曼编解码（rfc7541 5.2，码表见附录B）
+ * @note 解码用状态机：状态为哈夫曼树的内部节点（共256个），每次输入4位，查表得到下一个
+ * 状态、解出的字符（最短码长为5，每次至多解出一个字符）以及是否出错、当前位置是否可以
+ * 结束。编码把码字累积到64位整数中，满32位写出一个字。两者都先按最大长度预留输出空间，
+ * 不逐字节调用CBuffer和std::string的接口。
+ */
 class Huffman
 {
 public:
@@ -83,15 +30,43 @@ public:
 
     static Huffman* Instance();
 
+    /**
+     * @brief 哈夫曼编码后的长度（字节）
+     */
+    static size_t EncodedLength(const std::string& strData);
+
+    /**
+     * @brief 编码strData并写入pBuff（不含长度前缀），末尾以EOS码的高位补齐
+     */
     void Encode(const std::string& strData, CBuffer* pBuff);
+
+    /**
+     * @brief 从pBuff读取iBuffLength字节解码，结果替换strData原有的内容
+     * @return 填充超过7位、填充不是EOS码的高位、或含EOS码时返回false（rfc7541 5.2）
+     */
     bool Decode(CBuffer* pBuff, int iBuffLength, std::string& strData);
 
 protected:
-    void BuildTree();
+    void BuildDecodeTable();
 
 private:
     Huffman();
-    Node* m_pRoot;
+
+    enum E_DECODE_FLAG
+    {
+        DECODE_FLAG_ACCEPTED    = 0x01,     ///< 转移后的位置可以作为结束（此前的位都是完整的码或EOS码的高位）
+        DECODE_FLAG_SYMBOL      = 0x02,     ///< 转移过程中解出了一个字符
+        DECODE_FLAG_FAIL        = 0x04,     ///< 解出了EOS码
+    };
+
+    struct tagDecodeTransition
+    {
+        uint8_t ucState = 0;
+        uint8_t ucFlags = 0;
+        uint8_t ucSymbol = 0;
+    };
+
+    tagDecodeTransition m_aDecodeTable[256][16];
 
     static Huffman* m_pInstance;
     static const uint32_t CODES[];
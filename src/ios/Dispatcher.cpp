@@ -10,13 +10,23 @@
 
 #include "Dispatcher.hpp"
 #include <algorithm>
+#ifdef __linux__
+#include <linux/filter.h>
+#endif
 #include "Definition.hpp"
 #include "labor/Labor.hpp"
 #include "labor/Manager.hpp"
+#include "util/MemoryPool.hpp"
+#include "pb/report.pb.h"
+#include "actor/cmd/CW.hpp"
 #include "labor/Worker.hpp"
 #include "actor/Actor.hpp"
 #include "actor/step/Step.hpp"
 #include "actor/step/RedisStep.hpp"
+#include "codec/RespView.hpp"
+#include "codec/RespCmd.hpp"
+#include "codec/CodecHttp.hpp"
+#include "channel/SendQueue.hpp"
 #include "actor/session/sys_session/manager/SessionManager.hpp"
 
 namespace neb
@@ -24,7 +34,10 @@ namespace neb
 
 Dispatcher::Dispatcher(Labor* pLabor, std::shared_ptr<NetLogger> pLogger)
    : m_pErrBuff(NULL), m_pLabor(pLabor), m_loop(NULL), m_iClientNum(0), m_lLastCheckNodeTime(0),
-     m_pLogger(pLogger), m_pSessionNode(nullptr)
+     m_dLastEndpointReportTime(0.0), m_pResolveWatcher(NULL),
+     m_pLogger(pLogger), m_pSessionNode(nullptr),
+     m_oTimingWheel((uint64)GetMonotonicTimeMs()), m_pTimingWheelWatcher(NULL),
+     m_ullTimingWheelWakeTick(UINT64_MAX)
 {
     m_pErrBuff = (char*)malloc(gc_iErrBuffLen);
 
@@ -81,18 +94,50 @@ void Dispatcher::PeriodicTaskCallback(struct ev_loop* loop, ev_timer* watcher, i
         {
             ((Manager*)(pDispatcher->m_pLabor))->GetSessionManager()->CheckWorker();
             ((Manager*)(pDispatcher->m_pLabor))->RefreshServer();
+            ((Manager*)(pDispatcher->m_pLabor))->RotateSslTicketKey();
         }
         else
         {
             ((Worker*)(pDispatcher->m_pLabor))->CheckParent();
         }
         pDispatcher->CheckFailedNode();
+        pDispatcher->CheckEndpointPool();
+        pDispatcher->CheckRedisTracking();
+        SendQueue::CheckParkedZeroCopy();
     }
     ev_timer_stop (loop, watcher);
     ev_timer_set (watcher, NODE_BEAT + ev_time() - ev_now(loop), 0);
     ev_timer_start (loop, watcher);
 }
 
+void Dispatcher::TimingWheelCallback(struct ev_loop* loop, ev_timer* watcher, int revents)
+{
+    if (watcher->data != NULL)
+    {
+        Dispatcher* pDispatcher = (Dispatcher*)(watcher->data);
+        pDispatcher->OnTimingWheelTimeout();
+    }
+}
+
+void Dispatcher::ResolveCallback(struct ev_loop* loop, ev_async* watcher, int revents)
+{
+    if (watcher->data != NULL)
+    {
+        Dispatcher* pDispatcher = (Dispatcher*)(watcher->data);
+        pDispatcher->OnResolved();
+    }
+}
+
+void Dispatcher::ResolveTimeoutCallback(TimingWheel::tagTimer* pTimer)
+{
+    if (pTimer->data != NULL)
+    {
+        tagPendingResolve* pPending = (tagPendingResolve*)pTimer->data;
+        std::string strHost = pPending->strHost;   // OnResolveTimeout()会释放pPending
+        pPending->pDispatcher->OnResolveTimeout(strHost);
+    }
+}
+
 void Dispatcher::SignalCallback(struct ev_loop* loop, struct ev_signal* watcher, int revents)
 {
     if (watcher->data != NULL)
@@ -144,6 +189,12 @@ bool Dispatcher::OnIoRead(std::shared_ptr<SocketChannel> pChannel)
         {
             return(FdTransfer(pChannel->m_pImpl->GetFd()));
         }
+        else if (((Worker*)m_pLabor)->GetWorkerInfo().iC2SListenFd > 2
+                && pChannel->m_pImpl->GetFd() == ((Worker*)m_pLabor)->GetWorkerInfo().iC2SListenFd)
+        {
+            return(AcceptClientConn(((Worker*)m_pLabor)->GetWorkerInfo().iC2SListenFd,
+                    ((Worker*)m_pLabor)->GetWorkerInfo().iC2SFamily));
+        }
         else
         {
             return(DataRecvAndHandle(pChannel));
@@ -164,7 +215,8 @@ bool Dispatcher::DataRecvAndHandle(std::shared_ptr<SocketChannel> pChannel)
         case CODEC_HTTP:
             for (int i = 0; ; ++i)
             {
-                HttpMsg oHttpMsg;
+                MessagePool<HttpMsg>::Holder oHttpMsgHolder(m_oHttpMsgPool);
+                HttpMsg& oHttpMsg = *oHttpMsgHolder;
                 if (0 == i)
                 {
                     eCodecStatus = pChannel->m_pImpl->Recv(oHttpMsg);
@@ -191,19 +243,30 @@ bool Dispatcher::DataRecvAndHandle(std::shared_ptr<SocketChannel> pChannel)
         case CODEC_RESP:
             for (int i = 0; ; ++i)
             {
-                RedisMsg oRedisMsg;
+                // 零拷贝解码，需要RedisReply的回调再从回收池取消息转换（见Step::Callback()）
+                RespView oRespView;
                 if (0 == i)
                 {
-                    eCodecStatus = pChannel->m_pImpl->Recv(oRedisMsg);
+                    eCodecStatus = pChannel->m_pImpl->Recv(oRespView);
                 }
                 else
                 {
-                    eCodecStatus = pChannel->m_pImpl->Fetch(oRedisMsg);
+                    eCodecStatus = pChannel->m_pImpl->Fetch(oRespView);
                 }
 
                 if (CODEC_STATUS_OK == eCodecStatus)
                 {
-                    m_pLabor->GetActorBuilder()->OnMessage(pChannel, oRedisMsg);
+                    if (m_oRedisNearCache.IsTrackingChannel(pChannel.get()))
+                    {
+                        if (!OnRedisTrackingMessage(pChannel, oRespView))
+                        {
+                            return(false);
+                        }
+                    }
+                    else
+                    {
+                        m_pLabor->GetActorBuilder()->OnMessage(pChannel, oRespView);
+                    }
                 }
                 else
                 {
@@ -216,7 +279,6 @@ bool Dispatcher::DataRecvAndHandle(std::shared_ptr<SocketChannel> pChannel)
             CBuffer oBuff;
             for (int i = 0; ; ++i)
             {
-                RedisMsg oRedisMsg;
                 if (0 == i)
                 {
                     eCodecStatus = pChannel->m_pImpl->Recv(oBuff);
@@ -240,8 +302,10 @@ bool Dispatcher::DataRecvAndHandle(std::shared_ptr<SocketChannel> pChannel)
         default:
             for (int i = 0; ; ++i)
             {
-                MsgHead oMsgHead;
-                MsgBody oMsgBody;
+                MessagePool<MsgHead>::Holder oMsgHeadHolder(m_oMsgHeadPool);
+                MessagePool<MsgBody>::Holder oMsgBodyHolder(m_oMsgBodyPool);
+                MsgHead& oMsgHead = *oMsgHeadHolder;
+                MsgBody& oMsgBody = *oMsgBodyHolder;
                 if (0 == i)
                 {
                     eCodecStatus = pChannel->m_pImpl->Recv(oMsgHead, oMsgBody);
@@ -314,28 +378,42 @@ bool Dispatcher::DataFetchAndHandle(std::shared_ptr<SocketChannel> pChannel)
     switch(pChannel->GetCodecType())
     {
         case CODEC_HTTP:
+            for (int i = 0; ; ++i)
             {
-                HttpMsg oHttpMsg;
+                // 每个消息单独从回收池取，回调中被RetainMessage()接管的消息不会被下一次解码覆盖
+                MessagePool<HttpMsg>::Holder oHttpMsgHolder(m_oHttpMsgPool);
+                HttpMsg& oHttpMsg = *oHttpMsgHolder;
                 eCodecStatus = pChannel->m_pImpl->Fetch(oHttpMsg);
-                while (CODEC_STATUS_OK == eCodecStatus)
+                if (CODEC_STATUS_OK == eCodecStatus)
                 {
                     m_pLabor->GetActorBuilder()->OnMessage(pChannel, oHttpMsg);
-                    eCodecStatus = pChannel->m_pImpl->Fetch(oHttpMsg);
+                    continue;
                 }
                 if (CODEC_STATUS_EOF == eCodecStatus && oHttpMsg.ByteSize() > 10) // http1.0 client close
                 {
                     m_pLabor->GetActorBuilder()->OnMessage(pChannel, oHttpMsg);
                 }
+                break;
             }
             break;
         case CODEC_RESP:
             for (int i = 0; ; ++i)
             {
-                RedisMsg oRedisMsg;
-                eCodecStatus = pChannel->m_pImpl->Fetch(oRedisMsg);
+                RespView oRespView;
+                eCodecStatus = pChannel->m_pImpl->Fetch(oRespView);
                 if (CODEC_STATUS_OK == eCodecStatus)
                 {
-                    m_pLabor->GetActorBuilder()->OnMessage(pChannel, oRedisMsg);
+                    if (m_oRedisNearCache.IsTrackingChannel(pChannel.get()))
+                    {
+                        if (!OnRedisTrackingMessage(pChannel, oRespView))
+                        {
+                            return(false);
+                        }
+                    }
+                    else
+                    {
+                        m_pLabor->GetActorBuilder()->OnMessage(pChannel, oRespView);
+                    }
                 }
                 else
                 {
@@ -348,7 +426,6 @@ bool Dispatcher::DataFetchAndHandle(std::shared_ptr<SocketChannel> pChannel)
             CBuffer oBuff;
             for (int i = 0; ; ++i)
             {
-                RedisMsg oRedisMsg;
                 eCodecStatus = pChannel->m_pImpl->Fetch(oBuff);
                 if (CODEC_STATUS_OK == eCodecStatus)
                 {
@@ -364,8 +441,10 @@ bool Dispatcher::DataFetchAndHandle(std::shared_ptr<SocketChannel> pChannel)
         default:
             for (int i = 0; ; ++i)
             {
-                MsgHead oMsgHead;
-                MsgBody oMsgBody;
+                MessagePool<MsgHead>::Holder oMsgHeadHolder(m_oMsgHeadPool);
+                MessagePool<MsgBody>::Holder oMsgBodyHolder(m_oMsgBodyPool);
+                MsgHead& oMsgHead = *oMsgHeadHolder;
+                MsgBody& oMsgBody = *oMsgBodyHolder;
                 eCodecStatus = pChannel->m_pImpl->Fetch(oMsgHead, oMsgBody);
                 if (CODEC_STATUS_OK == eCodecStatus)
                 {
@@ -441,111 +520,117 @@ bool Dispatcher::FdTransfer(int iFd)
     }
     else
     {
-        if (iAiFamily != PF_UNIX)
+        return(CreateAcceptedChannel(iAcceptFd, iAiFamily, iCodec));
+    }
+    return(false);
+}
+
+bool Dispatcher::CreateAcceptedChannel(int iAcceptFd, int iAiFamily, int iCodec)
+{
+    if (iAiFamily != PF_UNIX)
+    {
+        int iKeepAlive = 1;
+        int iKeepIdle = 60;
+        int iKeepInterval = 5;
+        int iKeepCount = 3;
+        int iTcpNoDelay = 1;
+        if (setsockopt(iAcceptFd, SOL_SOCKET, SO_KEEPALIVE, (void*)&iKeepAlive, sizeof(iKeepAlive)) < 0)
         {
-            int iKeepAlive = 1;
-            int iKeepIdle = 60;
-            int iKeepInterval = 5;
-            int iKeepCount = 3;
-            int iTcpNoDelay = 1;
-            if (setsockopt(iAcceptFd, SOL_SOCKET, SO_KEEPALIVE, (void*)&iKeepAlive, sizeof(iKeepAlive)) < 0)
-            {
-                LOG4_WARNING("fail to set SO_KEEPALIVE");
-            }
-            if (setsockopt(iAcceptFd, IPPROTO_TCP, TCP_KEEPIDLE, (void*) &iKeepIdle, sizeof(iKeepIdle)) < 0)
-            {
-                LOG4_WARNING("fail to set TCP_KEEPIDLE");
-            }
-            if (setsockopt(iAcceptFd, IPPROTO_TCP, TCP_KEEPINTVL, (void *)&iKeepInterval, sizeof(iKeepInterval)) < 0)
-            {
-                LOG4_WARNING("fail to set TCP_KEEPINTVL");
-            }
-            if (setsockopt(iAcceptFd, IPPROTO_TCP, TCP_KEEPCNT, (void*)&iKeepCount, sizeof (iKeepCount)) < 0)
-            {
-                LOG4_WARNING("fail to set TCP_KEEPCNT");
-            }
-            if (setsockopt(iAcceptFd, IPPROTO_TCP, TCP_NODELAY, (void*)&iTcpNoDelay, sizeof(iTcpNoDelay)) < 0)
-            {
-                LOG4_WARNING("fail to set TCP_NODELAY");
-            }
+            LOG4_WARNING("fail to set SO_KEEPALIVE");
         }
-        std::shared_ptr<SocketChannel> pChannel = nullptr;
-        LOG4_TRACE("fd[%d] transfer successfully.", iAcceptFd);
-        if (CODEC_NEBULA != iCodec && m_pLabor->WithSsl())
+        if (setsockopt(iAcceptFd, IPPROTO_TCP, TCP_KEEPIDLE, (void*) &iKeepIdle, sizeof(iKeepIdle)) < 0)
         {
-            pChannel = CreateSocketChannel(iAcceptFd, E_CODEC_TYPE(iCodec), false, true);
+            LOG4_WARNING("fail to set TCP_KEEPIDLE");
         }
-        else
+        if (setsockopt(iAcceptFd, IPPROTO_TCP, TCP_KEEPINTVL, (void *)&iKeepInterval, sizeof(iKeepInterval)) < 0)
+        {
+            LOG4_WARNING("fail to set TCP_KEEPINTVL");
+        }
+        if (setsockopt(iAcceptFd, IPPROTO_TCP, TCP_KEEPCNT, (void*)&iKeepCount, sizeof (iKeepCount)) < 0)
+        {
+            LOG4_WARNING("fail to set TCP_KEEPCNT");
+        }
+        if (setsockopt(iAcceptFd, IPPROTO_TCP, TCP_NODELAY, (void*)&iTcpNoDelay, sizeof(iTcpNoDelay)) < 0)
         {
-            pChannel = CreateSocketChannel(iAcceptFd, E_CODEC_TYPE(iCodec), false, false);
+            LOG4_WARNING("fail to set TCP_NODELAY");
         }
-        if (nullptr != pChannel)
+    }
+    std::shared_ptr<SocketChannel> pChannel = nullptr;
+    LOG4_TRACE("fd[%d] transfer successfully.", iAcceptFd);
+    if (CODEC_NEBULA != iCodec && m_pLabor->WithSsl())
+    {
+        pChannel = CreateSocketChannel(iAcceptFd, E_CODEC_TYPE(iCodec), false, true);
+    }
+    else
+    {
+        pChannel = CreateSocketChannel(iAcceptFd, E_CODEC_TYPE(iCodec), false, false);
+    }
+    if (nullptr != pChannel)
+    {
+        if (AF_INET == iAiFamily)
         {
-            if (AF_INET == iAiFamily)
+            char szClientAddr[64] = {0};
+            int z;                          /* status return code */
+            struct sockaddr_in stClientAddr;
+            socklen_t iClientAddrSize = sizeof(stClientAddr);
+            z = getpeername(iAcceptFd, (struct sockaddr *)&stClientAddr, &iClientAddrSize);
+            if (z == 0)
             {
-                char szClientAddr[64] = {0};
-                int z;                          /* status return code */
-                struct sockaddr_in stClientAddr;
-                socklen_t iClientAddrSize = sizeof(stClientAddr);
-                z = getpeername(iAcceptFd, (struct sockaddr *)&stClientAddr, &iClientAddrSize);
-                if (z == 0)
-                {
-                    inet_ntop(AF_INET, &stClientAddr.sin_addr, szClientAddr, sizeof(szClientAddr));
-                    LOG4_TRACE("set fd %d's remote addr \"%s\"", iAcceptFd, szClientAddr);
-                    pChannel->m_pImpl->SetRemoteAddr(std::string(szClientAddr));
-                }
-                else
-                {
-                    LOG4_ERROR("getpeername error %d", errno);
-                }
+                inet_ntop(AF_INET, &stClientAddr.sin_addr, szClientAddr, sizeof(szClientAddr));
+                LOG4_TRACE("set fd %d's remote addr \"%s\"", iAcceptFd, szClientAddr);
+                pChannel->m_pImpl->SetRemoteAddr(std::string(szClientAddr));
             }
-            else if (AF_INET6 == iAiFamily)  // AF_INET6
+            else
             {
-                char szClientAddr[64] = {0};
-                int z;                          /* status return code */
-                struct sockaddr_in6 stClientAddr;
-                socklen_t iClientAddrSize = sizeof(stClientAddr);
-                z = getpeername(iAcceptFd, (struct sockaddr *)&stClientAddr, &iClientAddrSize);
-                if (z == 0)
-                {
-                    inet_ntop(AF_INET6, &stClientAddr.sin6_addr, szClientAddr, sizeof(szClientAddr));
-                    LOG4_TRACE("set fd %d's remote addr \"%s\"", iAcceptFd, szClientAddr);
-                    pChannel->m_pImpl->SetRemoteAddr(std::string(szClientAddr));
-                }
-                else
-                {
-                    LOG4_ERROR("getpeername error %d", errno);
-                }
+                LOG4_ERROR("getpeername error %d", errno);
             }
-            AddIoReadEvent(pChannel);
-            if (CODEC_NEBULA == iCodec)
+        }
+        else if (AF_INET6 == iAiFamily)  // AF_INET6
+        {
+            char szClientAddr[64] = {0};
+            int z;                          /* status return code */
+            struct sockaddr_in6 stClientAddr;
+            socklen_t iClientAddrSize = sizeof(stClientAddr);
+            z = getpeername(iAcceptFd, (struct sockaddr *)&stClientAddr, &iClientAddrSize);
+            if (z == 0)
             {
-                AddIoTimeout(pChannel, m_pLabor->GetNodeInfo().dIoTimeout);
-                std::shared_ptr<Step> pStepTellWorker
-                    = m_pLabor->GetActorBuilder()->MakeSharedStep(nullptr, "neb::StepTellWorker", pChannel);
-                if (nullptr == pStepTellWorker)
-                {
-                    return(false);
-                }
-                pStepTellWorker->Emit(ERR_OK);
+                inet_ntop(AF_INET6, &stClientAddr.sin6_addr, szClientAddr, sizeof(szClientAddr));
+                LOG4_TRACE("set fd %d's remote addr \"%s\"", iAcceptFd, szClientAddr);
+                pChannel->m_pImpl->SetRemoteAddr(std::string(szClientAddr));
             }
-            else if (CODEC_NEBULA_IN_NODE == iCodec)
+            else
             {
-                pChannel->m_pImpl->SetChannelStatus(CHANNEL_STATUS_ESTABLISHED);
-                m_mapLoaderAndWorkerChannel.insert(std::make_pair(pChannel->GetFd(), pChannel));
-                m_iterLoaderAndWorkerChannel = m_mapLoaderAndWorkerChannel.begin();
+                LOG4_ERROR("getpeername error %d", errno);
             }
-            else
+        }
+        AddIoReadEvent(pChannel);
+        if (CODEC_NEBULA == iCodec)
+        {
+            AddIoTimeout(pChannel, m_pLabor->GetNodeInfo().dIoTimeout);
+            std::shared_ptr<Step> pStepTellWorker
+                = m_pLabor->GetActorBuilder()->MakeSharedStep(nullptr, "neb::StepTellWorker", pChannel);
+            if (nullptr == pStepTellWorker)
             {
-                pChannel->m_pImpl->SetChannelStatus(CHANNEL_STATUS_ESTABLISHED);
-                AddIoTimeout(pChannel, 1.0);     // 为了防止大量连接攻击，初始化连接只有一秒即超时，在正常发送第一个数据包之后才采用正常配置的网络IO超时检查
+                return(false);
             }
-            return(true);
+            pStepTellWorker->Emit(ERR_OK);
         }
-        else    // 没有足够资源分配给新连接，直接close掉
+        else if (CODEC_NEBULA_IN_NODE == iCodec)
         {
-            close(iAcceptFd);
+            pChannel->m_pImpl->SetChannelStatus(CHANNEL_STATUS_ESTABLISHED);
+            m_mapLoaderAndWorkerChannel.insert(std::make_pair(pChannel->GetFd(), pChannel));
+            m_iterLoaderAndWorkerChannel = m_mapLoaderAndWorkerChannel.begin();
         }
+        else
+        {
+            pChannel->m_pImpl->SetChannelStatus(CHANNEL_STATUS_ESTABLISHED);
+            AddIoTimeout(pChannel, 1.0);     // 为了防止大量连接攻击，初始化连接只有一秒即超时，在正常发送第一个数据包之后才采用正常配置的网络IO超时检查
+        }
+        return(true);
+    }
+    else    // 没有足够资源分配给新连接，直接close掉
+    {
+        close(iAcceptFd);
     }
     return(false);
 }
@@ -672,6 +757,17 @@ bool Dispatcher::OnClientConnFrequencyTimeout(tagClientConnWatcherData* pData, e
     return(bRes);
 }
 
+void Dispatcher::OnTimingWheelTimeout()
+{
+    m_ullTimingWheelWakeTick = UINT64_MAX;
+    m_oTimingWheel.Advance((uint64)GetMonotonicTimeMs());
+    uint64 ullWakeTick = 0;
+    if (m_oTimingWheel.GetNextWakeTick(ullWakeTick))
+    {
+        ScheduleTimingWheel(ullWakeTick);
+    }
+}
+
 void Dispatcher::EventRun()
 {
     ev_run (m_loop, 0);
@@ -736,6 +832,427 @@ bool Dispatcher::SendDataReport(int32 iCmd, uint32 uiSeq, const MsgBody& oMsgBod
     }
 }
 
+std::shared_ptr<SocketChannel> Dispatcher::Connect(const std::string& strHost, int iPort, E_CODEC_TYPE eCodecType, bool bWithSsl)
+{
+    Resolver::tagAddress stAddress;
+    int iErrCode = 0;
+    Resolver::E_RESOLVE_STATUS eResolveStatus = m_oResolver.Lookup(strHost, iPort, stAddress, iErrCode, ev_now(m_loop));
+    if (Resolver::RESOLVE_NEGATIVE == eResolveStatus)
+    {
+        LOG4_ERROR("getaddrinfo(\"%s\", \"%d\") error %d: %s (cached)",
+                strHost.c_str(), iPort, iErrCode, gai_strerror(iErrCode));
+        return(nullptr);
+    }
+    // 未命中缓存时地址族未知，先按IPv4创建socket，解析结果为IPv6时再替换
+    int iFamily = (Resolver::RESOLVE_HIT == eResolveStatus) ? stAddress.stAddr.ss_family : AF_INET;
+    int iFd = CreateConnectFd(iFamily);
+    if (iFd == -1)
+    {
+        LOG4_ERROR("Could not connect to \"%s:%d\"", strHost.c_str(), iPort);
+        return(nullptr);
+    }
+    std::shared_ptr<SocketChannel> pChannel = CreateSocketChannel(iFd, eCodecType, true, bWithSsl);
+    if (nullptr == pChannel)    // 没有足够资源分配给新连接，直接close掉
+    {
+        close(iFd);
+        return(nullptr);
+    }
+    pChannel->m_pImpl->SetRemoteAddr(strHost);
+    if (Resolver::RESOLVE_HIT == eResolveStatus)
+    {
+        ConnectResolved(pChannel, stAddress, iFamily);
+        return(pChannel);
+    }
+
+    if (!m_oResolver.Resolve(strHost))
+    {
+        LOG4_ERROR("failed to resolve \"%s\"", strHost.c_str());
+        DiscardSocketChannel(pChannel, false);
+        return(nullptr);
+    }
+    LOG4_TRACE("resolving \"%s\" for fd %d", strHost.c_str(), iFd);
+    pChannel->m_pImpl->SetResolving(true);
+    tagPendingResolve& stPending = m_mapPendingResolve[strHost];
+    if (stPending.vecChannel.empty())
+    {
+        stPending.pDispatcher = this;
+        stPending.strHost = strHost;
+        stPending.stTimer.data = &stPending;    // unordered_map的元素地址在rehash时不变
+        AddEvent(&stPending.stTimer, ResolveTimeoutCallback, m_pLabor->GetNodeInfo().dDnsTimeout);
+    }
+    tagPendingChannel stPendingChannel;
+    stPendingChannel.pChannel = pChannel;
+    stPendingChannel.iPort = iPort;
+    stPendingChannel.iFamily = iFamily;
+    stPending.vecChannel.push_back(stPendingChannel);
+    return(pChannel);
+}
+
+int Dispatcher::CreateConnectFd(int iFamily)
+{
+    int iFd = socket(iFamily, SOCK_STREAM, IPPROTO_IP);
+    if (iFd == -1)
+    {
+        return(-1);
+    }
+    x_sock_set_block(iFd, 0);
+    int nREUSEADDR = 1;
+    int iKeepAlive = 1;
+    int iKeepIdle = 60;
+    int iKeepInterval = 5;
+    int iKeepCount = 3;
+    int iTcpNoDelay = 1;
+    int iTcpQuickAck = 1;
+    setsockopt(iFd, SOL_SOCKET, SO_REUSEADDR, (const char*)&nREUSEADDR, sizeof(int));
+    setsockopt(iFd, SOL_SOCKET, SO_KEEPALIVE, (void*)&iKeepAlive, sizeof(iKeepAlive));
+    setsockopt(iFd, IPPROTO_TCP, TCP_KEEPIDLE, (void*) &iKeepIdle, sizeof(iKeepIdle));
+    setsockopt(iFd, IPPROTO_TCP, TCP_KEEPINTVL, (void *)&iKeepInterval, sizeof(iKeepInterval));
+    setsockopt(iFd, IPPROTO_TCP, TCP_KEEPCNT, (void*)&iKeepCount, sizeof (iKeepCount));
+    setsockopt(iFd, IPPROTO_TCP, TCP_NODELAY, (void*)&iTcpNoDelay, sizeof(iTcpNoDelay));
+    setsockopt(iFd, IPPROTO_TCP, TCP_QUICKACK, (void*)&iTcpQuickAck, sizeof(iTcpQuickAck));
+    return(iFd);
+}
+
+bool Dispatcher::ConnectResolved(std::shared_ptr<SocketChannel> pChannel, const Resolver::tagAddress& stAddress, int iFamily)
+{
+    int iFd = pChannel->m_pImpl->GetFd();
+    if (iFamily != stAddress.stAddr.ss_family)
+    {
+        // 以新socket替换同一fd，连接对象及其在m_mapSocketChannel中的位置保持不变（此时fd尚未加入IO事件）
+        int iNewFd = CreateConnectFd(stAddress.stAddr.ss_family);
+        if (iNewFd == -1)
+        {
+            return(false);
+        }
+        if (dup2(iNewFd, iFd) < 0)
+        {
+            close(iNewFd);
+            return(false);
+        }
+        close(iNewFd);
+    }
+    pChannel->m_pImpl->SetResolving(false);
+    connect(iFd, (const struct sockaddr*)&stAddress.stAddr, stAddress.uiAddrLen);
+    AddIoTimeout(pChannel, 1.5);
+    AddIoReadEvent(pChannel);
+    AddIoWriteEvent(pChannel);
+    return(true);
+}
+
+void Dispatcher::ResolveFailed(std::shared_ptr<SocketChannel> pChannel, const std::string& strErrMsg)
+{
+    LOG4_ERROR("fd %d: %s", pChannel->m_pImpl->GetFd(), strErrMsg.c_str());
+    if (!pChannel->m_pImpl->GetIdentify().empty())
+    {
+        m_pSessionNode->NodeFailed(pChannel->GetIdentify());
+    }
+    auto& listUncompletedStep = pChannel->m_pImpl->GetPipelineStepSeq();
+    for (auto it = listUncompletedStep.begin();
+            it != listUncompletedStep.end(); ++it)
+    {
+        m_pLabor->GetActorBuilder()->OnError(pChannel, *it, ERR_CONNECTION, strErrMsg);
+    }
+    pChannel->m_pImpl->SetResolving(false);
+    DiscardSocketChannel(pChannel);
+}
+
+void Dispatcher::OnResolved()
+{
+    m_vecResolveResult.clear();
+    m_oResolver.FetchResult(m_vecResolveResult);
+    ev_tstamp dNow = ev_now(m_loop);
+    for (auto& stResult : m_vecResolveResult)
+    {
+        if (0 == stResult.iErrCode)
+        {
+            m_oResolver.Update(stResult, dNow, m_pLabor->GetNodeInfo().dDnsCacheTtl);
+        }
+        else
+        {
+            LOG4_ERROR("getaddrinfo(\"%s\") error %d: %s", stResult.strHost.c_str(),
+                    stResult.iErrCode, gai_strerror(stResult.iErrCode));
+            m_oResolver.Update(stResult, dNow, m_pLabor->GetNodeInfo().dDnsNegativeTtl);
+        }
+        auto iter = m_mapPendingResolve.find(stResult.strHost);
+        if (iter == m_mapPendingResolve.end())
+        {
+            continue;
+        }
+        std::vector<tagPendingChannel> vecChannel;
+        vecChannel.swap(iter->second.vecChannel);
+        m_mapPendingResolve.erase(iter);
+        Resolver::tagAddress stAddress;
+        for (auto& stPendingChannel : vecChannel)
+        {
+            std::shared_ptr<SocketChannel> pChannel = stPendingChannel.pChannel.lock();
+            if (nullptr == pChannel || CHANNEL_STATUS_CLOSED == pChannel->m_pImpl->GetChannelStatus())
+            {
+                continue;
+            }
+            if (Resolver::GetAddress(stResult, stPendingChannel.iPort, stAddress))
+            {
+                if (!ConnectResolved(pChannel, stAddress, stPendingChannel.iFamily))
+                {
+                    ResolveFailed(pChannel, "failed to connect to \"" + stResult.strHost + "\"");
+                }
+            }
+            else
+            {
+                ResolveFailed(pChannel, std::string("failed to resolve \"") + stResult.strHost
+                        + "\": " + gai_strerror(stResult.iErrCode));
+            }
+        }
+    }
+    m_vecResolveResult.clear();
+}
+
+void Dispatcher::OnResolveTimeout(const std::string& strHost)
+{
+    auto iter = m_mapPendingResolve.find(strHost);
+    if (iter == m_mapPendingResolve.end())
+    {
+        return;
+    }
+    // 解析结果晚到时仍会更新缓存，只是不再有等待的连接
+    std::vector<tagPendingChannel> vecChannel;
+    vecChannel.swap(iter->second.vecChannel);
+    m_mapPendingResolve.erase(iter);
+    for (auto& stPendingChannel : vecChannel)
+    {
+        std::shared_ptr<SocketChannel> pChannel = stPendingChannel.pChannel.lock();
+        if (nullptr != pChannel && CHANNEL_STATUS_CLOSED != pChannel->m_pImpl->GetChannelStatus())
+        {
+            ResolveFailed(pChannel, "resolve \"" + strHost + "\" timeout");
+        }
+    }
+}
+
+bool Dispatcher::AddPooledChannel(uint32 uiEndpoint, E_CODEC_TYPE eCodecType)
+{
+    Endpoints::tagEndpoint* pEndpoint = m_oEndpoints.Get(uiEndpoint);
+    if (nullptr == pEndpoint || !pEndpoint->bAddressValid)
+    {
+        return(false);
+    }
+    LOG4_TRACE("%s", pEndpoint->strIdentify.c_str());
+    std::shared_ptr<SocketChannel> pChannel = Connect(pEndpoint->strHost, pEndpoint->iPort, eCodecType, false);
+    if (nullptr == pChannel)
+    {
+        return(false);
+    }
+    // 连接建立后的首个写事件由OnIoWrite()发起StepConnectWorker，完成后与AutoSend()建立的连接相同
+    pChannel->m_pImpl->SetIdentify(pEndpoint->strIdentify);
+    pChannel->m_pImpl->SetPipeline(true);
+    pChannel->m_pImpl->SetChannelStatus(CHANNEL_STATUS_TRY_CONNECT);
+    pChannel->m_pImpl->SetRemoteWorkerIndex(pEndpoint->iWorkerIndex);
+    m_oEndpoints.AddChannel(uiEndpoint, pChannel);
+    return(true);
+}
+
+bool Dispatcher::TrackRedis(const std::string& strNamespace, bool bCluster, bool bWithSsl)
+{
+    if (!m_oRedisNearCache.IsEnabled())
+    {
+        return(false);
+    }
+    if (!bCluster && !m_oRedisNearCache.HasNamespace(strNamespace))
+    {
+        m_oRedisNearCache.SetNamespaceNodes(strNamespace, std::vector<std::string>{strNamespace});
+    }
+    if (m_oRedisNearCache.IsReady(strNamespace))
+    {
+        return(true);
+    }
+    std::vector<std::string> vecNode;
+    m_oRedisNearCache.GetUntrackedNodes(strNamespace, ev_now(m_loop), vecNode);
+    for (auto& strNode : vecNode)
+    {
+        ConnectRedisTracking(strNode, bWithSsl);
+    }
+    return(false);
+}
+
+bool Dispatcher::ConnectRedisTracking(const std::string& strNode, bool bWithSsl)
+{
+    Endpoints::tagEndpoint* pEndpoint = m_oEndpoints.Get(m_oEndpoints.Intern(strNode));
+    if (nullptr == pEndpoint || !pEndpoint->bAddressValid)
+    {
+        LOG4_ERROR("invalid redis node identify \"%s\".", strNode.c_str());
+        return(false);
+    }
+    std::shared_ptr<SocketChannel> pChannel = Connect(pEndpoint->strHost, pEndpoint->iPort, CODEC_RESP, bWithSsl);
+    if (nullptr == pChannel)
+    {
+        return(false);
+    }
+    LOG4_DEBUG("connect redis tracking channel to %s, fd %d", strNode.c_str(), pChannel->GetFd());
+    // 跟踪连接不加入连接池，只接收invalidate消息；BCAST模式下不需要在数据连接上重定向
+    std::vector<RespCmd> vecRespCmd;
+    vecRespCmd.reserve(2);
+    vecRespCmd.emplace_back("HELLO", 3);
+    vecRespCmd.emplace_back("CLIENT", "TRACKING", "ON", "BCAST");
+    const std::vector<std::string>& vecPrefix = m_pLabor->GetNodeInfo().vecRedisNearCachePrefix;
+    for (auto& strPrefix : vecPrefix)
+    {
+        vecRespCmd.back().Append("PREFIX").Append(strPrefix);
+    }
+    pChannel->m_pImpl->SetIdentify(strNode);
+    pChannel->m_pImpl->SetPipeline(true);
+    E_CODEC_STATUS eCodecStatus = pChannel->m_pImpl->Send(vecRespCmd, 0);
+    if (CODEC_STATUS_OK != eCodecStatus
+            && CODEC_STATUS_PAUSE != eCodecStatus
+            && CODEC_STATUS_WANT_WRITE != eCodecStatus
+            && CODEC_STATUS_WANT_READ != eCodecStatus)
+    {
+        DiscardSocketChannel(pChannel, false);
+        return(false);
+    }
+    pChannel->m_pImpl->SetChannelStatus(CHANNEL_STATUS_TRY_CONNECT);
+    m_oRedisNearCache.AddTrackingChannel(strNode, pChannel, vecRespCmd.size());
+    return(true);
+}
+
+bool Dispatcher::OnRedisTrackingMessage(std::shared_ptr<SocketChannel> pChannel, const RespView& oRespView)
+{
+    if (m_oRedisNearCache.OnTrackingMessage(pChannel.get(), oRespView, ev_now(m_loop)))
+    {
+        return(true);
+    }
+    LOG4_WARNING("redis %s does not support client side caching: %s",
+            pChannel->m_pImpl->GetIdentify().c_str(), oRespView.Str().c_str());
+    DiscardSocketChannel(pChannel, false);
+    return(false);
+}
+
+void Dispatcher::CheckRedisTracking()
+{
+    m_oRedisNearCache.SetMaxMemory(m_pLabor->GetNodeInfo().ullRedisNearCacheMemory);
+    std::vector<std::shared_ptr<SocketChannel>> vecChannel;
+    m_oRedisNearCache.GetTrackingChannels(vecChannel);
+    ev_tstamp dNow = ev_now(m_loop);
+    for (auto it = vecChannel.begin(); it != vecChannel.end(); ++it)
+    {
+        // 跟踪连接平时没有请求，须在IO超时前保活
+        if (dNow - (*it)->m_pImpl->GetActiveTime() >= (*it)->m_pImpl->GetKeepAlive() / 2)
+        {
+            SendTo(*it, RespCmd("PING"), (uint32)0);
+        }
+    }
+}
+
+void Dispatcher::ExtendEndpointPool(uint32 uiEndpoint, E_CODEC_TYPE eCodecType, bool bWarmUp)
+{
+    Endpoints::tagEndpoint* pEndpoint = m_oEndpoints.Get(uiEndpoint);
+    if (nullptr == pEndpoint)
+    {
+        return;
+    }
+    const NodeInfo& stNodeInfo = m_pLabor->GetNodeInfo();
+    if (bWarmUp)
+    {
+        uint32 uiMinChannel = std::min(stNodeInfo.uiEndpointPoolMin, stNodeInfo.uiEndpointPoolMax);
+        while (pEndpoint->vecChannel.size() < uiMinChannel && AddPooledChannel(uiEndpoint, eCodecType))
+        {
+            ;
+        }
+    }
+    else if (pEndpoint->vecChannel.size() < stNodeInfo.uiEndpointPoolMax)
+    {
+        AddPooledChannel(uiEndpoint, eCodecType);
+    }
+}
+
+void Dispatcher::CheckEndpointPool()
+{
+    const NodeInfo& stNodeInfo = m_pLabor->GetNodeInfo();
+    ev_tstamp dNow = ev_now(m_loop);
+    uint32 uiMinChannel = std::max(std::min(stNodeInfo.uiEndpointPoolMin, stNodeInfo.uiEndpointPoolMax), (uint32)1);
+    bool bReport = (Labor::LABOR_MANAGER != m_pLabor->GetLaborType())
+            && (dNow - m_dLastEndpointReportTime >= stNodeInfo.dDataReportInterval);
+    Report oReport;
+    std::vector<std::shared_ptr<SocketChannel>> vecIdleChannel;
+    for (uint32 uiEndpoint = 1; uiEndpoint < m_oEndpoints.GetEndpointNum(); ++uiEndpoint)
+    {
+        Endpoints::tagEndpoint* pEndpoint = m_oEndpoints.Get(uiEndpoint);
+        if (pEndpoint->vecChannel.empty())
+        {
+            continue;
+        }
+        uint64 ullInFlight = 0;
+        uint64 ullQueuedBytes = 0;
+        uint32 uiIdleNum = 0;
+        for (auto it = pEndpoint->vecChannel.begin(); it != pEndpoint->vecChannel.end(); ++it)
+        {
+            size_t uiInFlight = (*it)->m_pImpl->GetPipelineStepSeq().size();
+            size_t uiQueuedBytes = (*it)->m_pImpl->GetQueuedBytes();
+            ullInFlight += uiInFlight;
+            ullQueuedBytes += uiQueuedBytes;
+            // 只回收服务器间连接，其他连接由IO超时关闭
+            if (CODEC_NEBULA == (*it)->m_pImpl->GetCodecType()
+                    && CHANNEL_STATUS_ESTABLISHED == (*it)->m_pImpl->GetChannelStatus()
+                    && 0 == uiInFlight && 0 == uiQueuedBytes
+                    && dNow - (*it)->m_pImpl->GetActiveTime() >= stNodeInfo.dEndpointPoolIdle
+                    && pEndpoint->vecChannel.size() - uiIdleNum > uiMinChannel)
+            {
+                vecIdleChannel.push_back(*it);
+                ++uiIdleNum;
+            }
+        }
+        if (bReport)
+        {
+            ReportRecord* pRecord = oReport.add_records();
+            pRecord->set_key("neb.endpoint_pool." + pEndpoint->strIdentify);    // value: 连接数，待响应请求数，待发送字节数
+            pRecord->add_value(pEndpoint->vecChannel.size());
+            pRecord->add_value(ullInFlight);
+            pRecord->add_value(ullQueuedBytes);
+        }
+    }
+    for (auto it = vecIdleChannel.begin(); it != vecIdleChannel.end(); ++it)
+    {
+        LOG4_DEBUG("close idle pooled channel %s, fd %d", (*it)->GetIdentify().c_str(), (*it)->GetFd());
+        DiscardSocketChannel(*it, false);
+    }
+    if (bReport && m_oRedisNearCache.IsEnabled())
+    {
+        const RedisNearCache::tagStat& stStat = m_oRedisNearCache.GetStat();
+        ReportRecord* pRecord = oReport.add_records();
+        pRecord->set_key("neb.redis_near_cache");     // value: 命中数，未命中数，失效数，淘汰数，占用内存，缓存条数
+        pRecord->add_value(stStat.ullHit);
+        pRecord->add_value(stStat.ullMiss);
+        pRecord->add_value(stStat.ullInvalidate);
+        pRecord->add_value(stStat.ullEvict);
+        pRecord->add_value(m_oRedisNearCache.GetMemory());
+        pRecord->add_value(m_oRedisNearCache.GetEntryNum());
+        m_oRedisNearCache.ResetStat();
+    }
+#ifdef WITH_OPENSSL
+    if (bReport)
+    {
+        const SslResumption::tagStat& stStat = SslResumption::GetStat();
+        if (stStat.ullFullHandshake + stStat.ullResumedHandshake > 0)
+        {
+            ReportRecord* pRecord = oReport.add_records();
+            pRecord->set_key("neb.ssl_handshake");   // value: 完整握手数，复用握手数，完整握手CPU微秒，复用握手CPU微秒
+            pRecord->add_value(stStat.ullFullHandshake);
+            pRecord->add_value(stStat.ullResumedHandshake);
+            pRecord->add_value(stStat.ullFullHandshakeCpuUs);
+            pRecord->add_value(stStat.ullResumedHandshakeCpuUs);
+            SslResumption::ResetStat();
+        }
+    }
+#endif
+    if (bReport)
+    {
+        m_dLastEndpointReportTime = dNow;
+        if (oReport.records_size() > 0)
+        {
+            MsgBody oMsgBody;
+            oMsgBody.set_data(oReport.SerializeAsString());
+            SendDataReport(CMD_REQ_DATA_REPORT, 0, oMsgBody);
+        }
+    }
+}
+
 std::shared_ptr<SocketChannel> Dispatcher::StressSend(const std::string& strIdentify, int32 iCmd, uint32 uiSeq, const MsgBody& oMsgBody, E_CODEC_TYPE eCodecType)
 {
     LOG4_TRACE("%s", strIdentify.c_str());
@@ -886,17 +1403,17 @@ bool Dispatcher::Disconnect(std::shared_ptr<SocketChannel> pChannel, bool bChann
 
 bool Dispatcher::Disconnect(const std::string& strIdentify, bool bChannelNotice)
 {
-    auto named_iter = m_mapNamedSocketChannel.find(strIdentify);
-    if (named_iter != m_mapNamedSocketChannel.end())
+    Endpoints::tagEndpoint* pEndpoint = m_oEndpoints.Get(m_oEndpoints.Find(strIdentify));
+    if (nullptr != pEndpoint && !pEndpoint->vecChannel.empty())
     {
-        std::unordered_set<std::shared_ptr<SocketChannel>>::iterator channel_iter;
-        while (named_iter->second.size() > 1)
+        std::vector<std::shared_ptr<SocketChannel>> vecChannel;
+        vecChannel.swap(pEndpoint->vecChannel);
+        bool bResult = false;
+        for (auto channel_iter = vecChannel.begin(); channel_iter != vecChannel.end(); ++channel_iter)
         {
-            channel_iter = named_iter->second.begin();
-            DiscardSocketChannel(*channel_iter, bChannelNotice);
+            bResult = DiscardSocketChannel(*channel_iter, bChannelNotice);
         }
-        channel_iter = named_iter->second.begin();
-        return(DiscardSocketChannel(*channel_iter, bChannelNotice));
+        return(bResult);
     }
     return(false);
 }
@@ -904,22 +1421,21 @@ bool Dispatcher::Disconnect(const std::string& strIdentify, bool bChannelNotice)
 bool Dispatcher::DiscardNamedChannel(const std::string& strIdentify)
 {
     LOG4_TRACE("identify: %s", strIdentify.c_str());
-    auto named_iter = m_mapNamedSocketChannel.find(strIdentify);
-    if (named_iter == m_mapNamedSocketChannel.end())
+    Endpoints::tagEndpoint* pEndpoint = m_oEndpoints.Get(m_oEndpoints.Find(strIdentify));
+    if (nullptr == pEndpoint || pEndpoint->vecChannel.empty())
     {
         LOG4_DEBUG("no channel match %s.", strIdentify.c_str());
         return(false);
     }
     else
     {
-        for (auto channel_iter = named_iter->second.begin();
-                channel_iter != named_iter->second.end(); ++channel_iter)
+        for (auto channel_iter = pEndpoint->vecChannel.begin();
+                channel_iter != pEndpoint->vecChannel.end(); ++channel_iter)
         {
             (*channel_iter)->m_pImpl->SetIdentify("");
             (*channel_iter)->m_pImpl->SetClientData("");
         }
-        named_iter->second.clear();
-        m_mapNamedSocketChannel.erase(named_iter);
+        pEndpoint->vecChannel.clear();
         return(true);
     }
 }
@@ -932,31 +1448,17 @@ bool Dispatcher::SwitchCodec(std::shared_ptr<SocketChannel> pChannel, E_CODEC_TY
 bool Dispatcher::AddNamedSocketChannel(const std::string& strIdentify, std::shared_ptr<SocketChannel> pChannel)
 {
     LOG4_TRACE("%s", strIdentify.c_str());
-    auto named_iter = m_mapNamedSocketChannel.find(strIdentify);
-    if (named_iter == m_mapNamedSocketChannel.end())
-    {
-        std::unordered_set<std::shared_ptr<SocketChannel>> setChannel;
-        setChannel.insert(pChannel);
-        m_mapNamedSocketChannel.insert(std::make_pair(strIdentify, std::move(setChannel)));
-    }
-    else
-    {
-        named_iter->second.insert(pChannel);
-    }
+    m_oEndpoints.AddChannel(m_oEndpoints.Intern(strIdentify), pChannel);
     pChannel->m_pImpl->SetIdentify(strIdentify);
     return(true);
 }
 
 void Dispatcher::DelNamedSocketChannel(const std::string& strIdentify)
 {
-    auto named_iter = m_mapNamedSocketChannel.find(strIdentify);
-    if (named_iter == m_mapNamedSocketChannel.end())
+    Endpoints::tagEndpoint* pEndpoint = m_oEndpoints.Get(m_oEndpoints.Find(strIdentify));
+    if (nullptr != pEndpoint)
     {
-        ;
-    }
-    else
-    {
-        m_mapNamedSocketChannel.erase(named_iter);
+        pEndpoint->vecChannel.clear();
     }
 }
 
@@ -994,6 +1496,11 @@ void Dispatcher::DelNodeIdentify(const std::string& strNodeType, const std::stri
     }
 }
 
+bool Dispatcher::GetOrientedNode(const std::string& strNodeType, const std::string& strFactor, std::string& strNodeIdentify)
+{
+    return(m_pSessionNode->GetNode(strNodeType, strFactor, strNodeIdentify));
+}
+
 void Dispatcher::SetClientData(std::shared_ptr<SocketChannel> pChannel, const std::string& strClientData)
 {
     pChannel->m_pImpl->SetClientData(strClientData);
@@ -1037,6 +1544,16 @@ bool Dispatcher::AddEvent(ev_idle* idle_watcher, idle_callback pFunc)
     return(true);
 }
 
+bool Dispatcher::AddEvent(TimingWheel::tagTimer* pTimer, TimingWheel::timer_callback pFunc, ev_tstamp dTimeout)
+{
+    if (NULL == pTimer)
+    {
+        return(false);
+    }
+    pTimer->pCallback = pFunc;
+    return(RefreshEvent(pTimer, dTimeout));
+}
+
 bool Dispatcher::RefreshEvent(ev_timer* timer_watcher, ev_tstamp dTimeout)
 {
     if (NULL == timer_watcher)
@@ -1049,6 +1566,22 @@ bool Dispatcher::RefreshEvent(ev_timer* timer_watcher, ev_tstamp dTimeout)
     return(true);
 }
 
+bool Dispatcher::RefreshEvent(TimingWheel::tagTimer* pTimer, ev_tstamp dTimeout)
+{
+    if (NULL == pTimer)
+    {
+        return(false);
+    }
+    uint64 ullTimeout = (dTimeout > 0) ? (uint64)(dTimeout * 1000.0 + 0.5) : 0;
+    uint64 ullExpireTick = (uint64)GetMonotonicTimeMs() + ullTimeout;
+    m_oTimingWheel.Add(pTimer, ullExpireTick);
+    if (ullExpireTick < m_ullTimingWheelWakeTick)
+    {
+        ScheduleTimingWheel(ullExpireTick);
+    }
+    return(true);
+}
+
 bool Dispatcher::DelEvent(ev_io* io_watcher)
 {
     if (NULL == io_watcher)
@@ -1069,12 +1602,43 @@ bool Dispatcher::DelEvent(ev_timer* timer_watcher)
     return(true);
 }
 
+bool Dispatcher::DelEvent(TimingWheel::tagTimer* pTimer)
+{
+    if (NULL == pTimer)
+    {
+        return(false);
+    }
+    m_oTimingWheel.Del(pTimer);     // 时间轮定时器不随之重设，空转一次即停
+    return(true);
+}
+
+void Dispatcher::ScheduleTimingWheel(uint64 ullWakeTick)
+{
+    if (NULL == m_pTimingWheelWatcher)
+    {
+        m_pTimingWheelWatcher = (ev_timer*)malloc(sizeof(ev_timer));
+        if (NULL == m_pTimingWheelWatcher)
+        {
+            LOG4_ERROR("malloc timing wheel watcher error!");
+            return;
+        }
+        ev_timer_init (m_pTimingWheelWatcher, TimingWheelCallback, 0., 0.);
+        m_pTimingWheelWatcher->data = (void*)this;
+    }
+    m_ullTimingWheelWakeTick = ullWakeTick;
+    uint64 ullNowTick = (uint64)GetMonotonicTimeMs();
+    ev_tstamp dAfter = (ullWakeTick > ullNowTick) ? (ev_tstamp)(ullWakeTick - ullNowTick) / 1000.0 : 0.0;
+    ev_timer_stop (m_loop, m_pTimingWheelWatcher);
+    ev_timer_set (m_pTimingWheelWatcher, dAfter + ev_time() - ev_now(m_loop), 0);
+    ev_timer_start (m_loop, m_pTimingWheelWatcher);
+}
+
 int Dispatcher::SendFd(int iSocketFd, int iSendFd, int iAiFamily, int iCodecType)
 {
     return(SocketChannel::SendChannelFd(iSocketFd, iSendFd, iAiFamily, iCodecType, m_pLogger));
 }
 
-bool Dispatcher::CreateListenFd(const std::string& strHost, int32 iPort, int& iFd, int& iFamily)
+bool Dispatcher::CreateListenFd(const std::string& strHost, int32 iPort, int& iFd, int& iFamily, bool bReusePort)
 {
     int queueLen = 100;
     int reuse = 1;
@@ -1120,6 +1684,24 @@ bool Dispatcher::CreateListenFd(const std::string& strHost, int32 iPort, int& iF
             iFd = -1;
             continue;
         }
+        if (bReusePort)
+        {
+#ifdef SO_REUSEPORT
+            if (-1 == ::setsockopt(iFd,
+                        SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(int)))
+            {
+                close(iFd);
+                iFd = -1;
+                continue;
+            }
+            x_sock_set_block(iFd, 0);   // 每次可读事件循环accept直至EAGAIN
+#else
+            LOG4_ERROR("SO_REUSEPORT is not supported on this platform!");
+            close(iFd);
+            iFd = -1;
+            break;
+#endif
+        }
         if (-1 == bind(iFd,
                     pAddrCurrent->ai_addr, pAddrCurrent->ai_addrlen))
         {
@@ -1151,6 +1733,45 @@ bool Dispatcher::CreateListenFd(const std::string& strHost, int32 iPort, int& iF
     return(true);
 }
 
+bool Dispatcher::AttachReusePortCbpf(int iFd, uint32 uiGroupSize)
+{
+#if defined(__linux__) && defined(SO_ATTACH_REUSEPORT_CBPF)
+    if (uiGroupSize == 0)
+    {
+        return(false);
+    }
+    /**
+     * @brief 按客户端IP选择SO_REUSEPORT组内的socket：
+     * A = 源IP（IPv4取源地址，IPv6取源地址最后4字节）；return A % uiGroupSize。
+     * 同一IP的连接总是落到同一个Worker，使每个Worker内的IP连接频率限制与Manager统一accept时等价。
+     * 返回值超出组内socket数量（如某Worker重启中）时内核自动回退到四元组哈希。
+     */
+    struct sock_filter stCode[] = {
+        { BPF_LD | BPF_B | BPF_ABS, 0, 0, (uint32)SKF_NET_OFF },            // A = ip[0]
+        { BPF_ALU | BPF_RSH | BPF_K, 0, 0, 4 },                             // A >>= 4 (ip version)
+        { BPF_JMP | BPF_JEQ | BPF_K, 0, 2, 4 },                             // if (A == 4)
+        { BPF_LD | BPF_W | BPF_ABS, 0, 0, (uint32)(SKF_NET_OFF + 12) },     //     A = ipv4 saddr
+        { BPF_JMP | BPF_JA, 0, 0, 1 },                                      // else
+        { BPF_LD | BPF_W | BPF_ABS, 0, 0, (uint32)(SKF_NET_OFF + 20) },     //     A = ipv6 saddr[3]
+        { BPF_ALU | BPF_MOD | BPF_K, 0, 0, uiGroupSize },                   // A %= uiGroupSize
+        { BPF_RET | BPF_A, 0, 0, 0 }                                        // return A
+    };
+    struct sock_fprog stProg;
+    stProg.len = sizeof(stCode) / sizeof(stCode[0]);
+    stProg.filter = stCode;
+    if (-1 == ::setsockopt(iFd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &stProg, sizeof(stProg)))
+    {
+        LOG4_WARNING("failed to attach reuseport cbpf to fd %d, error %d: %s, fall back to kernel hashing.",
+                iFd, errno, strerror_r(errno, m_pErrBuff, gc_iErrBuffLen));
+        return(false);
+    }
+    return(true);
+#else
+    LOG4_WARNING("SO_ATTACH_REUSEPORT_CBPF is not supported, fall back to kernel hashing.");
+    return(false);
+#endif
+}
+
 std::shared_ptr<SocketChannel> Dispatcher::GetChannel(int iFd)
 {
     auto iter = m_mapSocketChannel.find(iFd);
@@ -1173,21 +1794,60 @@ int32 Dispatcher::GetClientNum() const
 bool Dispatcher::Init()
 {
 #if __cplusplus >= 201401L
-    m_pSessionNode = std::make_unique<Nodes>();
+    m_pSessionNode = std::make_unique<Nodes>(HASH_murmur3_32, 200, m_pLabor->GetNodeInfo().iNodeDistribution, &m_oEndpoints);
 #else
-    m_pSessionNode = std::unique_ptr<Nodes>(new Nodes());
+    m_pSessionNode = std::unique_ptr<Nodes>(new Nodes(HASH_murmur3_32, 200, m_pLabor->GetNodeInfo().iNodeDistribution, &m_oEndpoints));
 #endif
     Codec::AddAutoSwitchCodecType(CODEC_HTTP);
     Codec::AddAutoSwitchCodecType(CODEC_PROTO);
     Codec::AddAutoSwitchCodecType(CODEC_RESP);
     Codec::AddAutoSwitchCodecType(CODEC_PRIVATE);
+    CodecHttp::SetResponseHeaderBlock(m_pLabor->GetNodeInfo().strHttpResponseHeaders);
+    m_oRedisNearCache.SetMaxMemory(m_pLabor->GetNodeInfo().ullRedisNearCacheMemory);
+    m_oRedisNearCache.SetTrackingPrefix(m_pLabor->GetNodeInfo().vecRedisNearCachePrefix);
+    if (NULL == m_pResolveWatcher)
+    {
+        m_pResolveWatcher = (ev_async*)malloc(sizeof(ev_async));
+        if (NULL == m_pResolveWatcher)
+        {
+            LOG4_ERROR("malloc ev_async error!");
+            return(false);
+        }
+        ev_async_init(m_pResolveWatcher, ResolveCallback);
+        m_pResolveWatcher->data = (void*)this;
+        ev_async_start(m_loop, m_pResolveWatcher);
+        m_oResolver.SetNotifyFunction([this]()
+                {
+                    ev_async_send(m_loop, m_pResolveWatcher);   // ev_async_send()可在其他线程调用
+                });
+    }
     return(true);
 }
 
 void Dispatcher::Destroy()
 {
+    m_oResolver.Stop();     // 须在事件循环销毁之前，解析线程会通知事件循环
+    m_mapPendingResolve.clear();
     m_mapSocketChannel.clear();
-    m_mapNamedSocketChannel.clear();
+    m_oEndpoints.ClearChannel();
+    if (m_pTimingWheelWatcher != NULL)
+    {
+        if (m_loop != NULL)
+        {
+            ev_timer_stop (m_loop, m_pTimingWheelWatcher);
+        }
+        free(m_pTimingWheelWatcher);
+        m_pTimingWheelWatcher = NULL;
+    }
+    if (m_pResolveWatcher != NULL)
+    {
+        if (m_loop != NULL)
+        {
+            ev_async_stop (m_loop, m_pResolveWatcher);
+        }
+        free(m_pResolveWatcher);
+        m_pResolveWatcher = NULL;
+    }
     if (m_loop != NULL)
     {
         ev_loop_destroy(m_loop);
@@ -1211,7 +1871,9 @@ std::shared_ptr<SocketChannel> Dispatcher::CreateSocketChannel(int iFd, E_CODEC_
         std::shared_ptr<SocketChannel> pChannel = nullptr;
         try
         {
-            pChannel = std::make_shared<SocketChannel>(m_pLogger, iFd, m_pLabor->GetSequence(), bWithSsl);
+            // 连接对象与shared_ptr控制块从回收池分配，连接频繁建立和关闭时复用内存
+            pChannel = std::allocate_shared<SocketChannel>(PoolAllocator<SocketChannel>(),
+                    m_pLogger, iFd, m_pLabor->GetSequence(), bWithSsl);
         }
         catch(std::bad_alloc& e)
         {
@@ -1249,23 +1911,14 @@ bool Dispatcher::DiscardSocketChannel(std::shared_ptr<SocketChannel> pChannel, b
         return(false);
     }
 
-    auto named_iter = m_mapNamedSocketChannel.find(pChannel->m_pImpl->GetIdentify());
-    if (named_iter != m_mapNamedSocketChannel.end())
+    if (m_oRedisNearCache.IsTrackingChannel(pChannel.get()))
     {
-       for (auto it = named_iter->second.begin();
-           it != named_iter->second.end(); ++it)
-       {
-           if ((*it)->m_pImpl->GetSequence() == pChannel->m_pImpl->GetSequence())
-           {
-               named_iter->second.erase(it);
-               LOG4_TRACE("erase channel %d from m_mapNamedSocketChannel.", pChannel->m_pImpl->GetFd());
-               break;
-           }
-       }
-       if (0 == named_iter->second.size())
-       {
-           m_mapNamedSocketChannel.erase(named_iter);
-       }
+        m_oRedisNearCache.OnTrackingClosed(pChannel.get(), ev_now(m_loop));
+    }
+    if (!pChannel->m_pImpl->GetIdentify().empty()
+            && m_oEndpoints.DelChannel(m_oEndpoints.Find(pChannel->m_pImpl->GetIdentify()), pChannel))
+    {
+        LOG4_TRACE("erase channel %d from named channel.", pChannel->m_pImpl->GetFd());
     }
 
     bool bCloseResult = pChannel->m_pImpl->Close();
@@ -1319,6 +1972,10 @@ bool Dispatcher::AddIoReadEvent(std::shared_ptr<SocketChannel> pChannel)
     {
         return(false);
     }
+    else if (pChannel->m_pImpl->IsResolving())    // 尚未发起连接，解析完成后由ConnectResolved()加入
+    {
+        return(true);
+    }
     else
     {
         if (ev_is_active(io_watcher))
@@ -1344,6 +2001,10 @@ bool Dispatcher::AddIoWriteEvent(std::shared_ptr<SocketChannel> pChannel)
     {
         return(false);
     }
+    else if (pChannel->m_pImpl->IsResolving())    // 尚未发起连接，解析完成后由ConnectResolved()加入
+    {
+        return(true);
+    }
     else
     {
         if (ev_is_active(io_watcher))
@@ -1406,6 +2067,27 @@ bool Dispatcher::AddClientConnFrequencyTimeout(const char* pAddr, ev_tstamp dTim
     return(true);
 }
 
+bool Dispatcher::CheckClientConnFrequency(const char* szClientAddr, uint32 uiPermitNum)
+{
+    auto iter = m_mapClientConnFrequency.find(std::string(szClientAddr));
+    if (iter == m_mapClientConnFrequency.end())
+    {
+        m_mapClientConnFrequency.insert(std::make_pair(std::string(szClientAddr), 1));
+        AddClientConnFrequencyTimeout(szClientAddr, m_pLabor->GetNodeInfo().dAddrStatInterval);
+    }
+    else
+    {
+        iter->second++;
+        if (iter->second > uiPermitNum)
+        {
+            LOG4_WARNING("client addr %s had been connected more than %u times in %f seconds, it's not permitted",
+                            szClientAddr, uiPermitNum, m_pLabor->GetNodeInfo().dAddrStatInterval);
+            return(false);
+        }
+    }
+    return(true);
+}
+
 bool Dispatcher::AcceptFdAndTransfer(int iFd, int iFamily)
 {
     char szClientAddr[64] = {0};
@@ -1437,22 +2119,10 @@ bool Dispatcher::AcceptFdAndTransfer(int iFd, int iFamily)
         LOG4_TRACE("accept connect from \"%s\"", szClientAddr);
     }
 
-    auto iter = m_mapClientConnFrequency.find(std::string(szClientAddr));
-    if (iter == m_mapClientConnFrequency.end())
-    {
-        m_mapClientConnFrequency.insert(std::make_pair(std::string(szClientAddr), 1));
-        AddClientConnFrequencyTimeout(szClientAddr, m_pLabor->GetNodeInfo().dAddrStatInterval);
-    }
-    else
+    if (!CheckClientConnFrequency(szClientAddr, (uint32)m_pLabor->GetNodeInfo().iAddrPermitNum))
     {
-        iter->second++;
-        if (((Manager*)m_pLabor)->GetManagerInfo().iC2SListenFd > 2 && iter->second > (uint32)m_pLabor->GetNodeInfo().iAddrPermitNum)
-        {
-            LOG4_WARNING("client addr %s had been connected more than %u times in %f seconds, it's not permitted",
-                            szClientAddr, m_pLabor->GetNodeInfo().iAddrPermitNum, m_pLabor->GetNodeInfo().dAddrStatInterval);
-            close(iAcceptFd);
-            return(false);
-        }
+        close(iAcceptFd);
+        return(false);
     }
 
     int iWorkerDataFd = -1;
@@ -1477,6 +2147,68 @@ bool Dispatcher::AcceptFdAndTransfer(int iFd, int iFamily)
     return(false);
 }
 
+bool Dispatcher::AcceptClientConn(int iFd, int iFamily)
+{
+    /**
+     * SO_REUSEPORT模式下Worker直接accept客户端连接，省去Manager的accept和fd传递。
+     * 挂载CBPF时同一IP的连接固定落到同一Worker，IP连接频率限制不变；由内核按四元组哈希
+     * 分发时同一IP的连接分散到各Worker，每个Worker按Worker数均摊允许连接次数。
+     */
+    uint32 uiPermitNum = (uint32)m_pLabor->GetNodeInfo().iAddrPermitNum;
+    uint32 uiWorkerNum = m_pLabor->GetNodeInfo().uiWorkerNum;
+    if (!m_pLabor->GetNodeInfo().bReusePortCbpf && uiWorkerNum > 1)
+    {
+        uiPermitNum = (uiPermitNum + uiWorkerNum - 1) / uiWorkerNum;
+    }
+    char szClientAddr[64] = {0};
+    int iAcceptFd = -1;
+    for (int i = 0; i < gc_iMaxAcceptPerEvent; ++i)
+    {
+        if (AF_INET == iFamily)
+        {
+            struct sockaddr_in stClientAddr;
+            socklen_t clientAddrSize = sizeof(stClientAddr);
+            iAcceptFd = accept(iFd, (struct sockaddr*) &stClientAddr, &clientAddrSize);
+            if (iAcceptFd >= 0)
+            {
+                inet_ntop(AF_INET, &stClientAddr.sin_addr, szClientAddr, sizeof(szClientAddr));
+            }
+        }
+        else    // AF_INET6
+        {
+            struct sockaddr_in6 stClientAddr;
+            socklen_t clientAddrSize = sizeof(stClientAddr);
+            iAcceptFd = accept(iFd, (struct sockaddr*) &stClientAddr, &clientAddrSize);
+            if (iAcceptFd >= 0)
+            {
+                inet_ntop(AF_INET6, &stClientAddr.sin6_addr, szClientAddr, sizeof(szClientAddr));
+            }
+        }
+        if (iAcceptFd < 0)
+        {
+            if (EAGAIN == errno || EWOULDBLOCK == errno)
+            {
+                return(true);
+            }
+            if (EINTR == errno || ECONNABORTED == errno)
+            {
+                continue;
+            }
+            LOG4_ERROR("error %d: %s", errno, strerror_r(errno, m_pErrBuff, gc_iErrBuffLen));
+            return(false);
+        }
+        LOG4_TRACE("accept connect from \"%s\"", szClientAddr);
+
+        if (!CheckClientConnFrequency(szClientAddr, uiPermitNum))
+        {
+            close(iAcceptFd);
+            continue;
+        }
+        CreateAcceptedChannel(iAcceptFd, iFamily, m_pLabor->GetNodeInfo().eCodec);
+    }
+    return(true);
+}
+
 bool Dispatcher::AcceptServerConn(int iFd)
 {
     struct sockaddr_in stClientAddr;
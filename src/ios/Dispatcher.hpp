@@ -20,6 +20,7 @@ extern "C" {
 #include <errno.h>
 #include <unistd.h>
 #include <signal.h>
+#include <time.h>
 #include <sys/wait.h>
 #include <sys/types.h>
 #include <sys/socket.h>
@@ -44,12 +45,21 @@ extern "C" {
 #include <unordered_map>
 #include <sstream>
 #include <memory>
+#include <type_traits>
 
 #include "util/process_helper.h"
 #include "pb/msg.pb.h"
+#include "pb/http.pb.h"
+#include "pb/redis.pb.h"
+#include "codec/EncodedFrame.hpp"
 #include "channel/SocketChannel.hpp"
 #include "logger/NetLogger.hpp"
 #include "Nodes.hpp"
+#include "Endpoints.hpp"
+#include "Resolver.hpp"
+#include "RedisNearCache.hpp"
+#include "TimingWheel.hpp"
+#include "MessagePool.hpp"
 
 namespace neb
 {
@@ -96,18 +106,28 @@ public:
     static void PeriodicTaskCallback(struct ev_loop* loop, ev_timer* watcher, int revents);
     static void SignalCallback(struct ev_loop* loop, struct ev_signal* watcher, int revents);
     static void ClientConnFrequencyTimeoutCallback(struct ev_loop* loop, ev_timer* watcher, int revents);
+    static void TimingWheelCallback(struct ev_loop* loop, ev_timer* watcher, int revents);
+    static void ResolveCallback(struct ev_loop* loop, ev_async* watcher, int revents);
+    static void ResolveTimeoutCallback(TimingWheel::tagTimer* pTimer);
 
     bool OnIoRead(std::shared_ptr<SocketChannel> pChannel);
     bool DataRecvAndHandle(std::shared_ptr<SocketChannel> pChannel);
     bool DataFetchAndHandle(std::shared_ptr<SocketChannel> pChannel);
     bool FdTransfer(int iFd);
+    bool CreateAcceptedChannel(int iAcceptFd, int iAiFamily, int iCodec);
     bool OnIoWrite(std::shared_ptr<SocketChannel> pChannel);
     bool OnIoError(std::shared_ptr<SocketChannel> pChannel);
     bool OnIoTimeout(std::shared_ptr<SocketChannel> pChannel);
     bool OnClientConnFrequencyTimeout(tagClientConnWatcherData* pData, ev_timer* watcher);
+    void OnTimingWheelTimeout();
+    void OnResolved();
 
     template <typename ...Targs>
     void Logger(int iLogLevel, const char* szFileName, unsigned int uiFileLine, const char* szFunction, Targs&&... args);
+    bool IsLogLevelEnabled(int iLogLevel) const
+    {
+        return(m_pLogger->IsLevelEnabled(iLogLevel));
+    }
 
     void EventRun();
 
@@ -119,6 +139,13 @@ public:
     bool SendTo(const std::string& strIdentify, E_CODEC_TYPE eCodecType, bool bWithSsl, bool bPipeline, Targs&&... args);
     template <typename ...Targs>
     bool SendTo(const std::string& strHost, int iPort, E_CODEC_TYPE eCodecType, bool bWithSsl, bool bPipeline, Targs&&... args);
+    /**
+     * @brief 按节点句柄发送
+     * @note 句柄由GetEndpoint()获取，已有连接时按下标取连接发送，无连接时自动连接。
+     * @param uiEndpoint 节点句柄
+     */
+    template <typename ...Targs>
+    bool SendTo(uint32 uiEndpoint, E_CODEC_TYPE eCodecType, bool bWithSsl, bool bPipeline, Targs&&... args);
     template <typename ...Targs>
     bool AutoSend(const std::string& strIdentify, const std::string& strHost,
             int iPort, int iRemoteWorkerIndex, E_CODEC_TYPE eCodecType, bool bWithSsl, bool bPipeline, Targs&&... args);
@@ -132,6 +159,14 @@ public:
             bool bWithSsl, bool bPipeline, const std::string& strFactor, Targs&&... args);
     template <typename ...Targs>
     bool Broadcast(const std::string& strNodeType, E_CODEC_TYPE eCodecType, bool bWithSsl, bool bPipeline, Targs&&... args);
+    /**
+     * @brief 同一消息发送到一组连接
+     * @note 每种编解码方式只编码一次，编码结果由各连接的发送队列共享（见EncodedFrame）。
+     * @param oChannels 连接集合（元素为std::shared_ptr<SocketChannel>的任意容器）
+     * @return 是否至少有一个连接发送成功
+     */
+    template <typename Channels>
+    bool Multicast(const Channels& oChannels, int32 iCmd, uint32 uiSeq, const MsgBody& oMsgBody);
     bool AutoSend(const std::string& strIdentify, int32 iCmd, uint32 uiSeq, const MsgBody& oMsgBody, E_CODEC_TYPE eCodecType = CODEC_NEBULA);
     bool SendDataReport(int32 iCmd, uint32 uiSeq, const MsgBody& oMsgBody);
     std::shared_ptr<SocketChannel> StressSend(const std::string& strIdentify, int32 iCmd, uint32 uiSeq, const MsgBody& oMsgBody, E_CODEC_TYPE eCodecType = CODEC_NEBULA);
@@ -151,6 +186,23 @@ public:
     void DelNamedSocketChannel(const std::string& strIdentify);
     void AddNodeIdentify(const std::string& strNodeType, const std::string& strIdentify);
     void DelNodeIdentify(const std::string& strNodeType, const std::string& strIdentify);
+    /**
+     * @brief 获取节点句柄
+     * @note 节点标识首次出现时登记并分配句柄，之后返回同一句柄，可保存下来用于SendTo()。
+     * @param strIdentify 节点标识（host:port或host:port.worker_index）
+     */
+    uint32 GetEndpoint(const std::string& strIdentify)
+    {
+        return(m_oEndpoints.Intern(strIdentify));
+    }
+    uint32 GetEndpoint(const std::string& strHost, int iPort)
+    {
+        return(m_oEndpoints.Intern(strHost, iPort));
+    }
+    /**
+     * @brief 获取strFactor在SendOriented()中对应的节点
+     */
+    bool GetOrientedNode(const std::string& strNodeType, const std::string& strFactor, std::string& strNodeIdentify);
     void SetClientData(std::shared_ptr<SocketChannel> pChannel, const std::string& strClientData);
     bool IsNodeType(const std::string& strNodeIdentify, const std::string& strNodeType);
 
@@ -160,14 +212,85 @@ public:
     }
     long GetNowTimeMs() const
     {
-        return((long)ev_now(m_loop) * 1000);
+        return((long)(ev_now(m_loop) * 1000));
+    }
+    int64 GetMonotonicTimeMs() const
+    {
+        return(GetMonotonicTimeUs() / 1000);
+    }
+    int64 GetMonotonicTimeUs() const
+    {
+        struct timespec stTime;
+        clock_gettime(CLOCK_MONOTONIC, &stTime);
+        return((int64)stTime.tv_sec * 1000000 + stTime.tv_nsec / 1000);
+    }
+    /**
+     * @brief 单调时钟时间（单位：秒，精确到微秒），Actor的活跃时间以此计
+     */
+    ev_tstamp GetMonotonicTime() const
+    {
+        return((ev_tstamp)GetMonotonicTimeUs() / 1000000.0);
+    }
+    /**
+     * @brief 接管当前回调中正在处理的解码消息（见Actor::RetainMessage()）
+     */
+    std::shared_ptr<MsgHead> RetainMessage(const MsgHead& oMsgHead)
+    {
+        return(m_oMsgHeadPool.Retain(oMsgHead));
+    }
+    std::shared_ptr<MsgBody> RetainMessage(const MsgBody& oMsgBody)
+    {
+        return(m_oMsgBodyPool.Retain(oMsgBody));
+    }
+    std::shared_ptr<HttpMsg> RetainMessage(const HttpMsg& oHttpMsg)
+    {
+        return(m_oHttpMsgPool.Retain(oHttpMsg));
+    }
+    std::shared_ptr<RedisReply> RetainMessage(const RedisReply& oRedisReply)
+    {
+        return(m_oRedisMsgPool.Retain(oRedisReply));
+    }
+    MessagePool<RedisReply>& GetRedisMsgPool()
+    {
+        return(m_oRedisMsgPool);
     }
     std::shared_ptr<SocketChannel> CreateSocketChannel(int iFd, E_CODEC_TYPE eCodecType, bool bIsClient = false, bool bWithSsl = false);
     bool DiscardSocketChannel(std::shared_ptr<SocketChannel> pChannel, bool bChannelNotice = true);
-    bool CreateListenFd(const std::string& strHost, int32 iPort, int& iFd, int& iFamily);
+    bool CreateListenFd(const std::string& strHost, int32 iPort, int& iFd, int& iFamily, bool bReusePort = false);
+    bool AttachReusePortCbpf(int iFd, uint32 uiGroupSize);
     std::shared_ptr<SocketChannel> GetChannel(int iFd);
     int SendFd(int iSocketFd, int iSendFd, int iAiFamily, int iCodecType);
 
+    /**
+     * @brief 发起到strHost:iPort的非阻塞连接
+     * @note strHost为域名且未命中解析缓存时，连接先创建并返回，发送的数据暂存于连接的
+     * 待发送缓冲区，解析完成后再发起连接；解析失败或超时则按连接失败处理。
+     * @return 已加入事件循环（或等待域名解析）的连接，状态和标识由调用方设置
+     */
+    std::shared_ptr<SocketChannel> Connect(const std::string& strHost, int iPort, E_CODEC_TYPE eCodecType, bool bWithSsl);
+    /**
+     * @brief 为节点新建一个pipeline连接加入连接池（不发送数据）
+     */
+    bool AddPooledChannel(uint32 uiEndpoint, E_CODEC_TYPE eCodecType);
+    /**
+     * @brief 扩充节点连接池
+     * @param bWarmUp true 补足到endpoint_pool.min_channel个连接；false 未达到max_channel时新建一个连接
+     */
+    void ExtendEndpointPool(uint32 uiEndpoint, E_CODEC_TYPE eCodecType, bool bWarmUp);
+
+    RedisNearCache& GetRedisNearCache()
+    {
+        return(m_oRedisNearCache);
+    }
+    /**
+     * @brief 确保命名空间的各redis节点都已建立跟踪连接
+     * @note 未建立的节点发起跟踪连接（异步），建立完成前该命名空间不使用近端缓存。
+     * @param strNamespace 命名空间，单节点为节点标识，集群为集群标识（节点由
+     * StepRedisCluster设置）
+     * @return 跟踪已全部生效，可以使用近端缓存
+     */
+    bool TrackRedis(const std::string& strNamespace, bool bCluster, bool bWithSsl);
+
 protected:
     void Destroy();
     bool AddIoReadEvent(std::shared_ptr<SocketChannel> pChannel);
@@ -176,32 +299,115 @@ protected:
     bool AddEvent(ev_signal* signal_watcher, signal_callback pFunc, int iSignum);
     bool AddEvent(ev_timer* timer_watcher, timer_callback pFunc, ev_tstamp dTimeout);
     bool AddEvent(ev_idle* idle_watcher, idle_callback pFunc);
+    bool AddEvent(TimingWheel::tagTimer* pTimer, TimingWheel::timer_callback pFunc, ev_tstamp dTimeout);
     bool RefreshEvent(ev_timer* timer_watcher, ev_tstamp dTimeout);
+    bool RefreshEvent(TimingWheel::tagTimer* pTimer, ev_tstamp dTimeout);
     bool DelEvent(ev_io* io_watcher);
     bool DelEvent(ev_timer* timer_watcher);
+    bool DelEvent(TimingWheel::tagTimer* pTimer);
+    void ScheduleTimingWheel(uint64 ullWakeTick);
     int32 GetConnectionNum() const;
     int32 GetClientNum() const;
     void SetChannelStatus(std::shared_ptr<SocketChannel> pChannel, E_CHANNEL_STATUS eStatus);
     bool AddClientConnFrequencyTimeout(const char* pAddr, ev_tstamp dTimeout = 60.0);
+    bool CheckClientConnFrequency(const char* szClientAddr, uint32 uiPermitNum);
     bool AcceptFdAndTransfer(int iFd, int iFamily = AF_INET);
+    bool AcceptClientConn(int iFd, int iFamily = AF_INET);
     bool AcceptServerConn(int iFd);
     void CheckFailedNode();
+    /**
+     * @brief 回收连接池中的空闲连接，并按统计数据上报时间间隔上报各节点连接池状态
+     * 和redis近端缓存状态
+     */
+    void CheckEndpointPool();
+    /**
+     * @brief 按配置调整redis近端缓存的内存上限，空闲的跟踪连接发送PING保活
+     */
+    void CheckRedisTracking();
+    /**
+     * @brief 向redis节点发起跟踪连接（HELLO 3，CLIENT TRACKING ON BCAST）
+     */
+    bool ConnectRedisTracking(const std::string& strNode, bool bWithSsl);
+    /**
+     * @brief 处理跟踪连接上收到的消息
+     * @return 跟踪建立失败已关闭连接时返回false
+     */
+    bool OnRedisTrackingMessage(std::shared_ptr<SocketChannel> pChannel, const RespView& oRespView);
+    /**
+     * @brief 域名解析超时，关闭等待该域名解析的连接
+     */
+    void OnResolveTimeout(const std::string& strHost);
+    /**
+     * @brief 以解析得到的地址发起连接
+     * @param iFamily 创建连接时socket的地址族，与解析结果不同时替换为同一fd上的新socket
+     */
+    int CreateConnectFd(int iFamily);
+    bool ConnectResolved(std::shared_ptr<SocketChannel> pChannel, const Resolver::tagAddress& stAddress, int iFamily);
+    /**
+     * @brief 域名解析失败，连接上等待响应的步骤回调错误并关闭连接
+     */
+    void ResolveFailed(std::shared_ptr<SocketChannel> pChannel, const std::string& strErrMsg);
     void EvBreak();
 
+    /**
+     * @brief 发送到一组节点
+     * @note 参数可构造EncodedFrame（iCmd, uiSeq, oMsgBody）时先编码一次再发往各节点，
+     * 其他消息逐节点编码。
+     */
+    template <typename ...Targs>
+    typename std::enable_if<std::is_constructible<EncodedFrame, Targs&&...>::value, bool>::type
+    SendToNodes(const std::unordered_set<std::string>& setNodes, E_CODEC_TYPE eCodecType, bool bWithSsl, bool bPipeline, Targs&&... args);
+    template <typename ...Targs>
+    typename std::enable_if<!std::is_constructible<EncodedFrame, Targs&&...>::value, bool>::type
+    SendToNodes(const std::unordered_set<std::string>& setNodes, E_CODEC_TYPE eCodecType, bool bWithSsl, bool bPipeline, Targs&&... args);
+
 private:
     char* m_pErrBuff;
     Labor* m_pLabor;
     struct ev_loop* m_loop;
     int32 m_iClientNum;
     time_t m_lLastCheckNodeTime;
+    ev_tstamp m_dLastEndpointReportTime;
+    ev_async* m_pResolveWatcher;                ///< 后台域名解析完成通知
     std::shared_ptr<NetLogger> m_pLogger;
+    Endpoints m_oEndpoints;     ///< 对端节点及其连接（named Channel），按句柄访问
     std::unique_ptr<Nodes> m_pSessionNode;
 
+    // 域名解析
+    struct tagPendingChannel
+    {
+        std::weak_ptr<SocketChannel> pChannel;
+        int iPort;
+        int iFamily;                            ///< 连接创建时socket的地址族
+    };
+    struct tagPendingResolve
+    {
+        Dispatcher* pDispatcher = nullptr;
+        std::string strHost;
+        TimingWheel::tagTimer stTimer;          ///< 解析超时定时器，首个等待的连接加入时挂入时间轮，解析完成随之摘除
+        std::vector<tagPendingChannel> vecChannel;
+    };
+    Resolver m_oResolver;
+    std::unordered_map<std::string, tagPendingResolve> m_mapPendingResolve;    ///< key为域名，value为等待该域名解析的连接
+    std::vector<Resolver::tagResult> m_vecResolveResult;
+
+    RedisNearCache m_oRedisNearCache;           ///< redis近端缓存，以CLIENT TRACKING跟踪连接维持一致
+
+    // Step、Session、Chain超时统一由时间轮管理（单位：毫秒），整个时间轮只占用一个ev_timer
+    TimingWheel m_oTimingWheel;
+    ev_timer* m_pTimingWheelWatcher;
+    uint64 m_ullTimingWheelWakeTick;            ///< 时间轮定时器下一次触发时刻
+
+    // 解码消息回收池，回调返回后清空复用，需在回调之外持有消息须经RetainMessage()接管
+    MessagePool<MsgHead> m_oMsgHeadPool;
+    MessagePool<MsgBody> m_oMsgBodyPool;
+    MessagePool<HttpMsg> m_oHttpMsgPool;
+    MessagePool<RedisReply> m_oRedisMsgPool;
+
     // Channel
     std::unordered_map<int32, std::shared_ptr<SocketChannel> > m_mapSocketChannel;
 
-    /* named Channel */
-    std::unordered_map<std::string, std::unordered_set<std::shared_ptr<SocketChannel> > > m_mapNamedSocketChannel;      ///< key为Identify，连接存在时，if(http连接)set.size()>=1;else set.size()==1;
+    /* named Channel 见m_oEndpoints */
     std::unordered_map<int32, std::shared_ptr<SocketChannel> > m_mapLoaderAndWorkerChannel;     ///< Loader和Worker之间通信通道
     std::unordered_map<int32, std::shared_ptr<SocketChannel> >::iterator m_iterLoaderAndWorkerChannel;
 
@@ -247,114 +453,75 @@ template <typename ...Targs>
 bool Dispatcher::SendTo(const std::string& strIdentify, E_CODEC_TYPE eCodecType, bool bWithSsl, bool bPipeline, Targs&&... args)
 {
     LOG4_TRACE("identify: %s", strIdentify.c_str());
-    // 将strIdentify分割的功能只在此SendTo()函数内两处调用，定义为Dispatcher的成员函数语义上不太合适，故定义lambda表达式
-    auto split = [](const std::string& strIdentify, std::string& strHost, int& iPort, int& iWorkerIndex, std::string& strError)->bool
+    return(SendTo(m_oEndpoints.Intern(strIdentify), eCodecType, bWithSsl, bPipeline, std::forward<Targs>(args)...));
+}
+
+template <typename ...Targs>
+bool Dispatcher::SendTo(const std::string& strHost, int iPort, E_CODEC_TYPE eCodecType, bool bWithSsl, bool bPipeline, Targs&&... args)
+{
+    LOG4_TRACE("host %s port %d", strHost.c_str(), iPort);
+    return(SendTo(m_oEndpoints.Intern(strHost, iPort), eCodecType, bWithSsl, bPipeline, std::forward<Targs>(args)...));
+}
+
+template <typename ...Targs>
+bool Dispatcher::SendTo(uint32 uiEndpoint, E_CODEC_TYPE eCodecType, bool bWithSsl, bool bPipeline, Targs&&... args)
+{
+    Endpoints::tagEndpoint* pEndpoint = m_oEndpoints.Get(uiEndpoint);
+    if (nullptr == pEndpoint)
+    {
+        LOG4_ERROR("invalid endpoint %u.", uiEndpoint);
+        return(false);
+    }
+    if (pEndpoint->vecChannel.empty())
     {
-        size_t iPosIpPortSeparator = strIdentify.rfind(':');
-        size_t iPosPortWorkerIndexSeparator = strIdentify.rfind('.');
-        if (iPosIpPortSeparator == std::string::npos)
+        LOG4_TRACE("no channel match %s.", pEndpoint->strIdentify.c_str());
+        if (!pEndpoint->bAddressValid)
         {
+            LOG4_ERROR("invalid identify \"%s\", expect host:port or host:port.worker_index(worker index must smaller than 200).",
+                    pEndpoint->strIdentify.c_str());
             return(false);
         }
-        strHost = strIdentify.substr(0, iPosIpPortSeparator);
-        std::string strPort;
-        if (iPosPortWorkerIndexSeparator != std::string::npos && iPosPortWorkerIndexSeparator > iPosIpPortSeparator)
-        {
-            strPort = strIdentify.substr(iPosIpPortSeparator + 1, iPosPortWorkerIndexSeparator - (iPosIpPortSeparator + 1));
-            iPort = atoi(strPort.c_str());
-            if (iPort == 0)
-            {
-                return(false);
-            }
-            std::string strWorkerIndex = strIdentify.substr(iPosPortWorkerIndexSeparator + 1, std::string::npos);
-            iWorkerIndex = atoi(strWorkerIndex.c_str());
-            if (iWorkerIndex > 200)
-            {
-                strError = "worker index must smaller than 200";
-                return(false);
-            }
-        }
-        else
+        bool bResult = AutoSend(pEndpoint->strIdentify, pEndpoint->strHost, pEndpoint->iPort, pEndpoint->iWorkerIndex,
+                eCodecType, bWithSsl, bPipeline, std::forward<Targs>(args)...);
+        if (bResult && bPipeline && CODEC_NEBULA == eCodecType)
         {
-            strPort = strIdentify.substr(iPosIpPortSeparator + 1, std::string::npos);
-            iPort = atoi(strPort.c_str());
-            if (iPort == 0)
-            {
-                return(false);
-            }
+            ExtendEndpointPool(uiEndpoint, eCodecType, true);   // 预先建立连接池中的其余连接
         }
-        return(true);
-    };
-
-    auto named_iter = m_mapNamedSocketChannel.find(strIdentify);
-    if (named_iter == m_mapNamedSocketChannel.end())
-    {
-        LOG4_TRACE("no channel match %s.", strIdentify.c_str());
-        std::string strError;
-        std::string strHost;
-        int iPort = 0;
-        int iWorkerIndex = 0;
-        if (!split(strIdentify, strHost, iPort, iWorkerIndex, strError))
-        {
-            LOG4_ERROR("%s", strError.c_str());
-            return(false);
-        }
-        return(AutoSend(strIdentify, strHost, iPort, iWorkerIndex, eCodecType, bWithSsl, bPipeline, std::forward<Targs>(args)...));
+        return(bResult);
     }
-    else
+    if (!bPipeline)
     {
-        if (named_iter->second.empty())
-        {
-            std::string strError;
-            std::string strHost;
-            int iPort = 0;
-            int iWorkerIndex = 0;
-            if (!split(strIdentify, strHost, iPort, iWorkerIndex, strError))
-            {
-                LOG4_ERROR("%s", strError.c_str());
-                return(false);
-            }
-            return(AutoSend(strIdentify, strHost, iPort, iWorkerIndex, eCodecType, bWithSsl, bPipeline, std::forward<Targs>(args)...));
-        }
-        else
+        std::shared_ptr<SocketChannel> pChannel = pEndpoint->vecChannel.back();
+        bool bResult = SendTo(pChannel, std::forward<Targs>(args)...);
+        if (bResult)
         {
-            auto channel_iter = named_iter->second.begin();
-            bool bResult = SendTo((*channel_iter), std::forward<Targs>(args)...);
-            if (!bPipeline && bResult)
-            {
-                named_iter->second.erase(channel_iter);
-            }
-            return(bResult);
+            m_oEndpoints.DelChannel(uiEndpoint, pChannel);  // 非pipeline连接在收到响应后由ActorBuilder放回
         }
+        return(bResult);
     }
-}
 
-template <typename ...Targs>
-bool Dispatcher::SendTo(const std::string& strHost, int iPort, E_CODEC_TYPE eCodecType, bool bWithSsl, bool bPipeline, Targs&&... args)
-{
-    LOG4_TRACE("host %s port %d", strHost.c_str(), iPort);
-    std::ostringstream ossIdentify;
-    ossIdentify << strHost << ":" << iPort;
-    auto named_iter = m_mapNamedSocketChannel.find(ossIdentify.str());
-    if (named_iter == m_mapNamedSocketChannel.end())
-    {
-        LOG4_TRACE("no channel match %s.", ossIdentify.str().c_str());
-        return(AutoSend(ossIdentify.str(), strHost, iPort, 0, eCodecType, bWithSsl, bPipeline, std::forward<Targs>(args)...));
-    }
-    else
+    // 选择待响应请求最少的连接，相同时选择待发送字节数最少的；尚在建立中的连接视为有一个待响应请求
+    std::shared_ptr<SocketChannel> pChannel = nullptr;
+    size_t uiLeastInFlight = (size_t)-1;
+    size_t uiLeastQueuedBytes = (size_t)-1;
+    for (auto it = pEndpoint->vecChannel.begin(); it != pEndpoint->vecChannel.end(); ++it)
     {
-        auto channel_iter = named_iter->second.begin();
-        if (channel_iter == named_iter->second.end())
+        size_t uiInFlight = (*it)->m_pImpl->GetPipelineStepSeq().size()
+            + ((CHANNEL_STATUS_ESTABLISHED == (*it)->m_pImpl->GetChannelStatus()) ? 0 : 1);
+        size_t uiQueuedBytes = (*it)->m_pImpl->GetQueuedBytes();
+        if (uiInFlight < uiLeastInFlight || (uiInFlight == uiLeastInFlight && uiQueuedBytes < uiLeastQueuedBytes))
         {
-            return(AutoSend(ossIdentify.str(), strHost, iPort, 0, eCodecType, bWithSsl, bPipeline, std::forward<Targs>(args)...));
+            pChannel = *it;
+            uiLeastInFlight = uiInFlight;
+            uiLeastQueuedBytes = uiQueuedBytes;
         }
-        bool bResult = SendTo((*channel_iter), std::forward<Targs>(args)...);
-        if (!bPipeline && bResult)
-        {
-            named_iter->second.erase(channel_iter);
-        }
-        return(bResult);
     }
+    bool bResult = SendTo(pChannel, std::forward<Targs>(args)...);
+    if (CODEC_NEBULA == eCodecType && (uiLeastInFlight > 0 || uiLeastQueuedBytes > 0))
+    {
+        ExtendEndpointPool(uiEndpoint, eCodecType, false);  // 所有连接都繁忙，扩充连接池
+    }
+    return(bResult);
 }
 
 template <typename ...Targs>
@@ -363,104 +530,43 @@ bool Dispatcher::AutoSend(
         int iRemoteWorkerIndex, E_CODEC_TYPE eCodecType, bool bWithSsl, bool bPipeline, Targs&&... args)
 {
     LOG4_TRACE("%s", strIdentify.c_str());
-    struct addrinfo stAddrHints;
-    struct addrinfo* pAddrResult;
-    struct addrinfo* pAddrCurrent;
-    memset(&stAddrHints, 0, sizeof(struct addrinfo));
-    stAddrHints.ai_family = AF_UNSPEC;
-    stAddrHints.ai_socktype = SOCK_STREAM;
-    stAddrHints.ai_protocol = IPPROTO_IP;
-    int iCode = getaddrinfo(strHost.c_str(), std::to_string(iPort).c_str(), &stAddrHints, &pAddrResult);
-    if (0 != iCode)
-    {
-        LOG4_ERROR("getaddrinfo(\"%s\", \"%d\") error %d: %s",
-                strHost.c_str(), iPort, iCode, gai_strerror(iCode));
-        return(false);
-    }
-    int iFd = -1;
-    for (pAddrCurrent = pAddrResult;
-            pAddrCurrent != NULL; pAddrCurrent = pAddrCurrent->ai_next)
+    std::shared_ptr<SocketChannel> pChannel = Connect(strHost, iPort, eCodecType, bWithSsl);
+    if (nullptr == pChannel)
     {
-        iFd = socket(pAddrCurrent->ai_family,
-                pAddrCurrent->ai_socktype, pAddrCurrent->ai_protocol);
-        if (iFd == -1)
-        {
-            continue;
-        }
-
-        break;
+        return(false);
     }
-
-    /* No address succeeded */
-    if (pAddrCurrent == NULL)
+    pChannel->m_pImpl->SetIdentify(strIdentify);
+    pChannel->m_pImpl->SetPipeline(bPipeline);
+    E_CODEC_STATUS eCodecStatus = pChannel->m_pImpl->Send(std::forward<Targs>(args)...);
+    if (CODEC_STATUS_OK != eCodecStatus
+            && CODEC_STATUS_PAUSE != eCodecStatus
+            && CODEC_STATUS_WANT_WRITE != eCodecStatus
+            && CODEC_STATUS_WANT_READ != eCodecStatus)
     {
-        LOG4_ERROR("Could not connect to \"%s:%d\"", strHost.c_str(), iPort);
-        freeaddrinfo(pAddrResult);           /* No longer needed */
-        return(false);
+        DiscardSocketChannel(pChannel);
     }
 
-    x_sock_set_block(iFd, 0);
-    int nREUSEADDR = 1;
-    int iKeepAlive = 1;
-    int iKeepIdle = 60;
-    int iKeepInterval = 5;
-    int iKeepCount = 3;
-    int iTcpNoDelay = 1;
-    int iTcpQuickAck = 1;
-    setsockopt(iFd, SOL_SOCKET, SO_REUSEADDR, (const char*)&nREUSEADDR, sizeof(int));
-    setsockopt(iFd, SOL_SOCKET, SO_KEEPALIVE, (void*)&iKeepAlive, sizeof(iKeepAlive));
-    setsockopt(iFd, IPPROTO_TCP, TCP_KEEPIDLE, (void*) &iKeepIdle, sizeof(iKeepIdle));
-    setsockopt(iFd, IPPROTO_TCP, TCP_KEEPINTVL, (void *)&iKeepInterval, sizeof(iKeepInterval));
-    setsockopt(iFd, IPPROTO_TCP, TCP_KEEPCNT, (void*)&iKeepCount, sizeof (iKeepCount));
-    setsockopt(iFd, IPPROTO_TCP, TCP_NODELAY, (void*)&iTcpNoDelay, sizeof(iTcpNoDelay));
-    setsockopt(iFd, IPPROTO_TCP, TCP_QUICKACK, (void*)&iTcpQuickAck, sizeof(iTcpQuickAck));
-    std::shared_ptr<SocketChannel> pChannel = CreateSocketChannel(iFd, eCodecType, true, bWithSsl);
-    if (nullptr != pChannel)
-    {
-        connect(iFd, pAddrCurrent->ai_addr, pAddrCurrent->ai_addrlen);
-        freeaddrinfo(pAddrResult);           /* No longer needed */
-        AddIoTimeout(pChannel, 1.5);
-        AddIoReadEvent(pChannel);
-        AddIoWriteEvent(pChannel);
-        pChannel->m_pImpl->SetIdentify(strIdentify);
-        pChannel->m_pImpl->SetRemoteAddr(strHost);
-        pChannel->m_pImpl->SetPipeline(bPipeline);
-        E_CODEC_STATUS eCodecStatus = pChannel->m_pImpl->Send(std::forward<Targs>(args)...);
-        if (CODEC_STATUS_OK != eCodecStatus
-                && CODEC_STATUS_PAUSE != eCodecStatus
-                && CODEC_STATUS_WANT_WRITE != eCodecStatus
-                && CODEC_STATUS_WANT_READ != eCodecStatus)
-        {
-            DiscardSocketChannel(pChannel);
-        }
-
-        pChannel->m_pImpl->SetChannelStatus(CHANNEL_STATUS_TRY_CONNECT);
-        pChannel->m_pImpl->SetRemoteWorkerIndex(iRemoteWorkerIndex);
-        if (bPipeline)
-        {
-            AddNamedSocketChannel(strIdentify, pChannel);
-        }
-        return(true);
-    }
-    else    // 没有足够资源分配给新连接，直接close掉
+    pChannel->m_pImpl->SetChannelStatus(CHANNEL_STATUS_TRY_CONNECT);
+    pChannel->m_pImpl->SetRemoteWorkerIndex(iRemoteWorkerIndex);
+    if (bPipeline)
     {
-        freeaddrinfo(pAddrResult);           /* No longer needed */
-        close(iFd);
-        return(false);
+        AddNamedSocketChannel(strIdentify, pChannel);
     }
+    return(true);
 }
 
 template <typename ...Targs>
 bool Dispatcher::SendRoundRobin(const std::string& strNodeType, E_CODEC_TYPE eCodecType, bool bWithSsl, bool bPipeline, Targs&&... args)
 {
     LOG4_TRACE("node_type: %s", strNodeType.c_str());
-    std::string strOnlineNode;
-    if (m_pSessionNode->GetNode(strNodeType, strOnlineNode))
+    uint32 uiEndpoint = Endpoints::s_uiInvalidEndpoint;
+    if (m_pSessionNode->GetNode(strNodeType, uiEndpoint))
     {
-        return(SendTo(strOnlineNode, eCodecType, bWithSsl, bPipeline, std::forward<Targs>(args)...));
+        return(SendTo(uiEndpoint, eCodecType, bWithSsl, bPipeline, std::forward<Targs>(args)...));
     }
     else
     {
+        std::string strOnlineNode;
         LOG4_TRACE("node type \"%s\" not found, go to SplitAddAndGetNode.", strNodeType.c_str());
         if (m_pSessionNode->SplitAddAndGetNode(strNodeType, strOnlineNode))
         {
@@ -475,13 +581,14 @@ template <typename ...Targs>
 bool Dispatcher::SendOriented(const std::string& strNodeType, E_CODEC_TYPE eCodecType, bool bWithSsl, bool bPipeline, uint32 uiFactor, Targs&&... args)
 {
     LOG4_TRACE("node_type: %s", strNodeType.c_str());
-    std::string strOnlineNode;
-    if (m_pSessionNode->GetNode(strNodeType, uiFactor, strOnlineNode))
+    uint32 uiEndpoint = Endpoints::s_uiInvalidEndpoint;
+    if (m_pSessionNode->GetNode(strNodeType, uiFactor, uiEndpoint))
     {
-        return(SendTo(strOnlineNode, eCodecType, bWithSsl, bPipeline, std::forward<Targs>(args)...));
+        return(SendTo(uiEndpoint, eCodecType, bWithSsl, bPipeline, std::forward<Targs>(args)...));
     }
     else
     {
+        std::string strOnlineNode;
         LOG4_TRACE("node type \"%s\" not found, go to SplitAddAndGetNode.", strNodeType.c_str());
         if (m_pSessionNode->SplitAddAndGetNode(strNodeType, strOnlineNode))
         {
@@ -496,13 +603,14 @@ template <typename ...Targs>
 bool Dispatcher::SendOriented(const std::string& strNodeType, E_CODEC_TYPE eCodecType, bool bWithSsl, bool bPipeline, const std::string& strFactor, Targs&&... args)
 {
     LOG4_TRACE("node_type: %s", strNodeType.c_str());
-    std::string strOnlineNode;
-    if (m_pSessionNode->GetNode(strNodeType, strFactor, strOnlineNode))
+    uint32 uiEndpoint = Endpoints::s_uiInvalidEndpoint;
+    if (m_pSessionNode->GetNode(strNodeType, strFactor, uiEndpoint))
     {
-        return(SendTo(strOnlineNode, eCodecType, bWithSsl, bPipeline, std::forward<Targs>(args)...));
+        return(SendTo(uiEndpoint, eCodecType, bWithSsl, bPipeline, std::forward<Targs>(args)...));
     }
     else
     {
+        std::string strOnlineNode;
         LOG4_TRACE("node type \"%s\" not found, go to SplitAddAndGetNode.", strNodeType.c_str());
         if (m_pSessionNode->SplitAddAndGetNode(strNodeType, strOnlineNode))
         {
@@ -520,12 +628,7 @@ bool Dispatcher::Broadcast(const std::string& strNodeType, E_CODEC_TYPE eCodecTy
     std::unordered_set<std::string> setOnlineNodes;
     if (m_pSessionNode->GetNode(strNodeType, setOnlineNodes))
     {
-        bool bSendResult = false;
-        for (auto node_iter = setOnlineNodes.begin(); node_iter != setOnlineNodes.end(); ++node_iter)
-        {
-            bSendResult |= SendTo(*node_iter, eCodecType, bWithSsl, bPipeline, std::forward<Targs>(args)...);
-        }
-        return(bSendResult);
+        return(SendToNodes(setOnlineNodes, eCodecType, bWithSsl, bPipeline, std::forward<Targs>(args)...));
     }
     else
     {
@@ -541,12 +644,7 @@ bool Dispatcher::Broadcast(const std::string& strNodeType, E_CODEC_TYPE eCodecTy
             {
                 if (m_pSessionNode->GetNode(strNodeType, setOnlineNodes))
                 {
-                    bool bSendResult = false;
-                    for (auto node_iter = setOnlineNodes.begin(); node_iter != setOnlineNodes.end(); ++node_iter)
-                    {
-                        bSendResult |= SendTo(*node_iter, eCodecType, bWithSsl, bPipeline, std::forward<Targs>(args)...);
-                    }
-                    return(bSendResult);
+                    return(SendToNodes(setOnlineNodes, eCodecType, bWithSsl, bPipeline, std::forward<Targs>(args)...));
                 }
             }
             LOG4_ERROR("no online node match node_type \"%s\"", strNodeType.c_str());
@@ -555,6 +653,49 @@ bool Dispatcher::Broadcast(const std::string& strNodeType, E_CODEC_TYPE eCodecTy
     }
 }
 
+template <typename Channels>
+bool Dispatcher::Multicast(const Channels& oChannels, int32 iCmd, uint32 uiSeq, const MsgBody& oMsgBody)
+{
+    LOG4_TRACE("cmd %d, seq %u", iCmd, uiSeq);
+    EncodedFrame oFrame(iCmd, uiSeq, oMsgBody);
+    bool bSendResult = false;
+    for (auto channel_iter = oChannels.begin(); channel_iter != oChannels.end(); ++channel_iter)
+    {
+        if (nullptr == *channel_iter)
+        {
+            continue;
+        }
+        bSendResult |= SendTo(*channel_iter, oFrame);
+    }
+    return(bSendResult);
+}
+
+template <typename ...Targs>
+typename std::enable_if<std::is_constructible<EncodedFrame, Targs&&...>::value, bool>::type
+Dispatcher::SendToNodes(const std::unordered_set<std::string>& setNodes, E_CODEC_TYPE eCodecType, bool bWithSsl, bool bPipeline, Targs&&... args)
+{
+    // 已连接的节点共享同一份编码结果，尚未连接的节点由AutoSend()退回逐连接编码
+    EncodedFrame oFrame(std::forward<Targs>(args)...);
+    bool bSendResult = false;
+    for (auto node_iter = setNodes.begin(); node_iter != setNodes.end(); ++node_iter)
+    {
+        bSendResult |= SendTo(*node_iter, eCodecType, bWithSsl, bPipeline, oFrame);
+    }
+    return(bSendResult);
+}
+
+template <typename ...Targs>
+typename std::enable_if<!std::is_constructible<EncodedFrame, Targs&&...>::value, bool>::type
+Dispatcher::SendToNodes(const std::unordered_set<std::string>& setNodes, E_CODEC_TYPE eCodecType, bool bWithSsl, bool bPipeline, Targs&&... args)
+{
+    bool bSendResult = false;
+    for (auto node_iter = setNodes.begin(); node_iter != setNodes.end(); ++node_iter)
+    {
+        bSendResult |= SendTo(*node_iter, eCodecType, bWithSsl, bPipeline, std::forward<Targs>(args)...);
+    }
+    return(bSendResult);
+}
+
 } /* namespace neb */
 
 #endif /* SRC_IOS_DISPATCHER_HPP_ */
@@ -0,0 +1,134 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     Endpoints.cpp
+ * @brief    对端节点登记表
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note
+ * Modify history:
+ ******************************************************************************/
+#include <cstdlib>
+#include "Endpoints.hpp"
+
+namespace neb
+{
+
+Endpoints::Endpoints()
+{
+    m_deqEndpoint.emplace_back();   // 0号为无效句柄
+}
+
+Endpoints::~Endpoints()
+{
+    m_mapEndpoint.clear();
+    m_deqEndpoint.clear();
+}
+
+uint32 Endpoints::Intern(const std::string& strIdentify)
+{
+    auto iter = m_mapEndpoint.find(strIdentify);
+    if (iter != m_mapEndpoint.end())
+    {
+        return(iter->second);
+    }
+    uint32 uiEndpoint = m_deqEndpoint.size();
+    m_deqEndpoint.emplace_back();
+    tagEndpoint& stEndpoint = m_deqEndpoint.back();
+    stEndpoint.strIdentify = strIdentify;
+    stEndpoint.bAddressValid = Split(strIdentify, stEndpoint.strHost, stEndpoint.iPort, stEndpoint.iWorkerIndex);
+    m_mapEndpoint.insert(std::make_pair(strIdentify, uiEndpoint));
+    return(uiEndpoint);
+}
+
+uint32 Endpoints::Intern(const std::string& strHost, int iPort)
+{
+    m_strIdentify.assign(strHost);
+    m_strIdentify.append(":");
+    m_strIdentify.append(std::to_string(iPort));
+    return(Intern(m_strIdentify));
+}
+
+uint32 Endpoints::Find(const std::string& strIdentify) const
+{
+    auto iter = m_mapEndpoint.find(strIdentify);
+    if (iter == m_mapEndpoint.end())
+    {
+        return(s_uiInvalidEndpoint);
+    }
+    return(iter->second);
+}
+
+bool Endpoints::AddChannel(uint32 uiEndpoint, std::shared_ptr<SocketChannel> pChannel)
+{
+    tagEndpoint* pEndpoint = Get(uiEndpoint);
+    if (nullptr == pEndpoint)
+    {
+        return(false);
+    }
+    for (auto it = pEndpoint->vecChannel.begin(); it != pEndpoint->vecChannel.end(); ++it)
+    {
+        if (*it == pChannel)
+        {
+            return(true);
+        }
+    }
+    pEndpoint->vecChannel.push_back(pChannel);
+    return(true);
+}
+
+bool Endpoints::DelChannel(uint32 uiEndpoint, std::shared_ptr<SocketChannel> pChannel)
+{
+    tagEndpoint* pEndpoint = Get(uiEndpoint);
+    if (nullptr == pEndpoint)
+    {
+        return(false);
+    }
+    for (size_t i = 0; i < pEndpoint->vecChannel.size(); ++i)
+    {
+        if (pEndpoint->vecChannel[i] == pChannel)
+        {
+            if (i + 1 < pEndpoint->vecChannel.size())
+            {
+                pEndpoint->vecChannel[i] = std::move(pEndpoint->vecChannel.back());
+            }
+            pEndpoint->vecChannel.pop_back();
+            return(true);
+        }
+    }
+    return(false);
+}
+
+void Endpoints::ClearChannel()
+{
+    for (auto it = m_deqEndpoint.begin(); it != m_deqEndpoint.end(); ++it)
+    {
+        it->vecChannel.clear();
+    }
+}
+
+bool Endpoints::Split(const std::string& strIdentify, std::string& strHost, int& iPort, int& iWorkerIndex)
+{
+    size_t iPosIpPortSeparator = strIdentify.rfind(':');
+    size_t iPosPortWorkerIndexSeparator = strIdentify.rfind('.');
+    if (iPosIpPortSeparator == std::string::npos)
+    {
+        return(false);
+    }
+    strHost = strIdentify.substr(0, iPosIpPortSeparator);
+    if (iPosPortWorkerIndexSeparator != std::string::npos && iPosPortWorkerIndexSeparator > iPosIpPortSeparator)
+    {
+        iPort = atoi(strIdentify.c_str() + iPosIpPortSeparator + 1);
+        iWorkerIndex = atoi(strIdentify.c_str() + iPosPortWorkerIndexSeparator + 1);
+        if (iWorkerIndex > 200)     // worker index must smaller than 200
+        {
+            return(false);
+        }
+    }
+    else
+    {
+        iPort = atoi(strIdentify.c_str() + iPosIpPortSeparator + 1);
+    }
+    return(iPort != 0);
+}
+
+} /* namespace neb */
@@ -0,0 +1,102 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     Endpoints.hpp
+ * @brief    对端节点登记表
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note     节点标识（"host:port"或"host:port.worker_index"）首次出现时登记一次，
+ * 分配一个整数句柄并解析出host、port、worker_index，之后按句柄以下标访问该节点的
+ * 连接列表，发送时不再对节点标识做hash查找和字符串解析。
+ * Modify history:
+ ******************************************************************************/
+#ifndef SRC_IOS_ENDPOINTS_HPP_
+#define SRC_IOS_ENDPOINTS_HPP_
+
+#include <string>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include "Definition.hpp"
+
+namespace neb
+{
+
+class SocketChannel;
+
+/**
+ * @brief 对端节点登记表
+ * @note 每个Dispatcher一份，非线程安全。句柄在登记表生命周期内不回收、不复用，
+ * 0为无效句柄。节点信息存放于std::deque，登记新节点不会使已取得的tagEndpoint
+ * 引用失效。
+ */
+class Endpoints
+{
+public:
+    struct tagEndpoint
+    {
+        std::string strIdentify;
+        std::string strHost;
+        int iPort = 0;
+        int iWorkerIndex = 0;
+        bool bAddressValid = false;     ///< strIdentify是否可解析为host:port[.worker_index]
+        std::vector<std::shared_ptr<SocketChannel> > vecChannel;     ///< 连接存在时，if(http连接)size()>=1;else size()==1;
+    };
+
+    Endpoints();
+    Endpoints(const Endpoints&) = delete;
+    Endpoints& operator=(const Endpoints&) = delete;
+    virtual ~Endpoints();
+
+    /**
+     * @brief 登记节点
+     * @return 节点句柄，已登记的节点返回原句柄
+     */
+    uint32 Intern(const std::string& strIdentify);
+    uint32 Intern(const std::string& strHost, int iPort);
+
+    /**
+     * @brief 查找已登记的节点
+     * @return 节点句柄，未登记返回s_uiInvalidEndpoint
+     */
+    uint32 Find(const std::string& strIdentify) const;
+
+    tagEndpoint* Get(uint32 uiEndpoint)
+    {
+        if (s_uiInvalidEndpoint == uiEndpoint || uiEndpoint >= m_deqEndpoint.size())
+        {
+            return(nullptr);
+        }
+        return(&m_deqEndpoint[uiEndpoint]);
+    }
+
+    /**
+     * @brief 已登记的节点数（含0号无效句柄），有效句柄为[1, GetEndpointNum())
+     */
+    uint32 GetEndpointNum() const
+    {
+        return(m_deqEndpoint.size());
+    }
+
+    bool AddChannel(uint32 uiEndpoint, std::shared_ptr<SocketChannel> pChannel);
+    bool DelChannel(uint32 uiEndpoint, std::shared_ptr<SocketChannel> pChannel);
+
+    /**
+     * @brief 清空所有节点的连接列表（节点句柄保持有效）
+     */
+    void ClearChannel();
+
+    static const uint32 s_uiInvalidEndpoint = 0;
+
+protected:
+    static bool Split(const std::string& strIdentify, std::string& strHost, int& iPort, int& iWorkerIndex);
+
+private:
+    std::deque<tagEndpoint> m_deqEndpoint;
+    std::unordered_map<std::string, uint32> m_mapEndpoint;      ///< key为节点标识，value为句柄
+    std::string m_strIdentify;      ///< 由host和port拼接节点标识的临时缓冲区
+};
+
+} /* namespace neb */
+
+#endif /* SRC_IOS_ENDPOINTS_HPP_ */
@@ -0,0 +1,160 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     MessagePool.hpp
+ * @brief    解码消息回收池
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note     Dispatcher每次解码都要构造一个MsgHead、MsgBody、HttpMsg或RedisMsg，
+ * 回调返回即析构，pipeline的redis和http keep-alive场景下分配释放非常频繁。
+ * 回收池里的消息在回收时Clear()，pb的Clear()保留字符串和repeated字段已分配的
+ * 内存（包括RedisReply递归的element），下一次解码可直接复用。
+ * 保留的内存不会随Clear()释放，一次大消息（如大的MGET结果或http body）会让回收池
+ * 一直占着这块内存，所以回收前按SpaceUsedLong()检查，超过上限的消息直接释放。
+ * Modify history:
+ ******************************************************************************/
+#ifndef SRC_IOS_MESSAGEPOOL_HPP_
+#define SRC_IOS_MESSAGEPOOL_HPP_
+
+#include <memory>
+#include <vector>
+#include "Definition.hpp"
+
+namespace neb
+{
+
+/**
+ * @brief 消息回收池
+ * @note 非线程安全，每个Dispatcher（即每个Worker）各持有一份。
+ */
+template<typename T>
+class MessagePool
+{
+public:
+    /**
+     * @brief 从回收池取得消息并在作用域结束时归还
+     */
+    class Holder
+    {
+    public:
+        explicit Holder(MessagePool<T>& oPool)
+            : m_oPool(oPool), m_pMsg(oPool.Acquire())
+        {
+        }
+        Holder(const Holder&) = delete;
+        Holder& operator=(const Holder&) = delete;
+        ~Holder()
+        {
+            m_oPool.Release(m_pMsg);
+        }
+
+        T& operator*() const
+        {
+            return(*m_pMsg);
+        }
+
+    private:
+        MessagePool<T>& m_oPool;
+        T* m_pMsg;
+    };
+
+public:
+    /**
+     * @param uiMaxIdle 回收池最多保留的空闲消息数，超出的消息直接释放
+     * @param uiMaxRetainBytes 回收的消息（含已分配未释放的内存）最大字节数，超出的消息直接释放
+     */
+    explicit MessagePool(uint32 uiMaxIdle = 16, size_t uiMaxRetainBytes = 64 * 1024)
+        : m_uiMaxIdle(uiMaxIdle), m_uiMaxRetainBytes(uiMaxRetainBytes)
+    {
+    }
+    MessagePool(const MessagePool&) = delete;
+    MessagePool& operator=(const MessagePool&) = delete;
+
+    ~MessagePool()
+    {
+        for (auto pMsg : m_vecIdle)
+        {
+            delete pMsg;
+        }
+        for (auto pMsg : m_vecInUse)
+        {
+            delete pMsg;
+        }
+    }
+
+    T* Acquire()
+    {
+        T* pMsg = nullptr;
+        if (m_vecIdle.empty())
+        {
+            pMsg = new T();
+        }
+        else
+        {
+            pMsg = m_vecIdle.back();
+            m_vecIdle.pop_back();
+        }
+        m_vecInUse.push_back(pMsg);
+        return(pMsg);
+    }
+
+    /**
+     * @brief 归还消息
+     * @note 已被Retain()接管的消息不再归还。
+     */
+    void Release(T* pMsg)
+    {
+        if (!Detach(pMsg))
+        {
+            return;
+        }
+        if (m_vecIdle.size() < m_uiMaxIdle && pMsg->SpaceUsedLong() <= m_uiMaxRetainBytes)
+        {
+            pMsg->Clear();
+            m_vecIdle.push_back(pMsg);
+        }
+        else
+        {
+            delete pMsg;
+        }
+    }
+
+    /**
+     * @brief 接管正在使用的消息
+     * @note oMsg是本回收池正在使用的消息时，将消息本身移出回收池交给调用方（无拷贝），
+     * 否则复制一份。
+     */
+    std::shared_ptr<T> Retain(const T& oMsg)
+    {
+        T* pMsg = const_cast<T*>(&oMsg);
+        if (Detach(pMsg))
+        {
+            return(std::shared_ptr<T>(pMsg));
+        }
+        return(std::make_shared<T>(oMsg));
+    }
+
+private:
+    bool Detach(T* pMsg)
+    {
+        // 嵌套解码极少，正在使用的消息通常只有一两个且总在末尾
+        for (auto it = m_vecInUse.rbegin(); it != m_vecInUse.rend(); ++it)
+        {
+            if (*it == pMsg)
+            {
+                m_vecInUse.erase(std::next(it).base());
+                return(true);
+            }
+        }
+        return(false);
+    }
+
+private:
+    uint32 m_uiMaxIdle;
+    size_t m_uiMaxRetainBytes;
+    std::vector<T*> m_vecIdle;
+    std::vector<T*> m_vecInUse;
+};
+
+} /* namespace neb */
+
+#endif /* SRC_IOS_MESSAGEPOOL_HPP_ */
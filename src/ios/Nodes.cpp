@@ -9,7 +9,9 @@
  * Modify history:
  ******************************************************************************/
 #include "Nodes.hpp"
+#include "Endpoints.hpp"
 #include <cstring>
+#include <algorithm>
 #define CRYPTOPP_ENABLE_NAMESPACE_WEAK 1
 #include "cryptopp/md5.h"
 #include "cryptopp/hex.h"
@@ -20,8 +22,9 @@
 namespace neb
 {
 
-Nodes::Nodes(int iHashAlgorithm, int iVirtualNodeNum)
-    : m_iHashAlgorithm(iHashAlgorithm), m_iVirtualNodeNum(iVirtualNodeNum)
+Nodes::Nodes(int iHashAlgorithm, int iVirtualNodeNum, int iDistribution, Endpoints* pEndpoints)
+    : m_iHashAlgorithm(iHashAlgorithm), m_iVirtualNodeNum(iVirtualNodeNum), m_iDistribution(iDistribution),
+      m_pEndpoints(pEndpoints)
 {
 }
 
@@ -33,99 +36,72 @@ Nodes::~Nodes()
 
 bool Nodes::GetNode(const std::string& strNodeType, const std::string& strHashKey, std::string& strNodeIdentify)
 {
-    uint32 uiKeyHash = 0;
-    switch (m_iHashAlgorithm)
+    const std::string* pNodeIdentify = nullptr;
+    if (GetNode(strNodeType, HashKey(strHashKey.c_str(), strHashKey.size()), pNodeIdentify))
     {
-        case HASH_cityhash_32:
-            uiKeyHash = CityHash32(strHashKey.c_str(), strHashKey.size());
-            break;
-        case HASH_fnv1_64:
-            uiKeyHash = hash_fnv1_64(strHashKey.c_str(), strHashKey.size());
-            break;
-        case HASH_murmur3_32:
-            uiKeyHash = murmur3_32(strHashKey.c_str(), strHashKey.size(), 0x000001b3);
-            break;
-        default:
-            uiKeyHash = hash_fnv1a_64(strHashKey.c_str(), strHashKey.size());
+        strNodeIdentify = *pNodeIdentify;
+        return(true);
     }
+    return(false);
+}
 
-    auto node_type_iter = m_mapNode.find(strNodeType);
-    if (node_type_iter == m_mapNode.end())
-    {
-        return(false);
-    }
-    else
+bool Nodes::GetNode(const std::string& strNodeType, uint32 uiHash, std::string& strNodeIdentify)
+{
+    const std::string* pNodeIdentify = nullptr;
+    if (GetNode(strNodeType, uiHash, pNodeIdentify))
     {
-        if (node_type_iter->second->bCheckFailedNode)
-        {
-            node_type_iter->second->bCheckFailedNode = false;
-            if (node_type_iter->second->setFailedNode.size() > 0)
-            {
-                strNodeIdentify = *(node_type_iter->second->setFailedNode.begin());
-                return(true);
-            }
-        }
-        auto c_iter = node_type_iter->second->mapHash2Node.lower_bound(uiKeyHash);
-        if (c_iter == node_type_iter->second->mapHash2Node.end())
-        {
-            strNodeIdentify = node_type_iter->second->mapHash2Node.begin()->second;
-        }
-        else
-        {
-            strNodeIdentify = c_iter->second;
-            node_type_iter->second->itHashRing = c_iter;
-        }
+        strNodeIdentify = *pNodeIdentify;
         return(true);
     }
+    return(false);
 }
 
-bool Nodes::GetNode(const std::string& strNodeType, uint32 uiHash, std::string& strNodeIdentify)
+bool Nodes::GetNode(const std::string& strNodeType, const std::string& strHashKey, const std::string*& pNodeIdentify)
+{
+    return(GetNode(strNodeType, HashKey(strHashKey.c_str(), strHashKey.size()), pNodeIdentify));
+}
+
+bool Nodes::GetNode(const std::string& strNodeType, uint32 uiHash, const std::string*& pNodeIdentify)
 {
     auto node_type_iter = m_mapNode.find(strNodeType);
     if (node_type_iter == m_mapNode.end())
     {
         return(false);
     }
-    else
+    tagNode& stNode = *(node_type_iter->second);
+    if (stNode.bCheckFailedNode)
     {
-        if (node_type_iter->second->bCheckFailedNode)
-        {
-            node_type_iter->second->bCheckFailedNode = false;
-            if (node_type_iter->second->setFailedNode.size() > 0)
-            {
-                strNodeIdentify = *(node_type_iter->second->setFailedNode.begin());
-                return(true);
-            }
-        }
-        auto c_iter = node_type_iter->second->mapHash2Node.lower_bound(uiHash);
-        if (c_iter == node_type_iter->second->mapHash2Node.end())
+        stNode.bCheckFailedNode = false;
+        if (stNode.setFailedNode.size() > 0)
         {
-            strNodeIdentify = node_type_iter->second->mapHash2Node.begin()->second;
-        }
-        else
-        {
-            strNodeIdentify = c_iter->second;
-            node_type_iter->second->itHashRing = c_iter;
+            pNodeIdentify = &(*(stNode.setFailedNode.begin()));
+            return(true);
         }
-        return(true);
     }
+    if (stNode.vecNodeIdentify.empty())     // 节点均已失败
+    {
+        return(false);
+    }
+    pNodeIdentify = stNode.vecNodeIdentify[Locate(stNode, uiHash)];
+    return(true);
 }
 
 bool Nodes::GetNodeInHashRing(const std::string& strNodeType, std::string& strNodeIdentify)
 {
     auto node_type_iter = m_mapNode.find(strNodeType);
-    if (node_type_iter == m_mapNode.end())
+    if (node_type_iter == m_mapNode.end() || node_type_iter->second->vecRingHash.empty())
     {
         return(false);
     }
     else
     {
-        node_type_iter->second->itHashRing++;
-        if (node_type_iter->second->itHashRing == node_type_iter->second->mapHash2Node.end())
+        tagNode& stNode = *(node_type_iter->second);
+        ++stNode.uiHashRingPos;
+        if (stNode.uiHashRingPos >= stNode.vecRingHash.size())
         {
-            node_type_iter->second->itHashRing = node_type_iter->second->mapHash2Node.begin();
+            stNode.uiHashRingPos = 0;
         }
-        strNodeIdentify = node_type_iter->second->itHashRing->first;
+        strNodeIdentify = *(stNode.vecNodeIdentify[stNode.vecRingNode[stNode.uiHashRingPos]]);
         return(true);
     }
 }
@@ -137,194 +113,124 @@ bool Nodes::GetNode(const std::string& strNodeType, std::string& strNodeIdentify
     {
         return(false);
     }
-    else
+    const std::string* pFailedNode = nullptr;
+    uint32 uiIndex = PollNode(*(node_type_iter->second), pFailedNode);
+    if (nullptr != pFailedNode)
     {
-        if (node_type_iter->second->bCheckFailedNode)
-        {
-            node_type_iter->second->bCheckFailedNode = false;
-            if (node_type_iter->second->setFailedNode.size() > 0)
-            {
-                strNodeIdentify = *(node_type_iter->second->setFailedNode.begin());
-                return(true);
-            }
-        }
-        node_type_iter->second->itPollingNode++;
-        if (node_type_iter->second->itPollingNode == node_type_iter->second->mapNode2Hash.end())
-        {
-            node_type_iter->second->itPollingNode = node_type_iter->second->mapNode2Hash.begin();
-        }
-        strNodeIdentify = node_type_iter->second->itPollingNode->first;
+        strNodeIdentify = *pFailedNode;
         return(true);
     }
+    if (uiIndex >= node_type_iter->second->vecNodeIdentify.size())
+    {
+        return(false);
+    }
+    strNodeIdentify = *(node_type_iter->second->vecNodeIdentify[uiIndex]);
+    return(true);
 }
 
-bool Nodes::GetNode(const std::string& strNodeType, std::unordered_set<std::string>& setNodeIdentify)
+bool Nodes::GetNode(const std::string& strNodeType, uint32& uiEndpoint)
 {
     auto node_type_iter = m_mapNode.find(strNodeType);
-    if (node_type_iter == m_mapNode.end())
+    if (node_type_iter == m_mapNode.end() || nullptr == m_pEndpoints)
     {
         return(false);
     }
-    else
+    const std::string* pFailedNode = nullptr;
+    uint32 uiIndex = PollNode(*(node_type_iter->second), pFailedNode);
+    if (nullptr != pFailedNode)
     {
-        for (auto iter = node_type_iter->second->mapNode2Hash.begin(); iter != node_type_iter->second->mapNode2Hash.end(); ++iter)
-        {
-            setNodeIdentify.insert(iter->first);
-        }
+        uiEndpoint = m_pEndpoints->Intern(*pFailedNode);
         return(true);
     }
+    if (uiIndex >= node_type_iter->second->vecNodeEndpoint.size())
+    {
+        return(false);
+    }
+    uiEndpoint = node_type_iter->second->vecNodeEndpoint[uiIndex];
+    return(true);
 }
 
-void Nodes::AddNode(const std::string& strNodeType, const std::string& strNodeIdentify)
+bool Nodes::GetNode(const std::string& strNodeType, const std::string& strHashKey, uint32& uiEndpoint)
+{
+    return(GetNode(strNodeType, HashKey(strHashKey.c_str(), strHashKey.size()), uiEndpoint));
+}
+
+bool Nodes::GetNode(const std::string& strNodeType, uint32 uiHash, uint32& uiEndpoint)
 {
     auto node_type_iter = m_mapNode.find(strNodeType);
-    if (node_type_iter == m_mapNode.end())
+    if (node_type_iter == m_mapNode.end() || nullptr == m_pEndpoints)
     {
-        std::shared_ptr<tagNode> pNode = std::make_shared<tagNode>();
-        m_mapNode.insert(std::make_pair(strNodeType, pNode));
-        pNode->strNodeType = strNodeType;
-        std::string strHashKey;
-        char szVirtualNodeIdentify[40] = {0};
-        uint32 uiKeyHash = 0;
-        std::vector<uint32> vecHash;
-        for (int i = 0; i < m_iVirtualNodeNum; ++i)
-        {
-            snprintf(szVirtualNodeIdentify, 40, "%d@%s#%d", m_iVirtualNodeNum - i, strNodeIdentify.c_str(), i);
-            strHashKey = szVirtualNodeIdentify;
-            switch (m_iHashAlgorithm)
-            {
-                case HASH_cityhash_32:
-                    uiKeyHash = CityHash32(strHashKey.c_str(), strHashKey.size());
-                    break;
-                case HASH_fnv1_64:
-                    uiKeyHash = hash_fnv1_64(strHashKey.c_str(), strHashKey.size());
-                    break;
-                case HASH_murmur3_32:
-                    uiKeyHash = murmur3_32(strHashKey.c_str(), strHashKey.size(), 0x000001b3);
-                    break;
-                default:
-                    uiKeyHash = hash_fnv1a_64(strHashKey.c_str(), strHashKey.size());
-            }
-            vecHash.push_back(uiKeyHash);
-            pNode->mapHash2Node.insert(std::make_pair(uiKeyHash, strNodeIdentify));
-        }
-        pNode->mapNode2Hash.insert(std::make_pair(strNodeIdentify, std::move(vecHash)));
-        pNode->itPollingNode = pNode->mapNode2Hash.begin();
-        pNode->itHashRing = pNode->mapHash2Node.begin();
+        return(false);
     }
-    else
+    tagNode& stNode = *(node_type_iter->second);
+    if (stNode.bCheckFailedNode)
     {
-        auto node_iter = node_type_iter->second->mapNode2Hash.find(strNodeIdentify);
-        if (node_iter == node_type_iter->second->mapNode2Hash.end())
+        stNode.bCheckFailedNode = false;
+        if (stNode.setFailedNode.size() > 0)
         {
-            std::string strHashKey;
-            char szVirtualNodeIdentify[40] = {0};
-            uint32 uiKeyHash = 0;
-            std::vector<uint32> vecHash;
-            for (int i = 0; i < m_iVirtualNodeNum; ++i)
-            {
-                snprintf(szVirtualNodeIdentify, 40, "%d@%s#%d", m_iVirtualNodeNum - i, strNodeIdentify.c_str(), i);
-                strHashKey = szVirtualNodeIdentify;
-                switch (m_iHashAlgorithm)
-                {
-                    case HASH_cityhash_32:
-                        uiKeyHash = CityHash32(strHashKey.c_str(), strHashKey.size());
-                        break;
-                    case HASH_fnv1_64:
-                        uiKeyHash = hash_fnv1_64(strHashKey.c_str(), strHashKey.size());
-                        break;
-                    case HASH_murmur3_32:
-                        uiKeyHash = murmur3_32(strHashKey.c_str(), strHashKey.size(), 0x000001b3);
-                        break;
-                    default:
-                        uiKeyHash = hash_fnv1a_64(strHashKey.c_str(), strHashKey.size());
-                }
-                vecHash.push_back(uiKeyHash);
-                node_type_iter->second->mapHash2Node.insert(std::make_pair(uiKeyHash, strNodeIdentify));
-            }
-            node_type_iter->second->mapNode2Hash.insert(std::make_pair(strNodeIdentify, std::move(vecHash)));
-            node_type_iter->second->itPollingNode = node_type_iter->second->mapNode2Hash.begin();
-            node_type_iter->second->itHashRing = node_type_iter->second->mapHash2Node.begin();
+            uiEndpoint = m_pEndpoints->Intern(*(stNode.setFailedNode.begin()));
+            return(true);
         }
     }
-    auto node_id_iter = m_mapNodeType.find(strNodeIdentify);
-    if (node_id_iter == m_mapNodeType.end())
+    if (stNode.vecNodeEndpoint.empty())
     {
-        std::unordered_set<std::string> setNodeType;
-        setNodeType.insert(strNodeType);
-        m_mapNodeType.insert(std::make_pair(strNodeIdentify, std::move(setNodeType)));
+        return(false);
+    }
+    uiEndpoint = stNode.vecNodeEndpoint[Locate(stNode, uiHash)];
+    return(true);
+}
+
+bool Nodes::GetNode(const std::string& strNodeType, std::unordered_set<std::string>& setNodeIdentify)
+{
+    auto node_type_iter = m_mapNode.find(strNodeType);
+    if (node_type_iter == m_mapNode.end())
+    {
+        return(false);
     }
     else
     {
-        node_id_iter->second.insert(strNodeType);
+        for (auto iter = node_type_iter->second->mapNode2Hash.begin(); iter != node_type_iter->second->mapNode2Hash.end(); ++iter)
+        {
+            setNodeIdentify.insert(iter->first);
+        }
+        return(true);
     }
 }
 
+void Nodes::AddNode(const std::string& strNodeType, const std::string& strNodeIdentify)
+{
+    AddNode(strNodeType, strNodeIdentify, false);
+}
+
 void Nodes::AddNodeKetama(const std::string& strNodeType, const std::string& strNodeIdentify)
+{
+    AddNode(strNodeType, strNodeIdentify, true);
+}
+
+void Nodes::AddNode(const std::string& strNodeType, const std::string& strNodeIdentify, bool bKetama)
 {
     auto node_type_iter = m_mapNode.find(strNodeType);
     if (node_type_iter == m_mapNode.end())
     {
         std::shared_ptr<tagNode> pNode = std::make_shared<tagNode>();
-        m_mapNode.insert(std::make_pair(strNodeType, pNode));
         pNode->strNodeType = strNodeType;
-        std::string strHash;
-        char szVirtualNodeIdentify[40] = {0};
-        int32 iPointPerHash = 4;
+        node_type_iter = m_mapNode.insert(std::make_pair(strNodeType, pNode)).first;
+    }
+    tagNode& stNode = *(node_type_iter->second);
+    auto node_iter = stNode.mapNode2Hash.find(strNodeIdentify);
+    if (node_iter == stNode.mapNode2Hash.end())
+    {
         std::vector<uint32> vecHash;
-        for (int i = 0; i < m_iVirtualNodeNum / iPointPerHash; ++i)     // distribution: ketama
+        if (bKetama)
         {
-            snprintf(szVirtualNodeIdentify, 40, "%d@%s#%d", m_iVirtualNodeNum - i, strNodeIdentify.c_str(), i);
-            CryptoPP::Weak1::MD5 oMd5;
-            CryptoPP::HexEncoder oHexEncoder;
-            oMd5.Update((const CryptoPP::byte*)szVirtualNodeIdentify, strlen(szVirtualNodeIdentify));
-            strHash.resize(oMd5.DigestSize());
-            oMd5.Final((CryptoPP::byte*)&strHash[0]);
-            for (int j = 0; j < iPointPerHash; ++j)
-            {
-                uint32 k = ((uint32)(strHash[3 + j * iPointPerHash] & 0xFF) << 24)
-                       | ((uint32)(strHash[2 + j * iPointPerHash] & 0xFF) << 16)
-                       | ((uint32)(strHash[1 + j * iPointPerHash] & 0xFF) << 8)
-                       | (strHash[j * iPointPerHash] & 0xFF);
-                vecHash.push_back(k);
-                pNode->mapHash2Node.insert(std::make_pair(k, strNodeIdentify));
-            }
+            MakeKetamaHash(strNodeIdentify, vecHash);
         }
-        pNode->mapNode2Hash.insert(std::make_pair(strNodeIdentify, std::move(vecHash)));
-        pNode->itPollingNode = pNode->mapNode2Hash.begin();
-        pNode->itHashRing = pNode->mapHash2Node.begin();
-    }
-    else
-    {
-        auto node_iter = node_type_iter->second->mapNode2Hash.find(strNodeIdentify);
-        if (node_iter == node_type_iter->second->mapNode2Hash.end())
+        else
         {
-            std::string strHash;
-            char szVirtualNodeIdentify[40] = {0};
-            int32 iPointPerHash = 4;
-            std::vector<uint32> vecHash;
-            for (int i = 0; i < m_iVirtualNodeNum / iPointPerHash; ++i)     // distribution: ketama
-            {
-                snprintf(szVirtualNodeIdentify, 40, "%d@%s#%d", m_iVirtualNodeNum - i, strNodeIdentify.c_str(), i);
-                CryptoPP::Weak1::MD5 oMd5;
-                CryptoPP::HexEncoder oHexEncoder;
-                oMd5.Update((const CryptoPP::byte*)szVirtualNodeIdentify, strlen(szVirtualNodeIdentify));
-                strHash.resize(oMd5.DigestSize());
-                oMd5.Final((CryptoPP::byte*)&strHash[0]);
-                for (int j = 0; j < iPointPerHash; ++j)
-                {
-                    uint32 k = ((uint32)(strHash[3 + j * iPointPerHash] & 0xFF) << 24)
-                           | ((uint32)(strHash[2 + j * iPointPerHash] & 0xFF) << 16)
-                           | ((uint32)(strHash[1 + j * iPointPerHash] & 0xFF) << 8)
-                           | (strHash[j * iPointPerHash] & 0xFF);
-                    vecHash.push_back(k);
-                    node_type_iter->second->mapHash2Node.insert(std::make_pair(k, strNodeIdentify));
-                }
-            }
-            node_type_iter->second->mapNode2Hash.insert(std::make_pair(strNodeIdentify, std::move(vecHash)));
-            node_type_iter->second->itPollingNode = node_type_iter->second->mapNode2Hash.begin();
-            node_type_iter->second->itHashRing = node_type_iter->second->mapHash2Node.begin();
+            MakeVirtualNodeHash(strNodeIdentify, vecHash);
         }
+        stNode.mapNode2Hash.insert(std::make_pair(strNodeIdentify, std::move(vecHash)));
+        Rebuild(stNode);
     }
     auto node_id_iter = m_mapNodeType.find(strNodeIdentify);
     if (node_id_iter == m_mapNodeType.end())
@@ -366,18 +272,8 @@ void Nodes::DelNode(const std::string& strNodeType, const std::string& strNodeId
         auto node_iter = node_type_iter->second->mapNode2Hash.find(strNodeIdentify);
         if (node_iter != node_type_iter->second->mapNode2Hash.end())
         {
-            for (std::vector<uint32>::iterator hash_iter = node_iter->second.begin();
-                            hash_iter != node_iter->second.end(); ++hash_iter)
-            {
-                auto it = node_type_iter->second->mapHash2Node.find(*hash_iter);
-                if (it != node_type_iter->second->mapHash2Node.end())
-                {
-                    node_type_iter->second->mapHash2Node.erase(it);
-                }
-            }
             node_type_iter->second->mapNode2Hash.erase(node_iter);
-            node_type_iter->second->itPollingNode = node_type_iter->second->mapNode2Hash.begin();
-            node_type_iter->second->itHashRing = node_type_iter->second->mapHash2Node.begin();
+            Rebuild(*(node_type_iter->second));
         }
 
         if (node_type_iter->second->setFailedNode.size() > 0)
@@ -418,18 +314,8 @@ void Nodes::NodeFailed(const std::string& strNodeIdentify)
                 auto node_iter = node_type_iter->second->mapNode2Hash.find(strNodeIdentify);
                 if (node_iter != node_type_iter->second->mapNode2Hash.end())
                 {
-                    for (auto hash_iter = node_iter->second.begin();
-                            hash_iter != node_iter->second.end(); ++hash_iter)
-                    {
-                        auto it = node_type_iter->second->mapHash2Node.find(*hash_iter);
-                        if (it != node_type_iter->second->mapHash2Node.end())
-                        {
-                            node_type_iter->second->mapHash2Node.erase(it);
-                        }
-                    }
                     node_type_iter->second->mapNode2Hash.erase(node_iter);
-                    node_type_iter->second->itPollingNode = node_type_iter->second->mapNode2Hash.begin();
-                    node_type_iter->second->itHashRing = node_type_iter->second->mapHash2Node.begin();
+                    Rebuild(*(node_type_iter->second));
                 }
                 node_type_iter->second->setFailedNode.insert(strNodeIdentify);
             }
@@ -487,7 +373,222 @@ void Nodes::CheckFailedNode()
     }
 }
 
-uint32 Nodes::hash_fnv1_64(const char *key, size_t key_length)
+uint32 Nodes::PollNode(tagNode& stNode, const std::string*& pFailedNode)
+{
+    if (stNode.bCheckFailedNode)
+    {
+        stNode.bCheckFailedNode = false;
+        if (stNode.setFailedNode.size() > 0)
+        {
+            pFailedNode = &(*(stNode.setFailedNode.begin()));
+            return(0);
+        }
+    }
+    if (stNode.vecNodeIdentify.empty())
+    {
+        return(0xFFFFFFFF);
+    }
+    ++stNode.uiPollingPos;
+    if (stNode.uiPollingPos >= stNode.vecNodeIdentify.size())
+    {
+        stNode.uiPollingPos = 0;
+    }
+    return(stNode.uiPollingPos);
+}
+
+uint32 Nodes::HashKey(const char* szKey, size_t uiKeyLen) const
+{
+    switch (m_iHashAlgorithm)
+    {
+        case HASH_cityhash_32:
+            return(CityHash32(szKey, uiKeyLen));
+        case HASH_fnv1_64:
+            return(hash_fnv1_64(szKey, uiKeyLen));
+        case HASH_murmur3_32:
+            return(murmur3_32(szKey, uiKeyLen, 0x000001b3));
+        default:
+            return(hash_fnv1a_64(szKey, uiKeyLen));
+    }
+}
+
+void Nodes::MakeVirtualNodeHash(const std::string& strNodeIdentify, std::vector<uint32>& vecHash) const
+{
+    char szVirtualNodeIdentify[40] = {0};
+    vecHash.reserve(m_iVirtualNodeNum);
+    for (int i = 0; i < m_iVirtualNodeNum; ++i)
+    {
+        int iLen = snprintf(szVirtualNodeIdentify, 40, "%d@%s#%d", m_iVirtualNodeNum - i, strNodeIdentify.c_str(), i);
+        vecHash.push_back(HashKey(szVirtualNodeIdentify, (iLen < 40) ? iLen : 39));
+    }
+}
+
+void Nodes::MakeKetamaHash(const std::string& strNodeIdentify, std::vector<uint32>& vecHash) const
+{
+    std::string strHash;
+    char szVirtualNodeIdentify[40] = {0};
+    int32 iPointPerHash = 4;
+    for (int i = 0; i < m_iVirtualNodeNum / iPointPerHash; ++i)     // distribution: ketama
+    {
+        snprintf(szVirtualNodeIdentify, 40, "%d@%s#%d", m_iVirtualNodeNum - i, strNodeIdentify.c_str(), i);
+        CryptoPP::Weak1::MD5 oMd5;
+        oMd5.Update((const CryptoPP::byte*)szVirtualNodeIdentify, strlen(szVirtualNodeIdentify));
+        strHash.resize(oMd5.DigestSize());
+        oMd5.Final((CryptoPP::byte*)&strHash[0]);
+        for (int j = 0; j < iPointPerHash; ++j)
+        {
+            uint32 k = ((uint32)(strHash[3 + j * iPointPerHash] & 0xFF) << 24)
+                   | ((uint32)(strHash[2 + j * iPointPerHash] & 0xFF) << 16)
+                   | ((uint32)(strHash[1 + j * iPointPerHash] & 0xFF) << 8)
+                   | (strHash[j * iPointPerHash] & 0xFF);
+            vecHash.push_back(k);
+        }
+    }
+}
+
+void Nodes::Rebuild(tagNode& stNode)
+{
+    // 节点下标按节点标识的字典序分配，各进程对同一组节点得到相同的映射，与添加顺序无关
+    std::vector<T_NODE2HASH_MAP::const_iterator> vecNodeIter;
+    vecNodeIter.reserve(stNode.mapNode2Hash.size());
+    for (auto iter = stNode.mapNode2Hash.cbegin(); iter != stNode.mapNode2Hash.cend(); ++iter)
+    {
+        vecNodeIter.push_back(iter);
+    }
+    std::sort(vecNodeIter.begin(), vecNodeIter.end(),
+            [](const T_NODE2HASH_MAP::const_iterator& a, const T_NODE2HASH_MAP::const_iterator& b)->bool
+            {
+                return(a->first < b->first);
+            });
+    stNode.vecNodeIdentify.clear();
+    stNode.vecNodeIdentify.reserve(vecNodeIter.size());
+    stNode.vecNodeEndpoint.clear();
+
+    std::vector<std::pair<uint32, uint32>> vecRing;     // (hash, 节点下标)
+    for (uint32 i = 0; i < vecNodeIter.size(); ++i)
+    {
+        stNode.vecNodeIdentify.push_back(&(vecNodeIter[i]->first));
+        if (nullptr != m_pEndpoints)
+        {
+            stNode.vecNodeEndpoint.push_back(m_pEndpoints->Intern(vecNodeIter[i]->first));
+        }
+        const std::vector<uint32>& vecHash = vecNodeIter[i]->second;
+        for (auto hash_iter = vecHash.begin(); hash_iter != vecHash.end(); ++hash_iter)
+        {
+            vecRing.push_back(std::make_pair(*hash_iter, i));
+        }
+    }
+    std::sort(vecRing.begin(), vecRing.end());
+    stNode.vecRingHash.clear();
+    stNode.vecRingNode.clear();
+    stNode.vecRingHash.reserve(vecRing.size());
+    stNode.vecRingNode.reserve(vecRing.size());
+    for (size_t i = 0; i < vecRing.size(); ++i)
+    {
+        if (i > 0 && vecRing[i].first == vecRing[i - 1].first)
+        {
+            continue;   // hash冲突的虚拟节点只保留一个
+        }
+        stNode.vecRingHash.push_back(vecRing[i].first);
+        stNode.vecRingNode.push_back(vecRing[i].second);
+    }
+    stNode.uiHashRingPos = 0;
+    stNode.uiPollingPos = 0;
+
+    if (DISTRIBUTION_MAGLEV == m_iDistribution)
+    {
+        BuildMaglevTable(stNode);
+    }
+}
+
+void Nodes::BuildMaglevTable(tagNode& stNode)
+{
+    const uint32 uiEmpty = (uint32)-1;
+    uint32 uiNodeNum = stNode.vecNodeIdentify.size();
+    stNode.vecMaglevTable.assign(s_uiMaglevTableSize, uiEmpty);
+    if (0 == uiNodeNum)
+    {
+        stNode.vecMaglevTable.clear();
+        return;
+    }
+    std::vector<uint64> vecOffset(uiNodeNum);
+    std::vector<uint64> vecSkip(uiNodeNum);
+    std::vector<uint64> vecNext(uiNodeNum, 0);
+    for (uint32 i = 0; i < uiNodeNum; ++i)
+    {
+        const std::string& strIdentify = *(stNode.vecNodeIdentify[i]);
+        vecOffset[i] = murmur3_32(strIdentify.c_str(), strIdentify.size(), 0x5bd1e995) % s_uiMaglevTableSize;
+        vecSkip[i] = murmur3_32(strIdentify.c_str(), strIdentify.size(), 0x1b873593) % (s_uiMaglevTableSize - 1) + 1;
+    }
+    uint32 uiFilled = 0;
+    while (true)
+    {
+        for (uint32 i = 0; i < uiNodeNum; ++i)
+        {
+            uint64 ullSlot = (vecOffset[i] + vecNext[i] * vecSkip[i]) % s_uiMaglevTableSize;
+            while (uiEmpty != stNode.vecMaglevTable[ullSlot])
+            {
+                ++vecNext[i];
+                ullSlot = (vecOffset[i] + vecNext[i] * vecSkip[i]) % s_uiMaglevTableSize;
+            }
+            stNode.vecMaglevTable[ullSlot] = i;
+            ++vecNext[i];
+            if (++uiFilled == s_uiMaglevTableSize)
+            {
+                return;
+            }
+        }
+    }
+}
+
+uint32 Nodes::Locate(tagNode& stNode, uint32 uiHash)
+{
+    switch (m_iDistribution)
+    {
+        case DISTRIBUTION_MAGLEV:
+            return(stNode.vecMaglevTable[uiHash % s_uiMaglevTableSize]);
+        case DISTRIBUTION_JUMP:
+            return(JumpConsistentHash(uiHash, stNode.vecNodeIdentify.size()));
+        default:
+            break;
+    }
+    // 无分支二分查找第一个不小于uiHash的虚拟节点，超出环尾则回到环首
+    const uint32* pRing = stNode.vecRingHash.data();
+    const uint32* pBase = pRing;
+    size_t uiLen = stNode.vecRingHash.size();
+    while (uiLen > 1)
+    {
+        size_t uiHalf = uiLen / 2;
+        pBase = (pBase[uiHalf - 1] < uiHash) ? pBase + uiHalf : pBase;
+        uiLen -= uiHalf;
+    }
+    size_t uiPos = (pBase - pRing) + (*pBase < uiHash);
+    if (uiPos >= stNode.vecRingHash.size())
+    {
+        uiPos = 0;
+    }
+    stNode.uiHashRingPos = uiPos;
+    return(stNode.vecRingNode[uiPos]);
+}
+
+uint32 Nodes::JumpConsistentHash(uint64 ullKey, uint32 uiBucketNum)
+{
+    // 32位hash值先经splitmix64扩散到64位（jump consistent hash依赖key的高位）
+    ullKey += 0x9e3779b97f4a7c15ULL;
+    ullKey = (ullKey ^ (ullKey >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    ullKey = (ullKey ^ (ullKey >> 27)) * 0x94d049bb133111ebULL;
+    ullKey = ullKey ^ (ullKey >> 31);
+    int64 llBucket = -1;
+    int64 llJump = 0;
+    while (llJump < (int64)uiBucketNum)
+    {
+        llBucket = llJump;
+        ullKey = ullKey * 2862933555777941757ULL + 1;
+        llJump = (int64)((llBucket + 1) * (double(1LL << 31) / double((ullKey >> 33) + 1)));
+    }
+    return((uint32)llBucket);
+}
+
+uint32 Nodes::hash_fnv1_64(const char *key, size_t key_length) const
 {
     uint64_t hash = FNV_64_INIT;
     size_t x;
@@ -500,7 +601,7 @@ uint32 Nodes::hash_fnv1_64(const char *key, size_t key_length)
     return (uint32_t)hash;
 }
 
-uint32 Nodes::hash_fnv1a_64(const char *key, size_t key_length)
+uint32 Nodes::hash_fnv1a_64(const char *key, size_t key_length) const
 {
     uint32_t hash = (uint32_t) FNV_64_INIT;
     size_t x;
@@ -514,7 +615,7 @@ uint32 Nodes::hash_fnv1a_64(const char *key, size_t key_length)
     return hash;
 }
 
-uint32_t Nodes::murmur3_32(const char *key, uint32_t len, uint32_t seed)
+uint32_t Nodes::murmur3_32(const char *key, uint32_t len, uint32_t seed) const
 {
     static const uint32_t c1 = 0xcc9e2d51;
     static const uint32_t c2 = 0x1b873593;
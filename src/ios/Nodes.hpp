@@ -11,9 +11,9 @@
 #ifndef SRC_IOS_NODES_HPP_
 #define SRC_IOS_NODES_HPP_
 
+#include <string>
 #include <memory>
 #include <vector>
-#include <map>
 #include <unordered_map>
 #include <unordered_set>
 #include "Definition.hpp"
@@ -23,6 +23,8 @@
 namespace neb
 {
 
+class Endpoints;
+
 const unsigned long FNV_64_INIT = 0x100000001b3;
 const unsigned long FNV_64_PRIME = 0xcbf29ce484222325;
 
@@ -34,6 +36,17 @@ enum E_HASH_ALGORITHM
     HASH_cityhash_32        = 3,
 };
 
+/**
+ * @brief hash值到节点的映射方式
+ */
+enum E_NODE_DISTRIBUTION
+{
+    DISTRIBUTION_HASH_RING  = 0,    ///< 一致性hash环（每个节点iVirtualNodeNum个虚拟节点）
+    DISTRIBUTION_MAGLEV     = 1,    ///< Maglev查找表，O(1)查找，节点间负载最均衡
+    DISTRIBUTION_JUMP       = 2,    ///< jump consistent hash，无额外内存；按节点标识排序编号，
+                                    ///< 增删字典序最大的节点时迁移最少，其他位置的增删迁移较多
+};
+
 /**
  * @brief 节点管理
  */
@@ -44,8 +57,11 @@ public:
      * @note 节点管理Session构造函数
      * @param iHashAlgorithm hash算法
      * @param iVirtualNodeNum 每个实体节点对应的虚拟节点数量
+     * @param iDistribution hash值到节点的映射方式（E_NODE_DISTRIBUTION）
+     * @param pEndpoints 节点登记表，为nullptr时不提供按句柄获取节点
      */
-    Nodes(int iHashAlgorithm = HASH_murmur3_32, int iVirtualNodeNum = 200);
+    Nodes(int iHashAlgorithm = HASH_murmur3_32, int iVirtualNodeNum = 200, int iDistribution = DISTRIBUTION_HASH_RING,
+            Endpoints* pEndpoints = nullptr);
     virtual ~Nodes();
 
     /* 实体节点hash信息
@@ -53,14 +69,24 @@ public:
      * value为hash(Property001#0) hash(Property001#1) hash(Property001#2) 组成的vector */
     typedef std::unordered_map<std::string, std::vector<uint32> > T_NODE2HASH_MAP;
 
+    /**
+     * @brief 同类型节点
+     * @note 节点增删时重建查找结构：vecNodeIdentify按字典序存放指向mapNode2Hash中节点标识
+     * 的指针，其下标即节点序号；一致性hash环以两个平行的有序数组存放，查找时在连续内存上做
+     * 无分支二分查找。
+     */
     struct tagNode
     {
         bool bCheckFailedNode = false;
         std::string strNodeType;
         T_NODE2HASH_MAP mapNode2Hash;
-        T_NODE2HASH_MAP::iterator itPollingNode;
-        std::map<uint32, std::string> mapHash2Node;
-        std::map<uint32, std::string>::const_iterator itHashRing;
+        std::vector<const std::string*> vecNodeIdentify;   ///< 节点标识（字典序）
+        std::vector<uint32> vecNodeEndpoint;        ///< 与vecNodeIdentify一一对应的节点句柄（见Endpoints）
+        std::vector<uint32> vecRingHash;            ///< hash环上的虚拟节点hash值（升序）
+        std::vector<uint32> vecRingNode;            ///< 与vecRingHash一一对应的节点下标
+        std::vector<uint32> vecMaglevTable;         ///< Maglev查找表（仅DISTRIBUTION_MAGLEV）
+        uint32 uiHashRingPos = 0;                   ///< 最近一次hash环查找的位置
+        uint32 uiPollingPos = 0;                    ///< 轮询位置（vecNodeIdentify下标）
         std::unordered_set<std::string> setFailedNode;
 
         tagNode(){}
@@ -82,6 +108,29 @@ public:
 
     bool GetNode(const std::string& strNodeType, uint32 uiHash, std::string& strNodeIdentify);
 
+    /**
+     * @brief 获取节点信息（不复制节点标识）
+     * @param[out] pNodeIdentify 节点标识，指向Nodes内部存储，在该节点被删除、失败或恢复之前
+     * 有效（其他节点的增删不影响）
+     */
+    bool GetNode(const std::string& strNodeType, const std::string& strHashKey, const std::string*& pNodeIdentify);
+
+    bool GetNode(const std::string& strNodeType, uint32 uiHash, const std::string*& pNodeIdentify);
+
+    /**
+     * @brief 获取节点句柄
+     * @note 仅在构造时传入了节点登记表时可用
+     * @param[out] uiEndpoint 节点句柄（见Endpoints）
+     */
+    bool GetNode(const std::string& strNodeType, const std::string& strHashKey, uint32& uiEndpoint);
+
+    bool GetNode(const std::string& strNodeType, uint32 uiHash, uint32& uiEndpoint);
+
+    /**
+     * @brief 轮询获取节点句柄
+     */
+    bool GetNode(const std::string& strNodeType, uint32& uiEndpoint);
+
     bool GetNodeInHashRing(const std::string& strNodeType, std::string& strNodeIdentify);
 
     bool GetNode(const std::string& strNodeType, std::string& strNodeIdentify);
@@ -134,13 +183,31 @@ public:
     void CheckFailedNode();
 
 protected:
-    uint32 hash_fnv1_64(const char *key, size_t key_length);
-    uint32 hash_fnv1a_64(const char *key, size_t key_length);
-    uint32_t murmur3_32(const char *key, uint32_t len, uint32_t seed);
+    uint32 HashKey(const char* szKey, size_t uiKeyLen) const;
+    void MakeVirtualNodeHash(const std::string& strNodeIdentify, std::vector<uint32>& vecHash) const;
+    void MakeKetamaHash(const std::string& strNodeIdentify, std::vector<uint32>& vecHash) const;
+    void AddNode(const std::string& strNodeType, const std::string& strNodeIdentify, bool bKetama);
+    /**
+     * @brief 轮询下一个节点
+     * @return 节点下标，返回0xFFFFFFFF表示无可用节点；存在待探测的失败节点时通过pFailedNode返回
+     */
+    uint32 PollNode(tagNode& stNode, const std::string*& pFailedNode);
+    void Rebuild(tagNode& stNode);
+    void BuildMaglevTable(tagNode& stNode);
+    uint32 Locate(tagNode& stNode, uint32 uiHash);
+    static uint32 JumpConsistentHash(uint64 ullKey, uint32 uiBucketNum);
+
+    uint32 hash_fnv1_64(const char *key, size_t key_length) const;
+    uint32 hash_fnv1a_64(const char *key, size_t key_length) const;
+    uint32_t murmur3_32(const char *key, uint32_t len, uint32_t seed) const;
 
 private:
+    static const uint32 s_uiMaglevTableSize = 65537;   ///< Maglev查找表大小（质数，远大于节点数）
+
     const int m_iHashAlgorithm;
     const int m_iVirtualNodeNum;
+    const int m_iDistribution;
+    Endpoints* m_pEndpoints;
 
     std::unordered_map<std::string, std::shared_ptr<tagNode> > m_mapNode;
     std::unordered_map<std::string, std::unordered_set<std::string>> m_mapNodeType;  // key为节点标识
@@ -0,0 +1,512 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     RedisNearCache.cpp
+ * @brief    redis读请求的进程内近端缓存
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note
+ * Modify history:
+ ******************************************************************************/
+#include <cctype>
+#include <cstring>
+#include <algorithm>
+#include <unordered_set>
+#include "RedisNearCache.hpp"
+#include "codec/RespCmd.hpp"
+#include "codec/RespView.hpp"
+
+namespace neb
+{
+
+const ev_tstamp RedisNearCache::sc_dReconnectInterval = 1.0;
+const ev_tstamp RedisNearCache::sc_dUnsupportedInterval = 60.0;
+
+/**
+ * @brief 每条缓存除key和响应外的固定开销（链表节点、两个索引的哈希节点等）估算
+ */
+static const size_t sc_uiEntryOverhead = 128;
+
+RedisNearCache::RedisNearCache()
+    : m_ullMaxMemory(0), m_ullMemory(0), m_uiFillId(0)
+{
+}
+
+RedisNearCache::~RedisNearCache()
+{
+}
+
+void RedisNearCache::SetMaxMemory(uint64 ullMaxMemory)
+{
+    m_ullMaxMemory = ullMaxMemory;
+    if (0 == m_ullMaxMemory)
+    {
+        m_mapEntry.clear();
+        m_mapIndex.clear();
+        m_listEntry.clear();
+        m_mapPending.clear();
+        m_mapPendingIndex.clear();
+        m_ullMemory = 0;
+        return;
+    }
+    Evict();
+}
+
+bool RedisNearCache::IsCacheable(const RespCmd& oRespCmd) const
+{
+    // 只缓存以第一个参数为唯一key的读命令，失效通知按key删除缓存
+    static const std::unordered_set<std::string> s_setCacheableCmd = {
+        "GET", "GETRANGE", "STRLEN",
+        "HGET", "HGETALL", "HMGET", "HEXISTS", "HKEYS", "HVALS", "HLEN", "HSTRLEN",
+        "LRANGE", "LLEN", "LINDEX",
+        "SMEMBERS", "SISMEMBER", "SMISMEMBER", "SCARD",
+        "ZRANGE", "ZRANGEBYSCORE", "ZREVRANGE", "ZREVRANGEBYSCORE", "ZSCORE", "ZMSCORE",
+        "ZCARD", "ZCOUNT", "ZRANK", "ZREVRANK",
+        "EXISTS"
+    };
+    if (oRespCmd.GetArgNum() < 2)
+    {
+        return(false);
+    }
+    const RespCmd::tagArg& stCmd = oRespCmd.GetArg(0);
+    char szCmd[24];
+    if (nullptr == stCmd.pData || stCmd.uiLength >= sizeof(szCmd))
+    {
+        return(false);
+    }
+    for (size_t i = 0; i < stCmd.uiLength; ++i)
+    {
+        szCmd[i] = toupper(stCmd.pData[i]);
+    }
+    szCmd[stCmd.uiLength] = '\0';
+    if (s_setCacheableCmd.find(szCmd) == s_setCacheableCmd.end())
+    {
+        return(false);
+    }
+    if (0 == strcmp(szCmd, "EXISTS") && oRespCmd.GetArgNum() != 2)
+    {
+        return(false);
+    }
+    if (m_vecPrefix.empty())
+    {
+        return(true);
+    }
+    const RespCmd::tagArg& stKey = oRespCmd.GetArg(1);
+    if (nullptr == stKey.pData)
+    {
+        return(false);
+    }
+    for (auto& strPrefix : m_vecPrefix)
+    {
+        if (stKey.uiLength >= strPrefix.size() && 0 == memcmp(stKey.pData, strPrefix.data(), strPrefix.size()))
+        {
+            return(true);
+        }
+    }
+    return(false);
+}
+
+void RedisNearCache::SetNamespaceNodes(const std::string& strNamespace, const std::vector<std::string>& vecNode)
+{
+    std::vector<std::string> vecSortedNode = vecNode;
+    std::sort(vecSortedNode.begin(), vecSortedNode.end());
+    vecSortedNode.erase(std::unique(vecSortedNode.begin(), vecSortedNode.end()), vecSortedNode.end());
+    auto& stNamespace = m_mapNamespace[strNamespace];
+    if (stNamespace.vecNode == vecSortedNode)
+    {
+        return;
+    }
+    Flush(strNamespace);
+    for (auto& strNode : stNamespace.vecNode)
+    {
+        auto iter = m_mapNode.find(strNode);
+        if (iter != m_mapNode.end())
+        {
+            auto& vecNamespace = iter->second.vecNamespace;
+            vecNamespace.erase(std::remove(vecNamespace.begin(), vecNamespace.end(), strNamespace), vecNamespace.end());
+        }
+    }
+    stNamespace.vecNode.swap(vecSortedNode);
+    stNamespace.uiActiveNode = 0;
+    for (auto& strNode : stNamespace.vecNode)
+    {
+        auto& stNode = m_mapNode[strNode];
+        stNode.vecNamespace.push_back(strNamespace);
+        if (TRACKING_ACTIVE == stNode.eStatus)
+        {
+            ++stNamespace.uiActiveNode;
+        }
+    }
+}
+
+bool RedisNearCache::IsReady(const std::string& strNamespace) const
+{
+    auto iter = m_mapNamespace.find(strNamespace);
+    if (iter == m_mapNamespace.end())
+    {
+        return(false);
+    }
+    return(!iter->second.vecNode.empty() && iter->second.uiActiveNode == iter->second.vecNode.size());
+}
+
+void RedisNearCache::GetUntrackedNodes(const std::string& strNamespace, ev_tstamp dNow, std::vector<std::string>& vecNode) const
+{
+    auto iter = m_mapNamespace.find(strNamespace);
+    if (iter == m_mapNamespace.end())
+    {
+        return;
+    }
+    for (auto& strNode : iter->second.vecNode)
+    {
+        auto node_iter = m_mapNode.find(strNode);
+        if (node_iter != m_mapNode.end() && TRACKING_NONE == node_iter->second.eStatus
+                && dNow >= node_iter->second.dRetryTime)
+        {
+            vecNode.push_back(strNode);
+        }
+    }
+}
+
+void RedisNearCache::AddTrackingChannel(const std::string& strNode, std::shared_ptr<SocketChannel> pChannel, uint32 uiExpectReply)
+{
+    auto& stNode = m_mapNode[strNode];
+    auto pOldChannel = stNode.pChannel.lock();
+    if (pOldChannel != nullptr)
+    {
+        m_mapTrackingChannel.erase(pOldChannel.get());
+    }
+    stNode.pChannel = pChannel;
+    stNode.uiExpectReply = uiExpectReply;
+    m_mapTrackingChannel[pChannel.get()] = strNode;
+    SetNodeStatus(stNode, TRACKING_CONNECTING);
+}
+
+bool RedisNearCache::OnTrackingMessage(const SocketChannel* pChannel, const RespView& oRespView, ev_tstamp dNow)
+{
+    auto channel_iter = m_mapTrackingChannel.find(pChannel);
+    if (channel_iter == m_mapTrackingChannel.end())
+    {
+        return(false);
+    }
+    auto node_iter = m_mapNode.find(channel_iter->second);
+    if (node_iter == m_mapNode.end())
+    {
+        return(false);
+    }
+    tagNode& stNode = node_iter->second;
+    if (RespView::RESP_TYPE_PUSH == oRespView.Type())
+    {
+        // >2\r\n$10\r\ninvalidate\r\n*<n>\r\n$<len>\r\n<key>... 或 >2\r\n$10\r\ninvalidate\r\n_\r\n（FLUSHALL等）
+        RespView oElement;
+        RespView::Iterator oIter = oRespView.Begin();
+        if (!oIter.Next(oElement) || !oElement.Equals("invalidate") || !oIter.Next(oElement))
+        {
+            return(true);
+        }
+        if (oElement.IsNull())
+        {
+            for (auto& strNamespace : stNode.vecNamespace)
+            {
+                Flush(strNamespace);
+            }
+            return(true);
+        }
+        RespView oKey;
+        RespView::Iterator oKeyIter = oElement.Begin();
+        while (oKeyIter.Next(oKey))
+        {
+            Invalidate(stNode, oKey.Data(), oKey.Size());
+        }
+        return(true);
+    }
+    if (TRACKING_CONNECTING != stNode.eStatus)
+    {
+        return(true);       // 保活PING的响应
+    }
+    if (oRespView.IsError())
+    {
+        // redis 6以下不支持HELLO 3和CLIENT TRACKING，较长时间后再重试
+        stNode.dRetryTime = dNow + sc_dUnsupportedInterval;
+        return(false);
+    }
+    if (stNode.uiExpectReply > 0)
+    {
+        --stNode.uiExpectReply;
+    }
+    if (0 == stNode.uiExpectReply)
+    {
+        SetNodeStatus(stNode, TRACKING_ACTIVE);
+    }
+    return(true);
+}
+
+void RedisNearCache::OnTrackingClosed(const SocketChannel* pChannel, ev_tstamp dNow)
+{
+    auto channel_iter = m_mapTrackingChannel.find(pChannel);
+    if (channel_iter == m_mapTrackingChannel.end())
+    {
+        return;
+    }
+    auto node_iter = m_mapNode.find(channel_iter->second);
+    m_mapTrackingChannel.erase(channel_iter);
+    if (node_iter == m_mapNode.end())
+    {
+        return;
+    }
+    tagNode& stNode = node_iter->second;
+    stNode.pChannel.reset();
+    stNode.uiExpectReply = 0;
+    stNode.dRetryTime = std::max(stNode.dRetryTime, dNow + sc_dReconnectInterval);
+    SetNodeStatus(stNode, TRACKING_NONE);
+}
+
+void RedisNearCache::GetTrackingChannels(std::vector<std::shared_ptr<SocketChannel> >& vecChannel) const
+{
+    for (auto& node : m_mapNode)
+    {
+        if (TRACKING_ACTIVE != node.second.eStatus)
+        {
+            continue;
+        }
+        auto pChannel = node.second.pChannel.lock();
+        if (pChannel != nullptr)
+        {
+            vecChannel.push_back(pChannel);
+        }
+    }
+}
+
+const RedisReply* RedisNearCache::Lookup(const std::string& strNamespace, const RespCmd& oRespCmd, uint32& uiFillId)
+{
+    MakeKey(strNamespace, oRespCmd);
+    auto iter = m_mapEntry.find(m_strCacheKey);
+    if (iter != m_mapEntry.end())
+    {
+        ++m_stStat.ullHit;
+        m_listEntry.splice(m_listEntry.begin(), m_listEntry, iter->second);
+        return(&iter->second->oReply);
+    }
+    ++m_stStat.ullMiss;
+    if (0 == ++m_uiFillId)
+    {
+        ++m_uiFillId;
+    }
+    uiFillId = m_uiFillId;
+    auto& stPending = m_mapPending[uiFillId];
+    stPending.strCacheKey = m_strCacheKey;
+    stPending.strIndexKey = m_strIndexKey;
+    m_mapPendingIndex.insert(std::make_pair(m_strIndexKey, uiFillId));
+    return(nullptr);
+}
+
+void RedisNearCache::Fill(uint32 uiFillId, const RedisReply& oRedisReply)
+{
+    auto pending_iter = m_mapPending.find(uiFillId);
+    if (pending_iter == m_mapPending.end())
+    {
+        return;     // 已失效
+    }
+    tagPending stPending;
+    stPending.strCacheKey.swap(pending_iter->second.strCacheKey);
+    stPending.strIndexKey.swap(pending_iter->second.strIndexKey);
+    Cancel(uiFillId);
+    if (0 == m_ullMaxMemory || REDIS_REPLY_ERROR == oRedisReply.type())
+    {
+        return;
+    }
+    size_t uiMemory = sc_uiEntryOverhead + stPending.strCacheKey.size() + stPending.strIndexKey.size()
+        + oRedisReply.ByteSizeLong();
+    if (uiMemory > m_ullMaxMemory / 16)
+    {
+        return;     // 过大的响应不缓存，以免一条响应淘汰大量缓存
+    }
+    auto entry_iter = m_mapEntry.find(stPending.strCacheKey);
+    if (entry_iter != m_mapEntry.end())
+    {
+        Erase(entry_iter->second);
+    }
+    m_listEntry.emplace_front();
+    auto iter = m_listEntry.begin();
+    iter->strCacheKey.swap(stPending.strCacheKey);
+    iter->strIndexKey.swap(stPending.strIndexKey);
+    iter->oReply = oRedisReply;
+    iter->uiMemory = uiMemory;
+    m_mapEntry.insert(std::make_pair(iter->strCacheKey, iter));
+    m_mapIndex[iter->strIndexKey].push_back(iter);
+    m_ullMemory += uiMemory;
+    Evict();
+}
+
+void RedisNearCache::Cancel(uint32 uiFillId)
+{
+    auto pending_iter = m_mapPending.find(uiFillId);
+    if (pending_iter == m_mapPending.end())
+    {
+        return;
+    }
+    auto range = m_mapPendingIndex.equal_range(pending_iter->second.strIndexKey);
+    for (auto iter = range.first; iter != range.second; ++iter)
+    {
+        if (iter->second == uiFillId)
+        {
+            m_mapPendingIndex.erase(iter);
+            break;
+        }
+    }
+    m_mapPending.erase(pending_iter);
+}
+
+void RedisNearCache::MakeKey(const std::string& strNamespace, const RespCmd& oRespCmd)
+{
+    // 命名空间\0<命令大写><参数长度>:<参数>...，参数以长度分隔，任意二进制参数都不会混淆
+    m_strIndexKey.assign(strNamespace);
+    m_strIndexKey.push_back('\0');
+    m_strCacheKey.assign(m_strIndexKey);
+    const RespCmd::tagArg& stCmd = oRespCmd.GetArg(0);
+    for (size_t i = 0; i < stCmd.uiLength; ++i)
+    {
+        m_strCacheKey.push_back(toupper(stCmd.pData[i]));
+    }
+    for (uint32 i = 1; i < oRespCmd.GetArgNum(); ++i)
+    {
+        const RespCmd::tagArg& stArg = oRespCmd.GetArg(i);
+        m_strCacheKey.append(std::to_string(stArg.uiLength));
+        m_strCacheKey.push_back(':');
+        if (nullptr != stArg.pData)
+        {
+            m_strCacheKey.append(stArg.pData, stArg.uiLength);
+            if (1 == i)
+            {
+                m_strIndexKey.append(stArg.pData, stArg.uiLength);
+            }
+        }
+        else
+        {
+            std::string strArg = oRespCmd.GetArgString(i);
+            m_strCacheKey.append(strArg);
+            if (1 == i)
+            {
+                m_strIndexKey.append(strArg);
+            }
+        }
+    }
+}
+
+void RedisNearCache::Invalidate(const tagNode& stNode, const char* pKey, size_t uiKeyLen)
+{
+    for (auto& strNamespace : stNode.vecNamespace)
+    {
+        m_strIndexKey.assign(strNamespace);
+        m_strIndexKey.push_back('\0');
+        m_strIndexKey.append(pKey, uiKeyLen);
+        auto iter = m_mapIndex.find(m_strIndexKey);
+        while (iter != m_mapIndex.end())
+        {
+            ++m_stStat.ullInvalidate;
+            Erase(iter->second.back());     // 最后一条删除后索引被删除
+            iter = m_mapIndex.find(m_strIndexKey);
+        }
+        ErasePending(m_strIndexKey);
+    }
+}
+
+void RedisNearCache::SetNodeStatus(tagNode& stNode, E_TRACKING_STATUS eStatus)
+{
+    bool bWasActive = (TRACKING_ACTIVE == stNode.eStatus);
+    bool bActive = (TRACKING_ACTIVE == eStatus);
+    stNode.eStatus = eStatus;
+    if (bWasActive == bActive)
+    {
+        return;
+    }
+    for (auto& strNamespace : stNode.vecNamespace)
+    {
+        auto iter = m_mapNamespace.find(strNamespace);
+        if (iter == m_mapNamespace.end())
+        {
+            continue;
+        }
+        if (bActive)
+        {
+            ++iter->second.uiActiveNode;
+        }
+        else
+        {
+            if (iter->second.uiActiveNode > 0)
+            {
+                --iter->second.uiActiveNode;
+            }
+            // 跟踪中断期间可能漏掉失效通知，已有缓存和待回填的响应都不可信
+            Flush(strNamespace);
+        }
+    }
+}
+
+void RedisNearCache::Flush(const std::string& strNamespace)
+{
+    std::string strPrefix = strNamespace;
+    strPrefix.push_back('\0');
+    for (auto iter = m_listEntry.begin(); iter != m_listEntry.end();)
+    {
+        auto erase_iter = iter++;
+        if (0 == erase_iter->strCacheKey.compare(0, strPrefix.size(), strPrefix))
+        {
+            ++m_stStat.ullInvalidate;
+            Erase(erase_iter);
+        }
+    }
+    for (auto iter = m_mapPendingIndex.begin(); iter != m_mapPendingIndex.end();)
+    {
+        if (0 == iter->first.compare(0, strPrefix.size(), strPrefix))
+        {
+            m_mapPending.erase(iter->second);
+            iter = m_mapPendingIndex.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+}
+
+void RedisNearCache::Erase(std::list<tagEntry>::iterator iterEntry)
+{
+    auto index_iter = m_mapIndex.find(iterEntry->strIndexKey);
+    if (index_iter != m_mapIndex.end())
+    {
+        auto& vecEntry = index_iter->second;
+        auto iter = std::find(vecEntry.begin(), vecEntry.end(), iterEntry);
+        if (iter != vecEntry.end())
+        {
+            *iter = vecEntry.back();
+            vecEntry.pop_back();
+        }
+        if (vecEntry.empty())
+        {
+            m_mapIndex.erase(index_iter);
+        }
+    }
+    m_mapEntry.erase(iterEntry->strCacheKey);
+    m_ullMemory -= iterEntry->uiMemory;
+    m_listEntry.erase(iterEntry);
+}
+
+void RedisNearCache::ErasePending(const std::string& strIndexKey)
+{
+    auto range = m_mapPendingIndex.equal_range(strIndexKey);
+    for (auto iter = range.first; iter != range.second; ++iter)
+    {
+        m_mapPending.erase(iter->second);
+    }
+    m_mapPendingIndex.erase(range.first, range.second);
+}
+
+void RedisNearCache::Evict()
+{
+    while (m_ullMemory > m_ullMaxMemory && !m_listEntry.empty())
+    {
+        ++m_stStat.ullEvict;
+        Erase(std::prev(m_listEntry.end()));
+    }
+}
+
+} /* namespace neb */
@@ -0,0 +1,235 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     RedisNearCache.hpp
+ * @brief    redis读请求的进程内近端缓存
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note     缓存按“命名空间（请求发往的节点标识或集群标识）+ 命令 + 参数”存放redis读
+ * 命令的响应，内存超出上限时按LRU淘汰。一致性依靠redis 6的CLIENT TRACKING：对命名
+ * 空间中的每个redis节点建立一条专用的RESP3连接（HELLO 3），以BCAST模式开启跟踪，
+ * 节点上任何被修改的key（或匹配前缀的key）都会以push消息通知到这条连接，收到后删除
+ * 对应缓存。跟踪连接断开或跟踪未就绪时，该命名空间的缓存全部清空且不再缓存，直到跟踪
+ * 重新建立。
+ * Modify history:
+ ******************************************************************************/
+#ifndef SRC_IOS_REDISNEARCACHE_HPP_
+#define SRC_IOS_REDISNEARCACHE_HPP_
+
+#include <string>
+#include <vector>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include "Definition.hpp"
+#include "pb/redis.pb.h"
+
+namespace neb
+{
+
+class SocketChannel;
+class RespCmd;
+class RespView;
+
+/**
+ * @brief redis近端缓存
+ * @note 每个Dispatcher一份，非线程安全。本类只维护缓存和跟踪状态，跟踪连接的建立和
+ * 收发由Dispatcher完成。
+ */
+class RedisNearCache
+{
+public:
+    enum E_TRACKING_STATUS
+    {
+        TRACKING_NONE           = 0,        ///< 未建立跟踪（或跟踪连接已断开），到重试时间后可重新建立
+        TRACKING_CONNECTING     = 1,        ///< 已发出HELLO和CLIENT TRACKING，等待响应
+        TRACKING_ACTIVE         = 2,        ///< 跟踪已生效
+    };
+
+    struct tagStat
+    {
+        uint64 ullHit = 0;
+        uint64 ullMiss = 0;
+        uint64 ullInvalidate = 0;           ///< 因失效通知删除的缓存数
+        uint64 ullEvict = 0;                ///< 因内存上限淘汰的缓存数
+    };
+
+    RedisNearCache();
+    RedisNearCache(const RedisNearCache&) = delete;
+    RedisNearCache& operator=(const RedisNearCache&) = delete;
+    virtual ~RedisNearCache();
+
+    /**
+     * @brief 设置内存上限
+     * @param ullMaxMemory 内存上限（字节），0表示不开启缓存并清空已有缓存
+     */
+    void SetMaxMemory(uint64 ullMaxMemory);
+
+    bool IsEnabled() const
+    {
+        return(m_ullMaxMemory > 0);
+    }
+
+    /**
+     * @brief 设置跟踪的key前缀，为空跟踪全部key
+     * @note 须与跟踪连接的CLIENT TRACKING ... PREFIX一致，不匹配的key不缓存。
+     */
+    void SetTrackingPrefix(const std::vector<std::string>& vecPrefix)
+    {
+        m_vecPrefix = vecPrefix;
+    }
+
+    /**
+     * @brief 是否可缓存的读命令（单key，key为第一个参数，且匹配跟踪的前缀）
+     */
+    bool IsCacheable(const RespCmd& oRespCmd) const;
+
+    /**
+     * @brief 设置命名空间对应的redis节点
+     * @note 节点有变化时清空该命名空间的缓存。单节点的命名空间即该节点本身，集群由
+     * StepRedisCluster在刷新槽位后设置。
+     */
+    void SetNamespaceNodes(const std::string& strNamespace, const std::vector<std::string>& vecNode);
+
+    bool HasNamespace(const std::string& strNamespace) const
+    {
+        return(m_mapNamespace.find(strNamespace) != m_mapNamespace.end());
+    }
+
+    /**
+     * @brief 命名空间的所有节点是否都已建立跟踪（可以读写缓存）
+     */
+    bool IsReady(const std::string& strNamespace) const;
+
+    /**
+     * @brief 取命名空间中需要（重新）建立跟踪的节点
+     */
+    void GetUntrackedNodes(const std::string& strNamespace, ev_tstamp dNow, std::vector<std::string>& vecNode) const;
+
+    /**
+     * @brief 登记节点的跟踪连接，此后该连接上收到的消息交给OnTrackingMessage()
+     * @param uiExpectReply 连接上已发出、需等待响应的命令数（HELLO和CLIENT TRACKING）
+     */
+    void AddTrackingChannel(const std::string& strNode, std::shared_ptr<SocketChannel> pChannel, uint32 uiExpectReply);
+
+    bool IsTrackingChannel(const SocketChannel* pChannel) const
+    {
+        return(!m_mapTrackingChannel.empty() && m_mapTrackingChannel.find(pChannel) != m_mapTrackingChannel.end());
+    }
+
+    /**
+     * @brief 处理跟踪连接上收到的消息（命令响应或invalidate push消息）
+     * @return 跟踪建立失败（如redis版本低于6）时返回false，调用方应关闭连接
+     */
+    bool OnTrackingMessage(const SocketChannel* pChannel, const RespView& oRespView, ev_tstamp dNow);
+
+    /**
+     * @brief 跟踪连接关闭，清空相关命名空间的缓存
+     */
+    void OnTrackingClosed(const SocketChannel* pChannel, ev_tstamp dNow);
+
+    /**
+     * @brief 取已生效的跟踪连接（用于保活）
+     */
+    void GetTrackingChannels(std::vector<std::shared_ptr<SocketChannel> >& vecChannel) const;
+
+    /**
+     * @brief 查找缓存
+     * @note 调用前须确认IsReady(strNamespace)。
+     * @param[out] uiFillId 未命中时为待回填的序号，响应到达后以Fill()回填
+     * @return 命中时返回缓存的响应（在缓存下一次被修改前有效），未命中返回nullptr
+     */
+    const RedisReply* Lookup(const std::string& strNamespace, const RespCmd& oRespCmd, uint32& uiFillId);
+
+    /**
+     * @brief 以响应回填缓存
+     * @note 查找之后该key收到过失效通知或跟踪断开过的不回填，错误响应不回填。
+     */
+    void Fill(uint32 uiFillId, const RedisReply& oRedisReply);
+
+    /**
+     * @brief 放弃回填（请求失败或超时）
+     */
+    void Cancel(uint32 uiFillId);
+
+    const tagStat& GetStat() const
+    {
+        return(m_stStat);
+    }
+
+    void ResetStat()
+    {
+        m_stStat = tagStat();
+    }
+
+    uint64 GetMemory() const
+    {
+        return(m_ullMemory);
+    }
+
+    size_t GetEntryNum() const
+    {
+        return(m_mapEntry.size());
+    }
+
+    static const ev_tstamp sc_dReconnectInterval;       ///< 跟踪连接断开后重新建立的间隔
+    static const ev_tstamp sc_dUnsupportedInterval;     ///< 节点不支持跟踪（redis 6以下）时重试的间隔
+
+private:
+    struct tagEntry
+    {
+        std::string strCacheKey;                ///< 命名空间 + 命令 + 参数
+        std::string strIndexKey;                ///< 命名空间 + redis key
+        RedisReply oReply;
+        size_t uiMemory = 0;
+    };
+
+    struct tagPending
+    {
+        std::string strCacheKey;
+        std::string strIndexKey;
+    };
+
+    struct tagNode
+    {
+        E_TRACKING_STATUS eStatus = TRACKING_NONE;
+        uint32 uiExpectReply = 0;
+        ev_tstamp dRetryTime = 0.0;
+        std::weak_ptr<SocketChannel> pChannel;           ///< 连接由Dispatcher持有
+        std::vector<std::string> vecNamespace;
+    };
+
+    struct tagNamespace
+    {
+        std::vector<std::string> vecNode;
+        uint32 uiActiveNode = 0;
+    };
+
+    void MakeKey(const std::string& strNamespace, const RespCmd& oRespCmd);
+    void Invalidate(const tagNode& stNode, const char* pKey, size_t uiKeyLen);
+    void SetNodeStatus(tagNode& stNode, E_TRACKING_STATUS eStatus);
+    void Flush(const std::string& strNamespace);
+    void Erase(std::list<tagEntry>::iterator iterEntry);
+    void ErasePending(const std::string& strIndexKey);
+    void Evict();
+
+private:
+    uint64 m_ullMaxMemory;
+    uint64 m_ullMemory;
+    uint32 m_uiFillId;
+    tagStat m_stStat;
+    std::list<tagEntry> m_listEntry;                                        ///< 按最近访问排序，表头最新
+    std::unordered_map<std::string, std::list<tagEntry>::iterator> m_mapEntry;                  ///< key为strCacheKey
+    std::unordered_map<std::string, std::vector<std::list<tagEntry>::iterator> > m_mapIndex;    ///< key为strIndexKey
+    std::unordered_map<uint32, tagPending> m_mapPending;                    ///< 待回填的请求，key为回填序号
+    std::unordered_multimap<std::string, uint32> m_mapPendingIndex;         ///< key为strIndexKey，value为回填序号
+    std::unordered_map<std::string, tagNode> m_mapNode;                     ///< key为节点标识
+    std::unordered_map<std::string, tagNamespace> m_mapNamespace;
+    std::unordered_map<const SocketChannel*, std::string> m_mapTrackingChannel;    ///< 跟踪连接对应的节点
+    std::vector<std::string> m_vecPrefix;
+    std::string m_strCacheKey;                  ///< MakeKey()的临时缓冲区
+    std::string m_strIndexKey;                  ///< MakeKey()的临时缓冲区
+};
+
+} /* namespace neb */
+
+#endif /* SRC_IOS_REDISNEARCACHE_HPP_ */
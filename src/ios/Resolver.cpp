@@ -0,0 +1,268 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     Resolver.cpp
+ * @brief    域名解析缓存与后台解析
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note
+ * Modify history:
+ ******************************************************************************/
+#include <unistd.h>
+#include <netdb.h>
+#include <string.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "Resolver.hpp"
+
+namespace neb
+{
+
+Resolver::Resolver()
+    : m_fnResolve(GetAddrInfo), m_bStop(false), m_iPid(0), m_pResolveThread(nullptr)
+{
+}
+
+Resolver::~Resolver()
+{
+    Stop();
+}
+
+Resolver::E_RESOLVE_STATUS Resolver::Lookup(const std::string& strHost, int iPort,
+        tagAddress& stAddress, int& iErrCode, ev_tstamp dNow)
+{
+    if (ParseNumericHost(strHost, iPort, stAddress))
+    {
+        return(RESOLVE_HIT);
+    }
+    auto iter = m_mapCache.find(strHost);
+    if (iter == m_mapCache.end() || iter->second.dExpireTime < dNow)
+    {
+        return(RESOLVE_MISS);
+    }
+    if (0 != iter->second.iErrCode)
+    {
+        iErrCode = iter->second.iErrCode;
+        return(RESOLVE_NEGATIVE);
+    }
+    stAddress = iter->second.stAddress;
+    SetPort(stAddress, iPort);
+    return(RESOLVE_HIT);
+}
+
+bool Resolver::Resolve(const std::string& strHost)
+{
+    if (m_setResolving.find(strHost) != m_setResolving.end())
+    {
+        return(true);
+    }
+    if (nullptr == m_pResolveThread)
+    {
+        try
+        {
+            m_bStop = false;
+            m_iPid = getpid();
+            m_pResolveThread = new std::thread(&Resolver::ResolveThread, this);
+        }
+        catch(std::exception& e)
+        {
+            m_pResolveThread = nullptr;
+            return(false);
+        }
+    }
+    m_setResolving.insert(strHost);
+    {
+        std::lock_guard<std::mutex> oLock(m_mutex);
+        m_deqRequest.push_back(strHost);
+    }
+    m_cond.notify_one();
+    return(true);
+}
+
+void Resolver::FetchResult(std::vector<tagResult>& vecResult)
+{
+    {
+        std::lock_guard<std::mutex> oLock(m_mutex);
+        vecResult.swap(m_vecResult);
+    }
+    for (auto it = vecResult.begin(); it != vecResult.end(); ++it)
+    {
+        m_setResolving.erase(it->strHost);
+    }
+}
+
+void Resolver::Update(const tagResult& stResult, ev_tstamp dNow, ev_tstamp dTtl)
+{
+    tagCacheEntry stEntry;
+    stEntry.iErrCode = stResult.iErrCode;
+    stEntry.dExpireTime = dNow + dTtl;
+    if (0 == stResult.iErrCode)
+    {
+        if (stResult.vecAddress.empty())
+        {
+            stEntry.iErrCode = EAI_NONAME;
+        }
+        else
+        {
+            stEntry.stAddress = stResult.vecAddress[0];
+        }
+    }
+    auto iter = m_mapCache.find(stResult.strHost);
+    if (iter != m_mapCache.end())
+    {
+        iter->second = stEntry;
+        return;
+    }
+    if (m_mapCache.size() >= s_uiMaxCacheEntry)
+    {
+        // 先淘汰已过期的缓存，仍不足时任意淘汰一个
+        for (auto it = m_mapCache.begin(); it != m_mapCache.end();)
+        {
+            if (it->second.dExpireTime < dNow)
+            {
+                it = m_mapCache.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        if (m_mapCache.size() >= s_uiMaxCacheEntry)
+        {
+            m_mapCache.erase(m_mapCache.begin());
+        }
+    }
+    m_mapCache.insert(std::make_pair(stResult.strHost, stEntry));
+}
+
+bool Resolver::GetAddress(const tagResult& stResult, int iPort, tagAddress& stAddress)
+{
+    if (0 != stResult.iErrCode || stResult.vecAddress.empty())
+    {
+        return(false);
+    }
+    stAddress = stResult.vecAddress[0];
+    SetPort(stAddress, iPort);
+    return(true);
+}
+
+void Resolver::Stop()
+{
+    if (nullptr == m_pResolveThread)
+    {
+        return;
+    }
+    if (getpid() != m_iPid)
+    {
+        // fork()得到的子进程中并没有这个线程，不能join，线程对象直接放弃
+        m_pResolveThread = nullptr;
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> oLock(m_mutex);
+        m_bStop = true;
+        m_deqRequest.clear();
+    }
+    m_cond.notify_one();
+    m_pResolveThread->join();   // 最长等待正在进行的一次getaddrinfo()返回
+    delete m_pResolveThread;
+    m_pResolveThread = nullptr;
+    m_vecResult.clear();
+    m_setResolving.clear();
+}
+
+int Resolver::GetAddrInfo(const std::string& strHost, std::vector<tagAddress>& vecAddress)
+{
+    struct addrinfo stAddrHints;
+    struct addrinfo* pAddrResult;
+    memset(&stAddrHints, 0, sizeof(struct addrinfo));
+    stAddrHints.ai_family = AF_UNSPEC;
+    stAddrHints.ai_socktype = SOCK_STREAM;
+    stAddrHints.ai_protocol = IPPROTO_IP;
+    int iCode = getaddrinfo(strHost.c_str(), NULL, &stAddrHints, &pAddrResult);
+    if (0 != iCode)
+    {
+        return(iCode);
+    }
+    for (struct addrinfo* pAddrCurrent = pAddrResult;
+            pAddrCurrent != NULL; pAddrCurrent = pAddrCurrent->ai_next)
+    {
+        if ((AF_INET != pAddrCurrent->ai_family && AF_INET6 != pAddrCurrent->ai_family)
+                || pAddrCurrent->ai_addrlen > sizeof(struct sockaddr_storage))
+        {
+            continue;
+        }
+        tagAddress stAddress;
+        memcpy(&stAddress.stAddr, pAddrCurrent->ai_addr, pAddrCurrent->ai_addrlen);
+        stAddress.uiAddrLen = pAddrCurrent->ai_addrlen;
+        vecAddress.push_back(stAddress);
+    }
+    freeaddrinfo(pAddrResult);
+    return(vecAddress.empty() ? EAI_NONAME : 0);
+}
+
+bool Resolver::ParseNumericHost(const std::string& strHost, int iPort, tagAddress& stAddress)
+{
+    memset(&stAddress.stAddr, 0, sizeof(stAddress.stAddr));
+    struct sockaddr_in* pAddr4 = (struct sockaddr_in*)&stAddress.stAddr;
+    if (1 == inet_pton(AF_INET, strHost.c_str(), &pAddr4->sin_addr))
+    {
+        pAddr4->sin_family = AF_INET;
+        pAddr4->sin_port = htons(iPort);
+        stAddress.uiAddrLen = sizeof(struct sockaddr_in);
+        return(true);
+    }
+    struct sockaddr_in6* pAddr6 = (struct sockaddr_in6*)&stAddress.stAddr;
+    if (1 == inet_pton(AF_INET6, strHost.c_str(), &pAddr6->sin6_addr))
+    {
+        pAddr6->sin6_family = AF_INET6;
+        pAddr6->sin6_port = htons(iPort);
+        stAddress.uiAddrLen = sizeof(struct sockaddr_in6);
+        return(true);
+    }
+    return(false);
+}
+
+void Resolver::SetPort(tagAddress& stAddress, int iPort)
+{
+    if (AF_INET6 == stAddress.stAddr.ss_family)
+    {
+        ((struct sockaddr_in6*)&stAddress.stAddr)->sin6_port = htons(iPort);
+    }
+    else
+    {
+        ((struct sockaddr_in*)&stAddress.stAddr)->sin_port = htons(iPort);
+    }
+}
+
+void Resolver::ResolveThread()
+{
+    while (true)
+    {
+        tagResult stResult;
+        {
+            std::unique_lock<std::mutex> oLock(m_mutex);
+            m_cond.wait(oLock, [this]{ return(m_bStop || !m_deqRequest.empty()); });
+            if (m_bStop)
+            {
+                return;
+            }
+            stResult.strHost = std::move(m_deqRequest.front());
+            m_deqRequest.pop_front();
+        }
+        stResult.iErrCode = m_fnResolve(stResult.strHost, stResult.vecAddress);
+        {
+            std::lock_guard<std::mutex> oLock(m_mutex);
+            if (m_bStop)
+            {
+                return;
+            }
+            m_vecResult.push_back(std::move(stResult));
+        }
+        if (m_fnNotify)
+        {
+            m_fnNotify();
+        }
+    }
+}
+
+} /* namespace neb */
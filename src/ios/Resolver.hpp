@@ -0,0 +1,165 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     Resolver.hpp
+ * @brief    域名解析缓存与后台解析
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note     事件循环线程只查缓存，缓存未命中的域名提交给后台解析线程以getaddrinfo()
+ * 解析，解析完成后由通知函数（ev_async）唤醒事件循环取回结果，事件循环不会因DNS
+ * 慢或不可达而阻塞。解析失败的结果同样缓存（较短的TTL），避免对不可解析的域名
+ * 反复发起解析。
+ * Modify history:
+ ******************************************************************************/
+#ifndef SRC_IOS_RESOLVER_HPP_
+#define SRC_IOS_RESOLVER_HPP_
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include "Definition.hpp"
+
+namespace neb
+{
+
+/**
+ * @brief 域名解析缓存与后台解析
+ * @note 每个Dispatcher一份。除后台解析线程外，所有接口只在所属事件循环线程调用。
+ * IP地址（IPv4或IPv6）直接转换，不经缓存也不提交解析。
+ */
+class Resolver
+{
+public:
+    enum E_RESOLVE_STATUS
+    {
+        RESOLVE_HIT             = 0,        ///< 命中缓存（或host为IP地址）
+        RESOLVE_NEGATIVE        = 1,        ///< 命中解析失败的缓存
+        RESOLVE_MISS            = 2,        ///< 未命中或已过期，需提交解析
+    };
+
+    struct tagAddress
+    {
+        struct sockaddr_storage stAddr;
+        socklen_t uiAddrLen = 0;
+    };
+
+    struct tagResult
+    {
+        std::string strHost;
+        int iErrCode = 0;                   ///< getaddrinfo()返回值，0为成功
+        std::vector<tagAddress> vecAddress;
+    };
+
+    /**
+     * @brief 解析函数，返回值与getaddrinfo()相同，解析出的地址端口为0
+     */
+    typedef std::function<int(const std::string&, std::vector<tagAddress>&)> resolve_function;
+    typedef std::function<void()> notify_function;
+
+    Resolver();
+    Resolver(const Resolver&) = delete;
+    Resolver& operator=(const Resolver&) = delete;
+    virtual ~Resolver();
+
+    /**
+     * @brief 设置解析完成通知函数
+     * @note 在后台解析线程中调用，须线程安全（如ev_async_send()）。
+     */
+    void SetNotifyFunction(notify_function fnNotify)
+    {
+        m_fnNotify = fnNotify;
+    }
+
+    /**
+     * @brief 替换解析函数（默认为GetAddrInfo()），可替换为本地桩解析以便测试
+     * @note 须在首次Resolve()之前调用。
+     */
+    void SetResolveFunction(resolve_function fnResolve)
+    {
+        m_fnResolve = fnResolve;
+    }
+
+    /**
+     * @brief 查找strHost:iPort的地址
+     * @param[out] stAddress RESOLVE_HIT时为可直接connect()的地址
+     * @param[out] iErrCode RESOLVE_NEGATIVE时为缓存的getaddrinfo()错误码
+     * @param dNow 当前时间
+     */
+    E_RESOLVE_STATUS Lookup(const std::string& strHost, int iPort, tagAddress& stAddress, int& iErrCode, ev_tstamp dNow);
+
+    /**
+     * @brief 提交后台解析
+     * @note 同一域名已在解析中时不重复提交。首次调用时启动后台解析线程。
+     * @return 是否已提交（或已在解析中）
+     */
+    bool Resolve(const std::string& strHost);
+
+    /**
+     * @brief 取出已完成的解析结果，取出后该域名可再次提交解析
+     */
+    void FetchResult(std::vector<tagResult>& vecResult);
+
+    /**
+     * @brief 以解析结果更新缓存
+     * @param dNow 当前时间
+     * @param dTtl 缓存有效时长，成功和失败的结果可使用不同的TTL
+     */
+    void Update(const tagResult& stResult, ev_tstamp dNow, ev_tstamp dTtl);
+
+    /**
+     * @brief 取解析结果中端口为iPort的地址
+     */
+    static bool GetAddress(const tagResult& stResult, int iPort, tagAddress& stAddress);
+
+    /**
+     * @brief 停止并回收后台解析线程，未完成的解析结果丢弃
+     */
+    void Stop();
+
+    static int GetAddrInfo(const std::string& strHost, std::vector<tagAddress>& vecAddress);
+
+    static const size_t s_uiMaxCacheEntry = 4096;
+
+protected:
+    /**
+     * @brief strHost为IP地址时转换为端口为iPort的地址
+     */
+    static bool ParseNumericHost(const std::string& strHost, int iPort, tagAddress& stAddress);
+    static void SetPort(tagAddress& stAddress, int iPort);
+
+private:
+    void ResolveThread();
+
+    struct tagCacheEntry
+    {
+        int iErrCode = 0;
+        ev_tstamp dExpireTime = 0.0;
+        tagAddress stAddress;                   ///< 取解析结果的首个地址（与原同步解析一致）
+    };
+
+private:
+    resolve_function m_fnResolve;
+    notify_function m_fnNotify;
+    std::unordered_map<std::string, tagCacheEntry> m_mapCache;
+    std::unordered_set<std::string> m_setResolving;     ///< 已提交尚未取回结果的域名
+
+    // 以下成员由事件循环线程与后台解析线程共享，以m_mutex保护
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::deque<std::string> m_deqRequest;
+    std::vector<tagResult> m_vecResult;
+    bool m_bStop;
+    pid_t m_iPid;                                       ///< 启动后台解析线程的进程
+    std::thread* m_pResolveThread;
+};
+
+} /* namespace neb */
+
+#endif /* SRC_IOS_RESOLVER_HPP_ */
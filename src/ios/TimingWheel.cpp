@@ -0,0 +1,274 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     TimingWheel.cpp
+ * @brief    分层时间轮
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note
+ * Modify history:
+ ******************************************************************************/
+#include "TimingWheel.hpp"
+#include <cstring>
+
+namespace neb
+{
+
+TimingWheel::TimingWheel(uint64 ullStartTick)
+    : m_ullCurrentTick(ullStartTick)
+{
+    memset(m_aullRootBitmap, 0, sizeof(m_aullRootBitmap));
+    memset(m_aullNodeBitmap, 0, sizeof(m_aullNodeBitmap));
+    for (uint32 i = 0; i < s_uiRootSize; ++i)
+    {
+        InitSlot(&m_aRootSlot[i]);
+    }
+    for (int i = 0; i < s_iNodeLevel; ++i)
+    {
+        for (uint32 j = 0; j < s_uiNodeSize; ++j)
+        {
+            InitSlot(&m_aNodeSlot[i][j]);
+        }
+    }
+}
+
+TimingWheel::~TimingWheel()
+{
+    // 定时器节点可能比时间轮活得更久（如Dispatcher先于ActorBuilder析构），须先断开所有节点
+    for (uint32 i = 0; i < s_uiRootSize; ++i)
+    {
+        ClearSlot(&m_aRootSlot[i]);
+    }
+    for (int i = 0; i < s_iNodeLevel; ++i)
+    {
+        for (uint32 j = 0; j < s_uiNodeSize; ++j)
+        {
+            ClearSlot(&m_aNodeSlot[i][j]);
+        }
+    }
+}
+
+void TimingWheel::Add(tagTimer* pTimer, uint64 ullExpireTick)
+{
+    pTimer->Unlink();
+    pTimer->ullExpireTick = ullExpireTick;
+    AddToSlot(pTimer);
+}
+
+void TimingWheel::Del(tagTimer* pTimer)
+{
+    pTimer->Unlink();
+}
+
+uint32 TimingWheel::Advance(uint64 ullNowTick)
+{
+    uint32 uiExpiredNum = 0;
+    tagTimer stExpired;
+    InitSlot(&stExpired);
+    while (m_ullCurrentTick <= ullNowTick)
+    {
+        uint64 ullWakeTick = 0;
+        if (!GetNextWakeTick(ullWakeTick) || ullWakeTick > ullNowTick)
+        {
+            m_ullCurrentTick = ullNowTick + 1;
+            break;
+        }
+        m_ullCurrentTick = ullWakeTick;
+        uint32 uiIndex = (uint32)(m_ullCurrentTick & s_uiRootMask);
+        if (0 == uiIndex)
+        {
+            for (int i = 0; i < s_iNodeLevel; ++i)
+            {
+                if (0 != Cascade(i))
+                {
+                    break;
+                }
+            }
+        }
+        ++m_ullCurrentTick;
+        Splice(&m_aRootSlot[uiIndex], &stExpired);
+        m_aullRootBitmap[uiIndex >> 6] &= ~(1ULL << (uiIndex & 63));
+        while (!IsEmpty(&stExpired))
+        {
+            tagTimer* pTimer = stExpired.pNext;
+            pTimer->Unlink();
+            ++uiExpiredNum;
+            if (nullptr != pTimer->pCallback)
+            {
+                pTimer->pCallback(pTimer);
+            }
+        }
+    }
+    ClearSlot(&stExpired);
+    return(uiExpiredNum);
+}
+
+bool TimingWheel::GetNextWakeTick(uint64& ullWakeTick) const
+{
+    bool bFound = false;
+    uint32 uiDistance = NextRootSlot((uint32)(m_ullCurrentTick & s_uiRootMask));
+    if (uiDistance < s_uiRootSize)
+    {
+        ullWakeTick = m_ullCurrentTick + uiDistance;
+        bFound = true;
+    }
+    // 第i层的槽在tick的低(8 + 6 * i)位全为0时下放，槽号为tick右移这么多位
+    for (int i = 0; i < s_iNodeLevel; ++i)
+    {
+        uint32 uiShift = s_uiRootBits + i * s_uiNodeBits;
+        uint64 ullBoundary = (m_ullCurrentTick + (1ULL << uiShift) - 1) >> uiShift;
+        uiDistance = NextNodeSlot(i, (uint32)(ullBoundary & s_uiNodeMask));
+        if (uiDistance < s_uiNodeSize)
+        {
+            uint64 ullTick = (ullBoundary + uiDistance) << uiShift;
+            if (!bFound || ullTick < ullWakeTick)
+            {
+                ullWakeTick = ullTick;
+                bFound = true;
+            }
+        }
+    }
+    return(bFound);
+}
+
+void TimingWheel::AddToSlot(tagTimer* pTimer)
+{
+    uint64 ullExpireTick = pTimer->ullExpireTick;
+    if (ullExpireTick < m_ullCurrentTick)
+    {
+        ullExpireTick = m_ullCurrentTick;
+    }
+    uint64 ullDistance = ullExpireTick - m_ullCurrentTick;
+    if (ullDistance < s_uiRootSize)
+    {
+        uint32 uiIndex = (uint32)(ullExpireTick & s_uiRootMask);
+        Append(&m_aRootSlot[uiIndex], pTimer);
+        m_aullRootBitmap[uiIndex >> 6] |= (1ULL << (uiIndex & 63));
+        return;
+    }
+    if (ullDistance > s_ullMaxTimeout)
+    {
+        ullExpireTick = m_ullCurrentTick + s_ullMaxTimeout;
+        pTimer->ullExpireTick = ullExpireTick;
+    }
+    for (int i = 0; i < s_iNodeLevel; ++i)
+    {
+        uint32 uiShift = s_uiRootBits + (i + 1) * s_uiNodeBits;
+        if (ullDistance < (1ULL << uiShift) || i == s_iNodeLevel - 1)
+        {
+            uiShift -= s_uiNodeBits;
+            uint32 uiIndex = (uint32)((ullExpireTick >> uiShift) & s_uiNodeMask);
+            Append(&m_aNodeSlot[i][uiIndex], pTimer);
+            m_aullNodeBitmap[i] |= (1ULL << uiIndex);
+            return;
+        }
+    }
+}
+
+uint32 TimingWheel::Cascade(int iLevel)
+{
+    uint32 uiIndex = (uint32)((m_ullCurrentTick >> (s_uiRootBits + iLevel * s_uiNodeBits)) & s_uiNodeMask);
+    tagTimer stList;
+    InitSlot(&stList);
+    Splice(&m_aNodeSlot[iLevel][uiIndex], &stList);
+    m_aullNodeBitmap[iLevel] &= ~(1ULL << uiIndex);
+    while (!IsEmpty(&stList))
+    {
+        tagTimer* pTimer = stList.pNext;
+        pTimer->Unlink();
+        AddToSlot(pTimer);
+    }
+    ClearSlot(&stList);
+    return(uiIndex);
+}
+
+uint32 TimingWheel::NextRootSlot(uint32 uiFrom) const
+{
+    uint32 uiDistance = 0;
+    while (uiDistance < s_uiRootSize)
+    {
+        uint32 uiIndex = (uiFrom + uiDistance) & s_uiRootMask;
+        uint64 ullBits = m_aullRootBitmap[uiIndex >> 6] >> (uiIndex & 63);
+        if (0 == ullBits)
+        {
+            uiDistance += 64 - (uiIndex & 63);
+            continue;
+        }
+        uint32 uiSkip = (uint32)__builtin_ctzll(ullBits);
+        uiIndex += uiSkip;
+        uiDistance += uiSkip;
+        if (uiDistance >= s_uiRootSize)
+        {
+            break;
+        }
+        if (IsEmpty(&m_aRootSlot[uiIndex]))
+        {
+            m_aullRootBitmap[uiIndex >> 6] &= ~(1ULL << (uiIndex & 63));
+            continue;
+        }
+        return(uiDistance);
+    }
+    return(s_uiRootSize);
+}
+
+uint32 TimingWheel::NextNodeSlot(int iLevel, uint32 uiFrom) const
+{
+    while (0 != m_aullNodeBitmap[iLevel])
+    {
+        // 循环右移，使uiFrom槽对应第0位
+        uint64 ullBits = m_aullNodeBitmap[iLevel];
+        ullBits = (0 == uiFrom) ? ullBits : ((ullBits >> uiFrom) | (ullBits << (s_uiNodeSize - uiFrom)));
+        uint32 uiDistance = (uint32)__builtin_ctzll(ullBits);
+        uint32 uiIndex = (uiFrom + uiDistance) & s_uiNodeMask;
+        if (!IsEmpty(&m_aNodeSlot[iLevel][uiIndex]))
+        {
+            return(uiDistance);
+        }
+        m_aullNodeBitmap[iLevel] &= ~(1ULL << uiIndex);
+    }
+    return(s_uiNodeSize);
+}
+
+void TimingWheel::InitSlot(tagTimer* pSlot)
+{
+    pSlot->pPrev = pSlot;
+    pSlot->pNext = pSlot;
+}
+
+void TimingWheel::ClearSlot(tagTimer* pSlot)
+{
+    tagTimer* pTimer = pSlot->pNext;
+    while (nullptr != pTimer && pTimer != pSlot)
+    {
+        tagTimer* pNext = pTimer->pNext;
+        pTimer->pPrev = nullptr;
+        pTimer->pNext = nullptr;
+        pTimer = pNext;
+    }
+    pSlot->pPrev = nullptr;
+    pSlot->pNext = nullptr;
+}
+
+void TimingWheel::Append(tagTimer* pSlot, tagTimer* pTimer)
+{
+    pTimer->pPrev = pSlot->pPrev;
+    pTimer->pNext = pSlot;
+    pSlot->pPrev->pNext = pTimer;
+    pSlot->pPrev = pTimer;
+}
+
+void TimingWheel::Splice(tagTimer* pSlot, tagTimer* pList)
+{
+    if (IsEmpty(pSlot))
+    {
+        return;
+    }
+    tagTimer* pFirst = pSlot->pNext;
+    tagTimer* pLast = pSlot->pPrev;
+    pFirst->pPrev = pList->pPrev;
+    pList->pPrev->pNext = pFirst;
+    pLast->pNext = pList;
+    pList->pPrev = pLast;
+    InitSlot(pSlot);
+}
+
+} /* namespace neb */
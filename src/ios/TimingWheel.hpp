@@ -0,0 +1,153 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     TimingWheel.hpp
+ * @brief    分层时间轮
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note     Step、Session、Chain等超时统一由时间轮管理，定时器节点内嵌于对象中，
+ * 挂入、刷新、摘除均为O(1)，整个时间轮只占用一个libev定时器。
+ * Modify history:
+ ******************************************************************************/
+#ifndef SRC_IOS_TIMINGWHEEL_HPP_
+#define SRC_IOS_TIMINGWHEEL_HPP_
+
+#include "Definition.hpp"
+
+namespace neb
+{
+
+/**
+ * @brief 分层时间轮
+ * @note 第0层256个槽，每槽1个tick；第1~4层各64个槽，每层槽宽为上一层整层跨度。
+ * 以1毫秒为1个tick时可覆盖约49.7天的超时，超出部分按最大值处理。高层槽在低层
+ * 转完一圈时逐级下放（cascade）到低层，到期回调只在第0层槽触发。
+ */
+class TimingWheel
+{
+public:
+    struct tagTimer;
+    typedef void (*timer_callback)(tagTimer* pTimer);
+
+    /**
+     * @brief 时间轮定时器
+     * @note 侵入式双向链表节点，通常作为成员内嵌于定时对象中，节点析构时自动从时间轮摘除。
+     */
+    struct tagTimer
+    {
+        tagTimer* pPrev             = nullptr;
+        tagTimer* pNext             = nullptr;
+        uint64 ullExpireTick        = 0;        ///< 到期时刻（单位：tick）
+        timer_callback pCallback    = nullptr;  ///< 到期回调
+        void* data                  = nullptr;  ///< 回调数据
+
+        tagTimer(){}
+        tagTimer(const tagTimer&) = delete;
+        tagTimer& operator=(const tagTimer&) = delete;
+        ~tagTimer()
+        {
+            Unlink();
+        }
+
+        bool IsActive() const
+        {
+            return(nullptr != pPrev);
+        }
+
+        void Unlink()
+        {
+            if (nullptr != pPrev)
+            {
+                pPrev->pNext = pNext;
+                pNext->pPrev = pPrev;
+                pPrev = nullptr;
+                pNext = nullptr;
+            }
+        }
+    };
+
+public:
+    TimingWheel(uint64 ullStartTick = 0);
+    TimingWheel(const TimingWheel&) = delete;
+    TimingWheel& operator=(const TimingWheel&) = delete;
+    virtual ~TimingWheel();
+
+    /**
+     * @brief 挂入（或刷新）定时器
+     * @param pTimer 定时器，已在时间轮中的定时器会先被摘除
+     * @param ullExpireTick 到期时刻，早于当前时刻的定时器在下一个tick到期
+     */
+    void Add(tagTimer* pTimer, uint64 ullExpireTick);
+
+    /**
+     * @brief 摘除定时器
+     */
+    void Del(tagTimer* pTimer);
+
+    /**
+     * @brief 推进时间轮到ullNowTick（含），回调所有到期定时器
+     * @note 回调中可以重新挂入或摘除任意定时器。空槽不逐个走过，直接跳到下一个
+     * 有定时器的槽或需要下放的时刻，空闲很久之后推进的开销与空闲时长无关。
+     * @return 到期回调的定时器数量
+     */
+    uint32 Advance(uint64 ullNowTick);
+
+    /**
+     * @brief 获取下一次需要推进时间轮的时刻
+     * @note 不晚于最早到期的定时器，可能早于它（高层槽下放时刻）。按各层的占用位图查找，
+     * 不逐槽扫描。
+     * @param[out] ullWakeTick 下一次推进时刻
+     * @return 时间轮中是否还有定时器
+     */
+    bool GetNextWakeTick(uint64& ullWakeTick) const;
+
+    uint64 GetCurrentTick() const
+    {
+        return(m_ullCurrentTick);
+    }
+
+private:
+    void AddToSlot(tagTimer* pTimer);
+    uint32 Cascade(int iLevel);
+    /**
+     * @brief 从第0层的uiFrom槽起（含）循环查找第一个非空槽
+     * @return 与uiFrom的距离，没有非空槽返回s_uiRootSize
+     */
+    uint32 NextRootSlot(uint32 uiFrom) const;
+    /**
+     * @brief 从第iLevel层（高层，从0计）的uiFrom槽起（含）循环查找第一个非空槽
+     * @return 与uiFrom的距离，没有非空槽返回s_uiNodeSize
+     */
+    uint32 NextNodeSlot(int iLevel, uint32 uiFrom) const;
+    static void InitSlot(tagTimer* pSlot);
+    static void ClearSlot(tagTimer* pSlot);
+    static void Append(tagTimer* pSlot, tagTimer* pTimer);
+    static void Splice(tagTimer* pSlot, tagTimer* pList);
+    static bool IsEmpty(const tagTimer* pSlot)
+    {
+        return(pSlot->pNext == pSlot);
+    }
+
+private:
+    static const uint32 s_uiRootBits = 8;
+    static const uint32 s_uiNodeBits = 6;
+    static const uint32 s_uiRootSize = 1 << s_uiRootBits;
+    static const uint32 s_uiNodeSize = 1 << s_uiNodeBits;
+    static const uint32 s_uiRootMask = s_uiRootSize - 1;
+    static const uint32 s_uiNodeMask = s_uiNodeSize - 1;
+    static const int s_iNodeLevel = 4;
+    static const uint64 s_ullMaxTimeout = 0xFFFFFFFFULL;
+
+    uint64 m_ullCurrentTick;                                    ///< 下一个待处理的tick
+    /**
+     * 各槽的占用位图。定时器可以不经时间轮自行摘除（节点析构、Unlink()），位图只在
+     * 挂入时置位，查找时遇到已空的槽再清除，因此置位的槽不一定非空，未置位的槽一定为空。
+     */
+    mutable uint64 m_aullRootBitmap[s_uiRootSize / 64];
+    mutable uint64 m_aullNodeBitmap[s_iNodeLevel];             ///< 高层每层64个槽，一个字
+    tagTimer m_aRootSlot[s_uiRootSize];                         ///< 第0层
+    tagTimer m_aNodeSlot[s_iNodeLevel][s_uiNodeSize];           ///< 第1~4层
+};
+
+} /* namespace neb */
+
+#endif /* SRC_IOS_TIMINGWHEEL_HPP_ */
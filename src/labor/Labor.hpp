@@ -60,11 +60,23 @@ public:
     virtual uint32 GetSequence() const = 0;
     virtual time_t GetNowTime() const = 0;
     virtual long GetNowTimeMs() const = 0;
+    virtual int64 GetMonotonicTimeMs() const = 0;       ///< 单调时钟（单位：毫秒），用于计时和超时
+    virtual int64 GetMonotonicTimeUs() const = 0;       ///< 单调时钟（单位：微秒），用于计时和超时
     virtual const CJsonObject& GetNodeConf() const = 0;
     virtual void SetNodeConf(const CJsonObject& oNodeConf) = 0;
     virtual const NodeInfo& GetNodeInfo() const = 0;
     virtual void SetNodeId(uint32 uiNodeId) = 0;
     virtual bool AddNetLogMsg(const MsgBody& oMsgBody) = 0;
+    /**
+     * @brief 添加一条网络日志到批量发送队列
+     * @note 此函数不能写日志。
+     * @return 是否已加入批量发送，返回false时调用方以AddNetLogMsg()逐条发送
+     */
+    virtual bool AddNetLog(const std::string& strTraceId, int iLogLevel, const char* szFileName,
+            unsigned int uiFileLine, const char* szFunction, const char* szLogContent)
+    {
+        return(false);
+    }
     virtual void OnTerminated(struct ev_signal* watcher) = 0;
     virtual const CJsonObject& GetCustomConf() const = 0;
     virtual bool WithSsl()
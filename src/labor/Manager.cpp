@@ -202,9 +202,10 @@ void Manager::StartService()
                  m_stNodeInfo.iPortForServer, m_stManagerInfo.iS2SListenFd,
                  m_stManagerInfo.iS2SFamily);
 
-        if (m_stNodeInfo.strHostForClient.size() > 0 && m_stNodeInfo.iPortForClient > 0)
+        if (m_stNodeInfo.strHostForClient.size() > 0 && m_stNodeInfo.iPortForClient > 0
+                && !m_stNodeInfo.bReusePort)
         {
-            // 接入节点才需要监听客户端连接
+            // 接入节点才需要监听客户端连接（SO_REUSEPORT模式由各Worker自行监听）
             m_pDispatcher->CreateListenFd(strBindIp,
                   m_stNodeInfo.iPortForClient, m_stManagerInfo.iC2SListenFd,
                   m_stManagerInfo.iC2SFamily);
@@ -216,9 +217,10 @@ void Manager::StartService()
               m_stNodeInfo.iPortForServer, m_stManagerInfo.iS2SListenFd,
               m_stManagerInfo.iS2SFamily);
 
-        if (m_stNodeInfo.strHostForClient.size() > 0 && m_stNodeInfo.iPortForClient > 0)
+        if (m_stNodeInfo.strHostForClient.size() > 0 && m_stNodeInfo.iPortForClient > 0
+                && !m_stNodeInfo.bReusePort)
         {
-            // 接入节点才需要监听客户端连接
+            // 接入节点才需要监听客户端连接（SO_REUSEPORT模式由各Worker自行监听）
             m_pDispatcher->CreateListenFd(m_stNodeInfo.strHostForClient,
                     m_stNodeInfo.iPortForClient, m_stManagerInfo.iC2SListenFd,
                     m_stManagerInfo.iC2SFamily);
@@ -257,6 +259,17 @@ bool Manager::AddNetLogMsg(const MsgBody& oMsgBody)
     return(true);
 }
 
+bool Manager::AddNetLog(const std::string& strTraceId, int iLogLevel, const char* szFileName,
+        unsigned int uiFileLine, const char* szFunction, const char* szLogContent)
+{
+    if (std::string("BEACON") != m_stNodeInfo.strNodeType
+            && std::string("LOGGER") != m_stNodeInfo.strNodeType)
+    {
+        return(m_pActorBuilder->AddNetLog(strTraceId, iLogLevel, szFileName, uiFileLine, szFunction, szLogContent));
+    }
+    return(true);
+}
+
 time_t Manager::GetNowTime() const
 {
     return(m_pDispatcher->GetNowTime());
@@ -267,6 +280,16 @@ long Manager::GetNowTimeMs() const
     return(m_pDispatcher->GetNowTimeMs());
 }
 
+int64 Manager::GetMonotonicTimeMs() const
+{
+    return(m_pDispatcher->GetMonotonicTimeMs());
+}
+
+int64 Manager::GetMonotonicTimeUs() const
+{
+    return(m_pDispatcher->GetMonotonicTimeUs());
+}
+
 bool Manager::GetConf()
 {
     if (m_stNodeInfo.strWorkPath.length() == 0)
@@ -310,6 +333,23 @@ bool Manager::GetConf()
     if (m_oLastConf.ToString() != m_oCurrentConf.ToString())
     {
         m_oCurrentConf.Get("io_timeout", m_stNodeInfo.dIoTimeout);
+        m_oCurrentConf.Get("zerocopy_threshold", m_stNodeInfo.uiZeroCopyThreshold);
+        m_oCurrentConf["endpoint_pool"].Get("max_channel", m_stNodeInfo.uiEndpointPoolMax);
+        m_oCurrentConf["endpoint_pool"].Get("min_channel", m_stNodeInfo.uiEndpointPoolMin);
+        m_oCurrentConf["endpoint_pool"].Get("idle_timeout", m_stNodeInfo.dEndpointPoolIdle);
+        m_oCurrentConf["dns"].Get("cache_ttl", m_stNodeInfo.dDnsCacheTtl);
+        m_oCurrentConf["dns"].Get("negative_ttl", m_stNodeInfo.dDnsNegativeTtl);
+        m_oCurrentConf["dns"].Get("timeout", m_stNodeInfo.dDnsTimeout);
+        m_oCurrentConf["redis_near_cache"].Get("max_memory", m_stNodeInfo.ullRedisNearCacheMemory);
+        m_stNodeInfo.vecRedisNearCachePrefix.clear();
+        for (int i = 0; i < m_oCurrentConf["redis_near_cache"]["tracking_prefix"].GetArraySize(); ++i)
+        {
+            std::string strPrefix;
+            if (m_oCurrentConf["redis_near_cache"]["tracking_prefix"].Get(i, strPrefix))
+            {
+                m_stNodeInfo.vecRedisNearCachePrefix.push_back(strPrefix);
+            }
+        }
         m_oCurrentConf.Get("data_report", m_stNodeInfo.dDataReportInterval);
         if (m_oLastConf.ToString().length() == 0)
         {
@@ -321,6 +361,9 @@ bool Manager::GetConf()
             m_oCurrentConf.Get("access_port", m_stNodeInfo.iPortForClient);
             m_oCurrentConf.Get("gateway", m_stNodeInfo.strGateway);
             m_oCurrentConf.Get("gateway_port", m_stNodeInfo.iGatewayPort);
+            m_oCurrentConf.Get("reuse_port", m_stNodeInfo.bReusePort);
+            m_oCurrentConf.Get("reuse_port_cbpf", m_stNodeInfo.bReusePortCbpf);
+            m_oCurrentConf.Get("node_distribution", m_stNodeInfo.iNodeDistribution);
             m_stNodeInfo.strNodeIdentify = m_stNodeInfo.strHostForServer + std::string(":") + std::to_string(m_stNodeInfo.iPortForServer);
         }
         int32 iCodec;
@@ -337,13 +380,45 @@ bool Manager::GetConf()
 bool Manager::Init()
 {
     m_oCurrentConf.Get("thread_mode", m_stNodeInfo.bThreadMode);
-    if (!InitLogger(m_oCurrentConf) || !InitDispatcher() || !InitActorBuilder())
+    if (!InitLogger(m_oCurrentConf) || !InitDispatcher() || !InitActorBuilder() || !InitSsl())
     {
         return(false);
     }
     return(true);
 }
 
+bool Manager::InitSsl()
+{
+#ifdef WITH_OPENSSL
+    // ticket密钥和共享会话缓存须在fork Worker之前准备好，Worker（含重启的Worker）直接继承
+    if (m_oCurrentConf["with_ssl"]("config_path").length() == 0)
+    {
+        return(true);
+    }
+    bool bSessionTicket = true;
+    uint32 uiSessionCacheSize = 0;
+    m_oCurrentConf["with_ssl"].Get("session_ticket", bSessionTicket);
+    m_oCurrentConf["with_ssl"].Get("session_cache_size", uiSessionCacheSize);
+    if (bSessionTicket)
+    {
+        std::string strKey = SslResumption::MakeTicketKey();
+        if (strKey.empty() || !SslResumption::SetTicketKeys(strKey))
+        {
+            LOG4_FATAL("failed to make ssl session ticket key!");
+            return(false);
+        }
+        m_lTicketKeyTime = GetNowTime();
+    }
+    if (!SslResumption::CreateSharedCache(uiSessionCacheSize))
+    {
+        LOG4_FATAL("failed to create ssl session cache of %u entries, error %d: %s", uiSessionCacheSize,
+                errno, strerror_r(errno, m_pErrBuff, gc_iErrBuffLen));
+        return(false);
+    }
+#endif
+    return(true);
+}
+
 void Manager::Destroy()
 {
     LOG4_TRACE(" ");
@@ -755,6 +830,38 @@ void Manager::RefreshServer()
     }
 }
 
+void Manager::RotateSslTicketKey()
+{
+#ifdef WITH_OPENSSL
+    if (m_lTicketKeyTime == 0)
+    {
+        return;
+    }
+    int32 iRotateInterval = 3600;
+    m_oCurrentConf["with_ssl"].Get("ticket_key_rotate", iRotateInterval);
+    if (iRotateInterval <= 0 || GetNowTime() - m_lTicketKeyTime < iRotateInterval)
+    {
+        return;
+    }
+    std::string strKey = SslResumption::MakeTicketKey();
+    if (strKey.empty())
+    {
+        LOG4_ERROR("failed to make ssl session ticket key!");
+        return;
+    }
+    std::string strKeys = strKey + SslResumption::GetTicketKeys().substr(0, SslResumption::sc_uiTicketKeyLen);
+    SslResumption::SetTicketKeys(strKeys);
+    m_lTicketKeyTime = GetNowTime();
+    if (!m_stNodeInfo.bThreadMode)     // 线程模式下各Worker线程共用同一份密钥
+    {
+        MsgBody oMsgBody;
+        oMsgBody.set_data(strKeys);
+        m_pSessionManager->SendToChild(CMD_REQ_SET_SSL_TICKET_KEY, GetSequence(), oMsgBody);
+    }
+    LOG4_INFO("ssl session ticket key rotated.");
+#endif
+}
+
 bool Manager::AddPeriodicTaskEvent()
 {
     LOG4_TRACE(" ");
@@ -64,6 +64,7 @@ public:
 
     template <typename ...Targs>
         void Logger(int iLogLevel, const char* szFileName, unsigned int uiFileLine, const char* szFunction, Targs&&... args);
+    bool IsLogLevelEnabled(int iLogLevel) const;
 
 public:
     virtual uint32 GetSequence() const
@@ -93,6 +94,8 @@ public:
 
     virtual time_t GetNowTime() const;
     virtual long GetNowTimeMs() const;
+    virtual int64 GetMonotonicTimeMs() const;
+    virtual int64 GetMonotonicTimeUs() const;
     virtual const CJsonObject& GetNodeConf() const;
     virtual void SetNodeConf(const CJsonObject& oNodeConf);
     virtual const NodeInfo& GetNodeInfo() const;
@@ -101,7 +104,14 @@ public:
     const tagManagerInfo& GetManagerInfo() const;
 
     virtual bool AddNetLogMsg(const MsgBody& oMsgBody);
+    virtual bool AddNetLog(const std::string& strTraceId, int iLogLevel, const char* szFileName,
+            unsigned int uiFileLine, const char* szFunction, const char* szLogContent);
     void RefreshServer();
+    /**
+     * @brief 到轮换时间时生成新的TLS session ticket密钥并下发给所有Worker
+     * @note Worker保留新密钥和上一个密钥，上一周期签发的ticket仍可复用
+     */
+    void RotateSslTicketKey();
 
 protected:
     bool GetConf();
@@ -109,6 +119,7 @@ protected:
     bool InitLogger(const CJsonObject& oJsonConf);
     bool InitDispatcher();
     bool InitActorBuilder();
+    bool InitSsl();
     void StartService();
     void Destroy();
 
@@ -134,6 +145,7 @@ private:
     NodeInfo m_stNodeInfo;
     tagManagerInfo m_stManagerInfo;
     ev_timer* m_pPeriodicTaskWatcher = NULL;          ///< 进程周期任务定时器
+    time_t m_lTicketKeyTime = 0;                      ///< 上次生成TLS session ticket密钥的时间，0表示未开启ticket
     std::shared_ptr<NetLogger> m_pLogger = nullptr;
     std::shared_ptr<SessionManager> m_pSessionManager = nullptr;
     std::shared_ptr<Step> m_pReportStep = nullptr;
@@ -145,6 +157,11 @@ void Manager::Logger(int iLogLevel, const char* szFileName, unsigned int uiFileL
     m_pLogger->WriteLog(iLogLevel, szFileName, uiFileLine, szFunction, std::forward<Targs>(args)...);
 }
 
+inline bool Manager::IsLogLevelEnabled(int iLogLevel) const
+{
+    return(m_pLogger->IsLevelEnabled(iLogLevel));
+}
+
 } /* namespace neb */
 
 #endif /* SRC_LABOR_MANAGER_HPP_ */
@@ -11,6 +11,7 @@
 #define SRC_LABOR_NODEINFO_HPP_
 
 #include <string>
+#include <vector>
 #include "Definition.hpp"
 #include "codec/Codec.hpp"
 
@@ -31,13 +32,26 @@ struct NodeInfo
     int32 iPortForServer            = 0;            ///< Server间通信监听端口，对应 iS2SListenFd
     int32 iPortForClient            = 0;            ///< 对Client通信监听端口，对应 iC2SListenFd
     int32 iGatewayPort              = 0;            ///< 对Client服务的真实端口
+    uint32 uiZeroCopyThreshold      = 0;            ///< 发送队列中不小于此长度的数据段以MSG_ZEROCOPY发送，0表示不使用
+    int32 iNodeDistribution         = 0;            ///< 按hash选择节点的分布算法（E_NODE_DISTRIBUTION）
+    uint32 uiEndpointPoolMax        = 1;            ///< 到每个节点（worker）的pipeline连接数上限
+    uint32 uiEndpointPoolMin        = 1;            ///< 到每个节点（worker）首次发送时预先建立并保持的连接数
     bool bThreadMode                = 0;            ///< 是否线程模型
     bool bIsAccess                  = false;        ///< 是否接入Server
+    bool bReusePort                 = false;        ///< 是否由各Worker以SO_REUSEPORT各自监听对Client服务端口（不经Manager转发fd）
+    bool bReusePortCbpf             = false;        ///< SO_REUSEPORT模式下是否挂载按客户端IP分发连接的CBPF程序（否则由内核按四元组哈希分发）
     ev_tstamp dIoTimeout            = 10.0;          ///< IO（连接）超时配置
     ev_tstamp dDataReportInterval   = 60.0;         ///< 统计数据上报时间间隔
+    ev_tstamp dEndpointPoolIdle     = 60.0;         ///< 超出uiEndpointPoolMin的连接空闲多久后关闭
+    ev_tstamp dDnsCacheTtl          = 60.0;         ///< 域名解析结果缓存时长
+    ev_tstamp dDnsNegativeTtl       = 5.0;          ///< 域名解析失败结果缓存时长
+    ev_tstamp dDnsTimeout           = 10.0;         ///< 等待域名解析的连接超时时长
     ev_tstamp dMsgStatInterval      = 60.0;          ///< 客户端连接发送数据包统计时间间隔
     ev_tstamp dAddrStatInterval     = 60.0;          ///< IP地址数据统计时间间隔
     ev_tstamp dStepTimeout          = 1.5;          ///< 步骤超时
+    uint64 ullRedisNearCacheMemory  = 0;            ///< redis近端缓存内存上限（字节），0为不开启
+    std::vector<std::string> vecRedisNearCachePrefix;   ///< redis近端缓存只跟踪这些前缀的key，为空跟踪全部key
+    std::string strHttpResponseHeaders;                 ///< 每个http响应都带上的头，已序列化为"Name: value\r\n"
     std::string strWorkPath;                        ///< 工作路径
     std::string strConfFile;                        ///< 配置文件
     std::string strNodeType;                        ///< 节点类型
@@ -56,6 +70,8 @@ struct WorkerInfo
     int iWorkerIndex        = 0;                    ///< 工作进程序号
     int iControlFd          = -1;                   ///< 与Manager进程通信的文件描述符（控制流）
     int iDataFd             = -1;                   ///< 与Manager进程通信的文件描述符（数据流）
+    int iC2SListenFd        = -1;                   ///< SO_REUSEPORT模式下Worker自行监听的Client to Server文件描述符
+    int iC2SFamily          = 0;                    ///<
     int32 iLoad             = 0;                    ///< 负载
     int32 iConnect          = 0;                    ///< 连接数量
     int32 iRecvNum          = 0;                    ///< 接收数据包数量
@@ -125,6 +125,36 @@ bool Worker::Init(CJsonObject& oJsonConf)
         ngx_setproctitle(szProcessName);
     }
     oJsonConf.Get("io_timeout", m_stNodeInfo.dIoTimeout);
+    oJsonConf.Get("zerocopy_threshold", m_stNodeInfo.uiZeroCopyThreshold);
+    oJsonConf.Get("node_distribution", m_stNodeInfo.iNodeDistribution);
+    oJsonConf["endpoint_pool"].Get("max_channel", m_stNodeInfo.uiEndpointPoolMax);
+    oJsonConf["endpoint_pool"].Get("min_channel", m_stNodeInfo.uiEndpointPoolMin);
+    oJsonConf["endpoint_pool"].Get("idle_timeout", m_stNodeInfo.dEndpointPoolIdle);
+    oJsonConf["dns"].Get("cache_ttl", m_stNodeInfo.dDnsCacheTtl);
+    oJsonConf["dns"].Get("negative_ttl", m_stNodeInfo.dDnsNegativeTtl);
+    oJsonConf["dns"].Get("timeout", m_stNodeInfo.dDnsTimeout);
+    oJsonConf["redis_near_cache"].Get("max_memory", m_stNodeInfo.ullRedisNearCacheMemory);
+    m_stNodeInfo.vecRedisNearCachePrefix.clear();
+    for (int i = 0; i < oJsonConf["redis_near_cache"]["tracking_prefix"].GetArraySize(); ++i)
+    {
+        std::string strPrefix;
+        if (oJsonConf["redis_near_cache"]["tracking_prefix"].Get(i, strPrefix))
+        {
+            m_stNodeInfo.vecRedisNearCachePrefix.push_back(strPrefix);
+        }
+    }
+    m_stNodeInfo.strHttpResponseHeaders.clear();
+    std::string strHeaderName;
+    std::string strHeaderValue;
+    oJsonConf["http_response_headers"].ResetTraversing();
+    while (oJsonConf["http_response_headers"].GetKey(strHeaderName))
+    {
+        if (oJsonConf["http_response_headers"].Get(strHeaderName, strHeaderValue))
+        {
+            m_stNodeInfo.strHttpResponseHeaders.append(strHeaderName).append(": ")
+                .append(strHeaderValue).append("\r\n");
+        }
+    }
     if (!oJsonConf.Get("step_timeout", m_stNodeInfo.dStepTimeout))
     {
         m_stNodeInfo.dStepTimeout = 0.5;
@@ -138,6 +168,8 @@ bool Worker::Init(CJsonObject& oJsonConf)
     oJsonConf.Get("access_port", m_stNodeInfo.iPortForClient);
     oJsonConf.Get("gateway", m_stNodeInfo.strGateway);
     oJsonConf.Get("gateway_port", m_stNodeInfo.iGatewayPort);
+    oJsonConf.Get("reuse_port", m_stNodeInfo.bReusePort);
+    oJsonConf.Get("reuse_port_cbpf", m_stNodeInfo.bReusePortCbpf);
     m_oNodeConf = oJsonConf;
     m_oCustomConf = oJsonConf["custom"];
     std::ostringstream oss;
@@ -149,6 +181,16 @@ bool Worker::Init(CJsonObject& oJsonConf)
         m_stNodeInfo.bIsAccess = true;
         oJsonConf["permission"]["uin_permit"].Get("stat_interval", m_stNodeInfo.dMsgStatInterval);
         oJsonConf["permission"]["uin_permit"].Get("permit_num", m_stNodeInfo.iMsgPermitNum);
+        if (m_stNodeInfo.bReusePort)    // Worker自行accept，需自己做接入编解码和IP连接频率限制
+        {
+            int32 iCodec;
+            if (oJsonConf.Get("access_codec", iCodec))
+            {
+                m_stNodeInfo.eCodec = E_CODEC_TYPE(iCodec);
+            }
+            oJsonConf["permission"]["addr_permit"].Get("stat_interval", m_stNodeInfo.dAddrStatInterval);
+            oJsonConf["permission"]["addr_permit"].Get("permit_num", m_stNodeInfo.iAddrPermitNum);
+        }
     }
     if (!InitLogger(oJsonConf, szProcessName))
     {
@@ -192,6 +234,17 @@ bool Worker::Init(CJsonObject& oJsonConf)
             LOG4_FATAL("SslServerCertificate() failed!");
             return(false);
         }
+        bool bSessionTicket = true;
+        int32 iSessionTimeout = 3600;
+        oJsonConf["with_ssl"].Get("session_ticket", bSessionTicket);
+        oJsonConf["with_ssl"].Get("session_timeout", iSessionTimeout);
+        SocketChannelSslImpl::SslServerSessionResumption(bSessionTicket, iSessionTimeout);
+        bool bKtls = false;
+        oJsonConf["with_ssl"].Get("ktls", bKtls);
+        if (bKtls)
+        {
+            SocketChannelSslImpl::SslEnableKtls(m_pLogger);
+        }
 #endif
     }
 
@@ -256,6 +309,20 @@ bool Worker::InitLogger(const CJsonObject& oJsonConf, const std::string& strLogN
         oJsonConf.Get("always_flush_log", bAlwaysFlushLog);
         m_pLogger = std::make_shared<neb::NetLogger>(strLogname, iLogLevel, iMaxLogFileSize, iMaxLogFileNum, iMaxLogLineLen, bAlwaysFlushLog, this);
         m_pLogger->SetNetLogLevel(iNetLogLevel);
+        bool bAsyncLog = false;
+        oJsonConf.Get("async_log", bAsyncLog);
+        if (bAsyncLog)
+        {
+            uint32 uiAsyncLogBufferSize = 8 * 1024 * 1024;
+            std::string strOverflowPolicy;
+            oJsonConf.Get("async_log_buffer_size", uiAsyncLogBufferSize);
+            oJsonConf.Get("async_log_overflow", strOverflowPolicy);
+            if (!m_pLogger->EnableAsync(uiAsyncLogBufferSize, ("block" == strOverflowPolicy)
+                    ? FileLogger::OVERFLOW_BLOCK : FileLogger::OVERFLOW_DROP))
+            {
+                LOG4_WARNING("enable async log failed, log synchronously.");
+            }
+        }
         LOG4_NOTICE("%s program begin...", getproctitle());
         return(true);
     }
@@ -336,6 +403,39 @@ void Worker::StartService()
     MsgBody oMsgBody;
     oMsgBody.set_data(std::to_string(m_stWorkerInfo.iWorkerIndex));
     m_pDispatcher->SendTo(m_pManagerControlChannel, CMD_REQ_START_SERVICE, GetSequence(), oMsgBody);
+
+    if (m_stNodeInfo.bReusePort && Labor::LABOR_WORKER == GetLaborType()
+            && m_stNodeInfo.strHostForClient.size() > 0 && m_stNodeInfo.iPortForClient > 0)
+    {
+        // SO_REUSEPORT模式：每个Worker各自监听对Client服务端口，由内核（或CBPF程序）分发新连接
+        std::string strBindIp;
+        if (!m_oNodeConf.Get("bind_ip", strBindIp) || strBindIp.length() == 0)
+        {
+            strBindIp = m_stNodeInfo.strHostForClient;
+        }
+        if (!m_pDispatcher->CreateListenFd(strBindIp, m_stNodeInfo.iPortForClient,
+                m_stWorkerInfo.iC2SListenFd, m_stWorkerInfo.iC2SFamily, true))
+        {
+            LOG4_ERROR("worker %d failed to listen on %s:%d with SO_REUSEPORT",
+                    m_stWorkerInfo.iWorkerIndex, strBindIp.c_str(), m_stNodeInfo.iPortForClient);
+            return;
+        }
+        if (m_stNodeInfo.bReusePortCbpf)
+        {
+            m_pDispatcher->AttachReusePortCbpf(m_stWorkerInfo.iC2SListenFd, m_stNodeInfo.uiWorkerNum);
+        }
+        LOG4_TRACE("C2SListenFd[%d]", m_stWorkerInfo.iC2SListenFd);
+        std::shared_ptr<SocketChannel> pChannelListen = m_pDispatcher->CreateSocketChannel(
+                m_stWorkerInfo.iC2SListenFd, m_stNodeInfo.eCodec);
+        if (nullptr == pChannelListen)
+        {
+            close(m_stWorkerInfo.iC2SListenFd);
+            m_stWorkerInfo.iC2SListenFd = -1;
+            return;
+        }
+        m_pDispatcher->SetChannelStatus(pChannelListen, CHANNEL_STATUS_ESTABLISHED);
+        m_pDispatcher->AddIoReadEvent(pChannelListen);
+    }
 }
 
 void Worker::Destroy()
@@ -345,6 +445,21 @@ void Worker::Destroy()
 #ifdef WITH_OPENSSL
     SocketChannelSslImpl::SslFree();
 #endif
+    if (m_stWorkerInfo.iC2SListenFd > 2)
+    {
+        // SO_REUSEPORT模式下先关闭自己的监听fd，内核不再向本Worker分发新连接（线程模式下进程不随之退出）
+        std::shared_ptr<SocketChannel> pChannelListen = (m_pDispatcher == nullptr)
+                ? nullptr : m_pDispatcher->GetChannel(m_stWorkerInfo.iC2SListenFd);
+        if (nullptr == pChannelListen)
+        {
+            close(m_stWorkerInfo.iC2SListenFd);
+        }
+        else
+        {
+            m_pDispatcher->DiscardSocketChannel(pChannelListen, false);
+        }
+        m_stWorkerInfo.iC2SListenFd = -1;
+    }
     if (m_pDispatcher != nullptr)
     {
         delete m_pDispatcher;
@@ -386,6 +501,16 @@ long Worker::GetNowTimeMs() const
     return(m_pDispatcher->GetNowTimeMs());
 }
 
+int64 Worker::GetMonotonicTimeMs() const
+{
+    return(m_pDispatcher->GetMonotonicTimeMs());
+}
+
+int64 Worker::GetMonotonicTimeUs() const
+{
+    return(m_pDispatcher->GetMonotonicTimeUs());
+}
+
 const CJsonObject& Worker::GetNodeConf() const
 {
     return(m_oNodeConf);
@@ -413,6 +538,13 @@ bool Worker::AddNetLogMsg(const MsgBody& oMsgBody)
     return(true);
 }
 
+bool Worker::AddNetLog(const std::string& strTraceId, int iLogLevel, const char* szFileName,
+        unsigned int uiFileLine, const char* szFunction, const char* szLogContent)
+{
+    // 此函数不能写日志，不然可能会导致写日志函数与此函数无限递归
+    return(m_pActorBuilder->AddNetLog(strTraceId, iLogLevel, szFileName, uiFileLine, szFunction, szLogContent));
+}
+
 const WorkerInfo& Worker::GetWorkerInfo() const
 {
     return(m_stWorkerInfo);
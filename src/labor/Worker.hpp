@@ -89,11 +89,15 @@ public:     // about worker
 
     virtual time_t GetNowTime() const;
     virtual long GetNowTimeMs() const;
+    virtual int64 GetMonotonicTimeMs() const;
+    virtual int64 GetMonotonicTimeUs() const;
     virtual const CJsonObject& GetNodeConf() const;
     virtual void SetNodeConf(const CJsonObject& oJsonConf);
     virtual const NodeInfo& GetNodeInfo() const;
     virtual void SetNodeId(uint32 uiNodeId);
     virtual bool AddNetLogMsg(const MsgBody& oMsgBody);
+    virtual bool AddNetLog(const std::string& strTraceId, int iLogLevel, const char* szFileName,
+            unsigned int uiFileLine, const char* szFunction, const char* szLogContent);
     virtual const CJsonObject& GetCustomConf() const;
     bool WithSsl();
     const WorkerInfo& GetWorkerInfo() const;
@@ -102,6 +106,7 @@ public:     // about worker
 
     template <typename ...Targs>
         void Logger(int iLogLevel, const char* szFileName, unsigned int uiFileLine, const char* szFunction, Targs&&... args);
+    bool IsLogLevelEnabled(int iLogLevel) const;
 
 protected:
     bool InitLogger(const CJsonObject& oJsonConf, const std::string& strLogNameBase = "");
@@ -137,6 +142,11 @@ void Worker::Logger(int iLogLevel, const char* szFileName, unsigned int uiFileLi
     m_pLogger->WriteLog(iLogLevel, szFileName, uiFileLine, szFunction, std::forward<Targs>(args)...);
 }
 
+inline bool Worker::IsLogLevelEnabled(int iLogLevel) const
+{
+    return(m_pLogger->IsLevelEnabled(iLogLevel));
+}
+
 
 } /* namespace neb */
 
@@ -10,6 +10,8 @@
 
 #include <cstdio>
 #include <cstdarg>
+#include <cstdlib>
+#include <cstring>
 #include <chrono>
 #include <ctime>
 #include <sys/time.h>
@@ -18,6 +20,10 @@
 #include <iostream>
 #include <sstream>
 #include <fstream>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
 
 #include "FileLogger.hpp"
 
@@ -26,19 +32,44 @@ namespace neb
 
 FileLogger* FileLogger::s_pInstance = nullptr;
 
+/** @brief 异步模式下单条日志（含前缀）的最大长度，超出截断 */
+static const unsigned int s_uiMaxAsyncLineLen = gc_uiMaxLogLineLen * 4;
+/** @brief 异步模式环形缓冲区最小容量 */
+static const unsigned int s_uiMinAsyncBufferSize = 64 * 1024;
+/** @brief 后台线程空闲时的最长等待时间，也是非紧急日志的最长落盘延迟 */
+static const int s_iFlushIntervalMs = 100;
+
 FileLogger::FileLogger(const std::string& strLogFile, int iLogLev,
         unsigned int uiMaxFileSize, unsigned int uiMaxRollFileIndex, bool bAlwaysFlush)
     : m_iLogLevel(iLogLev), m_uiLogNum(0), m_uiMaxFileSize(uiMaxFileSize),
-      m_uiMaxRollFileIndex(uiMaxRollFileIndex), m_bAlwaysFlush(bAlwaysFlush), m_strLogFileBase(strLogFile)
+      m_uiMaxRollFileIndex(uiMaxRollFileIndex), m_bAlwaysFlush(bAlwaysFlush), m_strLogFileBase(strLogFile),
+      m_bAsync(false), m_eOverflowPolicy(OVERFLOW_DROP), m_pRing(NULL), m_ullRingMask(0),
+      m_ullWritePos(0), m_ullReadPos(0), m_ullDroppedNum(0), m_ullReportedDroppedNum(0), m_ullFileSize(0),
+      m_bFlusherWaiting(false), m_bStop(false), m_pFlushThread(nullptr), m_pLineBuff(NULL), m_lCachedTime(0)
 {
 #if __GNUC__ < 5
     m_szTime = (char*)malloc(20);
 #endif
+    m_szCachedTime[0] = '\0';
     m_fp = NULL;
     OpenLogFile(strLogFile);
     WriteLog(Logger::NOTICE, __FILE__, __LINE__, __FUNCTION__, "new log instance.");
 }
 
+FileLogger::~FileLogger()
+{
+    StopAsync();
+#if __GNUC__ < 5
+    free(m_szTime);
+#endif
+    free(m_pRing);
+    free(m_pLineBuff);
+    if (NULL != m_fp)
+    {
+        fclose(m_fp);
+    }
+}
+
 int FileLogger::OpenLogFile(const std::string strLogFile)
 {
     m_fp = fopen(strLogFile.c_str(), "a+" );
@@ -57,13 +88,22 @@ int FileLogger::WriteLog(int iLev, const char* szFileName, unsigned int uiFileLi
         return 0;
     }
 
+    va_list ap;
+    if (m_bAsync)
+    {
+        // 异步模式下日志文件句柄只由后台线程访问（滚动时会关闭并重新打开），这里不能读取m_fp
+        va_start(ap, szLogStr);
+        int iResult = AsyncAppend(NULL, iLev, szFileName, uiFileLine, szFunction, szLogStr, ap);
+        va_end(ap);
+        return(iResult);
+    }
+
     if(NULL == m_fp)
     {
         std::cerr << "Write log error: no log file handle." << std::endl;
         return -1;
     }
 
-    va_list ap;
     va_start(ap, szLogStr);
     Vappend(iLev, szFileName, uiFileLine, szFunction, szLogStr, ap);
     va_end(ap);
@@ -86,13 +126,21 @@ int FileLogger::WriteLog(const std::string& strTraceId, int iLev, const char* sz
         return 0;
     }
 
+    va_list ap;
+    if (m_bAsync)
+    {
+        va_start(ap, szLogStr);
+        int iResult = AsyncAppend(&strTraceId, iLev, szFileName, uiFileLine, szFunction, szLogStr, ap);
+        va_end(ap);
+        return(iResult);
+    }
+
     if(NULL == m_fp)
     {
         std::cerr << "Write log error: no log file handle." << std::endl;
         return -1;
     }
 
-    va_list ap;
     va_start(ap, szLogStr);
     Vappend(strTraceId, iLev, szFileName, uiFileLine, szFunction, szLogStr, ap);
     va_end(ap);
@@ -246,4 +294,269 @@ int FileLogger::Vappend(const std::string& strTraceId, int iLev, const char* szF
     return 0;
 }
 
+bool FileLogger::EnableAsync(unsigned int uiBufferSize, E_OVERFLOW_POLICY eOverflowPolicy)
+{
+    if (m_bAsync)
+    {
+        return(true);
+    }
+    if (NULL == m_fp)
+    {
+        return(false);
+    }
+    unsigned long long ullCapacity = s_uiMinAsyncBufferSize;
+    while (ullCapacity < uiBufferSize)
+    {
+        ullCapacity <<= 1;
+    }
+    m_pRing = (char*)malloc(ullCapacity);
+    m_pLineBuff = (char*)malloc(s_uiMaxAsyncLineLen);
+    if (NULL == m_pRing || NULL == m_pLineBuff)
+    {
+        free(m_pRing);
+        free(m_pLineBuff);
+        m_pRing = NULL;
+        m_pLineBuff = NULL;
+        return(false);
+    }
+    m_ullRingMask = ullCapacity - 1;
+    m_eOverflowPolicy = eOverflowPolicy;
+
+    // 此后文件只由后台线程以write()写入，先清空FILE缓冲
+    fflush(m_fp);
+    struct stat stFileStat;
+    m_ullFileSize = (0 == fstat(fileno(m_fp), &stFileStat)) ? stFileStat.st_size : 0;
+    m_bStop = false;
+    m_bAsync = true;
+    try
+    {
+        m_pFlushThread = new std::thread(&FileLogger::FlushThread, this);
+    }
+    catch(std::exception& e)
+    {
+        std::cerr << "start log flush thread error: " << e.what() << std::endl;
+        m_bAsync = false;
+        return(false);
+    }
+    return(true);
+}
+
+void FileLogger::StopAsync()
+{
+    if (nullptr == m_pFlushThread)
+    {
+        return;
+    }
+    m_bStop = true;
+    {
+        std::lock_guard<std::mutex> oLock(m_mutex);
+    }
+    m_cond.notify_one();
+    m_pFlushThread->join();     // 后台线程退出前写完缓冲区中剩余的日志
+    delete m_pFlushThread;
+    m_pFlushThread = nullptr;
+    m_bAsync = false;
+}
+
+int FileLogger::AsyncAppend(const std::string* pTraceId, int iLev, const char* szFileName, unsigned int uiFileLine, const char* szFunction, const char* szLogStr, va_list ap)
+{
+    struct timeval stTime;
+    gettimeofday(&stTime, NULL);
+    if (stTime.tv_sec != m_lCachedTime)
+    {
+        struct tm stTm;
+        time_t lTime = stTime.tv_sec;
+        localtime_r(&lTime, &stTm);
+        strftime(m_szCachedTime, sizeof(m_szCachedTime), "%Y-%m-%d %H:%M:%S", &stTm);
+        m_lCachedTime = stTime.tv_sec;
+    }
+    int iLen = 0;
+    if (NULL == pTraceId)
+    {
+        iLen = snprintf(m_pLineBuff, s_uiMaxAsyncLineLen, "[%s,%ld][%s][%s:%u][%s] ",
+                m_szCachedTime, (long)stTime.tv_usec / 1000, LogLevMsg[iLev].c_str(),
+                szFileName, uiFileLine, szFunction);
+    }
+    else
+    {
+        iLen = snprintf(m_pLineBuff, s_uiMaxAsyncLineLen, "[%s,%ld][%s][%s:%u][%s][%s] ",
+                m_szCachedTime, (long)stTime.tv_usec / 1000, LogLevMsg[iLev].c_str(),
+                szFileName, uiFileLine, szFunction, pTraceId->c_str());
+    }
+    if (iLen < 0)
+    {
+        return(-1);
+    }
+    // 末尾预留换行符
+    int iAvailable = (int)s_uiMaxAsyncLineLen - 1 - iLen;
+    if (iAvailable <= 1)
+    {
+        iLen = s_uiMaxAsyncLineLen - 2;
+    }
+    else
+    {
+        int iContentLen = vsnprintf(m_pLineBuff + iLen, iAvailable, szLogStr, ap);
+        if (iContentLen > 0)
+        {
+            iLen += (iContentLen < iAvailable) ? iContentLen : (iAvailable - 1);
+        }
+    }
+    m_pLineBuff[iLen++] = '\n';
+    Push(m_pLineBuff, iLen, m_bAlwaysFlush || iLev <= Logger::ERROR);
+    ++m_uiLogNum;
+    return(0);
+}
+
+void FileLogger::Push(const char* pData, unsigned int uiLength, bool bUrgent)
+{
+    unsigned long long ullCapacity = m_ullRingMask + 1;
+    unsigned long long ullWritePos = m_ullWritePos.load(std::memory_order_relaxed);
+    auto wake = [this]()
+    {
+        // 后台线程等待时才需要唤醒，每次等待最多唤醒一次，繁忙时写日志不产生系统调用
+        if (m_bFlusherWaiting.load(std::memory_order_relaxed) && m_bFlusherWaiting.exchange(false))
+        {
+            {
+                std::lock_guard<std::mutex> oLock(m_mutex);
+            }
+            m_cond.notify_one();
+        }
+    };
+    while (ullWritePos + uiLength - m_ullReadPos.load(std::memory_order_acquire) > ullCapacity)
+    {
+        if (OVERFLOW_BLOCK != m_eOverflowPolicy || uiLength > ullCapacity)
+        {
+            m_ullDroppedNum.fetch_add(1, std::memory_order_relaxed);
+            wake();
+            return;
+        }
+        wake();
+        std::this_thread::yield();
+    }
+    unsigned long long ullOffset = ullWritePos & m_ullRingMask;
+    unsigned long long ullFirstPart = ullCapacity - ullOffset;
+    if (uiLength <= ullFirstPart)
+    {
+        memcpy(m_pRing + ullOffset, pData, uiLength);
+    }
+    else
+    {
+        memcpy(m_pRing + ullOffset, pData, ullFirstPart);
+        memcpy(m_pRing, pData + ullFirstPart, uiLength - ullFirstPart);
+    }
+    m_ullWritePos.store(ullWritePos + uiLength);    // 须与后台线程设置等待标志的顺序一致（seq_cst），否则可能漏唤醒
+    if (bUrgent || ullWritePos + uiLength - m_ullReadPos.load(std::memory_order_relaxed) >= ullCapacity / 2)
+    {
+        wake();
+    }
+}
+
+void FileLogger::FlushThread()
+{
+    while (true)
+    {
+        if (FlushRing())
+        {
+            continue;
+        }
+        if (m_bStop)
+        {
+            break;
+        }
+        std::unique_lock<std::mutex> oLock(m_mutex);
+        m_bFlusherWaiting = true;
+        if (m_ullWritePos.load() != m_ullReadPos.load(std::memory_order_relaxed) || m_bStop)
+        {
+            m_bFlusherWaiting = false;
+            continue;
+        }
+        m_cond.wait_for(oLock, std::chrono::milliseconds(s_iFlushIntervalMs));
+        m_bFlusherWaiting = false;
+    }
+}
+
+bool FileLogger::FlushRing()
+{
+    unsigned long long ullReadPos = m_ullReadPos.load(std::memory_order_relaxed);
+    unsigned long long ullWritePos = m_ullWritePos.load(std::memory_order_acquire);
+    unsigned long long ullDroppedNum = m_ullDroppedNum.load(std::memory_order_relaxed);
+    if (ullReadPos == ullWritePos && ullDroppedNum == m_ullReportedDroppedNum)
+    {
+        return(false);
+    }
+    if (NULL == m_fp)
+    {
+        ReOpen();
+    }
+
+    struct iovec aIov[3];
+    int iIovCnt = 0;
+    char szDropped[128];
+    if (ullDroppedNum != m_ullReportedDroppedNum)
+    {
+        char szTime[24];
+        struct tm stTm;
+        time_t lTime = time(NULL);
+        localtime_r(&lTime, &stTm);
+        strftime(szTime, sizeof(szTime), "%Y-%m-%d %H:%M:%S", &stTm);
+        aIov[iIovCnt].iov_base = szDropped;
+        aIov[iIovCnt].iov_len = snprintf(szDropped, sizeof(szDropped),
+                "[%s][%s] %llu log lines dropped, log buffer overflow.\n",
+                szTime, LogLevMsg[Logger::WARNING].c_str(), ullDroppedNum - m_ullReportedDroppedNum);
+        ++iIovCnt;
+        m_ullReportedDroppedNum = ullDroppedNum;
+    }
+    unsigned long long ullLength = ullWritePos - ullReadPos;
+    unsigned long long ullOffset = ullReadPos & m_ullRingMask;
+    unsigned long long ullFirstPart = m_ullRingMask + 1 - ullOffset;
+    if (ullLength > 0)
+    {
+        aIov[iIovCnt].iov_base = m_pRing + ullOffset;
+        aIov[iIovCnt].iov_len = (ullLength < ullFirstPart) ? ullLength : ullFirstPart;
+        ++iIovCnt;
+        if (ullLength > ullFirstPart)
+        {
+            aIov[iIovCnt].iov_base = m_pRing;
+            aIov[iIovCnt].iov_len = ullLength - ullFirstPart;
+            ++iIovCnt;
+        }
+    }
+
+    // 一批日志一次writev，普通文件上极少部分写入，仍按部分写入处理
+    struct iovec* pIov = aIov;
+    while (NULL != m_fp && iIovCnt > 0)
+    {
+        ssize_t iWriteLen = writev(fileno(m_fp), pIov, iIovCnt);
+        if (iWriteLen < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            break;      // 写失败（如磁盘满）的日志丢弃，避免阻塞写日志的线程
+        }
+        m_ullFileSize += iWriteLen;
+        while (iIovCnt > 0 && (size_t)iWriteLen >= pIov->iov_len)
+        {
+            iWriteLen -= pIov->iov_len;
+            ++pIov;
+            --iIovCnt;
+        }
+        if (iIovCnt > 0)
+        {
+            pIov->iov_base = (char*)pIov->iov_base + iWriteLen;
+            pIov->iov_len -= iWriteLen;
+        }
+    }
+    m_ullReadPos.store(ullWritePos, std::memory_order_release);
+
+    if (m_ullFileSize >= m_uiMaxFileSize)
+    {
+        RollOver();
+        ReOpen();
+        m_ullFileSize = 0;
+    }
+    return(true);
+}
+
 } /* namespace neb */
@@ -11,14 +11,36 @@
 #define LOGGER_FILELOGGER_HPP_
 
 #include <cstdio>
+#include <cstdarg>
 #include <string>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
 #include "Logger.hpp"
 
 namespace neb
 {
 
+/**
+ * @brief 文件日志
+ * @note 默认在调用线程中同步写文件。开启异步模式（EnableAsync()）后，日志在调用线程格式化
+ * 后写入单生产者单消费者环形缓冲区，由后台线程批量write()到文件并按文件大小滚动，此后文件
+ * 句柄只由后台线程访问。异步模式要求同一时刻只有一个线程写日志（每个Worker各自持有一个日志
+ * 实例即满足），且开启后不能fork。
+ */
 class FileLogger: public Logger
 {
+public:
+    /**
+     * @brief 异步模式下环形缓冲区满时的处理方式
+     */
+    enum E_OVERFLOW_POLICY
+    {
+        OVERFLOW_DROP       = 0,        ///< 丢弃并计数，由后台线程在日志文件中报告丢弃的条数
+        OVERFLOW_BLOCK      = 1,        ///< 等待后台线程腾出空间
+    };
+
 public:
     explicit FileLogger(
             const std::string& strLogFile,
@@ -26,13 +48,7 @@ public:
             unsigned int uiMaxFileSize = neb::gc_uiMaxLogFileSize,
             unsigned int uiMaxRollFileIndex = neb::gc_uiMaxRollLogFileIndex,
             bool bAlwaysFlush = true);
-    virtual ~FileLogger()
-    {
-#if __GNUC__ < 5
-        free(m_szTime);
-#endif
-        fclose(m_fp);
-    }
+    virtual ~FileLogger();
 
     static FileLogger* Instance(const std::string& strLogFile = "../log/default.log",
                     int iLogLev = Logger::INFO,
@@ -54,12 +70,33 @@ public:
     virtual int WriteLog(int iLev, const char* szFileName, unsigned int uiFileLine, const char* szFunction, const char* szLogStr = "info", ...);
     virtual int WriteLog(const std::string& strTraceId, int iLev, const char* szFileName, unsigned int uiFileLine, const char* szFunction, const char* szLogStr = "info", ...);
 
+    /**
+     * @brief 开启异步写日志
+     * @param uiBufferSize 环形缓冲区大小（向上取整为2的幂）
+     * @param eOverflowPolicy 缓冲区满时的处理方式
+     * @return 是否开启成功
+     */
+    bool EnableAsync(unsigned int uiBufferSize, E_OVERFLOW_POLICY eOverflowPolicy = OVERFLOW_DROP);
+
+    /**
+     * @brief 异步模式下因缓冲区满而丢弃的日志条数
+     */
+    unsigned long long GetDroppedLogNum() const
+    {
+        return(m_ullDroppedNum.load(std::memory_order_relaxed));
+    }
+
 private:
     int OpenLogFile(const std::string strLogFile);
     void ReOpen();
     void RollOver();
     int Vappend(int iLev, const char* szFileName, unsigned int uiFileLine, const char* szFunction, const char* szLogStr, va_list ap);
     int Vappend(const std::string& strTraceId, int iLev, const char* szFileName, unsigned int uiFileLine, const char* szFunction, const char* szLogStr, va_list ap);
+    int AsyncAppend(const std::string* pTraceId, int iLev, const char* szFileName, unsigned int uiFileLine, const char* szFunction, const char* szLogStr, va_list ap);
+    void Push(const char* pData, unsigned int uiLength, bool bUrgent);
+    void FlushThread();
+    bool FlushRing();
+    void StopAsync();
 
     static FileLogger* s_pInstance;
 
@@ -73,6 +110,25 @@ private:
     unsigned int m_uiMaxRollFileIndex;  // 滚动日志文件数量
     bool m_bAlwaysFlush;
     std::string m_strLogFileBase;       // 日志文件基本名（如 log/program_name.log）
+
+    // 异步模式
+    bool m_bAsync;
+    E_OVERFLOW_POLICY m_eOverflowPolicy;
+    char* m_pRing;                                      ///< 环形缓冲区，存放格式化好的日志行
+    unsigned long long m_ullRingMask;
+    std::atomic<unsigned long long> m_ullWritePos;      ///< 生产者（写日志线程）写位置
+    std::atomic<unsigned long long> m_ullReadPos;       ///< 消费者（后台线程）读位置
+    std::atomic<unsigned long long> m_ullDroppedNum;
+    unsigned long long m_ullReportedDroppedNum;
+    unsigned long long m_ullFileSize;
+    std::atomic<bool> m_bFlusherWaiting;
+    std::atomic<bool> m_bStop;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::thread* m_pFlushThread;
+    char* m_pLineBuff;                                  ///< 生产者格式化日志行的缓冲区
+    long m_lCachedTime;                                 ///< 日志时间前缀按秒缓存
+    char m_szCachedTime[24];
 };
 
 } /* namespace neb */
@@ -0,0 +1,161 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     NetLogBatch.cpp
+ * @brief    批量网络日志
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note
+ * Modify history:
+ ******************************************************************************/
+#include <cstring>
+#include <zlib.h>
+#include "NetLogBatch.hpp"
+
+namespace neb
+{
+
+// protobuf wire type
+static const uint32 s_uiWireVarint = 0;
+static const uint32 s_uiWireLengthDelimited = 2;
+
+NetLogBatch::NetLogBatch(const std::string& strNodeType, const std::string& strNodeIdentify)
+    : m_strNodeType(strNodeType), m_strNodeIdentify(strNodeIdentify), m_uiLogNum(0)
+{
+}
+
+NetLogBatch::~NetLogBatch()
+{
+}
+
+void NetLogBatch::Add(uint64 ullLogTimeMs, int iLogLevel, const char* szFileName, uint32 uiFileLine,
+        const char* szFunction, const std::string& strTraceId, const char* szLogContent)
+{
+    if (m_vecDict.empty())
+    {
+        // node_type总是dict[0]，proto3中0为默认值不编码；trace_id为0即表示无trace id
+        Intern(m_strNodeType);
+        uint32 uiNodeIdentify = Intern(m_strNodeIdentify);
+        AppendTag(m_strDict, 3, s_uiWireVarint);
+        AppendVarint(m_strDict, uiNodeIdentify);
+    }
+    uint32 uiFileName = Intern(szFileName);
+    uint32 uiFunction = Intern(szFunction);
+    uint32 uiTraceId = strTraceId.empty() ? 0 : Intern(strTraceId);
+
+    m_strEntry.clear();
+    AppendTag(m_strEntry, 1, s_uiWireVarint);
+    AppendVarint(m_strEntry, ullLogTimeMs);
+    AppendTag(m_strEntry, 2, s_uiWireVarint);
+    AppendVarint(m_strEntry, (uint64)iLogLevel);
+    AppendTag(m_strEntry, 3, s_uiWireVarint);
+    AppendVarint(m_strEntry, uiFileName);
+    AppendTag(m_strEntry, 4, s_uiWireVarint);
+    AppendVarint(m_strEntry, uiFileLine);
+    AppendTag(m_strEntry, 5, s_uiWireVarint);
+    AppendVarint(m_strEntry, uiFunction);
+    AppendBytes(m_strEntry, 6, szLogContent, (nullptr == szLogContent) ? 0 : strlen(szLogContent));
+    if (uiTraceId > 0)
+    {
+        AppendTag(m_strEntry, 7, s_uiWireVarint);
+        AppendVarint(m_strEntry, uiTraceId);
+    }
+    AppendBytes(m_strLog, 4, m_strEntry.data(), m_strEntry.size());
+    ++m_uiLogNum;
+}
+
+void NetLogBatch::Serialize(std::string& strOutput, bool bCompress) const
+{
+    strOutput.clear();
+    strOutput.reserve(GetByteSize());
+    strOutput.append(m_strDict);
+    strOutput.append(m_strLog);
+    if (!bCompress)
+    {
+        return;
+    }
+
+    uLongf ulCompressedLen = compressBound(strOutput.size());
+    std::string strCompressed;
+    strCompressed.resize(ulCompressedLen);
+    if (Z_OK != compress2((Bytef*)&strCompressed[0], &ulCompressedLen,
+            (const Bytef*)strOutput.data(), strOutput.size(), Z_BEST_SPEED)
+            || ulCompressedLen >= strOutput.size())
+    {
+        return;     // 压缩失败或压缩无收益时发送未压缩数据
+    }
+    uint32 uiOriginalSize = strOutput.size();
+    strOutput.clear();
+    AppendBytes(strOutput, 5, strCompressed.data(), ulCompressedLen);
+    AppendTag(strOutput, 6, s_uiWireVarint);
+    AppendVarint(strOutput, uiOriginalSize);
+}
+
+void NetLogBatch::Clear()
+{
+    m_uiLogNum = 0;
+    m_vecDict.clear();
+    m_mapLiteral.clear();
+    m_mapString.clear();
+    m_strDict.clear();
+    m_strLog.clear();
+}
+
+uint32 NetLogBatch::Intern(const char* szString)
+{
+    if (nullptr == szString)
+    {
+        szString = "";
+    }
+    auto iter = m_mapLiteral.find(szString);
+    if (iter != m_mapLiteral.end() && 0 == strcmp(m_vecDict[iter->second], szString))
+    {
+        return(iter->second);
+    }
+    uint32 uiIndex = Intern(std::string(szString));
+    m_mapLiteral[szString] = uiIndex;
+    return(uiIndex);
+}
+
+uint32 NetLogBatch::Intern(const std::string& strString)
+{
+    auto iter = m_mapString.find(strString);
+    if (iter != m_mapString.end())
+    {
+        return(iter->second);
+    }
+    uint32 uiIndex = m_vecDict.size();
+    auto ret = m_mapString.insert(std::make_pair(strString, uiIndex));
+    m_vecDict.push_back(ret.first->first.c_str());
+    AppendBytes(m_strDict, 1, strString.data(), strString.size());
+    return(uiIndex);
+}
+
+void NetLogBatch::AppendVarint(std::string& strOutput, uint64 ullValue)
+{
+    char szVarint[10];
+    int iLen = 0;
+    while (ullValue >= 0x80)
+    {
+        szVarint[iLen++] = (char)((ullValue & 0x7F) | 0x80);
+        ullValue >>= 7;
+    }
+    szVarint[iLen++] = (char)ullValue;
+    strOutput.append(szVarint, iLen);
+}
+
+void NetLogBatch::AppendTag(std::string& strOutput, uint32 uiField, uint32 uiWireType)
+{
+    AppendVarint(strOutput, (uiField << 3) | uiWireType);
+}
+
+void NetLogBatch::AppendBytes(std::string& strOutput, uint32 uiField, const char* pData, size_t uiLength)
+{
+    AppendTag(strOutput, uiField, s_uiWireLengthDelimited);
+    AppendVarint(strOutput, uiLength);
+    if (uiLength > 0)
+    {
+        strOutput.append(pData, uiLength);
+    }
+}
+
+} /* namespace neb */
@@ -0,0 +1,87 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     NetLogBatch.hpp
+ * @brief    批量网络日志
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note     按neb_sys.proto中TraceLogBatch的格式直接编码，日志写入时只做字符串查重和
+ * 追加编码，不逐条构造TraceLog和MsgBody。
+ * Modify history:
+ ******************************************************************************/
+#ifndef LOGGER_NETLOGBATCH_HPP_
+#define LOGGER_NETLOGBATCH_HPP_
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "Definition.hpp"
+
+namespace neb
+{
+
+/**
+ * @brief 批量网络日志
+ * @note 非线程安全，在所属Worker线程中使用。文件名和函数名通常来自__FILE__和__FUNCTION__，
+ * 按指针查重，命中后仍比较内容，兼容非字面量字符串。
+ */
+class NetLogBatch
+{
+public:
+    NetLogBatch(const std::string& strNodeType, const std::string& strNodeIdentify);
+    NetLogBatch(const NetLogBatch&) = delete;
+    NetLogBatch& operator=(const NetLogBatch&) = delete;
+    virtual ~NetLogBatch();
+
+    void Add(uint64 ullLogTimeMs, int iLogLevel, const char* szFileName, uint32 uiFileLine,
+            const char* szFunction, const std::string& strTraceId, const char* szLogContent);
+
+    uint32 GetLogNum() const
+    {
+        return(m_uiLogNum);
+    }
+
+    /**
+     * @brief 已编码的字节数（未压缩）
+     */
+    size_t GetByteSize() const
+    {
+        return(m_strDict.size() + m_strLog.size());
+    }
+
+    bool Empty() const
+    {
+        return(0 == m_uiLogNum);
+    }
+
+    /**
+     * @brief 序列化为TraceLogBatch
+     * @param[out] strOutput 序列化结果
+     * @param bCompress 是否压缩，压缩后不小于原数据时仍输出未压缩格式
+     */
+    void Serialize(std::string& strOutput, bool bCompress) const;
+
+    void Clear();
+
+private:
+    uint32 Intern(const char* szString);
+    uint32 Intern(const std::string& strString);
+
+    static void AppendVarint(std::string& strOutput, uint64 ullValue);
+    static void AppendTag(std::string& strOutput, uint32 uiField, uint32 uiWireType);
+    static void AppendBytes(std::string& strOutput, uint32 uiField, const char* pData, size_t uiLength);
+
+private:
+    std::string m_strNodeType;
+    std::string m_strNodeIdentify;
+    uint32 m_uiLogNum;
+    std::vector<const char*> m_vecDict;                         ///< 按下标存放字典字符串（指向m_mapString的键）
+    std::unordered_map<const char*, uint32> m_mapLiteral;       ///< 按指针查重
+    std::unordered_map<std::string, uint32> m_mapString;        ///< 按内容查重
+    std::string m_strDict;      ///< 已编码的dict、node_type、node_identify字段
+    std::string m_strLog;       ///< 已编码的log字段
+    std::string m_strEntry;     ///< 编码单条日志的临时缓冲区
+};
+
+} /* namespace neb */
+
+#endif /* LOGGER_NETLOGBATCH_HPP_ */
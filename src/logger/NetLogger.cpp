@@ -56,6 +56,10 @@ int NetLogger::WriteLog(int iLev, const char* szFileName, unsigned int uiFileLin
     }
     if (m_bEnableNetLogger && m_pLabor)  // TODO 当前版本Manager进程的日志不会发送到LOGGER，因为Manager并未存储除Beacon之外的节点信息
     {
+        if (m_pLabor->AddNetLog(m_strEmptyTraceId, iLev, szFileName, uiFileLine, szFunction, m_pLogBuff))
+        {
+            return 0;
+        }
         MsgBody oMsgBody;
         TraceLog oTraceLog;
         //oTraceLog.set_log_time();
@@ -93,6 +97,10 @@ int NetLogger::WriteLog(const std::string& strTraceId, int iLev, const char* szF
     }
     if (m_bEnableNetLogger && m_pLabor)
     {
+        if (m_pLabor->AddNetLog(strTraceId, iLev, szFileName, uiFileLine, szFunction, m_pLogBuff))
+        {
+            return 0;
+        }
         MsgBody oMsgBody;
         TraceLog oTraceLog;
         oTraceLog.set_node_type(m_pLabor->GetNodeInfo().strNodeType);
@@ -39,6 +39,16 @@ public:
                     const char* szFileName, unsigned int uiFileLine, const char* szFunction,
                     const char* szLogStr = "info", ...);
 
+    /**
+     * @brief 日志级别是否需要输出
+     * @note 供LOG4_*宏在求值和格式化日志参数之前判断。带trace id的日志在开启网络日志时
+     * 不受级别限制（与WriteLog()一致）。
+     */
+    bool IsLevelEnabled(int iLev, bool bWithTraceId = false) const
+    {
+        return(iLev <= m_iLogLevel || iLev <= m_iNetLogLevel || (bWithTraceId && m_bEnableNetLogger));
+    }
+
     virtual void SetLogLevel(int iLev)
     {
         m_iLogLevel = iLev;
@@ -55,6 +65,14 @@ public:
         m_bEnableNetLogger = bEnableNetLogger;
     }
 
+    /**
+     * @brief 开启异步写日志文件（见FileLogger::EnableAsync()）
+     */
+    bool EnableAsync(unsigned int uiBufferSize, FileLogger::E_OVERFLOW_POLICY eOverflowPolicy)
+    {
+        return(m_pLog->EnableAsync(uiBufferSize, eOverflowPolicy));
+    }
+
 private:
     char* m_pLogBuff;
     int m_iLogLevel;
@@ -63,6 +81,7 @@ private:
     bool m_bEnableNetLogger;
     Labor* m_pLabor;
     std::string m_strLogData;   ///< 用于提高序列化效率
+    const std::string m_strEmptyTraceId;
     std::unique_ptr<neb::FileLogger> m_pLog;
 };
 
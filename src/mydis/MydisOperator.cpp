@@ -70,7 +70,14 @@ bool MydisOperator::AddField(const std::string& strFieldName,
     }
     if (FIELD_OPERATOR_REDIS & iFieldOper)
     {
-        RedisOperator::AddRedisField(strFieldName, strFieldValue);
+        if (strFieldValue.size() > 0)
+        {
+            RedisOperator::AddRedisField(strFieldName, strFieldValue);
+        }
+        else    // 未填值的字段（含由DataProxy以数据库字段填值的Redis字段）只有字段名
+        {
+            RedisOperator::AddRedisField(strFieldName);
+        }
     }
     return (true);
 }
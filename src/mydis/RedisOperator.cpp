@@ -78,17 +78,56 @@ Mydis* RedisOperator::MakeMemOperate()
     return(m_pRedisMemRequest);
 }
 
+bool RedisOperator::MakeRespCmd(RespCmd& oRespCmd) const
+{
+    if (m_pRedisOperate == NULL)
+    {
+        return(false);
+    }
+    const std::string& strCmd = (Mydis::RedisOperate::T_READ == m_pRedisOperate->op_type())
+            ? m_pRedisOperate->redis_cmd_read() : m_pRedisOperate->redis_cmd_write();
+    if (strCmd.size() == 0)
+    {
+        return(false);
+    }
+    oRespCmd.Clear();
+    oRespCmd.Append(strCmd);
+    oRespCmd.Append(m_pRedisOperate->key_name());
+    for (int i = 0; i < m_pRedisOperate->fields_size(); ++i)
+    {
+        const Field& oField = m_pRedisOperate->fields(i);
+        oRespCmd.Append(oField.col_name());
+        // 以字段名加字段值添加的字段，值为空串（如HSET key f ""）时同样是一个参数
+        if (oField.col_value().size() > 0
+                || ((size_t)i < m_vecFieldWithValue.size() && m_vecFieldWithValue[i]))
+        {
+            oRespCmd.Append(oField.col_value());
+        }
+    }
+    return(true);
+}
+
+bool RedisOperator::AddRedisField(const std::string& strFieldName)
+{
+    Field* pField = m_pRedisOperate->add_fields();
+    pField->set_col_name(strFieldName);
+    m_vecFieldWithValue.push_back(false);
+    return(true);
+}
+
 bool RedisOperator::AddRedisField(const std::string& strFieldName, const std::string& strFieldValue)
 {
     Field* pField = m_pRedisOperate->add_fields();
     if (0 == strFieldName.size())
     {
-        pField->set_col_name(strFieldValue);
+        pField->set_col_name(strFieldValue);    // list、set等结构的元素，与只有字段名的字段一样只发送一个参数
+        m_vecFieldWithValue.push_back(false);
     }
     else
     {
         pField->set_col_name(strFieldName);
         pField->set_col_value(strFieldValue);
+        m_vecFieldWithValue.push_back(true);
     }
     return(true);
 }
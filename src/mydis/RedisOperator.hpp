@@ -10,7 +10,9 @@
 #ifndef SRC_STORAGE_REDISOPERATOR_HPP_
 #define SRC_STORAGE_REDISOPERATOR_HPP_
 
+#include <vector>
 #include "Operator.hpp"
+#include "codec/RespCmd.hpp"
 
 namespace neb
 {
@@ -43,10 +45,15 @@ public:
      * @note 当写操作Redis与数据库存储的数据字段不相等且Redis Field数量为1或Redis第一个Field的value为空时，
      * 生成的协议包支持，将数据库协议里所有field存储到Redis的Field Value中。详见MemOperator::MakeMemOperate()函数实现。
      * @param strFieldName 字段名（当不是hash结果，是list，set等结构时填写strFieldValue，不填写strFieldName）
-     * @param strFieldValue 字段值
+     * @param strFieldValue 字段值（填写strFieldName时空串同样作为一个参数发送）
      * @return 是否添加成功
      */
-    virtual bool AddRedisField(const std::string& strFieldName, const std::string& strFieldValue = "");
+    virtual bool AddRedisField(const std::string& strFieldName, const std::string& strFieldValue);
+
+    /**
+     * @brief 添加只有字段名的字段（如HGET、HDEL的field）
+     */
+    virtual bool AddRedisField(const std::string& strFieldName);
 
     virtual bool AddRedisField(const std::string& strFieldName, int32 iFieldValue);
     virtual bool AddRedisField(const std::string& strFieldName, uint32 uiFieldValue);
@@ -55,6 +62,17 @@ public:
     virtual bool AddRedisField(const std::string& strFieldName, float fFieldValue);
     virtual bool AddRedisField(const std::string& strFieldName, double dFieldValue);
 
+    /**
+     * @brief 生成直接发往Redis的命令
+     * @note 不经DataProxy直接访问Redis时使用，命令为读操作的读命令或写操作的写命令，
+     * 其后依次是key和各字段（字段名、字段值；只有字段名的字段只发送一个参数，以字段名加
+     * 字段值添加、值为空串的字段同样发送空参数）。oRespCmd引用本对象保存的数据，须在本
+     * 对象析构前发送。
+     * @param[out] oRespCmd 生成的命令
+     * @return 是否生成成功
+     */
+    bool MakeRespCmd(RespCmd& oRespCmd) const;
+
 protected:
     Mydis::RedisOperate* GetRedisOperate()
     {
@@ -70,6 +88,7 @@ private:
     Mydis* m_pRedisMemRequest;
     Mydis::RedisOperate* m_pRedisOperate;
     uint32 m_uiSectionFactor;
+    std::vector<bool> m_vecFieldWithValue;      ///< 各字段是否以字段名加字段值添加（值为空串时MakeRespCmd()仍发送）
 };
 
 } /* namespace neb */
@@ -40,7 +40,7 @@ void protobuf_AssignDesc_http_2eproto() {
       "http.proto");
   GOOGLE_CHECK(file != NULL);
   HttpMsg_descriptor_ = file->message_type(0);
-  static const int HttpMsg_offsets_[28] = {
+  static const int HttpMsg_offsets_[29] = {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(HttpMsg, type_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(HttpMsg, http_major_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(HttpMsg, http_minor_),
@@ -56,6 +56,7 @@ void protobuf_AssignDesc_http_2eproto() {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(HttpMsg, keep_alive_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(HttpMsg, path_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(HttpMsg, is_decoding_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(HttpMsg, header_block_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(HttpMsg, chunk_notice_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(HttpMsg, stream_id_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(HttpMsg, hpack_data_),
@@ -163,7 +164,7 @@ void protobuf_AddDesc_http_2eproto() {
   GOOGLE_PROTOBUF_VERIFY_VERSION;
 
   ::google::protobuf::DescriptorPool::InternalAddGeneratedFile(
-    "\n\nhttp.proto\"\251\007\n\007HttpMsg\022\014\n\004type\030\001 \001(\005\022\022"
+    "\n\nhttp.proto\"\277\007\n\007HttpMsg\022\014\n\004type\030\001 \001(\005\022\022"
     "\n\nhttp_major\030\002 \001(\005\022\022\n\nhttp_minor\030\003 \001(\005\022\026"
     "\n\016content_length\030\004 \001(\005\022\016\n\006method\030\005 \001(\005\022\023"
     "\n\013status_code\030\006 \001(\005\022\020\n\010encoding\030\007 \001(\005\022\013\n"
@@ -171,22 +172,23 @@ void protobuf_AddDesc_http_2eproto() {
     "adersEntry\022\014\n\004body\030\n \001(\014\022$\n\006params\030\013 \003(\013"
     "2\024.HttpMsg.ParamsEntry\022!\n\007upgrade\030\014 \001(\0132"
     "\020.HttpMsg.Upgrade\022\022\n\nkeep_alive\030\r \001(\002\022\014\n"
-    "\004path\030\016 \001(\t\022\023\n\013is_decoding\030\017 \001(\010\022\024\n\014chun"
-    "k_notice\030\023 \001(\010\022\021\n\tstream_id\030\024 \001(\r\022\022\n\nhpa"
-    "ck_data\030\025 \001(\t\022$\n\034adding_without_index_he"
-    "aders\030\026 \003(\t\022&\n\036deleting_without_index_he"
-    "aders\030\027 \003(\t\022\"\n\032adding_never_index_header"
-    "s\030\030 \003(\t\022$\n\034deleting_never_index_headers\030"
-    "\031 \003(\t\022!\n\031dynamic_table_update_size\030\032 \001(\r"
-    "\022\024\n\014with_huffman\030\033 \001(\010\022\035\n\025headers_frame_"
-    "padding\030\034 \001(\t\022\032\n\022data_frame_padding\030\035 \001("
-    "\t\022\"\n\032push_promise_frame_padding\030\036 \001(\t\022(\n"
-    "\010settings\030\037 \003(\0132\026.HttpMsg.SettingsEntry\032"
-    "/\n\007Upgrade\022\022\n\nis_upgrade\030\001 \001(\010\022\020\n\010protoc"
-    "ol\030\002 \001(\t\032.\n\014HeadersEntry\022\013\n\003key\030\001 \001(\t\022\r\n"
-    "\005value\030\002 \001(\t:\0028\001\032-\n\013ParamsEntry\022\013\n\003key\030\001"
-    " \001(\t\022\r\n\005value\030\002 \001(\t:\0028\001\032/\n\rSettingsEntry"
-    "\022\013\n\003key\030\001 \001(\r\022\r\n\005value\030\002 \001(\r:\0028\001b\006proto3", 960);
+    "\004path\030\016 \001(\t\022\023\n\013is_decoding\030\017 \001(\010\022\024\n\014head"
+    "er_block\030\020 \001(\014\022\024\n\014chunk_notice\030\023 \001(\010\022\021\n\t"
+    "stream_id\030\024 \001(\r\022\022\n\nhpack_data\030\025 \001(\t\022$\n\034a"
+    "dding_without_index_headers\030\026 \003(\t\022&\n\036del"
+    "eting_without_index_headers\030\027 \003(\t\022\"\n\032add"
+    "ing_never_index_headers\030\030 \003(\t\022$\n\034deletin"
+    "g_never_index_headers\030\031 \003(\t\022!\n\031dynamic_t"
+    "able_update_size\030\032 \001(\r\022\024\n\014with_huffman\030\033"
+    " \001(\010\022\035\n\025headers_frame_padding\030\034 \001(\t\022\032\n\022d"
+    "ata_frame_padding\030\035 \001(\t\022\"\n\032push_promise_"
+    "frame_padding\030\036 \001(\t\022(\n\010settings\030\037 \003(\0132\026."
+    "HttpMsg.SettingsEntry\032/\n\007Upgrade\022\022\n\nis_u"
+    "pgrade\030\001 \001(\010\022\020\n\010protocol\030\002 \001(\t\032.\n\014Header"
+    "sEntry\022\013\n\003key\030\001 \001(\t\022\r\n\005value\030\002 \001(\t:\0028\001\032-"
+    "\n\013ParamsEntry\022\013\n\003key\030\001 \001(\t\022\r\n\005value\030\002 \001("
+    "\t:\0028\001\032/\n\rSettingsEntry\022\013\n\003key\030\001 \001(\r\022\r\n\005v"
+    "alue\030\002 \001(\r:\0028\001b\006proto3", 982);
   ::google::protobuf::MessageFactory::InternalRegisterGeneratedFile(
     "http.proto", &protobuf_RegisterTypes);
   HttpMsg::default_instance_ = new HttpMsg();
@@ -494,6 +496,7 @@ const int HttpMsg::kUpgradeFieldNumber;
 const int HttpMsg::kKeepAliveFieldNumber;
 const int HttpMsg::kPathFieldNumber;
 const int HttpMsg::kIsDecodingFieldNumber;
+const int HttpMsg::kHeaderBlockFieldNumber;
 const int HttpMsg::kChunkNoticeFieldNumber;
 const int HttpMsg::kStreamIdFieldNumber;
 const int HttpMsg::kHpackDataFieldNumber;
@@ -553,6 +556,7 @@ void HttpMsg::SharedCtor() {
   keep_alive_ = 0;
   path_.UnsafeSetDefault(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
   is_decoding_ = false;
+  header_block_.UnsafeSetDefault(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
   chunk_notice_ = false;
   stream_id_ = 0u;
   hpack_data_.UnsafeSetDefault(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
@@ -576,6 +580,7 @@ void HttpMsg::SharedDtor() {
   url_.DestroyNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
   body_.DestroyNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
   path_.DestroyNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
+  header_block_.DestroyNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
   hpack_data_.DestroyNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
   headers_frame_padding_.DestroyNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
   data_frame_padding_.DestroyNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
@@ -637,6 +642,7 @@ void HttpMsg::Clear() {
   upgrade_ = NULL;
   keep_alive_ = 0;
   path_.ClearToEmptyNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
+  header_block_.ClearToEmptyNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
   stream_id_ = 0u;
   hpack_data_.ClearToEmptyNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
   dynamic_table_update_size_ = 0u;
@@ -919,6 +925,19 @@ bool HttpMsg::MergePartialFromCodedStream(
         } else {
           goto handle_unusual;
         }
+        if (input->ExpectTag(130)) goto parse_header_block;
+        break;
+      }
+
+      // optional bytes header_block = 16;
+      case 16: {
+        if (tag == 130) {
+         parse_header_block:
+          DO_(::google::protobuf::internal::WireFormatLite::ReadBytes(
+                input, this->mutable_header_block()));
+        } else {
+          goto handle_unusual;
+        }
         if (input->ExpectTag(152)) goto parse_chunk_notice;
         break;
       }
@@ -1357,6 +1376,12 @@ void HttpMsg::SerializeWithCachedSizes(
     ::google::protobuf::internal::WireFormatLite::WriteBool(15, this->is_decoding(), output);
   }
 
+  // optional bytes header_block = 16;
+  if (this->header_block().size() > 0) {
+    ::google::protobuf::internal::WireFormatLite::WriteBytesMaybeAliased(
+      16, this->header_block(), output);
+  }
+
   // optional bool chunk_notice = 19;
   if (this->chunk_notice() != 0) {
     ::google::protobuf::internal::WireFormatLite::WriteBool(19, this->chunk_notice(), output);
@@ -1697,6 +1722,13 @@ void HttpMsg::SerializeWithCachedSizes(
     target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(15, this->is_decoding(), target);
   }
 
+  // optional bytes header_block = 16;
+  if (this->header_block().size() > 0) {
+    target =
+      ::google::protobuf::internal::WireFormatLite::WriteBytesToArray(
+        16, this->header_block(), target);
+  }
+
   // optional bool chunk_notice = 19;
   if (this->chunk_notice() != 0) {
     target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(19, this->chunk_notice(), target);
@@ -1939,6 +1971,13 @@ int HttpMsg::ByteSize() const {
     total_size += 1 + 1;
   }
 
+  // optional bytes header_block = 16;
+  if (this->header_block().size() > 0) {
+    total_size += 2 +
+      ::google::protobuf::internal::WireFormatLite::BytesSize(
+        this->header_block());
+  }
+
   // optional bool chunk_notice = 19;
   if (this->chunk_notice() != 0) {
     total_size += 2 + 1;
@@ -2135,6 +2174,10 @@ void HttpMsg::MergeFrom(const HttpMsg& from) {
   if (from.is_decoding() != 0) {
     set_is_decoding(from.is_decoding());
   }
+  if (from.header_block().size() > 0) {
+
+    header_block_.AssignWithDefault(&::google::protobuf::internal::GetEmptyStringAlreadyInited(), from.header_block_);
+  }
   if (from.chunk_notice() != 0) {
     set_chunk_notice(from.chunk_notice());
   }
@@ -2204,6 +2247,7 @@ void HttpMsg::InternalSwap(HttpMsg* other) {
   std::swap(keep_alive_, other->keep_alive_);
   path_.Swap(&other->path_);
   std::swap(is_decoding_, other->is_decoding_);
+  header_block_.Swap(&other->header_block_);
   std::swap(chunk_notice_, other->chunk_notice_);
   std::swap(stream_id_, other->stream_id_);
   hpack_data_.Swap(&other->hpack_data_);
@@ -2626,6 +2670,50 @@ void HttpMsg::clear_is_decoding() {
   // @@protoc_insertion_point(field_set:HttpMsg.is_decoding)
 }
 
+// optional bytes header_block = 16;
+void HttpMsg::clear_header_block() {
+  header_block_.ClearToEmptyNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
+}
+ const ::std::string& HttpMsg::header_block() const {
+  // @@protoc_insertion_point(field_get:HttpMsg.header_block)
+  return header_block_.GetNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
+}
+ void HttpMsg::set_header_block(const ::std::string& value) {
+  
+  header_block_.SetNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited(), value);
+  // @@protoc_insertion_point(field_set:HttpMsg.header_block)
+}
+ void HttpMsg::set_header_block(const char* value) {
+  
+  header_block_.SetNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited(), ::std::string(value));
+  // @@protoc_insertion_point(field_set_char:HttpMsg.header_block)
+}
+ void HttpMsg::set_header_block(const void* value, size_t size) {
+  
+  header_block_.SetNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited(),
+      ::std::string(reinterpret_cast<const char*>(value), size));
+  // @@protoc_insertion_point(field_set_pointer:HttpMsg.header_block)
+}
+ ::std::string* HttpMsg::mutable_header_block() {
+  
+  // @@protoc_insertion_point(field_mutable:HttpMsg.header_block)
+  return header_block_.MutableNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
+}
+ ::std::string* HttpMsg::release_header_block() {
+  // @@protoc_insertion_point(field_release:HttpMsg.header_block)
+  
+  return header_block_.ReleaseNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
+}
+ void HttpMsg::set_allocated_header_block(::std::string* header_block) {
+  if (header_block != NULL) {
+    
+  } else {
+    
+  }
+  header_block_.SetAllocatedNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited(), header_block);
+  // @@protoc_insertion_point(field_set_allocated:HttpMsg.header_block)
+}
+
 // optional bool chunk_notice = 19;
 void HttpMsg::clear_chunk_notice() {
   chunk_notice_ = false;
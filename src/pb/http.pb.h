@@ -311,6 +311,17 @@ class HttpMsg : public ::google::protobuf::Message /* @@protoc_insertion_point(c
   bool is_decoding() const;
   void set_is_decoding(bool value);
 
+  // optional bytes header_block = 16;
+  void clear_header_block();
+  static const int kHeaderBlockFieldNumber = 16;
+  const ::std::string& header_block() const;
+  void set_header_block(const ::std::string& value);
+  void set_header_block(const char* value);
+  void set_header_block(const void* value, size_t size);
+  ::std::string* mutable_header_block();
+  ::std::string* release_header_block();
+  void set_allocated_header_block(::std::string* header_block);
+
   // optional bool chunk_notice = 19;
   void clear_chunk_notice();
   static const int kChunkNoticeFieldNumber = 19;
@@ -491,6 +502,7 @@ class HttpMsg : public ::google::protobuf::Message /* @@protoc_insertion_point(c
       0 > params_;
   ::HttpMsg_Upgrade* upgrade_;
   ::google::protobuf::internal::ArenaStringPtr path_;
+  ::google::protobuf::internal::ArenaStringPtr header_block_;
   ::google::protobuf::internal::ArenaStringPtr hpack_data_;
   ::google::protobuf::uint32 stream_id_;
   bool is_decoding_;
@@ -925,6 +937,50 @@ inline void HttpMsg::set_is_decoding(bool value) {
   // @@protoc_insertion_point(field_set:HttpMsg.is_decoding)
 }
 
+// optional bytes header_block = 16;
+inline void HttpMsg::clear_header_block() {
+  header_block_.ClearToEmptyNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
+}
+inline const ::std::string& HttpMsg::header_block() const {
+  // @@protoc_insertion_point(field_get:HttpMsg.header_block)
+  return header_block_.GetNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
+}
+inline void HttpMsg::set_header_block(const ::std::string& value) {
+  
+  header_block_.SetNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited(), value);
+  // @@protoc_insertion_point(field_set:HttpMsg.header_block)
+}
+inline void HttpMsg::set_header_block(const char* value) {
+  
+  header_block_.SetNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited(), ::std::string(value));
+  // @@protoc_insertion_point(field_set_char:HttpMsg.header_block)
+}
+inline void HttpMsg::set_header_block(const void* value, size_t size) {
+  
+  header_block_.SetNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited(),
+      ::std::string(reinterpret_cast<const char*>(value), size));
+  // @@protoc_insertion_point(field_set_pointer:HttpMsg.header_block)
+}
+inline ::std::string* HttpMsg::mutable_header_block() {
+  
+  // @@protoc_insertion_point(field_mutable:HttpMsg.header_block)
+  return header_block_.MutableNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
+}
+inline ::std::string* HttpMsg::release_header_block() {
+  // @@protoc_insertion_point(field_release:HttpMsg.header_block)
+  
+  return header_block_.ReleaseNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
+}
+inline void HttpMsg::set_allocated_header_block(::std::string* header_block) {
+  if (header_block != NULL) {
+    
+  } else {
+    
+  }
+  header_block_.SetAllocatedNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited(), header_block);
+  // @@protoc_insertion_point(field_set_allocated:HttpMsg.header_block)
+}
+
 // optional bool chunk_notice = 19;
 inline void HttpMsg::clear_chunk_notice() {
   chunk_notice_ = false;
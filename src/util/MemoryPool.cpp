@@ -0,0 +1,67 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     MemoryPool.cpp
+ * @brief    定长内存块回收池
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note
+ * Modify history:
+ ******************************************************************************/
+#include <vector>
+#include "MemoryPool.hpp"
+
+namespace neb
+{
+
+static const size_t s_uiSizeClassNum = MemoryPool::s_uiMaxBlockSize / MemoryPool::s_uiAlignment;
+
+// 各级空闲内存块，每个线程一份；与发送缓冲区回收池相同，池本身不随线程退出析构
+static thread_local std::vector<void*>* s_aFreeBlock[s_uiSizeClassNum] = {nullptr};
+
+void* MemoryPool::Allocate(size_t uiSize)
+{
+    if (0 == uiSize || uiSize > s_uiMaxBlockSize)
+    {
+        return(::operator new(uiSize));
+    }
+    size_t uiClass = (uiSize - 1) / s_uiAlignment;
+    std::vector<void*>* pFreeBlock = s_aFreeBlock[uiClass];
+    if (nullptr != pFreeBlock && !pFreeBlock->empty())
+    {
+        void* pBlock = pFreeBlock->back();
+        pFreeBlock->pop_back();
+        return(pBlock);
+    }
+    return(::operator new((uiClass + 1) * s_uiAlignment));
+}
+
+void MemoryPool::Deallocate(void* pBlock, size_t uiSize)
+{
+    if (nullptr == pBlock)
+    {
+        return;
+    }
+    if (0 == uiSize || uiSize > s_uiMaxBlockSize)
+    {
+        ::operator delete(pBlock);
+        return;
+    }
+    size_t uiClass = (uiSize - 1) / s_uiAlignment;
+    std::vector<void*>* pFreeBlock = s_aFreeBlock[uiClass];
+    if (nullptr == pFreeBlock)
+    {
+        pFreeBlock = new std::vector<void*>();
+        pFreeBlock->reserve(64);
+        s_aFreeBlock[uiClass] = pFreeBlock;
+    }
+    if (pFreeBlock->size() < s_uiMaxPooledBlock)
+    {
+        pFreeBlock->push_back(pBlock);
+    }
+    else
+    {
+        ::operator delete(pBlock);
+    }
+}
+
+} /* namespace neb */
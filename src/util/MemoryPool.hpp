@@ -0,0 +1,81 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     MemoryPool.hpp
+ * @brief    定长内存块回收池
+ * @author   Bwar
+ * @date:    2026年10月17日
+ * @note     按16字节对齐分级回收释放的内存块，分配时优先复用同级内存块。用于连接等
+ * 频繁创建销毁的对象，连接建立和关闭在稳定状态下不再调用系统内存分配。
+ * Modify history:
+ ******************************************************************************/
+#ifndef SRC_UTIL_MEMORYPOOL_HPP_
+#define SRC_UTIL_MEMORYPOOL_HPP_
+
+#include <cstddef>
+#include <new>
+
+namespace neb
+{
+
+/**
+ * @brief 定长内存块回收池
+ * @note 每个线程一份（Worker线程模式下每个Worker一份），无锁。在一个线程分配、另一个
+ * 线程释放的内存块归入释放线程的回收池，不影响正确性。超过s_uiMaxBlockSize的内存
+ * 直接向系统申请和释放。
+ */
+class MemoryPool
+{
+public:
+    static void* Allocate(size_t uiSize);
+    static void Deallocate(void* pBlock, size_t uiSize);
+
+    static const size_t s_uiAlignment = 16;
+    static const size_t s_uiMaxBlockSize = 4096;        ///< 回收的最大内存块
+    static const size_t s_uiMaxPooledBlock = 4096;      ///< 每级最多保留的空闲内存块数
+};
+
+/**
+ * @brief 从MemoryPool分配内存的分配器
+ * @note 用于std::allocate_shared()，对象与shared_ptr控制块在同一内存块中。
+ */
+template <typename T>
+class PoolAllocator
+{
+public:
+    typedef T value_type;
+
+    PoolAllocator() noexcept
+    {
+    }
+
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) noexcept
+    {
+    }
+
+    T* allocate(size_t uiNum)
+    {
+        return(static_cast<T*>(MemoryPool::Allocate(uiNum * sizeof(T))));
+    }
+
+    void deallocate(T* pObject, size_t uiNum) noexcept
+    {
+        MemoryPool::Deallocate(pObject, uiNum * sizeof(T));
+    }
+};
+
+template <typename T, typename U>
+inline bool operator==(const PoolAllocator<T>&, const PoolAllocator<U>&) noexcept
+{
+    return(true);
+}
+
+template <typename T, typename U>
+inline bool operator!=(const PoolAllocator<T>&, const PoolAllocator<U>&) noexcept
+{
+    return(false);
+}
+
+} /* namespace neb */
+
+#endif /* SRC_UTIL_MEMORYPOOL_HPP_ */
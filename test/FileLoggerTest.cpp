@@ -0,0 +1,142 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     FileLoggerTest.cpp
+ * @brief    FileLogger异步模式下后台线程滚动日志文件时不丢日志
+ * @author   Bwar
+ * @date:    2026年10月18日
+ * @note     日志文件上限设得很小，写日志线程持续写带序号的日志，后台线程频繁关闭、改名、
+ * 重新打开日志文件。关闭日志实例后读取当前文件和全部滚动文件，每个序号应恰好出现一次。
+ * Modify history:
+ ******************************************************************************/
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "logger/FileLogger.hpp"
+
+using namespace neb;
+
+static int s_iFailed = 0;
+
+#define CHECK(cond) \
+    do \
+    { \
+        if (!(cond)) \
+        { \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            ++s_iFailed; \
+        } \
+    } while(0)
+
+static const char* s_szMark = "rollover test seq ";
+
+/**
+ * @brief 读取日志文件中的序号，返回读到的行数
+ */
+static int ReadSeq(const std::string& strFile, std::vector<int>& vecSeen)
+{
+    std::ifstream oFile(strFile);
+    if (!oFile.is_open())
+    {
+        return(-1);
+    }
+    int iLines = 0;
+    std::string strLine;
+    while (std::getline(oFile, strLine))
+    {
+        size_t uiPos = strLine.find(s_szMark);
+        if (std::string::npos == uiPos)
+        {
+            continue;
+        }
+        int iSeq = atoi(strLine.c_str() + uiPos + strlen(s_szMark));
+        if (iSeq >= 0 && iSeq < (int)vecSeen.size())
+        {
+            ++vecSeen[iSeq];
+        }
+        ++iLines;
+    }
+    return(iLines);
+}
+
+static void TestAsyncRollOver(const std::string& strDir)
+{
+    const int iLogNum = 20000;
+    const unsigned int uiMaxFileSize = 16 * 1024;
+    const unsigned int uiMaxRollFileIndex = 1000;      // 足够保留全部滚动文件
+    std::string strLogFile = strDir + "/rollover.log";
+    unsigned long long ullDropped = 0;
+    {
+        FileLogger oLogger(strLogFile, Logger::INFO, uiMaxFileSize, uiMaxRollFileIndex, false);
+        CHECK(oLogger.EnableAsync(64 * 1024, FileLogger::OVERFLOW_BLOCK));
+        std::string strTraceId = "trace";
+        for (int i = 0; i < iLogNum; ++i)
+        {
+            if (i % 2 == 0)
+            {
+                oLogger.WriteLog(Logger::INFO, __FILE__, __LINE__, __FUNCTION__, "%s%d", s_szMark, i);
+            }
+            else
+            {
+                oLogger.WriteLog(strTraceId, Logger::INFO, __FILE__, __LINE__, __FUNCTION__, "%s%d", s_szMark, i);
+            }
+        }
+        ullDropped = oLogger.GetDroppedLogNum();
+    }   // 析构时后台线程写完剩余日志
+    CHECK(0 == ullDropped);
+
+    std::vector<int> vecSeen(iLogNum, 0);
+    int iLines = ReadSeq(strLogFile, vecSeen);
+    CHECK(iLines >= 0);
+    unlink(strLogFile.c_str());
+    unsigned int uiRollFiles = 0;
+    for (unsigned int i = 1; i <= uiMaxRollFileIndex; ++i)
+    {
+        std::string strRollFile = strLogFile + "." + std::to_string(i);
+        int iRollLines = ReadSeq(strRollFile, vecSeen);
+        if (iRollLines < 0)
+        {
+            continue;
+        }
+        iLines += iRollLines;
+        ++uiRollFiles;
+        unlink(strRollFile.c_str());
+    }
+    CHECK(uiRollFiles > 10);            // 确实发生了多次滚动
+    CHECK(uiRollFiles < uiMaxRollFileIndex);
+    CHECK(iLogNum == iLines);
+    int iMissing = 0;
+    int iDuplicated = 0;
+    for (int i = 0; i < iLogNum; ++i)
+    {
+        iMissing += (0 == vecSeen[i]) ? 1 : 0;
+        iDuplicated += (vecSeen[i] > 1) ? 1 : 0;
+    }
+    if (iMissing > 0 || iDuplicated > 0)
+    {
+        fprintf(stderr, "%d log lines missing, %d duplicated\n", iMissing, iDuplicated);
+    }
+    CHECK(0 == iMissing && 0 == iDuplicated);
+}
+
+int main()
+{
+    char szDir[] = "/tmp/neb_file_logger_test_XXXXXX";
+    if (NULL == mkdtemp(szDir))
+    {
+        perror("mkdtemp");
+        return(1);
+    }
+    TestAsyncRollOver(szDir);
+    rmdir(szDir);
+    if (s_iFailed > 0)
+    {
+        printf("FileLoggerTest: %d checks failed\n", s_iFailed);
+        return(1);
+    }
+    printf("FileLoggerTest: passed\n");
+    return(0);
+}
@@ -0,0 +1,368 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     HpackTest.cpp
+ * @brief    HPACK整数、字符串、头块编解码与rfc7541附录C示例的一致性
+ * @author   Bwar
+ * @date:    2026年10月18日
+ * @note     C.1整数表示；C.2各种头字段表示；C.3、C.4同一连接上的三个请求（不用
+ * 和使用哈夫曼编码）；C.5、C.6动态表上限为256字节时的三个响应（含淘汰）。
+ * 解码逐字节使用rfc中的头块并核对头字段和动态表大小；编码对只含一个头字段的
+ * 头块核对输出字节，多个头字段时核对编码后能还原（HttpMsg的headers为map，
+ * 编码顺序不固定）。
+ * Modify history:
+ ******************************************************************************/
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <utility>
+#include <unistd.h>
+#include "codec/http2/CodecHttp2.hpp"
+#include "codec/http2/Http2Frame.hpp"
+#include "codec/http2/Http2Header.hpp"
+#include "logger/NetLogger.hpp"
+#include "util/CBuffer.hpp"
+
+using namespace neb;
+
+static int s_iFailed = 0;
+
+#define CHECK(cond) \
+    do \
+    { \
+        if (!(cond)) \
+        { \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            ++s_iFailed; \
+        } \
+    } while(0)
+
+typedef std::vector<std::pair<std::string, std::string>> HeaderList;
+
+/**
+ * @brief 取解码动态表的大小（rfc7541 4.1）
+ */
+class HpackCodec: public CodecHttp2
+{
+public:
+    HpackCodec(std::shared_ptr<NetLogger> pLogger)
+        : CodecHttp2(pLogger, CODEC_HTTP)
+    {
+    }
+
+    uint32 GetDecodingTableSize() const
+    {
+        uint32 uiSize = 0;
+        const std::string* pName = nullptr;
+        const std::string* pValue = nullptr;
+        for (size_t i = Http2Header::sc_uiMaxStaticTableIndex + 1;
+                GetDecodingTableEntry(i, pName, pValue); ++i)
+        {
+            uiSize += pName->size() + pValue->size() + 32;
+        }
+        return(uiSize);
+    }
+};
+
+static std::string FromHex(const char* szHex)
+{
+    std::string strBytes;
+    std::string strDigit;
+    for (const char* p = szHex; *p != '\0'; ++p)
+    {
+        if (*p == ' ')
+        {
+            continue;
+        }
+        strDigit.push_back(*p);
+        if (strDigit.size() == 2)
+        {
+            strBytes.push_back((char)strtol(strDigit.c_str(), NULL, 16));
+            strDigit.clear();
+        }
+    }
+    return(strBytes);
+}
+
+static std::string ToHex(const char* pData, size_t uiLength)
+{
+    static const char sc_szDigit[] = "0123456789abcdef";
+    std::string strHex;
+    for (size_t i = 0; i < uiLength; ++i)
+    {
+        strHex.push_back(sc_szDigit[(pData[i] >> 4) & 0x0F]);
+        strHex.push_back(sc_szDigit[pData[i] & 0x0F]);
+    }
+    return(strHex);
+}
+
+static bool Decode(HpackCodec& oCodec, const std::string& strBlock, const HeaderList& vecExpect)
+{
+    CBuffer oBuff;
+    oBuff.Write(strBlock.data(), strBlock.size());
+    HttpMsg oHttpMsg;
+    if (CODEC_STATUS_PART_OK != oCodec.UnpackHeader(oBuff.GetWriteIndex(), &oBuff, oHttpMsg))
+    {
+        return(false);
+    }
+    if (oBuff.ReadableBytes() != 0 || (size_t)oHttpMsg.headers_size() != vecExpect.size())
+    {
+        return(false);
+    }
+    for (auto& oHeader : vecExpect)
+    {
+        auto iter = oHttpMsg.headers().find(oHeader.first);
+        if (iter == oHttpMsg.headers().end() || iter->second != oHeader.second)
+        {
+            fprintf(stderr, "header %s mismatch\n", oHeader.first.c_str());
+            return(false);
+        }
+    }
+    return(true);
+}
+
+static std::string Encode(HpackCodec& oCodec, const HttpMsg& oHttpMsg)
+{
+    CBuffer oBuff;
+    oCodec.PackHeader(oHttpMsg, &oBuff);
+    return(ToHex(oBuff.GetRawReadBuffer(), oBuff.ReadableBytes()));
+}
+
+static void TestInteger()
+{
+    const struct
+    {
+        size_t uiValue;
+        size_t uiPrefix;
+        const char* szHex;
+    } astCase[] = {
+        {10, H2_HPACK_PREFIX_5_BITS, "0a"},          // C.1.1
+        {1337, H2_HPACK_PREFIX_5_BITS, "1f9a0a"},    // C.1.2
+        {42, H2_HPACK_PREFIX_8_BITS, "2a"},          // C.1.3
+        {31, H2_HPACK_PREFIX_5_BITS, "1f00"},
+        {127, H2_HPACK_PREFIX_7_BITS, "7f00"},
+        {4096, H2_HPACK_PREFIX_7_BITS, "7f811f"},
+    };
+    for (auto& stCase : astCase)
+    {
+        CBuffer oBuff;
+        Http2Header::EncodeInt(stCase.uiValue, stCase.uiPrefix, 0, &oBuff);
+        CHECK(ToHex(oBuff.GetRawReadBuffer(), oBuff.ReadableBytes()) == stCase.szHex);
+        CHECK((int)stCase.uiValue == Http2Header::DecodeInt((int)stCase.uiPrefix, &oBuff));
+        CHECK(0 == oBuff.ReadableBytes());
+    }
+    // 前缀之外的标志位不影响解码
+    CBuffer oBuff;
+    Http2Header::EncodeInt(1337, H2_HPACK_PREFIX_5_BITS, (char)H2_HPACK_CONDITION_DYNAMIC_TABLE_SIZE_UPDATE, &oBuff);
+    CHECK(1337 == Http2Header::DecodeInt(H2_HPACK_PREFIX_5_BITS, &oBuff));
+}
+
+static void TestStringLiteral()
+{
+    CBuffer oBuff;
+    Http2Header::EncodeStringLiteral("custom-key", &oBuff);
+    CHECK("0a637573746f6d2d6b6579" == ToHex(oBuff.GetRawReadBuffer(), oBuff.ReadableBytes()));
+    Http2Header::EncodeStringLiteralWithHuffman("www.example.com", &oBuff);
+    Http2Header::EncodeStringLiteralWithHuffman("0", &oBuff);     // 哈夫曼编码不更短时按原文
+    std::string strLiteral;
+    bool bWithHuffman = false;      // 只在遇到哈夫曼编码时置为true，由调用方累计整个头块
+    CHECK(Http2Header::DecodeStringLiteral(&oBuff, strLiteral, bWithHuffman));
+    CHECK("custom-key" == strLiteral && !bWithHuffman);
+    size_t uiReadIndex = oBuff.GetReadIndex();
+    CHECK("8cf1e3c2e5f23a6ba0ab90f4ff" == ToHex(oBuff.GetRawReadBuffer(), 13));
+    CHECK(Http2Header::DecodeStringLiteral(&oBuff, strLiteral, bWithHuffman));
+    CHECK("www.example.com" == strLiteral && bWithHuffman);
+    CHECK(oBuff.GetReadIndex() == uiReadIndex + 13);
+    bWithHuffman = false;
+    CHECK(Http2Header::DecodeStringLiteral(&oBuff, strLiteral, bWithHuffman));
+    CHECK("0" == strLiteral && !bWithHuffman);
+}
+
+static void TestHeaderField(std::shared_ptr<NetLogger> pLogger)
+{
+    // C.2.1 Literal Header Field with Indexing
+    HpackCodec oDecoder(pLogger);
+    CHECK(Decode(oDecoder, FromHex("400a 6375 7374 6f6d 2d6b 6579 0d63 7573 746f 6d2d 6865 6164 6572"),
+            {{"custom-key", "custom-header"}}));
+    CHECK(55 == oDecoder.GetDecodingTableSize());
+
+    // C.2.2 Literal Header Field without Indexing
+    HpackCodec oDecoder2(pLogger);
+    CHECK(Decode(oDecoder2, FromHex("040c 2f73 616d 706c 652f 7061 7468"), {{":path", "/sample/path"}}));
+    CHECK(0 == oDecoder2.GetDecodingTableSize());
+
+    // C.2.3 Literal Header Field Never Indexed
+    CHECK(Decode(oDecoder2, FromHex("1008 7061 7373 776f 7264 0673 6563 7265 74"), {{"password", "secret"}}));
+    CHECK(0 == oDecoder2.GetDecodingTableSize());
+
+    // C.2.4 Indexed Header Field
+    CHECK(Decode(oDecoder2, FromHex("82"), {{":method", "GET"}}));
+    CHECK(0 == oDecoder2.GetDecodingTableSize());
+
+    // 超出静态表和动态表的索引是COMPRESSION_ERROR
+    CHECK(!Decode(oDecoder2, FromHex("be"), {}));
+
+    HpackCodec oEncoder(pLogger);
+    HttpMsg oHttpMsg;
+    (*oHttpMsg.mutable_headers())["custom-key"] = "custom-header";
+    CHECK("400a637573746f6d2d6b65790d637573746f6d2d686561646572" == Encode(oEncoder, oHttpMsg));
+    CHECK("be" == Encode(oEncoder, oHttpMsg));
+    HttpMsg oHttpMsg2;
+    (*oHttpMsg2.mutable_headers())[":method"] = "GET";
+    CHECK("82" == Encode(oEncoder, oHttpMsg2));
+}
+
+static void TestRequest(std::shared_ptr<NetLogger> pLogger)
+{
+    const HeaderList vecRequest1 = {{":method", "GET"}, {":scheme", "http"}, {":path", "/"},
+            {":authority", "www.example.com"}};
+    HeaderList vecRequest2 = vecRequest1;
+    vecRequest2.push_back({"cache-control", "no-cache"});
+    const HeaderList vecRequest3 = {{":method", "GET"}, {":scheme", "https"}, {":path", "/index.html"},
+            {":authority", "www.example.com"}, {"custom-key", "custom-value"}};
+
+    // C.3 Request Examples without Huffman Coding
+    HpackCodec oDecoder(pLogger);
+    CHECK(Decode(oDecoder, FromHex("8286 8441 0f77 7777 2e65 7861 6d70 6c65 2e63 6f6d"), vecRequest1));
+    CHECK(57 == oDecoder.GetDecodingTableSize());
+    CHECK(Decode(oDecoder, FromHex("8286 84be 5808 6e6f 2d63 6163 6865"), vecRequest2));
+    CHECK(110 == oDecoder.GetDecodingTableSize());
+    CHECK(Decode(oDecoder, FromHex("8287 85bf 400a 6375 7374 6f6d 2d6b 6579 0c63 7573 746f 6d2d 7661 6c75 65"),
+            vecRequest3));
+    CHECK(164 == oDecoder.GetDecodingTableSize());
+
+    // C.4 Request Examples with Huffman Coding
+    HpackCodec oHuffmanDecoder(pLogger);
+    CHECK(Decode(oHuffmanDecoder, FromHex("8286 8441 8cf1 e3c2 e5f2 3a6b a0ab 90f4 ff"), vecRequest1));
+    CHECK(57 == oHuffmanDecoder.GetDecodingTableSize());
+    CHECK(Decode(oHuffmanDecoder, FromHex("8286 84be 5886 a8eb 1064 9cbf"), vecRequest2));
+    CHECK(110 == oHuffmanDecoder.GetDecodingTableSize());
+    CHECK(Decode(oHuffmanDecoder, FromHex("8287 85bf 4088 25a8 49e9 5ba9 7d7f 8925 a849 e95b b8e8 b4bf"),
+            vecRequest3));
+    CHECK(164 == oHuffmanDecoder.GetDecodingTableSize());
+
+    // 本端编码的同一组请求能被解码，动态表与对端一致，重复的请求全部编码为索引
+    const HeaderList* apRequest[] = {&vecRequest1, &vecRequest2, &vecRequest3};
+    for (int i = 0; i < 2; ++i)
+    {
+        bool bWithHuffman = (i == 1);
+        HpackCodec oEncoder(pLogger);
+        HpackCodec oPeer(pLogger);
+        for (auto* pRequest : apRequest)
+        {
+            HttpMsg oHttpMsg;
+            oHttpMsg.set_with_huffman(bWithHuffman);
+            for (auto& oHeader : *pRequest)
+            {
+                (*oHttpMsg.mutable_headers())[oHeader.first] = oHeader.second;
+            }
+            CHECK(Decode(oPeer, FromHex(Encode(oEncoder, oHttpMsg).c_str()), *pRequest));
+        }
+        CHECK(164 == oPeer.GetDecodingTableSize());
+        HttpMsg oHttpMsg;
+        oHttpMsg.set_with_huffman(bWithHuffman);
+        for (auto& oHeader : vecRequest3)
+        {
+            (*oHttpMsg.mutable_headers())[oHeader.first] = oHeader.second;
+        }
+        std::string strBlock = FromHex(Encode(oEncoder, oHttpMsg).c_str());
+        CHECK(5 == strBlock.size());
+        CHECK(Decode(oPeer, strBlock, vecRequest3));
+    }
+}
+
+static void TestResponse(std::shared_ptr<NetLogger> pLogger)
+{
+    const HeaderList vecResponse1 = {{":status", "302"}, {"cache-control", "private"},
+            {"date", "Mon, 21 Oct 2013 20:13:21 GMT"}, {"location", "https://www.example.com"}};
+    HeaderList vecResponse2 = vecResponse1;
+    vecResponse2[0].second = "307";
+    const HeaderList vecResponse3 = {{":status", "200"}, {"cache-control", "private"},
+            {"date", "Mon, 21 Oct 2013 20:13:22 GMT"}, {"location", "https://www.example.com"},
+            {"content-encoding", "gzip"},
+            {"set-cookie", "foo=ASDJKHQKBZXOQWEOPIUAXQWEOIU; max-age=3600; version=1"}};
+    // 附录C.5、C.6的动态表上限为256，以头块开头的动态表大小更新（3fe101）设置
+    const std::string strTableSize = FromHex("3fe101");
+
+    // C.5 Response Examples without Huffman Coding
+    HpackCodec oDecoder(pLogger);
+    CHECK(Decode(oDecoder, strTableSize + FromHex("4803 3330 3258 0770 7269 7661 7465 611d 4d6f 6e2c 2032 3120"
+            "4f63 7420 3230 3133 2032 303a 3133 3a32 3120 474d 546e 1768 7474 7073 3a2f 2f77 7777 2e65"
+            "7861 6d70 6c65 2e63 6f6d"), vecResponse1));
+    CHECK(222 == oDecoder.GetDecodingTableSize());
+    CHECK(Decode(oDecoder, FromHex("4803 3330 37c1 c0bf"), vecResponse2));
+    CHECK(222 == oDecoder.GetDecodingTableSize());
+    CHECK(Decode(oDecoder, FromHex("88c1 611d 4d6f 6e2c 2032 3120 4f63 7420 3230 3133 2032 303a 3133 3a32"
+            "3220 474d 54c0 5a04 677a 6970 7738 666f 6f3d 4153 444a 4b48 514b 425a 584f 5157 454f 5049"
+            "5541 5851 5745 4f49 553b 206d 6178 2d61 6765 3d33 3630 303b 2076 6572 7369 6f6e 3d31"),
+            vecResponse3));
+    CHECK(215 == oDecoder.GetDecodingTableSize());
+
+    // C.6 Response Examples with Huffman Coding
+    HpackCodec oHuffmanDecoder(pLogger);
+    CHECK(Decode(oHuffmanDecoder, strTableSize + FromHex("4882 6402 5885 aec3 771a 4b61 96d0 7abe 9410 54d4"
+            "44a8 2005 9504 0b81 66e0 82a6 2d1b ff6e 919d 29ad 1718 63c7 8f0b 97c8 e9ae 82ae 43d3"),
+            vecResponse1));
+    CHECK(222 == oHuffmanDecoder.GetDecodingTableSize());
+    CHECK(Decode(oHuffmanDecoder, FromHex("4883 640e ffc1 c0bf"), vecResponse2));
+    CHECK(222 == oHuffmanDecoder.GetDecodingTableSize());
+    CHECK(Decode(oHuffmanDecoder, FromHex("88c1 6196 d07a be94 1054 d444 a820 0595 040b 8166 e084 a62d 1bff"
+            "c05a 839b d9ab 77ad 94e7 821d d7f2 e6c7 b335 dfdf cd5b 3960 d5af 2708 7f36 72c1 ab27 0fb5"
+            "291f 9587 3160 65c0 03ed 4ee5 b106 3d50 07"), vecResponse3));
+    CHECK(215 == oHuffmanDecoder.GetDecodingTableSize());
+
+    // 超出SETTINGS_HEADER_TABLE_SIZE（4096）的动态表大小更新（4097）是COMPRESSION_ERROR
+    HpackCodec oDecoder2(pLogger);
+    CHECK(!Decode(oDecoder2, FromHex("3fe21f"), {}));
+
+    // 编码端：dynamic_table_update_size在头块开头输出动态表大小更新，之后按上限淘汰
+    HpackCodec oEncoder(pLogger);
+    HpackCodec oPeer(pLogger);
+    const HeaderList* apResponse[] = {&vecResponse1, &vecResponse2, &vecResponse3};
+    for (auto* pResponse : apResponse)
+    {
+        HttpMsg oHttpMsg;
+        oHttpMsg.set_with_huffman(true);
+        if (pResponse == &vecResponse1)
+        {
+            oHttpMsg.set_dynamic_table_update_size(256);
+        }
+        for (auto& oHeader : *pResponse)
+        {
+            (*oHttpMsg.mutable_headers())[oHeader.first] = oHeader.second;
+        }
+        std::string strBlock = FromHex(Encode(oEncoder, oHttpMsg).c_str());
+        CHECK((pResponse == &vecResponse1) == (0 == strBlock.compare(0, strTableSize.size(), strTableSize)));
+        CHECK(Decode(oPeer, strBlock, *pResponse));
+        CHECK(oPeer.GetDecodingTableSize() <= 256);
+    }
+}
+
+int main()
+{
+    char szDir[] = "/tmp/neb_hpack_test_XXXXXX";
+    if (NULL == mkdtemp(szDir))
+    {
+        perror("mkdtemp");
+        return(1);
+    }
+    std::string strLogFile = std::string(szDir) + "/test.log";
+    {
+        std::shared_ptr<NetLogger> pLogger = std::make_shared<NetLogger>(strLogFile, Logger::FATAL);
+        TestInteger();
+        TestStringLiteral();
+        TestHeaderField(pLogger);
+        TestRequest(pLogger);
+        TestResponse(pLogger);
+    }
+    unlink(strLogFile.c_str());
+    rmdir(szDir);
+    if (s_iFailed > 0)
+    {
+        printf("HpackTest: %d checks failed\n", s_iFailed);
+        return(1);
+    }
+    printf("HpackTest: passed\n");
+    return(0);
+}
@@ -0,0 +1,344 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     Http2WriteSchedulerTest.cpp
+ * @brief    http2 DATA帧发送调度：交替发送、权重、流量控制窗口、流的登记和删除、大小响应交错
+ * @author   Bwar
+ * @date:    2026年10月18日
+ * @note
+ * Modify history:
+ ******************************************************************************/
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "codec/http2/CodecHttp2.hpp"
+#include "codec/http2/Http2Frame.hpp"
+#include "codec/http2/Http2WriteScheduler.hpp"
+#include "logger/NetLogger.hpp"
+#include "util/CBuffer.hpp"
+
+using namespace neb;
+
+static int s_iFailed = 0;
+
+#define CHECK(cond) \
+    do \
+    { \
+        if (!(cond)) \
+        { \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            ++s_iFailed; \
+        } \
+    } while(0)
+
+struct tagFrame
+{
+    uint32 uiLength;
+    uint8 ucFlag;
+    uint32 uiStreamId;
+};
+
+static std::vector<tagFrame> ParseFrame(CBuffer& oBuff)
+{
+    std::vector<tagFrame> vecFrame;
+    while (oBuff.ReadableBytes() >= Http2WriteScheduler::sc_uiFrameHeadSize)
+    {
+        const uint8* p = (const uint8*)oBuff.GetRawReadBuffer();
+        tagFrame stFrame;
+        stFrame.uiLength = ((uint32)p[0] << 16) | ((uint32)p[1] << 8) | p[2];
+        stFrame.ucFlag = p[4];
+        stFrame.uiStreamId = ((uint32)p[5] << 24) | ((uint32)p[6] << 16) | ((uint32)p[7] << 8) | p[8];
+        CHECK(H2_FRAME_DATA == p[3]);
+        oBuff.AdvanceReadIndex(Http2WriteScheduler::sc_uiFrameHeadSize + stFrame.uiLength);
+        vecFrame.push_back(stFrame);
+    }
+    return(vecFrame);
+}
+
+static size_t SumLength(const std::vector<tagFrame>& vecFrame)
+{
+    size_t uiLength = 0;
+    for (auto& stFrame : vecFrame)
+    {
+        uiLength += stFrame.uiLength;
+    }
+    return(uiLength);
+}
+
+static void TestInterleave()
+{
+    // 大响应不阻塞同一连接上的小响应
+    Http2WriteScheduler oScheduler;
+    oScheduler.UpdateWindow(0, 10000000);
+    oScheduler.SetInitialWindowSize(10000000);
+    oScheduler.Add(1);
+    oScheduler.Add(3);
+    std::string strBig(1000000, 'a');
+    std::string strSmall(100, 'b');
+    oScheduler.Push(1, strBig.data(), strBig.size(), true);
+    oScheduler.Push(3, strSmall.data(), strSmall.size(), true);
+    CBuffer oBuff;
+    oScheduler.Flush(16384, 1 << 30, &oBuff);
+    auto vecFrame = ParseFrame(oBuff);
+    int iSmallPos = -1;
+    for (size_t i = 0; i < vecFrame.size(); ++i)
+    {
+        if (vecFrame[i].uiStreamId == 3)
+        {
+            iSmallPos = (int)i;
+        }
+    }
+    CHECK(iSmallPos >= 0 && iSmallPos <= 1 && (vecFrame[iSmallPos].ucFlag & H2_FRAME_FLAG_END_STREAM));
+    CHECK(!vecFrame.empty() && (vecFrame.back().ucFlag & H2_FRAME_FLAG_END_STREAM));
+    CHECK(strBig.size() + strSmall.size() == SumLength(vecFrame));
+    CHECK(0 == oScheduler.GetPendingBytes() && !oScheduler.IsWritable());
+}
+
+static void TestWeight()
+{
+    Http2WriteScheduler oScheduler;
+    oScheduler.UpdateWindow(0, 100000000);
+    oScheduler.SetInitialWindowSize(100000000);
+    oScheduler.Add(1);
+    oScheduler.Add(3);
+    std::string strData(4000000, 'x');
+    oScheduler.Push(1, strData.data(), strData.size(), false);
+    oScheduler.Push(3, strData.data(), strData.size(), false);
+    oScheduler.SetWeight(1, 256);
+    oScheduler.SetWeight(3, 16);
+    CBuffer oBuff;
+    oScheduler.Flush(16384, 1700000, &oBuff);
+    std::map<uint32, size_t> mapSent;
+    for (auto& stFrame : ParseFrame(oBuff))
+    {
+        mapSent[stFrame.uiStreamId] += stFrame.uiLength;
+    }
+    double dRatio = (double)mapSent[1] / mapSent[3];
+    CHECK(dRatio > 14.0 && dRatio < 18.0);
+}
+
+static void TestWindow()
+{
+    Http2WriteScheduler oScheduler;
+    oScheduler.Add(1);
+    std::string strData(100000, 'x');
+    oScheduler.Push(1, strData.data(), strData.size(), true);
+    CBuffer oBuff;
+    oScheduler.Flush(16384, 1 << 30, &oBuff);
+    CHECK(65535 == SumLength(ParseFrame(oBuff)));      // 默认窗口
+    CHECK(!oScheduler.IsWritable());
+    oScheduler.UpdateWindow(0, 50000);
+    CHECK(!oScheduler.IsWritable());
+    oScheduler.UpdateWindow(1, 50000);
+    CHECK(oScheduler.IsWritable());
+    CBuffer oBuff2;
+    oScheduler.Flush(16384, 1 << 30, &oBuff2);
+    auto vecFrame = ParseFrame(oBuff2);
+    CHECK(34465 == SumLength(vecFrame));
+    CHECK(!vecFrame.empty() && (vecFrame.back().ucFlag & H2_FRAME_FLAG_END_STREAM));
+    CHECK(!oScheduler.UpdateWindow(0, 0x7FFFFFFF));
+
+    // 连接窗口耗尽时仍可以发送空的END_STREAM帧
+    Http2WriteScheduler oScheduler2;
+    oScheduler2.Add(1);
+    oScheduler2.Add(3);
+    oScheduler2.Add(5);
+    std::string strWindow(65535, 'x');
+    oScheduler2.Push(1, strWindow.data(), strWindow.size(), false);
+    CBuffer oBuff3;
+    oScheduler2.Flush(16384, 1 << 30, &oBuff3);
+    oScheduler2.Push(3, "", 0, true);
+    oScheduler2.Push(5, "y", 1, true);
+    CBuffer oBuff4;
+    oScheduler2.Flush(16384, 1 << 30, &oBuff4);
+    vecFrame = ParseFrame(oBuff4);
+    CHECK(1 == vecFrame.size() && 3 == vecFrame[0].uiStreamId && 0 == vecFrame[0].uiLength);
+    oScheduler2.Remove(5);
+    CHECK(0 == oScheduler2.GetPendingBytes());
+}
+
+static void TestByteBudget()
+{
+    // 每次最多输出uiMaxBytes字节（含帧头），其余留到下次
+    Http2WriteScheduler oScheduler;
+    oScheduler.UpdateWindow(0, 1000000);
+    oScheduler.SetInitialWindowSize(1000000);
+    oScheduler.Add(1);
+    std::string strData(50000, 'x');
+    oScheduler.Push(1, strData.data(), strData.size(), true);
+    size_t uiSent = 0;
+    int iFlushTimes = 0;
+    while (oScheduler.GetPendingBytes() > 0 && iFlushTimes < 100)
+    {
+        CBuffer oBuff;
+        size_t uiWritten = oScheduler.Flush(16384, 1000, &oBuff);
+        CHECK(uiWritten > 0 && uiWritten <= 1000 && uiWritten == oBuff.ReadableBytes());
+        uiSent += SumLength(ParseFrame(oBuff));
+        ++iFlushTimes;
+    }
+    CHECK(strData.size() == uiSent);
+    CHECK(51 == iFlushTimes);
+}
+
+static void TestUnknownStream()
+{
+    // 未登记的流：PRIORITY、WINDOW_UPDATE不产生条目，数据丢弃
+    Http2WriteScheduler oScheduler;
+    oScheduler.SetWeight(7, 200);
+    CHECK(oScheduler.UpdateWindow(9, 100));
+    oScheduler.Push(11, "abc", 3, true);
+    CHECK(0 == oScheduler.GetPendingBytes() && !oScheduler.IsWritable());
+    CBuffer oBuff;
+    CHECK(0 == oScheduler.Flush(16384, 1 << 30, &oBuff));
+
+    // 发出END_STREAM后流删除，之后的窗口更新和数据忽略
+    oScheduler.Add(1);
+    oScheduler.Push(1, "abc", 3, true);
+    CHECK(oScheduler.Flush(16384, 1 << 30, &oBuff) > 0);
+    CHECK(oScheduler.UpdateWindow(1, 0x7FFFFFFF));
+    oScheduler.Push(1, "def", 3, false);
+    CHECK(0 == oScheduler.GetPendingBytes());
+
+    // 被删除的流未发送的数据丢弃
+    oScheduler.Add(3);
+    oScheduler.Push(3, "abc", 3, false);
+    CHECK(3 == oScheduler.GetPendingBytes());
+    oScheduler.Remove(3);
+    CHECK(0 == oScheduler.GetPendingBytes() && !oScheduler.IsWritable());
+}
+
+static void TestCodecStream(std::shared_ptr<NetLogger> pLogger)
+{
+    CodecHttp2 oCodec(pLogger, CODEC_HTTP);
+    tagPriority stPriority;
+    stPriority.ucWeight = 255;
+    oCodec.SetPriority(5, stPriority);              // 未打开的流
+    CHECK(oCodec.WindowUpdate(5, 100));
+    oCodec.SendData(5, "abc", true);
+    CHECK(!oCodec.HasPendingData());
+
+    CBuffer oReactBuff;
+    CHECK(CODEC_STATUS_PART_OK == oCodec.PromiseStream(2, &oReactBuff));
+    oCodec.SetPriority(2, stPriority);
+    oCodec.SendData(2, "abc", false);
+    CHECK(oCodec.HasPendingData());
+    oCodec.RstStream(2);                            // 对端重置
+    CHECK(!oCodec.HasPendingData());
+
+    CHECK(CODEC_STATUS_PART_OK == oCodec.PromiseStream(4, &oReactBuff));
+    oCodec.SendData(4, "abc", false);
+    CHECK(oCodec.HasPendingData());
+    oCodec.DropPendingData(4);                      // 本端重置
+    CHECK(!oCodec.HasPendingData());
+    CBuffer oBuff;
+    CHECK(0 == oCodec.FlushData(&oBuff, 1 << 30));
+}
+
+static void TestCodecInterleave(std::shared_ptr<NetLogger> pLogger)
+{
+    // 一个大响应发送过程中到达的小响应：每次连接可写时按字节预算输出，小响应在下一次
+    // 可写时按到达顺序全部完成，完成前输出的字节数只与大响应的一帧和排在前面的小响应有关
+    CodecHttp2 oCodec(pLogger, CODEC_HTTP);
+    std::vector<tagSetting> vecSetting(1);
+    vecSetting[0].unIdentifier = H2_SETTINGS_INITIAL_WINDOW_SIZE;
+    vecSetting[0].uiValue = 10000000;
+    CHECK(H2_ERR_NO_ERROR == oCodec.Setting(vecSetting));
+    CHECK(oCodec.WindowUpdate(0, 10000000));
+    const size_t uiWritable = 65536;                // 连接每次可写的字节数
+    const uint32 uiMaxFrameSize = oCodec.GetMaxFrameSize();
+    CBuffer oReactBuff;
+    CHECK(CODEC_STATUS_PART_OK == oCodec.PromiseStream(2, &oReactBuff));
+    std::string strBig(1000000, 'a');
+    oCodec.SendData(2, strBig, true);
+    CBuffer oBuff;
+    oCodec.FlushData(&oBuff, uiWritable);
+    size_t uiBigSent = SumLength(ParseFrame(oBuff));
+    CHECK(uiBigSent > 0 && uiBigSent < strBig.size());
+
+    const int iSmallNum = 50;
+    std::string strSmall(100, 'b');
+    std::vector<uint32> vecSmallId;
+    for (int i = 0; i < iSmallNum; ++i)
+    {
+        uint32 uiStreamId = 4 + 2 * i;
+        CHECK(CODEC_STATUS_PART_OK == oCodec.PromiseStream(uiStreamId, &oReactBuff));
+        oCodec.SendData(uiStreamId, strSmall, true);
+        vecSmallId.push_back(uiStreamId);
+    }
+
+    std::vector<uint32> vecCompleted;               // 小响应按完成顺序的流ID
+    std::vector<size_t> vecCompletedBytes;          // 小响应到达后、该响应完成时已输出的字节数
+    std::vector<int> vecCompletedRound;             // 小响应在第几次可写时完成
+    size_t uiOutput = 0;
+    bool bBigDone = false;
+    bool bBigDoneBeforeSmall = false;
+    int iRound = 0;
+    while (oCodec.HasPendingData() && iRound < 100)
+    {
+        CBuffer oRoundBuff;
+        size_t uiWritten = oCodec.FlushData(&oRoundBuff, uiWritable);
+        CHECK(uiWritten > 0 && uiWritten <= uiWritable);
+        for (auto& stFrame : ParseFrame(oRoundBuff))
+        {
+            uiOutput += Http2WriteScheduler::sc_uiFrameHeadSize + stFrame.uiLength;
+            if (2 == stFrame.uiStreamId)
+            {
+                uiBigSent += stFrame.uiLength;
+                if (stFrame.ucFlag & H2_FRAME_FLAG_END_STREAM)
+                {
+                    bBigDone = true;
+                    bBigDoneBeforeSmall = ((int)vecCompleted.size() < iSmallNum);
+                }
+            }
+            else
+            {
+                CHECK(strSmall.size() == stFrame.uiLength && (stFrame.ucFlag & H2_FRAME_FLAG_END_STREAM));
+                vecCompleted.push_back(stFrame.uiStreamId);
+                vecCompletedBytes.push_back(uiOutput);
+                vecCompletedRound.push_back(iRound);
+            }
+        }
+        ++iRound;
+    }
+    CHECK(bBigDone && !bBigDoneBeforeSmall);
+    CHECK(strBig.size() == uiBigSent);
+    CHECK(vecSmallId == vecCompleted);
+    for (size_t i = 0; i < vecCompleted.size(); ++i)
+    {
+        CHECK(0 == vecCompletedRound[i]);
+        // 最多先输出大响应的一帧，之后是排在前面的小响应
+        CHECK(vecCompletedBytes[i] <= Http2WriteScheduler::sc_uiFrameHeadSize + uiMaxFrameSize
+                + (i + 1) * (Http2WriteScheduler::sc_uiFrameHeadSize + strSmall.size()));
+    }
+}
+
+int main()
+{
+    char szDir[] = "/tmp/neb_h2_sched_test_XXXXXX";
+    if (NULL == mkdtemp(szDir))
+    {
+        perror("mkdtemp");
+        return(1);
+    }
+    std::string strLogFile = std::string(szDir) + "/test.log";
+    {
+        std::shared_ptr<NetLogger> pLogger = std::make_shared<NetLogger>(strLogFile, Logger::FATAL);
+        TestInterleave();
+        TestWeight();
+        TestWindow();
+        TestByteBudget();
+        TestUnknownStream();
+        TestCodecStream(pLogger);
+        TestCodecInterleave(pLogger);
+    }
+    unlink(strLogFile.c_str());
+    rmdir(szDir);
+    if (s_iFailed > 0)
+    {
+        printf("Http2WriteSchedulerTest: %d checks failed\n", s_iFailed);
+        return(1);
+    }
+    printf("Http2WriteSchedulerTest: passed\n");
+    return(0);
+}
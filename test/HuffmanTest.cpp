@@ -0,0 +1,148 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     HuffmanTest.cpp
+ * @brief    HPACK哈夫曼编解码与rfc7541附录C示例的一致性
+ * @author   Bwar
+ * @date:    2026年10月18日
+ * @note     核对附录C.4、C.6中所有哈夫曼编码的字符串，随机字节串的往返编解码，
+ * EncodedLength()与实际编码长度一致，以及rfc7541 5.2要求视为解码错误的情形：
+ * 含EOS、填充超过7位、填充不是EOS的最高位（全1）。
+ * Modify history:
+ ******************************************************************************/
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include "codec/http2/Huffman.hpp"
+#include "util/CBuffer.hpp"
+
+using namespace neb;
+
+static int s_iFailed = 0;
+
+#define CHECK(cond) \
+    do \
+    { \
+        if (!(cond)) \
+        { \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            ++s_iFailed; \
+        } \
+    } while(0)
+
+static std::string FromHex(const std::string& strHex)
+{
+    std::string strBytes;
+    for (size_t i = 0; i + 1 < strHex.size(); i += 2)
+    {
+        strBytes.push_back((char)strtol(strHex.substr(i, 2).c_str(), NULL, 16));
+    }
+    return(strBytes);
+}
+
+static std::string ToHex(const char* pData, size_t uiLength)
+{
+    static const char sc_szDigit[] = "0123456789abcdef";
+    std::string strHex;
+    for (size_t i = 0; i < uiLength; ++i)
+    {
+        strHex.push_back(sc_szDigit[(pData[i] >> 4) & 0x0F]);
+        strHex.push_back(sc_szDigit[pData[i] & 0x0F]);
+    }
+    return(strHex);
+}
+
+static bool Decode(const std::string& strEncoded, std::string& strData)
+{
+    CBuffer oBuff;
+    oBuff.Write(strEncoded.data(), strEncoded.size());
+    return(Huffman::Instance()->Decode(&oBuff, (int)strEncoded.size(), strData));
+}
+
+static void TestRfcVectors()
+{
+    const char* aszCase[][2] = {
+        {"www.example.com", "f1e3c2e5f23a6ba0ab90f4ff"},
+        {"no-cache", "a8eb10649cbf"},
+        {"custom-key", "25a849e95ba97d7f"},
+        {"custom-value", "25a849e95bb8e8b4bf"},
+        {"302", "6402"},
+        {"private", "aec3771a4b"},
+        {"Mon, 21 Oct 2013 20:13:21 GMT", "d07abe941054d444a8200595040b8166e082a62d1bff"},
+        {"https://www.example.com", "9d29ad171863c78f0b97c8e9ae82ae43d3"},
+        {"307", "640eff"},
+        {"Mon, 21 Oct 2013 20:13:22 GMT", "d07abe941054d444a8200595040b8166e084a62d1bff"},
+        {"gzip", "9bd9ab"},
+        {"foo=ASDJKHQKBZXOQWEOPIUAXQWEOIU; max-age=3600; version=1",
+            "94e7821dd7f2e6c7b335dfdfcd5b3960d5af27087f3672c1ab270fb5291f9587316065c003ed4ee5b1063d5007"},
+    };
+    for (auto& aszPair : aszCase)
+    {
+        CBuffer oBuff;
+        Huffman::Instance()->Encode(aszPair[0], &oBuff);
+        std::string strHex = ToHex(oBuff.GetRawReadBuffer(), oBuff.ReadableBytes());
+        if (strHex != aszPair[1])
+        {
+            fprintf(stderr, "encode \"%s\": %s, expect %s\n", aszPair[0], strHex.c_str(), aszPair[1]);
+            ++s_iFailed;
+        }
+        CHECK(Huffman::EncodedLength(aszPair[0]) == oBuff.ReadableBytes());
+        std::string strData = "junk";
+        CHECK(Decode(FromHex(aszPair[1]), strData));
+        CHECK(strData == aszPair[0]);
+    }
+}
+
+static void TestRoundTrip()
+{
+    std::mt19937 oRandom(7);
+    for (int i = 0; i < 20000; ++i)
+    {
+        std::string strData(oRandom() % 100, '\0');
+        for (auto& c : strData)
+        {
+            c = (char)oRandom();
+        }
+        CBuffer oBuff;
+        Huffman::Instance()->Encode(strData, &oBuff);
+        size_t uiLength = oBuff.ReadableBytes();
+        CHECK(Huffman::EncodedLength(strData) == uiLength);
+        std::string strDecoded;
+        CHECK(Huffman::Instance()->Decode(&oBuff, (int)uiLength, strDecoded));
+        CHECK(strDecoded == strData);
+        CHECK(0 == oBuff.ReadableBytes());
+    }
+
+    // 只解码指定长度，紧随其后的数据不受影响
+    CBuffer oBuff;
+    Huffman::Instance()->Encode("no-cache", &oBuff);
+    oBuff.Write("\x82", 1);
+    std::string strData;
+    CHECK(Huffman::Instance()->Decode(&oBuff, 6, strData));
+    CHECK("no-cache" == strData);
+    CHECK(1 == oBuff.ReadableBytes() && '\x82' == *oBuff.GetRawReadBuffer());
+
+    CHECK(Decode("", strData) && strData.empty());
+}
+
+static void TestDecodeError()
+{
+    std::string strData;
+    CHECK(!Decode(FromHex("ffffffff"), strData));                       // 含30位的EOS
+    CHECK(!Decode(FromHex("f1e3c2e5f23a6ba0ab90f4ffff"), strData));     // 填充超过7位
+    CHECK(!Decode(FromHex("f1e3c2e5f23a6ba0ab90f4fe"), strData));       // 填充含0
+}
+
+int main()
+{
+    TestRfcVectors();
+    TestRoundTrip();
+    TestDecodeError();
+    if (s_iFailed > 0)
+    {
+        printf("HuffmanTest: %d checks failed\n", s_iFailed);
+        return(1);
+    }
+    printf("HuffmanTest: passed\n");
+    return(0);
+}
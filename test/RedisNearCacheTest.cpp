@@ -0,0 +1,396 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     RedisNearCacheTest.cpp
+ * @brief    RedisNearCache跟踪握手、失效通知、跟踪断开清空和淘汰
+ * @author   Bwar
+ * @date:    2026年10月18日
+ * @note     第一部分以预先构造的RESP3帧驱动缓存，不依赖redis；第二部分连接真实的
+ * redis 6+（环境变量NEB_TEST_REDIS=host:port，默认127.0.0.1:6379），按Dispatcher的
+ * 方式在专用连接上HELLO 3和CLIENT TRACKING ON BCAST，在另一连接上写key，验证缓存
+ * 收到push消息后失效；连不上redis时跳过。
+ * Modify history:
+ ******************************************************************************/
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include "ios/RedisNearCache.hpp"
+#include "channel/SocketChannel.hpp"
+#include "codec/RespCmd.hpp"
+#include "codec/RespView.hpp"
+#include "logger/NetLogger.hpp"
+#include "util/CBuffer.hpp"
+
+using namespace neb;
+
+static int s_iFailed = 0;
+
+#define CHECK(cond) \
+    do \
+    { \
+        if (!(cond)) \
+        { \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            ++s_iFailed; \
+        } \
+    } while(0)
+
+static bool View(const std::string& strFrame, RespView& oView)
+{
+    return(CODEC_STATUS_OK == RespView::Parse(strFrame.data(), strFrame.size(), oView));
+}
+
+static bool Message(RedisNearCache& oCache, const SocketChannel* pChannel, const std::string& strFrame, ev_tstamp dNow = 0.0)
+{
+    RespView oView;
+    if (!View(strFrame, oView))
+    {
+        fprintf(stderr, "invalid test frame %s\n", strFrame.c_str());
+        ++s_iFailed;
+        return(false);
+    }
+    return(oCache.OnTrackingMessage(pChannel, oView, dNow));
+}
+
+static RedisReply StringReply(const std::string& strValue)
+{
+    RedisReply oReply;
+    oReply.set_type(REDIS_REPLY_STRING);
+    oReply.set_str(strValue);
+    return(oReply);
+}
+
+/**
+ * @brief 缓存一个GET的响应
+ */
+static void Cache(RedisNearCache& oCache, const std::string& strNamespace, const std::string& strKey, const std::string& strValue)
+{
+    uint32 uiFillId = 0;
+    CHECK(nullptr == oCache.Lookup(strNamespace, RespCmd("GET", strKey), uiFillId));
+    oCache.Fill(uiFillId, StringReply(strValue));
+}
+
+static bool Cached(RedisNearCache& oCache, const std::string& strNamespace, const std::string& strKey)
+{
+    uint32 uiFillId = 0;
+    const RedisReply* pReply = oCache.Lookup(strNamespace, RespCmd("GET", strKey), uiFillId);
+    if (nullptr == pReply)
+    {
+        oCache.Cancel(uiFillId);
+    }
+    return(nullptr != pReply);
+}
+
+static void TestCacheable()
+{
+    RedisNearCache oCache;
+    CHECK(oCache.IsCacheable(RespCmd("get", "k")));
+    CHECK(oCache.IsCacheable(RespCmd("HGET", "h", "f")));
+    CHECK(oCache.IsCacheable(RespCmd("EXISTS", "k")));
+    CHECK(!oCache.IsCacheable(RespCmd("EXISTS", "a", "b")));
+    CHECK(!oCache.IsCacheable(RespCmd("SET", "k", "v")));
+    CHECK(!oCache.IsCacheable(RespCmd("MGET", "a", "b")));
+    oCache.SetTrackingPrefix({"user:"});
+    CHECK(oCache.IsCacheable(RespCmd("GET", "user:1")));
+    CHECK(!oCache.IsCacheable(RespCmd("GET", "order:1")));
+}
+
+static void TestTrackingAndInvalidation(std::shared_ptr<NetLogger> pLogger)
+{
+    RedisNearCache oCache;
+    oCache.SetMaxMemory(1 << 20);
+    oCache.SetNamespaceNodes("r", {"n1"});
+    CHECK(!oCache.IsReady("r"));
+    std::vector<std::string> vecNode;
+    oCache.GetUntrackedNodes("r", 0.0, vecNode);
+    CHECK(1 == vecNode.size());
+
+    // 握手：HELLO 3的map响应和CLIENT TRACKING的+OK都到达后才就绪
+    auto pChannel = std::make_shared<SocketChannel>(pLogger, -1, 1);
+    oCache.AddTrackingChannel("n1", pChannel, 2);
+    CHECK(oCache.IsTrackingChannel(pChannel.get()));
+    CHECK(Message(oCache, pChannel.get(), "%2\r\n+server\r\n+redis\r\n+proto\r\n:3\r\n"));
+    CHECK(!oCache.IsReady("r"));
+    CHECK(Message(oCache, pChannel.get(), "+OK\r\n"));
+    CHECK(oCache.IsReady("r"));
+
+    Cache(oCache, "r", "k", "v1");
+    Cache(oCache, "r", "h", "v2");
+    CHECK(2 == oCache.GetEntryNum());
+    uint32 uiFillId = 0;
+    const RedisReply* pReply = oCache.Lookup("r", RespCmd("get", "k"), uiFillId);
+    CHECK(nullptr != pReply && "v1" == pReply->str());
+
+    // 写入后redis推送invalidate，缓存删除
+    CHECK(Message(oCache, pChannel.get(), ">2\r\n$10\r\ninvalidate\r\n*1\r\n$1\r\nk\r\n"));
+    CHECK(!Cached(oCache, "r", "k"));
+    CHECK(Cached(oCache, "r", "h"));
+    CHECK(1 == oCache.GetStat().ullInvalidate);
+
+    // 查找后、回填前收到失效通知的响应不回填（响应可能早于写入）
+    uint32 uiPendingId = 0;
+    CHECK(nullptr == oCache.Lookup("r", RespCmd("HGET", "p", "f"), uiPendingId));
+    CHECK(Message(oCache, pChannel.get(), ">2\r\n$10\r\ninvalidate\r\n*2\r\n$1\r\np\r\n$1\r\nx\r\n"));
+    oCache.Fill(uiPendingId, StringReply("stale"));
+    uint32 uiFillId2 = 0;
+    CHECK(nullptr == oCache.Lookup("r", RespCmd("HGET", "p", "f"), uiFillId2));
+    oCache.Cancel(uiFillId2);
+
+    // 错误响应不回填
+    CHECK(nullptr == oCache.Lookup("r", RespCmd("GET", "e"), uiFillId));
+    RedisReply oError;
+    oError.set_type(REDIS_REPLY_ERROR);
+    oError.set_str("ERR");
+    oCache.Fill(uiFillId, oError);
+    CHECK(!Cached(oCache, "r", "e"));
+
+    // 其他push消息（如pubsub）和保活PING的响应不影响缓存
+    CHECK(Message(oCache, pChannel.get(), ">3\r\n$7\r\nmessage\r\n$2\r\nch\r\n$1\r\nh\r\n"));
+    CHECK(Message(oCache, pChannel.get(), "+PONG\r\n"));
+    CHECK(Cached(oCache, "r", "h"));
+
+    // FLUSHALL、FLUSHDB时invalidate的key为null，清空命名空间
+    CHECK(Message(oCache, pChannel.get(), ">2\r\n$10\r\ninvalidate\r\n_\r\n"));
+    CHECK(0 == oCache.GetEntryNum() && 0 == oCache.GetMemory());
+
+    // 跟踪连接断开：清空缓存，重连间隔内不重连，之后节点重新待跟踪
+    Cache(oCache, "r", "z", "v3");
+    CHECK(1 == oCache.GetEntryNum());
+    uint32 uiInFlightId = 0;
+    CHECK(nullptr == oCache.Lookup("r", RespCmd("GET", "y"), uiInFlightId));
+    oCache.OnTrackingClosed(pChannel.get(), 10.0);
+    CHECK(!oCache.IsReady("r"));
+    CHECK(!oCache.IsTrackingChannel(pChannel.get()));
+    CHECK(0 == oCache.GetEntryNum() && 0 == oCache.GetMemory());
+    oCache.Fill(uiInFlightId, StringReply("v4"));      // 断开前发出的请求的响应不回填
+    CHECK(0 == oCache.GetEntryNum());
+    vecNode.clear();
+    oCache.GetUntrackedNodes("r", 10.5, vecNode);
+    CHECK(vecNode.empty());
+    oCache.GetUntrackedNodes("r", 11.0, vecNode);
+    CHECK(1 == vecNode.size());
+
+    // redis 6以下不支持HELLO 3：握手失败，较长时间内不重试
+    auto pChannel2 = std::make_shared<SocketChannel>(pLogger, -1, 2);
+    oCache.AddTrackingChannel("n1", pChannel2, 2);
+    CHECK(!Message(oCache, pChannel2.get(), "-ERR unknown command 'HELLO'\r\n", 20.0));
+    oCache.OnTrackingClosed(pChannel2.get(), 20.0);
+    vecNode.clear();
+    oCache.GetUntrackedNodes("r", 30.0, vecNode);
+    CHECK(vecNode.empty());
+}
+
+static void TestClusterNamespace(std::shared_ptr<NetLogger> pLogger)
+{
+    RedisNearCache oCache;
+    oCache.SetMaxMemory(1 << 20);
+    oCache.SetNamespaceNodes("cluster", {"n1", "n2"});
+    auto pChannel1 = std::make_shared<SocketChannel>(pLogger, -1, 1);
+    auto pChannel2 = std::make_shared<SocketChannel>(pLogger, -1, 2);
+    oCache.AddTrackingChannel("n1", pChannel1, 1);
+    CHECK(Message(oCache, pChannel1.get(), "+OK\r\n"));
+    CHECK(!oCache.IsReady("cluster"));      // 所有节点都建立跟踪后才可缓存
+    oCache.AddTrackingChannel("n2", pChannel2, 1);
+    CHECK(Message(oCache, pChannel2.get(), "+OK\r\n"));
+    CHECK(oCache.IsReady("cluster"));
+    Cache(oCache, "cluster", "a", "1");
+    Cache(oCache, "cluster", "b", "2");
+
+    // 任一节点的失效通知都作用于整个命名空间
+    CHECK(Message(oCache, pChannel2.get(), ">2\r\n$10\r\ninvalidate\r\n*1\r\n$1\r\na\r\n"));
+    CHECK(!Cached(oCache, "cluster", "a"));
+    CHECK(Cached(oCache, "cluster", "b"));
+
+    // 任一节点的跟踪断开都清空整个命名空间
+    oCache.OnTrackingClosed(pChannel1.get(), 1.0);
+    CHECK(!oCache.IsReady("cluster"));
+    CHECK(0 == oCache.GetEntryNum());
+}
+
+static void TestEviction(std::shared_ptr<NetLogger> pLogger)
+{
+    RedisNearCache oCache;
+    oCache.SetMaxMemory(1 << 20);
+    oCache.SetNamespaceNodes("r", {"n1"});
+    auto pChannel = std::make_shared<SocketChannel>(pLogger, -1, 1);
+    oCache.AddTrackingChannel("n1", pChannel, 1);
+    Message(oCache, pChannel.get(), "+OK\r\n");
+    oCache.SetMaxMemory(16 * 400);
+    for (int i = 0; i < 100; ++i)
+    {
+        Cache(oCache, "r", std::to_string(i), "value");
+    }
+    CHECK(oCache.GetMemory() <= 16 * 400);
+    CHECK(oCache.GetEntryNum() > 0 && oCache.GetEntryNum() < 100);
+    CHECK(oCache.GetStat().ullEvict > 0);
+    CHECK(Cached(oCache, "r", "99"));       // 最近写入的不被淘汰
+    CHECK(!Cached(oCache, "r", "0"));
+    oCache.SetMaxMemory(0);
+    CHECK(!oCache.IsEnabled() && 0 == oCache.GetEntryNum());
+}
+
+/**
+ * @brief 连接redis的简单阻塞客户端
+ */
+class RawRedis
+{
+public:
+    ~RawRedis()
+    {
+        if (m_iFd >= 0)
+        {
+            close(m_iFd);
+        }
+    }
+
+    bool Connect(const std::string& strHost, const std::string& strPort)
+    {
+        struct addrinfo stHints;
+        struct addrinfo* pResult = nullptr;
+        memset(&stHints, 0, sizeof(stHints));
+        stHints.ai_socktype = SOCK_STREAM;
+        if (0 != getaddrinfo(strHost.c_str(), strPort.c_str(), &stHints, &pResult))
+        {
+            return(false);
+        }
+        m_iFd = socket(pResult->ai_family, SOCK_STREAM, 0);
+        bool bConnected = (m_iFd >= 0 && 0 == connect(m_iFd, pResult->ai_addr, pResult->ai_addrlen));
+        freeaddrinfo(pResult);
+        struct timeval stTimeout = {2, 0};
+        setsockopt(m_iFd, SOL_SOCKET, SO_RCVTIMEO, &stTimeout, sizeof(stTimeout));
+        return(bConnected);
+    }
+
+    bool Send(const RespCmd& oRespCmd)
+    {
+        CBuffer oBuff;
+        oRespCmd.Encode(&oBuff);
+        return((ssize_t)oBuff.ReadableBytes() == write(m_iFd, oBuff.GetRawReadBuffer(), oBuff.ReadableBytes()));
+    }
+
+    /**
+     * @brief 读取一个完整的帧，返回的视图在下一次Read()前有效
+     */
+    bool Read(RespView& oView)
+    {
+        m_strData.erase(0, m_uiConsumed);
+        m_uiConsumed = 0;
+        while (true)
+        {
+            E_CODEC_STATUS eStatus = RespView::Parse(m_strData.data(), m_strData.size(), oView);
+            if (CODEC_STATUS_OK == eStatus)
+            {
+                m_uiConsumed = oView.GetFrameLength();
+                return(true);
+            }
+            if (CODEC_STATUS_PAUSE != eStatus)
+            {
+                return(false);
+            }
+            char szBuff[4096];
+            ssize_t iReadLen = read(m_iFd, szBuff, sizeof(szBuff));
+            if (iReadLen <= 0)
+            {
+                return(false);
+            }
+            m_strData.append(szBuff, iReadLen);
+        }
+    }
+
+private:
+    int m_iFd = -1;
+    std::string m_strData;
+    size_t m_uiConsumed = 0;
+};
+
+static void TestLiveRedis(std::shared_ptr<NetLogger> pLogger)
+{
+    const char* szAddr = getenv("NEB_TEST_REDIS");
+    std::string strAddr = (nullptr == szAddr) ? "127.0.0.1:6379" : szAddr;
+    size_t uiColon = strAddr.rfind(':');
+    std::string strHost = strAddr.substr(0, uiColon);
+    std::string strPort = (std::string::npos == uiColon) ? "6379" : strAddr.substr(uiColon + 1);
+    RawRedis oTracking;
+    RawRedis oData;
+    if (!oTracking.Connect(strHost, strPort) || !oData.Connect(strHost, strPort))
+    {
+        printf("RedisNearCacheTest: no redis at %s, live test skipped\n", strAddr.c_str());
+        return;
+    }
+
+    RedisNearCache oCache;
+    oCache.SetMaxMemory(1 << 20);
+    oCache.SetNamespaceNodes("live", {strAddr});
+    auto pChannel = std::make_shared<SocketChannel>(pLogger, -1, 1);
+    CHECK(oTracking.Send(RespCmd("HELLO", 3)));
+    CHECK(oTracking.Send(RespCmd("CLIENT", "TRACKING", "ON", "BCAST")));
+    oCache.AddTrackingChannel(strAddr, pChannel, 2);
+    RespView oView;
+    for (int i = 0; i < 2 && oTracking.Read(oView); ++i)
+    {
+        if (!oCache.OnTrackingMessage(pChannel.get(), oView, 0.0))
+        {
+            printf("RedisNearCacheTest: redis at %s does not support tracking (%s), live test skipped\n",
+                    strAddr.c_str(), oView.Str().c_str());
+            return;
+        }
+    }
+    CHECK(oCache.IsReady("live"));
+
+    const std::string strKey = "neb:near_cache_test:" + std::to_string(getpid());
+    CHECK(oData.Send(RespCmd("SET", strKey, "v1")) && oData.Read(oView) && !oView.IsError());
+    uint32 uiFillId = 0;
+    CHECK(nullptr == oCache.Lookup("live", RespCmd("GET", strKey), uiFillId));
+    CHECK(oData.Send(RespCmd("GET", strKey)) && oData.Read(oView));
+    RedisReply oReply;
+    oView.ToRedisReply(oReply);
+    oCache.Fill(uiFillId, oReply);
+    const RedisReply* pCached = oCache.Lookup("live", RespCmd("GET", strKey), uiFillId);
+    CHECK(nullptr != pCached && "v1" == pCached->str());
+
+    // 另一连接写入，跟踪连接收到invalidate后缓存失效
+    CHECK(oData.Send(RespCmd("SET", strKey, "v2")) && oData.Read(oView));
+    bool bInvalidated = false;
+    while (!bInvalidated && oTracking.Read(oView))
+    {
+        oCache.OnTrackingMessage(pChannel.get(), oView, 0.0);
+        bInvalidated = !Cached(oCache, "live", strKey);
+    }
+    CHECK(bInvalidated);
+    oData.Send(RespCmd("DEL", strKey));
+    oData.Read(oView);
+    printf("RedisNearCacheTest: live test against %s done\n", strAddr.c_str());
+}
+
+int main()
+{
+    char szDir[] = "/tmp/neb_near_cache_test_XXXXXX";
+    if (NULL == mkdtemp(szDir))
+    {
+        perror("mkdtemp");
+        return(1);
+    }
+    std::string strLogFile = std::string(szDir) + "/test.log";
+    {
+        std::shared_ptr<NetLogger> pLogger = std::make_shared<NetLogger>(strLogFile, Logger::FATAL);
+        TestCacheable();
+        TestTrackingAndInvalidation(pLogger);
+        TestClusterNamespace(pLogger);
+        TestEviction(pLogger);
+        TestLiveRedis(pLogger);
+    }
+    unlink(strLogFile.c_str());
+    rmdir(szDir);
+    if (s_iFailed > 0)
+    {
+        printf("RedisNearCacheTest: %d checks failed\n", s_iFailed);
+        return(1);
+    }
+    printf("RedisNearCacheTest: passed\n");
+    return(0);
+}
@@ -0,0 +1,72 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     RedisOperatorTest.cpp
+ * @brief    RedisOperator::MakeRespCmd()生成的命令参数
+ * @author   Bwar
+ * @date:    2026年10月18日
+ * @note     字段名加字段值（含空串值）、只有字段名和只有值（list、set元素）的字段。
+ * Modify history:
+ ******************************************************************************/
+#include <cstdio>
+#include <string>
+#include "mydis/RedisOperator.hpp"
+#include "codec/RespCmd.hpp"
+#include "util/CBuffer.hpp"
+
+using namespace neb;
+
+static int s_iFailed = 0;
+
+static std::string Encode(const RedisOperator& oOperator)
+{
+    RespCmd oRespCmd;
+    if (!oOperator.MakeRespCmd(oRespCmd))
+    {
+        return("");
+    }
+    CBuffer oBuff;
+    oRespCmd.Encode(&oBuff);
+    return(std::string(oBuff.GetRawReadBuffer(), oBuff.ReadableBytes()));
+}
+
+static void Expect(const char* szCase, const RedisOperator& oOperator, const std::string& strExpected)
+{
+    std::string strEncoded = Encode(oOperator);
+    if (strEncoded != strExpected)
+    {
+        fprintf(stderr, "%s: expected\n%s\ngot\n%s\n", szCase, strExpected.c_str(), strEncoded.c_str());
+        ++s_iFailed;
+    }
+}
+
+int main()
+{
+    RedisOperator oHset(0, "1:2:user", "HSET");
+    oHset.AddRedisField("name", "bwar");
+    oHset.AddRedisField("nick", "");
+    oHset.AddRedisField("age", (int32)18);
+    Expect("HSET with an empty value", oHset,
+            "*8\r\n$4\r\nHSET\r\n$8\r\n1:2:user\r\n$4\r\nname\r\n$4\r\nbwar\r\n"
+            "$4\r\nnick\r\n$0\r\n\r\n$3\r\nage\r\n$2\r\n18\r\n");
+
+    RedisOperator oHmget(0, "1:2:user", "HMSET", "HMGET");
+    oHmget.AddRedisField("name");
+    oHmget.AddRedisField("nick");
+    Expect("HMGET field names", oHmget,
+            "*4\r\n$5\r\nHMGET\r\n$8\r\n1:2:user\r\n$4\r\nname\r\n$4\r\nnick\r\n");
+
+    RedisOperator oRpush(0, "1:2:list", "RPUSH");
+    oRpush.AddRedisField("", "a");
+    oRpush.AddRedisField("", "");
+    oRpush.AddRedisField("", "c");
+    Expect("RPUSH elements", oRpush,
+            "*5\r\n$5\r\nRPUSH\r\n$8\r\n1:2:list\r\n$1\r\na\r\n$0\r\n\r\n$1\r\nc\r\n");
+
+    if (s_iFailed > 0)
+    {
+        printf("RedisOperatorTest: %d cases failed\n", s_iFailed);
+        return(1);
+    }
+    printf("RedisOperatorTest: passed\n");
+    return(0);
+}
@@ -0,0 +1,249 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     ResolverTest.cpp
+ * @brief    Resolver缓存与后台解析
+ * @author   Bwar
+ * @date:    2026年10月18日
+ * @note     以桩解析函数代替getaddrinfo()，验证IP地址直接转换、缓存命中、失败结果
+ * 缓存、TTL过期和同一域名解析中不重复提交。
+ * Modify history:
+ ******************************************************************************/
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <map>
+#include <netdb.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include "ios/Resolver.hpp"
+
+using namespace neb;
+
+static int s_iFailed = 0;
+
+#define CHECK(cond) \
+    do \
+    { \
+        if (!(cond)) \
+        { \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            ++s_iFailed; \
+        } \
+    } while(0)
+
+/**
+ * @brief 桩解析：ok.test解析为10.0.0.1，v6.test解析为2001:db8::1，其他域名失败；
+ * 关闭闸门时解析阻塞，用于验证解析中不重复提交
+ */
+class StubDns
+{
+public:
+    int Resolve(const std::string& strHost, std::vector<Resolver::tagAddress>& vecAddress)
+    {
+        {
+            std::unique_lock<std::mutex> oLock(m_mutex);
+            ++m_mapCall[strHost];
+            m_cond.wait(oLock, [this]{ return(m_bOpen); });
+        }
+        Resolver::tagAddress stAddress;
+        memset(&stAddress.stAddr, 0, sizeof(stAddress.stAddr));
+        if ("ok.test" == strHost)
+        {
+            struct sockaddr_in* pAddr = (struct sockaddr_in*)&stAddress.stAddr;
+            pAddr->sin_family = AF_INET;
+            inet_pton(AF_INET, "10.0.0.1", &pAddr->sin_addr);
+            stAddress.uiAddrLen = sizeof(struct sockaddr_in);
+            vecAddress.push_back(stAddress);
+            return(0);
+        }
+        if ("v6.test" == strHost)
+        {
+            struct sockaddr_in6* pAddr = (struct sockaddr_in6*)&stAddress.stAddr;
+            pAddr->sin6_family = AF_INET6;
+            inet_pton(AF_INET6, "2001:db8::1", &pAddr->sin6_addr);
+            stAddress.uiAddrLen = sizeof(struct sockaddr_in6);
+            vecAddress.push_back(stAddress);
+            return(0);
+        }
+        return(EAI_NONAME);
+    }
+
+    int CallNum(const std::string& strHost)
+    {
+        std::lock_guard<std::mutex> oLock(m_mutex);
+        return(m_mapCall[strHost]);
+    }
+
+    void SetOpen(bool bOpen)
+    {
+        {
+            std::lock_guard<std::mutex> oLock(m_mutex);
+            m_bOpen = bOpen;
+        }
+        m_cond.notify_all();
+    }
+
+    void Notify()
+    {
+        {
+            std::lock_guard<std::mutex> oLock(m_mutex);
+            ++m_uiNotifyNum;
+        }
+        m_cond.notify_all();
+    }
+
+    /**
+     * @brief 等待通知次数达到uiNum（最长2秒）
+     */
+    bool WaitNotify(unsigned int uiNum)
+    {
+        std::unique_lock<std::mutex> oLock(m_mutex);
+        return(m_cond.wait_for(oLock, std::chrono::seconds(2), [this, uiNum]{ return(m_uiNotifyNum >= uiNum); }));
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::map<std::string, int> m_mapCall;
+    bool m_bOpen = true;
+    unsigned int m_uiNotifyNum = 0;
+};
+
+static int Port(const Resolver::tagAddress& stAddress)
+{
+    if (AF_INET6 == stAddress.stAddr.ss_family)
+    {
+        return(ntohs(((const struct sockaddr_in6*)&stAddress.stAddr)->sin6_port));
+    }
+    return(ntohs(((const struct sockaddr_in*)&stAddress.stAddr)->sin_port));
+}
+
+static std::string Ip(const Resolver::tagAddress& stAddress)
+{
+    char szIp[INET6_ADDRSTRLEN] = {0};
+    if (AF_INET6 == stAddress.stAddr.ss_family)
+    {
+        inet_ntop(AF_INET6, &((const struct sockaddr_in6*)&stAddress.stAddr)->sin6_addr, szIp, sizeof(szIp));
+    }
+    else
+    {
+        inet_ntop(AF_INET, &((const struct sockaddr_in*)&stAddress.stAddr)->sin_addr, szIp, sizeof(szIp));
+    }
+    return(szIp);
+}
+
+static void TestNumericHost(Resolver& oResolver, StubDns& oDns)
+{
+    Resolver::tagAddress stAddress;
+    int iErrCode = 0;
+    CHECK(Resolver::RESOLVE_HIT == oResolver.Lookup("127.0.0.1", 6379, stAddress, iErrCode, 0.0));
+    CHECK(AF_INET == stAddress.stAddr.ss_family && 6379 == Port(stAddress) && "127.0.0.1" == Ip(stAddress));
+    CHECK(Resolver::RESOLVE_HIT == oResolver.Lookup("::1", 443, stAddress, iErrCode, 0.0));
+    CHECK(AF_INET6 == stAddress.stAddr.ss_family && 443 == Port(stAddress) && "::1" == Ip(stAddress));
+    CHECK(0 == oDns.CallNum("127.0.0.1") && 0 == oDns.CallNum("::1"));
+}
+
+static void TestResolveAndCache(Resolver& oResolver, StubDns& oDns)
+{
+    Resolver::tagAddress stAddress;
+    int iErrCode = 0;
+    CHECK(Resolver::RESOLVE_MISS == oResolver.Lookup("ok.test", 80, stAddress, iErrCode, 100.0));
+    CHECK(Resolver::RESOLVE_MISS == oResolver.Lookup("bad.test", 80, stAddress, iErrCode, 100.0));
+    CHECK(oResolver.Resolve("ok.test"));
+    CHECK(oResolver.Resolve("bad.test"));
+    CHECK(oDns.WaitNotify(2));
+
+    std::vector<Resolver::tagResult> vecResult;
+    oResolver.FetchResult(vecResult);
+    CHECK(2 == vecResult.size());
+    for (auto& stResult : vecResult)
+    {
+        if ("ok.test" == stResult.strHost)
+        {
+            CHECK(0 == stResult.iErrCode);
+            CHECK(Resolver::GetAddress(stResult, 8080, stAddress) && 8080 == Port(stAddress));
+            oResolver.Update(stResult, 100.0, 30.0);
+        }
+        else
+        {
+            CHECK(EAI_NONAME == stResult.iErrCode);
+            CHECK(!Resolver::GetAddress(stResult, 8080, stAddress));
+            oResolver.Update(stResult, 100.0, 5.0);
+        }
+    }
+
+    // 命中缓存，端口取查找时的端口
+    CHECK(Resolver::RESOLVE_HIT == oResolver.Lookup("ok.test", 80, stAddress, iErrCode, 120.0));
+    CHECK(80 == Port(stAddress) && "10.0.0.1" == Ip(stAddress));
+    CHECK(Resolver::RESOLVE_HIT == oResolver.Lookup("ok.test", 443, stAddress, iErrCode, 130.0));
+    CHECK(443 == Port(stAddress));
+    CHECK(Resolver::RESOLVE_MISS == oResolver.Lookup("ok.test", 80, stAddress, iErrCode, 130.5));
+
+    // 失败结果缓存到TTL过期
+    iErrCode = 0;
+    CHECK(Resolver::RESOLVE_NEGATIVE == oResolver.Lookup("bad.test", 80, stAddress, iErrCode, 104.0));
+    CHECK(EAI_NONAME == iErrCode);
+    CHECK(Resolver::RESOLVE_MISS == oResolver.Lookup("bad.test", 80, stAddress, iErrCode, 105.5));
+    CHECK(1 == oDns.CallNum("ok.test") && 1 == oDns.CallNum("bad.test"));
+
+    // 解析成功但无地址视为失败
+    Resolver::tagResult stEmpty;
+    stEmpty.strHost = "empty.test";
+    oResolver.Update(stEmpty, 100.0, 30.0);
+    CHECK(Resolver::RESOLVE_NEGATIVE == oResolver.Lookup("empty.test", 80, stAddress, iErrCode, 101.0));
+}
+
+static void TestInFlightDedupe(Resolver& oResolver, StubDns& oDns)
+{
+    oDns.SetOpen(false);
+    CHECK(oResolver.Resolve("v6.test"));
+    CHECK(oResolver.Resolve("v6.test"));
+    CHECK(oResolver.Resolve("v6.test"));
+    std::vector<Resolver::tagResult> vecResult;
+    oResolver.FetchResult(vecResult);
+    CHECK(vecResult.empty());
+    oDns.SetOpen(true);
+    CHECK(oDns.WaitNotify(3));
+    oResolver.FetchResult(vecResult);
+    CHECK(1 == vecResult.size());
+    CHECK(1 == oDns.CallNum("v6.test"));
+
+    // 取回结果后可再次提交
+    CHECK(oResolver.Resolve("v6.test"));
+    CHECK(oDns.WaitNotify(4));
+    vecResult.clear();
+    oResolver.FetchResult(vecResult);
+    CHECK(1 == vecResult.size() && 2 == oDns.CallNum("v6.test"));
+    if (1 == vecResult.size())
+    {
+        Resolver::tagAddress stAddress;
+        int iErrCode = 0;
+        oResolver.Update(vecResult[0], 200.0, 30.0);
+        CHECK(Resolver::RESOLVE_HIT == oResolver.Lookup("v6.test", 6379, stAddress, iErrCode, 200.0));
+        CHECK(AF_INET6 == stAddress.stAddr.ss_family && 6379 == Port(stAddress) && "2001:db8::1" == Ip(stAddress));
+    }
+}
+
+int main()
+{
+    StubDns oDns;
+    Resolver oResolver;
+    oResolver.SetResolveFunction([&oDns](const std::string& strHost, std::vector<Resolver::tagAddress>& vecAddress)
+            { return(oDns.Resolve(strHost, vecAddress)); });
+    oResolver.SetNotifyFunction([&oDns]{ oDns.Notify(); });
+
+    TestNumericHost(oResolver, oDns);
+    TestResolveAndCache(oResolver, oDns);
+    TestInFlightDedupe(oResolver, oDns);
+    oResolver.Stop();
+
+    if (s_iFailed > 0)
+    {
+        printf("ResolverTest: %d checks failed\n", s_iFailed);
+        return(1);
+    }
+    printf("ResolverTest: passed\n");
+    return(0);
+}
@@ -0,0 +1,215 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     SendQueueTest.cpp
+ * @brief    SendQueue的分段合并和MSG_ZEROCOPY数据在连接关闭后的生命周期
+ * @author   Bwar
+ * @date:    2026年10月18日
+ * @note     1. 对端不读取时逐条排队小消息并反复发送，未发完的数据应继续追加到尾部缓冲区，
+ * 而不是每次发送后封存为一段；
+ * 2. 通过本机TCP连接以MSG_ZEROCOPY发送一段外部数据，连接关闭时数据应移交暂存
+ * 列表而不随队列释放，收到完成通知后才释放。内核不支持SO_ZEROCOPY时跳过。
+ * Modify history:
+ ******************************************************************************/
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <fcntl.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "channel/SendQueue.hpp"
+
+using namespace neb;
+
+static int s_iFailed = 0;
+
+#define CHECK(cond) \
+    do \
+    { \
+        if (!(cond)) \
+        { \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            ++s_iFailed; \
+        } \
+    } while(0)
+
+static bool TcpPair(int& iClientFd, int& iServerFd)
+{
+    int iListenFd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in stAddr;
+    memset(&stAddr, 0, sizeof(stAddr));
+    stAddr.sin_family = AF_INET;
+    stAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t uiAddrLen = sizeof(stAddr);
+    if (iListenFd < 0 || bind(iListenFd, (struct sockaddr*)&stAddr, sizeof(stAddr)) != 0
+            || listen(iListenFd, 1) != 0 || getsockname(iListenFd, (struct sockaddr*)&stAddr, &uiAddrLen) != 0)
+    {
+        return(false);
+    }
+    iClientFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (connect(iClientFd, (struct sockaddr*)&stAddr, sizeof(stAddr)) != 0)
+    {
+        return(false);
+    }
+    iServerFd = accept(iListenFd, nullptr, nullptr);
+    close(iListenFd);
+    fcntl(iClientFd, F_SETFL, fcntl(iClientFd, F_GETFL) | O_NONBLOCK);
+    return(iServerFd >= 0);
+}
+
+static void Drain(int iFd)
+{
+    char szBuff[65536];
+    fcntl(iFd, F_SETFL, fcntl(iFd, F_GETFL) | O_NONBLOCK);
+    while (read(iFd, szBuff, sizeof(szBuff)) > 0)
+    {
+    }
+}
+
+/**
+ * @brief 发送阻塞（EAGAIN）期间排队的小消息合并在尾部缓冲区中，每段接近一个缓冲区大小
+ */
+static void TestCoalesceOnEagain()
+{
+    int iClientFd = -1;
+    int iServerFd = -1;
+    if (!TcpPair(iClientFd, iServerFd))
+    {
+        fprintf(stderr, "failed to create tcp connection\n");
+        ++s_iFailed;
+        return;
+    }
+    int iSendBuff = 4096;
+    setsockopt(iClientFd, SOL_SOCKET, SO_SNDBUF, &iSendBuff, sizeof(iSendBuff));
+    std::string strMsg(100, 'm');
+    SendQueue* pQueue = SendQueue::Acquire();
+    int iErrno = 0;
+    int iEagain = 0;
+    for (int i = 0; i < 20000; ++i)
+    {
+        pQueue->GetTail(strMsg.size())->Write(strMsg.data(), strMsg.size());
+        if (pQueue->WriteFD(iClientFd, iErrno, 0) < 0)
+        {
+            CHECK(EAGAIN == iErrno || EWOULDBLOCK == iErrno);
+            ++iEagain;
+        }
+    }
+    CHECK(iEagain > 0);
+
+    size_t uiQueued = pQueue->ReadableBytes();
+    size_t uiSegment = 0;
+    const char* pData = nullptr;
+    size_t uiLength = 0;
+    while (pQueue->Front(pData, uiLength))
+    {
+        pQueue->Skip(uiLength);
+        ++uiSegment;
+    }
+    // 每段至少填满半个缓冲区；每次发送后都封存时会是每条消息一段
+    CHECK(uiSegment <= uiQueued / (CBuffer::BUFFER_MAX_READ / 2) + 2);
+    SendQueue::Release(pQueue);
+    close(iClientFd);
+    close(iServerFd);
+}
+
+/**
+ * @brief 零拷贝发送后关闭连接，数据由暂存列表持有直到收到完成通知
+ * @return 内核不支持零拷贝时返回false
+ */
+static bool TestParkOnClose()
+{
+    int iClientFd = -1;
+    int iServerFd = -1;
+    if (!TcpPair(iClientFd, iServerFd))
+    {
+        fprintf(stderr, "failed to create tcp connection\n");
+        ++s_iFailed;
+        return(true);
+    }
+    std::shared_ptr<CBuffer> pData = std::make_shared<CBuffer>(256 * 1024);
+    std::string strData(128 * 1024, 'z');
+    pData->Write(strData.data(), strData.size());
+    std::weak_ptr<CBuffer> pWatch = pData;
+
+    SendQueue* pQueue = SendQueue::Acquire();
+    pQueue->Append(pData, 0, pData->ReadableBytes());
+    pData.reset();
+    int iErrno = 0;
+    int iWriteLen = pQueue->WriteFD(iClientFd, iErrno, 64 * 1024);
+    if (iWriteLen <= 0 || !pQueue->HasZeroCopyPending())
+    {
+        SendQueue::Release(pQueue);
+        close(iClientFd);
+        close(iServerFd);
+        return(false);
+    }
+
+    // 与SocketChannelImpl::Close()相同的顺序：暂存、关闭fd、回收队列
+    pQueue->ParkZeroCopy(iClientFd);
+    close(iClientFd);
+    SendQueue::Release(pQueue);
+    // 本机连接上完成通知可能在ParkZeroCopy()中即已读到，此时数据已释放
+    for (int i = 0; i < 100 && !pWatch.expired(); ++i)
+    {
+        Drain(iServerFd);
+        usleep(10000);
+        SendQueue::CheckParkedZeroCopy();
+    }
+    CHECK(pWatch.expired());
+    close(iServerFd);
+    return(true);
+}
+
+/**
+ * @brief 无法读取完成通知的零拷贝数据（队列析构时）不随队列释放
+ */
+static void TestParkWithoutFd()
+{
+    int iClientFd = -1;
+    int iServerFd = -1;
+    if (!TcpPair(iClientFd, iServerFd))
+    {
+        return;
+    }
+    std::shared_ptr<CBuffer> pData = std::make_shared<CBuffer>(256 * 1024);
+    std::string strData(128 * 1024, 'w');
+    pData->Write(strData.data(), strData.size());
+    std::weak_ptr<CBuffer> pWatch = pData;
+    SendQueue* pQueue = new SendQueue();
+    pQueue->Append(pData, 0, pData->ReadableBytes());
+    pData.reset();
+    int iErrno = 0;
+    pQueue->WriteFD(iClientFd, iErrno, 64 * 1024);
+    bool bPending = pQueue->HasZeroCopyPending();
+    delete pQueue;
+    if (bPending)
+    {
+        SendQueue::CheckParkedZeroCopy();
+        CHECK(!pWatch.expired());
+    }
+    close(iClientFd);
+    close(iServerFd);
+}
+
+int main()
+{
+    TestCoalesceOnEagain();
+    if (TestParkOnClose())
+    {
+        TestParkWithoutFd();
+    }
+    else
+    {
+        printf("SendQueueTest: MSG_ZEROCOPY not available, zero copy cases skipped\n");
+    }
+    if (s_iFailed > 0)
+    {
+        printf("SendQueueTest: %d checks failed\n", s_iFailed);
+        return(1);
+    }
+    printf("SendQueueTest: passed\n");
+    return(0);
+}
@@ -0,0 +1,618 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     StepRedisClusterTest.cpp
+ * @brief    StepRedisCluster跨槽位多key命令的拆分、合并和超时
+ * @author   Bwar
+ * @date:    2026年10月18日
+ * @note     以预先构造的CLUSTER SLOTS响应建立三个主节点的槽位表，派生类覆盖节点级
+ * SendTo()截获Dispatch()拆分出的子命令（不建立连接），再把预先构造的RESP响应逐个交给
+ * Gather()，由真实的ActorBuilder把合并结果回调到登记的步骤。覆盖按key原始顺序合并
+ * MGET结果、DEL/EXISTS结果求和、某一子批次返回错误或MOVED、子批次发送失败以及合并超时。
+ * Modify history:
+ ******************************************************************************/
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <sys/socket.h>
+#include "labor/Labor.hpp"
+#include "labor/NodeInfo.hpp"
+#include "ios/Dispatcher.hpp"
+#include "actor/ActorBuilder.hpp"
+#include "actor/step/RedisStep.hpp"
+#include "actor/step/sys_step/StepRedisCluster.hpp"
+#include "channel/SocketChannel.hpp"
+#include "codec/RespView.hpp"
+#include "logger/NetLogger.hpp"
+#include "util/json/CJsonObject.hpp"
+
+using namespace neb;
+
+static int s_iFailed = 0;
+
+#define CHECK(cond) \
+    do \
+    { \
+        if (!(cond)) \
+        { \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            ++s_iFailed; \
+        } \
+    } while(0)
+
+/**
+ * @brief 只提供StepRedisCluster用到的Dispatcher、ActorBuilder、序列号和可控的当前时间
+ */
+class TestLabor: public Labor
+{
+public:
+    TestLabor(const std::string& strLogFile)
+        : Labor(LABOR_WORKER), m_lNowTime(1000000), m_uiSequence(0),
+          m_pDispatcher(nullptr), m_pActorBuilder(nullptr)
+    {
+        // 带trace id的日志要取节点信息，日志实例须关联Labor
+        m_pLogger = std::make_shared<NetLogger>(strLogFile, Logger::FATAL, gc_uiMaxLogFileSize,
+                gc_uiMaxRollLogFileIndex, gc_uiMaxLogLineLen, true, this);
+        m_pDispatcher = new Dispatcher(this, m_pLogger);
+        m_pActorBuilder = new ActorBuilder(this, m_pLogger);
+    }
+    virtual ~TestLabor()
+    {
+        delete m_pActorBuilder;
+        delete m_pDispatcher;
+    }
+
+    virtual Dispatcher* GetDispatcher() override
+    {
+        return(m_pDispatcher);
+    }
+    virtual ActorBuilder* GetActorBuilder() override
+    {
+        return(m_pActorBuilder);
+    }
+    virtual uint32 GetSequence() const override
+    {
+        return(++m_uiSequence);
+    }
+    virtual time_t GetNowTime() const override
+    {
+        return(m_lNowTime);
+    }
+    virtual long GetNowTimeMs() const override
+    {
+        return(m_lNowTime * 1000);
+    }
+    virtual int64 GetMonotonicTimeMs() const override
+    {
+        return(m_lNowTime * 1000);
+    }
+    virtual int64 GetMonotonicTimeUs() const override
+    {
+        return(m_lNowTime * 1000000);
+    }
+    virtual const CJsonObject& GetNodeConf() const override
+    {
+        return(m_oConf);
+    }
+    virtual void SetNodeConf(const CJsonObject& oNodeConf) override
+    {
+    }
+    virtual const NodeInfo& GetNodeInfo() const override
+    {
+        return(m_stNodeInfo);
+    }
+    virtual void SetNodeId(uint32 uiNodeId) override
+    {
+    }
+    virtual bool AddNetLogMsg(const MsgBody& oMsgBody) override
+    {
+        return(false);
+    }
+    virtual void OnTerminated(struct ev_signal* watcher) override
+    {
+    }
+    virtual const CJsonObject& GetCustomConf() const override
+    {
+        return(m_oConf);
+    }
+
+    void Elapse(time_t lSeconds)
+    {
+        m_lNowTime += lSeconds;
+    }
+
+private:
+    time_t m_lNowTime;
+    mutable uint32 m_uiSequence;
+    CJsonObject m_oConf;
+    NodeInfo m_stNodeInfo;
+    std::shared_ptr<NetLogger> m_pLogger;
+    Dispatcher* m_pDispatcher;
+    ActorBuilder* m_pActorBuilder;
+};
+
+/**
+ * @brief 截获发往各节点的子命令，可指定发送失败的节点
+ */
+class ClusterProbe: public StepRedisCluster
+{
+public:
+    struct tagSent
+    {
+        uint16 unServer;
+        std::shared_ptr<RedisMsg> pRedisMsg;
+    };
+
+    ClusterProbe()
+        : StepRedisCluster("127.0.0.1:7000", false, true, false)
+    {
+    }
+
+    using StepRedisCluster::SendTo;
+    using StepRedisCluster::Dispatch;
+    using StepRedisCluster::Gather;
+    using StepRedisCluster::CheckGatherTimeout;
+    using StepRedisCluster::CmdClusterSlotsCallback;
+    using StepRedisCluster::IsExpiredSubRequest;
+
+    virtual bool SendTo(uint16 unServer, std::shared_ptr<RedisMsg> pRedisMsg) override
+    {
+        if (m_setFailedServer.count(unServer) > 0)
+        {
+            return(false);
+        }
+        m_vecSent.push_back({unServer, pRedisMsg});
+        return(true);
+    }
+
+    virtual bool SendTo(uint16 unServer, const std::vector<std::shared_ptr<RedisMsg>>& vecRedisMsg,
+            std::vector<std::shared_ptr<RedisMsg>>& vecFailedMsg) override
+    {
+        ++m_uiBatchNum;
+        if (m_setFailedServer.count(unServer) > 0)
+        {
+            vecFailedMsg.insert(vecFailedMsg.end(), vecRedisMsg.begin(), vecRedisMsg.end());
+            return(false);
+        }
+        for (auto& pRedisMsg : vecRedisMsg)
+        {
+            m_vecSent.push_back({unServer, pRedisMsg});
+        }
+        return(true);
+    }
+
+    std::vector<tagSent> m_vecSent;
+    std::set<uint16> m_setFailedServer;
+    uint32 m_uiBatchNum = 0;
+};
+
+/**
+ * @brief 调用方步骤，记录合并后的回调
+ */
+class CallerStep: public RedisStep
+{
+public:
+    CallerStep()
+        : RedisStep(nullptr, gc_dNoTimeout), m_uiCallbackNum(0), m_uiErrBackNum(0), m_iErrno(0)
+    {
+    }
+
+    virtual E_CMD_STATUS Emit(int iErrno, const std::string& strErrMsg, void* data) override
+    {
+        return(CMD_STATUS_RUNNING);
+    }
+    virtual E_CMD_STATUS Callback(std::shared_ptr<SocketChannel> pChannel, const RedisReply& oRedisReply) override
+    {
+        ++m_uiCallbackNum;
+        m_oReply = oRedisReply;
+        return(CMD_STATUS_RUNNING);
+    }
+    virtual E_CMD_STATUS ErrBack(std::shared_ptr<SocketChannel> pChannel, int iErrno, const std::string& strErrMsg) override
+    {
+        ++m_uiErrBackNum;
+        m_iErrno = iErrno;
+        m_strErrMsg = strErrMsg;
+        return(CMD_STATUS_RUNNING);
+    }
+    virtual E_CMD_STATUS Timeout() override
+    {
+        return(CMD_STATUS_RUNNING);
+    }
+
+    uint32 m_uiCallbackNum;
+    uint32 m_uiErrBackNum;
+    int m_iErrno;
+    std::string m_strErrMsg;
+    RedisReply m_oReply;
+};
+
+static RedisReply Resp(const std::string& strFrame)
+{
+    RedisReply oReply;
+    RespView oView;
+    if (CODEC_STATUS_OK != RespView::Parse(strFrame.data(), strFrame.size(), oView) || !oView.ToRedisReply(oReply))
+    {
+        fprintf(stderr, "invalid test frame %s\n", strFrame.c_str());
+        ++s_iFailed;
+    }
+    return(oReply);
+}
+
+static std::string Bulk(const std::string& strValue)
+{
+    return("$" + std::to_string(strValue.size()) + "\r\n" + strValue + "\r\n");
+}
+
+static RedisMsg Request(const std::vector<std::string>& vecArg)
+{
+    std::string strFrame = "*" + std::to_string(vecArg.size()) + "\r\n";
+    for (auto& strArg : vecArg)
+    {
+        strFrame += Bulk(strArg);
+    }
+    return(Resp(strFrame));
+}
+
+/**
+ * @brief MGET子命令的响应：每个key的值为"v:"+key
+ */
+static RedisReply MgetReply(const RedisMsg& oSubRequest)
+{
+    std::string strFrame = "*" + std::to_string(oSubRequest.element_size() - 1) + "\r\n";
+    for (int i = 1; i < oSubRequest.element_size(); ++i)
+    {
+        strFrame += Bulk("v:" + oSubRequest.element(i).str());
+    }
+    return(Resp(strFrame));
+}
+
+class ClusterFixture
+{
+public:
+    ClusterFixture(const std::string& strLogFile)
+        : m_oLabor(strLogFile)
+    {
+        int aiFd[2] = {-1, -1};
+        socketpair(AF_UNIX, SOCK_STREAM, 0, aiFd);
+        m_iPeerFd = aiFd[1];
+        m_pChannel = m_oLabor.GetDispatcher()->CreateSocketChannel(aiFd[0], CODEC_RESP, true);
+        CHECK(nullptr != m_pChannel);
+        m_pCluster = std::make_shared<ClusterProbe>();
+        CHECK(nullptr != m_oLabor.GetActorBuilder()->InitializeSharedActor(nullptr, m_pCluster, "ClusterProbe"));
+        // 7000: 0-5460, 7001: 5461-10922（带一个从节点）, 7002: 10923-16383
+        CHECK(m_pCluster->CmdClusterSlotsCallback(Resp(
+                "*3\r\n"
+                "*3\r\n:0\r\n:5460\r\n*3\r\n$9\r\n127.0.0.1\r\n:7000\r\n$2\r\nn0\r\n"
+                "*4\r\n:5461\r\n:10922\r\n*3\r\n$9\r\n127.0.0.1\r\n:7001\r\n$2\r\nn1\r\n*3\r\n$9\r\n127.0.0.1\r\n:7101\r\n$2\r\nr1\r\n"
+                "*3\r\n:10923\r\n:16383\r\n*3\r\n$9\r\n127.0.0.1\r\n:7002\r\n$2\r\nn2\r\n")));
+    }
+    ~ClusterFixture()
+    {
+        m_pCluster.reset();
+        m_pChannel.reset();
+        close(m_iPeerFd);
+    }
+
+    std::shared_ptr<CallerStep> NewCaller()
+    {
+        auto pCaller = std::make_shared<CallerStep>();
+        CHECK(nullptr != m_oLabor.GetActorBuilder()->InitializeSharedActor(nullptr, pCaller, "CallerStep"));
+        return(pCaller);
+    }
+
+    TestLabor m_oLabor;
+    int m_iPeerFd;
+    std::shared_ptr<SocketChannel> m_pChannel;
+    std::shared_ptr<ClusterProbe> m_pCluster;
+};
+
+/**
+ * @brief 分布在三个节点多个槽位上的key
+ */
+static std::vector<std::string> Keys()
+{
+    std::vector<std::string> vecKey;
+    for (int i = 0; i < 12; ++i)
+    {
+        vecKey.push_back("key:" + std::to_string(i));
+    }
+    vecKey.push_back("{key:3}.same_slot");      // 与key:3同槽位，合入同一条子命令
+    return(vecKey);
+}
+
+static std::vector<std::string> Args(const std::string& strCmd, const std::vector<std::string>& vecKey)
+{
+    std::vector<std::string> vecArg(1, strCmd);
+    vecArg.insert(vecArg.end(), vecKey.begin(), vecKey.end());
+    return(vecArg);
+}
+
+static void TestDispatchSplit(const std::string& strLogFile)
+{
+    ClusterFixture oFixture(strLogFile);
+    auto pCaller = oFixture.NewCaller();
+    std::vector<std::string> vecKey = Keys();
+    std::set<uint16> setSlot;
+    std::set<uint16> setServer;
+    for (auto& strKey : vecKey)
+    {
+        setSlot.insert(StepRedisCluster::GetSlot(strKey));
+    }
+    CHECK(oFixture.m_pCluster->Dispatch(Request(Args("MGET", vecKey)), pCaller->GetSequence()));
+    CHECK(setSlot.size() == oFixture.m_pCluster->m_vecSent.size());     // 每个槽位一条子命令
+    size_t uiKeyNum = 0;
+    for (auto& stSent : oFixture.m_pCluster->m_vecSent)
+    {
+        setServer.insert(stSent.unServer);
+        CHECK(pCaller->GetSequence() == (uint32)stSent.pRedisMsg->integer());
+        CHECK("MGET" == stSent.pRedisMsg->element(0).str());
+        uint16 unSlot = StepRedisCluster::GetSlot(stSent.pRedisMsg->element(1).str());
+        for (int i = 1; i < stSent.pRedisMsg->element_size(); ++i)
+        {
+            const std::string& strKey = stSent.pRedisMsg->element(i).str();
+            CHECK(unSlot == StepRedisCluster::GetSlot(strKey));
+            CHECK(strKey == vecKey[stSent.pRedisMsg->element(i).integer()]);    // 记录了原始序号
+            ++uiKeyNum;
+        }
+    }
+    CHECK(vecKey.size() == uiKeyNum);
+    CHECK(3 == setServer.size());
+    CHECK(3 == oFixture.m_pCluster->m_uiBatchNum);      // 同一节点的子命令合为一批
+    CHECK(!oFixture.m_pCluster->Dispatch(Request(Args("MGET", vecKey)), pCaller->GetSequence()));   // 同一seq已有未完成的合并
+
+    // 同一槽位的多key命令不拆分，原命令直接发送
+    auto pOther = oFixture.NewCaller();
+    oFixture.m_pCluster->m_vecSent.clear();
+    CHECK(oFixture.m_pCluster->Dispatch(Request({"MGET", "{u}1", "{u}2"}), pOther->GetSequence()));
+    CHECK(1 == oFixture.m_pCluster->m_vecSent.size());
+    CHECK(3 == oFixture.m_pCluster->m_vecSent[0].pRedisMsg->element_size());
+    // 跨槽位但不能拆分的命令
+    CHECK(!oFixture.m_pCluster->Dispatch(Request({"MSETNX", "key:0", "a", "key:1", "b"}), pOther->GetSequence()));
+}
+
+static void TestMergeArray(const std::string& strLogFile)
+{
+    ClusterFixture oFixture(strLogFile);
+    auto pCaller = oFixture.NewCaller();
+    std::vector<std::string> vecKey = Keys();
+    CHECK(oFixture.m_pCluster->Dispatch(Request(Args("MGET", vecKey)), pCaller->GetSequence()));
+    auto& vecSent = oFixture.m_pCluster->m_vecSent;
+    CHECK(vecSent.size() > 2);
+    // 响应按与发送相反的顺序到达
+    for (size_t i = vecSent.size(); i > 0; --i)
+    {
+        bool bDone = oFixture.m_pCluster->Gather(oFixture.m_pChannel, pCaller->GetSequence(),
+                *vecSent[i - 1].pRedisMsg, MgetReply(*vecSent[i - 1].pRedisMsg));
+        CHECK(bDone == (1 == i));
+        CHECK((1 == i ? 1u : 0u) == pCaller->m_uiCallbackNum);
+    }
+    CHECK(REDIS_REPLY_ARRAY == pCaller->m_oReply.type());
+    CHECK((int)vecKey.size() == pCaller->m_oReply.element_size());
+    for (int i = 0; i < pCaller->m_oReply.element_size() && i < (int)vecKey.size(); ++i)
+    {
+        CHECK(REDIS_REPLY_STRING == pCaller->m_oReply.element(i).type());
+        CHECK("v:" + vecKey[i] == pCaller->m_oReply.element(i).str());
+    }
+    CHECK(0 == pCaller->m_uiErrBackNum);
+    // 合并完成后迟到的重复响应不再回调
+    CHECK(!oFixture.m_pCluster->Gather(oFixture.m_pChannel, pCaller->GetSequence(),
+            *vecSent[0].pRedisMsg, MgetReply(*vecSent[0].pRedisMsg)));
+    CHECK(1 == pCaller->m_uiCallbackNum);
+
+    // MSET结果为状态，全部成功时为OK
+    auto pMset = oFixture.NewCaller();
+    vecSent.clear();
+    CHECK(oFixture.m_pCluster->Dispatch(Request({"MSET", "key:0", "a", "key:1", "b", "key:2", "c"}), pMset->GetSequence()));
+    CHECK(vecSent.size() > 1);
+    for (auto& stSent : vecSent)
+    {
+        CHECK(0 == (stSent.pRedisMsg->element_size() - 1) % 2);      // key value成对拆分
+        oFixture.m_pCluster->Gather(oFixture.m_pChannel, pMset->GetSequence(), *stSent.pRedisMsg, Resp("+OK\r\n"));
+    }
+    CHECK(1 == pMset->m_uiCallbackNum);
+    CHECK(REDIS_REPLY_STATUS == pMset->m_oReply.type());
+    CHECK("OK" == pMset->m_oReply.str());
+}
+
+static void TestMergeSum(const std::string& strLogFile)
+{
+    ClusterFixture oFixture(strLogFile);
+    std::vector<std::string> vecKey = Keys();
+    const char* aszCmd[] = {"DEL", "EXISTS", "unlink", "TOUCH"};
+    for (size_t c = 0; c < sizeof(aszCmd) / sizeof(aszCmd[0]); ++c)
+    {
+        auto pCaller = oFixture.NewCaller();
+        auto& vecSent = oFixture.m_pCluster->m_vecSent;
+        vecSent.clear();
+        CHECK(oFixture.m_pCluster->Dispatch(Request(Args(aszCmd[c], vecKey)), pCaller->GetSequence()));
+        CHECK(vecSent.size() > 2);
+        int64 llExpect = 0;
+        for (size_t i = 0; i < vecSent.size(); ++i)
+        {
+            // 第一个子命令的key都不存在，其余子命令的key都存在
+            int64 llNum = (0 == i) ? 0 : vecSent[i].pRedisMsg->element_size() - 1;
+            llExpect += llNum;
+            oFixture.m_pCluster->Gather(oFixture.m_pChannel, pCaller->GetSequence(),
+                    *vecSent[i].pRedisMsg, Resp(":" + std::to_string(llNum) + "\r\n"));
+        }
+        CHECK(1 == pCaller->m_uiCallbackNum);
+        CHECK(REDIS_REPLY_INTEGER == pCaller->m_oReply.type());
+        CHECK(llExpect == pCaller->m_oReply.integer());
+        CHECK(llExpect > 0 && llExpect < (int64)vecKey.size());
+    }
+}
+
+static void TestSubBatchError(const std::string& strLogFile)
+{
+    ClusterFixture oFixture(strLogFile);
+    std::vector<std::string> vecKey = Keys();
+    auto& vecSent = oFixture.m_pCluster->m_vecSent;
+
+    // MGET：一个子命令返回MOVED（重定向次数用尽后交给Gather），其key对应的元素为错误，其余照常
+    auto pCaller = oFixture.NewCaller();
+    CHECK(oFixture.m_pCluster->Dispatch(Request(Args("MGET", vecKey)), pCaller->GetSequence()));
+    std::string strMoved = "MOVED 1234 127.0.0.1:7001";
+    std::set<std::string> setMovedKey;
+    for (int i = 1; i < vecSent[1].pRedisMsg->element_size(); ++i)
+    {
+        setMovedKey.insert(vecSent[1].pRedisMsg->element(i).str());
+    }
+    for (size_t i = 0; i < vecSent.size(); ++i)
+    {
+        RedisReply oReply = (1 == i) ? Resp("-" + strMoved + "\r\n") : MgetReply(*vecSent[i].pRedisMsg);
+        oFixture.m_pCluster->Gather(oFixture.m_pChannel, pCaller->GetSequence(), *vecSent[i].pRedisMsg, oReply);
+    }
+    CHECK(1 == pCaller->m_uiCallbackNum);
+    CHECK(REDIS_REPLY_ARRAY == pCaller->m_oReply.type());
+    CHECK((int)vecKey.size() == pCaller->m_oReply.element_size());
+    for (int i = 0; i < pCaller->m_oReply.element_size() && i < (int)vecKey.size(); ++i)
+    {
+        if (setMovedKey.count(vecKey[i]) > 0)
+        {
+            CHECK(REDIS_REPLY_ERROR == pCaller->m_oReply.element(i).type());
+            CHECK(strMoved == pCaller->m_oReply.element(i).str());
+        }
+        else
+        {
+            CHECK("v:" + vecKey[i] == pCaller->m_oReply.element(i).str());
+        }
+    }
+
+    // DEL：一个子命令出错时整体以首个错误返回
+    auto pDel = oFixture.NewCaller();
+    vecSent.clear();
+    CHECK(oFixture.m_pCluster->Dispatch(Request(Args("DEL", vecKey)), pDel->GetSequence()));
+    for (size_t i = 0; i < vecSent.size(); ++i)
+    {
+        RedisReply oReply = (vecSent.size() - 1 == i) ? Resp("-ERR node is loading\r\n") : Resp(":1\r\n");
+        oFixture.m_pCluster->Gather(oFixture.m_pChannel, pDel->GetSequence(), *vecSent[i].pRedisMsg, oReply);
+    }
+    CHECK(1 == pDel->m_uiCallbackNum);
+    CHECK(REDIS_REPLY_ERROR == pDel->m_oReply.type());
+    CHECK("ERR node is loading" == pDel->m_oReply.str());
+
+    // 一个节点的子批次发送失败：其key以发送失败合并，其余节点照常等待响应
+    auto pPartial = oFixture.NewCaller();
+    vecSent.clear();
+    oFixture.m_pCluster->m_setFailedServer.insert(0);       // 127.0.0.1:7000
+    CHECK(oFixture.m_pCluster->Dispatch(Request(Args("MGET", vecKey)), pPartial->GetSequence()));
+    CHECK(vecSent.size() > 0);
+    for (auto& stSent : vecSent)
+    {
+        CHECK(0 != stSent.unServer);
+        oFixture.m_pCluster->Gather(oFixture.m_pChannel, pPartial->GetSequence(), *stSent.pRedisMsg, MgetReply(*stSent.pRedisMsg));
+    }
+    CHECK(1 == pPartial->m_uiCallbackNum);
+    uint32 uiFailedKey = 0;
+    for (int i = 0; i < pPartial->m_oReply.element_size() && i < (int)vecKey.size(); ++i)
+    {
+        uint16 unSlot = StepRedisCluster::GetSlot(vecKey[i]);
+        if (unSlot <= 5460)
+        {
+            CHECK(REDIS_REPLY_ERROR == pPartial->m_oReply.element(i).type());
+            CHECK("failed to send to 127.0.0.1:7000" == pPartial->m_oReply.element(i).str());
+            ++uiFailedKey;
+        }
+        else
+        {
+            CHECK("v:" + vecKey[i] == pPartial->m_oReply.element(i).str());
+        }
+    }
+    CHECK(uiFailedKey > 0);
+
+    // 所有节点都发送失败时不登记合并，直接返回失败
+    auto pNone = oFixture.NewCaller();
+    oFixture.m_pCluster->m_setFailedServer.insert(1);       // 127.0.0.1:7001
+    oFixture.m_pCluster->m_setFailedServer.insert(3);       // 127.0.0.1:7002（2为7001的从节点）
+    CHECK(!oFixture.m_pCluster->Dispatch(Request(Args("DEL", vecKey)), pNone->GetSequence()));
+    CHECK(0 == pNone->m_uiCallbackNum);
+    oFixture.m_pCluster->m_setFailedServer.clear();
+    CHECK(oFixture.m_pCluster->Dispatch(Request(Args("DEL", vecKey)), pNone->GetSequence()));    // 合并状态已清除
+}
+
+static void TestGatherTimeout(const std::string& strLogFile)
+{
+    ClusterFixture oFixture(strLogFile);
+    std::vector<std::string> vecKey = Keys();
+    auto& vecSent = oFixture.m_pCluster->m_vecSent;
+    auto pCaller = oFixture.NewCaller();
+    CHECK(oFixture.m_pCluster->Dispatch(Request(Args("MGET", vecKey)), pCaller->GetSequence()));
+    CHECK(vecSent.size() > 1);
+    CHECK(!oFixture.m_pCluster->Gather(oFixture.m_pChannel, pCaller->GetSequence(),
+            *vecSent[0].pRedisMsg, MgetReply(*vecSent[0].pRedisMsg)));
+
+    oFixture.m_oLabor.Elapse(9);
+    oFixture.m_pCluster->CheckGatherTimeout();
+    CHECK(0 == pCaller->m_uiErrBackNum);
+
+    // 后发起的命令在其自身的超时时间之前不受影响
+    auto pLater = oFixture.NewCaller();
+    vecSent.clear();
+    CHECK(oFixture.m_pCluster->Dispatch(Request(Args("EXISTS", vecKey)), pLater->GetSequence()));
+    std::vector<ClusterProbe::tagSent> vecExists = vecSent;
+    vecSent.clear();
+
+    oFixture.m_oLabor.Elapse(1);
+    oFixture.m_pCluster->CheckGatherTimeout();
+    CHECK(1 == pCaller->m_uiErrBackNum);
+    CHECK(ERR_TIMEOUT == pCaller->m_iErrno);
+    CHECK(0 == pCaller->m_uiCallbackNum);
+    CHECK(0 == pLater->m_uiErrBackNum);
+
+    // 已超时命令的子命令都被标记，迟到的响应不再合并
+    oFixture.m_pCluster->CheckGatherTimeout();
+    CHECK(1 == pCaller->m_uiErrBackNum);
+    for (auto& stSent : vecExists)
+    {
+        CHECK(!ClusterProbe::IsExpiredSubRequest(*stSent.pRedisMsg));
+    }
+    for (auto& stSent : vecExists)
+    {
+        oFixture.m_pCluster->Gather(oFixture.m_pChannel, pLater->GetSequence(), *stSent.pRedisMsg, Resp(":1\r\n"));
+    }
+    CHECK(1 == pLater->m_uiCallbackNum);
+    CHECK((int64)vecExists.size() == pLater->m_oReply.integer());
+
+    // 同一seq在超时回调后可以再次发起跨槽位命令
+    CHECK(oFixture.m_pCluster->Dispatch(Request(Args("MGET", vecKey)), pCaller->GetSequence()));
+    oFixture.m_oLabor.Elapse(10);
+    oFixture.m_pCluster->CheckGatherTimeout();
+    CHECK(2 == pCaller->m_uiErrBackNum);
+    for (auto& stSent : vecSent)
+    {
+        CHECK(ClusterProbe::IsExpiredSubRequest(*stSent.pRedisMsg));
+        CHECK(!oFixture.m_pCluster->Gather(oFixture.m_pChannel, pCaller->GetSequence(),
+                *stSent.pRedisMsg, MgetReply(*stSent.pRedisMsg)));
+    }
+    CHECK(0 == pCaller->m_uiCallbackNum);
+}
+
+int main()
+{
+    char szDir[] = "/tmp/neb_redis_cluster_test_XXXXXX";
+    if (NULL == mkdtemp(szDir))
+    {
+        perror("mkdtemp");
+        return(1);
+    }
+    std::string strLogFile = std::string(szDir) + "/test.log";
+    TestDispatchSplit(strLogFile);
+    TestMergeArray(strLogFile);
+    TestMergeSum(strLogFile);
+    TestSubBatchError(strLogFile);
+    TestGatherTimeout(strLogFile);
+    unlink(strLogFile.c_str());
+    rmdir(szDir);
+    if (s_iFailed > 0)
+    {
+        printf("StepRedisClusterTest: %d checks failed\n", s_iFailed);
+        return(1);
+    }
+    printf("StepRedisClusterTest: passed\n");
+    return(0);
+}
@@ -0,0 +1,324 @@
+/*******************************************************************************
+ * Project:  Nebula
+ * @file     TimingWheelTest.cpp
+ * @brief    分层时间轮：逐级下放、跳过空槽的大跨度推进、回调中析构定时器、与参考模型随机对比
+ * @author   Bwar
+ * @date:    2026年10月18日
+ * @note     定时器回调时GetCurrentTick()已指向下一个tick，触发时刻按GetCurrentTick() - 1记录。
+ * Modify history:
+ ******************************************************************************/
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <vector>
+#include "ios/TimingWheel.hpp"
+
+using namespace neb;
+
+static int s_iFailed = 0;
+
+#define CHECK(cond) \
+    do \
+    { \
+        if (!(cond)) \
+        { \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            ++s_iFailed; \
+        } \
+    } while(0)
+
+struct tagFired
+{
+    int iId;
+    uint64 ullTick;
+};
+
+struct tagTestTimer
+{
+    TimingWheel::tagTimer stTimer;
+    int iId = 0;
+    TimingWheel* pWheel = nullptr;
+    std::vector<tagFired>* pFired = nullptr;
+    tagTestTimer* pVictim = nullptr;    ///< 回调中析构的另一个定时器对象
+    bool bDeleteSelf = false;           ///< 回调中析构自身
+};
+
+static void OnTimeout(TimingWheel::tagTimer* pTimer)
+{
+    tagTestTimer* pTest = (tagTestTimer*)pTimer->data;
+    pTest->pFired->push_back({pTest->iId, pTest->pWheel->GetCurrentTick() - 1});
+    if (nullptr != pTest->pVictim)
+    {
+        delete pTest->pVictim;
+        pTest->pVictim = nullptr;
+    }
+    if (pTest->bDeleteSelf)
+    {
+        delete pTest;
+    }
+}
+
+static void InitTimer(tagTestTimer& stTest, int iId, TimingWheel& oWheel, std::vector<tagFired>& vecFired)
+{
+    stTest.iId = iId;
+    stTest.pWheel = &oWheel;
+    stTest.pFired = &vecFired;
+    stTest.stTimer.pCallback = OnTimeout;
+    stTest.stTimer.data = &stTest;
+}
+
+static void TestCascade()
+{
+    // 落在各层的定时器逐级下放到第0层，在到期的tick准确触发
+    const uint64 aullDistance[] = {1, 255, 256, 257, 300, 16383, 16384, 16385, 70000,
+            (1ULL << 20) + 3, (1ULL << 26) - 1, (1ULL << 26) + 11, (1ULL << 30) + 5};
+    const int iNum = sizeof(aullDistance) / sizeof(aullDistance[0]);
+    const uint64 ullStart = 1000;
+    TimingWheel oWheel(ullStart);
+    std::vector<tagFired> vecFired;
+    std::vector<tagTestTimer> vecTimer(iNum);
+    for (int i = 0; i < iNum; ++i)
+    {
+        InitTimer(vecTimer[i], i, oWheel, vecFired);
+        oWheel.Add(&vecTimer[i].stTimer, ullStart + aullDistance[i]);
+    }
+    // 分多步推进，每步都经过若干次下放
+    uint64 ullNow = ullStart;
+    while (ullNow < ullStart + aullDistance[iNum - 1])
+    {
+        ullNow += 12345;
+        oWheel.Advance(ullNow);
+        for (auto& stFired : vecFired)
+        {
+            CHECK(stFired.ullTick <= ullNow);
+        }
+    }
+    oWheel.Advance(ullStart + aullDistance[iNum - 1]);
+    CHECK(iNum == (int)vecFired.size());
+    for (size_t i = 0; i < vecFired.size(); ++i)
+    {
+        CHECK((int)i == vecFired[i].iId);
+        CHECK(ullStart + aullDistance[vecFired[i].iId] == vecFired[i].ullTick);
+    }
+    uint64 ullWakeTick = 0;
+    CHECK(!oWheel.GetNextWakeTick(ullWakeTick));
+}
+
+static void TestLargeJump()
+{
+    // 只有高层有定时器时，下一次推进时刻直接跳到下放时刻，不经过中间的空槽
+    const uint64 ullStart = 123456789;
+    TimingWheel oWheel(ullStart);
+    std::vector<tagFired> vecFired;
+    tagTestTimer stFar;
+    InitTimer(stFar, 1, oWheel, vecFired);
+    uint64 ullExpire = ullStart + (1ULL << 31) + 777;
+    oWheel.Add(&stFar.stTimer, ullExpire);
+    uint64 ullWakeTick = 0;
+    CHECK(oWheel.GetNextWakeTick(ullWakeTick));
+    CHECK(ullWakeTick > ullStart && ullWakeTick <= ullExpire);
+    CHECK(0 == oWheel.Advance(ullExpire - 1));
+    CHECK(vecFired.empty());
+    CHECK(ullExpire == oWheel.GetCurrentTick());
+    CHECK(oWheel.GetNextWakeTick(ullWakeTick) && ullExpire == ullWakeTick);
+    CHECK(1 == oWheel.Advance(ullExpire));
+    CHECK(1 == vecFired.size() && ullExpire == vecFired[0].ullTick);
+
+    // 一次推进跨过多层，按到期先后触发；超过最大超时的按最大值处理
+    vecFired.clear();
+    uint64 ullNow = oWheel.GetCurrentTick();
+    const uint64 aullDistance[] = {5, 1000, 100000, 10000000, 1000000000, 0xFFFFFFFFULL, 0x500000000ULL};
+    const int iNum = sizeof(aullDistance) / sizeof(aullDistance[0]);
+    std::vector<tagTestTimer> vecTimer(iNum);
+    for (int i = iNum - 1; i >= 0; --i)
+    {
+        InitTimer(vecTimer[i], i, oWheel, vecFired);
+        oWheel.Add(&vecTimer[i].stTimer, ullNow + aullDistance[i]);
+    }
+    CHECK(iNum == (int)oWheel.Advance(ullNow + 0x600000000ULL));
+    CHECK(iNum == (int)vecFired.size());
+    for (int i = 0; i < (int)vecFired.size(); ++i)
+    {
+        int iId = vecFired[i].iId;
+        uint64 ullExpect = ullNow + ((aullDistance[iId] > 0xFFFFFFFFULL) ? 0xFFFFFFFFULL : aullDistance[iId]);
+        CHECK(ullExpect == vecFired[i].ullTick);
+        CHECK(i < 5 ? (i == iId) : (iId >= 5));     // 最后两个同一时刻到期
+    }
+    CHECK(ullNow + 0x600000000ULL + 1 == oWheel.GetCurrentTick());
+
+    // 空闲很久后挂入的定时器从当前时刻起算
+    vecFired.clear();
+    tagTestTimer stLate;
+    InitTimer(stLate, 9, oWheel, vecFired);
+    oWheel.Add(&stLate.stTimer, 10);            // 早于当前时刻，下一个tick到期
+    ullNow = oWheel.GetCurrentTick();
+    CHECK(1 == oWheel.Advance(ullNow));
+    CHECK(1 == vecFired.size() && ullNow == vecFired[0].ullTick);
+}
+
+static void TestDestroyWhileFiring()
+{
+    // 同一tick到期的定时器：前一个回调析构后一个（节点析构时从待触发链表摘除），
+    // 以及回调中析构自身；被析构的定时器不再触发
+    TimingWheel oWheel(0);
+    std::vector<tagFired> vecFired;
+    tagTestTimer* pFirst = new tagTestTimer();
+    tagTestTimer* pVictim = new tagTestTimer();
+    tagTestTimer* pLast = new tagTestTimer();
+    InitTimer(*pFirst, 1, oWheel, vecFired);
+    InitTimer(*pVictim, 2, oWheel, vecFired);
+    InitTimer(*pLast, 3, oWheel, vecFired);
+    pFirst->pVictim = pVictim;
+    pFirst->bDeleteSelf = true;
+    pLast->bDeleteSelf = true;
+    oWheel.Add(&pFirst->stTimer, 100);
+    oWheel.Add(&pVictim->stTimer, 100);
+    oWheel.Add(&pLast->stTimer, 100);
+    // 高层槽中的定时器在下放前析构
+    tagTestTimer* pFar = new tagTestTimer();
+    InitTimer(*pFar, 4, oWheel, vecFired);
+    oWheel.Add(&pFar->stTimer, 1000000);
+    CHECK(2 == oWheel.Advance(100));
+    CHECK(2 == vecFired.size() && 1 == vecFired[0].iId && 3 == vecFired[1].iId);
+    delete pFar;
+    uint64 ullWakeTick = 0;
+    CHECK(!oWheel.GetNextWakeTick(ullWakeTick));
+    CHECK(0 == oWheel.Advance(2000000));
+
+    // 时间轮先于定时器析构，定时器析构时不再访问时间轮
+    std::vector<tagFired> vecFired2;
+    tagTestTimer stTimer;
+    {
+        TimingWheel oWheel2(0);
+        InitTimer(stTimer, 5, oWheel2, vecFired2);
+        oWheel2.Add(&stTimer.stTimer, 50000);
+    }
+    CHECK(!stTimer.stTimer.IsActive());
+}
+
+static void TestRandom()
+{
+    // 随机挂入、刷新、摘除和推进（含大跨度推进），与按到期时刻排序的参考模型对比
+    std::mt19937_64 oRand(20261018);
+    const int iTimerNum = 2000;
+    TimingWheel oWheel(1000 + oRand() % 1000000);
+    std::vector<tagFired> vecFired;
+    std::vector<tagTestTimer> vecTimer(iTimerNum);
+    std::map<int, uint64> mapExpect;            ///< 定时器ID -> 应到期的tick
+    for (int i = 0; i < iTimerNum; ++i)
+    {
+        InitTimer(vecTimer[i], i, oWheel, vecFired);
+    }
+    for (int iRound = 0; iRound < 3000; ++iRound)
+    {
+        int iOps = oRand() % 20;
+        for (int i = 0; i < iOps; ++i)
+        {
+            int iId = oRand() % iTimerNum;
+            uint32 uiKind = oRand() % 10;
+            if (uiKind < 7)
+            {
+                uint64 ullDistance = 0;
+                switch (oRand() % 4)
+                {
+                    case 0: ullDistance = oRand() % 300; break;
+                    case 1: ullDistance = oRand() % 70000; break;
+                    case 2: ullDistance = oRand() % (1ULL << 28); break;
+                    default: ullDistance = oRand() % (1ULL << 33); break;
+                }
+                uint64 ullNow = oWheel.GetCurrentTick();
+                uint64 ullExpire = (ullDistance < 10) ? (ullNow - ullDistance) : (ullNow + ullDistance);
+                oWheel.Add(&vecTimer[iId].stTimer, ullExpire);
+                if (ullExpire < ullNow)
+                {
+                    ullExpire = ullNow;
+                }
+                if (ullExpire - ullNow > 0xFFFFFFFFULL)
+                {
+                    ullExpire = ullNow + 0xFFFFFFFFULL;
+                }
+                mapExpect[iId] = ullExpire;
+            }
+            else
+            {
+                oWheel.Del(&vecTimer[iId].stTimer);
+                mapExpect.erase(iId);
+            }
+        }
+        uint64 ullStep = 0;
+        switch (oRand() % 5)
+        {
+            case 0: ullStep = oRand() % 10; break;
+            case 1: ullStep = oRand() % 1000; break;
+            case 2: ullStep = oRand() % 100000; break;
+            case 3: ullStep = oRand() % (1ULL << 26); break;
+            default: ullStep = oRand() % (1ULL << 31); break;
+        }
+        uint64 ullNow = oWheel.GetCurrentTick() + ullStep;
+        std::multiset<std::pair<uint64, int>> setExpect;
+        for (auto it = mapExpect.begin(); it != mapExpect.end();)
+        {
+            if (it->second <= ullNow)
+            {
+                setExpect.insert(std::make_pair(it->second, it->first));
+                it = mapExpect.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        vecFired.clear();
+        uint32 uiExpired = oWheel.Advance(ullNow);
+        CHECK(setExpect.size() == uiExpired);
+        std::multiset<std::pair<uint64, int>> setFired;
+        for (size_t i = 0; i < vecFired.size(); ++i)
+        {
+            setFired.insert(std::make_pair(vecFired[i].ullTick, vecFired[i].iId));
+            if (i > 0)
+            {
+                CHECK(vecFired[i - 1].ullTick <= vecFired[i].ullTick);
+            }
+        }
+        if (setExpect != setFired)
+        {
+            fprintf(stderr, "round %d: expect %zu timers, fired %zu\n", iRound, setExpect.size(), setFired.size());
+            ++s_iFailed;
+            return;
+        }
+        for (auto& stExpect : mapExpect)
+        {
+            CHECK(vecTimer[stExpect.first].stTimer.IsActive());
+        }
+        uint64 ullWakeTick = 0;
+        bool bHasTimer = oWheel.GetNextWakeTick(ullWakeTick);
+        CHECK(bHasTimer == !mapExpect.empty());
+        if (bHasTimer)
+        {
+            uint64 ullEarliest = (uint64)-1;
+            for (auto& stExpect : mapExpect)
+            {
+                ullEarliest = (stExpect.second < ullEarliest) ? stExpect.second : ullEarliest;
+            }
+            CHECK(ullWakeTick >= oWheel.GetCurrentTick() && ullWakeTick <= ullEarliest);
+        }
+    }
+}
+
+int main()
+{
+    TestCascade();
+    TestLargeJump();
+    TestDestroyWhileFiring();
+    TestRandom();
+    if (s_iFailed > 0)
+    {
+        printf("TimingWheelTest: %d checks failed\n", s_iFailed);
+        return(1);
+    }
+    printf("TimingWheelTest: passed\n");
+    return(0);
+}